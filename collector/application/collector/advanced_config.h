@@ -65,6 +65,14 @@
 /* Number of max data retries */
 #define CONFIG_MAX_RETRIES 5
 
+/*!
+ Fast polling interval in milliseconds to be set on connected sleepy devices
+ using configuration request messages, see
+ SMSGS_CONFIG_REQUEST_FAST_POLL_MSG_LENGTH. 0 sends the shorter
+ configuration request understood by devices without fast polling.
+ */
+#define CONFIG_FAST_POLLING_INTERVAL 0
+
 /*!
  The number of non sleepy channel hopping end devices to be supported.
  It is to be noted that the total number of non sleepy devices supported
@@ -99,6 +99,9 @@
 #define RAMP_DATA_MSDU_HANDLE 0x20
 /* App Broadcast Cmd Msg marker for the MSDU Handle */
 #define APP_BROADCAST_MSDU_HANDLE 0x20
+/* App Collector Restored Msg marker for the MSDU Handle */
+#define APP_RESTORED_MSDU_HANDLE (APP_CONFIG_MSDU_HANDLE | \
+                                  APP_BROADCAST_MSDU_HANDLE)
 
 /* Delay for config request retry in busy network */
 #define CONFIG_DELAY 2000
@@ -123,6 +126,16 @@
 #define ASSOC_TRACKING_ERROR    0x8000    /* Tracking Req error */
 #define ASSOC_TRACKING_MASK     0xF000    /* Tracking mask  */
 
+/* Over-the-air length of the config requests sent by this collector */
+#if CONFIG_FAST_POLLING_INTERVAL > 0
+#define CONFIG_REQUEST_MSG_LENGTH SMSGS_CONFIG_REQUEST_FAST_POLL_MSG_LENGTH
+#else
+#define CONFIG_REQUEST_MSG_LENGTH SMSGS_CONFIG_REQUEST_MSG_LENGTH
+#endif
+
+/* Number of 16 bit values in the message statistics field */
+#define COMPACT_NUM_STATS (sizeof(Smsgs_msgStatsField_t) / sizeof(uint16_t))
+
 #ifdef USE_DMM
 #define NTWK_DISCOVER_TIMER         100
 #endif
@@ -158,6 +171,20 @@ STATIC uint16_t devicePanId = 0xFFFF;
 STATIC uint8_t deviceTxMsduHandle = 0;
 
 STATIC bool fhEnabled = false;
+
+/*! Compact sensor data delta base of an associated device */
+typedef struct
+{
+    /*! Short address of the device the base belongs to */
+    uint16_t shortAddr;
+    /*! Report sequence number of the base */
+    uint8_t seq;
+    /*! Message statistics of the base */
+    uint16_t stats[COMPACT_NUM_STATS];
+} Collector_compactBase_t;
+
+/*! Compact delta bases, same index as Cllc_associatedDevList */
+STATIC Collector_compactBase_t compactBases[CONFIG_MAX_DEVICES];
 #ifdef USE_DMM
 /* Device List Discovery Flag */
 static bool listDiscovery = false;
@@ -188,7 +215,17 @@ static void processToggleLedResponse(ApiMac_mcpsDataInd_t *pDataInd);
 static void processDeviceTypeResponse(ApiMac_mcpsDataInd_t *pDataInd);
 #endif
 
+static uint8_t *parseSensorFields(uint8_t *pBuf, uint16_t fields,
+                                  Smsgs_sensorMsg_t *pMsg);
+static uint16_t sensorFieldsLen(uint16_t fields);
 static void processSensorData(ApiMac_mcpsDataInd_t *pDataInd);
+static void processSensorDataBatch(ApiMac_mcpsDataInd_t *pDataInd);
+static uint8_t *parseCompactSensorFields(uint8_t *pBuf, uint8_t *pEnd,
+                                         ApiMac_sAddr_t *pSrcAddr,
+                                         Smsgs_sensorMsg_t *pMsg);
+static uint8_t *parseVarint(uint8_t *pBuf, uint8_t *pEnd, uint32_t *pValue);
+static uint8_t *parseZigZag(uint8_t *pBuf, uint8_t *pEnd, int32_t *pValue);
+static uint8_t *parseByte(uint8_t *pBuf, uint8_t *pEnd, uint8_t *pValue);
 static Cllc_associated_devices_t *findDevice(ApiMac_sAddr_t *pAddr);
 static Cllc_associated_devices_t *findDeviceStatusBit(uint16_t mask, uint16_t statusBit);
 static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType);
@@ -198,6 +235,7 @@ static bool sendMsg(Smsgs_cmdIds_t type, uint16_t dstShortAddr, bool rxOnIdle,
 static void generateConfigRequests(void);
 static void generateTrackingRequests(void);
 static void generateBroadcastCmd(void);
+static void generateRestoredMsg(void);
 static void sendTrackingRequest(Cllc_associated_devices_t *pDev);
 static void commStatusIndCB(ApiMac_mlmeCommStatusInd_t *pCommStatusInd);
 static void pollIndCB(ApiMac_mlmePollInd_t *pPollInd);
@@ -589,6 +627,9 @@ void Collector_process(void)
     if(Collector_events == 0)
 #endif
     {
+        /* Use the idle time to make room in NV */
+        Csf_compactNV();
+
         /* Wait for response message or events */
         ApiMac_processIncoming();
     }
@@ -875,7 +916,7 @@ Collector_status_t Collector_sendConfigRequest(ApiMac_sAddr_t *pDstAddr,
         /* Is the device a known device? */
         if(Csf_getDevice(pDstAddr, &item))
         {
-            uint8_t buffer[SMSGS_CONFIG_REQUEST_MSG_LENGTH];
+            uint8_t buffer[CONFIG_REQUEST_MSG_LENGTH];
             uint8_t *pBuf = buffer;
 
             /* Build the message */
@@ -889,11 +930,17 @@ Collector_status_t Collector_sendConfigRequest(ApiMac_sAddr_t *pDstAddr,
             *pBuf++ = Util_breakUint32(pollingInterval, 0);
             *pBuf++ = Util_breakUint32(pollingInterval, 1);
             *pBuf++ = Util_breakUint32(pollingInterval, 2);
-            *pBuf = Util_breakUint32(pollingInterval, 3);
+            *pBuf++ = Util_breakUint32(pollingInterval, 3);
+#if CONFIG_FAST_POLLING_INTERVAL > 0
+            *pBuf++ = Util_breakUint32(CONFIG_FAST_POLLING_INTERVAL, 0);
+            *pBuf++ = Util_breakUint32(CONFIG_FAST_POLLING_INTERVAL, 1);
+            *pBuf++ = Util_breakUint32(CONFIG_FAST_POLLING_INTERVAL, 2);
+            *pBuf = Util_breakUint32(CONFIG_FAST_POLLING_INTERVAL, 3);
+#endif
 
             if((sendMsg(Smsgs_cmdIds_configReq, item.devInfo.shortAddress,
                         item.capInfo.rxOnWhenIdle,
-                        (SMSGS_CONFIG_REQUEST_MSG_LENGTH),
+                        (CONFIG_REQUEST_MSG_LENGTH),
                          buffer)) == true)
             {
                 status = Collector_status_success;
@@ -1129,6 +1176,13 @@ static void cllcStateChangedCB(Cllc_states_t state)
      }
 #endif /* USE_DMM */
 
+    if((state == Cllc_states_restored) && !fhEnabled)
+    {
+        /* Let orphaned sensors know they can rejoin now. In FH mode the
+           CLLC sends a PC frame for this instead */
+        generateRestoredMsg();
+    }
+
     /* Notify the user interface */
     Csf_stateChangeUpdate(cllcState);
 
@@ -1144,6 +1198,9 @@ static void cllcStateChangedCB(Cllc_states_t state)
  */
 static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
 {
+    /* Feed the current channel's quality estimate */
+    Cllc_updateTxStatus(pDataCnf->status);
+
     /* Record statistics */
     if(pDataCnf->status == ApiMac_status_channelAccessFailure)
     {
@@ -1215,7 +1272,12 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
     if(pDataCnf->msduHandle & APP_MARKER_MSDU_HANDLE)
     {
         /* What message type was the original request? */
-        if(pDataCnf->msduHandle & APP_CONFIG_MSDU_HANDLE)
+        if((pDataCnf->msduHandle & APP_RESTORED_MSDU_HANDLE) ==
+           APP_RESTORED_MSDU_HANDLE)
+        {
+            /* Collector Restored broadcast, nothing to follow up */
+        }
+        else if(pDataCnf->msduHandle & APP_CONFIG_MSDU_HANDLE)
         {
             /* Config Request */
             Cllc_associated_devices_t *pDev;
@@ -1353,6 +1415,9 @@ static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd)
             case Smsgs_cmdIds_sensorData:
                 processSensorData(pDataInd);
                 break;
+            case Smsgs_cmdIds_sensorDataBatch:
+                processSensorDataBatch(pDataInd);
+                break;
             case Smsgs_cmdIds_rampdata:
                 Collector_statistics.sensorMessagesReceived++;
                 break;
@@ -1389,6 +1454,7 @@ static void processStartEvent(void)
     if(Csf_getNetworkInformation(&netInfo))
     {
         uint16_t numDevices = 0;
+        Llc_deviceListItem_t *pDevList = NULL;
 
 #ifdef FEATURE_MAC_SECURITY
         /* Initialize the MAC Security */
@@ -1397,8 +1463,25 @@ static void processStartEvent(void)
 
         numDevices = Csf_getNumDeviceListEntries();
 
+        /* Load the device list in one pass over NV, falling back to
+           reading it device by device if there isn't the memory */
+        if((numDevices > 0) &&
+           (numDevices <= (0xFFFF / sizeof(Llc_deviceListItem_t))))
+        {
+            pDevList = Csf_malloc(numDevices * sizeof(Llc_deviceListItem_t));
+        }
+        if(pDevList != NULL)
+        {
+            numDevices = Csf_getDeviceList(pDevList, numDevices);
+        }
+
         /* Restore with the network and device information */
-        Cllc_restoreNetwork(&netInfo, (uint8_t)numDevices, NULL);
+        Cllc_restoreNetwork(&netInfo, numDevices, pDevList);
+
+        if(pDevList != NULL)
+        {
+            Csf_free(pDevList);
+        }
 
         restarted = true;
 #ifdef FEATURE_SECURE_COMMISSIONING
@@ -1587,164 +1670,299 @@ static void processDeviceTypeResponse(ApiMac_mcpsDataInd_t *pDataInd)
 #endif /* DEVICE_TYPE_MSG */
 
 /*!
- * @brief      Process the Sensor Data message.
+ * @brief      Parse sensor data fields, in order of the frame control mask
+ *             starting with LSB.
  *
- * @param      pDataInd - pointer to the data indication information
+ * @param      pBuf - pointer to the first field
+ * @param      fields - bit mask of Smsgs_dataFields to parse
+ * @param      pMsg - where to put the parsed fields
+ *
+ * @return     pointer to the next byte after the parsed fields
  */
-static void processSensorData(ApiMac_mcpsDataInd_t *pDataInd)
+static uint8_t *parseSensorFields(uint8_t *pBuf, uint16_t fields,
+                                  Smsgs_sensorMsg_t *pMsg)
 {
-    Smsgs_sensorMsg_t sensorData;
-    uint8_t *pBuf = pDataInd->msdu.p;
-
-    memset(&sensorData, 0, sizeof(Smsgs_sensorMsg_t));
-
-    /* Parse the message */
-    sensorData.cmdId = (Smsgs_cmdIds_t)*pBuf++;
-
-    memcpy(sensorData.extAddress, pBuf, SMGS_SENSOR_EXTADDR_LEN);
-    pBuf += SMGS_SENSOR_EXTADDR_LEN;
-
-    sensorData.frameControl = Util_buildUint16(pBuf[0], pBuf[1]);
-    pBuf += 2;
-
-    /* Parse data in order of frameControl mask, starting with LSB */
-    if(sensorData.frameControl & Smsgs_dataFields_tempSensor)
+    if(fields & Smsgs_dataFields_tempSensor)
     {
-        sensorData.tempSensor.ambienceTemp = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->tempSensor.ambienceTemp = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
-        sensorData.tempSensor.objectTemp = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->tempSensor.objectTemp = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_lightSensor)
+    if(fields & Smsgs_dataFields_lightSensor)
     {
-        sensorData.lightSensor.rawData = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->lightSensor.rawData = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_humiditySensor)
+    if(fields & Smsgs_dataFields_humiditySensor)
     {
-        sensorData.humiditySensor.temp = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->humiditySensor.temp = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
-        sensorData.humiditySensor.humidity = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->humiditySensor.humidity = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_msgStats)
+    if(fields & Smsgs_dataFields_msgStats)
     {
-        sensorData.msgStats.joinAttempts = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->msgStats.joinAttempts = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.joinFails = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->msgStats.joinFails = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.msgsAttempted = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->msgStats.msgsAttempted = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.msgsSent = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->msgStats.msgsSent = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.trackingRequests = Util_buildUint16(pBuf[0],
-                                                                pBuf[1]);
+        pMsg->msgStats.trackingRequests = Util_buildUint16(pBuf[0],
+                                                           pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.trackingResponseAttempts = Util_buildUint16(
+        pMsg->msgStats.trackingResponseAttempts = Util_buildUint16(
                         pBuf[0],
                         pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.trackingResponseSent = Util_buildUint16(pBuf[0],
-                                                                    pBuf[1]);
+        pMsg->msgStats.trackingResponseSent = Util_buildUint16(pBuf[0],
+                                                               pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.configRequests = Util_buildUint16(pBuf[0],
-                                                              pBuf[1]);
+        pMsg->msgStats.configRequests = Util_buildUint16(pBuf[0],
+                                                         pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.configResponseAttempts = Util_buildUint16(
+        pMsg->msgStats.configResponseAttempts = Util_buildUint16(
                         pBuf[0],
                         pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.configResponseSent = Util_buildUint16(pBuf[0],
-                                                                  pBuf[1]);
+        pMsg->msgStats.configResponseSent = Util_buildUint16(pBuf[0],
+                                                             pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.channelAccessFailures = Util_buildUint16(pBuf[0],
-                                                                     pBuf[1]);
+        pMsg->msgStats.channelAccessFailures = Util_buildUint16(pBuf[0],
+                                                                pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.macAckFailures = Util_buildUint16(pBuf[0], pBuf[1]);
+        pMsg->msgStats.macAckFailures = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.otherDataRequestFailures = Util_buildUint16(
+        pMsg->msgStats.otherDataRequestFailures = Util_buildUint16(
                         pBuf[0],
                         pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.syncLossIndications = Util_buildUint16(pBuf[0],
-                                                                   pBuf[1]);
+        pMsg->msgStats.syncLossIndications = Util_buildUint16(pBuf[0],
+                                                              pBuf[1]);
+        pBuf += 2;
+        pMsg->msgStats.rxDecryptFailures = Util_buildUint16(pBuf[0],
+                                                            pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.rxDecryptFailures = Util_buildUint16(pBuf[0],
-                                                                 pBuf[1]);
+        pMsg->msgStats.txEncryptFailures = Util_buildUint16(pBuf[0],
+                                                            pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.txEncryptFailures = Util_buildUint16(pBuf[0],
-                                                                 pBuf[1]);
+        pMsg->msgStats.resetCount = Util_buildUint16(pBuf[0],
+                                                     pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.resetCount = Util_buildUint16(pBuf[0],
+        pMsg->msgStats.lastResetReason = Util_buildUint16(pBuf[0],
                                                           pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.lastResetReason = Util_buildUint16(pBuf[0],
-                                                               pBuf[1]);
+        pMsg->msgStats.joinTime = Util_buildUint16(pBuf[0],
+                                                   pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.joinTime = Util_buildUint16(pBuf[0],
-                                                        pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.interimDelay = Util_buildUint16(pBuf[0],
-                                                            pBuf[1]);
+        pMsg->msgStats.interimDelay = Util_buildUint16(pBuf[0],
+                                                       pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.numBroadcastMsgRcvd = Util_buildUint16(pBuf[0],
-                                                                   pBuf[1]);
+        pMsg->msgStats.numBroadcastMsgRcvd = Util_buildUint16(pBuf[0],
+                                                              pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.numBroadcastMsglost = Util_buildUint16(pBuf[0],
-                                                                   pBuf[1]);
+        pMsg->msgStats.numBroadcastMsglost = Util_buildUint16(pBuf[0],
+                                                              pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.avgE2EDelay = Util_buildUint16(pBuf[0],pBuf[1]);
+        pMsg->msgStats.avgE2EDelay = Util_buildUint16(pBuf[0],pBuf[1]);
         pBuf += 2;
-        sensorData.msgStats.worstCaseE2EDelay = Util_buildUint16(pBuf[0],pBuf[1]);
+        pMsg->msgStats.worstCaseE2EDelay = Util_buildUint16(pBuf[0],pBuf[1]);
         pBuf += 2;
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_configSettings)
+    if(fields & Smsgs_dataFields_configSettings)
     {
-        sensorData.configSettings.reportingInterval = Util_buildUint32(pBuf[0],
-                                                                       pBuf[1],
-                                                                       pBuf[2],
-                                                                       pBuf[3]);
+        pMsg->configSettings.reportingInterval = Util_buildUint32(pBuf[0],
+                                                                  pBuf[1],
+                                                                  pBuf[2],
+                                                                  pBuf[3]);
         pBuf += 4;
-        sensorData.configSettings.pollingInterval = Util_buildUint32(pBuf[0],
-                                                                     pBuf[1],
-                                                                     pBuf[2],
-                                                                     pBuf[3]);
-#ifdef LPSTK
+        pMsg->configSettings.pollingInterval = Util_buildUint32(pBuf[0],
+                                                                pBuf[1],
+                                                                pBuf[2],
+                                                                pBuf[3]);
         pBuf += 4;
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_hallEffectSensor)
+#ifdef LPSTK
+    if(fields & Smsgs_dataFields_hallEffectSensor)
     {
-        sensorData.hallEffectSensor.flux = (float) Util_buildUint32(pBuf[0],
-                                                                    pBuf[1],
-                                                                    pBuf[2],
-                                                                    pBuf[3]);
+        pMsg->hallEffectSensor.flux = (float) Util_buildUint32(pBuf[0],
+                                                               pBuf[1],
+                                                               pBuf[2],
+                                                               pBuf[3]);
         pBuf += 4;
     }
-    
-    if(sensorData.frameControl & Smsgs_dataFields_accelSensor)
-    {                  
-        sensorData.accelerometerSensor.xAxis = (int16_t)Util_buildUint16(pBuf[0],
-                                                                pBuf[1]);
+
+    if(fields & Smsgs_dataFields_accelSensor)
+    {
+        pMsg->accelerometerSensor.xAxis = (int16_t)Util_buildUint16(pBuf[0],
+                                                                    pBuf[1]);
         pBuf += 2;
-        sensorData.accelerometerSensor.yAxis = (int16_t)Util_buildUint16(pBuf[0],
-                                                                pBuf[1]);
+        pMsg->accelerometerSensor.yAxis = (int16_t)Util_buildUint16(pBuf[0],
+                                                                    pBuf[1]);
         pBuf += 2;
-        sensorData.accelerometerSensor.zAxis = (int16_t)Util_buildUint16(pBuf[0],
-                                                                pBuf[1]);
+        pMsg->accelerometerSensor.zAxis = (int16_t)Util_buildUint16(pBuf[0],
+                                                                    pBuf[1]);
+        pBuf += 2;
+        pMsg->accelerometerSensor.xTiltDet = *pBuf++;
+        pMsg->accelerometerSensor.yTiltDet = *pBuf++;
+    }
+#endif /* LPSTK */
+
+    if(fields & Smsgs_dataFields_energyStats)
+    {
+        pMsg->energyStats.periodTime = Util_buildUint32(pBuf[0], pBuf[1],
+                                                        pBuf[2], pBuf[3]);
+        pBuf += 4;
+        pMsg->energyStats.txTime = Util_buildUint32(pBuf[0], pBuf[1],
+                                                    pBuf[2], pBuf[3]);
+        pBuf += 4;
+        pMsg->energyStats.rxTime = Util_buildUint32(pBuf[0], pBuf[1],
+                                                    pBuf[2], pBuf[3]);
+        pBuf += 4;
+        pMsg->energyStats.activeTime = Util_buildUint32(pBuf[0], pBuf[1],
+                                                        pBuf[2], pBuf[3]);
+        pBuf += 4;
+        pMsg->energyStats.txFrames = Util_buildUint16(pBuf[0], pBuf[1]);
+        pBuf += 2;
+        pMsg->energyStats.retries = Util_buildUint16(pBuf[0], pBuf[1]);
+        pBuf += 2;
+        pMsg->energyStats.csmaBackoffs = Util_buildUint16(pBuf[0], pBuf[1]);
+        pBuf += 2;
+        pMsg->energyStats.polls = Util_buildUint16(pBuf[0], pBuf[1]);
+        pBuf += 2;
+        pMsg->energyStats.scans = Util_buildUint16(pBuf[0], pBuf[1]);
+        pBuf += 2;
+    }
+
+    if(fields & Smsgs_dataFields_latencyTrace)
+    {
+        pMsg->latencyTrace.traceId = Util_buildUint16(pBuf[0], pBuf[1]);
         pBuf += 2;
-        sensorData.accelerometerSensor.xTiltDet = *pBuf++;
-        sensorData.accelerometerSensor.yTiltDet = *pBuf++;    
+        pMsg->latencyTrace.timestamp = Util_buildUint32(pBuf[0], pBuf[1],
+                                                        pBuf[2], pBuf[3]);
+        pBuf += 4;
+        pMsg->latencyTrace.radioDelay = Util_buildUint16(pBuf[0], pBuf[1]);
+        pBuf += 2;
+    }
 
-#endif /* LPSTK */                               
+    return (pBuf);
+}
+
+/*!
+ * @brief      Length of the sensor data fields parseSensorFields() parses
+ *
+ * @param      fields - bit mask of Smsgs_dataFields
+ *
+ * @return     length of the fields in bytes
+ */
+static uint16_t sensorFieldsLen(uint16_t fields)
+{
+    uint16_t len = 0;
+
+    if(fields & Smsgs_dataFields_tempSensor)
+    {
+        len += SMSGS_SENSOR_TEMP_LEN;
+    }
+    if(fields & Smsgs_dataFields_lightSensor)
+    {
+        len += SMSGS_SENSOR_LIGHT_LEN;
+    }
+    if(fields & Smsgs_dataFields_humiditySensor)
+    {
+        len += SMSGS_SENSOR_HUMIDITY_LEN;
+    }
+    if(fields & Smsgs_dataFields_msgStats)
+    {
+        len += SMSGS_SENSOR_MSG_STATS_LEN;
+    }
+    if(fields & Smsgs_dataFields_configSettings)
+    {
+        len += SMSGS_SENSOR_CONFIG_SETTINGS_LEN;
+    }
+#ifdef LPSTK
+    if(fields & Smsgs_dataFields_hallEffectSensor)
+    {
+        len += sizeof(Smsgs_hallEffectSensorField_t);
+    }
+    if(fields & Smsgs_dataFields_accelSensor)
+    {
+        len += sizeof(Smsgs_accelSensorField_t);
+    }
+#endif /* LPSTK */
+    if(fields & Smsgs_dataFields_energyStats)
+    {
+        len += SMSGS_SENSOR_ENERGY_STATS_LEN;
+    }
+    if(fields & Smsgs_dataFields_latencyTrace)
+    {
+        len += SMSGS_SENSOR_LATENCY_TRACE_LEN;
+    }
+
+    return (len);
+}
+
+/*!
+ * @brief      Process the Sensor Data message.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processSensorData(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    Smsgs_sensorMsg_t sensorData;
+    uint8_t *pBuf = pDataInd->msdu.p;
+
+    memset(&sensorData, 0, sizeof(Smsgs_sensorMsg_t));
+
+    /* Parse the message */
+    sensorData.cmdId = (Smsgs_cmdIds_t)*pBuf++;
+
+    memcpy(sensorData.extAddress, pBuf, SMGS_SENSOR_EXTADDR_LEN);
+    pBuf += SMGS_SENSOR_EXTADDR_LEN;
+
+    sensorData.frameControl = Util_buildUint16(pBuf[0], pBuf[1]);
+    pBuf += 2;
+
+    if(sensorData.frameControl & Smsgs_dataFields_compactEncoding)
+    {
+        pBuf = parseCompactSensorFields(pBuf,
+                                        (pDataInd->msdu.p + pDataInd->msdu.len),
+                                        &pDataInd->srcAddr, &sensorData);
+        if(pBuf == NULL)
+        {
+            /* Unknown version or truncated message, nothing to report */
+            processDataRetry(&(pDataInd->srcAddr));
+            return;
+        }
+    }
+    else
+    {
+        parseSensorFields(pBuf, sensorData.frameControl, &sensorData);
     }
 
     Collector_statistics.sensorMessagesReceived++;
 
+    if(sensorData.frameControl & Smsgs_dataFields_msgStats)
+    {
+        Cllc_associated_devices_t *pDev = findDevice(&pDataInd->srcAddr);
+
+        /* Failures the sensor had count against the current channel */
+        if(pDev != NULL)
+        {
+            Cllc_updateLinkStats(pDev->shortAddr,
+                                 sensorData.msgStats.msgsAttempted,
+                                 (sensorData.msgStats.channelAccessFailures +
+                                  sensorData.msgStats.macAckFailures));
+        }
+    }
+
 #ifdef USE_DMM
     //search for device in device list and update SensorData field
     Cllc_associated_devices_t *currentDev;
@@ -1766,6 +1984,370 @@ static void processSensorData(ApiMac_mcpsDataInd_t *pDataInd)
     processDataRetry(&(pDataInd->srcAddr));
 }
 
+/*!
+ * @brief      Parse the data fields of a compact Sensor Data message.
+ *             The compact encoding flag is removed from the frame control
+ *             field, as is the message statistics flag if the statistics
+ *             are relative to a report this collector doesn't have.
+ *
+ * @param      pBuf - pointer to the compact header after the frame control
+ * @param      pEnd - pointer to the byte after the message
+ * @param      pSrcAddr - address of the sending device
+ * @param      pMsg - pointer to the sensor message to fill in
+ *
+ * @return     pointer to the byte following the parsed fields,
+ *             NULL if the message couldn't be parsed.
+ */
+static uint8_t *parseCompactSensorFields(uint8_t *pBuf, uint8_t *pEnd,
+                                         ApiMac_sAddr_t *pSrcAddr,
+                                         Smsgs_sensorMsg_t *pMsg)
+{
+    Cllc_associated_devices_t *pDev;
+    Collector_compactBase_t *pBase = NULL;
+    uint16_t fields;
+    uint32_t value;
+    int32_t sValue;
+    uint8_t byte;
+    uint8_t seq;
+    uint8_t baseSeq;
+
+    if(((pBuf + SMSGS_COMPACT_HDR_LEN) > pEnd)
+       || (pBuf[0] != SMSGS_COMPACT_VERSION))
+    {
+        return (NULL);
+    }
+    seq = pBuf[1];
+    baseSeq = pBuf[2];
+    pBuf += SMSGS_COMPACT_HDR_LEN;
+
+    pMsg->frameControl &= ~Smsgs_dataFields_compactEncoding;
+    fields = pMsg->frameControl;
+
+    pDev = findDevice(pSrcAddr);
+    if(pDev != NULL)
+    {
+        pBase = &compactBases[pDev - Cllc_associatedDevList];
+        if(pBase->shortAddr != pDev->shortAddr)
+        {
+            /* New device in this slot, forget the old base */
+            memset(pBase, 0, sizeof(Collector_compactBase_t));
+            pBase->shortAddr = pDev->shortAddr;
+        }
+    }
+
+    /* Parse data in order of frameControl mask, starting with LSB */
+    if(fields & Smsgs_dataFields_tempSensor)
+    {
+        pBuf = parseZigZag(pBuf, pEnd, &sValue);
+        pMsg->tempSensor.ambienceTemp = (int16_t)sValue;
+        pBuf = parseZigZag(pBuf, pEnd, &sValue);
+        pMsg->tempSensor.objectTemp = (int16_t)sValue;
+    }
+
+    if(fields & Smsgs_dataFields_lightSensor)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->lightSensor.rawData = (uint16_t)value;
+    }
+
+    if(fields & Smsgs_dataFields_humiditySensor)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->humiditySensor.temp = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->humiditySensor.humidity = (uint16_t)value;
+    }
+
+    if(fields & Smsgs_dataFields_msgStats)
+    {
+        uint16_t stats[COMPACT_NUM_STATS];
+        bool haveBase = (baseSeq == SMSGS_COMPACT_NO_BASE)
+                        || ((pBase != NULL) && (pBase->seq == baseSeq));
+        uint8_t numStats;
+        uint8_t i;
+
+        pBuf = parseByte(pBuf, pEnd, &numStats);
+        for(i = 0; (i < numStats) && (pBuf != NULL); i++)
+        {
+            /* Skip statistics this collector doesn't know about */
+            pBuf = parseZigZag(pBuf, pEnd, &sValue);
+            if(i < COMPACT_NUM_STATS)
+            {
+                stats[i] = (uint16_t)sValue;
+                if(baseSeq != SMSGS_COMPACT_NO_BASE)
+                {
+                    stats[i] += (haveBase == true) ? pBase->stats[i] : 0;
+                }
+            }
+        }
+        if(pBuf == NULL)
+        {
+            /* Truncated, keep the base for the next report */
+            return (NULL);
+        }
+        for(; i < COMPACT_NUM_STATS; i++)
+        {
+            stats[i] = 0;
+        }
+
+        if(haveBase == true)
+        {
+            memcpy(&pMsg->msgStats, stats, sizeof(Smsgs_msgStatsField_t));
+            if(pBase != NULL)
+            {
+                memcpy(pBase->stats, stats, sizeof(pBase->stats));
+                pBase->seq = seq;
+            }
+        }
+        else
+        {
+            /* Wait for the next absolute statistics */
+            pMsg->frameControl &= ~Smsgs_dataFields_msgStats;
+        }
+    }
+
+    if(fields & Smsgs_dataFields_configSettings)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->configSettings.reportingInterval = value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->configSettings.pollingInterval = value;
+    }
+
+#ifdef LPSTK
+    if(fields & Smsgs_dataFields_hallEffectSensor)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->hallEffectSensor.flux = (float)value;
+    }
+
+    if(fields & Smsgs_dataFields_accelSensor)
+    {
+        pBuf = parseZigZag(pBuf, pEnd, &sValue);
+        pMsg->accelerometerSensor.xAxis = (int16_t)sValue;
+        pBuf = parseZigZag(pBuf, pEnd, &sValue);
+        pMsg->accelerometerSensor.yAxis = (int16_t)sValue;
+        pBuf = parseZigZag(pBuf, pEnd, &sValue);
+        pMsg->accelerometerSensor.zAxis = (int16_t)sValue;
+        pBuf = parseByte(pBuf, pEnd, &byte);
+        pMsg->accelerometerSensor.xTiltDet = byte;
+        pBuf = parseByte(pBuf, pEnd, &byte);
+        pMsg->accelerometerSensor.yTiltDet = byte;
+    }
+#endif /* LPSTK */
+
+    if(fields & Smsgs_dataFields_energyStats)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->energyStats.periodTime);
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->energyStats.txTime);
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->energyStats.rxTime);
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->energyStats.activeTime);
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.txFrames = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.retries = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.csmaBackoffs = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.polls = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.scans = (uint16_t)value;
+    }
+
+    if(fields & Smsgs_dataFields_latencyTrace)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->latencyTrace.traceId = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->latencyTrace.timestamp);
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->latencyTrace.radioDelay = (uint16_t)value;
+    }
+
+    /* NULL if the message ran out */
+    return (pBuf);
+}
+
+/*!
+ * @brief      Parse a varint, 7 bits per byte starting with the least
+ *             significant bits.  Bit 7 is set in all but the last byte.
+ *
+ * @param      pBuf - pointer to the varint, NULL if the message already
+ *                    ran out
+ * @param      pEnd - pointer to the byte after the message
+ * @param      pValue - where to put the value
+ *
+ * @return     pointer to the byte following the varint,
+ *             NULL if the message ends before it does.
+ */
+static uint8_t *parseVarint(uint8_t *pBuf, uint8_t *pEnd, uint32_t *pValue)
+{
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    uint8_t i;
+
+    *pValue = 0;
+    if(pBuf == NULL)
+    {
+        return (NULL);
+    }
+
+    for(i = 0; i < SMSGS_VARINT_MAX_LEN; i++)
+    {
+        if(pBuf >= pEnd)
+        {
+            return (NULL);
+        }
+        value |= (uint32_t)(*pBuf & 0x7F) << shift;
+        shift += 7;
+        if((*pBuf++ & 0x80) == 0)
+        {
+            break;
+        }
+    }
+
+    *pValue = value;
+    return (pBuf);
+}
+
+/*!
+ * @brief      Parse a zig-zag encoded varint.
+ *
+ * @param      pBuf - pointer to the varint, NULL if the message already
+ *                    ran out
+ * @param      pEnd - pointer to the byte after the message
+ * @param      pValue - where to put the signed value
+ *
+ * @return     pointer to the byte following the varint,
+ *             NULL if the message ends before it does.
+ */
+static uint8_t *parseZigZag(uint8_t *pBuf, uint8_t *pEnd, int32_t *pValue)
+{
+    uint32_t value;
+
+    pBuf = parseVarint(pBuf, pEnd, &value);
+    *pValue = (int32_t)((value >> 1) ^ (~(value & 1) + 1));
+
+    return (pBuf);
+}
+
+/*!
+ * @brief      Parse a byte.
+ *
+ * @param      pBuf - pointer to the byte, NULL if the message already
+ *                    ran out
+ * @param      pEnd - pointer to the byte after the message
+ * @param      pValue - where to put the byte
+ *
+ * @return     pointer to the following byte,
+ *             NULL if the message ends before it.
+ */
+static uint8_t *parseByte(uint8_t *pBuf, uint8_t *pEnd, uint8_t *pValue)
+{
+    *pValue = 0;
+    if((pBuf == NULL) || (pBuf >= pEnd))
+    {
+        return (NULL);
+    }
+
+    *pValue = *pBuf++;
+    return (pBuf);
+}
+
+/*!
+ * @brief      Process the Sensor Data Batch message.  Each sample is
+ *             reported as its own sensor data message, oldest first, and
+ *             the report fields are only reported with the last sample.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processSensorDataBatch(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    Smsgs_sensorMsg_t sensorData;
+    uint8_t *pBuf = pDataInd->msdu.p;
+    uint8_t *pEnd = pDataInd->msdu.p + pDataInd->msdu.len;
+    uint16_t frameControl;
+    uint16_t sampleFields;
+    uint16_t sampleLen;
+    uint8_t numSamples;
+    uint8_t i;
+
+    /* Make sure the message has a complete header */
+    if(pDataInd->msdu.len < SMSGS_BASIC_SENSOR_BATCH_LEN)
+    {
+        return;
+    }
+
+    memset(&sensorData, 0, sizeof(Smsgs_sensorMsg_t));
+
+    /* Parse the message */
+    sensorData.cmdId = (Smsgs_cmdIds_t)*pBuf++;
+
+    memcpy(sensorData.extAddress, pBuf, SMGS_SENSOR_EXTADDR_LEN);
+    pBuf += SMGS_SENSOR_EXTADDR_LEN;
+
+    frameControl = Util_buildUint16(pBuf[0], pBuf[1]);
+    pBuf += 2;
+    sampleFields = frameControl & ~SMSGS_BATCH_REPORT_FIELDS;
+
+    numSamples = *pBuf++;
+    sampleLen = SMSGS_BATCH_SAMPLE_AGE_LEN + sensorFieldsLen(sampleFields);
+
+    /* The report fields are sent once, ahead of the samples */
+    if((pEnd - pBuf) <
+       sensorFieldsLen(frameControl & SMSGS_BATCH_REPORT_FIELDS))
+    {
+        /* Truncated message, nothing to report */
+        processDataRetry(&(pDataInd->srcAddr));
+        return;
+    }
+    pBuf = parseSensorFields(pBuf, (frameControl & SMSGS_BATCH_REPORT_FIELDS),
+                             &sensorData);
+
+    for(i = 0; i < numSamples; i++)
+    {
+        if((pEnd - pBuf) < sampleLen)
+        {
+            /* Truncated message, drop the rest */
+            break;
+        }
+
+        sensorData.sampleAge = (uint32_t)Util_buildUint16(pBuf[0], pBuf[1])
+                               * SMSGS_BATCH_SAMPLE_AGE_RES;
+        pBuf += SMSGS_BATCH_SAMPLE_AGE_LEN;
+
+        pBuf = parseSensorFields(pBuf, sampleFields, &sensorData);
+
+        sensorData.frameControl = (i == (numSamples - 1)) ?
+                        frameControl : sampleFields;
+
+        Collector_statistics.sensorMessagesReceived++;
+
+#ifdef USE_DMM
+        if(i == (numSamples - 1))
+        {
+            //search for device in device list and update SensorData field
+            Cllc_associated_devices_t *currentDev;
+            currentDev = findDevice(&pDataInd->srcAddr);
+            //if device found and listDiscovery not in progress
+            if(currentDev && !listDiscovery)
+            {
+                //UpdateDevList with current tempSensorData
+                currentDev->sensorData =
+                    sensorData.tempSensor.ambienceTemp & 0xFF;
+                //Update BLE application with new sensorData
+                RemoteDisplay_deviceUpdate(currentDev->shortAddr);
+            }
+        }
+#endif
+
+        /* Report the sample */
+        Csf_deviceSensorDataUpdate(&pDataInd->srcAddr, pDataInd->rssi,
+                                   &sensorData);
+    }
+
+    processDataRetry(&(pDataInd->srcAddr));
+}
+
 /*!
  * @brief      Find the associated device table entry matching pAddr.
  *
@@ -1878,6 +2460,10 @@ static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType)
     {
         msduHandle |= APP_BROADCAST_MSDU_HANDLE;
     }
+    else if(msgType == Smsgs_cmdIds_collectorRestored)
+    {
+        msduHandle |= APP_RESTORED_MSDU_HANDLE;
+    }
 
     return (msduHandle);
 }
@@ -1970,7 +2556,9 @@ static bool sendMsg(Smsgs_cmdIds_t type, uint16_t dstShortAddr, bool rxOnIdle,
 }
 
 /*!
- * @brief      Send MAC broadcast data request. Only supported in FH mode.
+ * @brief      Send MAC broadcast data request. In FH mode it goes out on the
+ *             broadcast schedule, otherwise to the broadcast short address,
+ *             which only devices with the receiver on hear.
  *
  * @param      type - message type
  * @param      len - length of payload
@@ -1981,15 +2569,18 @@ static void sendBroadcastMsg(Smsgs_cmdIds_t type, uint16_t len,
 {
     ApiMac_mcpsDataReq_t dataReq;
 
-    /* Only supported for FH mode */
-    if(!fhEnabled)
-    {
-        return;
-    }
     /* Fill the data request field */
     memset(&dataReq, 0, sizeof(ApiMac_mcpsDataReq_t));
 
-    dataReq.dstAddr.addrMode = ApiMac_addrType_none;
+    if(fhEnabled)
+    {
+        dataReq.dstAddr.addrMode = ApiMac_addrType_none;
+    }
+    else
+    {
+        dataReq.dstAddr.addrMode = ApiMac_addrType_short;
+        dataReq.dstAddr.addr.shortAddr = APIMAC_SHORT_ADDR_BROADCAST;
+    }
     dataReq.srcAddrMode = ApiMac_addrType_short;
 
     dataReq.dstPanId = devicePanId;
@@ -2288,6 +2879,19 @@ static void generateBroadcastCmd(void)
                      buffer);
 }
 
+/*!
+ * @brief      Generate Collector Restored Message
+ */
+static void generateRestoredMsg(void)
+{
+    uint8_t buffer[SMSGS_COLLECTOR_RESTORED_MSG_LENGTH];
+
+    buffer[0] = (uint8_t)Smsgs_cmdIds_collectorRestored;
+
+    sendBroadcastMsg(Smsgs_cmdIds_collectorRestored,
+                     SMSGS_COLLECTOR_RESTORED_MSG_LENGTH, buffer);
+}
+
 /*!
  * @brief      Generate Tracking Requests for a device
  *
@@ -2538,11 +3142,13 @@ void smSuccessCMProcessCb(ApiMac_deviceDescriptor_t *devInfo, bool keyRefreshmen
  */
 static void orphanIndCb(ApiMac_mlmeOrphanInd_t *pData)
 {
-    uint16_t shortAddr = Csf_getDeviceShort(&pData->orphanAddress);
     /* get the short address of the device */
-    if(CSF_INVALID_SHORT_ADDR != shortAddr)
+    Cllc_associated_devices_t *pDev =
+                    Cllc_findDeviceExt(&pData->orphanAddress);
+
+    if(pDev != NULL)
     {
-        Csf_IndicateOrphanReJoin(shortAddr);
+        Csf_IndicateOrphanReJoin(pDev->shortAddr);
     }
 
 }
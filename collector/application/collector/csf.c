@@ -88,6 +88,10 @@
 
 #ifdef OSAL_PORT2TIRTOS
 #include "osal_port.h"
+#ifdef OSAL_PORT_CS_STATS
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+#endif
 #else
 #include "icall.h"
 #endif
@@ -104,6 +108,14 @@
 /* Initial timeout value for the tracking clock */
 #define TRACKING_INIT_TIMEOUT_VALUE 100
 
+#if !defined(CSF_CLOCK_TOLERANCE)
+/*
+ Milliseconds a clock expiration may be delayed by so it is handled in the
+ same wakeup as another one (at most a quarter of the clock's timeout)
+ */
+#define CSF_CLOCK_TOLERANCE 250
+#endif
+
 /* NV Item ID - the device's network information */
 #define CSF_NV_NETWORK_INFO_ID 0x0001
 /* NV Item ID - the number of black list entries */
@@ -137,6 +149,36 @@
  */
 #define CSF_MAX_DEVICELIST_IDS (2*CONFIG_MAX_DEVICES)
 
+#if !defined(CSF_ADMIT_QUEUE_SIZE)
+/*
+ Number of newly joined devices kept in RAM until their device list records
+ are written to NV, so association responses don't wait on the NV writes
+ */
+#define CSF_ADMIT_QUEUE_SIZE 16
+#endif
+
+#if !defined(CSF_ADMIT_PERSIST_DELAY)
+/*
+ Milliseconds from the first queued device to writing the queue to NV,
+ joins arriving in the meantime are written in the same batch
+ */
+#define CSF_ADMIT_PERSIST_DELAY 500
+#endif
+
+#if !defined(CSF_ADMIT_RATE)
+/*
+ Join storm limit, new devices admitted per second once CSF_ADMIT_BURST
+ have joined back to back. Association requests over the limit aren't
+ answered, the device retries after its scan backoff. 0 for no limit.
+ */
+#define CSF_ADMIT_RATE 0
+#endif
+
+#if !defined(CSF_ADMIT_BURST)
+/* New devices admitted back to back before CSF_ADMIT_RATE applies */
+#define CSF_ADMIT_BURST 16
+#endif
+
 /* timeout value for trickle timer initialization */
 #define TRICKLE_TIMEOUT_VALUE       20
 
@@ -193,35 +235,43 @@ static ICall_Semaphore collectorSem;
 #endif
 
 /* Clock/timer resources */
-static Clock_Struct trackingClkStruct;
-static Clock_Handle trackingClkHandle;
-static Clock_Struct broadcastClkStruct;
-static Clock_Handle broadcastClkHandle;
+static Timer_WheelEntry trackingClk;
+static Timer_WheelEntry broadcastClk;
 
 /* Clock/timer resources for CLLC */
 /* trickle timer */
-STATIC Clock_Struct tricklePAClkStruct;
-STATIC Clock_Handle tricklePAClkHandle;
-STATIC Clock_Struct tricklePCClkStruct;
-STATIC Clock_Handle tricklePCClkHandle;
+STATIC Timer_WheelEntry tricklePAClk;
+STATIC Timer_WheelEntry tricklePCClk;
 
 /* timer for join permit */
-STATIC Clock_Struct joinClkStruct;
-STATIC Clock_Handle joinClkHandle;
+STATIC Timer_WheelEntry joinClk;
 
 /* timer for config request delay */
-STATIC Clock_Struct configClkStruct;
-STATIC Clock_Handle configClkHandle;
+STATIC Timer_WheelEntry configClk;
+
+/* timer for background channel scans */
+STATIC Timer_WheelEntry chanScanClk;
 
 /* timer for LED blink timeout*/
-STATIC Clock_Struct identifyClkStruct;
-STATIC Clock_Handle identifyClkHandle;
+STATIC Timer_WheelEntry identifyClk;
 
 #ifdef USE_DMM
-STATIC Clock_Struct provisioningClkStruct;
-STATIC Clock_Handle provisioningClkHandle;
+STATIC Timer_WheelEntry provisioningClk;
 #endif /* USE_DMM */
 
+/* timer for writing the admission queue to NV */
+static Timer_WheelEntry admitClk;
+
+/* Joined devices not yet written to the NV device list */
+static Llc_deviceListItem_t admitQueue[CSF_ADMIT_QUEUE_SIZE];
+static uint8_t admitCount = 0;
+
+#if CSF_ADMIT_RATE > 0
+/* Join rate limit token bucket, in thousandths of a device */
+static uint32_t admitTokens = CSF_ADMIT_BURST * 1000;
+static uint32_t admitLastTicks = 0;
+#endif
+
 /* NV Function Pointers */
 static NVINTF_nvFuncts_t *pNV = NULL;
 
@@ -254,6 +304,9 @@ CUI_clientHandle_t csfCuiHndl;
 uint32_t collectorStatusLine;
 uint32_t deviceStatusLine;
 uint32_t numJoinDevStatusLine;
+#ifdef OSAL_PORT_CS_STATS
+uint32_t csStatsStatusLine;
+#endif
 
 static uint16_t SelectedSensor;
 static uint32_t reportInterval;
@@ -265,13 +318,18 @@ static uint8_t Csf_sensorAction;
  *****************************************************************************/
 
 static void processTrackingTimeoutCallback(UArg a0);
+#if defined(OSAL_PORT_CS_STATS) && !defined(POWER_MEAS)
+static void displayCSStats(void);
+#endif
 static void processBroadcastTimeoutCallback(UArg a0);
 static void processKeyChangeCallback(uint32_t _btn, Button_EventMask _events);
 static void processPATrickleTimeoutCallback(UArg a0);
 static void processPCTrickleTimeoutCallback(UArg a0);
 static void processJoinTimeoutCallback(UArg a0);
+static void processChanScanTimeoutCallback(UArg a0);
 static void processConfigTimeoutCallback(UArg a0);
 static void processidentifyTimeoutCallback(UArg a0);
+static void processAdmitTimeoutCallback(UArg a0);
 static uint16_t getNumActiveDevices(void);
 #if defined(USE_DMM)
 static void processProvisioningCallback(UArg a0);
@@ -279,8 +337,13 @@ static void processProvisioningCallback(UArg a0);
 static bool addDeviceListItem(Llc_deviceListItem_t *pItem, bool *pNewDevice);
 static void updateDeviceListItem(Llc_deviceListItem_t *pItem);
 static int findDeviceListIndex(ApiMac_sAddrExt_t *pAddr);
-static int findUnusedDeviceListIndex(void);
+static uint16_t readNumDeviceListEntries(void);
 static void saveNumDeviceListEntries(uint16_t numEntries);
+static int findAdmitIndex(ApiMac_sAddrExt_t *pAddr);
+static void removeAdmitItem(int index);
+static void persistAdmitQueue(void);
+static void removeListedDevice(Llc_deviceListItem_t *pItem,
+                               bool addToBlackList);
 static int findBlackListIndex(ApiMac_sAddr_t *pAddr);
 static int findUnusedBlackListIndex(void);
 static uint16_t getNumBlackListEntries(void);
@@ -419,12 +482,18 @@ void Csf_init(void *sem)
     /* Save off the semaphore */
     collectorSem = sem;
 
+    Timer_wheelConstruct(&admitClk, processAdmitTimeoutCallback,
+                         CSF_ADMIT_PERSIST_DELAY, CSF_CLOCK_TOLERANCE, 0);
+
     /* Open UI for key and LED */
     CUI_clientParamsInit(&clientParams);
 
     strncpy(clientParams.clientName, "154 Collector", MAX_CLIENT_NAME_LEN);
     clientParams.maxStatusLines = 3;
 
+#ifdef OSAL_PORT_CS_STATS
+    clientParams.maxStatusLines++;
+#endif
 #ifdef FEATURE_SECURE_COMMISSIONING
     clientParams.maxStatusLines++;
 #endif
@@ -481,6 +550,9 @@ void Csf_init(void *sem)
     CUI_statusLineResourceRequest(csfCuiHndl, "Status", &collectorStatusLine);
     CUI_statusLineResourceRequest(csfCuiHndl, "Device Status", &deviceStatusLine);
     CUI_statusLineResourceRequest(csfCuiHndl, "Number of Joined Devices", &numJoinDevStatusLine);
+#ifdef OSAL_PORT_CS_STATS
+    CUI_statusLineResourceRequest(csfCuiHndl, "OSAL CS", &csStatsStatusLine);
+#endif
 #endif /* POWER_MEAS */
 
 #if !defined(AUTO_START)
@@ -642,6 +714,14 @@ void Csf_processEvents(void)
         Util_clearEvent(&Csf_events, COLLECTOR_SENSOR_ACTION_EVT);
     }
 
+    if(Csf_events & CSF_ADMIT_EVT)
+    {
+        persistAdmitQueue();
+
+        /* Clear the event */
+        Util_clearEvent(&Csf_events, CSF_ADMIT_EVT);
+    }
+
 #if defined(MT_CSF)
     MTCSF_displayStatistics();
 #endif
@@ -839,6 +919,9 @@ void Csf_deviceSensorDataUpdate(ApiMac_sAddr_t *pSrcAddr, int8_t rssi,
     CUI_statusLinePrintf(csfCuiHndl, deviceStatusLine, "Sensor - Addr=0x%04x, Temp=%d, RSSI=%d",
                          pSrcAddr->addr.shortAddr, pMsg->tempSensor.ambienceTemp, rssi);
     CUI_statusLinePrintf(csfCuiHndl, numJoinDevStatusLine, "%x", getNumActiveDevices());
+#ifdef OSAL_PORT_CS_STATS
+    displayCSStats();
+#endif
 
 #endif /* endif for POWER_MEAS */
 
@@ -932,8 +1015,8 @@ void Csf_identifyLED(uint16_t identifyTime)
     CUI_ledBlink(csfCuiHndl, CONFIG_LED_GREEN, 3);
 
     /* Setup timer */
-    Timer_setTimeout(identifyClkHandle, identifyTime);
-    Timer_start(&identifyClkStruct);
+    Timer_wheelSetTimeout(&identifyClk, identifyTime);
+    Timer_wheelStart(&identifyClk);
 }
 
 /*!
@@ -1001,12 +1084,8 @@ void Csf_stateChangeUpdate(Cllc_states_t state)
 void Csf_initializeTrackingClock(void)
 {
     /* Initialize the timers needed for this application */
-    trackingClkHandle = Timer_construct(&trackingClkStruct,
-                                        processTrackingTimeoutCallback,
-                                        TRACKING_INIT_TIMEOUT_VALUE,
-                                        0,
-                                        false,
-                                        0);
+    Timer_wheelConstruct(&trackingClk, processTrackingTimeoutCallback,
+                         TRACKING_INIT_TIMEOUT_VALUE, CSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1017,12 +1096,8 @@ void Csf_initializeTrackingClock(void)
 void Csf_initializeBroadcastClock(void)
 {
     /* Initialize the timers needed for this application */
-    broadcastClkHandle = Timer_construct(&broadcastClkStruct,
-                                        processBroadcastTimeoutCallback,
-                                        TRACKING_INIT_TIMEOUT_VALUE,
-                                        0,
-                                        false,
-                                        0);
+    Timer_wheelConstruct(&broadcastClk, processBroadcastTimeoutCallback,
+                         TRACKING_INIT_TIMEOUT_VALUE, CSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1033,19 +1108,11 @@ void Csf_initializeBroadcastClock(void)
 void Csf_initializeTrickleClock(void)
 {
     /* Initialize trickle timer */
-    tricklePAClkHandle = Timer_construct(&tricklePAClkStruct,
-                                         processPATrickleTimeoutCallback,
-                                         TRICKLE_TIMEOUT_VALUE,
-                                         0,
-                                         false,
-                                         0);
+    Timer_wheelConstruct(&tricklePAClk, processPATrickleTimeoutCallback,
+                         TRICKLE_TIMEOUT_VALUE, CSF_CLOCK_TOLERANCE, 0);
 
-    tricklePCClkHandle = Timer_construct(&tricklePCClkStruct,
-                                         processPCTrickleTimeoutCallback,
-                                         TRICKLE_TIMEOUT_VALUE,
-                                         0,
-                                         false,
-                                         0);
+    Timer_wheelConstruct(&tricklePCClk, processPCTrickleTimeoutCallback,
+                         TRICKLE_TIMEOUT_VALUE, CSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1056,12 +1123,20 @@ void Csf_initializeTrickleClock(void)
 void Csf_initializeJoinPermitClock(void)
 {
     /* Initialize join permit timer */
-    joinClkHandle = Timer_construct(&joinClkStruct,
-                                    processJoinTimeoutCallback,
-                                    JOIN_TIMEOUT_VALUE,
-                                    0,
-                                    false,
-                                    0);
+    Timer_wheelConstruct(&joinClk, processJoinTimeoutCallback,
+                         JOIN_TIMEOUT_VALUE, CSF_CLOCK_TOLERANCE, 0);
+}
+
+/*!
+ Initialize the clock for background channel scans
+
+ Public function defined in csf.h
+ */
+void Csf_initializeChanScanClock(void)
+{
+    /* Initialize channel scan timer */
+    Timer_wheelConstruct(&chanScanClk, processChanScanTimeoutCallback,
+                         JOIN_TIMEOUT_VALUE, CSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1072,12 +1147,8 @@ void Csf_initializeJoinPermitClock(void)
 void Csf_initializeConfigClock(void)
 {
     /* Initialize join permit timer */
-    configClkHandle = Timer_construct(&configClkStruct,
-                                    processConfigTimeoutCallback,
-                                    CONFIG_TIMEOUT_VALUE,
-                                    0,
-                                    false,
-                                    0);
+    Timer_wheelConstruct(&configClk, processConfigTimeoutCallback,
+                         CONFIG_TIMEOUT_VALUE, CSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1088,12 +1159,8 @@ void Csf_initializeConfigClock(void)
 void Csf_initializeIdentifyClock(void)
 {
     /* Initialize identify clock timer */
-    identifyClkHandle = Timer_construct(&identifyClkStruct,
-                                    processidentifyTimeoutCallback,
-                                    10,
-                                    0,
-                                    false,
-                                    0);
+    Timer_wheelConstruct(&identifyClk, processidentifyTimeoutCallback,
+                         10, CSF_CLOCK_TOLERANCE, 0);
 }
 
 
@@ -1105,16 +1172,16 @@ void Csf_initializeIdentifyClock(void)
 void Csf_setTrackingClock(uint32_t trackingTime)
 {
     /* Stop the Tracking timer */
-    if(Timer_isActive(&trackingClkStruct) == true)
+    if(Timer_wheelIsActive(&trackingClk) == true)
     {
-        Timer_stop(&trackingClkStruct);
+        Timer_wheelStop(&trackingClk);
     }
 
     if(trackingTime)
     {
         /* Setup timer */
-        Timer_setTimeout(trackingClkHandle, trackingTime);
-        Timer_start(&trackingClkStruct);
+        Timer_wheelSetTimeout(&trackingClk, trackingTime);
+        Timer_wheelStart(&trackingClk);
     }
 }
 
@@ -1126,16 +1193,16 @@ void Csf_setTrackingClock(uint32_t trackingTime)
 void Csf_setBroadcastClock(uint32_t broadcastTime)
 {
     /* Stop the Tracking timer */
-    if(Timer_isActive(&broadcastClkStruct) == true)
+    if(Timer_wheelIsActive(&broadcastClk) == true)
     {
-        Timer_stop(&broadcastClkStruct);
+        Timer_wheelStop(&broadcastClk);
     }
 
     if(broadcastTime)
     {
         /* Setup timer */
-        Timer_setTimeout(broadcastClkHandle, broadcastTime);
-        Timer_start(&broadcastClkStruct);
+        Timer_wheelSetTimeout(&broadcastClk, broadcastTime);
+        Timer_wheelStart(&broadcastClk);
     }
 }
 
@@ -1146,44 +1213,34 @@ void Csf_setBroadcastClock(uint32_t broadcastTime)
  */
 void Csf_setTrickleClock(uint32_t trickleTime, uint8_t frameType)
 {
-    uint16_t randomNum = 0;
-    uint16_t randomTime = 0;
-
-    if(trickleTime > 0)
-    {
-        randomNum = ((ApiMac_randomByte() << 8) + ApiMac_randomByte());
-        randomTime = (trickleTime >> 1) +
-                      (randomNum % (trickleTime >> 1));
-    }
-
     if(frameType == ApiMac_wisunAsyncFrame_advertisement)
     {
         /* Stop the PA trickle timer */
-        if(Timer_isActive(&tricklePAClkStruct) == true)
+        if(Timer_wheelIsActive(&tricklePAClk) == true)
         {
-            Timer_stop(&tricklePAClkStruct);
+            Timer_wheelStop(&tricklePAClk);
         }
 
         if(trickleTime > 0)
         {
             /* Setup timer */
-            Timer_setTimeout(tricklePAClkHandle, randomTime);
-            Timer_start(&tricklePAClkStruct);
+            Timer_wheelSetTimeout(&tricklePAClk, trickleTime);
+            Timer_wheelStart(&tricklePAClk);
         }
     }
     else if(frameType == ApiMac_wisunAsyncFrame_config)
     {
         /* Stop the PC trickle timer */
-        if(Timer_isActive(&tricklePCClkStruct) == true)
+        if(Timer_wheelIsActive(&tricklePCClk) == true)
         {
-            Timer_stop(&tricklePCClkStruct);
+            Timer_wheelStop(&tricklePCClk);
         }
 
         if(trickleTime > 0)
         {
             /* Setup timer */
-            Timer_setTimeout(tricklePCClkHandle, randomTime);
-            Timer_start(&tricklePCClkStruct);
+            Timer_wheelSetTimeout(&tricklePCClk, trickleTime);
+            Timer_wheelStart(&tricklePCClk);
         }
     }
 }
@@ -1196,16 +1253,37 @@ void Csf_setTrickleClock(uint32_t trickleTime, uint8_t frameType)
 void Csf_setJoinPermitClock(uint32_t joinDuration)
 {
     /* Stop the join timer */
-    if(Timer_isActive(&joinClkStruct) == true)
+    if(Timer_wheelIsActive(&joinClk) == true)
     {
-        Timer_stop(&joinClkStruct);
+        Timer_wheelStop(&joinClk);
     }
 
     if(joinDuration != 0)
     {
         /* Setup timer */
-        Timer_setTimeout(joinClkHandle, joinDuration);
-        Timer_start(&joinClkStruct);
+        Timer_wheelSetTimeout(&joinClk, joinDuration);
+        Timer_wheelStart(&joinClk);
+    }
+}
+
+/*!
+ Set the background channel scan clock.
+
+ Public function defined in csf.h
+ */
+void Csf_setChanScanClock(uint32_t scanTime)
+{
+    /* Stop the channel scan timer */
+    if(Timer_wheelIsActive(&chanScanClk) == true)
+    {
+        Timer_wheelStop(&chanScanClk);
+    }
+
+    if(scanTime != 0)
+    {
+        /* Setup timer */
+        Timer_wheelSetTimeout(&chanScanClk, scanTime);
+        Timer_wheelStart(&chanScanClk);
     }
 }
 
@@ -1217,16 +1295,16 @@ void Csf_setJoinPermitClock(uint32_t joinDuration)
 void Csf_setConfigClock(uint32_t delay)
 {
     /* Stop the join timer */
-    if(Timer_isActive(&configClkStruct) == true)
+    if(Timer_wheelIsActive(&configClk) == true)
     {
-        Timer_stop(&configClkStruct);
+        Timer_wheelStop(&configClk);
     }
 
     if(delay != 0)
     {
         /* Setup timer */
-        Timer_setTimeout(configClkHandle, delay);
-        Timer_start(&configClkStruct);
+        Timer_wheelSetTimeout(&configClk, delay);
+        Timer_wheelStart(&configClk);
     }
 }
 
@@ -1239,26 +1317,49 @@ void Csf_setConfigClock(uint32_t delay)
  */
 uint16_t Csf_getNumDeviceListEntries(void)
 {
-    uint16_t numEntries = 0;
-
-    if(pNV != NULL)
-    {
-        NVINTF_itemID_t id;
-        uint8_t stat;
+    /* Devices in the admission queue are part of the list too */
+    return (readNumDeviceListEntries() + admitCount);
+}
 
-        /* Setup NV ID for the number of entries in the device list */
-        id.systemID = NVINTF_SYSID_APP;
-        id.itemID = CSF_NV_DEVICELIST_ENTRIES_ID;
-        id.subID = 0;
+/*!
+ Admit a new device under the join rate limit
 
-        /* Read the number of device list items from NV */
-        stat = pNV->readItem(id, 0, sizeof(uint16_t), &numEntries);
-        if(stat != NVINTF_SUCCESS)
+ Public function defined in csf.h
+ */
+bool Csf_admitJoin(void)
+{
+#if CSF_ADMIT_RATE > 0
+    uint32_t now = Clock_getTicks();
+    uint64_t refill;
+
+    /*
+     Refill for the time since the last refill, CSF_ADMIT_RATE thousandths
+     of a device per millisecond. Clock_tickPeriod is in microseconds.
+     */
+    refill = ((uint64_t)(now - admitLastTicks) * Clock_tickPeriod
+              * CSF_ADMIT_RATE) / 1000;
+    if(refill > 0)
+    {
+        /* Less than a thousandth is kept for the next request */
+        admitLastTicks = now;
+        if(refill > ((CSF_ADMIT_BURST * 1000) - admitTokens))
         {
-            numEntries = 0;
+            admitTokens = CSF_ADMIT_BURST * 1000;
+        }
+        else
+        {
+            admitTokens += (uint32_t)refill;
         }
     }
-    return (numEntries);
+
+    if(admitTokens < 1000)
+    {
+        return (false);
+    }
+    admitTokens -= 1000;
+#endif
+
+    return (true);
 }
 
 /*!
@@ -1293,8 +1394,26 @@ bool Csf_getDevice(ApiMac_sAddr_t *pDevAddr, Llc_deviceListItem_t *pItem)
     if((pNV != NULL) && (pItem != NULL))
     {
         uint16_t numEntries;
+        uint8_t i;
+
+        /* Check the devices that haven't been written to NV yet */
+        for(i = 0; i < admitCount; i++)
+        {
+            if(((pDevAddr->addrMode == ApiMac_addrType_short)
+                && (pDevAddr->addr.shortAddr
+                    == admitQueue[i].devInfo.shortAddress))
+               || ((pDevAddr->addrMode == ApiMac_addrType_extended)
+                   && (memcmp(&pDevAddr->addr.extAddr,
+                              &admitQueue[i].devInfo.extAddress,
+                              (APIMAC_SADDR_EXT_LEN))
+                       == 0)))
+            {
+                memcpy(pItem, &admitQueue[i], sizeof(Llc_deviceListItem_t));
+                return (true);
+            }
+        }
 
-        numEntries = Csf_getNumDeviceListEntries();
+        numEntries = readNumDeviceListEntries();
 
         if(numEntries > 0)
         {
@@ -1352,7 +1471,19 @@ bool Csf_getDeviceItem(uint16_t devIndex, Llc_deviceListItem_t *pItem)
     {
         uint16_t numEntries;
 
-        numEntries = Csf_getNumDeviceListEntries();
+        numEntries = readNumDeviceListEntries();
+
+        /* The devices not written to NV yet come after the ones that are */
+        if(devIndex >= numEntries)
+        {
+            if((devIndex - numEntries) < admitCount)
+            {
+                memcpy(pItem, &admitQueue[devIndex - numEntries],
+                       sizeof(Llc_deviceListItem_t));
+                return (true);
+            }
+            return (false);
+        }
 
         if(numEntries > 0)
         {
@@ -1392,6 +1523,63 @@ bool Csf_getDeviceItem(uint16_t devIndex, Llc_deviceListItem_t *pItem)
     return (false);
 }
 
+/*!
+ Read the whole device list
+
+ Public function defined in csf.h
+ */
+uint16_t Csf_getDeviceList(Llc_deviceListItem_t *pList, uint16_t maxEntries)
+{
+    uint16_t readItems = 0;
+
+    if((pNV != NULL) && (pList != NULL))
+    {
+        uint16_t numEntries;
+        uint8_t i;
+
+        numEntries = readNumDeviceListEntries();
+        if(numEntries > maxEntries)
+        {
+            numEntries = maxEntries;
+        }
+
+        if(numEntries > 0)
+        {
+            NVINTF_itemID_t id;
+            uint8_t stat;
+            int subId = 0;
+
+            /* Setup NV ID for the device list records */
+            id.systemID = NVINTF_SYSID_APP;
+            id.itemID = CSF_NV_DEVICELIST_ID;
+
+            while((readItems < numEntries) && (subId
+                                               < CSF_MAX_DEVICELIST_IDS))
+            {
+                id.subID = (uint16_t)subId;
+
+                /* Read straight into the list, a miss is overwritten */
+                stat = pNV->readItem(id, 0, sizeof(Llc_deviceListItem_t),
+                                     &pList[readItems]);
+                if(stat == NVINTF_SUCCESS)
+                {
+                    readItems++;
+                }
+                subId++;
+            }
+        }
+
+        /* Then the devices not written to NV yet */
+        for(i = 0; (i < admitCount) && (readItems < maxEntries); i++)
+        {
+            memcpy(&pList[readItems++], &admitQueue[i],
+                   sizeof(Llc_deviceListItem_t));
+        }
+    }
+
+    return (readItems);
+}
+
 /*!
  Csf implementation for memory allocation
 
@@ -1541,10 +1729,16 @@ bool Csf_getFrameCounter(ApiMac_sAddr_t *pDevAddr, uint32_t *pFrameCntr)
  */
 void Csf_removeDeviceListItem(ApiMac_sAddrExt_t *pAddr)
 {
-    if((pNV != NULL) && (pNV->deleteItem != NULL))
-    {
-        int index;
+    int index;
 
+    /* Not written to NV yet? */
+    index = findAdmitIndex(pAddr);
+    if(index >= 0)
+    {
+        removeAdmitItem(index);
+    }
+    else if((pNV != NULL) && (pNV->deleteItem != NULL))
+    {
         /* Does the item exist? */
         index = findDeviceListIndex(pAddr);
         if(index != DEVICE_INDEX_NOT_FOUND)
@@ -1561,7 +1755,7 @@ void Csf_removeDeviceListItem(ApiMac_sAddrExt_t *pAddr)
             if(stat == NVINTF_SUCCESS)
             {
                 /* Update the number of entries */
-                uint16_t numEntries = Csf_getNumDeviceListEntries();
+                uint16_t numEntries = readNumDeviceListEntries();
                 if(numEntries > 0)
                 {
                     numEntries--;
@@ -1595,6 +1789,9 @@ void Csf_assertInd(uint8_t reason)
  */
 void Csf_clearAllNVItems(void)
 {
+    /* Forget the devices waiting to be written too */
+    admitCount = 0;
+
 #ifdef ONE_PAGE_NV
     if((pNV != NULL) && (pNV->deleteItem != NULL))
     {
@@ -1665,6 +1862,19 @@ void Csf_clearAllNVItems(void)
 #endif /* end if for ONE_PAGE_NV */
 }
 
+/*!
+ Compact NV ahead of time while idle
+
+ Public function defined in csf.h
+ */
+void Csf_compactNV(void)
+{
+#ifndef ONE_PAGE_NV
+    /* Compacts at most one page, and only when free space is low */
+    (void)NVOCMP_compactStep();
+#endif
+}
+
 
 /*!
  Add an entry into the black list
@@ -1719,7 +1929,7 @@ bool Csf_addBlackListItem(ApiMac_sAddr_t *pAddr)
  */
 bool Csf_isConfigTimerActive(void)
 {
-    return(Timer_isActive(&configClkStruct));
+    return(Timer_wheelIsActive(&configClk));
 }
 
 /*!
@@ -1729,7 +1939,7 @@ bool Csf_isConfigTimerActive(void)
  */
 bool Csf_isTrackingTimerActive(void)
 {
-    return(Timer_isActive(&trackingClkStruct));
+    return(Timer_wheelIsActive(&trackingClk));
 }
 
 /*!
@@ -1769,12 +1979,29 @@ void Csf_closeNwk(void)
 int Csf_removeDevice(uint16_t deviceShortAddr, bool addToBlackList)
 {
     int status = -1;
+    int i;
+
+    /* Search the whole list in NV */
+    persistAdmitQueue();
+
+    /* Devices that couldn't be written are still queued */
+    for(i = 0; i < admitCount; i++)
+    {
+        if(admitQueue[i].devInfo.shortAddress == deviceShortAddr)
+        {
+            Llc_deviceListItem_t item;
+
+            memcpy(&item, &admitQueue[i], sizeof(Llc_deviceListItem_t));
+            removeListedDevice(&item, addToBlackList);
+            return (0);
+        }
+    }
 
     if(pNV != NULL)
     {
         uint16_t numEntries;
 
-        numEntries = Csf_getNumDeviceListEntries();
+        numEntries = readNumDeviceListEntries();
 
         if(numEntries > 0)
         {
@@ -1799,22 +2026,7 @@ int Csf_removeDevice(uint16_t deviceShortAddr, bool addToBlackList)
                 if( (stat == NVINTF_SUCCESS) && (deviceShortAddr == item.devInfo.shortAddress))
                 {
                     /* Found the device in the list */
-                    ApiMac_sAddr_t addr;
-
-                    /* Send a disassociate to the device */
-                    Cllc_sendDisassociationRequest(item.devInfo.shortAddress,
-                                                   item.capInfo.rxOnWhenIdle);
-                    /* remove device from the NV list */
-                    Cllc_removeDevice(&item.devInfo.extAddress);
-
-                    if(addToBlackList)
-                    {
-                        /* Add the device to the black list so it can't join again */
-                        addr.addrMode = ApiMac_addrType_extended;
-                        memcpy(&addr.addr.extAddr, &item.devInfo.extAddress,
-                               (APIMAC_SADDR_EXT_LEN));
-                        Csf_addBlackListItem(&addr);
-                    }
+                    removeListedDevice(&item, addToBlackList);
 
                     status = 0;
                     break;
@@ -1906,6 +2118,21 @@ static void processJoinTimeoutCallback(UArg a0)
     Semaphore_post(collectorSem);
 }
 
+/*!
+ * @brief       Background channel scan timeout handler function.
+ *
+ * @param       a0 - ignored
+ */
+static void processChanScanTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Cllc_events, CLLC_CHAN_SCAN_EVT);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(collectorSem);
+}
+
 /*!
  * @brief       Config delay timeout handler function.
  *
@@ -1934,6 +2161,21 @@ static void processidentifyTimeoutCallback(UArg a0)
     CUI_ledOff(csfCuiHndl, CONFIG_LED_GREEN);
 }
 
+/*!
+ * @brief       Admission queue timeout handler function.
+ *
+ * @param       a0 - ignored
+ */
+static void processAdmitTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Csf_events, CSF_ADMIT_EVT);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(collectorSem);
+}
+
 /*!
  * @brief       Trickle timeout handler function for PA .
  *
@@ -1999,8 +2241,12 @@ static bool addDeviceListItem(Llc_deviceListItem_t *pItem, bool *pNewDevice)
 
     if((pNV != NULL) && (pItem != NULL))
     {
-        if(findDeviceListIndex(&pItem->devInfo.extAddress)
-                        != DEVICE_INDEX_NOT_FOUND)
+        /*
+         The association table holds every device in the list, so a
+         rejoining device is found without searching NV
+         */
+        if((Cllc_findDeviceExt(&pItem->devInfo.extAddress) != NULL)
+           || (findAdmitIndex(&pItem->devInfo.extAddress) >= 0))
         {
             retVal = true;
 
@@ -2009,27 +2255,30 @@ static bool addDeviceListItem(Llc_deviceListItem_t *pItem, bool *pNewDevice)
         }
         else
         {
-            uint8_t stat;
-            NVINTF_itemID_t id;
-            uint16_t numEntries = Csf_getNumDeviceListEntries();
-
-            /* Check the maximum size */
-            if(numEntries < CSF_MAX_DEVICELIST_ENTRIES)
+            if(admitCount == CSF_ADMIT_QUEUE_SIZE)
             {
-                /* Setup NV ID for the device list record */
-                id.systemID = NVINTF_SYSID_APP;
-                id.itemID = CSF_NV_DEVICELIST_ID;
-                id.subID = (uint16_t)findUnusedDeviceListIndex();
+                /* Make room */
+                persistAdmitQueue();
+            }
 
-                /* write the device list record */
-                stat = pNV->writeItem(id, sizeof(Llc_deviceListItem_t), pItem);
-                if(stat == NVINTF_SUCCESS)
+            /*
+             Check the maximum size, and that there is room left: devices
+             that couldn't be written stay queued
+             */
+            if((Csf_getNumDeviceListEntries() < CSF_MAX_DEVICELIST_ENTRIES)
+               && (admitCount < CSF_ADMIT_QUEUE_SIZE))
+            {
+                /*
+                 Queue the device list record, it's written to NV with the
+                 other devices joining around the same time
+                 */
+                memcpy(&admitQueue[admitCount++], pItem,
+                       sizeof(Llc_deviceListItem_t));
+                if(Timer_wheelIsActive(&admitClk) == false)
                 {
-                    /* Update the number of entries */
-                    numEntries++;
-                    saveNumDeviceListEntries(numEntries);
-                    retVal = true;
+                    Timer_wheelStart(&admitClk);
                 }
+                retVal = true;
             }
         }
     }
@@ -2069,6 +2318,14 @@ static void updateDeviceListItem(Llc_deviceListItem_t *pItem)
     {
         int idx;
 
+        idx = findAdmitIndex(&pItem->devInfo.extAddress);
+        if(idx >= 0)
+        {
+            /* Not written to NV yet, update the queued copy */
+            memcpy(&admitQueue[idx], pItem, sizeof(Llc_deviceListItem_t));
+            return;
+        }
+
         idx = findDeviceListIndex(&pItem->devInfo.extAddress);
         if(idx != DEVICE_INDEX_NOT_FOUND)
         {
@@ -2099,7 +2356,7 @@ static int findDeviceListIndex(ApiMac_sAddrExt_t *pAddr)
     {
         uint16_t numEntries;
 
-        numEntries = Csf_getNumDeviceListEntries();
+        numEntries = readNumDeviceListEntries();
 
         if(numEntries > 0)
         {
@@ -2142,55 +2399,32 @@ static int findDeviceListIndex(ApiMac_sAddrExt_t *pAddr)
 }
 
 /*!
- * @brief       Find an unused device list index
+ * @brief       Read the number of device list items stored in NV
  *
- * @return      index that is not in use
+ * @return      number of entries in the NV device list
  */
-static int findUnusedDeviceListIndex(void)
+static uint16_t readNumDeviceListEntries(void)
 {
-    int subId = 0;
+    uint16_t numEntries = 0;
 
     if(pNV != NULL)
     {
-        uint16_t numEntries;
+        NVINTF_itemID_t id;
+        uint8_t stat;
 
-        numEntries = Csf_getNumDeviceListEntries();
+        /* Setup NV ID for the number of entries in the device list */
+        id.systemID = NVINTF_SYSID_APP;
+        id.itemID = CSF_NV_DEVICELIST_ENTRIES_ID;
+        id.subID = 0;
 
-        if(numEntries > 0)
+        /* Read the number of device list items from NV */
+        stat = pNV->readItem(id, 0, sizeof(uint16_t), &numEntries);
+        if(stat != NVINTF_SUCCESS)
         {
-            NVINTF_itemID_t id;
-
-            int readItems = 0;
-            /* Setup NV ID for the device list records */
-            id.systemID = NVINTF_SYSID_APP;
-            id.itemID = CSF_NV_DEVICELIST_ID;
-
-            while((readItems < numEntries) && (subId
-                                               < CSF_MAX_DEVICELIST_IDS))
-            {
-                Llc_deviceListItem_t item;
-                uint8_t stat;
-
-                id.subID = (uint16_t)subId;
-
-                /* Read Network Information from NV */
-                stat = pNV->readItem(id, 0, sizeof(Llc_deviceListItem_t),
-                                     &item);
-                if(stat == NVINTF_NOTFOUND)
-                {
-                    /* Use this sub id */
-                    break;
-                }
-                else if(stat == NVINTF_SUCCESS)
-                {
-                    readItems++;
-                }
-                subId++;
-            }
+            numEntries = 0;
         }
     }
-
-    return (subId);
+    return (numEntries);
 }
 
 /*!
@@ -2214,6 +2448,178 @@ static void saveNumDeviceListEntries(uint16_t numEntries)
     }
 }
 
+/*!
+ * @brief       Find a device in the admission queue
+ *
+ * @param       pAddr - extended address of the device to find
+ *
+ * @return      index into the admission queue, -1 if not found
+ */
+static int findAdmitIndex(ApiMac_sAddrExt_t *pAddr)
+{
+    int i;
+
+    for(i = 0; i < admitCount; i++)
+    {
+        if(memcmp(pAddr, &admitQueue[i].devInfo.extAddress,
+                  (APIMAC_SADDR_EXT_LEN)) == 0)
+        {
+            return (i);
+        }
+    }
+
+    return (-1);
+}
+
+/*!
+ * @brief       Drop a device from the admission queue
+ *
+ * @param       index - index into the admission queue
+ */
+static void removeAdmitItem(int index)
+{
+    admitCount--;
+    memmove(&admitQueue[index], &admitQueue[index + 1],
+            (admitCount - index) * sizeof(Llc_deviceListItem_t));
+}
+
+/*!
+ * @brief       Write the devices in the admission queue to the NV device
+ *              list. One pass over the list finds the queued devices that
+ *              are already stored and the unused sub IDs for the rest, and
+ *              the number of entries is written once for the batch.
+ *              Devices that couldn't be written stay queued for the next
+ *              time.
+ */
+static void persistAdmitQueue(void)
+{
+    if(Timer_wheelIsActive(&admitClk) == true)
+    {
+        Timer_wheelStop(&admitClk);
+    }
+    Util_clearEvent(&Csf_events, CSF_ADMIT_EVT);
+
+    if((pNV != NULL) && (admitCount > 0))
+    {
+        NVINTF_itemID_t id;
+        uint16_t unusedIds[CSF_ADMIT_QUEUE_SIZE];
+        uint16_t numUnused = 0;
+        uint16_t numEntries = readNumDeviceListEntries();
+        uint16_t readItems = 0;
+        uint16_t subId = 0;
+        uint16_t written = 0;
+        uint8_t kept = 0;
+        int i;
+
+        /* Setup NV ID for the device list records */
+        id.systemID = NVINTF_SYSID_APP;
+        id.itemID = CSF_NV_DEVICELIST_ID;
+
+        while(((readItems < numEntries) || (numUnused < admitCount))
+              && (subId < CSF_MAX_DEVICELIST_IDS))
+        {
+            uint8_t stat = NVINTF_NOTFOUND;
+
+            /* Past the last record the rest of the sub IDs are unused */
+            if(readItems < numEntries)
+            {
+                Llc_deviceListItem_t item;
+
+                id.subID = subId;
+                stat = pNV->readItem(id, 0, sizeof(Llc_deviceListItem_t),
+                                     &item);
+                if(stat == NVINTF_SUCCESS)
+                {
+                    /* Already stored, e.g. it left and joined again */
+                    i = findAdmitIndex(&item.devInfo.extAddress);
+                    if(i >= 0)
+                    {
+                        removeAdmitItem(i);
+                    }
+                    readItems++;
+                }
+            }
+
+            if((stat == NVINTF_NOTFOUND) && (numUnused < admitCount))
+            {
+                unusedIds[numUnused++] = subId;
+            }
+            subId++;
+        }
+
+        for(i = 0; i < admitCount; i++)
+        {
+            bool stored = false;
+
+            if((written < numUnused)
+               && (numEntries < CSF_MAX_DEVICELIST_ENTRIES))
+            {
+                id.subID = unusedIds[written];
+
+                /* write the device list record */
+                if(pNV->writeItem(id, sizeof(Llc_deviceListItem_t),
+                                  &admitQueue[i]) == NVINTF_SUCCESS)
+                {
+                    written++;
+                    numEntries++;
+                    stored = true;
+                }
+            }
+
+            if(stored == false)
+            {
+                /* Keep it, at the front of the queue */
+                if(kept != i)
+                {
+                    memcpy(&admitQueue[kept], &admitQueue[i],
+                           sizeof(Llc_deviceListItem_t));
+                }
+                kept++;
+            }
+        }
+
+        if(written > 0)
+        {
+            /* Update the number of entries */
+            saveNumDeviceListEntries(numEntries);
+        }
+
+        admitCount = kept;
+        if(admitCount > 0)
+        {
+            /* Try the rest again later */
+            Timer_wheelStart(&admitClk);
+        }
+    }
+}
+
+/*!
+ * @brief       Disassociate a device of the device list and remove it
+ *
+ * @param       pItem - the device's device list entry
+ * @param       addToBlackList - true to add the device to the black list
+ */
+static void removeListedDevice(Llc_deviceListItem_t *pItem,
+                               bool addToBlackList)
+{
+    /* Send a disassociate to the device */
+    Cllc_sendDisassociationRequest(pItem->devInfo.shortAddress,
+                                   pItem->capInfo.rxOnWhenIdle);
+    /* remove device from the NV list */
+    Cllc_removeDevice(&pItem->devInfo.extAddress);
+
+    if(addToBlackList)
+    {
+        ApiMac_sAddr_t addr;
+
+        /* Add the device to the black list so it can't join again */
+        addr.addrMode = ApiMac_addrType_extended;
+        memcpy(&addr.addr.extAddr, &pItem->devInfo.extAddress,
+               (APIMAC_SADDR_EXT_LEN));
+        Csf_addBlackListItem(&addr);
+    }
+}
+
 /*!
  * @brief       Find entry in black list
  *
@@ -2420,11 +2826,14 @@ void removeBlackListItem(ApiMac_sAddr_t *pAddr)
  */
 static void removeTheFirstDevice(void)
 {
+    /* Search the whole list in NV */
+    persistAdmitQueue();
+
     if(pNV != NULL)
     {
         uint16_t numEntries;
 
-        numEntries = Csf_getNumDeviceListEntries();
+        numEntries = readNumDeviceListEntries();
 
         if(numEntries > 0)
         {
@@ -2482,11 +2891,15 @@ static void removeTheFirstDevice(void)
 static uint16_t getTheFirstDevice(void)
 {
     uint16_t found = CSF_INVALID_SHORT_ADDR;
+
+    /* Search the whole list in NV */
+    persistAdmitQueue();
+
     if(pNV != NULL)
     {
         uint16_t numEntries;
 
-        numEntries = Csf_getNumDeviceListEntries();
+        numEntries = readNumDeviceListEntries();
 
         if(numEntries > 0)
         {
@@ -2542,12 +2955,8 @@ void Csf_IndicateOrphanReJoin(uint16_t shortAddr)
 void Csf_initializeProvisioningClock(void)
 {
     /* Initialize the timers needed for this application */
-    provisioningClkHandle = Timer_construct(&provisioningClkStruct,
-                                       processProvisioningCallback,
-                                       FH_ASSOC_TIMER,
-                                        0,
-                                        false,
-                                        0);
+    Timer_wheelConstruct(&provisioningClk, processProvisioningCallback,
+                         FH_ASSOC_TIMER, CSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -2558,19 +2967,19 @@ void Csf_initializeProvisioningClock(void)
 void Csf_setProvisioningClock(bool provision)
 {
     /* Stop the Provisioning timer */
-    if(Timer_isActive(&provisioningClkStruct) == true)
+    if(Timer_wheelIsActive(&provisioningClk) == true)
     {
-        Timer_stop(&provisioningClkStruct);
+        Timer_wheelStop(&provisioningClk);
     }
 
     /* Setup timer for provisioning association timeout */
     if (provision)
     {
-        Timer_setTimeout(provisioningClkHandle, PROVISIONING_ASSOC_TIMER);
+        Timer_wheelSetTimeout(&provisioningClk, PROVISIONING_ASSOC_TIMER);
     }
 
-    Timer_setFunc(provisioningClkHandle, processProvisioningCallback, provision);
-    Timer_start(&provisioningClkStruct);
+    Timer_wheelSetFunc(&provisioningClk, processProvisioningCallback, provision);
+    Timer_wheelStart(&provisioningClk);
 }
 
 
@@ -2602,6 +3011,32 @@ static void processProvisioningCallback(UArg provision)
 }
 #endif /* endif for USE_DMM */
 
+#if defined(OSAL_PORT_CS_STATS) && !defined(POWER_MEAS)
+/*!
+ * @brief       Print the time interrupts were held off by OSAL port critical
+ *              sections, the longest and the mean, in microseconds.
+ */
+static void displayCSStats(void)
+{
+    OsalPort_CSStats stats;
+    Types_FreqHz freq;
+    uint32_t mean = 0;
+
+    OsalPort_getCSStats(&stats);
+    Timestamp_getFreq(&freq);
+    if(stats.count > 0)
+    {
+        mean = (uint32_t)((stats.totalTicks * 1000000) /
+                          ((uint64_t)stats.count * freq.lo));
+    }
+    CUI_statusLinePrintf(csfCuiHndl, csStatsStatusLine,
+                         "Max=%uus, Mean=%uus, Count=%u",
+                         (unsigned)(((uint64_t)stats.maxTicks * 1000000) /
+                                    freq.lo),
+                         (unsigned)mean, (unsigned)stats.count);
+}
+#endif /* OSAL_PORT_CS_STATS && !POWER_MEAS */
+
 /**
  *  @brief Updates the collector's status line
  *
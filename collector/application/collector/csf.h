@@ -80,6 +80,8 @@ extern "C"
 #define CSF_KEY_EVENT 0x0001
 #define COLLECTOR_UI_INPUT_EVT            0x0002
 #define COLLECTOR_SENSOR_ACTION_EVT       0x0004
+/*! CSF Events - Write the admission queue to NV */
+#define CSF_ADMIT_EVT                     0x0008
 
 #define CSF_INVALID_SHORT_ADDR   0xFFFF
 
@@ -303,10 +305,16 @@ extern void Csf_initializeJoinPermitClock(void);
  */
 extern void Csf_initializeConfigClock(void);
 
+/*!
+ * @brief       Initialize the clock for background channel scans
+ */
+extern void Csf_initializeChanScanClock(void);
+
 /*!
  * @brief       Set trickle clock
  *
- * @param       trickleTime - duration of trickle timer( in msec)
+ * @param       trickleTime - time until the trickle clock fires (in msec),
+ *                            0 stops it
  * @param       frameType - type of Async frame
  */
 extern void Csf_setTrickleClock(uint32_t trickleTime, uint8_t frameType);
@@ -318,6 +326,14 @@ extern void Csf_setTrickleClock(uint32_t trickleTime, uint8_t frameType);
  */
 extern void Csf_setJoinPermitClock(uint32_t joinDuration);
 
+/*!
+ * @brief       Set the background channel scan clock
+ *
+ * @param       scanTime - time to the next channel scan (in msec),
+ *                         0 stops the scans
+ */
+extern void Csf_setChanScanClock(uint32_t scanTime);
+
 /*!
  * @brief       Set Config request delay clock
  *
@@ -326,12 +342,21 @@ extern void Csf_setJoinPermitClock(uint32_t joinDuration);
 extern void Csf_setConfigClock(uint32_t delay);
 
 /*!
- * @brief       Read the number of device list items stored
+ * @brief       Read the number of device list items stored, including
+ *              the devices that joined but aren't written to NV yet
  *
  * @return      number of entries in the device list
  */
 extern uint16_t Csf_getNumDeviceListEntries(void);
 
+/*!
+ * @brief       Check the join rate limit before admitting a new device.
+ *              Call once per association request from an unknown device.
+ *
+ * @return      true to admit the device, false to leave it to retry later
+ */
+extern bool Csf_admitJoin(void);
+
 /*!
  * @brief       Find the short address from a given extended address
  *
@@ -361,6 +386,18 @@ extern bool Csf_getDevice(ApiMac_sAddr_t *pDevAddr, Llc_deviceListItem_t *pItem)
  */
 extern bool Csf_getDeviceItem(uint16_t devIndex, Llc_deviceListItem_t *pItem);
 
+/*!
+ * @brief       Read the whole device list in one pass over NV, followed
+ *              by the devices not written to NV yet
+ *
+ * @param       pList - place to put the devices
+ * @param       maxEntries - number of entries pList has room for
+ *
+ * @return      number of devices read
+ */
+extern uint16_t Csf_getDeviceList(Llc_deviceListItem_t *pList,
+                                  uint16_t maxEntries);
+
 /*!
  * @brief       Find entry in device list
  *
@@ -423,6 +460,12 @@ extern void Csf_assertInd(uint8_t reason);
  */
 extern void Csf_clearAllNVItems(void);
 
+/*!
+ * @brief       Compact NV ahead of time so that NV writes don't have to.
+ *              Call when the application is idle.
+ */
+extern void Csf_compactNV(void);
+
 /*!
  * @brief       Add an entry into the black list
  *
@@ -0,0 +1,555 @@
+/******************************************************************************
+
+ @file csf_join_sim.c
+
+ @brief Host simulation of a join storm on the collector
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2019, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+/******************************************************************************
+ Overview
+
+ Sends association requests from a number of sensors powering up at once to
+ the collector's device list handling (Csf_admitJoin(), Csf_deviceUpdate()
+ and the admission queue of csf.c), on the NV driver over the host flash
+ model, and prints the join throughput.
+
+   csf_join_sim [<sensors> [<known> [<spread ms>]]]
+
+ The sensors send their first request within <spread ms> (200 by default).
+ With <known> 1 they were in the device list before the outage.  The
+ collector handles one request at a time, taking 2 ms plus the time of the
+ flash operations it did: 8 ms per erase, 8 us per word programmed and
+ 1 us plus 0.1 us per byte read.  A response later than the sensor's
+ response wait (0.92 s) is lost, and the sensor tries again after its scan
+ backoff (5 s) and a scan (0.7 s), as does one that isn't answered under
+ the join rate limit (CSF_ADMIT_RATE).
+
+ Built on a host only, from this folder, e.g.
+   gcc -DCSF_JOIN_SIM_HOST -include host/pre.h -I host -I . -I ../utils
+       -I link_controller -I ../cui -I $S -I $S/services -I $S/mac
+       -I $S/mac/high_level -I $S/mac/low_level -I $S/mac/rom -I $S/osal_port
+       -I $S/stack_user_api/api_mac -I $S/hal/crypto -I $S/hal/platform
+       -I $S/mac_utils -I $S/radio_configuration
+       [-DCSF_ADMIT_RATE=20 -DCSF_ADMIT_BURST=50]
+       -o csf_join_sim csf_join_sim.c csf.c $S/services/nvocmp.c
+       $S/services/nv_linux.c $S/services/crc.c -lpthread
+ where S is ../../software_stack/ti15_4stack.  host/ holds stand-ins for
+ the TI-RTOS, driver and SysConfig headers, and host/pre.h the build
+ options of the project (CONFIG_MAX_DEVICES 150).
+ *****************************************************************************/
+
+/* Host builds only; the project doesn't build this file */
+#ifdef CSF_JOIN_SIM_HOST
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util_timer.h"
+#include "cui.h"
+#include "macconfig.h"
+#include "nvocmp.h"
+#include "nv_linux.h"
+#include "collector.h"
+#include "cllc.h"
+#include "csf.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Clock ticks per millisecond, the ticks are 10 us as on the device */
+#define MS 100
+
+/* Most sensors simulated */
+#define MAX_SENSORS 200
+
+/* Collector time per association request besides NV, in ticks */
+#define REQUEST_TIME (2 * MS)
+
+/* Sensor's association response wait, 48 superframes at 50 kbps */
+#define RSP_WAIT_TIME (920 * MS)
+
+/* Sensor's time from a lost response to its next request */
+#define RETRY_TIME ((5000 + 700) * MS)
+
+/* Most timer wheel entries */
+#define MAX_WHEEL_ENTRIES 32
+
+/* A sensor */
+typedef struct
+{
+    /* Time of its next request */
+    uint32_t next;
+    /* true once it got a response in time */
+    bool joined;
+} sensor_t;
+
+/******************************************************************************
+ Global variables
+ *****************************************************************************/
+
+/* The simulated time, in clock ticks */
+uint32_t simNow;
+
+mac_Config_t Main_user1Cfg;
+uint16_t Collector_events;
+uint16_t Cllc_events;
+Cllc_associated_devices_t Cllc_associatedDevList[CONFIG_MAX_DEVICES];
+Cllc_statistics_t Cllc_statistics;
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+static Timer_WheelEntry *wheel[MAX_WHEEL_ENTRIES];
+static int wheelCount = 0;
+
+static sensor_t sensors[MAX_SENSORS];
+
+/******************************************************************************
+ Local functions
+ *****************************************************************************/
+
+/* Time the flash operations since the last NV_LINUX_resetStats() take */
+static uint32_t nvTime(void)
+{
+    NV_LINUX_stats_t stats;
+
+    NV_LINUX_getStats(&stats);
+
+    /* In tenths of a microsecond, then ticks */
+    return ((stats.erases * 80000 + stats.programWords * 80
+             + stats.reads * 10 + stats.readBytes) / 100);
+}
+
+/* The started wheel entry that expires first, NULL if none */
+static Timer_WheelEntry *firstEntry(void)
+{
+    Timer_WheelEntry *pFirst = NULL;
+    int i;
+
+    for(i = 0; i < wheelCount; i++)
+    {
+        if(wheel[i]->active && ((pFirst == NULL)
+           || ((int32_t)(wheel[i]->expiry - pFirst->expiry) < 0)))
+        {
+            pFirst = wheel[i];
+        }
+    }
+
+    return (pFirst);
+}
+
+/* Run a wheel entry callback and the events it sets at the current time */
+static void expire(Timer_WheelEntry *pEntry)
+{
+    if((int32_t)(pEntry->expiry - simNow) > 0)
+    {
+        simNow = pEntry->expiry;
+    }
+    pEntry->active = false;
+    pEntry->fxn(pEntry->arg);
+    Csf_processEvents();
+}
+
+/* Add a device to the association table, as Cllc does */
+static void addAssociated(ApiMac_deviceDescriptor_t *pDevInfo)
+{
+    int x;
+
+    for(x = 0; x < CONFIG_MAX_DEVICES; x++)
+    {
+        if(Cllc_associatedDevList[x].shortAddr == CSF_INVALID_SHORT_ADDR)
+        {
+            Cllc_associatedDevList[x].shortAddr = pDevInfo->shortAddress;
+            memcpy(&Cllc_associatedDevList[x].extAddr, &pDevInfo->extAddress,
+                   APIMAC_SADDR_EXT_LEN);
+            return;
+        }
+    }
+}
+
+/* Device descriptor of a sensor */
+static void sensorDevInfo(int n, ApiMac_deviceDescriptor_t *pDevInfo)
+{
+    memset(pDevInfo, 0, sizeof(ApiMac_deviceDescriptor_t));
+    pDevInfo->panID = 1;
+    pDevInfo->shortAddress = 1 + n;
+    pDevInfo->extAddress[0] = 1 + n;
+    pDevInfo->extAddress[1] = (1 + n) >> 8;
+}
+
+/******************************************************************************
+ Stand-ins for the rest of the collector
+ *****************************************************************************/
+
+void Timer_wheelConstruct(Timer_WheelEntry *pEntry, Clock_FuncPtr fxn,
+                          uint32_t timeout, uint32_t tolerance, UArg arg)
+{
+    memset(pEntry, 0, sizeof(Timer_WheelEntry));
+    pEntry->fxn = fxn;
+    pEntry->arg = arg;
+    pEntry->timeout = timeout;
+    pEntry->tolerance = tolerance;
+    if(wheelCount < MAX_WHEEL_ENTRIES)
+    {
+        wheel[wheelCount++] = pEntry;
+    }
+}
+
+void Timer_wheelStart(Timer_WheelEntry *pEntry)
+{
+    pEntry->active = true;
+    pEntry->expiry = simNow + (pEntry->timeout * MS);
+}
+
+bool Timer_wheelIsActive(Timer_WheelEntry *pEntry)
+{
+    return (pEntry->active);
+}
+
+void Timer_wheelStop(Timer_WheelEntry *pEntry)
+{
+    pEntry->active = false;
+}
+
+void Timer_wheelSetTimeout(Timer_WheelEntry *pEntry, uint32_t timeout)
+{
+    pEntry->timeout = timeout;
+}
+
+Cllc_associated_devices_t *Cllc_findDeviceExt(ApiMac_sAddrExt_t *pExtAddr)
+{
+    int x;
+
+    for(x = 0; x < CONFIG_MAX_DEVICES; x++)
+    {
+        if((Cllc_associatedDevList[x].shortAddr != CSF_INVALID_SHORT_ADDR)
+           && (memcmp(pExtAddr, &Cllc_associatedDevList[x].extAddr,
+                      APIMAC_SADDR_EXT_LEN) == 0))
+        {
+            return (&Cllc_associatedDevList[x]);
+        }
+    }
+
+    return (NULL);
+}
+
+void Util_setEvent(uint16_t *pEvent, uint16_t event)
+{
+    *pEvent |= event;
+}
+
+void Util_clearEvent(uint16_t *pEvent, uint16_t event)
+{
+    *pEvent &= ~event;
+}
+
+void Cllc_removeDevice(ApiMac_sAddrExt_t *pExtAddr)
+{
+    (void)pExtAddr;
+}
+
+ApiMac_status_t Cllc_setJoinPermit(uint32_t duration)
+{
+    (void)duration;
+    return (ApiMac_status_success);
+}
+
+void Cllc_sendDisassociationRequest(uint16_t shortAddr, bool rxOnIdle)
+{
+    (void)shortAddr;
+    (void)rxOnIdle;
+}
+
+Collector_status_t Collector_sendConfigRequest(ApiMac_sAddr_t *pDstAddr,
+                                               uint16_t frameControl,
+                                               uint32_t reportingInterval,
+                                               uint32_t pollingInterval)
+{
+    (void)pDstAddr;
+    (void)frameControl;
+    (void)reportingInterval;
+    (void)pollingInterval;
+    return (Collector_status_success);
+}
+
+CUI_clientHandle_t CUI_clientOpen(CUI_clientParams_t *_pParams)
+{
+    (void)_pParams;
+    return ((CUI_clientHandle_t)1);
+}
+
+void CUI_clientParamsInit(CUI_clientParams_t *_pClientParams)
+{
+    (void)_pClientParams;
+}
+
+CUI_retVal_t CUI_btnResourceRequest(const CUI_clientHandle_t _clientHandle,
+                                    const CUI_btnRequest_t *_pRequest)
+{
+    (void)_clientHandle;
+    (void)_pRequest;
+    return (CUI_SUCCESS);
+}
+
+CUI_retVal_t CUI_btnSetCb(const CUI_clientHandle_t _clientHandle,
+                          const uint32_t _index, const CUI_btnPressCB_t _appCb)
+{
+    (void)_clientHandle;
+    (void)_index;
+    (void)_appCb;
+    return (CUI_SUCCESS);
+}
+
+CUI_retVal_t CUI_btnGetValue(const CUI_clientHandle_t _clientHandle,
+                             const uint32_t _index, bool *_pBtnState)
+{
+    (void)_clientHandle;
+    (void)_index;
+    *_pBtnState = false;
+    return (CUI_SUCCESS);
+}
+
+CUI_retVal_t CUI_ledOn(const CUI_clientHandle_t _clientHandle,
+                       const uint32_t _index, const uint8_t _brightness)
+{
+    (void)_clientHandle;
+    (void)_index;
+    (void)_brightness;
+    return (CUI_SUCCESS);
+}
+
+CUI_retVal_t CUI_ledOff(const CUI_clientHandle_t _clientHandle,
+                        const uint32_t _index)
+{
+    (void)_clientHandle;
+    (void)_index;
+    return (CUI_SUCCESS);
+}
+
+CUI_retVal_t CUI_ledToggle(const CUI_clientHandle_t _clientHandle,
+                           const uint32_t _index)
+{
+    (void)_clientHandle;
+    (void)_index;
+    return (CUI_SUCCESS);
+}
+
+CUI_retVal_t CUI_ledBlink(const CUI_clientHandle_t _clientHandle,
+                          const uint32_t _index, const uint16_t _numBlinks)
+{
+    (void)_clientHandle;
+    (void)_index;
+    (void)_numBlinks;
+    return (CUI_SUCCESS);
+}
+
+CUI_retVal_t CUI_processMenuUpdate(void)
+{
+    return (CUI_SUCCESS);
+}
+
+void *OsalPort_malloc(uint32_t size)
+{
+    return (malloc(size));
+}
+
+void OsalPort_free(void *pMsg)
+{
+    free(pMsg);
+}
+
+/******************************************************************************
+ Public functions
+ *****************************************************************************/
+
+int main(int argc, char **argv)
+{
+    int numSensors = (argc > 1) ? atoi(argv[1]) : 50;
+    int known = (argc > 2) ? atoi(argv[2]) : 0;
+    int spread = (argc > 3) ? atoi(argv[3]) : 200;
+    uint32_t busy, start, lastJoin, worst = 0;
+    uint64_t sumLatency = 0;
+    int joined = 0, requests = 0, late = 0, deferred = 0;
+    int n;
+
+    if((numSensors < 1) || (numSensors > MAX_SENSORS))
+    {
+        printf("1 to %d sensors\n", MAX_SENSORS);
+        return (1);
+    }
+
+    NVOCMP_loadApiPtrs(&Main_user1Cfg.nvFps);
+    Main_user1Cfg.nvFps.initNV(NULL);
+    memset(Cllc_associatedDevList, 0xFF, sizeof(Cllc_associatedDevList));
+    Csf_init(NULL);
+    srand(7);
+
+    for(n = 0; n < numSensors; n++)
+    {
+        if(known)
+        {
+            ApiMac_deviceDescriptor_t devInfo;
+            ApiMac_capabilityInfo_t capInfo;
+
+            memset(&capInfo, 0, sizeof(capInfo));
+            sensorDevInfo(n, &devInfo);
+            Csf_deviceUpdate(&devInfo, &capInfo);
+            addAssociated(&devInfo);
+        }
+    }
+
+    /* Let the known devices reach NV, then power up */
+    simNow = 10000 * MS;
+    while(firstEntry() != NULL)
+    {
+        expire(firstEntry());
+    }
+    start = simNow;
+    busy = simNow;
+    lastJoin = simNow;
+    for(n = 0; n < numSensors; n++)
+    {
+        sensors[n].next = start + (rand() % (spread * MS));
+        sensors[n].joined = false;
+    }
+
+    while(joined < numSensors)
+    {
+        Timer_WheelEntry *pEntry = firstEntry();
+        ApiMac_deviceDescriptor_t devInfo;
+        ApiMac_capabilityInfo_t capInfo;
+        Cllc_associated_devices_t *pDev;
+        sensor_t *pSensor = NULL;
+        uint32_t latency;
+        bool response;
+
+        for(n = 0; n < numSensors; n++)
+        {
+            if((sensors[n].joined == false) && ((pSensor == NULL)
+               || ((int32_t)(sensors[n].next - pSensor->next) < 0)))
+            {
+                pSensor = &sensors[n];
+            }
+        }
+
+        /* A clock due first is handled when the collector is free */
+        if((pEntry != NULL)
+           && ((int32_t)(pEntry->expiry - pSensor->next) <= 0))
+        {
+            simNow = ((int32_t)(busy - pEntry->expiry) > 0) ? busy :
+                     pEntry->expiry;
+            NV_LINUX_resetStats();
+            expire(pEntry);
+            busy = simNow + nvTime();
+            continue;
+        }
+
+        simNow = ((int32_t)(busy - pSensor->next) > 0) ? busy : pSensor->next;
+        requests++;
+        NV_LINUX_resetStats();
+
+        /* As assocIndCb() */
+        sensorDevInfo(pSensor - sensors, &devInfo);
+        memset(&capInfo, 0, sizeof(capInfo));
+        pDev = Cllc_findDeviceExt(&devInfo.extAddress);
+        if((pDev == NULL) && (Csf_admitJoin() == false))
+        {
+            /* Not answered */
+            deferred++;
+            busy = simNow + (REQUEST_TIME / 10);
+            pSensor->next += RSP_WAIT_TIME + RETRY_TIME;
+            continue;
+        }
+
+        response = (Csf_deviceUpdate(&devInfo, &capInfo) ==
+                    ApiMac_assocStatus_success);
+        if(response && (pDev == NULL))
+        {
+            addAssociated(&devInfo);
+        }
+        busy = simNow + REQUEST_TIME + nvTime();
+
+        latency = busy - pSensor->next;
+        sumLatency += latency;
+        if(latency > worst)
+        {
+            worst = latency;
+        }
+
+        if(response && (latency <= RSP_WAIT_TIME))
+        {
+            pSensor->joined = true;
+            joined++;
+            lastJoin = pSensor->next + latency;
+        }
+        else
+        {
+            late++;
+            pSensor->next += RSP_WAIT_TIME + RETRY_TIME;
+        }
+    }
+
+    /* Let the last batch reach NV */
+    while(firstEntry() != NULL)
+    {
+        expire(firstEntry());
+    }
+
+    printf("%d sensors%s: all joined in %.2f s (%.1f joins/s), %d requests, "
+           "%d late, %d deferred, response mean %.1f ms worst %.1f ms, "
+           "%d in the device list\n", numSensors, known ? " (known)" : "",
+           (lastJoin - start) / (1000.0 * MS),
+           numSensors / ((lastJoin - start) / (1000.0 * MS)), requests, late,
+           deferred, (double)sumLatency / requests / MS, (double)worst / MS,
+           Csf_getNumDeviceListEntries());
+
+    return (0);
+}
+
+#endif /* CSF_JOIN_SIM_HOST */
@@ -0,0 +1,17 @@
+/* Build options of the collector project, for host builds */
+#define MAC_USER_CONFIG_H
+#define CONFIG_MAX_DEVICES 150
+#define NV_RESTORE
+#define NV_LINUX
+#define NVOCMP_POSIX_MUTEX
+#define OSAL_PORT2TIRTOS
+#define KEY_TABLE_DEFAULT_KEY {0}
+#define CONFIG_TRANSMIT_POWER 0
+#define CONFIG_MIN_BE 3
+#define CONFIG_MAX_BE 5
+#define CERTIFICATION_TEST_MODE 0
+#define POWER_MEAS
+
+#include <xdc/std.h>
+
+typedef struct { int x; } macUserCfg_t;
@@ -0,0 +1,4 @@
+#include <stdlib.h>
+static void *OsalPort_heapMalloc(uint32_t size){ HEAPMGR_LOCK(); void *p = malloc(size); HEAPMGR_UNLOCK(); return p;}
+static void *OsalPort_heapRealloc(void *b, uint32_t size){ return realloc(b, size);}
+static void OsalPort_heapFree(void *b){ free(b);}
@@ -0,0 +1,3 @@
+#pragma once
+typedef void *NVS_Handle;
+typedef struct { size_t regionSize; size_t sectorSize; } NVS_Attrs;
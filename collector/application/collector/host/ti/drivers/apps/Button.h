@@ -0,0 +1,3 @@
+#pragma once
+typedef int Button_EventMask; typedef void* Button_Handle;
+#define Button_EV_CLICKED 1
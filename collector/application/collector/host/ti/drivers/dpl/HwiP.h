@@ -0,0 +1,3 @@
+#pragma once
+#include <stdint.h>
+extern int hwiDepth; static inline uintptr_t HwiP_disable(void){hwiDepth++; return 0;} static inline void HwiP_restore(uintptr_t k){(void)k; hwiDepth--;}
@@ -0,0 +1,3 @@
+#pragma once
+#define PowerCC26XX_SD_DISALLOW 1
+#define PowerCC26XX_SB_DISALLOW 2
@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+typedef uintptr_t UArg; typedef int UInt;
+typedef void (*Clock_FuncPtr)(UArg);
+typedef struct { Clock_FuncPtr fxn; UArg arg; uint32_t timeout, period, expiry; bool active; } Clock_Struct;
+typedef Clock_Struct *Clock_Handle;
+typedef struct { UArg arg; uint32_t period; bool startFlag; } Clock_Params;
+#define Clock_tickPeriod 10
+extern uint32_t simNow;
+void simRegister(Clock_Struct *c);
+static inline void Clock_Params_init(Clock_Params *p){ p->arg=0; p->period=0; p->startFlag=0; }
+static inline Clock_Handle Clock_handle(Clock_Struct *c){ return c; }
+static inline void Clock_start(Clock_Handle c){ c->active=true; c->expiry=simNow+c->timeout; }
+static inline void Clock_construct(Clock_Struct *c, Clock_FuncPtr f, uint32_t t, Clock_Params *p){ c->fxn=f; c->arg=p->arg; c->timeout=t; c->period=p->period; c->active=false; simRegister(c); if(p->startFlag) Clock_start(c); }
+static inline bool Clock_isActive(Clock_Handle c){ return c->active; }
+static inline void Clock_stop(Clock_Handle c){ c->active=false; }
+static inline void Clock_setTimeout(Clock_Handle c, uint32_t t){ c->timeout=t; }
+static inline uint32_t Clock_getTimeout(Clock_Handle c){ return c->active ? c->expiry-simNow : c->timeout; }
+static inline void Clock_setFunc(Clock_Handle c, Clock_FuncPtr f, UArg a){ c->fxn=f; c->arg=a; }
+static inline uint32_t Clock_getTicks(void){ return simNow; }
@@ -0,0 +1,2 @@
+#pragma once
+typedef struct {void*a,*b;} Queue_Elem;
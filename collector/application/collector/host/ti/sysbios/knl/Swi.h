@@ -0,0 +1,3 @@
+#pragma once
+#include "Clock.h"
+static inline UInt Swi_disable(void){return 0;} static inline void Swi_restore(UInt k){(void)k;}
@@ -0,0 +1,22 @@
+#define CONFIG_CHANNEL_MASK {0x0F,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}
+#define CONFIG_FH_NETNAME {"FHTest"}
+#define CONFIG_PAN_ID 0xFFFF
+#define CONFIG_FH_ENABLE 0
+#define CONFIG_FH_CHANNEL_MASK {0xFF}
+#define FH_BROADCAST_DWELL_TIME 100
+#define FH_BROADCAST_INTERVAL 1000
+#define FH_ASYNC_CHANNEL_MASK {0xFF}
+#define CONFIG_PHY_ID 1
+#define CONFIG_CHANNEL_PAGE 9
+#define CONFIG_MAC_BEACON_ORDER 15
+#define CONFIG_MAC_SUPERFRAME_ORDER 15
+#define CONFIG_SCAN_DURATION 5
+#define CONFIG_COORD_SHORT_ADDR 0xAABB
+#define CONFIG_SECURE 1
+#define CONFIG_DWELL_TIME 250
+#define CONFIG_TRICKLE_MIN_CLK_DURATION 500
+#define CONFIG_TRICKLE_MAX_CLK_DURATION 6000
+#define CONFIG_DOUBLE_TRICKLE_TIMER 1
+#define FH_NUM_NON_SLEEPY_HOPPING_NEIGHBORS 2
+#define FH_NUM_NON_SLEEPY_FIXED_CHANNEL_NEIGHBORS 2
+#define CONFIG_POLLING_INTERVAL 6000
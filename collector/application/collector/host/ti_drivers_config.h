@@ -0,0 +1,4 @@
+#define CONFIG_BTN_LEFT 0
+#define CONFIG_BTN_RIGHT 1
+#define CONFIG_LED_GREEN 0
+#define CONFIG_LED_RED 1
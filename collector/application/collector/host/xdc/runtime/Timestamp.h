@@ -0,0 +1,3 @@
+#pragma once
+#include <stdint.h>
+extern uint32_t fakeTs; static inline uint32_t Timestamp_get32(void){ return fakeTs += 3; }
@@ -0,0 +1,6 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <ti/sysbios/knl/Clock.h>
+typedef bool Bool;
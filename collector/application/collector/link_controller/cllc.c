@@ -106,9 +106,34 @@
 #define CLLC_FH_GTK3HASH                {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03}
 #define CLLC_FH_PANVERSION              0x0000
 
+/*! Channel function of our unicast and broadcast schedules (DH1CF) */
+#define CLLC_FH_CHANNEL_FUNCTION        2
+
 #define CLLC_FH_MAX_TRICKLE             CONFIG_TRICKLE_MAX_CLK_DURATION
 #define CLLC_FH_MIN_TRICKLE             CONFIG_TRICKLE_MIN_CLK_DURATION
 
+/*
+ PA and PC frames follow the trickle algorithm of RFC 6206. Each interval
+ the frame is due at a random point in its second half, and is suppressed
+ if CLLC_FH_TRICKLE_K consistent frames were heard by then. A frame is
+ consistent only if it carries our network name and PAN ID and hops on our
+ channel function, so a foreign coordinator never silences us. A solicit
+ resets the interval to the minimum. While join permit is open the interval
+ stops growing at CLLC_FH_JOIN_MAX_TRICKLE, so joining devices don't wait
+ out a long interval.
+ Suppression is off by default: any device of our network that sends PA or
+ PC frames counts, and a device heard here may not be heard by the joining
+ devices that need our frames.
+ */
+#if !defined(CLLC_FH_TRICKLE_K)
+/* Redundancy constant, 0 turns suppression off */
+#define CLLC_FH_TRICKLE_K               0
+#endif
+#if !defined(CLLC_FH_JOIN_MAX_TRICKLE)
+/* Longest interval while join permit is open */
+#define CLLC_FH_JOIN_MAX_TRICKLE        (2 * CLLC_FH_MIN_TRICKLE)
+#endif
+
 #define PA_HOP_NEIGHBOR_FOUND_MASK      0x1
 #define PA_FIXED_NEIGHBOR_FOUND_MASK    0x2
 #define PC_HOP_NEIGHBOR_FOUND_MASK      0x4
@@ -140,6 +165,45 @@
 #define MAC_FRAME_TYPE_DATA 1
 #define MAC_DATA_REQ_FRAME 4
 
+/*
+ Interference tracking, beacon and non beacon networks only. Every
+ CLLC_CHAN_SCAN_INTERVAL one channel gets a short energy detect scan,
+ alternately the current channel and the next other one in the channel
+ mask. Each channel keeps an averaged noise level, and the current channel
+ is also charged for the transmit failures seen on it. After the current
+ channel costs CLLC_CHAN_HYSTERESIS more than the best other channel for
+ CLLC_CHAN_DEGRADED_COUNT scans in a row, the coordinator checks that
+ channel for a PAN ID conflict and moves the network there with a
+ coordinator realignment. Devices that miss the realignment find the
+ network again with an orphan scan.
+ */
+#if !defined(CLLC_CHAN_SCAN_INTERVAL)
+#if defined(POWER_MEAS)
+#define CLLC_CHAN_SCAN_INTERVAL     0
+#else
+/* Milliseconds between background scans, 0 turns them off */
+#define CLLC_CHAN_SCAN_INTERVAL     60000
+#endif
+#endif
+/* Scan duration exponent of a background scan */
+#define CLLC_CHAN_SCAN_DURATION     3
+/* A new energy sample gets a weight of 1/2^n in the noise history */
+#define CLLC_CHAN_NOISE_SHIFT       2
+/* Energy levels added to the current channel by a 100% failure rate */
+#define CLLC_CHAN_FAIL_WEIGHT       128
+/* Transmissions in a scan interval needed to update the failure rate */
+#define CLLC_CHAN_MIN_ATTEMPTS      8
+/* Energy levels another channel must be better by */
+#define CLLC_CHAN_HYSTERESIS        24
+/* Degraded scans in a row before moving */
+#define CLLC_CHAN_DEGRADED_COUNT    3
+/* Scans after a move before considering another */
+#define CLLC_CHAN_HOLDOFF_SCANS     20
+/* Noise history of a channel that hasn't been measured */
+#define CLLC_CHAN_NOISE_UNKNOWN     0xFFFF
+/* Link statistics count of a device that hasn't reported */
+#define CLLC_LINK_STATS_UNKNOWN     0xFFFF
+
 /******************************************************************************
  Structures
  *****************************************************************************/
@@ -161,6 +225,30 @@ typedef struct
     Cllc_coord_states_t currentCoordState;
 } coordInformation_t;
 
+/* Background channel scan states */
+typedef enum
+{
+    /* No background scan in progress */
+    chanScanStates_idle,
+    /* Energy detect scan of one channel */
+    chanScanStates_energyDetect,
+    /* Active scan of the channel to move to, for PAN ID conflicts */
+    chanScanStates_active,
+    /* Coordinator realignment to the new channel */
+    chanScanStates_realign
+} chanScanStates_t;
+
+/* Trickle timer state of one async frame type */
+typedef struct
+{
+    /* Consistent frames heard this interval */
+    uint8_t counter;
+    /* The clock runs to the transmit point rather than the interval end */
+    bool txPending;
+    /* Time from the transmit point to the end of the interval */
+    uint32_t restOfInterval;
+} trickleState_t;
+
 /******************************************************************************
  Global variables
  *****************************************************************************/
@@ -207,6 +295,23 @@ STATIC uint8_t chanMask[APIMAC_154G_CHANNEL_BITMAP_SIZ];
 #endif
 /* Linked list to store incoming PAN descriptors */
 STATIC panDescList_t *pPANDesclist = NULL;
+
+/* Averaged energy detect level of each channel, 8 fraction bits */
+STATIC uint16_t chanNoise[APIMAC_154G_MAX_NUM_CHANNEL];
+/* Averaged failure rate on the current channel, 256 = every transmission */
+STATIC uint16_t chanFailRate = 0;
+/* Transmissions and failures since the last background scan */
+STATIC uint16_t chanTxAttempts = 0;
+STATIC uint16_t chanTxFailures = 0;
+STATIC chanScanStates_t chanScanState = chanScanStates_idle;
+/* Channel being scanned, or moved to */
+STATIC uint8_t chanScanChannel = 0;
+/* Last other channel scanned */
+STATIC uint8_t chanScanOther = 0;
+STATIC bool chanScanCurrent = false;
+STATIC uint8_t chanDegradedCount = 0;
+STATIC uint8_t chanHoldoff = 0;
+STATIC uint8_t chanPrevious = 0;
 /* number of devices associated with the coordinator */
 STATIC uint16_t Cllc_numOfDevices = 0;
 /* copy of MAC API callbacks */
@@ -229,6 +334,12 @@ STATIC uint32_t fhPCtrickleTime = CLLC_FH_MIN_TRICKLE;
 STATIC uint32_t fhPAtrickleTime;
 STATIC uint32_t fhPCtrickleTime;
 #endif
+STATIC trickleState_t fhPAtrickle;
+STATIC trickleState_t fhPCtrickle;
+/* Join permit is open, intervals are capped at CLLC_FH_JOIN_MAX_TRICKLE */
+STATIC bool fhJoinBurst = false;
+/* The PA and PC trickle timers have been started */
+STATIC bool fhTrickleRunning = false;
 /* set of channels on which target nodes are expected to listen */
 STATIC uint8_t optPAChMask[APIMAC_154G_CHANNEL_BITMAP_SIZ];
 /* set of channels on which target nodes are expected to listen */
@@ -357,11 +468,23 @@ static uint16_t findChannel(uint16_t panID,uint8_t channel);
 static void updateState(Cllc_states_t state);
 static void sendAsyncReq(uint8_t frameType);
 static void joinPermitExpired(void);
-static void sendStartReq(bool startFH);
+static void sendStartReq(bool startFH, bool coordRealign);
 static void sendScanReq(ApiMac_scantype_t type);
 static void setTrickleTime(uint32_t *pTrickleTime, uint8_t frameType);
-static void processIncomingFHframe(uint8_t frameType);
-static void processIncomingAsyncUSIE(uint8_t frameType, uint8_t* pIEContent);
+static void trickleStart(uint32_t *pTrickleTime, uint8_t frameType);
+static void trickleReset(uint32_t *pTrickleTime, uint8_t frameType);
+static trickleState_t *trickleState(uint8_t frameType);
+static void joinBurstSet(bool enable);
+static void processIncomingFHframe(ApiMac_mlmeWsAsyncInd_t *pData,
+                                   bool sameSchedule);
+static bool processIncomingAsyncUSIE(uint8_t frameType, uint8_t* pIEContent);
+
+/* Interference tracking */
+static void chanScanStart(void);
+static void chanScanCnf(ApiMac_mlmeScanCnf_t *pData);
+static void chanNoiseUpdate(uint8_t channel, uint8_t energy);
+static void chanEvaluate(void);
+static void sendChanScanReq(ApiMac_scantype_t type, uint8_t channel);
 
 /******************************************************************************
  Public Functions
@@ -429,6 +552,10 @@ void Cllc_init(ApiMac_callbacks_t *pMacCbs, Cllc_callbacks_t *pCllcCbs)
     {
         /* initialize join permit timer clock */
         Csf_initializeJoinPermitClock();
+
+        /* No channel has been measured yet */
+        memset(chanNoise, 0xFF, sizeof(chanNoise));
+        Csf_initializeChanScanClock();
     }
     else
     {
@@ -447,9 +574,10 @@ void Cllc_init(ApiMac_callbacks_t *pMacCbs, Cllc_callbacks_t *pCllcCbs)
         /* initialize app clocks */
         Csf_initializeTrickleClock();
         /* set PIB to FH coordinator */
-        ApiMac_mlmeSetFhReqUint8(ApiMac_FHAttribute_unicastChannelFunction, 2);
+        ApiMac_mlmeSetFhReqUint8(ApiMac_FHAttribute_unicastChannelFunction,
+                                 CLLC_FH_CHANNEL_FUNCTION);
         ApiMac_mlmeSetFhReqUint8(ApiMac_FHAttribute_broadcastChannelFunction,
-                                 2);
+                                 CLLC_FH_CHANNEL_FUNCTION);
         ApiMac_mlmeSetFhReqUint8(ApiMac_FHAttribute_unicastDwellInterval,
                                  CONFIG_DWELL_TIME);
         ApiMac_mlmeSetFhReqUint8(ApiMac_FHAttribute_broadcastDwellInterval,
@@ -535,6 +663,15 @@ void Cllc_process(void)
         /* Clear the event */
         Util_clearEvent(&Cllc_events, CLLC_JOIN_EVT);
     }
+
+    /* Process background channel scan event */
+    if(Cllc_events & CLLC_CHAN_SCAN_EVT)
+    {
+        chanScanStart();
+
+        /* Clear the event */
+        Util_clearEvent(&Cllc_events, CLLC_CHAN_SCAN_EVT);
+    }
 }
 
 /*!
@@ -781,10 +918,10 @@ void Cllc_startNetwork(void)
 
  Public function defined in cllc.h
  */
-void Cllc_restoreNetwork(Llc_netInfo_t *pNetworkInfo, uint8_t numDevices,
+void Cllc_restoreNetwork(Llc_netInfo_t *pNetworkInfo, uint16_t numDevices,
 		Llc_deviceListItem_t *pDevList)
 {
-    uint8_t i = 0;
+    uint16_t i = 0;
 
     /* set state */
     updateState(Cllc_states_initRestoringCoordinator);
@@ -805,50 +942,50 @@ void Cllc_restoreNetwork(Llc_netInfo_t *pNetworkInfo, uint8_t numDevices,
     ApiMac_mlmeSetReqUint16(ApiMac_attribute_shortAddress,
                              pNetworkInfo->devInfo.shortAddress);
 
-    sendStartReq(pNetworkInfo->fh);
-
-    if (pDevList)
+    /*
+     Repopulate the security and association tables before the network
+     starts, so the devices' first frames after the restart are accepted
+     instead of sending them into sync loss and an orphan scan.
+     */
+    for(i = 0; i < numDevices; i++)
     {
-        /* repopulate association table */
-        for(i = 0; i < numDevices; i++, pDevList++)
+        Llc_deviceListItem_t item;
+        Llc_deviceListItem_t *pItem = &item;
+
+        if(pDevList != NULL)
         {
-            /* Add to association table */
-            maintainAssocTable(&pDevList->devInfo, &pDevList->capInfo, 1, 0,
-                               (false));
+            pItem = &pDevList[i];
         }
-    }
-    else
-    {
-        Llc_deviceListItem_t item;
-        /* repopulate association table */
-        for(i = 0; i < numDevices; i++)
+        else if(Csf_getDeviceItem(i, &item) == false)
         {
-            Csf_getDeviceItem(i, &item);
+            continue;
+        }
+
 #ifdef FEATURE_MAC_SECURITY
-            /* Add device to security device table */
-            Cllc_addSecDevice(item.devInfo.panID,
-                              item.devInfo.shortAddress,
-                              &item.devInfo.extAddress,
-                              item.rxFrameCounter);
+        /* Add device to security device table */
+        Cllc_addSecDevice(pItem->devInfo.panID,
+                          pItem->devInfo.shortAddress,
+                          &pItem->devInfo.extAddress,
+                          pItem->rxFrameCounter);
 #endif /* FEATURE_MAC_SECURITY */
-            /* Add to association table */
-            maintainAssocTable(&item.devInfo, &item.capInfo, 1, 0,
-                               (false));
+        /* Add to association table */
+        maintainAssocTable(&pItem->devInfo, &pItem->capInfo, 1, 0,
+                           (false));
 #ifdef FEATURE_SECURE_COMMISSIONING
+        {
+            /* Mark the devices that need to be re-commissioned */
+            Cllc_associated_devices_t *pExistingDevice;
+            pExistingDevice = Cllc_findDevice(pItem->devInfo.shortAddress);
+            if(pExistingDevice != NULL)
             {
-                /* Mark the devices that need to be re-commissioned */
-                Cllc_associated_devices_t *pExistingDevice;
-                pExistingDevice = Cllc_findDevice(item.devInfo.shortAddress);
-                if(pExistingDevice != NULL)
-                {
-                    pExistingDevice->reCM_status = SM_RE_CM_REQUIRED;
-                    /* Do not update key refresh info here. It should be done when CM is done */
-                }
+                pExistingDevice->reCM_status = SM_RE_CM_REQUIRED;
+                /* Do not update key refresh info here. It should be done when CM is done */
             }
-#endif
-
         }
+#endif
     }
+
+    sendStartReq(pNetworkInfo->fh, false);
 }
 
 /*!
@@ -863,6 +1000,7 @@ ApiMac_status_t Cllc_setJoinPermit(uint32_t duration)
     {
         /*  set join permit */
         ApiMac_mlmeSetReqBool(ApiMac_attribute_associatePermit, true);
+        joinBurstSet(true);
         updateState(Cllc_states_joiningAllowed);
         if(duration != CLLC_JOIN_PERMIT_ON)
         {
@@ -874,6 +1012,7 @@ ApiMac_status_t Cllc_setJoinPermit(uint32_t duration)
     {
         /*  set join permit */
         ApiMac_mlmeSetReqBool(ApiMac_attribute_associatePermit, false);
+        joinBurstSet(false);
         updateState(Cllc_states_joiningNotAllowed);
     }
 
@@ -1104,6 +1243,101 @@ Cllc_associated_devices_t *Cllc_findDevice(uint16_t shortAddr)
     return (NULL);
 }
 
+/*!
+ Find the associated device table entry matching an extended address.
+
+ Public function defined in cllc.h
+ */
+Cllc_associated_devices_t *Cllc_findDeviceExt(ApiMac_sAddrExt_t *pExtAddr)
+{
+    int x;
+
+    for(x = 0; (x < CONFIG_MAX_DEVICES); x++)
+    {
+        /* Make sure the entry is valid. */
+        if((Cllc_associatedDevList[x].shortAddr != CSF_INVALID_SHORT_ADDR) &&
+           (memcmp(pExtAddr, &Cllc_associatedDevList[x].extAddr,
+                   APIMAC_SADDR_EXT_LEN) == 0))
+        {
+            return (&Cllc_associatedDevList[x]);
+        }
+    }
+    return (NULL);
+}
+
+/*!
+ Record the result of a transmission
+
+ Public function defined in cllc.h
+ */
+void Cllc_updateTxStatus(ApiMac_status_t status)
+{
+    if(chanTxAttempts < UINT16_MAX)
+    {
+        chanTxAttempts++;
+        if((status == ApiMac_status_channelAccessFailure) ||
+           (status == ApiMac_status_noAck))
+        {
+            chanTxFailures++;
+        }
+    }
+}
+
+/*!
+ Record reported message statistics
+
+ Public function defined in cllc.h
+ */
+void Cllc_updateLinkStats(uint16_t shortAddr, uint16_t msgsAttempted,
+                          uint16_t msgFailures)
+{
+    Cllc_associated_devices_t *pItem = Cllc_findDevice(shortAddr);
+
+    if((pItem == NULL) || (shortAddr == CSF_INVALID_SHORT_ADDR))
+    {
+        return;
+    }
+
+    /* Totals that went down mean the device was reset */
+    if((pItem->msgsAttempted != CLLC_LINK_STATS_UNKNOWN) &&
+       (msgsAttempted >= pItem->msgsAttempted) &&
+       (msgFailures >= pItem->msgFailures))
+    {
+        uint16_t attempts = msgsAttempted - pItem->msgsAttempted;
+        uint16_t failures = msgFailures - pItem->msgFailures;
+
+        if(failures > attempts)
+        {
+            failures = attempts;
+        }
+        if((UINT16_MAX - chanTxAttempts) >= attempts)
+        {
+            chanTxAttempts += attempts;
+            chanTxFailures += failures;
+        }
+    }
+
+    pItem->msgsAttempted = msgsAttempted;
+    pItem->msgFailures = msgFailures;
+}
+
+/*!
+ Get the noise history of a channel
+
+ Public function defined in cllc.h
+ */
+uint8_t Cllc_getChanNoise(uint8_t channel)
+{
+    if((channel >= APIMAC_154G_MAX_NUM_CHANNEL) ||
+       (chanNoise[channel] == CLLC_CHAN_NOISE_UNKNOWN))
+    {
+        return (CLLC_MAX_ENERGY);
+    }
+
+    /* Round to the nearest level */
+    return ((uint8_t)((chanNoise[channel] + 0x80) >> 8));
+}
+
 /******************************************************************************
  Local Functions
  *****************************************************************************/
@@ -1156,7 +1390,7 @@ static void processState(Cllc_coord_states_t state)
                 ApiMac_mlmeSetReqUint16(ApiMac_attribute_shortAddress,
                                         coordInfoBlock.shortAddr);
             }
-            sendStartReq(CONFIG_FH_ENABLE);
+            sendStartReq(CONFIG_FH_ENABLE, false);
             break;
 
         case Cllc_coordStates_startCnf:
@@ -1183,12 +1417,21 @@ static void processState(Cllc_coord_states_t state)
             if(CONFIG_FH_ENABLE)
             {
                 ApiMac_startFH();
-                /* start trickle timer for PA */
-                Csf_setTrickleClock(CLLC_FH_MIN_TRICKLE,
-                                    ApiMac_wisunAsyncFrame_advertisement);
-                /* start trickle timer for PC */
-                Csf_setTrickleClock(CLLC_FH_MIN_TRICKLE + (CLLC_FH_MIN_TRICKLE/2),
-                                    ApiMac_wisunAsyncFrame_config);
+                /* start trickle timers for PA and PC */
+                fhPAtrickleTime = CLLC_FH_MIN_TRICKLE;
+                fhPCtrickleTime = CLLC_FH_MIN_TRICKLE;
+                trickleStart(&fhPAtrickleTime,
+                             ApiMac_wisunAsyncFrame_advertisement);
+                trickleStart(&fhPCtrickleTime, ApiMac_wisunAsyncFrame_config);
+                fhTrickleRunning = true;
+
+                if(coordInfoBlock.currentCllcState ==
+                                Cllc_states_initRestoringCoordinator)
+                {
+                    /* Orphaned devices listen for a PC to get back in sync,
+                       don't make them wait for the trickle timer */
+                    sendAsyncReq(ApiMac_wisunAsyncFrame_config);
+                }
             }
 
             /* Inform the application of a start */
@@ -1197,8 +1440,19 @@ static void processState(Cllc_coord_states_t state)
                 pCllcCallbacksCopy->pStartedCb(&networkInfo);
             }
 
+            if(!CONFIG_FH_ENABLE)
+            {
+                /* (re)start watching for interference */
+                Csf_setChanScanClock(CLLC_CHAN_SCAN_INTERVAL);
+            }
+
             /*  coordinator started , callback for start indication*/
-            if(coordInfoBlock.currentCllcState ==
+            if(chanScanState == chanScanStates_realign)
+            {
+                /* Moved channel, the network state is unchanged */
+                chanScanState = chanScanStates_idle;
+            }
+            else if(coordInfoBlock.currentCllcState ==
                             Cllc_states_initRestoringCoordinator)
             {
                 updateState(Cllc_states_restored);
@@ -1261,7 +1515,12 @@ static void configureStartParam(uint8_t channel)
  */
 static void scanCnfCb(ApiMac_mlmeScanCnf_t *pData)
 {
-    if((pData->status == ApiMac_status_success) || (pData->status
+    if(chanScanState != chanScanStates_idle)
+    {
+        /* Background scan of a running network */
+        chanScanCnf(pData);
+    }
+    else if((pData->status == ApiMac_status_success) || (pData->status
                       == ApiMac_status_noBeacon))
     {
         if(pData->scanType == ApiMac_scantype_active)
@@ -1270,6 +1529,18 @@ static void scanCnfCb(ApiMac_mlmeScanCnf_t *pData)
         }
         else if(pData->scanType == ApiMac_scantype_energyDetect)
         {
+            uint8_t chan;
+
+            /* The formation scan starts the noise history */
+            for(chan = 0; chan < APIMAC_154G_MAX_NUM_CHANNEL; chan++)
+            {
+                if(CLLC_IS_CHANNEL_MASK_SET(chanMask, chan))
+                {
+                    chanNoise[chan] = CLLC_CHAN_NOISE_UNKNOWN;
+                    chanNoiseUpdate(chan, pData->result.pEnergyDetect[chan]);
+                }
+            }
+
             coordInfoBlock.channel
                   = findBestChannel(pData->result.pEnergyDetect);
             switchState(Cllc_coordStates_scanEdCnf);
@@ -1305,8 +1576,18 @@ static void startCnfCb(ApiMac_mlmeStartCnf_t *pData)
             ApiMac_srcMatchEnable();
         }
 #endif
+        if(chanScanState == chanScanStates_realign)
+        {
+            Cllc_statistics.chanMigrations++;
+        }
         switchState(Cllc_coordStates_startCnf);
     }
+    else if(chanScanState == chanScanStates_realign)
+    {
+        /* Still on the old channel, keep the network there */
+        coordInfoBlock.channel = chanPrevious;
+        chanScanState = chanScanStates_idle;
+    }
     else
     {
         switchState(Cllc_coordStates_scanActive);
@@ -1465,6 +1746,20 @@ static void assocIndCb(ApiMac_mlmeAssociateInd_t *pData)
     /* Device joining callback */
     ApiMac_deviceDescriptor_t devInfo;
     ApiMac_mlmeAssociateRsp_t assocRsp;
+    Cllc_associated_devices_t *pExistingDevice = NULL;
+
+#ifdef NV_RESTORE
+    /* The association table holds every device in NV, check it first */
+    pExistingDevice = Cllc_findDeviceExt(&pData->deviceAddress);
+#endif
+
+    if((pExistingDevice == NULL) && (Csf_admitJoin() == false))
+    {
+        /* Too many devices joining at once. Don't respond, the device
+           retries after its scan backoff */
+        Cllc_statistics.assocDeferred++;
+        return;
+    }
 
 #ifdef FEATURE_SECURE_COMMISSIONING
     uint32_t duration=0;
@@ -1483,7 +1778,8 @@ static void assocIndCb(ApiMac_mlmeAssociateInd_t *pData)
     devInfo.shortAddress = CSF_INVALID_SHORT_ADDR;
 #else
     /* Check to see if the device exists */
-    devInfo.shortAddress = Csf_getDeviceShort(&pData->deviceAddress);
+    devInfo.shortAddress = (pExistingDevice != NULL) ?
+                    pExistingDevice->shortAddr : CSF_INVALID_SHORT_ADDR;
 #endif
     if(devInfo.shortAddress == CSF_INVALID_SHORT_ADDR)
     {
@@ -1599,24 +1895,23 @@ static void maintainAssocTable(ApiMac_deviceDescriptor_t *pDevInfo,
 
             /* insert one of the blank spaces in the table */
             pItem->shortAddr = pDevInfo->shortAddress;
+            Util_copyExtAddr(&pItem->extAddr, &pDevInfo->extAddress);
             memcpy(&pItem->capInfo, pCapInfo, sizeof(ApiMac_capabilityInfo_t));
             pItem->rssi = rssi;
             pItem->status = status;
+            pItem->msgsAttempted = CLLC_LINK_STATS_UNKNOWN;
+            pItem->msgFailures = CLLC_LINK_STATS_UNKNOWN;
         }
     }
     else if(mode == true)
     {
-        uint16_t shortAddr = Csf_getDeviceShort(&pDevInfo->extAddress);
-        if(shortAddr != CSF_INVALID_SHORT_ADDR)
-        {
-            static Cllc_associated_devices_t *pItem;
+        Cllc_associated_devices_t *pItem;
 
-            pItem = Cllc_findDevice(shortAddr);
-            if(pItem != NULL)
-            {
-                pItem->rssi = rssi;
-                pItem->status = status;
-            }
+        pItem = Cllc_findDeviceExt(&pDevInfo->extAddress);
+        if(pItem != NULL)
+        {
+            pItem->rssi = rssi;
+            pItem->status = status;
         }
     }
 }
@@ -1632,6 +1927,7 @@ static void wsAsyncIndCb(ApiMac_mlmeWsAsyncInd_t *pData)
     ApiMac_payloadIeRec_t *pPayloadGroupRec = NULL;
     uint8_t netname[32];
     bool netNameIEFound = false;
+    bool sameSchedule = false;
 
     /* Parse group IEs */
     status = ApiMac_parsePayloadGroupIEs(pData->pPayloadIE, pData->payloadIeLen,
@@ -1673,8 +1969,8 @@ static void wsAsyncIndCb(ApiMac_mlmeWsAsyncInd_t *pData)
                                 }
                                 break;
                             case ApiMac_wisunSubIE_USIE:
-                                processIncomingAsyncUSIE(pData->fhFrameType,
-                                                         pIEContent);
+                                sameSchedule = processIncomingAsyncUSIE(
+                                                pData->fhFrameType, pIEContent);
                                 break;
                             default:
                                 break;
@@ -1710,7 +2006,7 @@ static void wsAsyncIndCb(ApiMac_mlmeWsAsyncInd_t *pData)
         return;
     }
 
-    processIncomingFHframe(pData->fhFrameType);
+    processIncomingFHframe(pData, sameSchedule);
 
     if(macCallbacksCopy.pWsAsyncIndCb != NULL)
     {
@@ -1803,26 +2099,26 @@ static void resetIndCb(ApiMac_mcpsResetInd_t *pResetInd)
  */
 static void orphanIndCb(ApiMac_mlmeOrphanInd_t *pData)
 {
-    Llc_deviceListItem_t item;
-    ApiMac_sAddr_t devAddr;
-    devAddr.addrMode = ApiMac_addrType_extended;
-    memcpy(&devAddr.addr.extAddr, &pData->orphanAddress,
-           sizeof(ApiMac_sAddrExt_t));
+    /* The association table holds every device in NV, look the orphan up
+       there like a joining device */
+    Cllc_associated_devices_t *pItem =
+                    Cllc_findDeviceExt(&pData->orphanAddress);
 
-    if(Csf_getDevice(&devAddr, &item))
+    if(pItem != NULL)
     {
         ApiMac_mlmeOrphanRsp_t orphanRsp;
 
         /* Send orphan response */
-        Util_copyExtAddr(&orphanRsp.orphanAddress, &item.devInfo.extAddress);
+        Util_copyExtAddr(&orphanRsp.orphanAddress, &pItem->extAddr);
         memset(&orphanRsp.sec, 0, sizeof(ApiMac_sec_t));
         orphanRsp.associatedMember = true;
-        orphanRsp.shortAddress = item.devInfo.shortAddress;
+        orphanRsp.shortAddress = pItem->shortAddr;
 
         ApiMac_mlmeOrphanRsp(&orphanRsp);
 
         /* Update Assoc Table */
-        maintainAssocTable(&item.devInfo, &item.capInfo, 1, 0, (true));
+        pItem->rssi = 1;
+        pItem->status = 0;
     }
 
     /* Invoke call back from cllc into application layer/collector if not NULL */
@@ -1971,6 +2267,7 @@ static void joinPermitExpired(void)
 {
     /* set join permit to false */
     ApiMac_mlmeSetReqBool(ApiMac_attribute_associatePermit, false);
+    joinBurstSet(false);
     updateState(Cllc_states_joiningNotAllowed);
 }
 
@@ -1978,8 +2275,10 @@ static void joinPermitExpired(void)
  * @brief       Send Start Request
  *
  * @param       startFH - true if FH enable else false
+ * @param       coordRealign - true to move a running network to
+ *                             coordInfoBlock.channel
  */
-static void sendStartReq(bool startFH)
+static void sendStartReq(bool startFH, bool coordRealign)
 {
     ApiMac_mlmeStartReq_t startReq;
     memset(&startReq, 0, sizeof(ApiMac_mlmeStartReq_t));
@@ -1994,7 +2293,7 @@ static void sendStartReq(bool startFH)
     startReq.superframeOrder = CONFIG_MAC_SUPERFRAME_ORDER;
     startReq.panCoordinator = true;
     startReq.batteryLifeExt = false;
-    startReq.coordRealignment = false;
+    startReq.coordRealignment = coordRealign;
     startReq.realignSec.securityLevel = false;
     startReq.startFH = startFH;
     startReq.mpmParams.offsetTimeSlot = CLLC_OFFSET_TIMESLOT;
@@ -2038,7 +2337,8 @@ static void sendScanReq(ApiMac_scantype_t type)
 }
 
 /*!
- * @brief       Set Trickle time
+ * @brief       Handle a trickle clock expiry, either the transmit point or
+ *              the end of the interval
  *
  * @param       pTrickleTime - pointer to trickle time duration variable type
  *                            fhPAtrickleTime or fhPCtrickleTime
@@ -2046,68 +2346,189 @@ static void sendScanReq(ApiMac_scantype_t type)
  */
 static void setTrickleTime(uint32_t *pTrickleTime, uint8_t frameType)
 {
-    if(CONFIG_DOUBLE_TRICKLE_TIMER)
+    trickleState_t *pTrickle = trickleState(frameType);
+
+    if(pTrickle->txPending)
     {
-        if((2 * (*pTrickleTime)) < CLLC_FH_MAX_TRICKLE)
+        pTrickle->txPending = false;
+
+        /* Send unless enough consistent frames were heard already */
+        if((CLLC_FH_TRICKLE_K == 0) || (pTrickle->counter < CLLC_FH_TRICKLE_K))
         {
-            *pTrickleTime = 2 * (*pTrickleTime);
+            sendAsyncReq(frameType);
         }
-        else if(((2 * (*pTrickleTime)) == CLLC_FH_MAX_TRICKLE) ||
-               ((2 * (*pTrickleTime)) > CLLC_FH_MAX_TRICKLE))
+        else if(frameType == ApiMac_wisunAsyncFrame_advertisement)
         {
-            (*pTrickleTime) = CLLC_FH_MAX_TRICKLE;
+            Cllc_statistics.fhNumPASuppressed++;
+        }
+        else
+        {
+            Cllc_statistics.fhNumPANConfigSuppressed++;
+        }
+
+        if(CONFIG_DOUBLE_TRICKLE_TIMER || fhJoinBurst)
+        {
+            /* Wait for the end of the interval */
+            Csf_setTrickleClock(pTrickle->restOfInterval, frameType);
+        }
+        else
+        {
+            /* One frame per solicit */
+            *pTrickleTime = 0;
         }
-        /* Reset trickle timer */
-        Csf_setTrickleClock((*pTrickleTime),frameType);
     }
     else
     {
-        *pTrickleTime = 0;
+        uint32_t maxTrickle = CLLC_FH_MAX_TRICKLE;
+
+        if(fhJoinBurst && (CLLC_FH_JOIN_MAX_TRICKLE < maxTrickle))
+        {
+            maxTrickle = CLLC_FH_JOIN_MAX_TRICKLE;
+        }
+
+        /* End of the interval, double it */
+        if((2 * (*pTrickleTime)) < maxTrickle)
+        {
+            *pTrickleTime = 2 * (*pTrickleTime);
+        }
+        else
+        {
+            *pTrickleTime = maxTrickle;
+        }
+        trickleStart(pTrickleTime, frameType);
     }
-    /* Process LLC Event */
-    sendAsyncReq(frameType);
 }
 
 /*!
- * @brief       Process incoming FH frame
+ * @brief       Begin a trickle interval, arming the clock for a random
+ *              transmit point in its second half
  *
+ * @param       pTrickleTime - pointer to the interval, fhPAtrickleTime or
+ *                            fhPCtrickleTime
  * @param       frameType   - type of FH frame to be sent
  */
-static void processIncomingFHframe(uint8_t frameType)
+static void trickleStart(uint32_t *pTrickleTime, uint8_t frameType)
 {
+    trickleState_t *pTrickle = trickleState(frameType);
+    uint32_t txTime = *pTrickleTime;
+
+    if(txTime > 1)
+    {
+        uint16_t randomNum = ((ApiMac_randomByte() << 8) +
+                              ApiMac_randomByte());
+
+        txTime = (*pTrickleTime >> 1) + (randomNum % (*pTrickleTime >> 1));
+    }
+
+    pTrickle->counter = 0;
+    pTrickle->txPending = true;
+    pTrickle->restOfInterval = *pTrickleTime - txTime;
+
+    Csf_setTrickleClock(txTime, frameType);
+}
+
+/*!
+ * @brief       Go back to the shortest interval after an inconsistency
+ *
+ * @param       pTrickleTime - pointer to the interval, fhPAtrickleTime or
+ *                            fhPCtrickleTime
+ * @param       frameType   - type of FH frame to be sent
+ */
+static void trickleReset(uint32_t *pTrickleTime, uint8_t frameType)
+{
+    /* reset trickle timer only if trickleTime not at Min */
+    if(*pTrickleTime != CLLC_FH_MIN_TRICKLE)
+    {
+        *pTrickleTime = CLLC_FH_MIN_TRICKLE;
+        trickleStart(pTrickleTime, frameType);
+    }
+}
+
+/*!
+ * @brief       Get the trickle state of a frame type
+ *
+ * @param       frameType   - ApiMac_wisunAsyncFrame_advertisement or
+ *                            ApiMac_wisunAsyncFrame_config
+ *
+ * @return      pointer to the state
+ */
+static trickleState_t *trickleState(uint8_t frameType)
+{
+    if(frameType == ApiMac_wisunAsyncFrame_advertisement)
+    {
+        return(&fhPAtrickle);
+    }
+    return(&fhPCtrickle);
+}
+
+/*!
+ * @brief       Start or end the short trickle intervals used while join
+ *              permit is open
+ *
+ * @param       enable - true when join permit opens, false when it closes
+ */
+static void joinBurstSet(bool enable)
+{
+    bool opening = (enable && !fhJoinBurst);
+
+    fhJoinBurst = enable;
+
+    if(CONFIG_FH_ENABLE && opening && fhTrickleRunning)
+    {
+        /* Advertise promptly to the devices about to join */
+        trickleReset(&fhPAtrickleTime, ApiMac_wisunAsyncFrame_advertisement);
+        trickleReset(&fhPCtrickleTime, ApiMac_wisunAsyncFrame_config);
+    }
+}
+
+/*!
+ * @brief       Process incoming FH frame
+ *
+ * @param       pData        - pointer to Async indication structure
+ * @param       sameSchedule - true if the US IE shows our channel function
+ */
+static void processIncomingFHframe(ApiMac_mlmeWsAsyncInd_t *pData,
+                                   bool sameSchedule)
+{
+    uint8_t frameType = pData->fhFrameType;
+    /* Only a PA/PC of our own PAN and schedule counts toward suppression */
+    bool consistent = (sameSchedule &&
+                       (pData->srcPanId == coordInfoBlock.panID));
 
     if(frameType == ApiMac_fhFrameType_panAdvertSolicit)
     {
-        if(fhPAtrickleTime != CLLC_FH_MIN_TRICKLE)
-        {
-            fhPAtrickleTime = CLLC_FH_MIN_TRICKLE;
-            /* reset trickle timer only if trickleTime not at Min */
-            Csf_setTrickleClock(fhPAtrickleTime,
-                                ApiMac_wisunAsyncFrame_advertisement);
-        }
+        trickleReset(&fhPAtrickleTime, ApiMac_wisunAsyncFrame_advertisement);
         /* PAS is received , increment statistics */
         Cllc_statistics.fhNumPASolicitReceived++;
     }
     else if(frameType == ApiMac_fhFrameType_configSolicit)
     {
-        if(fhPCtrickleTime != CLLC_FH_MIN_TRICKLE)
-        {
-            fhPCtrickleTime = CLLC_FH_MIN_TRICKLE;
-            /* reset trickle timer only if trickleTime not at Min */
-            Csf_setTrickleClock(fhPCtrickleTime,
-                                ApiMac_wisunAsyncFrame_config);
-        }
+        trickleReset(&fhPCtrickleTime, ApiMac_wisunAsyncFrame_config);
         /* PCS is received , increment statistics */
         Cllc_statistics.fhNumPANConfigSolicitsReceived++;
     }
+    else if((frameType == ApiMac_fhFrameType_panAdvert) && consistent &&
+            (fhPAtrickle.counter < 0xFF))
+    {
+        /* A consistent PA from our network */
+        fhPAtrickle.counter++;
+    }
+    else if((frameType == ApiMac_fhFrameType_config) && consistent &&
+            (fhPCtrickle.counter < 0xFF))
+    {
+        /* A consistent PC from our network */
+        fhPCtrickle.counter++;
+    }
 }
 
 /*!
  * @brief       Process incoming Async US IE content
  *
  * @param       pIEContent   - Pointer to USIE Content
+ *
+ * @return      true if the sender hops on our channel function
  */
-static void processIncomingAsyncUSIE(uint8_t frameType, uint8_t* pIEContent)
+static bool processIncomingAsyncUSIE(uint8_t frameType, uint8_t* pIEContent)
 {
     uint8_t channelInfo = *(pIEContent + 3);
     uint8_t chPlan = channelInfo & 7;
@@ -2150,4 +2571,219 @@ static void processIncomingAsyncUSIE(uint8_t frameType, uint8_t* pIEContent)
             optAsyncFlag |= PC_HOP_NEIGHBOR_FOUND_MASK;
         }
     }
+
+    return (chFn == CLLC_FH_CHANNEL_FUNCTION);
+}
+
+/*!
+ * @brief       Start the next background scan, if the network is running
+ *              and no other scan is in progress
+ */
+static void chanScanStart(void)
+{
+    uint8_t chan;
+
+    if((CLLC_CHAN_SCAN_INTERVAL == 0) || CONFIG_FH_ENABLE ||
+       (coordInfoBlock.currentCoordState != Cllc_coordStates_startCnf))
+    {
+        return;
+    }
+
+    Csf_setChanScanClock(CLLC_CHAN_SCAN_INTERVAL);
+
+    if(chanScanState != chanScanStates_idle)
+    {
+        return;
+    }
+
+    /* Fold the transmissions since the last scan into the failure rate */
+    if(chanTxAttempts >= CLLC_CHAN_MIN_ATTEMPTS)
+    {
+        int32_t rate = ((uint32_t)chanTxFailures << 8) / chanTxAttempts;
+
+        chanFailRate += (rate - (int32_t)chanFailRate) >> CLLC_CHAN_NOISE_SHIFT;
+        chanTxAttempts = 0;
+        chanTxFailures = 0;
+    }
+
+    /* Alternate between the current channel and the others in the mask */
+    chanScanCurrent = !chanScanCurrent;
+    chanScanChannel = coordInfoBlock.channel;
+    if(chanScanCurrent == false)
+    {
+        chan = chanScanOther;
+        do
+        {
+            chan = (chan + 1) % APIMAC_154G_MAX_NUM_CHANNEL;
+            if(CLLC_IS_CHANNEL_MASK_SET(chanMask, chan) &&
+               (chan != coordInfoBlock.channel))
+            {
+                chanScanChannel = chan;
+                break;
+            }
+        } while(chan != chanScanOther);
+        chanScanOther = chanScanChannel;
+    }
+
+    chanScanState = chanScanStates_energyDetect;
+    sendChanScanReq(ApiMac_scantype_energyDetect, chanScanChannel);
+}
+
+/*!
+ * @brief       Process the scan confirm of a background scan
+ *
+ * @param       pData - pointer to Scan Confirm
+ */
+static void chanScanCnf(ApiMac_mlmeScanCnf_t *pData)
+{
+    if(chanScanState == chanScanStates_energyDetect)
+    {
+        chanScanState = chanScanStates_idle;
+
+        if((pData->status == ApiMac_status_success) &&
+           (pData->scanType == ApiMac_scantype_energyDetect) &&
+           (pData->result.pEnergyDetect != NULL))
+        {
+            Cllc_statistics.chanScans++;
+            chanNoiseUpdate(chanScanChannel,
+                            pData->result.pEnergyDetect[chanScanChannel]);
+            chanEvaluate();
+        }
+    }
+    else if(chanScanState == chanScanStates_active)
+    {
+        chanScanState = chanScanStates_idle;
+
+        if((pData->status == ApiMac_status_success) ||
+           (pData->status == ApiMac_status_noBeacon))
+        {
+            if(findChannel(coordInfoBlock.panID, chanScanChannel) ==
+               CLLC_PAN_NOT_FOUND)
+            {
+                /* Move the network, devices follow the realignment */
+                chanPrevious = coordInfoBlock.channel;
+                coordInfoBlock.channel = chanScanChannel;
+                chanFailRate = 0;
+                chanTxAttempts = 0;
+                chanTxFailures = 0;
+                chanScanState = chanScanStates_realign;
+                chanHoldoff = CLLC_CHAN_HOLDOFF_SCANS;
+                sendStartReq(false, true);
+            }
+            else
+            {
+                /* Our PAN ID is taken there, make it look busy */
+                chanNoise[chanScanChannel] = (uint16_t)CLLC_MAX_ENERGY << 8;
+            }
+        }
+
+        clearPANList();
+    }
+}
+
+/*!
+ * @brief       Add an energy detect sample to a channel's noise history
+ *
+ * @param       channel - channel scanned
+ * @param       energy - energy detect result
+ */
+static void chanNoiseUpdate(uint8_t channel, uint8_t energy)
+{
+    int32_t sample = (int32_t)energy << 8;
+
+    if(chanNoise[channel] == CLLC_CHAN_NOISE_UNKNOWN)
+    {
+        chanNoise[channel] = (uint16_t)sample;
+    }
+    else
+    {
+        chanNoise[channel] += (sample - (int32_t)chanNoise[channel]) >>
+                              CLLC_CHAN_NOISE_SHIFT;
+    }
+}
+
+/*!
+ * @brief       Compare the current channel with the best other one, and
+ *              start moving the network once it has been worse for long
+ *              enough
+ */
+static void chanEvaluate(void)
+{
+    uint8_t chan;
+    uint8_t bestChan = coordInfoBlock.channel;
+    uint32_t bestCost = UINT32_MAX;
+    uint32_t currCost;
+
+    if(chanHoldoff > 0)
+    {
+        chanHoldoff--;
+        return;
+    }
+
+    if(chanNoise[coordInfoBlock.channel] == CLLC_CHAN_NOISE_UNKNOWN)
+    {
+        return;
+    }
+
+    /* Noise and failures on the current channel, noise only elsewhere */
+    currCost = chanNoise[coordInfoBlock.channel] +
+               (((uint32_t)chanFailRate * CLLC_CHAN_FAIL_WEIGHT));
+
+    for(chan = 0; chan < APIMAC_154G_MAX_NUM_CHANNEL; chan++)
+    {
+        if(CLLC_IS_CHANNEL_MASK_SET(chanMask, chan) &&
+           (chan != coordInfoBlock.channel) &&
+           (chanNoise[chan] != CLLC_CHAN_NOISE_UNKNOWN) &&
+           (chanNoise[chan] < bestCost))
+        {
+            bestChan = chan;
+            bestCost = chanNoise[chan];
+        }
+    }
+
+    if((bestChan == coordInfoBlock.channel) ||
+       (currCost <= (bestCost + ((uint32_t)CLLC_CHAN_HYSTERESIS << 8))))
+    {
+        chanDegradedCount = 0;
+        return;
+    }
+
+    if(++chanDegradedCount >= CLLC_CHAN_DEGRADED_COUNT)
+    {
+        chanDegradedCount = 0;
+
+        /* Look for a network with our PAN ID there first */
+        clearPANList();
+        chanScanChannel = bestChan;
+        chanScanState = chanScanStates_active;
+        sendChanScanReq(ApiMac_scantype_active, bestChan);
+    }
+}
+
+/*!
+ * @brief       Send a scan request for one channel of a running network
+ *
+ * @param       type - type of scan: active or energy detect
+ * @param       channel - channel to scan
+ */
+static void sendChanScanReq(ApiMac_scantype_t type, uint8_t channel)
+{
+    ApiMac_mlmeScanReq_t scanReq;
+
+    memset(&scanReq, 0, sizeof(ApiMac_mlmeScanReq_t));
+    CLLC_SET_CHANNEL(scanReq.scanChannels, channel);
+    scanReq.scanType = type;
+    scanReq.scanDuration = CLLC_CHAN_SCAN_DURATION;
+    scanReq.maxResults = 0;/* Expecting beacon notifications */
+    scanReq.permitJoining = false;
+    scanReq.linkQuality = CONFIG_LINKQUALITY;
+    scanReq.percentFilter = CONFIG_PERCENTFILTER;
+    scanReq.channelPage = CONFIG_CHANNEL_PAGE;
+    scanReq.phyID = CONFIG_PHY_ID;
+
+    if(ApiMac_mlmeScanReq(&scanReq) != ApiMac_status_success)
+    {
+        /* Try again at the next interval */
+        chanScanState = chanScanStates_idle;
+    }
 }
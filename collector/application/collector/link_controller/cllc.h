@@ -73,6 +73,8 @@ extern "C"
 #define CLLC_JOIN_EVT           0x0004
 /*! Event ID - State change event */
 #define CLLC_STATE_CHANGE_EVT   0x0008
+/*! Event ID - Background channel scan */
+#define CLLC_CHAN_SCAN_EVT      0x0010
 
 /*! Association status */
 #define CLLC_ASSOC_STATUS_ALIVE 0x0001
@@ -122,6 +124,8 @@ typedef struct
 {
     /*! Short address of associated device */
     uint16_t shortAddr;
+    /*! Extended address of associated device */
+    ApiMac_sAddrExt_t extAddr;
     /*! capability information */
     ApiMac_capabilityInfo_t capInfo;
     /*! RSSI */
@@ -136,6 +140,10 @@ typedef struct
 #ifdef USE_DMM
     uint8_t sensorData;
 #endif
+    /*! Messages attempted in the device's last statistics report */
+    uint16_t msgsAttempted;
+    /*! Channel access and ack failures in the last statistics report */
+    uint16_t msgFailures;
 } Cllc_associated_devices_t;
 
 /*! Cllc statistics */
@@ -150,6 +158,16 @@ typedef struct
     /*! number of PC messages sent */
     uint32_t fhNumPANConfigSent;
     uint32_t otherStats;
+    /*! number of background energy detect scans */
+    uint32_t chanScans;
+    /*! number of moves to a quieter channel */
+    uint32_t chanMigrations;
+    /*! number of PA messages suppressed by trickle */
+    uint32_t fhNumPASuppressed;
+    /*! number of PC messages suppressed by trickle */
+    uint32_t fhNumPANConfigSuppressed;
+    /*! number of association requests left for the device to retry */
+    uint32_t assocDeferred;
 } Cllc_statistics_t;
 
 /*! Association table */
@@ -342,13 +360,15 @@ extern void Cllc_startNetwork(void);
  *              information needed to restore the device.
  *              <BR>
  *              This module will configure the MAC with all the network
- *              information then start the coordinator without scanning.
+ *              information and devices, then start the coordinator without
+ *              scanning.
  *
  * @param       pNetworkInfo - network information
  * @param       numDevices - number of devices in association table
- * @param       pDevList - list of devices
+ * @param       pDevList - list of devices, or NULL to read them from NV
+ *                         one at a time
  */
-extern void Cllc_restoreNetwork(Llc_netInfo_t *pNetworkInfo, uint8_t numDevices,
+extern void Cllc_restoreNetwork(Llc_netInfo_t *pNetworkInfo, uint16_t numDevices,
 		Llc_deviceListItem_t *pDevList);
 /*!
  * @brief       Remove device from the network.
@@ -425,8 +445,39 @@ extern ApiMac_status_t Cllc_addSecDevice(uint16_t panID,
                                               uint32_t frameCounter);
 
 /*!
- * @brief      Find the associated device table entry matching an
- *             extended address.
+ * @brief      Record the result of a transmission by this coordinator, for
+ *             the quality estimate of the current channel.
+ *
+ * @param      status - status of the MAC data confirm
+ */
+extern void Cllc_updateTxStatus(ApiMac_status_t status);
+
+/*!
+ * @brief      Record the message statistics a device reported, for the
+ *             quality estimate of the current channel. The counts are the
+ *             device's running totals; the change since its last report
+ *             is what gets used.
+ *
+ * @param      shortAddr - device's short address
+ * @param      msgsAttempted - messages the device attempted
+ * @param      msgFailures - channel access and ack failures the device had
+ */
+extern void Cllc_updateLinkStats(uint16_t shortAddr, uint16_t msgsAttempted,
+                                 uint16_t msgFailures);
+
+/*!
+ * @brief      Get the noise history of a channel
+ *
+ * @param      channel - channel
+ *
+ * @return     averaged energy detect level (0-255), 255 if the
+ *             channel hasn't been measured
+ */
+extern uint8_t Cllc_getChanNoise(uint8_t channel);
+
+/*!
+ * @brief      Find the associated device table entry matching a
+ *             short address.
  *
  * @param      shortAddr - device's short address
  *
@@ -434,6 +485,18 @@ extern ApiMac_status_t Cllc_addSecDevice(uint16_t panID,
  *             NULL if not found.
  */
 extern Cllc_associated_devices_t *Cllc_findDevice(uint16_t shortAddr);
+
+/*!
+ * @brief      Find the associated device table entry matching an
+ *             extended address.
+ *
+ * @param      pExtAddr - device's extended address
+ *
+ * @return     pointer to the associated device table entry,
+ *             NULL if not found.
+ */
+extern Cllc_associated_devices_t *Cllc_findDeviceExt(
+                ApiMac_sAddrExt_t *pExtAddr);
 //*****************************************************************************
 //*****************************************************************************
 
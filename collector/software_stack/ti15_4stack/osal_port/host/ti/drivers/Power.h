@@ -0,0 +1,2 @@
+#pragma once
+static inline void Power_setConstraint(int c){(void)c;} static inline void Power_releaseConstraint(int c){(void)c;}
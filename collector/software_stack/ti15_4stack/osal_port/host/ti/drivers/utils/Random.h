@@ -0,0 +1,2 @@
+#pragma once
+static inline unsigned Random_getNumber(void){return 4;}
@@ -0,0 +1,2 @@
+#pragma once
+typedef void *Semaphore_Handle; static inline void Semaphore_post(Semaphore_Handle s){(void)s;} static inline int Semaphore_pend(Semaphore_Handle s, unsigned t){(void)s;(void)t;return 1;}
@@ -0,0 +1,245 @@
+/******************************************************************************
+
+ @file  nv_linux.h
+
+ @brief Host flash model used by the NV driver when built with NV_LINUX
+
+ Group: WCS, LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+
+ Copyright (c) 2017-2019, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+
+
+ *****************************************************************************/
+#ifndef NV_LINUX_H
+#define NV_LINUX_H
+
+/******************************************************************************
+ Overview
+
+ Stands in for the TI NVS driver so nvocmp.c can be built and run on a host
+ (-DNV_LINUX -DNVOCMP_POSIX_MUTEX). The flash behaves like the CC26x2/CC13x2
+ NOR flash: pages of FLASH_PAGE_SIZE are erased to 0xFF as a whole, and
+ programming can only clear bits.
+
+ The flash lives in RAM, or in a file mapped with NV_LINUX_setFile() so its
+ contents survive the process. With a file, NV_LINUX_setPowerLoss() makes the
+ Nth program or erase stop half way and end the process, as a power loss
+ would. Running the driver again on the same file then exercises its
+ recovery.
+
+ NV_LINUX_getStats() returns operation counts for measuring throughput,
+ write amplification and wear.
+
+ Driver asserts are reported on stderr, and alerts too with
+ NV_LINUX_VERBOSE.
+
+ NVOCMP_NVPAGES and FLASH_PAGE_SIZE must be given the same values here as
+ for nvocmp.c.
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+#ifndef TRUE
+#define TRUE true
+#endif
+#ifndef FALSE
+#define FALSE false
+#endif
+
+#ifndef NVOCMP_NVPAGES
+#define NVOCMP_NVPAGES      2
+#endif
+
+#ifndef FLASH_PAGE_SIZE
+#define FLASH_PAGE_SIZE     (1 << 13)
+#endif
+
+/*! Process exit code when an injected power loss ends the process */
+#define NV_LINUX_POWERLOSS_EXIT     0x5A
+
+/*! Stand-ins for the NVS driver types nvocmp.c uses */
+typedef void *NVS_Handle;
+
+typedef struct
+{
+    size_t regionSize;
+    size_t sectorSize;
+} NVS_Attrs;
+
+#define NVS_HANDLE  ((NVS_Handle)&NV_LINUX_stats)
+
+/*! There is no supply voltage to check on the host */
+#define NVOCMP_FLASHACCESS(err)
+
+#ifndef NVDEBUG
+#define NVOCMP_ASSERT(cond, message) NV_LINUX_assert((cond), (message), TRUE);
+#define NVOCMP_ALERT(cond, message)  NV_LINUX_assert((cond), (message), FALSE);
+#endif
+
+/******************************************************************************
+ Structures
+ *****************************************************************************/
+
+/*! Flash operation counts since init or NV_LINUX_resetStats() */
+typedef struct
+{
+    /*! Number of reads */
+    uint32_t reads;
+    /*! Bytes read */
+    uint32_t readBytes;
+    /*! Number of program operations */
+    uint32_t programs;
+    /*! Bytes programmed */
+    uint32_t programBytes;
+    /*! 32-bit flash words touched by programming */
+    uint32_t programWords;
+    /*! Number of page erases */
+    uint32_t erases;
+    /*! Erases per page, for wear */
+    uint32_t pageErases[NVOCMP_NVPAGES];
+} NV_LINUX_stats_t;
+
+/******************************************************************************
+ Global Variables
+ *****************************************************************************/
+extern NV_LINUX_stats_t NV_LINUX_stats;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief       Back the flash with a file instead of RAM. A new file is
+ *              created erased. Call before the NV driver is initialized.
+ *
+ * @param       pPath - file name, or NULL for RAM
+ */
+extern void NV_LINUX_setFile(const char *pPath);
+
+/*!
+ * @brief       Arm power-loss injection
+ *
+ * @param       nOps - number of program/erase operations to let through;
+ *                     the next one is torn and ends the process.
+ *                     0 disarms.
+ */
+extern void NV_LINUX_setPowerLoss(uint32_t nOps);
+
+/*!
+ * @brief       Open the flash, called by the NV driver's init
+ */
+extern void NV_LINUX_init(void);
+
+/*!
+ * @brief       Flush a file backed flash, called by the NV driver after
+ *              each change
+ */
+extern void NV_LINUX_save(void);
+
+/*!
+ * @brief       Read from flash
+ *
+ * @param       pg   - page
+ * @param       off  - offset in the page
+ * @param       pBuf - destination
+ * @param       len  - number of bytes
+ */
+extern void NV_LINUX_read(uint8_t pg, uint16_t off, uint8_t *pBuf,
+                          uint16_t len);
+
+/*!
+ * @brief       Program flash, clearing bits only
+ *
+ * @param       pg   - page
+ * @param       off  - offset in the page
+ * @param       pBuf - data to program
+ * @param       len  - number of bytes
+ *
+ * @return      0 on success, negative if the bytes don't read back as
+ *              written (a 0 bit can't be programmed back to 1)
+ */
+extern int NV_LINUX_write(uint8_t pg, uint16_t off, uint8_t *pBuf,
+                          uint16_t len);
+
+/*!
+ * @brief       Erase a flash page to 0xFF
+ *
+ * @param       pg - page
+ *
+ * @return      0 on success, negative on a bad page
+ */
+extern int NV_LINUX_erase(uint8_t pg);
+
+/*!
+ * @brief       Clear the operation counts
+ */
+extern void NV_LINUX_resetStats(void);
+
+/*!
+ * @brief       Get the operation counts
+ *
+ * @param       pStats - filled in with the counts
+ */
+extern void NV_LINUX_getStats(NV_LINUX_stats_t *pStats);
+
+/*!
+ * @brief       Report a driver assert or alert on stderr
+ *
+ * @param       cond    - reported when false
+ * @param       message - text to report
+ * @param       fatal   - TRUE for an assert, FALSE for an alert
+ */
+extern void NV_LINUX_assert(bool cond, char *message, bool fatal);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NV_LINUX_H */
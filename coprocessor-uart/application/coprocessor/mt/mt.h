@@ -156,6 +156,8 @@ typedef struct
 #define MT_MAC_PURGE_REQ           0x0E
 /*! MT command code - MAC Set RX Gain request */
 #define MT_MAC_SET_RX_GAIN_REQ     0x0F
+/*! MT command code - MAC PIB Set Batch request */
+#define MT_MAC_SET_BATCH_REQ       0x10
 
 /*! MT command code - MAC Security PIB Get request */
 #define MT_MAC_SECURITY_GET_REQ    0x30
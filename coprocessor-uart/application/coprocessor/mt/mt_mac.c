@@ -82,6 +82,18 @@
  */
 #define MT_MAC_PIB_SECURITY_LEVEL_TABLE  0x73
 
+/*
+ Set PIB Batch request - attribute kinds and limits
+ */
+/*! Attribute of the MAC PIB */
+#define MT_MAC_SET_BATCH_MAC        0x00
+/*! Attribute of the frequency hopping PIB */
+#define MT_MAC_SET_BATCH_FH         0x01
+/*! Most attributes in one request */
+#define MT_MAC_SET_BATCH_MAX        32
+/*! Longest MAC PIB attribute value, as in MAC_SET_REQ */
+#define MT_MAC_SET_BATCH_VALUE_LEN  16
+
 /*
  TX Options - these should track values in the MAC file: mac_api.h
  */
@@ -216,6 +228,7 @@ static void macResetReq(Mt_mpb_t *pMpb);
 static void macScanReq(Mt_mpb_t *pMpb);
 static void macSetReq(Mt_mpb_t *pMpb);
 static void macSetFhReq(Mt_mpb_t *pMpb);
+static void macSetBatchReq(Mt_mpb_t *pMpb);
 static void macSetRxGainReq(Mt_mpb_t *pMpb);
 static void macStartReq(Mt_mpb_t *pMpb);
 static void macStartFhReq(Mt_mpb_t *pMpb);
@@ -410,6 +423,10 @@ uint8_t MtMac_commandProcessing(Mt_mpb_t *pMpb)
             macSetFhReq(pMpb);
             break;
 
+        case MT_MAC_SET_BATCH_REQ:
+            macSetBatchReq(pMpb);
+            break;
+
         case MT_MAC_ASSOCIATE_RSP:
             macAssociateRsp(pMpb);
             break;
@@ -1534,6 +1551,111 @@ static void macSetFhReq(Mt_mpb_t *pMpb)
     sendSRSP(MT_MAC_FH_SET_REQ, status);
 }
 
+/*!
+ * @brief   Process MAC_SET_BATCH_REQ command issued by host.  The attributes
+ *          are set in order, and the response holds the first failure (or
+ *          success), the number of attributes set, then the status of each.
+ *
+ * @param   pMpb - pointer to incoming message parameter block
+ */
+static void macSetBatchReq(Mt_mpb_t *pMpb)
+{
+    uint8_t rsp[2 + MT_MAC_SET_BATCH_MAX];
+    uint8_t count = 0;
+
+    rsp[0] = ApiMac_status_lengthError;
+
+    if((pMpb->length >= sizeof(MtPkt_setBatchReq_t))
+       && (*(uint8_t*)pMpb->pData <= MT_MAC_SET_BATCH_MAX))
+    {
+        uint8_t *pBuf = pMpb->pData;
+        uint8_t *pEnd = pBuf + pMpb->length;
+        uint8_t num;
+
+        /* Number of attributes */
+        num = *pBuf++;
+
+        rsp[0] = ApiMac_status_success;
+        while(count < num)
+        {
+            uint8_t kind;
+            uint16_t attr;
+            uint8_t len;
+            uint8_t status;
+
+            if((uint16_t)(pEnd - pBuf) < sizeof(MtPkt_setBatchAttr_t))
+            {
+                break;
+            }
+
+            /* Kind, 16-bit PIB attribute ID and value length */
+            kind = pBuf[0];
+            attr = Util_parseUint16(&pBuf[1]);
+            len = pBuf[3];
+            pBuf += sizeof(MtPkt_setBatchAttr_t);
+
+            if((uint16_t)(pEnd - pBuf) < len)
+            {
+                break;
+            }
+
+            if((kind == MT_MAC_SET_BATCH_MAC)
+               && (len <= MT_MAC_SET_BATCH_VALUE_LEN))
+            {
+                uint8_t value[MT_MAC_SET_BATCH_VALUE_LEN];
+
+                /* Padded as a MAC_SET_REQ would be */
+                memset(value, 0, sizeof(value));
+                memcpy(value, pBuf, len);
+                status = ApiMac_mlmeSetReqArray(
+                                (ApiMac_attribute_array_t)attr, value);
+            }
+            else if(kind == MT_MAC_SET_BATCH_FH)
+            {
+                uint8_t value[MAX_PARAM_SIZE_FH];
+                uint16_t size = 0;
+
+                /* The MAC takes as many bytes as the attribute has, scalar
+                   or array, so the value must be exactly that long */
+                status = ApiMac_mlmeGetFhReqArrayLen(
+                                (ApiMac_FHAttribute_array_t)attr, value, &size);
+                if((status == ApiMac_status_success) && (size != len))
+                {
+                    status = ApiMac_status_invalidParameter;
+                }
+                if(status == ApiMac_status_success)
+                {
+                    status = ApiMac_mlmeSetFhReqArray(
+                                    (ApiMac_FHAttribute_array_t)attr, pBuf);
+                }
+            }
+            else
+            {
+                status = ApiMac_status_unsupportedAttribute;
+            }
+            pBuf += len;
+
+            rsp[2 + count++] = status;
+            if((status != ApiMac_status_success)
+               && (rsp[0] == ApiMac_status_success))
+            {
+                rsp[0] = status;
+            }
+        }
+
+        if(count < num)
+        {
+            /* Ran out of buffer, the rest were not set */
+            rsp[0] = ApiMac_status_lengthError;
+        }
+    }
+
+    rsp[1] = count;
+
+    /* Send host a response */
+    sendDRSP(MT_MAC_SET_BATCH_REQ, 2 + count, rsp);
+}
+
 /*!
  * @brief   Process MAC_UPDATE_PAN_ID_REQ command issued by host
  *
@@ -381,6 +381,28 @@ typedef struct
     uint8_t data[];
 } MtPkt_setFhReq_t;
 
+/*! Packed serial command packet - Set PIB Batch Req */
+typedef struct
+{
+    /*! Number of attributes, MT_MAC_SET_BATCH_MAX at most */
+    uint8_t count[1];
+    /*! The attributes, each an MtPkt_setBatchAttr_t */
+    uint8_t data[];
+} MtPkt_setBatchReq_t;
+
+/*! Packed serial command packet - attribute of a Set PIB Batch Req */
+typedef struct
+{
+    /*! MT_MAC_SET_BATCH_MAC or MT_MAC_SET_BATCH_FH */
+    uint8_t kind[1];
+    /*! MAC or FH PIB attribute id */
+    uint8_t attrId[2];
+    /*! Length of the value */
+    uint8_t len[1];
+    /*! Attribute value */
+    uint8_t value[];
+} MtPkt_setBatchAttr_t;
+
 /*! Packed serial command packet - Set Security PIB Req */
 typedef struct
 {
@@ -0,0 +1,5 @@
+/* The OSAL heap over malloc() */
+#include <stdlib.h>
+static inline void *OsalPort_heapMalloc(uint32_t size){ HEAPMGR_LOCK(); void *p = malloc(size); HEAPMGR_UNLOCK(); return p;}
+static inline void *OsalPort_heapRealloc(void *b, uint32_t size){ return realloc(b, size);}
+static inline void OsalPort_heapFree(void *b){ free(b);}
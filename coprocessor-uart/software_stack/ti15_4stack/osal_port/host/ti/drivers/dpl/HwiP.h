@@ -0,0 +1,3 @@
+#pragma once
+#include <stdint.h>
+static inline uintptr_t HwiP_disable(void){return 0;} static inline void HwiP_restore(uintptr_t k){(void)k;}
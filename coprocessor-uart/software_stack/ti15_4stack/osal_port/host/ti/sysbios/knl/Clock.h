@@ -0,0 +1,5 @@
+#pragma once
+#include "Task.h"
+typedef void *Clock_Handle; typedef void (*Clock_FuncPtr)(UArg); typedef struct { unsigned period; int startFlag; UArg arg; } Clock_Params;
+static inline void Clock_Params_init(Clock_Params *p){(void)p;} static inline Clock_Handle Clock_create(Clock_FuncPtr f, unsigned t, Clock_Params *p, void *e){(void)f;(void)t;(void)p;(void)e;return 0;}
+static inline int Clock_isActive(Clock_Handle c){(void)c;return 0;} static inline void Clock_stop(Clock_Handle c){(void)c;} static inline void Clock_start(Clock_Handle c){(void)c;} static inline void Clock_setTimeout(Clock_Handle c, unsigned t){(void)c;(void)t;} static inline void Clock_delete(Clock_Handle *c){(void)c;}
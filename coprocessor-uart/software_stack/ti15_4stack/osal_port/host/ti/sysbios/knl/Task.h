@@ -0,0 +1,7 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+typedef void *Task_Handle; typedef unsigned int UInt; typedef uintptr_t UArg; typedef void Void;
+#define TRUE 1
+#define FALSE 0
+static inline UInt Task_disable(void){return 0;} static inline void Task_restore(UInt k){(void)k;} static inline Task_Handle Task_self(void){return (Task_Handle)1;}
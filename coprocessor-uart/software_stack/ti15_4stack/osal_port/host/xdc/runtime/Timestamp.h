@@ -0,0 +1,3 @@
+#pragma once
+#include <stdint.h>
+static inline uint32_t Timestamp_get32(void){ static uint32_t ts; return ts += 3; }
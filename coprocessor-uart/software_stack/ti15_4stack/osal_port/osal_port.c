@@ -58,6 +58,10 @@
 #include <ti/drivers/power/PowerCC26XX.h>
 #include <ti/drivers/utils/Random.h>
 
+#ifdef OSAL_PORT_CS_STATS
+#include <xdc/runtime/Timestamp.h>
+#endif
+
 // This include file will ensure HEAPMGR_CONFIG is properly setup in the ti-rtos
 // config file.
 #include <xdc/cfg/global.h>
@@ -66,6 +70,14 @@
 /* Only 1 application can talk to the MAC */
 #define MAX_TASKS 15
 
+/* Word size the memory helpers copy and compare in */
+#define OSAL_PORT_WORD              sizeof(uint32_t)
+#define OSAL_PORT_WORD_ALIGNED(p)   ((((uintptr_t)(p)) & (OSAL_PORT_WORD - 1)) == 0)
+
+/* Byte reverse of a word; compilers turn this into a single REV */
+#define OSAL_PORT_REV32(w)  ((((w) >> 24) & 0x000000FF) | (((w) >> 8) & 0x0000FF00) | \
+                             (((w) << 8) & 0x00FF0000) | (((w) << 24) & 0xFF000000))
+
 /***** Variable declarations *****/
 
 
@@ -83,11 +95,27 @@ typedef union _osal_port_state_union_t
   } each;
 } OsalPort_CSStateUnion;
 
+/* Message ring for a task's queue; the task is its only consumer */
+typedef struct
+{
+    /* Next slot to fill, written by senders only */
+    volatile uint16_t head;
+    /* Next slot to take, written by the receiving task only */
+    volatile uint16_t tail;
+    /* Number of slots - 1, the number of slots is a power of two */
+    uint16_t mask;
+    void * volatile slot[1];
+} OsalPort_MsgRing;
+
 typedef struct
 {
     uint8_t taskId;
     Task_Handle taskHndl;
     OsalPort_MsgQ qHandle;
+    /* Last message in qHandle, only valid when qHandle isn't empty */
+    OsalPort_MsgQ qTail;
+    /* Optional ring ahead of qHandle, see OsalPort_msgRingEnable() */
+    OsalPort_MsgRing *pRing;
     Semaphore_Handle taskSem;
     bool conservePower;
     uint32_t* pEventFlag;
@@ -119,8 +147,92 @@ typedef struct _osalPort_schedule_t
   void *arg;
 } OsalPort_ScheduleEntry;
 
+#ifdef OSAL_PORT_CS_STATS
+/* Nesting depth of critical sections, and when the outermost one began */
+static uint8_t csDepth = 0;
+static uint32_t csStart;
+static OsalPort_CSStats csStats;
+
+#define OsalPort_CS_STATS_ENTER()                                  \
+    do { if(csDepth++ == 0) { csStart = Timestamp_get32(); } } while (0)
+#define OsalPort_CS_STATS_LEAVE()                                  \
+    do { if(--csDepth == 0) { OsalPort_csStatsUpdate(Timestamp_get32() - csStart); } } while (0)
+#else
+#define OsalPort_CS_STATS_ENTER()
+#define OsalPort_CS_STATS_LEAVE()
+#endif
+
 /***** Private function definitions *****/
 
+#ifdef OSAL_PORT_CS_STATS
+/*********************************************************************
+ * @fn      OsalPort_csStatsUpdate
+ *
+ * @brief   Account for one critical section. Called with interrupts
+ *          still disabled.
+ *
+ * @param   ticks - Timestamp ticks interrupts were disabled for
+ */
+static void OsalPort_csStatsUpdate(uint32_t ticks)
+{
+    csStats.count++;
+    csStats.totalTicks += ticks;
+    if(ticks > csStats.maxTicks)
+    {
+        csStats.maxTicks = ticks;
+    }
+}
+#endif
+
+/*********************************************************************
+ * @fn      OsalPort_taskEntry
+ *
+ * @brief   Look up a registered task. OsalPort_registerTask() hands out
+ *          task IDs as indices into taskTbl, so no search is needed.
+ *
+ * @param   taskId - task ID
+ *
+ * @return  pointer to the task's entry, NULL if there is no such task
+ */
+static inline TaskEntry *OsalPort_taskEntry(uint8_t taskId)
+{
+    if((taskId < taskCnt) && (taskId < MAX_TASKS))
+    {
+        return &taskTbl[taskId];
+    }
+
+    return NULL;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_enterHwiCS
+ *
+ * @brief   Enters a critical section that only holds off interrupts.
+ *          Enough for short sections that neither block nor post, as
+ *          the scheduler can't run without an interrupt.
+ *
+ * @return  key used for exiting the critical section
+ */
+static inline uintptr_t OsalPort_enterHwiCS(void)
+{
+    uintptr_t key = HwiP_disable();
+    OsalPort_CS_STATS_ENTER();
+    return key;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_leaveHwiCS
+ *
+ * @brief   Exits a critical section entered by OsalPort_enterHwiCS()
+ *
+ * @param   key used for exiting the critical section
+ */
+static inline void OsalPort_leaveHwiCS(uintptr_t key)
+{
+    OsalPort_CS_STATS_LEAVE();
+    HwiP_restore(key);
+}
+
 // DMM currently uses ICall Heap
 #ifdef USE_DMM
 extern void *ICall_heapMalloc(uint32_t size);
@@ -203,6 +315,8 @@ uint8_t OsalPort_registerTask(Task_Handle taskHndl, Semaphore_Handle taskSem, ui
         taskTbl[taskCnt].taskHndl = taskHndl;
         taskTbl[taskCnt].taskSem = taskSem;
         taskTbl[taskCnt].qHandle = NULL;
+        taskTbl[taskCnt].qTail = NULL;
+        taskTbl[taskCnt].pRing = NULL;
         taskTbl[taskCnt].conservePower = false;
         taskTbl[taskCnt].pEventFlag = pEvent;
     }
@@ -309,31 +423,111 @@ uint8_t OsalPort_msgDeallocate( uint8_t *pMsg )
  */
 uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
 {
-    uint8_t taskIdx;
-    uint32_t key;
+    TaskEntry *pTask;
+    OsalPort_MsgRing *pRing;
+    uintptr_t key;
 
     if(pMsg == NULL)
     {
         return OsalPort_INVALID_MSG_POINTER;
     }
 
-    /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_taskEntry(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
+        return OsalPort_INVALID_TASK;
+    }
+
+    key = OsalPort_enterHwiCS();
+
+    pRing = pTask->pRing;
+    if((pRing != NULL) && (pTask->qHandle == NULL) &&
+       ((uint16_t)(pRing->head - pRing->tail) <= pRing->mask))
+    {
+        pRing->slot[pRing->head & pRing->mask] = pMsg;
+        pRing->head++;
+    }
+    else
+    {
+        /* No ring, or it is full: append to the list. Once the list is in
+         * use it takes every message until it is drained, to keep order. */
+        OsalPort_MSG_NEXT(pMsg) = NULL;
+        if(pTask->qHandle == NULL)
+        {
+            pTask->qHandle = pMsg;
+        }
+        else
         {
-            key = OsalPort_enterCS();
+            OsalPort_MSG_NEXT(pTask->qTail) = pMsg;
+        }
+        pTask->qTail = pMsg;
+    }
 
-            OsalPort_msgEnqueue(&taskTbl[taskIdx].qHandle, pMsg );
-            OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
+    *pTask->pEventFlag |= OsalPort_SYS_EVENT_MSG;
 
-            OsalPort_leaveCS(key);
+    OsalPort_leaveHwiCS(key);
 
-            return OsalPort_SUCCESS;
-        }
+    if(pTask->taskSem)
+    {
+        Semaphore_post(pTask->taskSem);
     }
 
-    return OsalPort_INVALID_TASK;
+    return OsalPort_SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_msgRingEnable
+ *
+ * @brief
+ *
+ *    This function puts a ring of message slots in front of a task's
+ *    message queue. Sending to the task then costs a few instructions
+ *    with interrupts off instead of a list append, and the task takes
+ *    messages from the ring without any lock. The list still takes
+ *    messages when the ring is full. The task's messages can't be
+ *    searched with OsalPort_msgFind()/OsalPort_msgFindDequeue() while
+ *    they are in the ring, so enable it only for tasks that don't.
+ *
+ * @param   uint8_t taskId - receiving task ID, before it has messages
+ * @param   uint16_t size - number of slots, a power of two up to 32768
+ *
+ * @return  OsalPort_SUCCESS, OsalPort_INVALID_TASK,
+ *          OsalPort_INVALIDPARAMETER, OsalPort_MSG_BUFFER_NOT_AVAIL
+ */
+uint8_t OsalPort_msgRingEnable( uint8_t taskId, uint16_t size )
+{
+    TaskEntry *pTask;
+    OsalPort_MsgRing *pRing;
+    uintptr_t key;
+
+    pTask = OsalPort_taskEntry(taskId);
+    if(pTask == NULL)
+    {
+        return OsalPort_INVALID_TASK;
+    }
+
+    if((size == 0) || (size > 0x8000) || ((size & (size - 1)) != 0) ||
+       (pTask->pRing != NULL))
+    {
+        return OsalPort_INVALIDPARAMETER;
+    }
+
+    pRing = (OsalPort_MsgRing *) OsalPort_malloc(sizeof(OsalPort_MsgRing) +
+                                                 ((size - 1) * sizeof(void *)));
+    if(pRing == NULL)
+    {
+        return OsalPort_MSG_BUFFER_NOT_AVAIL;
+    }
+
+    pRing->head = 0;
+    pRing->tail = 0;
+    pRing->mask = size - 1;
+
+    key = OsalPort_enterHwiCS();
+    pTask->pRing = pRing;
+    OsalPort_leaveHwiCS(key);
+
+    return OsalPort_SUCCESS;
 }
 
 /**************************************************************************************************
@@ -356,30 +550,26 @@ uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
  */
 OsalPort_EventHdr* OsalPort_msgFind(uint8_t taskId, uint8_t event)
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint32_t key;
     OsalPort_MsgHdr *pHdr = NULL;
 
     key = OsalPort_enterCS();
 
-    /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_taskEntry(taskId);
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
-        {
-            pHdr = (OsalPort_MsgHdr*) taskTbl[taskIdx].qHandle;
+        pHdr = (OsalPort_MsgHdr*) pTask->qHandle;
 
-            // Look through the tasks queue for a message that matches the task_id and event parameters.
-            while (pHdr != NULL)
-            {
-              if (((OsalPort_EventHdr *)pHdr)->event == event)
-              {
-                break;
-              }
-
-              pHdr = OsalPort_MSG_NEXT(pHdr);
-            }
+        // Look through the tasks queue for a message that matches the task_id and event parameters.
+        while (pHdr != NULL)
+        {
+          if (((OsalPort_EventHdr *)pHdr)->event == event)
+          {
             break;
+          }
+
+          pHdr = OsalPort_MSG_NEXT(pHdr);
         }
     }
 
@@ -403,28 +593,51 @@ OsalPort_EventHdr* OsalPort_msgFind(uint8_t taskId, uint8_t event)
  */
 uint8_t *OsalPort_msgReceive( uint8_t destinationTask )
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
+    OsalPort_MsgRing *pRing;
     uint8_t* pMsg = NULL;
+    uintptr_t key;
+    bool more;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_taskEntry(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            pMsg = OsalPort_msgDequeue( &taskTbl[taskIdx].qHandle );
+        return NULL;
+    }
 
-            // Are there any more messages?
-            if ( OsalPort_MSG_Q_EMPTY(&taskTbl[taskIdx].qHandle) )
-            {
-                // Clear message event
-                OsalPort_clearEvent(taskIdx, OsalPort_SYS_EVENT_MSG);
-            }
-            else
-            {
-                // Signal the task that another message is waiting
-                OsalPort_setEvent(taskIdx, OsalPort_SYS_EVENT_MSG);
-            }
+    // The ring holds the oldest messages, and this task is its only
+    // consumer, so taking from it needs no lock
+    pRing = pTask->pRing;
+    if((pRing != NULL) && (pRing->tail != pRing->head))
+    {
+        pMsg = pRing->slot[pRing->tail & pRing->mask];
+        pRing->tail++;
+        OsalPort_MSG_ID( pMsg ) = OsalPort_TASK_NO_TASK;
+    }
+    else
+    {
+        pMsg = OsalPort_msgDequeue( &pTask->qHandle );
+    }
 
-        }
+    // Are there any more messages? Checked and cleared together, so a
+    // message sent in between isn't left without its event.
+    key = OsalPort_enterHwiCS();
+    more = !OsalPort_MSG_Q_EMPTY(&pTask->qHandle) ||
+           ((pRing != NULL) && (pRing->tail != pRing->head));
+    if ( more )
+    {
+        *pTask->pEventFlag |= OsalPort_SYS_EVENT_MSG;
+    }
+    else
+    {
+        *pTask->pEventFlag &= ~(uint32_t)OsalPort_SYS_EVENT_MSG;
+    }
+    OsalPort_leaveHwiCS(key);
+
+    // Signal the task that another message is waiting
+    if ( more && pTask->taskSem )
+    {
+        Semaphore_post(pTask->taskSem);
     }
 
     return pMsg;
@@ -445,30 +658,26 @@ uint8_t *OsalPort_msgReceive( uint8_t destinationTask )
  */
 uint8_t OsalPort_setEvent( uint8_t destinationTask, uint32_t eventFlag )
 {
-    uint8_t taskIdx;
-    uint8_t status = OsalPort_INVALID_TASK;
-    uint32_t key;
+    TaskEntry *pTask;
+    uintptr_t key;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_taskEntry(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            key = OsalPort_enterCS();
-
-            *taskTbl[taskIdx].pEventFlag |= (uint32_t)eventFlag;
-
-            if(taskTbl[taskIdx].taskSem)
-            {
-                Semaphore_post(taskTbl[taskIdx].taskSem);
-            }
+        return OsalPort_INVALID_TASK;
+    }
 
-            status = OsalPort_SUCCESS;
+    key = OsalPort_enterHwiCS();
+    *pTask->pEventFlag |= (uint32_t)eventFlag;
+    OsalPort_leaveHwiCS(key);
 
-            OsalPort_leaveCS(key);
-        }
+    // Semaphore_post() protects itself, no need to hold interrupts off
+    if(pTask->taskSem)
+    {
+        Semaphore_post(pTask->taskSem);
     }
 
-    return status;
+    return OsalPort_SUCCESS;
 }
 
 /*********************************************************************
@@ -484,15 +693,12 @@ uint8_t OsalPort_setEvent( uint8_t destinationTask, uint32_t eventFlag )
  */
 uint32_t OsalPort_waitEvent(uint8_t taskId)
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask = OsalPort_taskEntry(taskId);
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
-        {
-            Semaphore_pend(taskTbl[taskIdx].taskSem, BIOS_WAIT_FOREVER);
-            return *taskTbl[taskIdx].pEventFlag;
-        }
+        Semaphore_pend(pTask->taskSem, BIOS_WAIT_FOREVER);
+        return *pTask->pEventFlag;
     }
 
     return 0;
@@ -539,20 +745,32 @@ void OsalPort_blockOnEvent(Task_Handle taskHndl)
  */
 void OsalPort_clearEvent(uint8_t TaskID, uint32_t eventFlag)
 {
+    TaskEntry *pTask = NULL;
     uint8_t taskIdx;
-    uint32_t key;
+    uintptr_t key;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    if(TaskID != OsalPort_TASK_NO_TASK)
+    {
+        pTask = OsalPort_taskEntry(TaskID);
+    }
+    else
     {
-        if( ((TaskID != OsalPort_TASK_NO_TASK) && (taskTbl[taskIdx].taskId == TaskID)) ||
-            ((TaskID == OsalPort_TASK_NO_TASK) && (taskTbl[taskIdx].taskHndl == Task_self())))
+        for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
         {
-            key = OsalPort_enterCS();
-            *taskTbl[taskIdx].pEventFlag &=  ~(uint32_t)eventFlag;
-            OsalPort_leaveCS(key);
-            break;
+            if(taskTbl[taskIdx].taskHndl == Task_self())
+            {
+                pTask = &taskTbl[taskIdx];
+                break;
+            }
         }
     }
+
+    if(pTask != NULL)
+    {
+        key = OsalPort_enterHwiCS();
+        *pTask->pEventFlag &=  ~(uint32_t)eventFlag;
+        OsalPort_leaveHwiCS(key);
+    }
 }
 
 /*********************************************************************
@@ -688,7 +906,7 @@ void *OsalPort_msgDequeue( OsalPort_MsgQ *pQ )
  */
 OsalPort_EventHdr* OsalPort_msgFindDequeue(uint8_t taskId, uint8_t event)
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint32_t key;
     OsalPort_MsgHdr *pHdr = NULL;
     OsalPort_MsgHdr *pPrev = NULL;
@@ -696,36 +914,36 @@ OsalPort_EventHdr* OsalPort_msgFindDequeue(uint8_t taskId, uint8_t event)
     // Hold off interrupts
     key = OsalPort_enterCS();
 
-    /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_taskEntry(taskId);
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
+        pHdr = (OsalPort_MsgHdr*) pTask->qHandle;
+
+        // Look through the tasks queue for a message that matches the task_id and event parameters.
+        while (pHdr != NULL)
         {
-            pHdr = (OsalPort_MsgHdr*) taskTbl[taskIdx].qHandle;
+          if (((OsalPort_EventHdr *)pHdr)->event == event)
+          {
 
-            // Look through the tasks queue for a message that matches the task_id and event parameters.
-            while (pHdr != NULL)
+            if(pPrev == NULL)
             {
-              if (((OsalPort_EventHdr *)pHdr)->event == event)
-              {
-
-                if(pPrev == NULL)
-                {
-                  OsalPort_MSG_Q_HEAD(&taskTbl[taskIdx].qHandle) = OsalPort_MSG_NEXT(pHdr);
-                }
-                else
-                {
-                  OsalPort_MSG_NEXT(pPrev) = OsalPort_MSG_NEXT(pHdr);
-                }
-                OsalPort_MSG_NEXT( pHdr ) = NULL;
-                OsalPort_MSG_ID( pHdr ) = OsalPort_TASK_NO_TASK;
-                break;
-              }
-
-              pPrev = pHdr;
-              pHdr = OsalPort_MSG_NEXT(pHdr);
+              OsalPort_MSG_Q_HEAD(&pTask->qHandle) = OsalPort_MSG_NEXT(pHdr);
+            }
+            else
+            {
+              OsalPort_MSG_NEXT(pPrev) = OsalPort_MSG_NEXT(pHdr);
+            }
+            if(pTask->qTail == pHdr)
+            {
+              pTask->qTail = pPrev;
             }
+            OsalPort_MSG_NEXT( pHdr ) = NULL;
+            OsalPort_MSG_ID( pHdr ) = OsalPort_TASK_NO_TASK;
             break;
+          }
+
+          pPrev = pHdr;
+          pHdr = OsalPort_MSG_NEXT(pHdr);
         }
     }
 
@@ -1020,6 +1238,27 @@ uint8_t OsalPort_memcmp( const void *src1, const void *src2, uint32_t len )
   pSrc1 = src1;
   pSrc2 = src2;
 
+  // Buffers with the same alignment are compared a word at a time
+  if ( (len >= OSAL_PORT_WORD) &&
+       OSAL_PORT_WORD_ALIGNED( (uintptr_t)pSrc1 - (uintptr_t)pSrc2 ) )
+  {
+    while ( !OSAL_PORT_WORD_ALIGNED( pSrc1 ) )
+    {
+      if( *pSrc1++ != *pSrc2++ )
+        return FALSE;
+      len--;
+    }
+
+    while ( len >= OSAL_PORT_WORD )
+    {
+      if ( *(const uint32_t *)pSrc1 != *(const uint32_t *)pSrc2 )
+        return FALSE;
+      pSrc1 += OSAL_PORT_WORD;
+      pSrc2 += OSAL_PORT_WORD;
+      len -= OSAL_PORT_WORD;
+    }
+  }
+
   while ( len-- )
   {
     if( *pSrc1++ != *pSrc2++ )
@@ -1044,6 +1283,27 @@ void *OsalPort_memcpy( void *dst, const void *src, unsigned int len )
   pSrc = src;
   pDst = dst;
 
+  // Buffers with the same alignment are copied a word at a time. Going
+  // forward a word at a time keeps the byte loop's result for overlapping
+  // buffers, since they are then at least a word apart.
+  if ( (len >= OSAL_PORT_WORD) &&
+       OSAL_PORT_WORD_ALIGNED( (uintptr_t)pDst - (uintptr_t)pSrc ) )
+  {
+    while ( !OSAL_PORT_WORD_ALIGNED( pDst ) )
+    {
+      *pDst++ = *pSrc++;
+      len--;
+    }
+
+    while ( len >= OSAL_PORT_WORD )
+    {
+      *(uint32_t *)pDst = *(const uint32_t *)pSrc;
+      pDst += OSAL_PORT_WORD;
+      pSrc += OSAL_PORT_WORD;
+      len -= OSAL_PORT_WORD;
+    }
+  }
+
   while ( len-- )
     *pDst++ = *pSrc++;
 
@@ -1076,6 +1336,28 @@ void *OsalPort_revmemcpy( void *dst, const void *src, unsigned int len )
   pSrc += (len-1);
   pDst = dst;
 
+  // When the destination and the end of the source line up, whole words
+  // are copied and byte reversed
+  if ( (len >= OSAL_PORT_WORD) &&
+       OSAL_PORT_WORD_ALIGNED( (uintptr_t)pDst + (uintptr_t)pSrc + 1 ) )
+  {
+    while ( !OSAL_PORT_WORD_ALIGNED( pDst ) )
+    {
+      *pDst++ = *pSrc--;
+      len--;
+    }
+
+    while ( len >= OSAL_PORT_WORD )
+    {
+      uint32_t word = *(const uint32_t *)(pSrc - (OSAL_PORT_WORD - 1));
+
+      *(uint32_t *)pDst = OSAL_PORT_REV32( word );
+      pDst += OSAL_PORT_WORD;
+      pSrc -= OSAL_PORT_WORD;
+      len -= OSAL_PORT_WORD;
+    }
+  }
+
   while ( len-- )
     *pDst++ = *pSrc--;
 
@@ -1131,6 +1413,7 @@ uint32_t OsalPort_enterCS(void)
     OsalPort_CSStateUnion cu;
     cu.each.taskkey = (uint_least16_t) Task_disable();
     cu.each.hwikey = (uint_least16_t) HwiP_disable();
+    OsalPort_CS_STATS_ENTER();
     return cu.state;
 }
 
@@ -1147,10 +1430,43 @@ uint32_t OsalPort_enterCS(void)
 void OsalPort_leaveCS(uint32_t key)
 {
     OsalPort_CSStateUnion *cu = (OsalPort_CSStateUnion *) &key;
+    OsalPort_CS_STATS_LEAVE();
     HwiP_restore((UInt) cu->each.hwikey);
     Task_restore((UInt) cu->each.taskkey);
 }
 
+#ifdef OSAL_PORT_CS_STATS
+/*********************************************************************
+ * @fn      OsalPort_getCSStats
+ *
+ * @brief
+ *
+ *   Gets the time interrupts were held off by OSAL port critical sections
+ *
+ * @param   pStats - filled in with the statistics
+ */
+void OsalPort_getCSStats(OsalPort_CSStats *pStats)
+{
+    uintptr_t key = HwiP_disable();
+    *pStats = csStats;
+    HwiP_restore(key);
+}
+
+/*********************************************************************
+ * @fn      OsalPort_resetCSStats
+ *
+ * @brief
+ *
+ *   Clears the critical section statistics
+ */
+void OsalPort_resetCSStats(void)
+{
+    uintptr_t key = HwiP_disable();
+    memset(&csStats, 0, sizeof(csStats));
+    HwiP_restore(key);
+}
+#endif
+
 /*********************************************************************
  * @fn      OsalPort_buildUint16
  *
@@ -1181,7 +1497,12 @@ uint16_t OsalPort_buildUint16( uint8_t *swapped )
  */
 uint32_t OsalPort_buildUint32( uint8_t *swapped, uint8_t len )
 {
-    if ( len == 1 )
+    // The device is little endian, an aligned LSB first word is just read
+    if ( (len == 4) && OSAL_PORT_WORD_ALIGNED( swapped ) )
+    {
+        return  *(uint32_t *)swapped;
+    }
+    else if ( len == 1 )
     {
         return  ((uint32_t)swapped[0]);
     }
@@ -1220,6 +1541,13 @@ uint32_t OsalPort_buildUint32( uint8_t *swapped, uint8_t len )
  */
 uint8_t* OsalPort_bufferUint32( uint8_t *buf, uint32_t val )
 {
+    // The device is little endian, an aligned LSB first word is just stored
+    if ( OSAL_PORT_WORD_ALIGNED( buf ) )
+    {
+        *(uint32_t *)buf = val;
+        return buf + OSAL_PORT_WORD;
+    }
+
     *buf++ = (uint8_t)((uint32_t)(val & 0x00FF));
     *buf++ = (uint8_t)((uint32_t)(((val) >>((1) * 8)) & 0x00FF));
     *buf++ = (uint8_t)((uint32_t)(((val) >>((2) * 8)) & 0x00FF));
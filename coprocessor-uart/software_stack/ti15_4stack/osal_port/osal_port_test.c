@@ -0,0 +1,354 @@
+/******************************************************************************
+
+ @file osal_port_test.c
+
+ @brief Host correctness test and benchmark of the OsalPort memory helpers
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2019, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+
+ Checks OsalPort_memcpy, OsalPort_revmemcpy and OsalPort_memcmp against
+ libc and against the byte loops they replaced, for every source and
+ destination alignment 0..7 and every length 0..100, with the bytes around
+ the destination checked too.  Overlapping copies must match the byte loop,
+ and OsalPort_bufferUint32 and OsalPort_buildUint32 must round trip at
+ every alignment.  Then it times each helper against its byte loop.
+
+ Built on a host only, from this folder, e.g.
+   gcc -O2 -fno-tree-loop-distribute-patterns -DOSAL_PORT_HOST
+       -I host -o osal_port_test osal_port_test.c osal_port.c
+ the -f option keeping gcc from turning the byte loops into libc calls,
+ which the device compiler doesn't do.  host/ stands in for the TI-RTOS and
+ driver headers osal_port.c includes, with the OSAL heap over malloc().
+ The times are the host's, only the ratios carry over to the device.
+ *****************************************************************************/
+
+/* Host builds only; the project compiles this file for the device too */
+#ifdef OSAL_PORT_HOST
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <time.h>
+
+#include "osal_port.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Alignments tried for each buffer */
+#define TEST_ALIGNS     8
+/* Longest length tried */
+#define TEST_MAX_LEN    100
+/* Bytes of the test buffers */
+#define TEST_BUF_LEN    256
+/* Fill of the bytes around a destination */
+#define TEST_FILL       0xAA
+
+/* Calls timed for each helper and length */
+#define BENCH_CALLS     2000000L
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+static uint8_t src[TEST_BUF_LEN];
+static uint8_t dst[TEST_BUF_LEN];
+static uint8_t ref[TEST_BUF_LEN];
+
+/* Keeps the benchmark loops from being optimized away */
+static volatile uint8_t sink;
+
+/******************************************************************************
+ Local functions
+ *****************************************************************************/
+
+/*!
+ * @brief   The byte loop OsalPort_memcpy used to be
+ */
+static void *byteMemcpy(void *pDst, const void *pSrc, unsigned int len)
+{
+    uint8_t *d = pDst;
+    const uint8_t *s = pSrc;
+
+    while(len--)
+    {
+        *d++ = *s++;
+    }
+    return (d);
+}
+
+/*!
+ * @brief   The byte loop OsalPort_revmemcpy used to be
+ */
+static void *byteRevmemcpy(void *pDst, const void *pSrc, unsigned int len)
+{
+    uint8_t *d = pDst;
+    const uint8_t *s = (const uint8_t *)pSrc + len - 1;
+
+    while(len--)
+    {
+        *d++ = *s--;
+    }
+    return (d);
+}
+
+/*!
+ * @brief   The byte loop OsalPort_memcmp used to be
+ */
+static uint8_t byteMemcmp(const void *pSrc1, const void *pSrc2, uint32_t len)
+{
+    const uint8_t *s1 = pSrc1;
+    const uint8_t *s2 = pSrc2;
+
+    while(len--)
+    {
+        if(*s1++ != *s2++)
+        {
+            return (FALSE);
+        }
+    }
+    return (TRUE);
+}
+
+/*!
+ * @brief   Check the helpers at every alignment and length
+ *
+ * @return  number of failures
+ */
+static int checkAll(void)
+{
+    uint8_t buf[TEST_BUF_LEN];
+    uint8_t bufRef[TEST_BUF_LEN];
+    int failures = 0;
+    int sa;
+    int da;
+    int len;
+    int pos;
+    int i;
+
+    for(i = 0; i < TEST_BUF_LEN; i++)
+    {
+        src[i] = (uint8_t)((i * 7) + 3);
+    }
+
+    for(sa = 0; sa < TEST_ALIGNS; sa++)
+    {
+        for(da = 0; da < TEST_ALIGNS; da++)
+        {
+            for(len = 0; len <= TEST_MAX_LEN; len++)
+            {
+                void *pEnd;
+
+                memset(dst, TEST_FILL, sizeof(dst));
+                memset(ref, TEST_FILL, sizeof(ref));
+                pEnd = OsalPort_memcpy(dst + da, src + sa, len);
+                memcpy(ref + da, src + sa, len);
+                if((pEnd != dst + da + len) ||
+                   (memcmp(dst, ref, sizeof(dst)) != 0))
+                {
+                    printf("memcpy src %d dst %d len %d\n", sa, da, len);
+                    failures++;
+                }
+
+                memset(dst, TEST_FILL, sizeof(dst));
+                memset(ref, TEST_FILL, sizeof(ref));
+                pEnd = OsalPort_revmemcpy(dst + da, src + sa, len);
+                byteRevmemcpy(ref + da, src + sa, len);
+                if((pEnd != dst + da + len) ||
+                   (memcmp(dst, ref, sizeof(dst)) != 0))
+                {
+                    printf("revmemcpy src %d dst %d len %d\n", sa, da, len);
+                    failures++;
+                }
+
+                /* Equal, then different at each position in turn */
+                memcpy(dst + da, src + sa, len);
+                if(OsalPort_memcmp(dst + da, src + sa, len) != TRUE)
+                {
+                    printf("memcmp equal src %d dst %d len %d\n", sa, da,
+                           len);
+                    failures++;
+                }
+                for(pos = 0; pos < len; pos++)
+                {
+                    dst[da + pos] ^= 0x10;
+                    if((OsalPort_memcmp(dst + da, src + sa, len) != FALSE) ||
+                       (OsalPort_memcmp(src + sa, dst + da, len) != FALSE))
+                    {
+                        printf("memcmp src %d dst %d len %d pos %d\n", sa, da,
+                               len, pos);
+                        failures++;
+                    }
+                    dst[da + pos] ^= 0x10;
+                }
+            }
+        }
+    }
+
+    /* Overlapping copies in both directions */
+    for(sa = 0; sa < 12; sa++)
+    {
+        for(da = 0; da < 12; da++)
+        {
+            for(len = 0; len < 60; len++)
+            {
+                for(i = 0; i < TEST_BUF_LEN; i++)
+                {
+                    buf[i] = (uint8_t)i;
+                }
+                memcpy(bufRef, buf, sizeof(buf));
+                OsalPort_memcpy(buf + da, buf + sa, len);
+                byteMemcpy(bufRef + da, bufRef + sa, len);
+                if(memcmp(buf, bufRef, sizeof(buf)) != 0)
+                {
+                    printf("overlapping memcpy src %d dst %d len %d\n", sa,
+                           da, len);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    for(da = 0; da < TEST_ALIGNS; da++)
+    {
+        uint32_t val = 0x12345678u * (uint32_t)(da + 1);
+
+        memset(dst, TEST_FILL, sizeof(dst));
+        if((OsalPort_bufferUint32(dst + da, val) != dst + da + 4) ||
+           (dst[da] != (uint8_t)val) || (dst[da + 3] != (uint8_t)(val >> 24)) ||
+           (dst[da + 4] != TEST_FILL) ||
+           (OsalPort_buildUint32(dst + da, 4) != val))
+        {
+            printf("uint32 at %d\n", da);
+            failures++;
+        }
+    }
+
+    return (failures);
+}
+
+/*!
+ * @brief   ns per call of the fastest of three runs
+ */
+static double timeCalls(int which, int len)
+{
+    double best = 0;
+    int run;
+
+    /* Compares run to the end */
+    memcpy(dst, src, sizeof(dst));
+    for(run = 0; run < 3; run++)
+    {
+        clock_t start = clock();
+        double ns;
+        long n;
+
+        for(n = 0; n < BENCH_CALLS; n++)
+        {
+            switch(which)
+            {
+                case 0:
+                    byteMemcpy(dst, src, len);
+                    break;
+                case 1:
+                    OsalPort_memcpy(dst, src, len);
+                    break;
+                case 2:
+                    sink += byteMemcmp(dst, src, len);
+                    break;
+                case 3:
+                    sink += OsalPort_memcmp(dst, src, len);
+                    break;
+                case 4:
+                    /* Source end lined up with the destination */
+                    byteRevmemcpy(dst, src + ((4 - (len % 4)) % 4), len);
+                    break;
+                default:
+                    OsalPort_revmemcpy(dst, src + ((4 - (len % 4)) % 4), len);
+                    break;
+            }
+            sink += dst[n & 7];
+        }
+        ns = ((double)(clock() - start) * 1e9) /
+             ((double)CLOCKS_PER_SEC * BENCH_CALLS);
+        if((run == 0) || (ns < best))
+        {
+            best = ns;
+        }
+    }
+    return (best);
+}
+
+/******************************************************************************
+ Public functions
+ *****************************************************************************/
+
+int main(void)
+{
+    static const int lens[] = {8, 16, 32, 127};
+    int failures;
+    int i;
+
+    failures = checkAll();
+    if(failures != 0)
+    {
+        printf("%d failures\n", failures);
+        return (1);
+    }
+    printf("correctness ok\n");
+
+    for(i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++)
+    {
+        printf("len %3d: memcpy %5.1f -> %5.1f ns, memcmp %5.1f -> %5.1f ns, "
+               "revmemcpy %5.1f -> %5.1f ns\n", lens[i],
+               timeCalls(0, lens[i]), timeCalls(1, lens[i]),
+               timeCalls(2, lens[i]), timeCalls(3, lens[i]),
+               timeCalls(4, lens[i]), timeCalls(5, lens[i]));
+    }
+    return (0);
+}
+
+#endif /* OSAL_PORT_HOST */
@@ -0,0 +1,353 @@
+/******************************************************************************
+
+ @file  nv_linux.c
+
+ @brief Host flash model used by the NV driver when built with NV_LINUX
+
+ Group: WCS, LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+
+ Copyright (c) 2017-2019, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+
+
+ *****************************************************************************/
+
+/* Host builds only; the project compiles this file for the device too */
+#ifdef NV_LINUX
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "nv_linux.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+#define NV_LINUX_SIZE       (NVOCMP_NVPAGES * FLASH_PAGE_SIZE)
+
+/* Flash word size, the unit programming is done in */
+#define NV_LINUX_WORD       4
+
+/******************************************************************************
+ Global variables
+ *****************************************************************************/
+NV_LINUX_stats_t NV_LINUX_stats;
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+static uint8_t *pFlash = NULL;
+static const char *pFlashFile = NULL;
+
+/* Program/erase operations left before the injected power loss, 0 = off */
+static uint32_t powerLossOps = 0;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static bool powerLost(void);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Back the flash with a file
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_setFile(const char *pPath)
+{
+    pFlashFile = pPath;
+}
+
+/*!
+ Arm power-loss injection
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_setPowerLoss(uint32_t nOps)
+{
+    powerLossOps = (nOps == 0) ? 0 : (nOps + 1);
+}
+
+/*!
+ Open the flash
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_init(void)
+{
+    memset(&NV_LINUX_stats, 0, sizeof(NV_LINUX_stats));
+
+    if(pFlash != NULL)
+    {
+        return;
+    }
+
+    if(pFlashFile != NULL)
+    {
+        struct stat st;
+        int fd = open(pFlashFile, O_RDWR | O_CREAT, 0644);
+
+        if((fd < 0) || (fstat(fd, &st) != 0))
+        {
+            perror(pFlashFile);
+            exit(EXIT_FAILURE);
+        }
+
+        if(st.st_size != NV_LINUX_SIZE)
+        {
+            /* New (or resized) flash starts out erased */
+            static uint8_t erased[FLASH_PAGE_SIZE];
+            int pg;
+
+            memset(erased, 0xFF, sizeof(erased));
+            if(ftruncate(fd, 0) != 0)
+            {
+                perror(pFlashFile);
+                exit(EXIT_FAILURE);
+            }
+            for(pg = 0; pg < NVOCMP_NVPAGES; pg++)
+            {
+                if(write(fd, erased, FLASH_PAGE_SIZE) != FLASH_PAGE_SIZE)
+                {
+                    perror(pFlashFile);
+                    exit(EXIT_FAILURE);
+                }
+            }
+        }
+
+        pFlash = mmap(NULL, NV_LINUX_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+        close(fd);
+        if(pFlash == MAP_FAILED)
+        {
+            perror(pFlashFile);
+            exit(EXIT_FAILURE);
+        }
+    }
+    else
+    {
+        pFlash = malloc(NV_LINUX_SIZE);
+        if(pFlash == NULL)
+        {
+            exit(EXIT_FAILURE);
+        }
+        memset(pFlash, 0xFF, NV_LINUX_SIZE);
+    }
+}
+
+/*!
+ Flush a file backed flash
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_save(void)
+{
+    if((pFlashFile != NULL) && (pFlash != NULL))
+    {
+        /* The mapping is shared, so a dying process loses nothing; this
+           only schedules the write back */
+        (void)msync(pFlash, NV_LINUX_SIZE, MS_ASYNC);
+    }
+}
+
+/*!
+ Read from flash
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_read(uint8_t pg, uint16_t off, uint8_t *pBuf, uint16_t len)
+{
+    NV_LINUX_stats.reads++;
+    NV_LINUX_stats.readBytes += len;
+
+    if((pg < NVOCMP_NVPAGES) && ((off + len) <= FLASH_PAGE_SIZE))
+    {
+        memcpy(pBuf, &pFlash[(pg * FLASH_PAGE_SIZE) + off], len);
+    }
+}
+
+/*!
+ Program flash
+
+ Public function defined in nv_linux.h
+ */
+int NV_LINUX_write(uint8_t pg, uint16_t off, uint8_t *pBuf, uint16_t len)
+{
+    uint8_t *pDst;
+    uint16_t i;
+
+    if((pg >= NVOCMP_NVPAGES) || ((off + len) > FLASH_PAGE_SIZE))
+    {
+        return(-1);
+    }
+    pDst = &pFlash[(pg * FLASH_PAGE_SIZE) + off];
+
+    if(powerLost())
+    {
+        /* Only the first half of the words make it */
+        uint16_t torn = (len / 2) & ~(NV_LINUX_WORD - 1);
+
+        for(i = 0; i < torn; i++)
+        {
+            pDst[i] &= pBuf[i];
+        }
+        NV_LINUX_save();
+        _exit(NV_LINUX_POWERLOSS_EXIT);
+    }
+
+    NV_LINUX_stats.programs++;
+    NV_LINUX_stats.programBytes += len;
+    if(len > 0)
+    {
+        NV_LINUX_stats.programWords += ((off + len - 1) / NV_LINUX_WORD)
+                                       - (off / NV_LINUX_WORD) + 1;
+    }
+
+    /* Programming clears bits only, like NOR flash */
+    for(i = 0; i < len; i++)
+    {
+        pDst[i] &= pBuf[i];
+    }
+
+    /* Post verify, as NVS_WRITE_POST_VERIFY does */
+    return((memcmp(pDst, pBuf, len) == 0) ? 0 : -1);
+}
+
+/*!
+ Erase a flash page
+
+ Public function defined in nv_linux.h
+ */
+int NV_LINUX_erase(uint8_t pg)
+{
+    uint8_t *pDst;
+
+    if(pg >= NVOCMP_NVPAGES)
+    {
+        return(-1);
+    }
+    pDst = &pFlash[pg * FLASH_PAGE_SIZE];
+
+    if(powerLost())
+    {
+        /* The erase didn't finish, part of the page is still old data */
+        memset(pDst, 0xFF, FLASH_PAGE_SIZE / 2);
+        NV_LINUX_save();
+        _exit(NV_LINUX_POWERLOSS_EXIT);
+    }
+
+    NV_LINUX_stats.erases++;
+    NV_LINUX_stats.pageErases[pg]++;
+
+    memset(pDst, 0xFF, FLASH_PAGE_SIZE);
+
+    return(0);
+}
+
+/*!
+ Clear the operation counts
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_resetStats(void)
+{
+    memset(&NV_LINUX_stats, 0, sizeof(NV_LINUX_stats));
+}
+
+/*!
+ Get the operation counts
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_getStats(NV_LINUX_stats_t *pStats)
+{
+    if(pStats != NULL)
+    {
+        *pStats = NV_LINUX_stats;
+    }
+}
+
+/*!
+ Report a driver assert or alert
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_assert(bool cond, char *message, bool fatal)
+{
+#ifndef NV_LINUX_VERBOSE
+    /* Alerts are frequent and expected, e.g. on every init */
+    if(!fatal)
+    {
+        return;
+    }
+#endif
+
+    if(!cond)
+    {
+        fprintf(stderr, "NV_LINUX %s: %s\n", fatal ? "assert" : "alert",
+                message);
+    }
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Count down to the injected power loss
+ *
+ * @return      true if this program/erase is the one that loses power
+ */
+static bool powerLost(void)
+{
+    if(powerLossOps == 0)
+    {
+        return(false);
+    }
+
+    return(--powerLossOps == 0);
+}
+
+#endif /* NV_LINUX */
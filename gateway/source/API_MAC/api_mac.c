@@ -157,6 +157,15 @@
 #define IE_UNPACKING(var,size,position) (((uint16_t)(var)>>(position))\
                 &(((uint16_t)1<<(size))-1))
 
+/*! Longest run of attributes sent in one MAC_SET_BATCH_REQ */
+#define SET_BATCH_MAX_LEN 240
+/*! Header of each attribute in a MAC_SET_BATCH_REQ: kind, ID and length */
+#define SET_BATCH_ATTR_HDR_LEN 4
+/*! Value length of a MAC PIB attribute set with MAC_SET_REQ */
+#define SET_REQ_VALUE_LEN 16
+/*! Number of FH PIB array lengths remembered */
+#define FH_ARRAY_LENS 8
+
 /*! Make a uint16_t from 2 uint8_t */
 #define MAKE_UINT16(low,high) (((low)&0x00FF)|(((high)&0x00FF)<<8))
 
@@ -201,6 +210,37 @@ ApiMac_sAddrExt_t ApiMac_extAddr;
 /*! MAC callback table, initialized to no callback table */
 STATIC ApiMac_callbacks_t *pMacCallbacks = (ApiMac_callbacks_t *) NULL;
 
+/*! Attribute settings held between ApiMac_mlmeSetBatchStart() and End() */
+STATIC struct
+{
+    /*! true while settings are held */
+    bool open;
+    /*! true once the co-processor has answered a MAC_SET_BATCH_REQ with an
+        RPC error */
+    bool unsupported;
+    /*! First failure since ApiMac_mlmeSetBatchStart() */
+    ApiMac_status_t status;
+    /*! Number of attributes held */
+    uint8_t count;
+    /*! Length of the held attributes */
+    uint8_t len;
+    /*! The held attributes, as sent in MAC_SET_BATCH_REQ */
+    uint8_t data[SET_BATCH_MAX_LEN];
+} setBatch;
+
+/*!
+ Lengths of FH PIB arrays, fixed by the co-processor, so each costs one
+ MAC_FH_GET_REQ rather than one per set
+ */
+STATIC struct
+{
+    uint16_t attr;
+    uint8_t len;
+} fhArrayLens[FH_ARRAY_LENS];
+
+/*! Number of entries in fhArrayLens */
+STATIC uint8_t numFhArrayLens = 0;
+
 
 
 
@@ -211,6 +251,12 @@ static ApiMac_status_t mlmeGetFhReq(uint16_t pibAttribute, void *pValue,
                                     uint16_t *pLen);
 static ApiMac_status_t mlmeGetSecurityReq(uint16_t pibAttribute, void *pValue,
                                                  uint16_t *len);
+static ApiMac_status_t setPib(uint8_t kind, uint16_t pibAttribute,
+                              uint8_t *pValue, uint8_t len);
+static ApiMac_status_t sendPib(uint8_t kind, uint16_t pibAttribute,
+                               uint8_t *pValue, uint8_t len);
+static void flushSetBatch(void);
+static ApiMac_status_t getFhArrayLen(uint16_t pibAttribute, uint8_t *pLen);
 
 static void ApiMac_mtAddrToApiMacsAddr(ApiMac_sAddr_t *apimacAddr, uint8_t *mtmacAddr, uint8_t addrMode);
 //static uint16_t processIncomingICallMsg(macCbackEvent_t *pMsg);
@@ -285,6 +331,11 @@ void ApiMac_init(bool enableFH)
     MtUtil_utilGetExtAddr_t getExtData;
     MtUtil_utilGetExtAddrSrsp_t rspData;
     MtMac_RegisterCbs(&mtMacCallbacks);
+
+    /* The co-processor may have new firmware */
+    numFhArrayLens = 0;
+    setBatch.unsupported = false;
+
     /* Enable frequency hopping? */
     if(enableFH)
     {
@@ -833,11 +884,8 @@ ApiMac_status_t ApiMac_mlmeScanReq(ApiMac_mlmeScanReq_t *pData)
 ApiMac_status_t ApiMac_mlmeSetReqBool(ApiMac_attribute_bool_t pibAttribute,
 bool value)
 {
-    MtMac_setReq_t setReq;
-    setReq.AttributeID = pibAttribute;
-    memset(setReq.AttributeValue, 0x00, 16);
-    setReq.AttributeValue[0] = (uint8_t)value;
-    return ((ApiMac_status_t)MtMac_setReq(&setReq));
+    uint8_t buf = (uint8_t)value;
+    return (setPib(MAC_SET_BATCH_MAC, pibAttribute, &buf, sizeof(buf)));
 }
 
 /*!
@@ -849,11 +897,7 @@ bool value)
 ApiMac_status_t ApiMac_mlmeSetReqUint8(ApiMac_attribute_uint8_t pibAttribute,
                                        uint8_t value)
 {
-    MtMac_setReq_t setReq;
-    setReq.AttributeID = pibAttribute;
-    memset(setReq.AttributeValue, 0x00, 16);
-    setReq.AttributeValue[0] = value;
-    return ((ApiMac_status_t)MtMac_setReq(&setReq));
+    return (setPib(MAC_SET_BATCH_MAC, pibAttribute, &value, sizeof(value)));
 }
 
 /*!
@@ -865,11 +909,9 @@ ApiMac_status_t ApiMac_mlmeSetReqUint8(ApiMac_attribute_uint8_t pibAttribute,
 ApiMac_status_t ApiMac_mlmeSetReqUint16(ApiMac_attribute_uint16_t pibAttribute,
                                         uint16_t value)
 {
-    MtMac_setReq_t setReq;
-    setReq.AttributeID = pibAttribute;
-    memset(setReq.AttributeValue, 0x00, 16);
-    Util_bufferUint16(setReq.AttributeValue, value);
-    return ((ApiMac_status_t)MtMac_setReq(&setReq));
+    uint8_t buf[sizeof(uint16_t)];
+    Util_bufferUint16(buf, value);
+    return (setPib(MAC_SET_BATCH_MAC, pibAttribute, buf, sizeof(buf)));
 }
 
 /*!
@@ -881,11 +923,9 @@ ApiMac_status_t ApiMac_mlmeSetReqUint16(ApiMac_attribute_uint16_t pibAttribute,
 ApiMac_status_t ApiMac_mlmeSetReqUint32(ApiMac_attribute_uint32_t pibAttribute,
                                         uint32_t value)
 {
-    MtMac_setReq_t setReq;
-    setReq.AttributeID = pibAttribute;
-    memset(setReq.AttributeValue, 0x00, 16);
-    Util_bufferUint32(setReq.AttributeValue, value);
-    return ((ApiMac_status_t)MtMac_setReq(&setReq));
+    uint8_t buf[sizeof(uint32_t)];
+    Util_bufferUint32(buf, value);
+    return (setPib(MAC_SET_BATCH_MAC, pibAttribute, buf, sizeof(buf)));
 }
 
 /*!
@@ -897,11 +937,14 @@ ApiMac_status_t ApiMac_mlmeSetReqUint32(ApiMac_attribute_uint32_t pibAttribute,
 ApiMac_status_t ApiMac_mlmeSetReqArray(ApiMac_attribute_array_t pibAttribute,
                                        uint8_t *pValue)
 {
-    MtMac_setReq_t setReq;
-    setReq.AttributeID = pibAttribute;
-    memset(setReq.AttributeValue, 0x00, 16);
-    memcpy(setReq.AttributeValue, pValue, 16);
-    return ((ApiMac_status_t)MtMac_setReq(&setReq));
+    uint8_t len = SET_REQ_VALUE_LEN;
+
+    if((pibAttribute == ApiMac_attribute_extendedAddress)
+       || (pibAttribute == ApiMac_attribute_coordExtendedAddress))
+    {
+        len = APIMAC_SADDR_EXT_LEN;
+    }
+    return (setPib(MAC_SET_BATCH_MAC, pibAttribute, pValue, len));
 }
 
 /*!
@@ -913,11 +956,7 @@ ApiMac_status_t ApiMac_mlmeSetReqArray(ApiMac_attribute_array_t pibAttribute,
 ApiMac_status_t ApiMac_mlmeSetFhReqUint8(
                 ApiMac_FHAttribute_uint8_t pibAttribute, uint8_t value)
 {
-    MtMac_fhSetReq_t fhSet;
-    fhSet.AttributeID = (uint16_t)pibAttribute;
-    fhSet.AttrLen = sizeof(uint8_t);
-    fhSet.Data = (uint8_t*)&value;
-    return ((ApiMac_status_t)MtMac_fhSetReq(&fhSet));
+    return (setPib(MAC_SET_BATCH_FH, pibAttribute, &value, sizeof(value)));
 }
 
 /*!
@@ -929,11 +968,9 @@ ApiMac_status_t ApiMac_mlmeSetFhReqUint8(
 ApiMac_status_t ApiMac_mlmeSetFhReqUint16(
                 ApiMac_FHAttribute_uint16_t pibAttribute, uint16_t value)
 {
-    MtMac_fhSetReq_t fhSet;
-    fhSet.AttributeID = (uint16_t)pibAttribute;
-    fhSet.AttrLen = sizeof(uint16_t);
-    fhSet.Data = (uint8_t*)&value;
-    return ((ApiMac_status_t)MtMac_fhSetReq(&fhSet));
+    uint8_t buf[sizeof(uint16_t)];
+    Util_bufferUint16(buf, value);
+    return (setPib(MAC_SET_BATCH_FH, pibAttribute, buf, sizeof(buf)));
 }
 
 /*!
@@ -945,11 +982,9 @@ ApiMac_status_t ApiMac_mlmeSetFhReqUint16(
 ApiMac_status_t ApiMac_mlmeSetFhReqUint32(
                 ApiMac_FHAttribute_uint32_t pibAttribute, uint32_t value)
 {
-    MtMac_fhSetReq_t fhSet;
-    fhSet.AttributeID = (uint16_t)pibAttribute;
-    fhSet.AttrLen = sizeof(uint32_t);
-    fhSet.Data = (uint8_t*)&value;
-    return ((ApiMac_status_t)MtMac_fhSetReq(&fhSet));
+    uint8_t buf[sizeof(uint32_t)];
+    Util_bufferUint32(buf, value);
+    return (setPib(MAC_SET_BATCH_FH, pibAttribute, buf, sizeof(buf)));
 }
 
 /*!
@@ -961,19 +996,41 @@ ApiMac_status_t ApiMac_mlmeSetFhReqUint32(
 ApiMac_status_t ApiMac_mlmeSetFhReqArray(
                 ApiMac_FHAttribute_array_t pibAttribute, uint8_t *pValue)
 {
-    MtMac_fhSetReq_t fhSet;
-    MtMac_fhGetReq_t fhGetLen;
-    MtMac_fhGetReqSrsp_t fhGetLenRsp;
+    uint8_t len;
+    ApiMac_status_t status;
 
-    fhGetLen.AttributeID = (uint16_t)pibAttribute;
-    fhGetLenRsp.Data = NULL;
-    fhGetLenRsp.AttrLen = 0;
-    MtMac_fhGetReq(&fhGetLen, &fhGetLenRsp);
+    status = getFhArrayLen(pibAttribute, &len);
+    if(status != ApiMac_status_success)
+    {
+        /* Don't set it without knowing how long it is */
+        return (status);
+    }
+    return (setPib(MAC_SET_BATCH_FH, pibAttribute, pValue, len));
+}
+
+/*!
+ Hold the MAC and FH PIB settings that follow, to send them in one frame.
 
-    fhSet.AttributeID = (uint16_t)pibAttribute;
-    fhSet.AttrLen = fhGetLenRsp.AttrLen;
-    fhSet.Data = pValue;
-    return ((ApiMac_status_t)MtMac_fhSetReq(&fhSet));
+ Public function defined in api_mac.h
+ */
+void ApiMac_mlmeSetBatchStart(void)
+{
+    setBatch.open = true;
+    setBatch.status = ApiMac_status_success;
+    setBatch.count = 0;
+    setBatch.len = 0;
+}
+
+/*!
+ Send the settings held since ApiMac_mlmeSetBatchStart().
+
+ Public function defined in api_mac.h
+ */
+ApiMac_status_t ApiMac_mlmeSetBatchEnd(void)
+{
+    flushSetBatch();
+    setBatch.open = false;
+    return (setBatch.status);
 }
 
 /*!
@@ -986,6 +1043,10 @@ ApiMac_status_t ApiMac_mlmeSetSecurityReqUint8(
                 ApiMac_securityAttribute_uint8_t pibAttribute, uint8_t value)
 {
     MtMac_securitySetReq_t secReq;
+
+    /* Keep the order of any held MAC and FH PIB settings */
+    flushSetBatch();
+
     secReq.AttrLen = 1;
     secReq.AttrValue = &value;
     secReq.AttributeID = pibAttribute;
@@ -1004,6 +1065,10 @@ ApiMac_status_t ApiMac_mlmeSetSecurityReqUint16(
                 ApiMac_securityAttribute_uint16_t pibAttribute, uint16_t value)
 {
     MtMac_securitySetReq_t secReq;
+
+    /* Keep the order of any held MAC and FH PIB settings */
+    flushSetBatch();
+
     secReq.AttrLen = 2;
     secReq.AttrValue = (uint8_t*)&value;
     secReq.AttributeID = pibAttribute;
@@ -1023,6 +1088,10 @@ ApiMac_status_t ApiMac_mlmeSetSecurityReqArray(
 {
     MtMac_securitySetReq_t secReq;
     uint16_t len;
+
+    /* Keep the order of any held MAC and FH PIB settings */
+    flushSetBatch();
+
     ApiMac_mlmeGetSecurityReqArrayLen(pibAttribute, NULL, &len);
 
     secReq.AttrLen = len;
@@ -1044,6 +1113,10 @@ ApiMac_status_t ApiMac_mlmeSetSecurityReqStruct(
 {
     MtMac_securitySetReq_t secReq;
     uint16_t len;
+
+    /* Keep the order of any held MAC and FH PIB settings */
+    flushSetBatch();
+
     ApiMac_mlmeGetSecurityReqArrayLen((ApiMac_securityAttribute_array_t)pibAttribute, NULL, &len);
     secReq.AttrLen = len;
     secReq.AttrValue = pValue;
@@ -1477,6 +1550,189 @@ static ApiMac_status_t mlmeGetSecurityReq(uint16_t pibAttribute, void *pValue,
     return macStatus;
 }
 
+/*!
+ * @brief       Set a MAC or FH PIB attribute, or hold it if a batch is open
+ *
+ * @param       kind - MAC_SET_BATCH_MAC or MAC_SET_BATCH_FH
+ * @param       pibAttribute - attribute to set
+ * @param       pValue - pointer to the attribute value, as sent
+ * @param       len - length of the value
+ *
+ * @return      status result, success if held
+ */
+static ApiMac_status_t setPib(uint8_t kind, uint16_t pibAttribute,
+                              uint8_t *pValue, uint8_t len)
+{
+    uint8_t *pBuf;
+
+    if((setBatch.open == false) || setBatch.unsupported)
+    {
+        return (sendPib(kind, pibAttribute, pValue, len));
+    }
+
+    if(((setBatch.len + SET_BATCH_ATTR_HDR_LEN + len) > SET_BATCH_MAX_LEN)
+       || (setBatch.count == MAC_SET_BATCH_MAX))
+    {
+        flushSetBatch();
+        if(setBatch.unsupported)
+        {
+            return (sendPib(kind, pibAttribute, pValue, len));
+        }
+    }
+
+    pBuf = &setBatch.data[setBatch.len];
+    *pBuf++ = kind;
+    pBuf = Util_bufferUint16(pBuf, pibAttribute);
+    *pBuf++ = len;
+    memcpy(pBuf, pValue, len);
+
+    setBatch.len += SET_BATCH_ATTR_HDR_LEN + len;
+    setBatch.count++;
+
+    return (ApiMac_status_success);
+}
+
+/*!
+ * @brief       Set a MAC or FH PIB attribute with its own MT command
+ *
+ * @param       kind - MAC_SET_BATCH_MAC or MAC_SET_BATCH_FH
+ * @param       pibAttribute - attribute to set
+ * @param       pValue - pointer to the attribute value, as sent
+ * @param       len - length of the value
+ *
+ * @return      status result
+ */
+static ApiMac_status_t sendPib(uint8_t kind, uint16_t pibAttribute,
+                               uint8_t *pValue, uint8_t len)
+{
+    if(kind == MAC_SET_BATCH_MAC)
+    {
+        MtMac_setReq_t setReq;
+        setReq.AttributeID = (uint8_t)pibAttribute;
+        memset(setReq.AttributeValue, 0x00, SET_REQ_VALUE_LEN);
+        memcpy(setReq.AttributeValue, pValue, len);
+        return ((ApiMac_status_t)MtMac_setReq(&setReq));
+    }
+    else
+    {
+        MtMac_fhSetReq_t fhSet;
+        fhSet.AttributeID = pibAttribute;
+        fhSet.AttrLen = len;
+        fhSet.Data = pValue;
+        return ((ApiMac_status_t)MtMac_fhSetReq(&fhSet));
+    }
+}
+
+/*!
+ * @brief       Send the held attribute settings in one MAC_SET_BATCH_REQ,
+ *              or one at a time if the co-processor does not support it or
+ *              did not answer
+ */
+static void flushSetBatch(void)
+{
+    MtMac_setBatchReq_t batchReq;
+    MtMac_setBatchReqSrsp_t batchRsp;
+    ApiMac_status_t status;
+    uint8_t *pBuf;
+    uint8_t x;
+
+    if(setBatch.count == 0)
+    {
+        return;
+    }
+
+    if(setBatch.unsupported == false)
+    {
+        batchReq.Count = setBatch.count;
+        batchReq.Data = setBatch.data;
+        batchReq.DataLen = setBatch.len;
+        status = (ApiMac_status_t)MtMac_setBatchReq(&batchReq, &batchRsp);
+
+        if(status == (ApiMac_status_t)MT_RPC_ERROR)
+        {
+            /* Older co-processor code doesn't know the command */
+            setBatch.unsupported = true;
+        }
+        else if(status != (ApiMac_status_t)MT_FAIL)
+        {
+            if((setBatch.status == ApiMac_status_success)
+               && (status != ApiMac_status_success))
+            {
+                setBatch.status = status;
+            }
+            setBatch.count = 0;
+            setBatch.len = 0;
+            return;
+        }
+        /* Else no answer, setting them again one at a time does no harm */
+    }
+
+    pBuf = setBatch.data;
+    for(x = 0; x < setBatch.count; x++)
+    {
+        uint16_t attr = Util_parseUint16(&pBuf[1]);
+        uint8_t len = pBuf[3];
+
+        status = sendPib(pBuf[0], attr, &pBuf[SET_BATCH_ATTR_HDR_LEN], len);
+        if((setBatch.status == ApiMac_status_success)
+           && (status != ApiMac_status_success))
+        {
+            setBatch.status = status;
+        }
+        pBuf += SET_BATCH_ATTR_HDR_LEN + len;
+    }
+    setBatch.count = 0;
+    setBatch.len = 0;
+}
+
+/*!
+ * @brief       Get the length of an FH PIB array attribute
+ *
+ * @param       pibAttribute - the attribute
+ * @param       pLen - filled in with the length, as reported by the
+ *                     co-processor
+ *
+ * @return      status result, not success if the length isn't known
+ */
+static ApiMac_status_t getFhArrayLen(uint16_t pibAttribute, uint8_t *pLen)
+{
+    MtMac_fhGetReq_t fhGetLen;
+    MtMac_fhGetReqSrsp_t fhGetLenRsp;
+    ApiMac_status_t status;
+    uint8_t x;
+
+    for(x = 0; x < numFhArrayLens; x++)
+    {
+        if(fhArrayLens[x].attr == pibAttribute)
+        {
+            *pLen = fhArrayLens[x].len;
+            return (ApiMac_status_success);
+        }
+    }
+
+    fhGetLen.AttributeID = pibAttribute;
+    fhGetLenRsp.Data = NULL;
+    fhGetLenRsp.AttrLen = 0;
+    status = (ApiMac_status_t)MtMac_fhGetReq(&fhGetLen, &fhGetLenRsp);
+    if((status == ApiMac_status_success) && (fhGetLenRsp.AttrLen == 0))
+    {
+        status = ApiMac_status_unsupportedAttribute;
+    }
+    if(status != ApiMac_status_success)
+    {
+        return (status);
+    }
+
+    if(numFhArrayLens < FH_ARRAY_LENS)
+    {
+        fhArrayLens[numFhArrayLens].attr = pibAttribute;
+        fhArrayLens[numFhArrayLens].len = fhGetLenRsp.AttrLen;
+        numFhArrayLens++;
+    }
+    *pLen = (uint8_t)fhGetLenRsp.AttrLen;
+    return (ApiMac_status_success);
+}
+
 /*!
   Convert from bitmask byte to API MAC capInfo
 
@@ -137,6 +137,8 @@
  - ApiMac_mlmeSetFhReqUint16()
  - ApiMac_mlmeSetFhReqUint32()
  - ApiMac_mlmeSetFhReqArray()
+ - ApiMac_mlmeSetBatchStart()
+ - ApiMac_mlmeSetBatchEnd()
  - ApiMac_mlmeSetSecurityReqUint8()
  - ApiMac_mlmeSetSecurityReqUint16()
  - ApiMac_mlmeSetSecurityReqArray()
@@ -2982,6 +2984,24 @@ extern ApiMac_status_t ApiMac_mlmeSetFhReqUint32(
 extern ApiMac_status_t ApiMac_mlmeSetFhReqArray(
                 ApiMac_FHAttribute_array_t pibAttribute, uint8_t *pValue);
 
+/*!
+ * @brief       Hold the MAC and FH PIB settings that follow, up to
+ *              ApiMac_mlmeSetBatchEnd(), and send them to the co-processor
+ *              in as few frames as fit instead of one frame each.  The set
+ *              functions then return success without waiting.  Security PIB
+ *              settings are still sent on their own, after the held ones.
+ *              Nothing but set requests should be made in between.
+ */
+extern void ApiMac_mlmeSetBatchStart(void);
+
+/*!
+ * @brief       Send the settings held since ApiMac_mlmeSetBatchStart().
+ *
+ * @return      The first failure of the held settings, or
+ *              [ApiMac_status_success](@ref ApiMac_status_success)
+ */
+extern ApiMac_status_t ApiMac_mlmeSetBatchEnd(void);
+
 /*!
  * @brief       This direct execute function sets an attribute value
  *              in the MAC Security PIB.
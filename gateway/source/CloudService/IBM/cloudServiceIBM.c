@@ -50,6 +50,9 @@
 //! @{
 //
 //*****************************************************************************
+/* Console prints of this file, see Utils/uart_term.h */
+#define LOG_MODULE TermLog_module_cloud
+
 /* Standard includes                                                          */
 #include <string.h>
 #include <stdlib.h>
@@ -85,6 +88,7 @@
 
 /* Common interface includes                                                  */
 #include <Utils/uart_term.h>
+#include <Utils/latency.h>
 #include <Common/commonDefs.h>
 
 /* Application includes                                                       */
@@ -168,21 +172,6 @@ char ClientId[CLIENTID_MAX_LEN];
 char IBMServerAddress[IBM_SRVR_ADDR_MAC_LEN];
 
 
-const char *incomingDevCmds[] =
-{
- "updateFanSpeed",
- "sendToggle",
- "updateDoorLock",
- "leakBuzzOff"
-};
-const CmdTypes incomingDevCmdTypes[] =
-{
- CmdType_FAN_DATA,
- CmdType_LED_DATA,
- CmdType_DOORLOCK_DATA,
- CmdType_LEAK_DATA
-};
-
 //*****************************************************************************
 //                      LOCAL FUNCTION PROTOTYPES
 //*****************************************************************************
@@ -578,6 +567,10 @@ void CloudIBM_handleGatewayEvt(msgQueue_t *inEvtMsg)
                                      tmpBuff,
                                      strlen(tmpBuff),
                                      MQTT_QOS_0 | MQTT_PUBLISH_RETAIN );
+            if(inEvtMsg->event == CloudServiceEvt_DEV_UPDATE)
+            {
+                Latency_recordSince(Latency_stage_cloud, inEvtMsg->timestamp);
+            }
 
             UART_PRINT("\n\r [Cloud Service] CC3200 Publishes the following message \n\r");
             UART_PRINT("\tTopic: %s\n\r", tmpTopic);
@@ -588,7 +581,8 @@ void CloudIBM_handleGatewayEvt(msgQueue_t *inEvtMsg)
     {
         char *buf = (char*)malloc(inEvtMsg->msgPtrLen);
         memcpy(buf, inEvtMsg->msgPtr, inEvtMsg->msgPtrLen);
-        msgQueue_t mqEvt = {inEvtMsg->event, buf, inEvtMsg->msgPtrLen};
+        msgQueue_t mqEvt = {inEvtMsg->event, buf, inEvtMsg->msgPtrLen,
+                            inEvtMsg->timestamp};
         if(mq_send(disconnectedMq, (char*) &mqEvt, sizeof(msgQueue_t), 0) != 0)
         {
             free(buf);
@@ -604,87 +598,36 @@ void CloudIBM_handleGatewayEvt(msgQueue_t *inEvtMsg)
  */
 void CloudIBM_handleCloudEvt(msgQueue_t *inEvtMsg)
 {
-    char *extractedJson;
     char *tmpBuff;
+    deviceCmd_t command;
     deviceCmd_t *inCommand;
     msgQueue_t queueElementSend;
-    inCommand = malloc(sizeof(deviceCmd_t));
-    inCommand->cmdType =   0xFFFF;
-    inCommand->shortAddr = 0x0000;
+    CloudJson_status_t status;
+    CloudJson_error_t error = {"", 0};
     tmpBuff = (char *)inEvtMsg->msgPtr;
     UART_PRINT(" [CS_IBM] InCmd: %s\n\r", tmpBuff);
 
-    extractedJson = jsonParseIn(tmpBuff, "action");
-    if(extractedJson)
+    /* Rejected commands stay off the heap; they are logged at info level,
+       which the log thread writes later, so a flood of them doesn't stall
+       this task on the UART */
+    status = CloudJson_parseCmd(tmpBuff, &command, &error);
+    if(status != CloudJson_status_success)
     {
-        UART_PRINT(" [CS_IBM] ExtractedJson: %s\n\r", extractedJson);
-        queueElementSend.event = GatewayEvent_PERMIT_JOIN;
-        inCommand->cmdType = CmdType_PERMIT_JOIN;
-        if(strncmp(extractedJson, "open", 5) == 0)
-        {
-            inCommand->data = 1;
-        }
-        else if(strncmp(extractedJson, "close", 5) == 0)
-        {
-            inCommand->data = 0;
-        }
-        free(extractedJson);
+        ReportLog(LOG_MODULE, TermLog_level_info,
+                  " [CS_IBM] Command rejected (%d): %.*s\n\r", status,
+                  error.len, error.pText);
+        return;
     }
 
-    extractedJson = jsonParseIn(tmpBuff, "dstAddr");
-    if(!extractedJson)
-    {
-        extractedJson = jsonParseIn(tmpBuff, "ext_addr");
-        inCommand->shortAddr = 0xFFFF;
-    }
-
-
-    if(extractedJson)
+    inCommand = malloc(sizeof(deviceCmd_t));
+    if(inCommand == NULL)
     {
-        UART_PRINT(" [CS_IBM] ExtractedJson: %s\n\r", extractedJson);
-        int shortAddr;
-        inCommand->cmdType = CmdType_DEVICE_DATA;
-        queueElementSend.event = GatewayEvent_DEVICE_CMD;
-        if(inCommand->shortAddr == 0x0000)
-        {
-            sscanf(extractedJson, "%x", &shortAddr);
-            inCommand->shortAddr = shortAddr;
-        }
-        else if(inCommand->shortAddr == 0xFFFF)
-        {
-            *(uint64_t*)inCommand->extAddr = strtoull (extractedJson, NULL, 16);
-        }
-        free(extractedJson);
-
-        extractedJson = jsonParseIn(tmpBuff, "devActionType");
-        if(extractedJson)
-        {
-            for(uint8_t cmds = 0; cmds < sizeof(incomingDevCmds); cmds++)
-            {
-                if(strncmp(extractedJson, incomingDevCmds[cmds], strlen(incomingDevCmds[cmds])) == 0)
-                {
-                    inCommand->cmdType = incomingDevCmdTypes[cmds];
-                    break;
-                }
-            }
-            free(extractedJson);
-        }
-
-
-
-        extractedJson = jsonParseIn(tmpBuff, "value");
-        if(extractedJson)
-        {
-            inCommand->data = atoi(extractedJson);
-            free(extractedJson);
-        }
-//        extractedJson = jsonParseIn(tmpBuff, "toggleLED");
-//        if(extractedJson)
-//        {
-//            inCommand->cmdType = CmdType_LED_DATA;
-//            free(extractedJson);
-//        }
+        return;
     }
+    *inCommand = command;
+    queueElementSend.event = (command.cmdType == CmdType_PERMIT_JOIN) ?
+                             GatewayEvent_PERMIT_JOIN :
+                             GatewayEvent_DEVICE_CMD;
     queueElementSend.msgPtr = inCommand;
 
     /* send message to gateway task for processing */
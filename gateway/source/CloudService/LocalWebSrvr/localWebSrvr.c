@@ -48,12 +48,16 @@
  Includes
  *****************************************************************************/
 
+/* Console prints of this file, see Utils/uart_term.h */
+#define LOG_MODULE TermLog_module_webServer
+
 /* Standard Include */
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
 #include <unistd.h>
+#include <time.h>
 #include <stdbool.h>
 #include <mqueue.h>
 
@@ -61,6 +65,9 @@
 #include <ti/drivers/net/wifi/simplelink.h>
 #include <Common/commonDefs.h>
 #include <Utils/uart_term.h>
+#include <Utils/latency.h>
+#include <Utils/metrics.h>
+#include <Gateway/history.h>
 #include <CloudService/cloudJson.h>
 #include <CloudService/IBM/cloudServiceIBM.h>
 #include "localWebSrvr.h"
@@ -81,26 +88,11 @@
 #define NETAPP_MAX_RX_FRAGMENT_LEN      SL_NETAPP_REQUEST_MAX_DATA_LEN
 #define NETAPP_MAX_METADATA_LEN         (100)
 #define NETAPP_MAX_ARGV_TO_CALLBACK SL_FS_MAX_FILE_NAME_LENGTH+50
-#define NUMBER_OF_URI_SERVICES          (6)
+#define NUMBER_OF_URI_SERVICES          (9)
 
 
 const uint8_t pgNotFound[] = "<html>404 - Sorry page not found</html>";
 
-const char *incomingDevCmdsLocal[] =
-{
- "updateFanSpeed",
- "sendToggle",
- "updateDoorLock",
- "leakBuzzOff"
-};
-const CmdTypes incomingDevCmdTypesLocal[] =
-{
- CmdType_FAN_DATA,
- CmdType_LED_DATA,
- CmdType_DOORLOCK_DATA,
- CmdType_LEAK_DATA
-};
-
 /******************************************************************************
  Local Function Prototypes
  *****************************************************************************/
@@ -110,6 +102,9 @@ int32_t cmdPostCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **arg
 int32_t actionPostCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **argvCallback, SlNetAppRequest_t *netAppRequest);
 int32_t cloudGetCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **argvCallback, SlNetAppRequest_t *netAppRequest);
 int32_t cloudPostCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **argvCallback, SlNetAppRequest_t *netAppRequest);
+int32_t latencyGetCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **argvCallback, SlNetAppRequest_t *netAppRequest);
+int32_t metricsGetCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **argvCallback, SlNetAppRequest_t *netAppRequest);
+int32_t historyGetCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **argvCallback, SlNetAppRequest_t *netAppRequest);
 void NetAppRequestErrorResponse(SlNetAppResponse_t *pNetAppResponse);
 void httpGetHandler(SlNetAppRequest_t *netAppRequest);
 void httpPostHandler(SlNetAppRequest_t *netAppRequest);
@@ -142,6 +137,13 @@ http_RequestObj_t    httpRequest[NUMBER_OF_URI_SERVICES] =
                                                     {"type"},
                                                     {"id"},
                                                     {"password"}}, cloudPostCallback},
+        {6, SL_NETAPP_REQUEST_HTTP_GET, "/latency", {{"latency"}}, latencyGetCallback},
+        {7, SL_NETAPP_REQUEST_HTTP_GET, "/metrics", {{"metrics"}}, metricsGetCallback},
+        {8, SL_NETAPP_REQUEST_HTTP_GET, "/history", {{"dev"},
+                                                     {"type"},
+                                                     {"from"},
+                                                     {"to"},
+                                                     {"points"}}, historyGetCallback},
 };
 http_headerFieldType_t g_HeaderFields [] =
 {
@@ -736,10 +738,11 @@ int32_t actionPostCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **
     UART_PRINT("\n\r\n\r[Action POST Handler] Callback Called: \n\r\n\r");
     uint8_t *argvArray, ptemp;
     uint16_t metadataLen, elementType;
-    char *extractedJson;
+    deviceCmd_t command;
     deviceCmd_t *inCommand;
-    inCommand = malloc(sizeof(deviceCmd_t));
-    inCommand->cmdType = 0xFFFF;
+    bool haveCommand = false;
+    CloudJson_status_t status;
+    CloudJson_error_t error = {"", 0};
 
     msgQueue_t queueElementSend;
 
@@ -755,60 +758,17 @@ int32_t actionPostCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **
                 switch(ptemp)
                 {
                     case 0:
-                        inCommand->shortAddr = 0x0000;
-                        extractedJson = jsonParseIn((char*) (argvArray + ARGV_VALUE_OFFSET), "dstAddr");
-                        if(!extractedJson)
+                        /* Rejected commands stay off the heap */
+                        status = CloudJson_parseCmd((char*) (argvArray + ARGV_VALUE_OFFSET), &command, &error);
+                        if(status == CloudJson_status_success)
                         {
-                            extractedJson = jsonParseIn((char*) (argvArray + ARGV_VALUE_OFFSET), "ext_addr");
-                            inCommand->shortAddr = 0xFFFF;
+                            haveCommand = true;
                         }
-
-
-                        if(extractedJson)
+                        else
                         {
-                            UART_PRINT(" [CS_AWS] ExtractedJson: %s\n\r", extractedJson);
-                            int shortAddr;
-                            inCommand->cmdType = CmdType_DEVICE_DATA;
-                            queueElementSend.event = GatewayEvent_DEVICE_CMD;
-                            if(inCommand->shortAddr == 0x0000)
-                            {
-                                sscanf(extractedJson, "%x", &shortAddr);
-                                inCommand->shortAddr = shortAddr;
-                            }
-                            else if(inCommand->shortAddr == 0xFFFF)
-                            {
-                                *(uint64_t*)inCommand->extAddr = strtoull (extractedJson, NULL, 16);
-                            }
-                            free(extractedJson);
-
-                            extractedJson = jsonParseIn((char*) (argvArray + ARGV_VALUE_OFFSET), "devActionType");
-                            if(extractedJson)
-                            {
-                                for(uint8_t cmds = 0; cmds < sizeof(incomingDevCmdsLocal); cmds++)
-                                {
-                                    if(strncmp(extractedJson, incomingDevCmdsLocal[cmds], strlen(incomingDevCmdsLocal[cmds])) == 0)
-                                    {
-                                        inCommand->cmdType = incomingDevCmdTypesLocal[cmds];
-                                        break;
-                                    }
-                                }
-                                free(extractedJson);
-                            }
-
-
-
-                            extractedJson = jsonParseIn((char*) (argvArray + ARGV_VALUE_OFFSET), "value");
-                            if(extractedJson)
-                            {
-                                inCommand->data = atoi(extractedJson);
-                                free(extractedJson);
-                            }
-                    //        extractedJson = jsonParseIn(tmpBuff, "toggleLED");
-                    //        if(extractedJson)
-                    //        {
-                    //            inCommand->cmdType = CmdType_LED_DATA;
-                    //            free(extractedJson);
-                    //        }
+                            ReportLog(LOG_MODULE, TermLog_level_info,
+                                      " [Action POST Handler] Command rejected (%d): %.*s\n\r",
+                                      status, error.len, error.pText);
                         }
                         break;
                     default:
@@ -826,11 +786,23 @@ int32_t actionPostCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **
         argvArray++;        /* skip the length */
     }
 
-    queueElementSend.msgPtr = inCommand;
-
-    mq_send(*gatewayCliMq, (char*) &queueElementSend, sizeof(msgQueue_t), 0);
-
+    if(haveCommand)
+    {
+        inCommand = malloc(sizeof(deviceCmd_t));
+        if(inCommand != NULL)
+        {
+            *inCommand = command;
+            queueElementSend.event = (command.cmdType == CmdType_PERMIT_JOIN) ?
+                                     GatewayEvent_PERMIT_JOIN :
+                                     GatewayEvent_DEVICE_CMD;
+            queueElementSend.msgPtr = inCommand;
 
+            if(mq_send(*gatewayCliMq, (char*) &queueElementSend, sizeof(msgQueue_t), 0) != 0)
+            {
+                free(inCommand);
+            }
+        }
+    }
 
     metadataLen = preparePostMetadata(0);
 
@@ -1004,6 +976,238 @@ int32_t cloudPostCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **a
     return 0;
 }
 
+//*****************************************************************************
+//
+//! \brief This is the latency histogram service callback function for HTTP GET
+//!
+//! \param[in]  requestIdx          request index to indicate the message
+//!
+//! \param[in]  argcCallback        count of input params to the service callback
+//!
+//! \param[in]  argvCallback        set of input params to the service callback
+//!
+//! \param[in] netAppRequest        netapp request structure
+//!
+//! \return 0 on success else negative
+//!
+//****************************************************************************
+int32_t latencyGetCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **argvCallback, SlNetAppRequest_t *netAppRequest)
+{
+    UART_PRINT("[Latency GET Handler] Callback Called: \n\r");
+    uint16_t metadataLen;
+    uint16_t latencyLen;
+
+    latencyLen = Latency_formatJson((char*)gPayloadBuffer, sizeof(gPayloadBuffer));
+    if(latencyLen == 0)
+    {
+        return -1;
+    }
+
+    metadataLen = prepareGetMetadata(0, latencyLen, HttpContentTypeList_UrlEncoded);
+
+    sl_NetAppSend (netAppRequest->Handle, metadataLen, gMetadataBuffer, (SL_NETAPP_REQUEST_RESPONSE_FLAGS_CONTINUATION | SL_NETAPP_REQUEST_RESPONSE_FLAGS_METADATA));
+    UART_PRINT("[Latency GET Handler] Metadata Sent; %s, len = %d \n\r", gMetadataBuffer, metadataLen);
+
+    sl_NetAppSend (netAppRequest->Handle, latencyLen, gPayloadBuffer, 0); /* mark as last segment */
+    UART_PRINT("[Latency GET Handler] Data Sent, len = %d\n\r", latencyLen);
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+//! \brief This is the metrics service callback function for HTTP GET
+//!
+//! The text is longer than a fragment, it is formatted from one snapshot
+//! and sent a fragment at a time.
+//!
+//! \param[in]  requestIdx          request index to indicate the message
+//!
+//! \param[in]  argcCallback        count of input params to the service callback
+//!
+//! \param[in]  argvCallback        set of input params to the service callback
+//!
+//! \param[in] netAppRequest        netapp request structure
+//!
+//! \return 0 on success else negative
+//!
+//****************************************************************************
+int32_t metricsGetCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **argvCallback, SlNetAppRequest_t *netAppRequest)
+{
+    DBG_PRINT("[Metrics GET Handler] Callback Called: \n\r");
+    uint16_t metadataLen;
+    uint32_t metricsLen;
+    uint32_t offset;
+    uint32_t fragmentLen;
+
+    Metrics_snapshot();
+    metricsLen = Metrics_formatText(NULL, 0, 0);
+
+    metadataLen = prepareGetMetadata(0, metricsLen, HttpContentTypeList_TextPlain);
+
+    sl_NetAppSend (netAppRequest->Handle, metadataLen, gMetadataBuffer, (SL_NETAPP_REQUEST_RESPONSE_FLAGS_CONTINUATION | SL_NETAPP_REQUEST_RESPONSE_FLAGS_METADATA));
+
+    for(offset = 0; offset < metricsLen; offset += fragmentLen)
+    {
+        fragmentLen = metricsLen - offset;
+        if(fragmentLen > sizeof(gPayloadBuffer))
+        {
+            fragmentLen = sizeof(gPayloadBuffer);
+        }
+        Metrics_formatText((char*)gPayloadBuffer, fragmentLen, offset);
+        sl_NetAppSend (netAppRequest->Handle, fragmentLen, gPayloadBuffer,
+                       ((offset + fragmentLen) < metricsLen) ? SL_NETAPP_REQUEST_RESPONSE_FLAGS_CONTINUATION : 0);
+    }
+    DBG_PRINT("[Metrics GET Handler] Data Sent, len = %d\n\r", (int)metricsLen);
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+//! \brief This is the reading history service callback function for HTTP GET
+//!
+//! /history?dev=<hex>&type=<object type>[&from=<s>][&to=<s>][&points=<n>]
+//! returns the readings of the objects of the type of the device, averaged
+//! in points time steps from from to to, seconds since 1970.  dev is the
+//! short address, or the extended address if it has more than 4 digits.
+//! The default is the last 24 hours in HISTORY_MAX_POINTS steps.
+//!
+//! \param[in]  requestIdx          request index to indicate the message
+//!
+//! \param[in]  argcCallback        count of input params to the service callback
+//!
+//! \param[in]  argvCallback        set of input params to the service callback
+//!
+//! \param[in] netAppRequest        netapp request structure
+//!
+//! \return 0 on success else negative
+//!
+//****************************************************************************
+int32_t historyGetCallback(uint8_t requestIdx, uint8_t *argcCallback, uint8_t **argvCallback, SlNetAppRequest_t *netAppRequest)
+{
+    DBG_PRINT("[History GET Handler] Callback Called: \n\r");
+    uint8_t *argvArray, ptemp = 0;
+    uint16_t metadataLen, elementType;
+    uint8_t extAddr[8];
+    bool isExtAddr = false;
+    uint16_t shortAddr = 0;
+    char type[MAX_TYPE_CHAR_LEN] = "";
+    uint32_t to = (uint32_t)time(NULL);
+    uint32_t from = 0;
+    uint16_t numPoints = HISTORY_MAX_POINTS;
+    History_result_t *pResult;
+    uint32_t historyLen;
+    uint32_t offset;
+    uint32_t fragmentLen;
+    int32_t status = -1;
+
+    argvArray = *argvCallback;
+
+    while (*argcCallback > 0)
+    {
+        elementType = setElementType(1, requestIdx, CONTENT_LEN_TYPE);
+
+        if ( *((uint16_t *)argvArray) != elementType)
+        {
+            if (*(argvArray + 1) & 0x80)    /* means it is the value, not the parameter */
+            {
+                char *tempStr;
+                tempStr = (char*) (argvArray + ARGV_VALUE_OFFSET);
+                switch(ptemp)
+                {
+                    case historyDev:
+                        if(strlen(tempStr) > 4)
+                        {
+                            /* most significant byte first, as it is printed */
+                            uint64_t addr = strtoull(tempStr, NULL, 16);
+                            uint8_t i;
+
+                            for(i = 0; i < sizeof(extAddr); i++)
+                            {
+                                extAddr[i] = (uint8_t)(addr >> (8 * i));
+                            }
+                            isExtAddr = true;
+                        }
+                        else
+                        {
+                            shortAddr = (uint16_t)strtoul(tempStr, NULL, 16);
+                        }
+                        break;
+                    case historyType:
+                        strncpy(type, tempStr, sizeof(type) - 1);
+                        break;
+                    case historyFrom:
+                        from = strtoul(tempStr, NULL, 10);
+                        break;
+                    case historyTo:
+                        to = strtoul(tempStr, NULL, 10);
+                        break;
+                    case historyPoints:
+                        numPoints = (uint16_t)strtoul(tempStr, NULL, 10);
+                        break;
+                    default:
+                        break;
+                }
+            }
+            else
+            {
+                ptemp = *(argvArray + ARGV_VALUE_OFFSET);
+            }
+        }
+        (*argcCallback)--;
+        argvArray += ARGV_LEN_OFFSET;       /* skip the type */
+        argvArray += *argvArray;    /* add the length */
+        argvArray++;        /* skip the length */
+    }
+
+    if(from == 0)
+    {
+        from = to - (24UL * 60UL * 60UL);
+    }
+
+    pResult = (History_result_t*)malloc(sizeof(History_result_t));
+    if((pResult != NULL) &&
+       History_query(isExtAddr ? extAddr : NULL, shortAddr, type, from, to,
+                     numPoints, pResult))
+    {
+        status = 0;
+    }
+
+    if(status != 0)
+    {
+        strcpy((char *)gPayloadBuffer, (const char *)pgNotFound);
+        metadataLen = prepareGetMetadata(status, strlen((const char *)gPayloadBuffer), HttpContentTypeList_TextHtml);
+
+        sl_NetAppSend (netAppRequest->Handle, metadataLen, gMetadataBuffer, (SL_NETAPP_REQUEST_RESPONSE_FLAGS_CONTINUATION | SL_NETAPP_REQUEST_RESPONSE_FLAGS_METADATA));
+        sl_NetAppSend (netAppRequest->Handle, strlen ((const char *)gPayloadBuffer), gPayloadBuffer, 0); /* mark as last segment */
+        free(pResult);
+        return status;
+    }
+
+    historyLen = History_formatJson(pResult, NULL, 0, 0);
+
+    metadataLen = prepareGetMetadata(0, historyLen, HttpContentTypeList_ApplicationJson);
+
+    sl_NetAppSend (netAppRequest->Handle, metadataLen, gMetadataBuffer, (SL_NETAPP_REQUEST_RESPONSE_FLAGS_CONTINUATION | SL_NETAPP_REQUEST_RESPONSE_FLAGS_METADATA));
+
+    for(offset = 0; offset < historyLen; offset += fragmentLen)
+    {
+        fragmentLen = historyLen - offset;
+        if(fragmentLen > sizeof(gPayloadBuffer))
+        {
+            fragmentLen = sizeof(gPayloadBuffer);
+        }
+        History_formatJson(pResult, (char*)gPayloadBuffer, fragmentLen, offset);
+        sl_NetAppSend (netAppRequest->Handle, fragmentLen, gPayloadBuffer,
+                       ((offset + fragmentLen) < historyLen) ? SL_NETAPP_REQUEST_RESPONSE_FLAGS_CONTINUATION : 0);
+    }
+    DBG_PRINT("[History GET Handler] Data Sent, len = %d\n\r", (int)historyLen);
+
+    free(pResult);
+    return 0;
+}
+
 //*****************************************************************************
 //
 //! \brief This function checks that the content requested via HTTP message exists
@@ -171,6 +171,15 @@ typedef enum
     password,
 }CloudPost;
 
+typedef enum
+{
+    historyDev,
+    historyType,
+    historyFrom,
+    historyTo,
+    historyPoints,
+}HistoryGet;
+
 typedef struct    _http_headerFieldType_t_
 {
     SlNetAppMetadataHTTPTypes_e headerType;
@@ -2,7 +2,7 @@
 
  @file cloudJson.c
 
- @brief
+ @brief Decoder of the JSON commands from the cloud and the local web page
 
  Group: WCS LPC
  Target Device: CC13xx CC32xx
@@ -43,40 +43,489 @@
  Release Name:
  Release Date:
  *****************************************************************************/
-#include <stdlib.h>
-#include <stdio.h>
 #include <string.h>
 #include <ThirdParty/jsmn.h>
 #include <Common/commonDefs.h>
-#include <Utils/uart_term.h>
 #include "cloudJson.h"
 
+//*****************************************************************************
+//                          LOCAL DEFINES
+//*****************************************************************************
 
-char* jsonParseIn(char* payload_str, char* findToken)
+/* The object, a key and a value for each of the eight keys and the members
+   of a group */
+#define CLOUDJSON_MAX_TOKENS    (1 + (2 * 8) + MAX_GROUP_MEMBERS)
+
+/* Keys seen */
+#define KEY_ACTION              0x01
+#define KEY_DST_ADDR            0x02
+#define KEY_EXT_ADDR            0x04
+#define KEY_DEV_ACTION_TYPE     0x08
+#define KEY_VALUE               0x10
+#define KEY_GROUP_ID            0x20
+#define KEY_MEMBERS             0x40
+#define KEY_OAD_URL             0x80
+
+/* Scheme of an OAD image URL, the image is fetched with plain HTTP */
+#define OAD_URL_SCHEME          "http://"
+
+/* String compare of a token against a literal */
+#define TOKEN_IS(pJson, pTok, str) \
+    ((((pTok)->end - (pTok)->start) == (sizeof(str) - 1)) && \
+     (memcmp(&(pJson)[(pTok)->start], (str), sizeof(str) - 1) == 0))
+
+//*****************************************************************************
+//                          LOCAL VARIABLES
+//*****************************************************************************
+
+static const struct
+{
+    const char *pName;
+    CmdTypes cmdType;
+} devActionTypes[] =
+{
+    {"updateFanSpeed", CmdType_FAN_DATA},
+    {"sendToggle", CmdType_LED_DATA},
+    {"updateDoorLock", CmdType_DOORLOCK_DATA},
+    {"leakBuzzOff", CmdType_LEAK_DATA}
+};
+
+//*****************************************************************************
+//                      LOCAL FUNCTION PROTOTYPES
+//*****************************************************************************
+
+static bool parseHex(const char *pStr, int len, uint64_t *pValue);
+static bool parseInt(const char *pStr, int len, int32_t *pValue);
+
+//*****************************************************************************
+//                          PUBLIC FUNCTIONS
+//*****************************************************************************
+
+/*!
+ Decode a command
+
+ Public function defined in cloudJson.h
+ */
+CloudJson_status_t CloudJson_parseCmd(const char *pPayload, deviceCmd_t *pCmd,
+                                      CloudJson_error_t *pError)
+{
+    jsmn_parser parser;
+    jsmntok_t tokens[CLOUDJSON_MAX_TOKENS];
+    const jsmntok_t *pAddr = NULL;
+    const jsmntok_t *pGroup = NULL;
+    const jsmntok_t *pMembers = NULL;
+    uint8_t keys = 0;
+    uint16_t cmdType = CmdType_DEVICE_DATA;
+    uint32_t data = 0;
+    uint32_t action = 0;
+    uint64_t value64;
+    int32_t value32;
+    int numTokens;
+    uint8_t groupId = 0;
+    int pair;
+    int i;
+
+    memset(pCmd, 0, sizeof(deviceCmd_t));
+
+    jsmn_init(&parser);
+    numTokens = jsmn_parse(&parser, pPayload, strlen(pPayload), tokens,
+                           CLOUDJSON_MAX_TOKENS);
+    if((numTokens < 1) || (tokens[0].type != JSMN_OBJECT))
+    {
+        return(CloudJson_status_badJson);
+    }
+
+    /* Keys and values alternate after the object, the only array is the
+       members list; any other nested object or array is rejected before its
+       own tokens would be reached */
+    for(pair = 0, i = 1; pair < tokens[0].size; pair++)
+    {
+        const jsmntok_t *pKey;
+        const jsmntok_t *pVal;
+        const char *pValStr;
+        int keyLen;
+        int valLen;
+        uint8_t key = 0;
+
+        if(((i + 1) >= numTokens) || (tokens[i].type != JSMN_STRING))
+        {
+            return(CloudJson_status_badJson);
+        }
+        pKey = &tokens[i];
+        pVal = &tokens[i + 1];
+        keyLen = pKey->end - pKey->start;
+        valLen = pVal->end - pVal->start;
+        pValStr = &pPayload[pVal->start];
+
+        /* The keys all have different lengths */
+        switch(keyLen)
+        {
+            case sizeof("value") - 1:
+                key = TOKEN_IS(pPayload, pKey, "value") ? KEY_VALUE : 0;
+                break;
+            case sizeof("action") - 1:
+                if(TOKEN_IS(pPayload, pKey, "action"))
+                {
+                    key = KEY_ACTION;
+                }
+                else if(TOKEN_IS(pPayload, pKey, "oadUrl"))
+                {
+                    key = KEY_OAD_URL;
+                }
+                break;
+            case sizeof("dstAddr") - 1:
+                if(TOKEN_IS(pPayload, pKey, "dstAddr"))
+                {
+                    key = KEY_DST_ADDR;
+                }
+                else if(TOKEN_IS(pPayload, pKey, "groupId"))
+                {
+                    key = KEY_GROUP_ID;
+                }
+                else if(TOKEN_IS(pPayload, pKey, "members"))
+                {
+                    key = KEY_MEMBERS;
+                }
+                break;
+            case sizeof("ext_addr") - 1:
+                key = TOKEN_IS(pPayload, pKey, "ext_addr") ? KEY_EXT_ADDR : 0;
+                break;
+            case sizeof("devActionType") - 1:
+                key = TOKEN_IS(pPayload, pKey, "devActionType") ?
+                      KEY_DEV_ACTION_TYPE : 0;
+                break;
+            default:
+                break;
+        }
+        if(key == 0)
+        {
+            if(pError != NULL)
+            {
+                pError->pText = &pPayload[pKey->start];
+                pError->len = keyLen;
+            }
+            return(CloudJson_status_unknownKey);
+        }
+
+        if((key == KEY_MEMBERS) ? (pVal->type != JSMN_ARRAY) :
+           ((pVal->type != JSMN_STRING) && (pVal->type != JSMN_PRIMITIVE)))
+        {
+            if(pError != NULL)
+            {
+                pError->pText = &pPayload[pKey->start];
+                pError->len = keyLen;
+            }
+            return(CloudJson_status_badValue);
+        }
+
+        switch(key)
+        {
+            case KEY_ACTION:
+                if(TOKEN_IS(pPayload, pVal, "open"))
+                {
+                    action = 1;
+                }
+                else if(TOKEN_IS(pPayload, pVal, "close"))
+                {
+                    action = 0;
+                }
+                else
+                {
+                    key = 0;
+                }
+                break;
+
+            case KEY_DST_ADDR:
+            case KEY_EXT_ADDR:
+                /* Checked once it is known which one is used */
+                if((key == KEY_DST_ADDR) || !(keys & KEY_DST_ADDR))
+                {
+                    pAddr = pVal;
+                }
+                break;
+
+            case KEY_DEV_ACTION_TYPE:
+            {
+                uint8_t t;
+
+                /* An unknown action type is sent as plain device data */
+                cmdType = CmdType_DEVICE_DATA;
+                for(t = 0; t < (sizeof(devActionTypes) /
+                                sizeof(devActionTypes[0])); t++)
+                {
+                    if((strlen(devActionTypes[t].pName) == (size_t)valLen) &&
+                       (memcmp(pValStr, devActionTypes[t].pName,
+                               valLen) == 0))
+                    {
+                        cmdType = devActionTypes[t].cmdType;
+                        break;
+                    }
+                }
+                break;
+            }
+
+            case KEY_VALUE:
+                if(parseInt(pValStr, valLen, &value32))
+                {
+                    data = (uint32_t)value32;
+                }
+                else
+                {
+                    key = 0;
+                }
+                break;
+
+            case KEY_OAD_URL:
+                /* An empty URL stops the image being pushed */
+                if((pVal->type == JSMN_STRING) && (valLen < MAX_OAD_URL_LEN) &&
+                   ((valLen == 0) ||
+                    ((valLen > (int)(sizeof(OAD_URL_SCHEME) - 1)) &&
+                     (memcmp(pValStr, OAD_URL_SCHEME,
+                             sizeof(OAD_URL_SCHEME) - 1) == 0))))
+                {
+                    memcpy(pCmd->url, pValStr, valLen);
+                    pCmd->url[valLen] = '\0';
+                }
+                else
+                {
+                    key = 0;
+                }
+                break;
+
+            case KEY_GROUP_ID:
+                pGroup = pVal;
+                if(TOKEN_IS(pPayload, pVal, "all"))
+                {
+                    groupId = GROUP_ID_ALL;
+                }
+                else if(parseInt(pValStr, valLen, &value32) &&
+                        (value32 > 0) && (value32 < GROUP_ID_ALL))
+                {
+                    groupId = (uint8_t)value32;
+                }
+                else
+                {
+                    key = 0;
+                }
+                break;
+
+            case KEY_MEMBERS:
+            {
+                const jsmntok_t *pMember = pVal + 1;
+                int m;
+
+                pMembers = pKey;
+                if((pVal->size > MAX_GROUP_MEMBERS) ||
+                   ((i + 1 + pVal->size) >= numTokens))
+                {
+                    key = 0;
+                    break;
+                }
+                for(m = 0; m < pVal->size; m++, pMember++)
+                {
+                    if(((pMember->type != JSMN_STRING) &&
+                        (pMember->type != JSMN_PRIMITIVE)) ||
+                       !parseHex(&pPayload[pMember->start],
+                                 pMember->end - pMember->start, &value64) ||
+                       (value64 >= 0xFFFE))
+                    {
+                        key = 0;
+                        break;
+                    }
+                    pCmd->members[m] = (uint16_t)value64;
+                }
+                pCmd->numMembers = (uint8_t)m;
+                break;
+            }
+        }
+        if(key == 0)
+        {
+            if(pError != NULL)
+            {
+                pError->pText = pValStr;
+                pError->len = valLen;
+            }
+            return(CloudJson_status_badValue);
+        }
+        keys |= key;
+        i += 2 + ((key == KEY_MEMBERS) ? pVal->size : 0);
+    }
+
+    if(keys & KEY_OAD_URL)
+    {
+        /* For every device, the devices decide whether they want it */
+        pCmd->cmdType = CmdType_OAD_START;
+        pCmd->shortAddr = 0xFFFF;
+    }
+    else if(keys & (KEY_GROUP_ID | KEY_MEMBERS))
+    {
+        /* A group is defined by its members, or sent a command */
+        if((groupId == 0) ||
+           ((keys & KEY_MEMBERS) && (groupId == GROUP_ID_ALL)))
+        {
+            const jsmntok_t *pTok = (pGroup != NULL) ? pGroup : pMembers;
+
+            if(pError != NULL)
+            {
+                pError->pText = &pPayload[pTok->start];
+                pError->len = pTok->end - pTok->start;
+            }
+            return(CloudJson_status_badValue);
+        }
+
+        pCmd->groupId = groupId;
+        if(keys & KEY_MEMBERS)
+        {
+            pCmd->cmdType = CmdType_GROUP_DEFINE;
+        }
+        else if(keys & KEY_DEV_ACTION_TYPE)
+        {
+            pCmd->cmdType = cmdType;
+            pCmd->data = (keys & KEY_VALUE) ? data : action;
+        }
+        else
+        {
+            return(CloudJson_status_noCommand);
+        }
+    }
+    else if(pAddr != NULL)
+    {
+        if(!parseHex(&pPayload[pAddr->start], pAddr->end - pAddr->start,
+                     &value64) ||
+           ((keys & KEY_DST_ADDR) && (value64 > 0xFFFF)))
+        {
+            if(pError != NULL)
+            {
+                pError->pText = &pPayload[pAddr->start];
+                pError->len = pAddr->end - pAddr->start;
+            }
+            return(CloudJson_status_badValue);
+        }
+
+        if(keys & KEY_DST_ADDR)
+        {
+            pCmd->shortAddr = (uint16_t)value64;
+        }
+        else
+        {
+            /* The gateway looks the device up by its extended address */
+            pCmd->shortAddr = 0xFFFF;
+            memcpy(pCmd->extAddr, &value64, sizeof(pCmd->extAddr));
+        }
+        pCmd->cmdType = cmdType;
+        pCmd->data = (keys & KEY_VALUE) ? data : action;
+    }
+    else if(keys & KEY_ACTION)
+    {
+        pCmd->cmdType = CmdType_PERMIT_JOIN;
+        pCmd->shortAddr = 0x0000;
+        pCmd->data = action;
+    }
+    else
+    {
+        return(CloudJson_status_noCommand);
+    }
+
+    return(CloudJson_status_success);
+}
+
+//*****************************************************************************
+//                          LOCAL FUNCTIONS
+//*****************************************************************************
+
+/*!
+ * @brief   Parse a hex number, with or without 0x
+ *
+ * @param   pStr - the digits, not NUL terminated
+ * @param   len - number of characters
+ * @param   pValue - the number
+ *
+ * @return  true if it is a hex number of 64 bits or less
+ */
+static bool parseHex(const char *pStr, int len, uint64_t *pValue)
+{
+    uint64_t value = 0;
+    int i;
+
+    if((len > 2) && (pStr[0] == '0') &&
+       ((pStr[1] == 'x') || (pStr[1] == 'X')))
+    {
+        pStr += 2;
+        len -= 2;
+    }
+    if((len < 1) || (len > 16))
+    {
+        return(false);
+    }
+
+    for(i = 0; i < len; i++)
+    {
+        char c = pStr[i];
+
+        if((c >= '0') && (c <= '9'))
+        {
+            value = (value << 4) | (uint64_t)(c - '0');
+        }
+        else if((c >= 'a') && (c <= 'f'))
+        {
+            value = (value << 4) | (uint64_t)(c - 'a' + 10);
+        }
+        else if((c >= 'A') && (c <= 'F'))
+        {
+            value = (value << 4) | (uint64_t)(c - 'A' + 10);
+        }
+        else
+        {
+            return(false);
+        }
+    }
+
+    *pValue = value;
+    return(true);
+}
+
+/*!
+ * @brief   Parse a decimal number
+ *
+ * @param   pStr - the digits, not NUL terminated
+ * @param   len - number of characters
+ * @param   pValue - the number
+ *
+ * @return  true if it is a decimal number that fits 32 bits
+ */
+static bool parseInt(const char *pStr, int len, int32_t *pValue)
 {
-    char *retToken = NULL;
-    char *tempToken;
-    int tokenNum;
-    int tokenLen = 0;
-    jsmn_parser jParser;
-    jsmntok_t tokens[56]; /* We expect no more than 25 tokens */
-
-    jsmn_init(&jParser);
-    tokenNum = jsmn_parse(&jParser, payload_str, strlen(payload_str), tokens, sizeof(tokens)/sizeof(tokens[0]));
-    Report("JSON Tokens: %d\r\n", tokenNum-1);
-    for (int tokenIdx = 0; tokenIdx < tokenNum; tokenIdx++)
+    int64_t value = 0;
+    bool negative = false;
+    int i = 0;
+
+    if((len > 0) && (pStr[0] == '-'))
     {
-        tokenLen = tokens[tokenIdx].end - tokens[tokenIdx].start;
-        tempToken = (char*)(payload_str + tokens[tokenIdx].start);
-        if(strncmp(tempToken, findToken, tokenLen) == 0)
+        negative = true;
+        i++;
+    }
+    if((i >= len) || ((len - i) > 10))
+    {
+        return(false);
+    }
+
+    for(; i < len; i++)
+    {
+        if((pStr[i] < '0') || (pStr[i] > '9'))
         {
-            tokenIdx++;
-            tokenLen = tokens[tokenIdx].end-tokens[tokenIdx].start;
-            retToken = (char*)malloc(tokenLen + 1);
-            strncpy(retToken, payload_str + tokens[tokenIdx].start, tokenLen);
-            retToken[tokenLen] = '\0';
-            break;
+            return(false);
         }
+        value = (value * 10) + (pStr[i] - '0');
+    }
+    if(negative)
+    {
+        value = -value;
     }
-    return retToken;
+    if((value > INT32_MAX) || (value < INT32_MIN))
+    {
+        return(false);
+    }
+
+    *pValue = (int32_t)value;
+    return(true);
 }
@@ -2,7 +2,7 @@
 
  @file cloudJson.h
 
- @brief
+ @brief Decoder of the JSON commands from the cloud and the local web page
 
  Group: WCS LPC
  Target Device: CC13xx CC32xx
@@ -46,20 +46,61 @@
 #ifndef __CLOUDJSON_H_
 #define __CLOUDJSON_H_
 
+#include <Common/commonDefs.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*! Result of decoding a command */
+typedef enum
+{
+    /*! The command was decoded */
+    CloudJson_status_success,
+    /*! Not a JSON object, or more keys than any command has */
+    CloudJson_status_badJson,
+    /*! A key no command uses */
+    CloudJson_status_unknownKey,
+    /*! A value of the wrong type, or one that doesn't parse */
+    CloudJson_status_badValue,
+    /*! Neither an action nor a device or group address */
+    CloudJson_status_noCommand
+} CloudJson_status_t;
+
+/*! What a command was rejected for */
+typedef struct
+{
+    /*! The key or value, in the payload; not NUL terminated */
+    const char *pText;
+    /*! Its length */
+    int len;
+} CloudJson_error_t;
+
 /*!
- * @brief
+ * @brief   Decode a command from the cloud or the local web server in one
+ *          pass over the payload, without allocating anything.
  *
+ *          {"action": "open" | "close"} permits or stops joining.
+ *          {"dstAddr": "<hex>"} or {"ext_addr": "<hex>"} addresses a
+ *          device, with an optional "devActionType" naming the command
+ *          and "value" its data. The address wins if both are given.
+ *          {"groupId": <1..254> | "all"} with "devActionType" sends the
+ *          command to the members of a group instead, and
+ *          {"groupId": <1..254>, "members": ["<hex>", ...]} defines the
+ *          group (CmdType_GROUP_DEFINE); an empty list deletes it.
+ *          {"oadUrl": "http://..."} pushes the image at the URL to every
+ *          device that wants it (CmdType_OAD_START); "" stops it.
  *
- * @param
+ * @param   pPayload - NUL terminated JSON object
+ * @param   pCmd - filled in with the command
+ * @param   pError - filled in with the offending text when a key or value
+ *                   is rejected, may be NULL
  *
- * @return
+ * @return  CloudJson_status_success, or why the command was rejected
  */
-extern char* jsonParseIn(char* payload_str, char* findToken);
+extern CloudJson_status_t CloudJson_parseCmd(const char *pPayload,
+                                             deviceCmd_t *pCmd,
+                                             CloudJson_error_t *pError);
 
 #ifdef __cplusplus
 }
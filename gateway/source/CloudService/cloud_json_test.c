@@ -0,0 +1,307 @@
+/******************************************************************************
+
+ @file cloud_json_test.c
+
+ @brief Host fuzz and throughput test of the cloud command decoder
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name:
+ Release Date:
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+
+ Checks CloudJson_parseCmd() against generated commands, feeds it mutated,
+ truncated and random payloads, and times it.
+
+   cloud_json_test [<iterations>]
+
+ Every generated command must decode to the values it was built from.  A
+ rejected payload must report an offending text that lies inside it.  Build
+ with the sanitizers to catch reads past the payload or the token array.
+
+ Built on a host only, from gateway/source, e.g.
+   gcc -std=c99 -DCLOUD_JSON_HOST -DFEATURE_MAC_SECURITY
+       -fsanitize=address,undefined
+       -iquote . -iquote Collector -I . -o cloud_json_test
+       CloudService/cloud_json_test.c CloudService/cloudJson.c
+       ThirdParty/jsmn.c
+ *****************************************************************************/
+
+/* Host builds only; the project compiles this file for the device too */
+#ifdef CLOUD_JSON_HOST
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Common/commonDefs.h>
+#include "cloudJson.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Commands generated for the decode check, five times as many are fuzzed */
+#define DEFAULT_ITERATIONS  200000
+
+/* Decodes timed for the throughput */
+#define TIMED_DECODES       1000000
+
+/* Largest generated payload */
+#define PAYLOAD_SIZE        256
+
+/* What a generated command should decode to */
+typedef struct
+{
+    uint16_t cmdType;
+    uint16_t shortAddr;
+    uint64_t extAddr;
+    uint32_t data;
+} expect_t;
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+static const struct
+{
+    const char *pName;
+    CmdTypes cmdType;
+} devActionTypes[] =
+{
+    {"updateFanSpeed", CmdType_FAN_DATA},
+    {"sendToggle", CmdType_LED_DATA},
+    {"updateDoorLock", CmdType_DOORLOCK_DATA},
+    {"leakBuzzOff", CmdType_LEAK_DATA}
+};
+
+/******************************************************************************
+ Local functions
+ *****************************************************************************/
+
+/*!
+ * @brief   Build a random well formed command
+ *
+ * @param   pBuf - filled with the NUL terminated payload
+ * @param   pExp - filled with what it should decode to
+ *
+ * @return  length of the payload
+ */
+static int genCommand(char *pBuf, expect_t *pExp)
+{
+    int n = 0;
+    int kind = rand() % 3;
+    int action;
+
+    memset(pExp, 0, sizeof(expect_t));
+    n += sprintf(pBuf + n, "{");
+    if(kind == 0)
+    {
+        pExp->cmdType = CmdType_PERMIT_JOIN;
+        pExp->data = rand() & 1;
+        n += sprintf(pBuf + n, "\"action\":\"%s\"",
+                     pExp->data ? "open" : "close");
+        return (n + sprintf(pBuf + n, "}"));
+    }
+
+    pExp->cmdType = CmdType_DEVICE_DATA;
+    if(kind == 1)
+    {
+        pExp->shortAddr = rand() & 0xFFFF;
+        n += sprintf(pBuf + n, "\"dstAddr\":\"0x%04x\"", pExp->shortAddr);
+    }
+    else
+    {
+        pExp->shortAddr = 0xFFFF;
+        pExp->extAddr = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+        n += sprintf(pBuf + n, "\"ext_addr\":\"%016llx\"",
+                     (unsigned long long)pExp->extAddr);
+    }
+    if(rand() & 1)
+    {
+        action = rand() % (sizeof(devActionTypes) / sizeof(devActionTypes[0]));
+        pExp->cmdType = devActionTypes[action].cmdType;
+        n += sprintf(pBuf + n, ",\"devActionType\":\"%s\"",
+                     devActionTypes[action].pName);
+    }
+    if(rand() & 1)
+    {
+        pExp->data = rand() % 100;
+        n += sprintf(pBuf + n, (rand() & 1) ? ",\"value\":%u" :
+                     ",\"value\":\"%u\"", pExp->data);
+    }
+    return (n + sprintf(pBuf + n, "}"));
+}
+
+/*!
+ * @brief   Check a decoded command against what it was built from
+ *
+ * @return  true if they agree
+ */
+static bool sameCommand(const deviceCmd_t *pCmd, const expect_t *pExp)
+{
+    uint64_t extAddr = 0;
+    int i;
+
+    if((pCmd->cmdType != pExp->cmdType) || (pCmd->data != pExp->data))
+    {
+        return (false);
+    }
+    if(pExp->cmdType == CmdType_PERMIT_JOIN)
+    {
+        return (true);
+    }
+    for(i = 0; i < 8; i++)
+    {
+        extAddr |= (uint64_t)pCmd->extAddr[i] << (8 * i);
+    }
+    return ((pCmd->shortAddr == pExp->shortAddr) &&
+            (extAddr == pExp->extAddr));
+}
+
+/******************************************************************************
+ Public functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    static const char timedCmd[] =
+        "{\"dstAddr\":\"0x1a2b\",\"devActionType\":\"updateFanSpeed\","
+        "\"value\":3}";
+    char buf[PAYLOAD_SIZE];
+    char mut[PAYLOAD_SIZE];
+    long rejected[CloudJson_status_noCommand + 1] = {0};
+    long mismatches = 0;
+    clock_t start;
+    volatile uint32_t sink = 0;
+    CloudJson_status_t status;
+    CloudJson_error_t error;
+    deviceCmd_t cmd;
+    expect_t exp;
+    int iterations = DEFAULT_ITERATIONS;
+    int n;
+    int i;
+    int k;
+
+    if(argc > 1)
+    {
+        iterations = atoi(argv[1]);
+    }
+    srand(3);
+
+    /* Well formed commands decode to what they were built from */
+    for(i = 0; i < iterations; i++)
+    {
+        genCommand(buf, &exp);
+        status = CloudJson_parseCmd(buf, &cmd, &error);
+        if((status != CloudJson_status_success) || !sameCommand(&cmd, &exp))
+        {
+            if(mismatches++ < 5)
+            {
+                printf("mismatch (%d): %s\n", status, buf);
+            }
+        }
+    }
+    printf("decode: %d commands, %ld mismatches\n", iterations, mismatches);
+
+    /* Byte mutations, truncations and random bytes */
+    for(i = 0; i < (iterations * 5); i++)
+    {
+        n = genCommand(buf, &exp);
+        memcpy(mut, buf, n + 1);
+        switch(rand() % 3)
+        {
+            case 0:
+                for(k = 1 + (rand() % 4); k > 0; k--)
+                {
+                    mut[rand() % n] = (char)(1 + (rand() % 255));
+                }
+                break;
+            case 1:
+                mut[rand() % n] = 0;
+                break;
+            default:
+                for(k = 0; k < n; k++)
+                {
+                    mut[k] = (char)(1 + (rand() % 255));
+                }
+                break;
+        }
+
+        error.pText = "";
+        error.len = 0;
+        status = CloudJson_parseCmd(mut, &cmd, &error);
+        rejected[status]++;
+        if(((status == CloudJson_status_unknownKey) ||
+            (status == CloudJson_status_badValue)) &&
+           ((error.pText < mut) || (error.len < 0) ||
+            ((error.pText + error.len) > (mut + strlen(mut)))))
+        {
+            printf("error text outside the payload: %s\n", mut);
+            return (1);
+        }
+    }
+    printf("fuzz: %d payloads, ok %ld badJson %ld unknownKey %ld "
+           "badValue %ld noCommand %ld\n", iterations * 5,
+           rejected[CloudJson_status_success],
+           rejected[CloudJson_status_badJson],
+           rejected[CloudJson_status_unknownKey],
+           rejected[CloudJson_status_badValue],
+           rejected[CloudJson_status_noCommand]);
+
+    /* Throughput of a three key command */
+    start = clock();
+    for(i = 0; i < TIMED_DECODES; i++)
+    {
+        (void)CloudJson_parseCmd(timedCmd, &cmd, NULL);
+        sink += cmd.data;
+    }
+    printf("throughput: %.0f ns per command\n",
+           ((double)(clock() - start) * 1e9) /
+           ((double)CLOCKS_PER_SEC * TIMED_DECODES));
+
+    return ((mismatches == 0) ? 0 : 1);
+}
+
+#endif /* CLOUD_JSON_HOST */
@@ -55,6 +55,9 @@
 //! @{
 //
 //*****************************************************************************
+/* Console prints of this file, see Utils/uart_term.h */
+#define LOG_MODULE TermLog_module_cloud
+
 /* Standard includes                                                          */
 
 
@@ -527,6 +527,7 @@ void Cllc_restoreNetwork(Llc_netInfo_t *pNetworkInfo, uint8_t numDevices,
     coordInfoBlock.panID = pNetworkInfo->devInfo.panID;
 
     /* Populate network info according to type of network */
+    ApiMac_mlmeSetBatchStart();
     if(pNetworkInfo->fh == true)
     {
         ApiMac_mlmeSetReqArray(ApiMac_attribute_extendedAddress,
@@ -539,6 +540,7 @@ void Cllc_restoreNetwork(Llc_netInfo_t *pNetworkInfo, uint8_t numDevices,
 
     ApiMac_mlmeSetReqUint16(ApiMac_attribute_shortAddress,
                              pNetworkInfo->devInfo.shortAddress);
+    ApiMac_mlmeSetBatchEnd();
 
     sendStartReq(pNetworkInfo->fh);
 
@@ -1500,6 +1502,9 @@ static void sendAsyncReq(uint8_t frameType)
     /* no security for PA */
     memset(&asyncReq.sec, 0, sizeof(ApiMac_sec_t));
 
+    /* PIB values for the frame go to the co-processor together */
+    ApiMac_mlmeSetBatchStart();
+
     /* send PA or PC according to frame type */
     if(frameType == ApiMac_wisunAsyncFrame_advertisement)
     {
@@ -1549,6 +1554,7 @@ static void sendAsyncReq(uint8_t frameType)
         Cllc_statistics.fhNumPANConfigSent++;
 
     }
+    ApiMac_mlmeSetBatchEnd();
     ApiMac_mlmeWSAsyncReq(&asyncReq);
 }
 
@@ -49,6 +49,7 @@
 *****************************************************************************/
 
 #include "Utils/uart_term.h"
+#include "Utils/latency.h"
 #include "pthread.h"
 #include "mqueue.h"
 #include "Common/commonDefs.h"
@@ -56,6 +57,7 @@
 #include "API_MAC/api_mac.h"
 #include "config.h"
 #include "appHandler.h"
+#include "sensorFields.h"
 
 
 #define EMBEDDED_GATEWAY
@@ -294,7 +296,6 @@ void appsrv_deviceSensorDataUpdate(ApiMac_sAddr_t *pSrcAddr, int8_t rssi,
                                    Smsgs_sensorMsg_t *pSensorMsg)
 {
     dev_t *pDev;
-    uint16_t objIdx = 0;
     pDev = (dev_t*) malloc(sizeof(dev_t));
 
     if(pSrcAddr->addrMode == ApiMac_addrType_short)
@@ -308,118 +309,14 @@ void appsrv_deviceSensorDataUpdate(ApiMac_sAddr_t *pSrcAddr, int8_t rssi,
     }
     memcpy(pDev->extAddr, pSensorMsg->extAddress, APIMAC_SADDR_EXT_LEN);
     pDev->rssi = (signed int) rssi;
-    pDev->object[0].typeId = LIGHT_TYPE_ID;//light type
-    pDev->object[0].sensorVal = 0.0;
-    pDev->object[0].unit[0] = '\0';
-    pDev->object[0].type[0] = '\0';
-    pDev->objectCount = 0;
+    pDev->objectCount = SensorFields_getObjects(pSensorMsg, pDev->object,
+                                                MAX_NUM_OF_OBJECTS);
     pDev->active = true;
 
-    if(pSensorMsg->frameControl & Smsgs_dataFields_tempSensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = TEMP_TYPE_ID;//temp type
-        pDev->object[objIdx].sensorVal = (pSensorMsg->tempSensor.ambienceTemp);
-        strcpy(pDev->object[objIdx].unit, "C");
-        strcpy(pDev->object[objIdx].type, TEMP_TYPE);
-    }
-    if(pSensorMsg->frameControl & Smsgs_dataFields_lightSensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = LIGHT_TYPE_ID;//light type
-        pDev->object[objIdx].sensorVal = (pSensorMsg->lightSensor.rawData);
-        strcpy(pDev->object[objIdx].unit, "Lumen");
-        strcpy(pDev->object[objIdx].type, LIGHT_TYPE);
-    }
-
-    if(pSensorMsg->frameControl & Smsgs_dataFields_humiditySensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = HUM_TYPE_ID;//hum type
-        pDev->object[objIdx].sensorVal = (pSensorMsg->humiditySensor.humidity);
-        strcpy(pDev->object[objIdx].unit,"%");
-        strcpy(pDev->object[objIdx].type, HUM_TYPE);
-    }
-
-    if(pSensorMsg->frameControl & Smsgs_dataFields_pressureSensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = GEN_SENSOR_TYPE_ID;
-        pDev->object[objIdx].sensorVal = (pSensorMsg->pressureSensor.pressureValue);
-        strcpy(pDev->object[objIdx].unit,"P");
-        strcpy(pDev->object[objIdx].type, PRESS_TYPE);
-
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = TEMP_TYPE_ID;
-        pDev->object[objIdx].sensorVal = (pSensorMsg->pressureSensor.tempValue);
-        strcpy(pDev->object[objIdx].unit,"C");
-        strcpy(pDev->object[objIdx].type, TEMP_TYPE);
-    }
-
-    if(pSensorMsg->frameControl & Smsgs_dataFields_motionSensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = PRESENSE_TYPE_ID;
-        pDev->object[objIdx].sensorVal = (int)(pSensorMsg->motionSensor.isMotion);
-        strcpy(pDev->object[objIdx].unit, "-");
-        strcpy(pDev->object[objIdx].type, MOTION_TYPE);
-    }
-
-    if(pSensorMsg->frameControl & Smsgs_dataFields_batterySensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = GEN_SENSOR_TYPE_ID;
-        pDev->object[objIdx].sensorVal = (pSensorMsg->batterySensor.voltageValue);
-        strcpy(pDev->object[objIdx].unit, "V");
-        strcpy(pDev->object[objIdx].type, VOLTAGE_TYPE);
-    }
-
-    if(pSensorMsg->frameControl & Smsgs_dataFields_hallEffectSensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = GEN_SENSOR_TYPE_ID;
-        pDev->object[objIdx].sensorVal = (pSensorMsg->hallEffectSensor.isOpen);
-        strcpy(pDev->object[objIdx].unit,"-");
-        strcpy(pDev->object[objIdx].type, HALL_OPEN_TYPE);
-
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = GEN_SENSOR_TYPE_ID;
-        pDev->object[objIdx].sensorVal = (pSensorMsg->hallEffectSensor.isTampered);
-        strcpy(pDev->object[objIdx].unit,"-");
-        strcpy(pDev->object[objIdx].type, HALL_TMPR_TYPE);
-    }
-
-    if(pSensorMsg->frameControl & Smsgs_dataFields_fanSensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = ACTUATOR_TYPE_ID;
-        pDev->object[objIdx].sensorVal = (pSensorMsg->fanSensor.fanSpeed);
-        strcpy(pDev->object[objIdx].unit,"%");
-        strcpy(pDev->object[objIdx].type, FAN_TYPE);
-    }
-
-    if(pSensorMsg->frameControl & Smsgs_dataFields_doorLockSensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = ACTUATOR_TYPE_ID;
-        pDev->object[objIdx].sensorVal = (pSensorMsg->doorLockSensor.isLocked);
-        strcpy(pDev->object[objIdx].unit, "-");
-        strcpy(pDev->object[objIdx].type, DOOR_LOCK_TYPE);
-    }
-
-    if(pSensorMsg->frameControl & Smsgs_dataFields_waterleakSensor)
-    {
-        objIdx = pDev->objectCount++;
-        pDev->object[objIdx].typeId = GEN_SENSOR_TYPE_ID;
-        pDev->object[objIdx].sensorVal = (int)(pSensorMsg->waterleakSensor.status);
-        strcpy(pDev->object[objIdx].unit, "Status");
-        strcpy(pDev->object[objIdx].type, WATR_LEAK_TYPE);
-    }
-
-
     msgQueue_t queueElement;
     queueElement.event = GatewayEvent_SENSOR_DATA_UPDATE;
     queueElement.msgPtr = pDev;
+    queueElement.timestamp = Latency_stamp();
     mq_send(*appHCliMq, (char*) &queueElement, sizeof(msgQueue_t), 0);
 }
 
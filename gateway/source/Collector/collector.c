@@ -54,15 +54,19 @@
 #include <Common/commonDefs.h>
 
 #include <Utils/uart_term.h>
+#include <Utils/latency.h>
+#include <Utils/metrics.h>
 #include <NPI/npiParse.h>
 #include <NPIcmds/mtSys.h>
 #include <API_MAC/api_mac.h>
+#include <Gateway/oadServer.h>
 #include "config.h"
 #include "LinkController/llc.h"
 #include "LinkController/cllc.h"
 #include "smsgs.h"
 #include "csf.h"
 #include "appHandler.h"
+#include "sensorFields.h"
 #include "collector.h"
 
 
@@ -99,6 +103,14 @@
 /* App Config request marker for the MSDU handle */
 #define APP_CONFIG_MSDU_HANDLE 0x40
 
+/* MSDU handle of a held frame, ORed with the index of the device's queue.
+   No other frame has the config marker without the App marker */
+#define HELD_MSDU_HANDLE APP_CONFIG_MSDU_HANDLE
+
+#if CONFIG_MAX_DEVICES > (MSDU_HANDLE_MAX + 1)
+#error "CONFIG_MAX_DEVICES too large for the MSDU handles of held frames"
+#endif
+
 /* Default configuration frame control */
 #define CONFIG_FRAME_CONTROL (Smsgs_dataFields_tempSensor | \
                               Smsgs_dataFields_lightSensor | \
@@ -111,7 +123,9 @@
                               Smsgs_dataFields_hallEffectSensor | \
                               Smsgs_dataFields_fanSensor | \
                               Smsgs_dataFields_doorLockSensor | \
-                              Smsgs_dataFields_waterleakSensor)
+                              Smsgs_dataFields_waterleakSensor | \
+                              Smsgs_dataFields_energyStats | \
+                              Smsgs_dataFields_latencyTrace)
 
 /* Default configuration reporting interval, in milliseconds */
 #define CONFIG_REPORTING_INTERVAL 90000
@@ -134,6 +148,68 @@
 #define ASSOC_TRACKING_RETRY    0x4000    /* Tracking Req retried */
 #define ASSOC_TRACKING_ERROR    0x8000    /* Tracking Req error */
 #define ASSOC_TRACKING_MASK     0xF000    /* Tracking mask  */
+
+/* Over-the-air length of the config requests sent by this collector */
+#if CONFIG_FAST_POLLING_INTERVAL > 0
+#define CONFIG_REQUEST_MSG_LENGTH SMSGS_CONFIG_REQUEST_FAST_POLL_MSG_LENGTH
+#else
+#define CONFIG_REQUEST_MSG_LENGTH SMSGS_CONFIG_REQUEST_MSG_LENGTH
+#endif
+
+/* Number of 16 bit values in the message statistics field */
+#define COMPACT_NUM_STATS (sizeof(Smsgs_msgStatsField_t) / sizeof(uint16_t))
+
+/* Time to wait for group command responses after the last response slot or
+   poll, in milliseconds */
+#define GROUP_ACK_MARGIN 500
+
+/* Longest Group Command Request */
+#define GROUP_CMD_MAX_LEN (SMSGS_GROUP_CMD_REQUEST_HDR_LEN + \
+                           SMSGS_GROUP_CMD_MAX_MASK_LEN + \
+                           SMSGS_GROUP_CMD_MAX_CMD_LEN)
+
+/* Frames held on the host for each sleepy device, see sendMsg() */
+#define INDIRECT_QUEUE_LEN 4
+/* Longest frame held, longer ones go straight to the co-processor */
+#define INDIRECT_MAX_LEN 24
+
+/* Time for the devices to get ready for an OAD image before its first
+   block, in milliseconds */
+#define OAD_PREPARE_TIME 5000
+/* Time to wait for OAD status responses after the last response slot or
+   poll, in milliseconds */
+#define OAD_STATUS_MARGIN 500
+/* Repair rounds before the devices still missing blocks are given up on */
+#define OAD_MAX_ROUNDS 8
+/* Bytes of the map of the blocks of an OAD image still to be sent */
+#define OAD_BLOCK_MAP_LEN \
+    (((OADSERVER_MAX_IMAGE_LEN / SMSGS_OAD_BLOCK_SIZE) + 7) / 8)
+/* OAD status of a device that hasn't answered */
+#define OAD_STATUS_UNKNOWN 0xFF
+
+/* Time between checks of the channel load, in milliseconds */
+#define LOAD_CHECK_INTERVAL (CONFIG_REPORTING_INTERVAL * 3)
+/* Share of the time the sensors may transmit for, in 1/1000 */
+#define LOAD_UTIL_TARGET 150
+/* Failed data requests per report attempted above which the channel is
+   congested, in 1/1000 */
+#define LOAD_FAIL_HIGH 250
+/* Failed data requests per report attempted below which the reporting
+   interval is brought back down, in 1/1000 */
+#define LOAD_FAIL_LOW 50
+/* Fewest reports attempted in a check for the failure rate to count */
+#define LOAD_MIN_ATTEMPTS 10
+/* Longest reporting interval, the most the sensors accept, in milliseconds */
+#define LOAD_MAX_INTERVAL 360000
+/* Step the reporting interval is brought back down by, in milliseconds */
+#define LOAD_INTERVAL_STEP (CONFIG_REPORTING_INTERVAL / 2)
+/* Reports lost by a device above which it backs off further than the rest
+   of the network, in 1/1000 */
+#define LOAD_DEVICE_LOSS_HIGH 200
+/* Fewest reports a device must attempt for its loss to count */
+#define LOAD_DEVICE_MIN_ATTEMPTS 4
+/* Most times a device's reporting interval is doubled beyond the network's */
+#define LOAD_MAX_DEVICE_BACKOFF 2
 /******************************************************************************
  Global variables
  *****************************************************************************/
@@ -166,6 +242,209 @@ STATIC uint8_t deviceTxMsduHandle = 0;
 
 STATIC bool fhEnabled = false;
 
+/*! Compact sensor data delta base of an associated device */
+typedef struct
+{
+    /*! Short address of the device the base belongs to */
+    uint16_t shortAddr;
+    /*! Report sequence number of the base */
+    uint8_t seq;
+    /*! Message statistics of the base */
+    uint16_t stats[COMPACT_NUM_STATS];
+} Collector_compactBase_t;
+
+/*! Compact delta bases, same index as Cllc_associatedDevList */
+STATIC Collector_compactBase_t compactBases[CONFIG_MAX_DEVICES];
+
+/*! A group of devices defined from the cloud */
+typedef struct
+{
+    /*! Group ID, 0 if the entry is free */
+    uint8_t groupId;
+    /*! Number of members */
+    uint8_t numMembers;
+    /*! Short addresses of the members */
+    uint16_t members[MAX_GROUP_MEMBERS];
+} Collector_group_t;
+
+/*! The group command waiting for responses */
+typedef struct
+{
+    /*! Group ID, 0 if no command is waiting */
+    uint8_t groupId;
+    /*! true once the members that didn't respond were sent it again */
+    bool retried;
+    /*! Number of members */
+    uint8_t numMembers;
+    /*! Number of members that responded */
+    uint8_t numAcked;
+    /*! Number of members that responded they didn't carry it out */
+    uint8_t numRefused;
+    /*! Short addresses of the members */
+    uint16_t members[CONFIG_MAX_DEVICES];
+    /*! true if the member responded */
+    bool acked[CONFIG_MAX_DEVICES];
+    /*! Time the command was sent, from Latency_stamp() */
+    uint32_t start;
+    /*! Length of the Group Command Request */
+    uint8_t frameLen;
+    /*! The Group Command Request */
+    uint8_t frame[GROUP_CMD_MAX_LEN];
+} Collector_groupCmd_t;
+
+/*! Groups defined from the cloud, in RAM only */
+STATIC Collector_group_t groups[MAX_NUM_OF_GROUPS];
+
+/*! The group command waiting for responses */
+STATIC Collector_groupCmd_t groupCmd;
+
+/*! Sequence number of the last Group Command Request */
+STATIC uint8_t groupCmdSeq = 0;
+
+/*! Priority of the frames held for a sleepy device, highest first */
+typedef enum
+{
+    /*! Commands from the user or the cloud */
+    Collector_txPri_actuation,
+    /*! Config Requests */
+    Collector_txPri_config,
+    /*! Tracking Requests */
+    Collector_txPri_tracking,
+    /*! OAD Image Notifies and Status Requests */
+    Collector_txPri_oad
+} Collector_txPri_t;
+
+/*! Frame held for a sleepy device */
+typedef struct
+{
+    /*! Length, 0 if the entry is free */
+    uint8_t len;
+    /*! Collector_txPri_t */
+    uint8_t pri;
+    /*! Order it was queued in, among the device's frames */
+    uint8_t order;
+    /*! Time it was first queued, from Latency_stamp() */
+    uint32_t stamp;
+    /*! The frame, Command ID first */
+    uint8_t data[INDIRECT_MAX_LEN];
+} Collector_heldFrame_t;
+
+/*! Frames held for a sleepy device until the co-processor has room */
+typedef struct
+{
+    /*! Short address of the device the queue belongs to */
+    uint16_t shortAddr;
+    /*! true while a frame to the device is in the co-processor */
+    bool inFlight;
+    /*! MSDU handle that frame would have had if not held, from
+        getMsduHandle() */
+    uint8_t msduHandle;
+    /*! Order number of the next frame queued */
+    uint8_t nextOrder;
+    /*! The held frames */
+    Collector_heldFrame_t frames[INDIRECT_QUEUE_LEN];
+} Collector_indirectQueue_t;
+
+/*! Indirect queues, same index as Cllc_associatedDevList */
+STATIC Collector_indirectQueue_t indirectQueues[CONFIG_MAX_DEVICES];
+
+/*! true from the co-processor refusing a frame until a data confirm */
+STATIC bool indirectFull = false;
+
+/*! Step of pushing an OAD image */
+typedef enum
+{
+    /*! No image is being pushed */
+    Collector_oadState_idle,
+    /*! Broadcasting the blocks of a round */
+    Collector_oadState_blocks,
+    /*! Waiting for the status responses after a round */
+    Collector_oadState_status
+} Collector_oadState_t;
+
+/*! The OAD image being pushed */
+typedef struct
+{
+    /*! Collector_oadState_t */
+    uint8_t state;
+    /*! Image Sequence */
+    uint8_t seq;
+    /*! Round being sent */
+    uint8_t round;
+    /*! Number of blocks */
+    uint16_t numBlocks;
+    /*! First block of the round not looked at yet */
+    uint16_t nextBlock;
+    /*! Time the push started, from Latency_stamp() */
+    uint32_t start;
+    /*! Image Header */
+    uint8_t hdr[SMSGS_OAD_IMG_HDR_LEN];
+    /*! Bit n set if block n is to be sent, by this round or the next */
+    uint8_t toSend[OAD_BLOCK_MAP_LEN];
+} Collector_oad_t;
+
+/*! OAD status of an associated device */
+typedef struct
+{
+    /*! Short address of the device the status belongs to */
+    uint16_t shortAddr;
+    /*! Smsgs_oadStatus_t of its last response, or OAD_STATUS_UNKNOWN */
+    uint8_t status;
+} Collector_oadDevice_t;
+
+/*! The OAD image being pushed */
+STATIC Collector_oad_t oad;
+
+/*! OAD status of the devices, same index as Cllc_associatedDevList */
+STATIC Collector_oadDevice_t oadDevices[CONFIG_MAX_DEVICES];
+
+/*! Channel load reported by the sensors since the last check */
+typedef struct
+{
+    /*! Reporting interval of the network, in milliseconds */
+    uint32_t reportingInterval;
+    /*! Time of the last check, from Latency_stamp() */
+    uint32_t start;
+    /*! Transmit time reported, in microseconds */
+    uint32_t txTime;
+    /*! Reports attempted */
+    uint32_t attempted;
+    /*! Channel access, MAC ACK and other data request failures */
+    uint32_t failures;
+} Collector_load_t;
+
+/*! Message statistics and reporting interval of an associated device */
+typedef struct
+{
+    /*! Short address of the device the entry belongs to */
+    uint16_t shortAddr;
+    /*! true once the counters below were reported */
+    bool statsValid;
+    /*! msgsAttempted last reported */
+    uint16_t msgsAttempted;
+    /*! msgsSent last reported */
+    uint16_t msgsSent;
+    /*! Sum of the data request failures last reported */
+    uint16_t failures;
+    /*! Reports attempted since the device's loss was last judged */
+    uint16_t attempted;
+    /*! Of those, reports sent */
+    uint16_t sent;
+    /*! Times the reporting interval is doubled beyond the network's */
+    uint8_t backoff;
+    /*! Reporting interval in its last Config Response, 0 if none */
+    uint32_t reportingInterval;
+} Collector_loadDevice_t;
+
+/*! Channel load since the last check */
+STATIC Collector_load_t load = {CONFIG_REPORTING_INTERVAL};
+
+/*! Load of the devices, same index as Cllc_associatedDevList */
+STATIC Collector_loadDevice_t loadDevices[CONFIG_MAX_DEVICES];
+
+/*! Time the NPI frame being processed was received from the CoP */
+static uint32_t npiRxStamp = LATENCY_NO_STAMP;
+
 Llc_netInfo_t coordInfo;
 
 /******************************************************************************
@@ -180,18 +459,35 @@ static ApiMac_assocStatus_t cllcDeviceJoiningCB(
                 ApiMac_capabilityInfo_t *pCapInfo);
 static void cllcStateChangedCB(Cllc_states_t state);
 static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf);
+static void processAppCnf(uint8_t msduHandle, ApiMac_status_t status);
 static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd);
 static void processStartEvent(void);
 static void processConfigResponse(ApiMac_mcpsDataInd_t *pDataInd);
 static void processTrackingResponse(ApiMac_mcpsDataInd_t *pDataInd);
 static void processToggleLedResponse(ApiMac_mcpsDataInd_t *pDataInd);
 static void processSensorData(ApiMac_mcpsDataInd_t *pDataInd);
+static void processSensorDataBatch(ApiMac_mcpsDataInd_t *pDataInd);
+static uint8_t *parseCompactSensorFields(uint8_t *pBuf, uint8_t *pEnd,
+                                         ApiMac_sAddr_t *pSrcAddr,
+                                         Smsgs_sensorMsg_t *pMsg);
+static uint8_t *parseVarint(uint8_t *pBuf, uint8_t *pEnd, uint32_t *pValue);
+static uint8_t *parseZigZag(uint8_t *pBuf, uint8_t *pEnd, int32_t *pValue);
+static uint8_t *parseByte(uint8_t *pBuf, uint8_t *pEnd, uint8_t *pValue);
 static Cllc_associated_devices_t *findDevice(ApiMac_sAddr_t *pAddr);
 static Cllc_associated_devices_t *findDeviceStatusBit(uint16_t mask, uint16_t statusBit);
 static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType);
 static bool sendMsg(Smsgs_cmdIds_t type, uint16_t dstShortAddr, bool rxOnIdle,
                     uint16_t len,
                     uint8_t *pData);
+static ApiMac_status_t sendDataReq(uint16_t dstShortAddr, bool rxOnIdle,
+                                   uint16_t len, uint8_t *pData,
+                                   uint8_t msduHandle);
+static bool queueIndirect(Cllc_associated_devices_t *pDev,
+                          Smsgs_cmdIds_t type, uint16_t len, uint8_t *pData);
+static bool supersedes(Smsgs_cmdIds_t type);
+static bool releaseIndirect(Collector_indirectQueue_t *pQueue,
+                            Collector_heldFrame_t *pNew);
+static uint8_t processIndirectCnf(uint8_t msduHandle);
 static void generateConfigRequests(void);
 static void generateTrackingRequests(void);
 static void sendTrackingRequest(Cllc_associated_devices_t *pDev);
@@ -199,6 +495,25 @@ static void commStatusIndCB(ApiMac_mlmeCommStatusInd_t *pCommStatusInd);
 static void pollIndCB(ApiMac_mlmePollInd_t *pPollInd);
 static void processDataRetry(ApiMac_sAddr_t *pAddr);
 static void processConfigRetry(void);
+static uint8_t buildDeviceCmd(deviceCmd_t *pCmd, uint8_t *pBuf);
+static void defineGroup(deviceCmd_t *pCmd);
+static void sendGroupCmd(deviceCmd_t *pCmd);
+static void processGroupCmdResponse(ApiMac_mcpsDataInd_t *pDataInd);
+static void processGroupTimeout(void);
+static void finishGroupCmd(void);
+static void startOad(OadServer_image_t *pImage);
+static void processOadEvt(void);
+static void sendOadNotify(void);
+static void sendOadStatusReq(void);
+static void processOadStatusResponse(ApiMac_mcpsDataInd_t *pDataInd);
+static void finishOad(void);
+static Collector_oadDevice_t *getOadDevice(Cllc_associated_devices_t *pDev);
+static void recordLoad(ApiMac_sAddr_t *pSrcAddr, Smsgs_sensorMsg_t *pMsg);
+static void processLoadEvt(void);
+static uint32_t getReportingInterval(Collector_loadDevice_t *pLoadDev);
+static Collector_loadDevice_t *getLoadDevice(Cllc_associated_devices_t *pDev);
+static ApiMac_status_t sendBroadcastMsg(Smsgs_cmdIds_t type, uint16_t len,
+                                        uint8_t *pData);
 
 /******************************************************************************
  Callback tables
@@ -298,9 +613,16 @@ void Collector_initCop(void)
 {
 //    /* Initialize the collector's statistics */
     memset(&Collector_statistics, 0, sizeof(Collector_statistics_t));
+
+    /* Nothing is in the co-processor any more, or for the devices it had */
+    memset(indirectQueues, 0, sizeof(indirectQueues));
+    indirectFull = false;
 //
 //    /* Initialize the MAC */
     ApiMac_init(CONFIG_FH_ENABLE);
+
+    /* The PIB settings below go to the co-processor in one frame */
+    ApiMac_mlmeSetBatchStart();
 //
 //    /* Initialize the Coordinator Logical Link Controller */
     Cllc_init(&Collector_macCallbacks, &cllcCallbacks);
@@ -316,6 +638,7 @@ void Collector_initCop(void)
                             INDIRECT_PERSISTENT_TIME);
     ApiMac_mlmeSetReqUint8(ApiMac_attribute_phyTransmitPowerSigned,
                            (uint8_t)CONFIG_TRANSMIT_POWER);
+    ApiMac_mlmeSetBatchEnd();
 //
 //    /* Initialize the app clocks */
     initializeClocks();
@@ -402,6 +725,33 @@ void Collector_process(void)
         /* Clear the event */
         Util_clearEvent(&Collector_events, COLLECTOR_CONFIG_EVT);
     }
+
+    /* Have the members of a group command had time to respond? */
+    if(Collector_events & COLLECTOR_GROUP_TIMEOUT_EVT)
+    {
+        processGroupTimeout();
+
+        /* Clear the event */
+        Util_clearEvent(&Collector_events, COLLECTOR_GROUP_TIMEOUT_EVT);
+    }
+
+    /* Send the next OAD block, or end the round */
+    if(Collector_events & COLLECTOR_OAD_EVT)
+    {
+        processOadEvt();
+
+        /* Clear the event */
+        Util_clearEvent(&Collector_events, COLLECTOR_OAD_EVT);
+    }
+
+    /* Adjust the reporting intervals to the channel load */
+    if(Collector_events & COLLECTOR_LOAD_EVT)
+    {
+        processLoadEvt();
+
+        /* Clear the event */
+        Util_clearEvent(&Collector_events, COLLECTOR_LOAD_EVT);
+    }
     /*
      Don't process ApiMac messages until all of the collector events
      are processed.
@@ -451,52 +801,32 @@ void * collectorThread(void *pvParameters)
             Collector_initCop();
             break;
         case CollectorEvent_PROCESS_NPI_CMD:
+            npiRxStamp = incomingMsg.timestamp;
             Mt_parseCmd(incomingMsg.msgPtr, incomingMsg.msgPtrLen);
+            npiRxStamp = LATENCY_NO_STAMP;
             break;
         case CollectorEvent_SEND_SNSR_CMD:
             //Collector_sendSnsrCmd();
             if(incomingMsg.msgPtr)
             {
                 deviceCmd_t *inCmd = (deviceCmd_t*)incomingMsg.msgPtr;
-                uint8_t *devMsgBuf;
-                uint8_t msgLen = 0;
-                switch(inCmd->cmdType)
+
+                if(inCmd->cmdType == CmdType_GROUP_DEFINE)
                 {
-                case CmdType_FAN_DATA:
-                    msgLen = SMSGS_SENSOR_FAN_LEN;
-                    devMsgBuf = (uint8_t*)malloc(msgLen);
-                    devMsgBuf[0] = Smsgs_cmdIds_fanSpeedChg;
-                    devMsgBuf[1] = (uint8_t)inCmd->data;
-                    break;
-                case CmdType_DOORLOCK_DATA:
-                    msgLen = SMSGS_SENSOR_DOORLOCK_LEN;
-                    devMsgBuf = (uint8_t*)malloc(msgLen);
-                    devMsgBuf[0] = Smsgs_cmdIds_doorlockChg;
-                    devMsgBuf[1] = (uint8_t)inCmd->data;
-                    break;
-                case CmdType_LED_DATA:
-                    msgLen = SMSGS_TOGGLE_LED_REQUEST_MSG_LEN;
-                    devMsgBuf = (uint8_t*)malloc(msgLen);
-                    devMsgBuf[0] = Smsgs_cmdIds_toggleLedReq;
-                    break;
-                case CmdType_LEAK_DATA:
-                    msgLen = SMSGS_BUZZER_CTRL_REQUEST_MSG_LEN;
-                    devMsgBuf = (uint8_t*)malloc(msgLen);
-                    devMsgBuf[0] = (uint8_t)Smsgs_cmdIds_buzzerCtrlReq;
-                    break;
-                default:
-                    msgLen = SMSGS_SENSOR_DOORLOCK_LEN;
-                    devMsgBuf = (uint8_t*)malloc(msgLen);
-                    devMsgBuf[0] = Smsgs_cmdIds_sensorData;
-                    devMsgBuf[1] = (uint8_t)inCmd->data;
-                    break;
+                    defineGroup(inCmd);
+                }
+                else if(inCmd->groupId != 0)
+                {
+                    sendGroupCmd(inCmd);
                 }
+                else
+                {
+                    uint8_t devMsgBuf[SMSGS_GROUP_CMD_MAX_CMD_LEN];
+                    uint8_t msgLen = buildDeviceCmd(inCmd, devMsgBuf);
 
-                sendMsg((Smsgs_cmdIds_t)devMsgBuf[0], inCmd->shortAddr,
-                                        false,
-                                        (msgLen),
-                                        devMsgBuf);
-                free(devMsgBuf);
+                    sendMsg((Smsgs_cmdIds_t)devMsgBuf[0], inCmd->shortAddr,
+                            false, msgLen, devMsgBuf);
+                }
             }
             break;
         case CollectorEvent_PERMIT_JOIN:
@@ -507,6 +837,9 @@ void * collectorThread(void *pvParameters)
             appsrv_stateChangeUpdate(permJoin);
         }
             break;
+        case CollectorEvent_OAD_IMAGE:
+            startOad((OadServer_image_t*)incomingMsg.msgPtr);
+            break;
         case COLLECTOR_PROCESS_EVT:
             Collector_process();
             break;
@@ -548,7 +881,7 @@ Collector_status_t Collector_sendConfigRequest(ApiMac_sAddr_t *pDstAddr,
         /* Is the device a known device? */
         //if(Csf_getDevice(pDstAddr, &item))
         {
-            uint8_t buffer[SMSGS_CONFIG_REQUEST_MSG_LENGTH];
+            uint8_t buffer[CONFIG_REQUEST_MSG_LENGTH];
             uint8_t *pBuf = buffer;
 
             /* Build the message */
@@ -562,11 +895,17 @@ Collector_status_t Collector_sendConfigRequest(ApiMac_sAddr_t *pDstAddr,
             *pBuf++ = Util_breakUint32(pollingInterval, 0);
             *pBuf++ = Util_breakUint32(pollingInterval, 1);
             *pBuf++ = Util_breakUint32(pollingInterval, 2);
-            *pBuf = Util_breakUint32(pollingInterval, 3);
+            *pBuf++ = Util_breakUint32(pollingInterval, 3);
+#if CONFIG_FAST_POLLING_INTERVAL > 0
+            *pBuf++ = Util_breakUint32(CONFIG_FAST_POLLING_INTERVAL, 0);
+            *pBuf++ = Util_breakUint32(CONFIG_FAST_POLLING_INTERVAL, 1);
+            *pBuf++ = Util_breakUint32(CONFIG_FAST_POLLING_INTERVAL, 2);
+            *pBuf = Util_breakUint32(CONFIG_FAST_POLLING_INTERVAL, 3);
+#endif
 
             if((sendMsg(Smsgs_cmdIds_configReq, pDstAddr->addr.shortAddr,
                         false,
-                        (SMSGS_CONFIG_REQUEST_MSG_LENGTH),
+                        (CONFIG_REQUEST_MSG_LENGTH),
                          buffer)) == true)
             {
                 status = Collector_status_success;
@@ -651,6 +990,9 @@ static void initializeClocks(void)
     /* Initialize the tracking clock */
     Csf_initializeTrackingClock();
     Csf_initializeConfigClock();
+    Csf_initializeGroupClock();
+    Csf_initializeOadClock();
+    Csf_initializeLoadClock();
 }
 
 /*!
@@ -674,6 +1016,10 @@ static void cllcStartedCB(Llc_netInfo_t *pStartedInfo)
 
     /* Start the tracking clock */
     Csf_setTrackingClock(TRACKING_DELAY_TIME);
+
+    /* Start checking the channel load */
+    load.start = Latency_stamp();
+    Csf_setLoadClock(LOAD_CHECK_INTERVAL);
 }
 
 /*!
@@ -705,7 +1051,7 @@ static ApiMac_assocStatus_t cllcDeviceJoiningCB(
         /* Send the Config Request */
         Collector_sendConfigRequest(
                         &pDstAddr, (CONFIG_FRAME_CONTROL),
-                        (CONFIG_REPORTING_INTERVAL),
+                        load.reportingInterval,
                         (CONFIG_POLLING_INTERVAL));
         appsrv_networkUpdate(false, &coordInfo);
         if(status==ApiMac_assocStatus_success)
@@ -754,6 +1100,8 @@ static void cllcStateChangedCB(Cllc_states_t state)
  */
 static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
 {
+    uint8_t msduHandle;
+
     /* Record statistics */
     if(pDataCnf->status == ApiMac_status_channelAccessFailure)
     {
@@ -780,18 +1128,34 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
         Collector_statistics.otherTxFailures++;
     }
 
+    /* The frame left the co-processor, so the next can go in */
+    msduHandle = processIndirectCnf(pDataCnf->msduHandle);
+
+    processAppCnf(msduHandle, pDataCnf->status);
+}
+
+/*!
+ * @brief      Process the confirm of a message from the app, from the
+ *             co-processor or for a held message that was dropped.
+ *
+ * @param      msduHandle - MSDU handle the message was sent with, or would
+ *                          have been if not held
+ * @param      status - status of the message
+ */
+static void processAppCnf(uint8_t msduHandle, ApiMac_status_t status)
+{
     /* Make sure the message came from the app */
-    if(pDataCnf->msduHandle & APP_MARKER_MSDU_HANDLE)
+    if(msduHandle & APP_MARKER_MSDU_HANDLE)
     {
         /* What message type was the original request? */
-        if(pDataCnf->msduHandle & APP_CONFIG_MSDU_HANDLE)
+        if(msduHandle & APP_CONFIG_MSDU_HANDLE)
         {
             /* Config Request */
             Cllc_associated_devices_t *pDev;
             pDev = findDeviceStatusBit(ASSOC_CONFIG_MASK, ASSOC_CONFIG_SENT);
             if(pDev != NULL)
             {
-                if(pDataCnf->status != ApiMac_status_success)
+                if(status != ApiMac_status_success)
                 {
                     /* Try to send again */
                     pDev->status &= ~ASSOC_CONFIG_SENT;
@@ -807,7 +1171,7 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
             }
 
             /* Update stats */
-            if(pDataCnf->status == ApiMac_status_success)
+            if(status == ApiMac_status_success)
             {
                 Collector_statistics.configReqRequestSent++;
             }
@@ -820,7 +1184,7 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
                                        ASSOC_TRACKING_SENT);
             if(pDev != NULL)
             {
-                if(pDataCnf->status == ApiMac_status_success)
+                if(status == ApiMac_status_success)
                 {
                     /* Make sure the retry is clear */
                     pDev->status &= ~ASSOC_TRACKING_RETRY;
@@ -847,7 +1211,7 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
             }
 
             /* Update stats */
-            if(pDataCnf->status == ApiMac_status_success)
+            if(status == ApiMac_status_success)
             {
                 Collector_statistics.trackingReqRequestSent++;
             }
@@ -892,6 +1256,9 @@ static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd)
             }
         }
 
+        Metrics_deviceRx(pDataInd->srcAddr.addr.shortAddr, pDataInd->rssi,
+                         pDataInd->mpduLinkQuality);
+
         switch(cmdId)
         {
             case Smsgs_cmdIds_configRsp:
@@ -910,6 +1277,15 @@ static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd)
             case Smsgs_cmdIds_sensorData:
                 processSensorData(pDataInd);
                 break;
+            case Smsgs_cmdIds_sensorDataBatch:
+                processSensorDataBatch(pDataInd);
+                break;
+            case Smsgs_cmdIds_groupCmdRsp:
+                processGroupCmdResponse(pDataInd);
+                break;
+            case Smsgs_cmdIds_oadStatusRsp:
+                processOadStatusResponse(pDataInd);
+                break;
 
 
 
@@ -1033,6 +1409,9 @@ static void processConfigResponse(ApiMac_mcpsDataInd_t *pDataInd)
             /* Clear the sent flag and set the response flag */
             pDev->status &= ~ASSOC_CONFIG_SENT;
             pDev->status |= ASSOC_CONFIG_RSP;
+
+            getLoadDevice(pDev)->reportingInterval =
+                configRsp.reportingInterval;
         }
 
         /* report the config response */
@@ -1110,6 +1489,9 @@ static void processSensorData(ApiMac_mcpsDataInd_t *pDataInd)
 {
     Smsgs_sensorMsg_t sensorData;
     uint8_t *pBuf = pDataInd->msdu.p;
+    uint32_t collectorStamp = Latency_stamp();
+
+    Latency_recordSince(Latency_stage_link, npiRxStamp);
 
     memset(&sensorData, 0, sizeof(Smsgs_sensorMsg_t));
 
@@ -1122,159 +1504,429 @@ static void processSensorData(ApiMac_mcpsDataInd_t *pDataInd)
     sensorData.frameControl = Util_buildUint16(pBuf[0], pBuf[1]);
     pBuf += 2;
 
-    if(sensorData.frameControl & Smsgs_dataFields_tempSensor)
+    if(sensorData.frameControl & Smsgs_dataFields_compactEncoding)
     {
-        sensorData.tempSensor.ambienceTemp = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
-        sensorData.tempSensor.objectTemp = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
+        pBuf = parseCompactSensorFields(pBuf,
+                                        (pDataInd->msdu.p + pDataInd->msdu.len),
+                                        &pDataInd->srcAddr, &sensorData);
+    }
+    else
+    {
+        pBuf = SensorFields_parse(pBuf,
+                                  (pDataInd->msdu.p + pDataInd->msdu.len),
+                                  sensorData.frameControl, &sensorData);
     }
+    if(pBuf == NULL)
+    {
+        /* Unknown version or truncated message, nothing to report */
+        processDataRetry(&(pDataInd->srcAddr));
+        return;
+    }
+
+    Collector_statistics.sensorMessagesReceived++;
 
-    if(sensorData.frameControl & Smsgs_dataFields_lightSensor)
+    if(sensorData.frameControl & Smsgs_dataFields_msgStats)
     {
-        sensorData.lightSensor.rawData = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
+        Metrics_deviceStats(pDataInd->srcAddr.addr.shortAddr,
+                            sensorData.msgStats.msgsAttempted,
+                            sensorData.msgStats.msgsSent);
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_humiditySensor)
+    recordLoad(&pDataInd->srcAddr, &sensorData);
+
+    if((sensorData.frameControl & Smsgs_dataFields_latencyTrace) &&
+       (sensorData.latencyTrace.radioDelay != 0))
     {
-        sensorData.humiditySensor.temp = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
-        sensorData.humiditySensor.humidity = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
+        Latency_record(Latency_stage_radio,
+                       sensorData.latencyTrace.radioDelay);
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_msgStats)
+    /* Report the sensor data */
+    Csf_deviceSensorDataUpdate(&pDataInd->srcAddr, pDataInd->rssi,
+                               &sensorData);
+    Latency_recordSince(Latency_stage_collector, collectorStamp);
+
+    processDataRetry(&(pDataInd->srcAddr));
+}
+
+/*!
+ * @brief      Parse the data fields of a compact Sensor Data message.
+ *             The compact encoding flag is removed from the frame control
+ *             field, as is the message statistics flag if the statistics
+ *             are relative to a report this collector doesn't have.
+ *
+ * @param      pBuf - pointer to the compact header after the frame control
+ * @param      pEnd - pointer to the byte after the message
+ * @param      pSrcAddr - address of the sending device
+ * @param      pMsg - pointer to the sensor message to fill in
+ *
+ * @return     pointer to the byte following the parsed fields,
+ *             NULL if the message couldn't be parsed.
+ */
+static uint8_t *parseCompactSensorFields(uint8_t *pBuf, uint8_t *pEnd,
+                                         ApiMac_sAddr_t *pSrcAddr,
+                                         Smsgs_sensorMsg_t *pMsg)
+{
+    Cllc_associated_devices_t *pDev;
+    Collector_compactBase_t *pBase = NULL;
+    uint16_t fields;
+    uint32_t value;
+    int32_t sValue;
+    uint8_t byte;
+    uint8_t seq;
+    uint8_t baseSeq;
+
+    if(((pBuf + SMSGS_COMPACT_HDR_LEN) > pEnd)
+       || (pBuf[0] != SMSGS_COMPACT_VERSION))
     {
-        sensorData.msgStats.joinAttempts = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.joinFails = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.msgsAttempted = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.msgsSent = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.trackingRequests = Util_buildUint16(pBuf[0],
-                                                                pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.trackingResponseAttempts = Util_buildUint16(
-                        pBuf[0],
-                        pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.trackingResponseSent = Util_buildUint16(pBuf[0],
-                                                                    pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.configRequests = Util_buildUint16(pBuf[0],
-                                                              pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.configResponseAttempts = Util_buildUint16(
-                        pBuf[0],
-                        pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.configResponseSent = Util_buildUint16(pBuf[0],
-                                                                  pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.channelAccessFailures = Util_buildUint16(pBuf[0],
-                                                                     pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.macAckFailures = Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.otherDataRequestFailures = Util_buildUint16(
-                        pBuf[0],
-                        pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.syncLossIndications = Util_buildUint16(pBuf[0],
-                                                                   pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.rxDecryptFailures = Util_buildUint16(pBuf[0],
-                                                                 pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.txEncryptFailures = Util_buildUint16(pBuf[0],
-                                                                 pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.resetCount = Util_buildUint16(pBuf[0],
-                                                          pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.lastResetReason = Util_buildUint16(pBuf[0],
-                                                               pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.joinTime = Util_buildUint16(pBuf[0],
-                                                        pBuf[1]);
-        pBuf += 2;
-        sensorData.msgStats.interimDelay = Util_buildUint16(pBuf[0],
-                                                            pBuf[1]);
-        pBuf += 2;
+        return (NULL);
     }
+    seq = pBuf[1];
+    baseSeq = pBuf[2];
+    pBuf += SMSGS_COMPACT_HDR_LEN;
+
+    pMsg->frameControl &= ~Smsgs_dataFields_compactEncoding;
+    fields = pMsg->frameControl;
 
-    if(sensorData.frameControl & Smsgs_dataFields_configSettings)
+    pDev = findDevice(pSrcAddr);
+    if(pDev != NULL)
     {
-        sensorData.configSettings.reportingInterval = Util_buildUint32(pBuf[0],
-                                                                       pBuf[1],
-                                                                       pBuf[2],
-                                                                       pBuf[3]);
-        pBuf += 4;
-        sensorData.configSettings.pollingInterval = Util_buildUint32(pBuf[0],
-                                                                     pBuf[1],
-                                                                     pBuf[2],
-                                                                     pBuf[3]);
-        pBuf += 4;
+        pBase = &compactBases[pDev - Cllc_associatedDevList];
+        if(pBase->shortAddr != pDev->shortAddr)
+        {
+            /* New device in this slot, forget the old base */
+            memset(pBase, 0, sizeof(Collector_compactBase_t));
+            pBase->shortAddr = pDev->shortAddr;
+        }
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_pressureSensor)
+    /* Parse data in order of frameControl mask, starting with LSB */
+    if(fields & Smsgs_dataFields_tempSensor)
     {
-        sensorData.pressureSensor.pressureValue = Util_buildUint32(pBuf[0],
-                                                                    pBuf[1],
-                                                                    pBuf[2],
-                                                                    pBuf[3]);
-        pBuf += 4;
-        sensorData.pressureSensor.tempValue =  Util_buildUint32(pBuf[0],
-                                                                pBuf[1],
-                                                                pBuf[2],
-                                                                pBuf[3]);
-        pBuf += 4;
+        pBuf = parseZigZag(pBuf, pEnd, &sValue);
+        pMsg->tempSensor.ambienceTemp = (int16_t)sValue;
+        pBuf = parseZigZag(pBuf, pEnd, &sValue);
+        pMsg->tempSensor.objectTemp = (int16_t)sValue;
+    }
+
+    if(fields & Smsgs_dataFields_lightSensor)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->lightSensor.rawData = (uint16_t)value;
+    }
+
+    if(fields & Smsgs_dataFields_humiditySensor)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->humiditySensor.temp = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->humiditySensor.humidity = (uint16_t)value;
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_motionSensor)
+    if(fields & Smsgs_dataFields_msgStats)
     {
-      sensorData.motionSensor.isMotion = *pBuf++;
+        uint16_t stats[COMPACT_NUM_STATS];
+        bool haveBase = (baseSeq == SMSGS_COMPACT_NO_BASE)
+                        || ((pBase != NULL) && (pBase->seq == baseSeq));
+        uint8_t numStats;
+        uint8_t i;
+
+        pBuf = parseByte(pBuf, pEnd, &numStats);
+        for(i = 0; (i < numStats) && (pBuf != NULL); i++)
+        {
+            /* Skip statistics this collector doesn't know about */
+            pBuf = parseZigZag(pBuf, pEnd, &sValue);
+            if(i < COMPACT_NUM_STATS)
+            {
+                stats[i] = (uint16_t)sValue;
+                if(baseSeq != SMSGS_COMPACT_NO_BASE)
+                {
+                    stats[i] += (haveBase == true) ? pBase->stats[i] : 0;
+                }
+            }
+        }
+        if(pBuf == NULL)
+        {
+            /* Truncated, keep the base for the next report */
+            return (NULL);
+        }
+        for(; i < COMPACT_NUM_STATS; i++)
+        {
+            stats[i] = 0;
+        }
+
+        if(haveBase == true)
+        {
+            memcpy(&pMsg->msgStats, stats, sizeof(Smsgs_msgStatsField_t));
+            if(pBase != NULL)
+            {
+                memcpy(pBase->stats, stats, sizeof(pBase->stats));
+                pBase->seq = seq;
+            }
+        }
+        else
+        {
+            /* Wait for the next absolute statistics */
+            pMsg->frameControl &= ~Smsgs_dataFields_msgStats;
+        }
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_batterySensor)
+    if(fields & Smsgs_dataFields_configSettings)
     {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->configSettings.reportingInterval = value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->configSettings.pollingInterval = value;
+    }
 
-      sensorData.batterySensor.voltageValue = Util_buildUint32(pBuf[0],
-                                                                     pBuf[1],
-                                                                     pBuf[2],
-                                                                     pBuf[3]);
-      pBuf +=4;
+    if(fields & Smsgs_dataFields_pressureSensor)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->pressureSensor.pressureValue = value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->pressureSensor.tempValue = value;
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_hallEffectSensor)
+    if(fields & Smsgs_dataFields_motionSensor)
     {
-      sensorData.hallEffectSensor.isOpen = *pBuf++;
-      sensorData.hallEffectSensor.isTampered = *pBuf++;
+        pBuf = parseByte(pBuf, pEnd, &byte);
+        pMsg->motionSensor.isMotion = byte;
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_fanSensor)
+    if(fields & Smsgs_dataFields_batterySensor)
     {
-      sensorData.fanSensor.fanSpeed = *pBuf++;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->batterySensor.voltageValue = value;
     }
 
-    if(sensorData.frameControl & Smsgs_dataFields_doorLockSensor)
+    if(fields & Smsgs_dataFields_hallEffectSensor)
     {
-      sensorData.doorLockSensor.isLocked = *pBuf++;
+        pBuf = parseByte(pBuf, pEnd, &byte);
+        pMsg->hallEffectSensor.isOpen = byte;
+        pBuf = parseByte(pBuf, pEnd, &byte);
+        pMsg->hallEffectSensor.isTampered = byte;
     }
-    if(sensorData.frameControl & Smsgs_dataFields_waterleakSensor)
+
+    if(fields & Smsgs_dataFields_fanSensor)
     {
-        sensorData.waterleakSensor.status =  Util_buildUint16(pBuf[0], pBuf[1]);
-        pBuf += 2;
+        pBuf = parseByte(pBuf, pEnd, &byte);
+        pMsg->fanSensor.fanSpeed = byte;
     }
 
-    Collector_statistics.sensorMessagesReceived++;
+    if(fields & Smsgs_dataFields_doorLockSensor)
+    {
+        pBuf = parseByte(pBuf, pEnd, &byte);
+        pMsg->doorLockSensor.isLocked = byte;
+    }
 
-    /* Report the sensor data */
-    Csf_deviceSensorDataUpdate(&pDataInd->srcAddr, pDataInd->rssi,
-                               &sensorData);
+    if(fields & Smsgs_dataFields_waterleakSensor)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->waterleakSensor.status = (uint16_t)value;
+    }
+
+    if(fields & Smsgs_dataFields_energyStats)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->energyStats.periodTime);
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->energyStats.txTime);
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->energyStats.rxTime);
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->energyStats.activeTime);
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.txFrames = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.retries = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.csmaBackoffs = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.polls = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->energyStats.scans = (uint16_t)value;
+    }
+
+    if(fields & Smsgs_dataFields_latencyTrace)
+    {
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->latencyTrace.traceId = (uint16_t)value;
+        pBuf = parseVarint(pBuf, pEnd, &pMsg->latencyTrace.timestamp);
+        pBuf = parseVarint(pBuf, pEnd, &value);
+        pMsg->latencyTrace.radioDelay = (uint16_t)value;
+    }
+
+    /* NULL if the message ran out */
+    return (pBuf);
+}
+
+/*!
+ * @brief      Parse a varint, 7 bits per byte starting with the least
+ *             significant bits.  Bit 7 is set in all but the last byte.
+ *
+ * @param      pBuf - pointer to the varint, NULL if the message already
+ *                    ran out
+ * @param      pEnd - pointer to the byte after the message
+ * @param      pValue - where to put the value
+ *
+ * @return     pointer to the byte following the varint,
+ *             NULL if the message ends before it does.
+ */
+static uint8_t *parseVarint(uint8_t *pBuf, uint8_t *pEnd, uint32_t *pValue)
+{
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    uint8_t i;
+
+    *pValue = 0;
+    if(pBuf == NULL)
+    {
+        return (NULL);
+    }
+
+    for(i = 0; i < SMSGS_VARINT_MAX_LEN; i++)
+    {
+        if(pBuf >= pEnd)
+        {
+            return (NULL);
+        }
+        value |= (uint32_t)(*pBuf & 0x7F) << shift;
+        shift += 7;
+        if((*pBuf++ & 0x80) == 0)
+        {
+            break;
+        }
+    }
+
+    *pValue = value;
+    return (pBuf);
+}
+
+/*!
+ * @brief      Parse a zig-zag encoded varint.
+ *
+ * @param      pBuf - pointer to the varint, NULL if the message already
+ *                    ran out
+ * @param      pEnd - pointer to the byte after the message
+ * @param      pValue - where to put the signed value
+ *
+ * @return     pointer to the byte following the varint,
+ *             NULL if the message ends before it does.
+ */
+static uint8_t *parseZigZag(uint8_t *pBuf, uint8_t *pEnd, int32_t *pValue)
+{
+    uint32_t value;
+
+    pBuf = parseVarint(pBuf, pEnd, &value);
+    *pValue = (int32_t)((value >> 1) ^ (~(value & 1) + 1));
+
+    return (pBuf);
+}
+
+/*!
+ * @brief      Parse a byte.
+ *
+ * @param      pBuf - pointer to the byte, NULL if the message already
+ *                    ran out
+ * @param      pEnd - pointer to the byte after the message
+ * @param      pValue - where to put the byte
+ *
+ * @return     pointer to the following byte,
+ *             NULL if the message ends before it.
+ */
+static uint8_t *parseByte(uint8_t *pBuf, uint8_t *pEnd, uint8_t *pValue)
+{
+    *pValue = 0;
+    if((pBuf == NULL) || (pBuf >= pEnd))
+    {
+        return (NULL);
+    }
+
+    *pValue = *pBuf++;
+    return (pBuf);
+}
+
+/*!
+ * @brief      Process the Sensor Data Batch message.  Each sample is
+ *             reported as its own sensor data message, oldest first, and
+ *             the report fields are only reported with the last sample.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processSensorDataBatch(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    Smsgs_sensorMsg_t sensorData;
+    uint8_t *pBuf = pDataInd->msdu.p;
+    uint8_t *pEnd = pDataInd->msdu.p + pDataInd->msdu.len;
+    uint16_t frameControl;
+    uint16_t sampleFields;
+    uint8_t numSamples;
+    uint8_t i;
+
+    /* Make sure the message has a complete header */
+    if(pDataInd->msdu.len < SMSGS_BASIC_SENSOR_BATCH_LEN)
+    {
+        return;
+    }
+
+    memset(&sensorData, 0, sizeof(Smsgs_sensorMsg_t));
+
+    /* Parse the message */
+    sensorData.cmdId = (Smsgs_cmdIds_t)*pBuf++;
+
+    memcpy(sensorData.extAddress, pBuf, SMGS_SENSOR_EXTADDR_LEN);
+    pBuf += SMGS_SENSOR_EXTADDR_LEN;
+
+    frameControl = Util_buildUint16(pBuf[0], pBuf[1]);
+    pBuf += 2;
+    sampleFields = frameControl & ~SMSGS_BATCH_REPORT_FIELDS;
+
+    numSamples = *pBuf++;
+
+    /* The report fields are sent once, ahead of the samples */
+    pBuf = SensorFields_parse(pBuf, pEnd,
+                              (frameControl & SMSGS_BATCH_REPORT_FIELDS),
+                              &sensorData);
+    if(pBuf == NULL)
+    {
+        /* Truncated message, nothing to report */
+        processDataRetry(&(pDataInd->srcAddr));
+        return;
+    }
+
+    sensorData.frameControl = frameControl;
+    recordLoad(&pDataInd->srcAddr, &sensorData);
+
+    if((frameControl & Smsgs_dataFields_latencyTrace) &&
+       (sensorData.latencyTrace.radioDelay != 0))
+    {
+        Latency_record(Latency_stage_radio,
+                       sensorData.latencyTrace.radioDelay);
+    }
+
+    for(i = 0; i < numSamples; i++)
+    {
+        if((pBuf + SMSGS_BATCH_SAMPLE_AGE_LEN) > pEnd)
+        {
+            /* Truncated message, drop the rest */
+            break;
+        }
+        sensorData.sampleAge = (uint32_t)Util_buildUint16(pBuf[0], pBuf[1])
+                               * SMSGS_BATCH_SAMPLE_AGE_RES;
+        pBuf += SMSGS_BATCH_SAMPLE_AGE_LEN;
+
+        pBuf = SensorFields_parse(pBuf, pEnd, sampleFields, &sensorData);
+        if(pBuf == NULL)
+        {
+            /* Truncated message, drop the rest */
+            break;
+        }
+
+        sensorData.frameControl = (i == (numSamples - 1)) ?
+                        frameControl : sampleFields;
+
+        Collector_statistics.sensorMessagesReceived++;
+
+        /* Report the sample */
+        Csf_deviceSensorDataUpdate(&pDataInd->srcAddr, pDataInd->rssi,
+                                   &sensorData);
+    }
 
     processDataRetry(&(pDataInd->srcAddr));
 }
@@ -1353,6 +2005,9 @@ static Cllc_associated_devices_t *findDeviceStatusBit(uint16_t mask, uint16_t st
  *             - The MSBit(7), when set means the the application sent the message
  *             - Bit 6, when set means that the app message is a config request
  *             - Bits 0-5, used as a message counter that rolls over.
+ *             <BR>
+ *             Held frames go out with HELD_MSDU_HANDLE instead, and this
+ *             handle is kept for their data confirm.
  *
  * @param      msgType - message command id needed
  *
@@ -1372,8 +2027,16 @@ static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType)
         deviceTxMsduHandle++;
     }
 
-    /* Add the App specific bit */
-    msduHandle |= APP_MARKER_MSDU_HANDLE;
+    /* Add the App specific bit, except to group commands and OAD frames:
+       their responses are followed instead of their confirms, which would
+       be taken for a tracking request's */
+    if((msgType != Smsgs_cmdIds_groupCmdReq) &&
+       (msgType != Smsgs_cmdIds_oadImgNotify) &&
+       (msgType != Smsgs_cmdIds_oadImgBlock) &&
+       (msgType != Smsgs_cmdIds_oadStatusReq))
+    {
+        msduHandle |= APP_MARKER_MSDU_HANDLE;
+    }
 
     /* Add the message type bit */
     if(msgType == Smsgs_cmdIds_configReq)
@@ -1385,7 +2048,15 @@ static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType)
 }
 
 /*!
- * @brief      Send MAC data request
+ * @brief      Send a message to a device.  Messages to a sleepy device are
+ *             held on the host, highest priority first, and given to the
+ *             co-processor one at a time, when the last one has left it;
+ *             a held message is replaced by a newer one that sets the same
+ *             thing, see supersedes().  A held message that is dropped
+ *             later is confirmed to the app with
+ *             ApiMac_status_transactionOverflow, as one dropped by the
+ *             co-processor would be, so ASSOC_CONFIG_SENT and
+ *             ASSOC_TRACKING_SENT are cleared and the requests retried.
  *
  * @param      type - message type
  * @param      dstShortAddr - destination short address
@@ -1393,13 +2064,49 @@ static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType)
  * @param      len - length of payload
  * @param      pData - pointer to the buffer
  *
- * @return  true if sent, false if not
+ * @return  true if sent or held, false if not.  The response timers the
+ *          callers start run while it is held, as they do while the
+ *          co-processor holds it for the device's next poll.
  */
 static bool sendMsg(Smsgs_cmdIds_t type, uint16_t dstShortAddr, bool rxOnIdle,
                     uint16_t len,
                     uint8_t *pData)
 {
-    ApiMac_mcpsDataReq_t dataReq;
+    if((rxOnIdle == false) && (len <= INDIRECT_MAX_LEN))
+    {
+        ApiMac_sAddr_t dstAddr;
+        Cllc_associated_devices_t *pDev;
+
+        dstAddr.addrMode = ApiMac_addrType_short;
+        dstAddr.addr.shortAddr = dstShortAddr;
+        pDev = findDevice(&dstAddr);
+        if(pDev != NULL)
+        {
+            return (queueIndirect(pDev, type, len, pData));
+        }
+    }
+
+    return (sendDataReq(dstShortAddr, rxOnIdle, len, pData,
+                        getMsduHandle(type)) == ApiMac_status_success);
+}
+
+/*!
+ * @brief      Send MAC data request
+ *
+ * @param      dstShortAddr - destination short address
+ * @param      rxOnIdle - true if not a sleepy device
+ * @param      len - length of payload
+ * @param      pData - pointer to the buffer
+ * @param      msduHandle - MSDU handle of the request
+ *
+ * @return  ApiMac_status_success if sent, otherwise the error,
+ *          ApiMac_status_transactionOverflow if the co-processor is full
+ */
+static ApiMac_status_t sendDataReq(uint16_t dstShortAddr, bool rxOnIdle,
+                                   uint16_t len, uint8_t *pData,
+                                   uint8_t msduHandle)
+{
+    ApiMac_mcpsDataReq_t dataReq;
 
     /* Fill the data request field */
     memset(&dataReq, 0, sizeof(ApiMac_mcpsDataReq_t));
@@ -1423,13 +2130,13 @@ static bool sendMsg(Smsgs_cmdIds_t type, uint16_t dstShortAddr, bool rxOnIdle,
         else
         {
             /* Can't send the message */
-            return (false);
+            return (ApiMac_status_invalidParameter);
         }
     }
 
     dataReq.dstPanId = devicePanId;
 
-    dataReq.msduHandle = getMsduHandle(type);
+    dataReq.msduHandle = msduHandle;
 
     dataReq.txOptions.ack = true;
     if(rxOnIdle == false)
@@ -1446,15 +2153,258 @@ static bool sendMsg(Smsgs_cmdIds_t type, uint16_t dstShortAddr, bool rxOnIdle,
 #endif /* FEATURE_MAC_SECURITY */
 
     /* Send the message */
-    if(ApiMac_mcpsDataReq(&dataReq) != ApiMac_status_success)
+    return (ApiMac_mcpsDataReq(&dataReq));
+}
+
+/*!
+ * @brief      Tell if a newer message of a type makes a held one of the same
+ *             type stale.  Only messages that set something do: Config and
+ *             Tracking Requests, and the actuations naming what they set in
+ *             the Command ID.  A LED toggle or buzzer request acts each time
+ *             it is received, group commands and OAD frames each have their
+ *             own response, and Smsgs_cmdIds_oad carries different requests
+ *             under one Command ID.
+ *
+ * @param      type - message type
+ *
+ * @return  true if a held message of the type is replaced
+ */
+static bool supersedes(Smsgs_cmdIds_t type)
+{
+    switch(type)
+    {
+        case Smsgs_cmdIds_configReq:
+        case Smsgs_cmdIds_trackingReq:
+        case Smsgs_cmdIds_fanSpeedChg:
+        case Smsgs_cmdIds_doorlockChg:
+            return (true);
+        default:
+            return (false);
+    }
+}
+
+/*!
+ * @brief      Hold a message for a sleepy device, replacing a held message it
+ *             makes stale, and give the co-processor the next one if it
+ *             has none for the device.
+ *
+ * @param      pDev - the device
+ * @param      type - message type
+ * @param      len - length of payload, INDIRECT_MAX_LEN at most
+ * @param      pData - pointer to the buffer, Command ID first
+ *
+ * @return  true if held, false if the queue is full of messages at least as
+ *          important or the co-processor refused it
+ */
+static bool queueIndirect(Cllc_associated_devices_t *pDev,
+                          Smsgs_cmdIds_t type, uint16_t len, uint8_t *pData)
+{
+    Collector_indirectQueue_t *pQueue;
+    Collector_heldFrame_t *pFrame = NULL;
+    Smsgs_cmdIds_t dropped = (Smsgs_cmdIds_t)0;
+    uint8_t pri;
+    int x;
+
+    pQueue = &indirectQueues[pDev - Cllc_associatedDevList];
+    if(pQueue->shortAddr != pDev->shortAddr)
+    {
+        /* Slot has a new device, anything held was for the old one */
+        memset(pQueue, 0, sizeof(Collector_indirectQueue_t));
+        pQueue->shortAddr = pDev->shortAddr;
+    }
+
+    if(type == Smsgs_cmdIds_configReq)
     {
-        /*  transaction overflow occurred */
-        return (false);
+        pri = Collector_txPri_config;
+    }
+    else if(type == Smsgs_cmdIds_trackingReq)
+    {
+        pri = Collector_txPri_tracking;
+    }
+    else if((type == Smsgs_cmdIds_oadImgNotify) ||
+            (type == Smsgs_cmdIds_oadStatusReq))
+    {
+        pri = Collector_txPri_oad;
     }
     else
     {
+        pri = Collector_txPri_actuation;
+    }
+
+    /* A newer message setting the same thing makes the held one stale */
+    for(x = 0; (x < INDIRECT_QUEUE_LEN) && supersedes(type); x++)
+    {
+        if((pQueue->frames[x].len != 0) && (pQueue->frames[x].data[0] == type))
+        {
+            pFrame = &pQueue->frames[x];
+            Metrics_increment(Metrics_counter_indirectSuperseded);
+            break;
+        }
+    }
+
+    if(pFrame == NULL)
+    {
+        for(x = 0; x < INDIRECT_QUEUE_LEN; x++)
+        {
+            if(pQueue->frames[x].len == 0)
+            {
+                pFrame = &pQueue->frames[x];
+                break;
+            }
+            /* Else remember the least important, and newest of those */
+            if((pQueue->frames[x].pri > pri) && ((pFrame == NULL)
+               || (pQueue->frames[x].pri > pFrame->pri)
+               || ((pQueue->frames[x].pri == pFrame->pri)
+                   && ((int8_t)(pQueue->frames[x].order - pFrame->order) > 0))))
+            {
+                pFrame = &pQueue->frames[x];
+            }
+        }
+
+        if(pFrame == NULL)
+        {
+            Metrics_increment(Metrics_counter_indirectDrops);
+            return (false);
+        }
+        if(pFrame->len != 0)
+        {
+            Metrics_increment(Metrics_counter_indirectDrops);
+            dropped = (Smsgs_cmdIds_t)pFrame->data[0];
+        }
+
+        pFrame->order = pQueue->nextOrder++;
+        pFrame->stamp = Latency_stamp();
+    }
+
+    /* Superseding keeps the place in the queue and the time queued */
+    pFrame->len = len;
+    pFrame->pri = pri;
+    memcpy(pFrame->data, pData, len);
+
+    if(dropped != 0)
+    {
+        processAppCnf(getMsduHandle(dropped),
+                      ApiMac_status_transactionOverflow);
+    }
+
+    if((pQueue->inFlight == false) && (indirectFull == false))
+    {
+        return (releaseIndirect(pQueue, pFrame));
+    }
+
+    return (true);
+}
+
+/*!
+ * @brief      Give the co-processor the most important message held for a
+ *             device, oldest first among equals.
+ *
+ * @param      pQueue - the device's queue, with nothing in the co-processor
+ * @param      pNew - frame just held, NULL if none
+ *
+ * @return  false if the co-processor refused pNew, which is then left to
+ *          the caller instead of confirmed to the app
+ */
+static bool releaseIndirect(Collector_indirectQueue_t *pQueue,
+                            Collector_heldFrame_t *pNew)
+{
+    Collector_heldFrame_t *pFrame = NULL;
+    ApiMac_status_t status;
+    int x;
+
+    for(x = 0; x < INDIRECT_QUEUE_LEN; x++)
+    {
+        if((pQueue->frames[x].len != 0) && ((pFrame == NULL)
+           || (pQueue->frames[x].pri < pFrame->pri)
+           || ((pQueue->frames[x].pri == pFrame->pri)
+               && ((int8_t)(pQueue->frames[x].order - pFrame->order) < 0))))
+        {
+            pFrame = &pQueue->frames[x];
+        }
+    }
+
+    if(pFrame == NULL)
+    {
+        return (true);
+    }
+
+    /* Held frames have a handle per device, so the data confirm tells
+       whose frame left the co-processor */
+    status = sendDataReq(pQueue->shortAddr, false, pFrame->len, pFrame->data,
+                         HELD_MSDU_HANDLE | (pQueue - indirectQueues));
+    if(status == ApiMac_status_transactionOverflow)
+    {
+        /* Keep it until a data confirm makes room */
+        indirectFull = true;
+        Metrics_increment(Metrics_counter_indirectOverflows);
         return (true);
     }
+
+    if(status == ApiMac_status_success)
+    {
+        pQueue->inFlight = true;
+        pQueue->msduHandle = getMsduHandle((Smsgs_cmdIds_t)pFrame->data[0]);
+        Metrics_record(Metrics_histogram_indirectWait,
+                       Latency_stamp() - pFrame->stamp);
+        pFrame->len = 0;
+    }
+    else
+    {
+        /* Refused, as it would have been if not held */
+        pFrame->len = 0;
+        if(pFrame == pNew)
+        {
+            return (false);
+        }
+        processAppCnf(getMsduHandle((Smsgs_cmdIds_t)pFrame->data[0]),
+                      status);
+    }
+
+    return (true);
+}
+
+/*!
+ * @brief      A message left the co-processor, give it the next one held
+ *             for the same device, then any held while it was full.
+ *
+ * @param      msduHandle - MSDU handle of the message
+ *
+ * @return  the MSDU handle the message would have had if not held
+ */
+static uint8_t processIndirectCnf(uint8_t msduHandle)
+{
+    int x;
+
+    if((msduHandle & (APP_MARKER_MSDU_HANDLE | HELD_MSDU_HANDLE)) ==
+       HELD_MSDU_HANDLE)
+    {
+        x = msduHandle & MSDU_HANDLE_MAX;
+        if((x < CONFIG_MAX_DEVICES) && indirectQueues[x].inFlight)
+        {
+            msduHandle = indirectQueues[x].msduHandle;
+            indirectQueues[x].inFlight = false;
+            if(indirectFull == false)
+            {
+                releaseIndirect(&indirectQueues[x], NULL);
+            }
+        }
+    }
+
+    if(indirectFull)
+    {
+        indirectFull = false;
+        for(x = 0; (x < CONFIG_MAX_DEVICES) && (indirectFull == false); x++)
+        {
+            if((indirectQueues[x].shortAddr ==
+                Cllc_associatedDevList[x].shortAddr)
+               && (indirectQueues[x].inFlight == false))
+            {
+                releaseIndirect(&indirectQueues[x], NULL);
+            }
+        }
+    }
+
+    return (msduHandle);
 }
 
 /*!
@@ -1516,7 +2466,8 @@ static void generateConfigRequests(void)
                     /* Send the Config Request */
                     stat = Collector_sendConfigRequest(
                                     &dstAddr, (CONFIG_FRAME_CONTROL),
-                                    (CONFIG_REPORTING_INTERVAL),
+                                    getReportingInterval(getLoadDevice(
+                                        &Cllc_associatedDevList[x])),
                                     (CONFIG_POLLING_INTERVAL));
                     if(stat == Collector_status_success)
                     {
@@ -1806,3 +2757,1054 @@ static void processConfigRetry(void)
         Csf_setConfigClock(CONFIG_DELAY);
     }
 }
+
+/*!
+ * @brief      Build the message a command from the cloud is sent to a device
+ *             as.
+ *
+ * @param      pCmd - the command
+ * @param      pBuf - buffer of SMSGS_GROUP_CMD_MAX_CMD_LEN bytes for the
+ *                    message
+ *
+ * @return     length of the message
+ */
+static uint8_t buildDeviceCmd(deviceCmd_t *pCmd, uint8_t *pBuf)
+{
+    uint8_t msgLen;
+
+    switch(pCmd->cmdType)
+    {
+    case CmdType_FAN_DATA:
+        pBuf[0] = (uint8_t)Smsgs_cmdIds_fanSpeedChg;
+        pBuf[1] = (uint8_t)pCmd->data;
+        msgLen = 1 + SMSGS_SENSOR_FAN_LEN;
+        break;
+    case CmdType_DOORLOCK_DATA:
+        pBuf[0] = (uint8_t)Smsgs_cmdIds_doorlockChg;
+        pBuf[1] = (uint8_t)pCmd->data;
+        msgLen = 1 + SMSGS_SENSOR_DOORLOCK_LEN;
+        break;
+    case CmdType_LED_DATA:
+        pBuf[0] = (uint8_t)Smsgs_cmdIds_toggleLedReq;
+        msgLen = SMSGS_TOGGLE_LED_REQUEST_MSG_LEN;
+        break;
+    case CmdType_LEAK_DATA:
+        pBuf[0] = (uint8_t)Smsgs_cmdIds_buzzerCtrlReq;
+        msgLen = SMSGS_BUZZER_CTRL_REQUEST_MSG_LEN;
+        break;
+    default:
+        pBuf[0] = (uint8_t)Smsgs_cmdIds_sensorData;
+        pBuf[1] = (uint8_t)pCmd->data;
+        msgLen = 1 + SMSGS_SENSOR_DOORLOCK_LEN;
+        break;
+    }
+
+    return (msgLen);
+}
+
+/*!
+ * @brief      Define, redefine or, with no members, delete a group.
+ *
+ * @param      pCmd - CmdType_GROUP_DEFINE command
+ */
+static void defineGroup(deviceCmd_t *pCmd)
+{
+    Collector_group_t *pGroup = NULL;
+    uint16_t lowest = 0xFFFF;
+    uint16_t highest = 0;
+    int x;
+
+    for(x = 0; x < pCmd->numMembers; x++)
+    {
+        if(pCmd->members[x] < lowest)
+        {
+            lowest = pCmd->members[x];
+        }
+        if(pCmd->members[x] > highest)
+        {
+            highest = pCmd->members[x];
+        }
+    }
+
+    /* The members have to fit the Member Mask of one request */
+    if((pCmd->numMembers > 0) && ((highest - (lowest & ~0x0007)) >=
+                                  (SMSGS_GROUP_CMD_MAX_MASK_LEN * 8)))
+    {
+        UART_PRINT("[Collector] Group %d not defined, members 0x%04x to "
+                   "0x%04x are too far apart\n\r", pCmd->groupId, lowest,
+                   highest);
+        return;
+    }
+
+    for(x = 0; x < MAX_NUM_OF_GROUPS; x++)
+    {
+        if(groups[x].groupId == pCmd->groupId)
+        {
+            pGroup = &groups[x];
+            break;
+        }
+        if((groups[x].groupId == 0) && (pGroup == NULL))
+        {
+            pGroup = &groups[x];
+        }
+    }
+    if(pGroup == NULL)
+    {
+        UART_PRINT("[Collector] Group %d not defined, %d groups already\n\r",
+                   pCmd->groupId, MAX_NUM_OF_GROUPS);
+        return;
+    }
+
+    pGroup->groupId = (pCmd->numMembers > 0) ? pCmd->groupId : 0;
+    pGroup->numMembers = 0;
+    for(x = 0; x < pCmd->numMembers; x++)
+    {
+        int y;
+
+        /* Skip the members listed twice */
+        for(y = 0; y < pGroup->numMembers; y++)
+        {
+            if(pGroup->members[y] == pCmd->members[x])
+            {
+                break;
+            }
+        }
+        if(y == pGroup->numMembers)
+        {
+            pGroup->members[pGroup->numMembers++] = pCmd->members[x];
+        }
+    }
+}
+
+/*!
+ * @brief      Send a command to the members of a group in one Group Command
+ *             Request: broadcast once for the members with the receiver on,
+ *             and queued for each sleepy member.  The responses are followed
+ *             until they are all in or COLLECTOR_GROUP_TIMEOUT_EVT.
+ *
+ * @param      pCmd - command with the group ID
+ */
+static void sendGroupCmd(deviceCmd_t *pCmd)
+{
+    uint8_t *pBuf;
+    uint16_t base = 0xFFFF;
+    uint16_t highest = 0;
+    uint16_t numSlots;
+    uint8_t maskLen = 0;
+    bool rxOnMembers = false;
+    bool sleepyMembers = false;
+    uint32_t timeout;
+    int x;
+
+    if(cllcState < Cllc_states_started)
+    {
+        return;
+    }
+
+    /* One group command is followed at a time */
+    if(groupCmd.groupId != 0)
+    {
+        finishGroupCmd();
+    }
+    memset(&groupCmd, 0, sizeof(groupCmd));
+
+    if(pCmd->groupId == GROUP_ID_ALL)
+    {
+        for(x = 0; x < CONFIG_MAX_DEVICES; x++)
+        {
+            if(Cllc_associatedDevList[x].shortAddr != INVALID_SHORT_ADDR)
+            {
+                groupCmd.members[groupCmd.numMembers++] =
+                    Cllc_associatedDevList[x].shortAddr;
+            }
+        }
+    }
+    else
+    {
+        for(x = 0; x < MAX_NUM_OF_GROUPS; x++)
+        {
+            if(groups[x].groupId == pCmd->groupId)
+            {
+                memcpy(groupCmd.members, groups[x].members,
+                       groups[x].numMembers * sizeof(uint16_t));
+                groupCmd.numMembers = groups[x].numMembers;
+                break;
+            }
+        }
+    }
+    if(groupCmd.numMembers == 0)
+    {
+        UART_PRINT("[Collector] Group %d has no members\n\r", pCmd->groupId);
+        return;
+    }
+
+    for(x = 0; x < groupCmd.numMembers; x++)
+    {
+        if(groupCmd.members[x] < base)
+        {
+            base = groupCmd.members[x];
+        }
+        if(groupCmd.members[x] > highest)
+        {
+            highest = groupCmd.members[x];
+        }
+    }
+
+    /* Send a Member Mask, also for every device, so the members take one
+       slot each in the order of the device list whatever the gaps between
+       their short addresses.  A span too wide for it has no mask, and the
+       devices a mask length apart share a slot */
+    if((pCmd->groupId == GROUP_ID_ALL) &&
+       ((highest - (base & ~0x0007)) >= (SMSGS_GROUP_CMD_MAX_MASK_LEN * 8)))
+    {
+        numSlots = SMSGS_GROUP_CMD_MAX_MASK_LEN * 8;
+    }
+    else
+    {
+        base &= ~0x0007;
+        maskLen = ((highest - base) / 8) + 1;
+        numSlots = groupCmd.numMembers;
+    }
+
+    /* Build the request, the same for every member */
+    if(groupCmdSeq == 0)
+    {
+        /* Don't start where the members may remember the last one from */
+        groupCmdSeq = ApiMac_randomByte();
+    }
+    pBuf = groupCmd.frame;
+    *pBuf++ = (uint8_t)Smsgs_cmdIds_groupCmdReq;
+    *pBuf++ = ++groupCmdSeq;
+    *pBuf++ = Util_loUint16(base);
+    *pBuf++ = Util_hiUint16(base);
+    *pBuf++ = maskLen;
+    memset(pBuf, 0, maskLen);
+    if(maskLen > 0)
+    {
+        for(x = 0; x < groupCmd.numMembers; x++)
+        {
+            uint16_t bit = groupCmd.members[x] - base;
+
+            pBuf[bit / 8] |= (uint8_t)(1 << (bit % 8));
+        }
+    }
+    pBuf += maskLen;
+    pBuf += buildDeviceCmd(pCmd, pBuf);
+    groupCmd.frameLen = (uint8_t)(pBuf - groupCmd.frame);
+
+    /* Queue it for the sleepy members, they answer when they poll */
+    for(x = 0; x < groupCmd.numMembers; x++)
+    {
+        ApiMac_sAddr_t dstAddr;
+        Cllc_associated_devices_t *pDev;
+
+        dstAddr.addrMode = ApiMac_addrType_short;
+        dstAddr.addr.shortAddr = groupCmd.members[x];
+        pDev = findDevice(&dstAddr);
+        if(pDev == NULL)
+        {
+            /* Not associated, it is reported as not responding */
+            continue;
+        }
+
+        if(pDev->capInfo.rxOnWhenIdle)
+        {
+            rxOnMembers = true;
+        }
+        else
+        {
+            sendMsg(Smsgs_cmdIds_groupCmdReq, groupCmd.members[x], false,
+                    groupCmd.frameLen, groupCmd.frame);
+            sleepyMembers = true;
+        }
+    }
+    if(rxOnMembers)
+    {
+        sendBroadcastMsg(Smsgs_cmdIds_groupCmdReq, groupCmd.frameLen,
+                         groupCmd.frame);
+    }
+
+    timeout = GROUP_ACK_MARGIN;
+    if(rxOnMembers)
+    {
+        timeout += (uint32_t)numSlots * SMSGS_GROUP_CMD_ACK_SLOT;
+    }
+    if(sleepyMembers &&
+       (timeout < (CONFIG_POLLING_INTERVAL + GROUP_ACK_MARGIN)))
+    {
+        timeout = CONFIG_POLLING_INTERVAL + GROUP_ACK_MARGIN;
+    }
+
+    groupCmd.groupId = pCmd->groupId;
+    groupCmd.start = Latency_stamp();
+    Metrics_increment(Metrics_counter_groupCmds);
+    Csf_setGroupClock(timeout);
+}
+
+/*!
+ * @brief      Process the Group Command Response message.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processGroupCmdResponse(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    uint8_t *pBuf = pDataInd->msdu.p;
+    int x;
+
+    /* Make sure it answers the command being followed */
+    if((pDataInd->msdu.len != SMSGS_GROUP_CMD_RESPONSE_MSG_LEN) ||
+       (groupCmd.groupId == 0) || (pBuf[1] != groupCmd.frame[1]))
+    {
+        return;
+    }
+
+    for(x = 0; x < groupCmd.numMembers; x++)
+    {
+        if((groupCmd.members[x] == pDataInd->srcAddr.addr.shortAddr) &&
+           (groupCmd.acked[x] == false))
+        {
+            groupCmd.acked[x] = true;
+            groupCmd.numAcked++;
+            if(pBuf[2] != Smsgs_statusValues_success)
+            {
+                groupCmd.numRefused++;
+            }
+            Metrics_increment(Metrics_counter_groupAcks);
+            break;
+        }
+    }
+
+    if(groupCmd.numAcked == groupCmd.numMembers)
+    {
+        finishGroupCmd();
+    }
+}
+
+/*!
+ * @brief      The members of a group command had time to respond: send it
+ *             again to the ones that didn't, on their own, or give up on
+ *             them if that was done already.
+ */
+static void processGroupTimeout(void)
+{
+    bool sent = false;
+    bool sleepyMembers = false;
+    int x;
+
+    if(groupCmd.groupId == 0)
+    {
+        return;
+    }
+
+    if(groupCmd.retried == false)
+    {
+        groupCmd.retried = true;
+        for(x = 0; x < groupCmd.numMembers; x++)
+        {
+            ApiMac_sAddr_t dstAddr;
+            Cllc_associated_devices_t *pDev;
+
+            if(groupCmd.acked[x])
+            {
+                continue;
+            }
+
+            dstAddr.addrMode = ApiMac_addrType_short;
+            dstAddr.addr.shortAddr = groupCmd.members[x];
+            pDev = findDevice(&dstAddr);
+            if((pDev != NULL) &&
+               sendMsg(Smsgs_cmdIds_groupCmdReq, groupCmd.members[x],
+                       pDev->capInfo.rxOnWhenIdle, groupCmd.frameLen,
+                       groupCmd.frame))
+            {
+                sent = true;
+                if(pDev->capInfo.rxOnWhenIdle == false)
+                {
+                    sleepyMembers = true;
+                }
+                Metrics_increment(Metrics_counter_groupRetries);
+            }
+        }
+
+        if(sent)
+        {
+            Csf_setGroupClock(sleepyMembers ?
+                              (CONFIG_POLLING_INTERVAL + GROUP_ACK_MARGIN) :
+                              GROUP_ACK_MARGIN);
+            return;
+        }
+    }
+
+    finishGroupCmd();
+}
+
+/*!
+ * @brief      Stop following the group command and report which members
+ *             responded.
+ */
+static void finishGroupCmd(void)
+{
+    int x;
+
+    Csf_setGroupClock(0);
+    Metrics_record(Metrics_histogram_groupCmdDone,
+                   Latency_stamp() - groupCmd.start);
+
+    UART_PRINT("[Collector] Group %d command %d: %d of %d members done, "
+               "%d refused\n\r", groupCmd.groupId, groupCmd.frame[1],
+               groupCmd.numAcked - groupCmd.numRefused, groupCmd.numMembers,
+               groupCmd.numRefused);
+    for(x = 0; x < groupCmd.numMembers; x++)
+    {
+        if(groupCmd.acked[x] == false)
+        {
+            UART_PRINT("[Collector] Group %d member 0x%04x did not respond\n\r",
+                       groupCmd.groupId, groupCmd.members[x]);
+            Metrics_increment(Metrics_counter_groupMisses);
+        }
+    }
+
+    groupCmd.groupId = 0;
+}
+
+/*!
+ * @brief      Start pushing an OAD image to the devices, or stop pushing
+ *             one.  Each round broadcasts its blocks, the first all of them
+ *             and the next only the ones the devices say they are missing,
+ *             see processOadEvt().
+ *
+ * @param      pImage - the image stored, NULL to stop
+ */
+static void startOad(OadServer_image_t *pImage)
+{
+    int x;
+
+    if(oad.state != Collector_oadState_idle)
+    {
+        finishOad();
+    }
+    if(pImage == NULL)
+    {
+        return;
+    }
+    if(cllcState < Cllc_states_started)
+    {
+        UART_PRINT("[Collector] OAD image ignored, network not started\n\r");
+        return;
+    }
+
+    memset(oad.toSend, 0, sizeof(oad.toSend));
+    for(x = 0; x < pImage->numBlocks; x++)
+    {
+        oad.toSend[x / 8] |= (uint8_t)(1 << (x % 8));
+    }
+
+    /* Nothing is known of the devices yet */
+    for(x = 0; x < CONFIG_MAX_DEVICES; x++)
+    {
+        oadDevices[x].shortAddr = INVALID_SHORT_ADDR;
+    }
+
+    if(oad.seq == 0)
+    {
+        /* Don't start where the devices may remember the last one from */
+        oad.seq = ApiMac_randomByte();
+    }
+    oad.seq++;
+    oad.round = 0;
+    oad.numBlocks = pImage->numBlocks;
+    oad.nextBlock = 0;
+    oad.start = Latency_stamp();
+    memcpy(oad.hdr, pImage->hdr, sizeof(oad.hdr));
+    oad.state = Collector_oadState_blocks;
+
+    UART_PRINT("[Collector] OAD image %d: %d blocks\n\r", oad.seq,
+               oad.numBlocks);
+    sendOadNotify();
+    Csf_setOadClock(OAD_PREPARE_TIME);
+}
+
+/*!
+ * @brief      Broadcast the next block of the round.  After the last one ask
+ *             the devices which blocks they are missing, and when they had
+ *             time to answer start a round with those, if there are any.
+ */
+static void processOadEvt(void)
+{
+    uint16_t block = oad.nextBlock;
+
+    if(oad.state == Collector_oadState_blocks)
+    {
+        uint8_t frame[SMSGS_OAD_IMG_BLOCK_HDR_LEN + SMSGS_OAD_BLOCK_SIZE];
+        uint8_t len;
+
+        while((block < oad.numBlocks) &&
+              !(oad.toSend[block / 8] & (1 << (block % 8))))
+        {
+            block++;
+        }
+        if(block == oad.numBlocks)
+        {
+            sendOadStatusReq();
+            return;
+        }
+
+        len = OadServer_readBlock(block, &frame[SMSGS_OAD_IMG_BLOCK_HDR_LEN]);
+        if(len == 0)
+        {
+            UART_PRINT("[Collector] OAD image %d can't be read\n\r", oad.seq);
+            finishOad();
+            return;
+        }
+        frame[0] = (uint8_t)Smsgs_cmdIds_oadImgBlock;
+        frame[1] = oad.seq;
+        frame[2] = Util_loUint16(block);
+        frame[3] = Util_hiUint16(block);
+
+        /* A block the co-processor has no room for goes next time */
+        if(sendBroadcastMsg(Smsgs_cmdIds_oadImgBlock,
+                            SMSGS_OAD_IMG_BLOCK_HDR_LEN + len, frame) ==
+           ApiMac_status_success)
+        {
+            oad.toSend[block / 8] &= (uint8_t)~(1 << (block % 8));
+            block++;
+            Metrics_increment(Metrics_counter_oadBlocks);
+        }
+        oad.nextBlock = block;
+        Csf_setOadClock(SMSGS_OAD_BLOCK_INTERVAL);
+    }
+    else if(oad.state == Collector_oadState_status)
+    {
+        for(block = 0; block < oad.numBlocks; block++)
+        {
+            if(oad.toSend[block / 8] & (1 << (block % 8)))
+            {
+                break;
+            }
+        }
+
+        if((block == oad.numBlocks) || (oad.round == OAD_MAX_ROUNDS))
+        {
+            finishOad();
+            return;
+        }
+
+        oad.round++;
+        oad.nextBlock = block;
+        oad.state = Collector_oadState_blocks;
+        sendOadNotify();
+        Csf_setOadClock(SMSGS_OAD_BLOCK_INTERVAL);
+    }
+}
+
+/*!
+ * @brief      Broadcast the OAD Image Notify of the round, and queue it for
+ *             the sleepy devices that may still want the image.
+ */
+static void sendOadNotify(void)
+{
+    uint8_t frame[SMSGS_OAD_IMG_NOTIFY_HDR_LEN + SMSGS_OAD_IMG_HDR_LEN];
+    int x;
+
+    frame[0] = (uint8_t)Smsgs_cmdIds_oadImgNotify;
+    frame[1] = oad.seq;
+    frame[2] = oad.round;
+    frame[3] = Util_loUint16(oad.numBlocks);
+    frame[4] = Util_hiUint16(oad.numBlocks);
+    memcpy(&frame[SMSGS_OAD_IMG_NOTIFY_HDR_LEN], oad.hdr,
+           SMSGS_OAD_IMG_HDR_LEN);
+
+    sendBroadcastMsg(Smsgs_cmdIds_oadImgNotify, sizeof(frame), frame);
+
+    for(x = 0; x < CONFIG_MAX_DEVICES; x++)
+    {
+        Cllc_associated_devices_t *pDev = &Cllc_associatedDevList[x];
+        uint8_t status;
+
+        if((pDev->shortAddr == INVALID_SHORT_ADDR) ||
+           pDev->capInfo.rxOnWhenIdle)
+        {
+            continue;
+        }
+
+        status = getOadDevice(pDev)->status;
+        if((status == OAD_STATUS_UNKNOWN) ||
+           (status == Smsgs_oadStatus_receiving))
+        {
+            sendMsg(Smsgs_cmdIds_oadImgNotify, pDev->shortAddr, false,
+                    sizeof(frame), frame);
+        }
+    }
+}
+
+/*!
+ * @brief      Ask the devices that may still want the image which blocks
+ *             they are missing, broadcast and queued for the sleepy ones,
+ *             and wait for the responses until COLLECTOR_OAD_EVT.
+ */
+static void sendOadStatusReq(void)
+{
+    uint8_t frame[SMSGS_OAD_STATUS_REQUEST_MSG_LEN];
+    uint16_t base = INVALID_SHORT_ADDR;
+    uint16_t highest = 0;
+    bool sleepyDevices = false;
+    uint32_t timeout;
+    int x;
+
+    for(x = 0; x < CONFIG_MAX_DEVICES; x++)
+    {
+        Cllc_associated_devices_t *pDev = &Cllc_associatedDevList[x];
+        uint8_t status;
+
+        if(pDev->shortAddr == INVALID_SHORT_ADDR)
+        {
+            continue;
+        }
+
+        status = getOadDevice(pDev)->status;
+        if((status == OAD_STATUS_UNKNOWN) ||
+           (status == Smsgs_oadStatus_receiving))
+        {
+            if(pDev->shortAddr < base)
+            {
+                base = pDev->shortAddr;
+            }
+            if(pDev->shortAddr > highest)
+            {
+                highest = pDev->shortAddr;
+            }
+        }
+    }
+
+    /* Every device has the image or doesn't want it */
+    if(base == INVALID_SHORT_ADDR)
+    {
+        finishOad();
+        return;
+    }
+
+    frame[0] = (uint8_t)Smsgs_cmdIds_oadStatusReq;
+    frame[1] = oad.seq;
+    frame[2] = oad.round;
+    frame[3] = Util_loUint16(base);
+    frame[4] = Util_hiUint16(base);
+
+    sendBroadcastMsg(Smsgs_cmdIds_oadStatusReq, sizeof(frame), frame);
+
+    for(x = 0; x < CONFIG_MAX_DEVICES; x++)
+    {
+        Cllc_associated_devices_t *pDev = &Cllc_associatedDevList[x];
+        uint8_t status;
+
+        if((pDev->shortAddr == INVALID_SHORT_ADDR) ||
+           pDev->capInfo.rxOnWhenIdle)
+        {
+            continue;
+        }
+
+        status = getOadDevice(pDev)->status;
+        if((status == OAD_STATUS_UNKNOWN) ||
+           (status == Smsgs_oadStatus_receiving))
+        {
+            sendMsg(Smsgs_cmdIds_oadStatusReq, pDev->shortAddr, false,
+                    sizeof(frame), frame);
+            sleepyDevices = true;
+        }
+    }
+
+    timeout = ((uint32_t)(highest - base + 1) * SMSGS_OAD_STATUS_SLOT) +
+              OAD_STATUS_MARGIN;
+    if(sleepyDevices &&
+       (timeout < (CONFIG_POLLING_INTERVAL + OAD_STATUS_MARGIN)))
+    {
+        timeout = CONFIG_POLLING_INTERVAL + OAD_STATUS_MARGIN;
+    }
+
+    oad.state = Collector_oadState_status;
+    Csf_setOadClock(timeout);
+}
+
+/*!
+ * @brief      Process the OAD Status Response message: the blocks the device
+ *             is missing go in the next round.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processOadStatusResponse(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    uint8_t *pBuf = pDataInd->msdu.p;
+    Cllc_associated_devices_t *pDev;
+    Collector_oadDevice_t *pOadDev;
+    uint16_t block;
+    int n;
+
+    /* Make sure it answers for the image being pushed */
+    if((pDataInd->msdu.len != SMSGS_OAD_STATUS_RESPONSE_MSG_LEN) ||
+       (oad.state == Collector_oadState_idle) || (pBuf[1] != oad.seq) ||
+       (pBuf[2] > Smsgs_oadStatus_declined))
+    {
+        return;
+    }
+
+    pDev = findDevice(&pDataInd->srcAddr);
+    if(pDev == NULL)
+    {
+        return;
+    }
+
+    pOadDev = getOadDevice(pDev);
+    if((pBuf[2] == Smsgs_oadStatus_complete) &&
+       (pOadDev->status != Smsgs_oadStatus_complete))
+    {
+        Metrics_increment(Metrics_counter_oadComplete);
+    }
+    pOadDev->status = pBuf[2];
+    if(pBuf[2] != Smsgs_oadStatus_receiving)
+    {
+        return;
+    }
+
+    Metrics_increment(Metrics_counter_oadNacks);
+    block = Util_buildUint16(pBuf[3], pBuf[4]);
+    pBuf += SMSGS_OAD_STATUS_RESPONSE_MSG_LEN - SMSGS_OAD_MISSING_MAP_LEN;
+
+    /* Every block after the Missing Map is missing too */
+    for(n = 0; block < oad.numBlocks; n++, block++)
+    {
+        if((n >= (SMSGS_OAD_MISSING_MAP_LEN * 8)) ||
+           (pBuf[n / 8] & (1 << (n % 8))))
+        {
+            oad.toSend[block / 8] |= (uint8_t)(1 << (block % 8));
+        }
+    }
+}
+
+/*!
+ * @brief      Stop pushing the OAD image and report how the devices did.
+ */
+static void finishOad(void)
+{
+    int numComplete = 0;
+    int numDeclined = 0;
+    int numMissing = 0;
+    int numSilent = 0;
+    int x;
+
+    Csf_setOadClock(0);
+
+    for(x = 0; x < CONFIG_MAX_DEVICES; x++)
+    {
+        Cllc_associated_devices_t *pDev = &Cllc_associatedDevList[x];
+
+        if(pDev->shortAddr == INVALID_SHORT_ADDR)
+        {
+            continue;
+        }
+
+        switch(getOadDevice(pDev)->status)
+        {
+            case Smsgs_oadStatus_complete:
+                numComplete++;
+                break;
+            case Smsgs_oadStatus_declined:
+                numDeclined++;
+                break;
+            case Smsgs_oadStatus_receiving:
+                UART_PRINT("[Collector] OAD image %d: 0x%04x is missing "
+                           "blocks\n\r", oad.seq, pDev->shortAddr);
+                numMissing++;
+                break;
+            default:
+                numSilent++;
+                break;
+        }
+    }
+
+    UART_PRINT("[Collector] OAD image %d: %d rounds in %u s, %d devices "
+               "complete, %d declined, %d missing blocks, %d did not "
+               "respond\n\r", oad.seq, oad.round + 1,
+               (unsigned int)((Latency_stamp() - oad.start) / 1000),
+               numComplete, numDeclined, numMissing, numSilent);
+
+    oad.state = Collector_oadState_idle;
+}
+
+/*!
+ * @brief      Get the OAD status of an associated device.
+ *
+ * @param      pDev - the device
+ *
+ * @return     its entry, reset if the slot has a new device
+ */
+static Collector_oadDevice_t *getOadDevice(Cllc_associated_devices_t *pDev)
+{
+    Collector_oadDevice_t *pOadDev =
+        &oadDevices[pDev - Cllc_associatedDevList];
+
+    if(pOadDev->shortAddr != pDev->shortAddr)
+    {
+        pOadDev->shortAddr = pDev->shortAddr;
+        pOadDev->status = OAD_STATUS_UNKNOWN;
+    }
+
+    return (pOadDev);
+}
+
+/*!
+ * @brief      Add what a sensor reported of its transmissions to the
+ *             channel load since the last check.  The message statistics
+ *             are counters since the device started, so what counts is
+ *             how much they went up since its last report.
+ *
+ * @param      pSrcAddr - address of the sensor
+ * @param      pMsg - the report, with the fields in its frame control
+ */
+static void recordLoad(ApiMac_sAddr_t *pSrcAddr, Smsgs_sensorMsg_t *pMsg)
+{
+    Cllc_associated_devices_t *pDev = findDevice(pSrcAddr);
+    Collector_loadDevice_t *pLoadDev;
+
+    if(pDev == NULL)
+    {
+        return;
+    }
+    pLoadDev = getLoadDevice(pDev);
+
+    if(pMsg->frameControl & Smsgs_dataFields_energyStats)
+    {
+        load.txTime += pMsg->energyStats.txTime;
+    }
+
+    if(pMsg->frameControl & Smsgs_dataFields_msgStats)
+    {
+        Smsgs_msgStatsField_t *pStats = &pMsg->msgStats;
+        uint16_t failures = pStats->channelAccessFailures +
+                            pStats->macAckFailures +
+                            pStats->otherDataRequestFailures;
+
+        /* Counters that went down mean the device restarted */
+        if(pLoadDev->statsValid &&
+           (pStats->msgsAttempted >= pLoadDev->msgsAttempted) &&
+           (pStats->msgsSent >= pLoadDev->msgsSent))
+        {
+            uint16_t attempted = pStats->msgsAttempted -
+                                 pLoadDev->msgsAttempted;
+            uint16_t sent = pStats->msgsSent - pLoadDev->msgsSent;
+
+            load.attempted += attempted;
+            load.failures += (uint16_t)(failures - pLoadDev->failures);
+
+            pLoadDev->attempted += attempted;
+            pLoadDev->sent += (sent < attempted) ? sent : attempted;
+        }
+
+        pLoadDev->statsValid = true;
+        pLoadDev->msgsAttempted = pStats->msgsAttempted;
+        pLoadDev->msgsSent = pStats->msgsSent;
+        pLoadDev->failures = failures;
+    }
+}
+
+/*!
+ * @brief      Check the channel load and adjust the reporting intervals.
+ *             The network's interval is doubled when the sensors transmit
+ *             for more than LOAD_UTIL_TARGET of the time or too many of
+ *             their data requests fail, and brought back down a step at a
+ *             time once there is room again, so a congested network sheds
+ *             reports instead of retrying them.  A device that loses more
+ *             of its reports than LOAD_DEVICE_LOSS_HIGH backs off further
+ *             on its own.  Devices running another interval are sent a
+ *             Config Request, one at a time, by generateConfigRequests().
+ */
+static void processLoadEvt(void)
+{
+    uint32_t elapsed = Latency_stamp() - load.start;
+    uint32_t interval = load.reportingInterval;
+    uint32_t util = 0;
+    uint32_t failRate = 0;
+    bool resend = false;
+    uint16_t x;
+
+    if(elapsed > 0)
+    {
+        /* Microseconds per millisecond is already 1/1000 */
+        util = load.txTime / elapsed;
+    }
+    if(load.attempted >= LOAD_MIN_ATTEMPTS)
+    {
+        failRate = (load.failures * 1000) / load.attempted;
+    }
+
+    if((util > LOAD_UTIL_TARGET) || (failRate > LOAD_FAIL_HIGH))
+    {
+        interval *= 2;
+        if(interval > LOAD_MAX_INTERVAL)
+        {
+            interval = LOAD_MAX_INTERVAL;
+        }
+    }
+    else if((util < (LOAD_UTIL_TARGET / 2)) && (failRate < LOAD_FAIL_LOW))
+    {
+        if(interval >= (CONFIG_REPORTING_INTERVAL + LOAD_INTERVAL_STEP))
+        {
+            interval -= LOAD_INTERVAL_STEP;
+        }
+        else
+        {
+            interval = CONFIG_REPORTING_INTERVAL;
+        }
+    }
+
+    if(interval != load.reportingInterval)
+    {
+        Metrics_increment((interval > load.reportingInterval) ?
+                          Metrics_counter_loadBackoffs :
+                          Metrics_counter_loadRecoveries);
+        UART_PRINT("[Collector] Channel load %u/1000, %u/1000 failures in "
+                   "%u reports, reporting interval %u s\n\r",
+                   (unsigned int)util, (unsigned int)failRate,
+                   (unsigned int)load.attempted,
+                   (unsigned int)(interval / 1000));
+        load.reportingInterval = interval;
+    }
+
+    for(x = 0; x < CONFIG_MAX_DEVICES; x++)
+    {
+        Cllc_associated_devices_t *pDev = &Cllc_associatedDevList[x];
+        Collector_loadDevice_t *pLoadDev;
+
+        if(pDev->shortAddr == INVALID_SHORT_ADDR)
+        {
+            continue;
+        }
+        pLoadDev = getLoadDevice(pDev);
+
+        /* Judge the device's loss once it tried enough reports */
+        if(pLoadDev->attempted >= LOAD_DEVICE_MIN_ATTEMPTS)
+        {
+            uint32_t loss = ((uint32_t)(pLoadDev->attempted - pLoadDev->sent)
+                             * 1000) / pLoadDev->attempted;
+
+            if((loss > LOAD_DEVICE_LOSS_HIGH) &&
+               (pLoadDev->backoff < LOAD_MAX_DEVICE_BACKOFF))
+            {
+                pLoadDev->backoff++;
+            }
+            else if((loss < LOAD_FAIL_LOW) && (pLoadDev->backoff > 0))
+            {
+                pLoadDev->backoff--;
+            }
+            pLoadDev->attempted = 0;
+            pLoadDev->sent = 0;
+        }
+
+        /*
+         Only a device that answered its last Config Request is sent
+         another, the others are still being sent one
+         */
+        if(((pDev->status & (ASSOC_CONFIG_SENT | ASSOC_CONFIG_RSP)) ==
+            ASSOC_CONFIG_RSP) &&
+           (pLoadDev->reportingInterval != getReportingInterval(pLoadDev)))
+        {
+            pDev->status &= ~ASSOC_CONFIG_RSP;
+            resend = true;
+        }
+    }
+
+    if(resend)
+    {
+        processConfigRetry();
+    }
+
+    load.start += elapsed;
+    load.txTime = 0;
+    load.attempted = 0;
+    load.failures = 0;
+
+    Csf_setLoadClock(LOAD_CHECK_INTERVAL);
+}
+
+/*!
+ * @brief      Get the reporting interval a device should run with.
+ *
+ * @param      pLoadDev - load of the device
+ *
+ * @return     reporting interval in milliseconds
+ */
+static uint32_t getReportingInterval(Collector_loadDevice_t *pLoadDev)
+{
+    uint32_t interval = load.reportingInterval << pLoadDev->backoff;
+
+    return ((interval < LOAD_MAX_INTERVAL) ? interval : LOAD_MAX_INTERVAL);
+}
+
+/*!
+ * @brief      Get the load of an associated device, starting it afresh if
+ *             the table entry changed hands.
+ *
+ * @param      pDev - associated device table entry
+ *
+ * @return     pointer to its load
+ */
+static Collector_loadDevice_t *getLoadDevice(Cllc_associated_devices_t *pDev)
+{
+    Collector_loadDevice_t *pLoadDev =
+        &loadDevices[pDev - Cllc_associatedDevList];
+
+    if(pLoadDev->shortAddr != pDev->shortAddr)
+    {
+        memset(pLoadDev, 0, sizeof(Collector_loadDevice_t));
+        pLoadDev->shortAddr = pDev->shortAddr;
+    }
+
+    return (pLoadDev);
+}
+
+/*!
+ * @brief      Send MAC broadcast data request. In FH mode it goes out on the
+ *             broadcast schedule, otherwise to the broadcast short address,
+ *             which only devices with the receiver on hear.
+ *
+ * @param      type - message type
+ * @param      len - length of payload
+ * @param      pData - pointer to the buffer
+ *
+ * @return  ApiMac_status_success if sent, otherwise the error
+ */
+static ApiMac_status_t sendBroadcastMsg(Smsgs_cmdIds_t type, uint16_t len,
+                                        uint8_t *pData)
+{
+    ApiMac_mcpsDataReq_t dataReq;
+
+    /* Fill the data request field */
+    memset(&dataReq, 0, sizeof(ApiMac_mcpsDataReq_t));
+
+    if(fhEnabled)
+    {
+        dataReq.dstAddr.addrMode = ApiMac_addrType_none;
+    }
+    else
+    {
+        dataReq.dstAddr.addrMode = ApiMac_addrType_short;
+        dataReq.dstAddr.addr.shortAddr = APIMAC_SHORT_ADDR_BROADCAST;
+    }
+    dataReq.srcAddrMode = ApiMac_addrType_short;
+
+    dataReq.dstPanId = devicePanId;
+
+    dataReq.msduHandle = getMsduHandle(type);
+
+    dataReq.txOptions.ack = false;
+    dataReq.txOptions.indirect = false;
+
+    dataReq.msdu.len = len;
+    dataReq.msdu.p = pData;
+
+#ifdef FEATURE_MAC_SECURITY
+    /* Fill in the appropriate security fields */
+    Cllc_securityFill(&dataReq.sec);
+#endif /* FEATURE_MAC_SECURITY */
+
+    /* Send the message */
+    return (ApiMac_mcpsDataReq(&dataReq));
+}
@@ -138,6 +138,25 @@ extern "C"
 #define TRACKING_DELAY_TIME 300000
 #endif
 
+/*!
+ Fast polling interval in milliseconds to be set on connected sleepy devices
+ using configuration request messages, see
+ SMSGS_CONFIG_REQUEST_FAST_POLL_MSG_LENGTH. 0 sends the shorter
+ configuration request understood by devices without fast polling.
+ */
+#define CONFIG_FAST_POLLING_INTERVAL 0
+
+/*!
+ Battery model used to estimate the remaining battery life of devices that
+ report the energy statistics field.  Capacity is in mAh, currents are the
+ average draw of each device state in microamps.
+ */
+#define CONFIG_BATTERY_CAPACITY_MAH     2400
+#define CONFIG_TX_CURRENT_UA            24900.0
+#define CONFIG_RX_CURRENT_UA            5800.0
+#define CONFIG_MCU_ACTIVE_CURRENT_UA    2900.0
+#define CONFIG_SLEEP_CURRENT_UA         0.85
+
 
 /*! scan duration in seconds */
 #define CONFIG_SCAN_DURATION         5
@@ -159,6 +159,17 @@ STATIC Clock_Handle joinClkHandle;
 STATIC Clock_Struct configClkStruct;
 STATIC Clock_Handle configClkHandle;
 
+/* Clock/timer resources for the group command acknowledgements */
+STATIC Clock_Struct groupClkStruct;
+STATIC Clock_Handle groupClkHandle;
+
+STATIC Clock_Struct oadClkStruct;
+STATIC Clock_Handle oadClkHandle;
+
+/* Clock/timer resources for the channel load check */
+STATIC Clock_Struct loadClkStruct;
+STATIC Clock_Handle loadClkHandle;
+
 /* NV Function Pointers */
 static NVINTF_nvFuncts_t *pNV = NULL;
 
@@ -193,6 +204,9 @@ static void processPATrickleTimeoutCallback(UArg a0);
 static void processPCTrickleTimeoutCallback(UArg a0);
 static void processJoinTimeoutCallback(UArg a0);
 static void processConfigTimeoutCallback(UArg a0);
+static void processGroupTimeoutCallback(UArg a0);
+static void processOadTimeoutCallback(UArg a0);
+static void processLoadTimeoutCallback(UArg a0);
 static bool addDeviceListItem(Llc_deviceListItem_t *pItem);
 static void updateDeviceListItem(Llc_deviceListItem_t *pItem);
 static int findDeviceListIndex(ApiMac_sAddrExt_t *pAddr);
@@ -623,6 +637,72 @@ void Csf_initializeConfigClock(void)
     }
 }
 
+/*!
+ Initialize the clock for the group command acknowledgements
+
+ Public function defined in csf.h
+ */
+void Csf_initializeGroupClock(void)
+{
+    if(groupClkHandle == NULL)
+    {
+        groupClkHandle = Timer_construct(&groupClkStruct,
+                                         processGroupTimeoutCallback,
+                                         CONFIG_TIMEOUT_VALUE,
+                                         0,
+                                         false,
+                                         0);
+    }
+    else if(Timer_isActive(&groupClkStruct) == true)
+    {
+        Timer_stop(&groupClkStruct);
+    }
+}
+
+/*!
+ Initialize the clock pacing the OAD image push
+
+ Public function defined in csf.h
+ */
+void Csf_initializeOadClock(void)
+{
+    if(oadClkHandle == NULL)
+    {
+        oadClkHandle = Timer_construct(&oadClkStruct,
+                                       processOadTimeoutCallback,
+                                       CONFIG_TIMEOUT_VALUE,
+                                       0,
+                                       false,
+                                       0);
+    }
+    else if(Timer_isActive(&oadClkStruct) == true)
+    {
+        Timer_stop(&oadClkStruct);
+    }
+}
+
+/*!
+ Initialize the channel load check clock
+
+ Public function defined in csf.h
+ */
+void Csf_initializeLoadClock(void)
+{
+    if(loadClkHandle == NULL)
+    {
+        loadClkHandle = Timer_construct(&loadClkStruct,
+                                        processLoadTimeoutCallback,
+                                        CONFIG_TIMEOUT_VALUE,
+                                        0,
+                                        false,
+                                        0);
+    }
+    else if(Timer_isActive(&loadClkStruct) == true)
+    {
+        Timer_stop(&loadClkStruct);
+    }
+}
+
 /*!
  Set the tracking clock.
 
@@ -756,6 +836,63 @@ void Csf_setConfigClock(uint32_t delay)
     }
 }
 
+/*!
+ Set the group command acknowledgement clock.
+
+ Public function defined in csf.h
+ */
+void Csf_setGroupClock(uint32_t timeout)
+{
+    if(Timer_isActive(&groupClkStruct) == true)
+    {
+        Timer_stop(&groupClkStruct);
+    }
+
+    if(timeout != 0)
+    {
+        Timer_setTimeout(groupClkHandle, timeout);
+        Timer_start(&groupClkStruct);
+    }
+}
+
+/*!
+ Set the clock pacing the OAD image push.
+
+ Public function defined in csf.h
+ */
+void Csf_setOadClock(uint32_t timeout)
+{
+    if(Timer_isActive(&oadClkStruct) == true)
+    {
+        Timer_stop(&oadClkStruct);
+    }
+
+    if(timeout != 0)
+    {
+        Timer_setTimeout(oadClkHandle, timeout);
+        Timer_start(&oadClkStruct);
+    }
+}
+
+/*!
+ Set the channel load check clock.
+
+ Public function defined in csf.h
+ */
+void Csf_setLoadClock(uint32_t timeout)
+{
+    if(Timer_isActive(&loadClkStruct) == true)
+    {
+        Timer_stop(&loadClkStruct);
+    }
+
+    if(timeout != 0)
+    {
+        Timer_setTimeout(loadClkHandle, timeout);
+        Timer_start(&loadClkStruct);
+    }
+}
+
 /*!
  Read the number of device list items stored
 
@@ -1287,6 +1424,42 @@ static void processConfigTimeoutCallback(UArg a0)
     triggerCollectorEvt(COLLECTOR_CONFIG_EVT);
 }
 
+/*!
+ * @brief       Group command acknowledgement timeout handler function.
+ *
+ * @param       a0 - ignored
+ */
+static void processGroupTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    triggerCollectorEvt(COLLECTOR_GROUP_TIMEOUT_EVT);
+}
+
+/*!
+ * @brief       OAD image push clock handler function.
+ *
+ * @param       a0 - ignored
+ */
+static void processOadTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    triggerCollectorEvt(COLLECTOR_OAD_EVT);
+}
+
+/*!
+ * @brief       Channel load check clock handler function.
+ *
+ * @param       a0 - ignored
+ */
+static void processLoadTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    triggerCollectorEvt(COLLECTOR_LOAD_EVT);
+}
+
 /*!
  * @brief       Trickle timeout handler function for PA .
  *
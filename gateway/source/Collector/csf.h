@@ -69,6 +69,12 @@ extern uint16_t Collector_events;
 /*! Event ID - Generate Configs Event */
 #define COLLECTOR_CONFIG_EVT 0x0004
 #define COLLECTOR_BROADCAST_TIMEOUT_EVT 0x0008
+/*! Event ID - Group command acknowledgement timeout */
+#define COLLECTOR_GROUP_TIMEOUT_EVT 0x0010
+/*! Event ID - Next step of pushing an OAD image */
+#define COLLECTOR_OAD_EVT 0x0020
+/*! Event ID - Check the channel load and adjust the reporting intervals */
+#define COLLECTOR_LOAD_EVT 0x0040
 
 /*! CSF Events - Key Event */
 #define CSF_KEY_EVENT 0x0001
@@ -239,6 +245,21 @@ extern void Csf_initializeJoinPermitClock(void);
  */
 extern void Csf_initializeConfigClock(void);
 
+/*!
+ * @brief       Initialize the group command acknowledgement clock
+ */
+extern void Csf_initializeGroupClock(void);
+
+/*!
+ * @brief       Initialize the clock pacing the OAD image push
+ */
+extern void Csf_initializeOadClock(void);
+
+/*!
+ * @brief       Initialize the channel load check clock
+ */
+extern void Csf_initializeLoadClock(void);
+
 /*!
  * @brief       Set trickle clock
  *
@@ -261,6 +282,28 @@ extern void Csf_setJoinPermitClock(uint32_t joinDuration);
  */
 extern void Csf_setConfigClock(uint32_t delay);
 
+/*!
+ * @brief       Set group command acknowledgement clock
+ *
+ * @param       timeout - time to wait for the acknowledgements( in msec),
+ *                        0 to stop the clock
+ */
+extern void Csf_setGroupClock(uint32_t timeout);
+
+/*!
+ * @brief       Set the clock pacing the OAD image push
+ *
+ * @param       timeout - time to the next step( in msec), 0 to stop the clock
+ */
+extern void Csf_setOadClock(uint32_t timeout);
+
+/*!
+ * @brief       Set the channel load check clock
+ *
+ * @param       timeout - time to the next check( in msec), 0 to stop the clock
+ */
+extern void Csf_setLoadClock(uint32_t timeout);
+
 /*!
  * @brief       Read the number of device list items stored
  *
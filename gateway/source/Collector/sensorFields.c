@@ -0,0 +1,564 @@
+/******************************************************************************
+
+ @file sensorFields.c
+
+ @brief Data fields of the Sensor Data message and the objects made of them
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <Utils/util.h>
+#include <Common/commonDefs.h>
+#include <API_MAC/api_mac.h>
+#include "config.h"
+#include "sensorFields.h"
+
+/******************************************************************************
+ Typedefs
+ *****************************************************************************/
+
+/*! An object the gateway makes of a field */
+typedef struct
+{
+    /*! IPSO object id */
+    int typeId;
+    /*! Type, NULL past the last object of the field */
+    const char *pType;
+    /*! Unit */
+    const char *pUnit;
+    /*! Get its value from the message, false if the message has none */
+    bool (*getValue)(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+} SensorFields_object_t;
+
+/*! A data field of the Sensor Data message */
+typedef struct
+{
+    /*! Its frame control bit */
+    uint16_t field;
+    /*! Its length on air */
+    uint8_t len;
+    /*! Decode it from the message into pMsg */
+    void (*decode)(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+    /*! The objects made of it */
+    SensorFields_object_t objects[SENSORFIELDS_MAX_OBJECTS];
+} SensorFields_field_t;
+
+/******************************************************************************
+ Local function prototypes
+ *****************************************************************************/
+static void decodeTemp(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeLight(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeHumidity(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeMsgStats(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeConfigSettings(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodePressure(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeMotion(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeBattery(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeHallEffect(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeFan(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeDoorLock(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeWaterleak(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeEnergyStats(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static void decodeLatencyTrace(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static bool getTemp(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getLight(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getHumidity(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getPressure(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getPressureTemp(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getMotion(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getBattery(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getHallOpen(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getHallTamper(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getFan(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getDoorLock(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getWaterleak(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+static bool getBatteryLife(const Smsgs_sensorMsg_t *pMsg, int *pValue);
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+/*! The data fields, in the order they are sent, LSB first */
+static const SensorFields_field_t fieldTable[] =
+{
+    {Smsgs_dataFields_tempSensor, SMSGS_SENSOR_TEMP_LEN, decodeTemp,
+     {{TEMP_TYPE_ID, TEMP_TYPE, "C", getTemp}}},
+    {Smsgs_dataFields_lightSensor, SMSGS_SENSOR_LIGHT_LEN, decodeLight,
+     {{LIGHT_TYPE_ID, LIGHT_TYPE, "Lumen", getLight}}},
+    {Smsgs_dataFields_humiditySensor, SMSGS_SENSOR_HUMIDITY_LEN,
+     decodeHumidity,
+     {{HUM_TYPE_ID, HUM_TYPE, "%", getHumidity}}},
+    {Smsgs_dataFields_msgStats, SMSGS_SENSOR_MSG_STATS_LEN, decodeMsgStats},
+    {Smsgs_dataFields_configSettings, SMSGS_SENSOR_CONFIG_SETTINGS_LEN,
+     decodeConfigSettings},
+    {Smsgs_dataFields_pressureSensor, SMSGS_SENSOR_PRESSURE_LEN,
+     decodePressure,
+     {{GEN_SENSOR_TYPE_ID, PRESS_TYPE, "P", getPressure},
+      {TEMP_TYPE_ID, TEMP_TYPE, "C", getPressureTemp}}},
+    {Smsgs_dataFields_motionSensor, SMSGS_SENSOR_MOTION_LEN, decodeMotion,
+     {{PRESENSE_TYPE_ID, MOTION_TYPE, "-", getMotion}}},
+    {Smsgs_dataFields_batterySensor, SMSGS_SENSOR_BATTERY_LEN, decodeBattery,
+     {{GEN_SENSOR_TYPE_ID, VOLTAGE_TYPE, "V", getBattery}}},
+    {Smsgs_dataFields_hallEffectSensor, SMSGS_SENSOR_HALL_EFFECT_LEN,
+     decodeHallEffect,
+     {{GEN_SENSOR_TYPE_ID, HALL_OPEN_TYPE, "-", getHallOpen},
+      {GEN_SENSOR_TYPE_ID, HALL_TMPR_TYPE, "-", getHallTamper}}},
+    {Smsgs_dataFields_fanSensor, SMSGS_SENSOR_FAN_LEN, decodeFan,
+     {{ACTUATOR_TYPE_ID, FAN_TYPE, "%", getFan}}},
+    {Smsgs_dataFields_doorLockSensor, SMSGS_SENSOR_DOORLOCK_LEN,
+     decodeDoorLock,
+     {{ACTUATOR_TYPE_ID, DOOR_LOCK_TYPE, "-", getDoorLock}}},
+    {Smsgs_dataFields_waterleakSensor, SMSGS_SENSOR_WATERLEAK_LEN,
+     decodeWaterleak,
+     {{GEN_SENSOR_TYPE_ID, WATR_LEAK_TYPE, "Status", getWaterleak}}},
+    {Smsgs_dataFields_energyStats, SMSGS_SENSOR_ENERGY_STATS_LEN,
+     decodeEnergyStats,
+     {{GEN_SENSOR_TYPE_ID, BATT_LIFE_TYPE, "days", getBatteryLife}}},
+    {Smsgs_dataFields_latencyTrace, SMSGS_SENSOR_LATENCY_TRACE_LEN,
+     decodeLatencyTrace},
+};
+
+/*! Number of data fields */
+#define NUM_FIELDS (sizeof(fieldTable) / sizeof(fieldTable[0]))
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Parse the data fields of a Sensor Data message.
+
+ Public function defined in sensorFields.h
+ */
+uint8_t *SensorFields_parse(uint8_t *pBuf, uint8_t *pEnd, uint16_t fields,
+                            Smsgs_sensorMsg_t *pMsg)
+{
+    const SensorFields_field_t *pField;
+
+    for(pField = fieldTable; pField < &fieldTable[NUM_FIELDS]; pField++)
+    {
+        if(fields & pField->field)
+        {
+            if((pBuf + pField->len) > pEnd)
+            {
+                return (NULL);
+            }
+            pField->decode(pBuf, pMsg);
+            pBuf += pField->len;
+        }
+    }
+
+    return (pBuf);
+}
+
+/*!
+ Make the objects of the fields of a Sensor Data message.
+
+ Public function defined in sensorFields.h
+ */
+uint8_t SensorFields_getObjects(const Smsgs_sensorMsg_t *pMsg,
+                                smartObject_t *pObjects, uint8_t maxObjects)
+{
+    const SensorFields_field_t *pField;
+    const SensorFields_object_t *pObject;
+    uint8_t numObjects = 0;
+    int value;
+
+    for(pField = fieldTable; pField < &fieldTable[NUM_FIELDS]; pField++)
+    {
+        if((pMsg->frameControl & pField->field) == 0)
+        {
+            continue;
+        }
+
+        for(pObject = pField->objects;
+            (pObject < &pField->objects[SENSORFIELDS_MAX_OBJECTS]) &&
+            (pObject->pType != NULL) && (numObjects < maxObjects);
+            pObject++)
+        {
+            if(pObject->getValue(pMsg, &value))
+            {
+                pObjects[numObjects].typeId = pObject->typeId;
+                pObjects[numObjects].type = pObject->pType;
+                pObjects[numObjects].unit = pObject->pUnit;
+                pObjects[numObjects].sensorVal = value;
+                numObjects++;
+            }
+        }
+    }
+
+    return (numObjects);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief      Decode the Temp Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeTemp(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->tempSensor.ambienceTemp = Util_buildUint16(pBuf[0], pBuf[1]);
+    pMsg->tempSensor.objectTemp = Util_buildUint16(pBuf[2], pBuf[3]);
+}
+
+/*!
+ * @brief      Decode the Light Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeLight(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->lightSensor.rawData = Util_buildUint16(pBuf[0], pBuf[1]);
+}
+
+/*!
+ * @brief      Decode the Humidity Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeHumidity(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->humiditySensor.temp = Util_buildUint16(pBuf[0], pBuf[1]);
+    pMsg->humiditySensor.humidity = Util_buildUint16(pBuf[2], pBuf[3]);
+}
+
+/*!
+ * @brief      Decode the Message Statistics field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeMsgStats(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    Smsgs_msgStatsField_t *pStats = &pMsg->msgStats;
+
+    pStats->joinAttempts = Util_buildUint16(pBuf[0], pBuf[1]);
+    pStats->joinFails = Util_buildUint16(pBuf[2], pBuf[3]);
+    pStats->msgsAttempted = Util_buildUint16(pBuf[4], pBuf[5]);
+    pStats->msgsSent = Util_buildUint16(pBuf[6], pBuf[7]);
+    pStats->trackingRequests = Util_buildUint16(pBuf[8], pBuf[9]);
+    pStats->trackingResponseAttempts = Util_buildUint16(pBuf[10], pBuf[11]);
+    pStats->trackingResponseSent = Util_buildUint16(pBuf[12], pBuf[13]);
+    pStats->configRequests = Util_buildUint16(pBuf[14], pBuf[15]);
+    pStats->configResponseAttempts = Util_buildUint16(pBuf[16], pBuf[17]);
+    pStats->configResponseSent = Util_buildUint16(pBuf[18], pBuf[19]);
+    pStats->channelAccessFailures = Util_buildUint16(pBuf[20], pBuf[21]);
+    pStats->macAckFailures = Util_buildUint16(pBuf[22], pBuf[23]);
+    pStats->otherDataRequestFailures = Util_buildUint16(pBuf[24], pBuf[25]);
+    pStats->syncLossIndications = Util_buildUint16(pBuf[26], pBuf[27]);
+    pStats->rxDecryptFailures = Util_buildUint16(pBuf[28], pBuf[29]);
+    pStats->txEncryptFailures = Util_buildUint16(pBuf[30], pBuf[31]);
+    pStats->resetCount = Util_buildUint16(pBuf[32], pBuf[33]);
+    pStats->lastResetReason = Util_buildUint16(pBuf[34], pBuf[35]);
+    pStats->joinTime = Util_buildUint16(pBuf[36], pBuf[37]);
+    pStats->interimDelay = Util_buildUint16(pBuf[38], pBuf[39]);
+    pStats->numBroadcastMsgRcvd = Util_buildUint16(pBuf[40], pBuf[41]);
+    pStats->numBroadcastMsglost = Util_buildUint16(pBuf[42], pBuf[43]);
+    pStats->avgE2EDelay = Util_buildUint16(pBuf[44], pBuf[45]);
+    pStats->worstCaseE2EDelay = Util_buildUint16(pBuf[46], pBuf[47]);
+}
+
+/*!
+ * @brief      Decode the Config Settings field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeConfigSettings(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->configSettings.reportingInterval = Util_buildUint32(pBuf[0],
+                                                              pBuf[1],
+                                                              pBuf[2],
+                                                              pBuf[3]);
+    pMsg->configSettings.pollingInterval = Util_buildUint32(pBuf[4],
+                                                            pBuf[5],
+                                                            pBuf[6],
+                                                            pBuf[7]);
+}
+
+/*!
+ * @brief      Decode the Pressure Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodePressure(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->pressureSensor.pressureValue = Util_buildUint32(pBuf[0], pBuf[1],
+                                                          pBuf[2], pBuf[3]);
+    pMsg->pressureSensor.tempValue = Util_buildUint32(pBuf[4], pBuf[5],
+                                                      pBuf[6], pBuf[7]);
+}
+
+/*!
+ * @brief      Decode the Motion Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeMotion(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->motionSensor.isMotion = pBuf[0];
+}
+
+/*!
+ * @brief      Decode the Battery Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeBattery(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->batterySensor.voltageValue = Util_buildUint32(pBuf[0], pBuf[1],
+                                                        pBuf[2], pBuf[3]);
+}
+
+/*!
+ * @brief      Decode the Hall Effect Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeHallEffect(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->hallEffectSensor.isOpen = pBuf[0];
+    pMsg->hallEffectSensor.isTampered = pBuf[1];
+}
+
+/*!
+ * @brief      Decode the Fan Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeFan(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->fanSensor.fanSpeed = pBuf[0];
+}
+
+/*!
+ * @brief      Decode the Door Lock Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeDoorLock(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->doorLockSensor.isLocked = pBuf[0];
+}
+
+/*!
+ * @brief      Decode the Water Leak Sensor field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeWaterleak(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->waterleakSensor.status = Util_buildUint16(pBuf[0], pBuf[1]);
+}
+
+/*!
+ * @brief      Decode the Energy Statistics field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeEnergyStats(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    Smsgs_energyStatsField_t *pStats = &pMsg->energyStats;
+
+    pStats->periodTime = Util_buildUint32(pBuf[0], pBuf[1], pBuf[2], pBuf[3]);
+    pStats->txTime = Util_buildUint32(pBuf[4], pBuf[5], pBuf[6], pBuf[7]);
+    pStats->rxTime = Util_buildUint32(pBuf[8], pBuf[9], pBuf[10], pBuf[11]);
+    pStats->activeTime = Util_buildUint32(pBuf[12], pBuf[13],
+                                          pBuf[14], pBuf[15]);
+    pStats->txFrames = Util_buildUint16(pBuf[16], pBuf[17]);
+    pStats->retries = Util_buildUint16(pBuf[18], pBuf[19]);
+    pStats->csmaBackoffs = Util_buildUint16(pBuf[20], pBuf[21]);
+    pStats->polls = Util_buildUint16(pBuf[22], pBuf[23]);
+    pStats->scans = Util_buildUint16(pBuf[24], pBuf[25]);
+}
+
+/*!
+ * @brief      Decode the Latency Trace field.
+ *
+ * @param      pBuf - pointer to the field
+ * @param      pMsg - pointer to the sensor message to fill in
+ */
+static void decodeLatencyTrace(const uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    pMsg->latencyTrace.traceId = Util_buildUint16(pBuf[0], pBuf[1]);
+    pMsg->latencyTrace.timestamp = Util_buildUint32(pBuf[2], pBuf[3],
+                                                    pBuf[4], pBuf[5]);
+    pMsg->latencyTrace.radioDelay = Util_buildUint16(pBuf[6], pBuf[7]);
+}
+
+/*
+ * Values of the objects.  Each gets the value of an object from the
+ * sensor message into pValue and returns false if the message has none.
+ */
+
+static bool getTemp(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->tempSensor.ambienceTemp;
+    return (true);
+}
+
+static bool getLight(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->lightSensor.rawData;
+    return (true);
+}
+
+static bool getHumidity(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->humiditySensor.humidity;
+    return (true);
+}
+
+static bool getPressure(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->pressureSensor.pressureValue;
+    return (true);
+}
+
+static bool getPressureTemp(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->pressureSensor.tempValue;
+    return (true);
+}
+
+static bool getMotion(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = (int)pMsg->motionSensor.isMotion;
+    return (true);
+}
+
+static bool getBattery(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->batterySensor.voltageValue;
+    return (true);
+}
+
+static bool getHallOpen(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->hallEffectSensor.isOpen;
+    return (true);
+}
+
+static bool getHallTamper(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->hallEffectSensor.isTampered;
+    return (true);
+}
+
+static bool getFan(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->fanSensor.fanSpeed;
+    return (true);
+}
+
+static bool getDoorLock(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = pMsg->doorLockSensor.isLocked;
+    return (true);
+}
+
+static bool getWaterleak(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    *pValue = (int)pMsg->waterleakSensor.status;
+    return (true);
+}
+
+/*!
+ * @brief Estimate the battery life of a device from the radio and MCU
+ *        usage it reported for its last reporting period
+ *
+ * @param pMsg - sensor message with the energy statistics
+ * @param pValue - filled in with the estimated battery life in days
+ *
+ * @return false if the statistics cover no time
+ */
+static bool getBatteryLife(const Smsgs_sensorMsg_t *pMsg, int *pValue)
+{
+    const Smsgs_energyStatsField_t *pStats = &pMsg->energyStats;
+    double periodUs = (double)pStats->periodTime * 1000.0;
+    double busyUs = (double)pStats->txTime + (double)pStats->rxTime +
+                    (double)pStats->activeTime;
+    double sleepUs = (periodUs > busyUs) ? (periodUs - busyUs) : 0.0;
+    double avgCurrentUa;
+    double hours;
+
+    if(pStats->periodTime == 0)
+    {
+        return (false);
+    }
+
+    /* Charge used in the period, in microamp microseconds */
+    avgCurrentUa = ((double)pStats->txTime * CONFIG_TX_CURRENT_UA) +
+                   ((double)pStats->rxTime * CONFIG_RX_CURRENT_UA) +
+                   ((double)pStats->activeTime * CONFIG_MCU_ACTIVE_CURRENT_UA) +
+                   (sleepUs * CONFIG_SLEEP_CURRENT_UA);
+    avgCurrentUa /= (periodUs > busyUs) ? periodUs : busyUs;
+
+    if(avgCurrentUa <= 0.0)
+    {
+        *pValue = 0;
+        return (true);
+    }
+
+    hours = ((double)CONFIG_BATTERY_CAPACITY_MAH * 1000.0) / avgCurrentUa;
+    *pValue = (int)(hours / 24.0);
+
+    return (true);
+}
@@ -0,0 +1,126 @@
+/******************************************************************************
+
+ @file sensorFields.h
+
+ @brief Data fields of the Sensor Data message and the objects made of them
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+#ifndef SENSORFIELDS_H
+#define SENSORFIELDS_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <Common/commonDefs.h>
+#include <Collector/smsgs.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup SensorFields Sensor Data Fields
+ <BR>
+ One constant table describes each data field of the Sensor Data message:
+ its Smsgs_dataFields_t bit, its length on air, how it is decoded and the
+ IPSO objects the gateway makes of it.  The collector parses messages with
+ it and the application builds the device objects with it, so a new kind
+ of sensor is one more entry.
+ <BR>
+ The objects point at the constant type and unit strings of the table,
+ nothing is copied.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup SensorFields
+ * @{
+ */
+
+/*! Most objects made of one field, e.g. pressure and its temperature */
+#define SENSORFIELDS_MAX_OBJECTS 2
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Parse the data fields of a Sensor Data message, in order of
+ *          their bits, starting with the LSB.
+ *
+ * @param   pBuf - pointer to the first data field
+ * @param   pEnd - pointer to the byte after the message
+ * @param   fields - frame control bits of the fields to parse
+ * @param   pMsg - pointer to the sensor message to fill in
+ *
+ * @return  pointer to the byte following the parsed fields,
+ *          NULL if the message is too short for them.
+ */
+extern uint8_t *SensorFields_parse(uint8_t *pBuf, uint8_t *pEnd,
+                                   uint16_t fields, Smsgs_sensorMsg_t *pMsg);
+
+/*!
+ * @brief   Make the objects of the fields of a parsed Sensor Data message.
+ *
+ * @param   pMsg - the sensor message
+ * @param   pObjects - where to put the objects
+ * @param   maxObjects - most objects pObjects holds
+ *
+ * @return  number of objects made
+ */
+extern uint8_t SensorFields_getObjects(const Smsgs_sensorMsg_t *pMsg,
+                                       smartObject_t *pObjects,
+                                       uint8_t maxObjects);
+
+/*! @} end group SensorFields */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SENSORFIELDS_H */
@@ -80,6 +80,11 @@ extern "C"
      - Polling Interval - in millseconds (32 bits) - If the sensor device is
      a sleep device, this tells the device how often to poll its parent for
      data.
+     - Fast Polling Interval - in millseconds (32 bits) - optional, only in
+     messages of SMSGS_CONFIG_REQUEST_FAST_POLL_MSG_LENGTH.  A sleep device
+     polls this often after receiving data from its parent, and backs off
+     exponentially to the Polling Interval while there is no data.  0 means
+     to always poll at the Polling Interval.
  <BR>
  The <b>Configuration Response Message</b> is defined as:
      - Command ID - [Smsgs_cmdIds_configRsp](@ref Smsgs_cmdIds) (1 byte)
@@ -105,6 +110,106 @@ extern "C"
      Smsgs_dataFields_lightSensor set, then the Temp Sensor field is first,
      followed by the light sensor field.
  <BR>
+ The <b>Sensor Data Batch Message</b> is defined as:
+     - Command ID - [Smsgs_cmdIds_sensorDataBatch](@ref Smsgs_cmdIds) (1 byte)
+     - Extended Address - (8 bytes)
+     - Frame Control field - Smsgs_dataFields (16 bits) - tells the collector
+     what fields are included in this message.
+     - Sample Count - (8 bits) - number of samples in this message.
+     - Report Fields - the fields of the Frame Control field that are in
+     SMSGS_BATCH_REPORT_FIELDS, sent once per message.
+     - Samples - Sample Count entries, oldest first.  Each entry is the
+     Sample Age (16 bits, in units of SMSGS_BATCH_SAMPLE_AGE_RES milliseconds,
+     measured when the message was built) followed by the data fields of the
+     Frame Control field that are not in SMSGS_BATCH_REPORT_FIELDS, in the
+     same order and format as the Sensor Data Message.
+ <BR>
+ The <b>Group Command Request</b> carries one command to the members of a
+ group.  The collector broadcasts it once for the members with the receiver
+ on, queues it for each sleepy member, and sends it again to any member that
+ hasn't acknowledged it:
+     - Command ID - [Smsgs_cmdIds_groupCmdReq](@ref Smsgs_cmdIds) (1 byte)
+     - Sequence - (8 bits) - the same in every copy of the command, so a
+     member carries it out only once.
+     - Base Address - (16 bits) - short address of the first member bit.
+     - Mask Length - (8 bits) - number of bytes in the Member Mask, at most
+     SMSGS_GROUP_CMD_MAX_MASK_LEN.  0 if every device is a member, and the
+     device with short address Base Address + n counts as the
+     (n % (SMSGS_GROUP_CMD_MAX_MASK_LEN * 8) + 1)th.  The collector only
+     sends it when the devices span more short addresses than a mask holds.
+     - Member Mask - bit n (bit n % 8 of byte n / 8) is set if the device
+     with short address Base Address + n is a member.
+     - Command - the rest of the message, a message the collector could send
+     to the member on its own (Command ID first).
+ <BR>
+ Each member answers with a <b>Group Command Response</b>:
+     - Command ID - [Smsgs_cmdIds_groupCmdRsp](@ref Smsgs_cmdIds) (1 byte)
+     - Sequence - (8 bits) - Sequence of the request.
+     - Status - (8 bits) - Smsgs_statusValues_success if the command was
+     carried out, Smsgs_statusValues_invalid if the device doesn't know it.
+ <BR>
+ To a broadcast request, the member that is the Nth set bit of the Member
+ Mask answers N * SMSGS_GROUP_CMD_ACK_SLOT milliseconds after it, so the
+ responses don't collide; to a request sent to it alone it answers at once.
+ <BR>
+ An image for over-the-air download is pushed to every device that wants it
+ at once.  The collector broadcasts an <b>OAD Image Notify</b> at the start
+ of each round, and queues it for each sleepy device:
+     - Command ID - [Smsgs_cmdIds_oadImgNotify](@ref Smsgs_cmdIds) (1 byte)
+     - Image Sequence - (8 bits) - changes with every image pushed.
+     - Round - (8 bits) - 0 for the round with every block, counting up for
+     the repair rounds.
+     - Number of Blocks - (16 bits) - of SMSGS_OAD_BLOCK_SIZE bytes, the last
+     one may be shorter.
+     - Image Header - the first SMSGS_OAD_IMG_HDR_LEN bytes of the image, for
+     the device to decide whether it wants it.
+ <BR>
+ A device that wants the image keeps its receiver on until it has every
+ block.  The blocks of a round are broadcast in order, one every
+ SMSGS_OAD_BLOCK_INTERVAL milliseconds, as an <b>OAD Image Block</b>:
+     - Command ID - [Smsgs_cmdIds_oadImgBlock](@ref Smsgs_cmdIds) (1 byte)
+     - Image Sequence - (8 bits)
+     - Block Number - (16 bits)
+     - Data - the block.
+ <BR>
+ After the blocks of a round the collector broadcasts an <b>OAD Status
+ Request</b>, and queues it for each sleepy device:
+     - Command ID - [Smsgs_cmdIds_oadStatusReq](@ref Smsgs_cmdIds) (1 byte)
+     - Image Sequence - (8 bits)
+     - Round - (8 bits) - the round that ended.
+     - Base Address - (16 bits) - the device with short address
+     Base Address + n answers n * SMSGS_OAD_STATUS_SLOT milliseconds after a
+     broadcast request; to a request sent to it alone it answers at once.
+ <BR>
+ Each device that heard the Image Notify answers with an <b>OAD Status
+ Response</b>:
+     - Command ID - [Smsgs_cmdIds_oadStatusRsp](@ref Smsgs_cmdIds) (1 byte)
+     - Image Sequence - (8 bits)
+     - Status - Smsgs_oadStatus (8 bits)
+     - First Missing - (16 bits) - first block it doesn't have, if
+     Smsgs_oadStatus_receiving.
+     - Missing Map - (SMSGS_OAD_MISSING_MAP_LEN bytes) - bit n (bit n % 8 of
+     byte n / 8) is set if block First Missing + n is missing.  Every block
+     after the map is taken as missing.
+ <BR>
+ The next round broadcasts only the blocks some device is missing, and the
+ rounds stop when no device is.
+ <BR>
+ When Smsgs_dataFields_compactEncoding is set in the Frame Control field
+ of a <b>Sensor Data Message</b>, the Frame Control field is followed by:
+     - Version - (8 bits) - SMSGS_COMPACT_VERSION.
+     - Report Sequence - (8 bits) - sequence number of this report, never
+     SMSGS_COMPACT_NO_BASE.
+     - Delta Base - (8 bits) - Report Sequence of the earlier report the
+     Message Statistics are relative to, or SMSGS_COMPACT_NO_BASE if they are
+     absolute.
+     - Data Fields - in the usual order, but each 16 or 32 bit value is sent
+     as a varint (7 bits per byte, low group first, bit 7 set on all but the
+     last byte).  Signed values are zig-zag encoded first, 8 bit values are
+     sent as-is.  The Message Statistics field starts with an 8 bit count of
+     the statistics that follow, and each statistic is the zig-zag encoded
+     16 bit difference from the same statistic in the Delta Base report.
+ <BR>
  The <b>Temp Sensor Field</b> is defined as:
     - Ambience Chip Temperature - (int16_t) - each value represents signed
       integer part of temperature in Deg C (-256 .. +255)
@@ -159,6 +264,26 @@ extern "C"
      - Polling Interval - in millseconds (32 bits) - If the sensor device is
      a sleep device, this states how often the device polls its parent for
      data. This field is 0 if the device doesn't sleep.
+ <BR>
+ The <b>Energy Statistics Field</b> is defined as:
+     - periodTime - uint32_t - length of the accounting period in
+     milliseconds, the counters are reset after every report.
+     - txTime - uint32_t - estimated radio transmit time in microseconds.
+     - rxTime - uint32_t - estimated radio receive time in microseconds.
+     - activeTime - uint32_t - application MCU active time in microseconds.
+     - txFrames - uint16_t - frames transmitted, including retries and polls.
+     - retries - uint16_t - MAC retries of transmitted data frames.
+     - csmaBackoffs - uint16_t - busy clear channel assessments, estimated
+     from the channel access failures.
+     - polls - uint16_t - data requests (polls) sent.
+     - scans - uint16_t - network scans started.
+ <BR>
+ The <b>Latency Trace Field</b> is defined as:
+     - traceId - uint16_t - incremented for every report.
+     - timestamp - uint32_t - sensor time the report was built, in
+     milliseconds since the sensor started.
+     - radioDelay - uint16_t - time from handing the previous report to the
+     MAC until its data confirm, in milliseconds. 0 if unknown.
  */
 
 /******************************************************************************
@@ -169,12 +294,44 @@ extern "C"
 
 /*! Config Request message length (over-the-air length) */
 #define SMSGS_CONFIG_REQUEST_MSG_LENGTH 11
+/*! Configuration Request message length with the fast polling interval */
+#define SMSGS_CONFIG_REQUEST_FAST_POLL_MSG_LENGTH \
+    (SMSGS_CONFIG_REQUEST_MSG_LENGTH + 4)
 /*! Config Response message length (over-the-air length) */
 #define SMSGS_CONFIG_RESPONSE_MSG_LENGTH 13
 /*! Tracking Request message length (over-the-air length) */
 #define SMSGS_TRACKING_REQUEST_MSG_LENGTH 1
 /*! Tracking Response message length (over-the-air length) */
 #define SMSGS_TRACKING_RESPONSE_MSG_LENGTH 1
+/*! Group Command Request length before the Member Mask (over-the-air) */
+#define SMSGS_GROUP_CMD_REQUEST_HDR_LEN 5
+/*! Longest Member Mask of a Group Command Request */
+#define SMSGS_GROUP_CMD_MAX_MASK_LEN 8
+/*! Longest command carried by a Group Command Request */
+#define SMSGS_GROUP_CMD_MAX_CMD_LEN 4
+/*! Group Command Response message length (over-the-air length) */
+#define SMSGS_GROUP_CMD_RESPONSE_MSG_LEN 3
+/*! Time between the responses to a broadcast group command, in ms */
+#define SMSGS_GROUP_CMD_ACK_SLOT 20
+/*! OAD Image Notify length before the Image Header (over-the-air) */
+#define SMSGS_OAD_IMG_NOTIFY_HDR_LEN 5
+/*! Length of the Image Header in an OAD Image Notify */
+#define SMSGS_OAD_IMG_HDR_LEN 16
+/*! OAD Image Block length before the data (over-the-air) */
+#define SMSGS_OAD_IMG_BLOCK_HDR_LEN 4
+/*! Data in an OAD Image Block, leaves room for the security and, in FH
+    mode, the header IEs of a broadcast frame */
+#define SMSGS_OAD_BLOCK_SIZE 64
+/*! Time between the broadcast blocks of a round, in ms */
+#define SMSGS_OAD_BLOCK_INTERVAL 100
+/*! OAD Status Request message length (over-the-air length) */
+#define SMSGS_OAD_STATUS_REQUEST_MSG_LEN 5
+/*! Length of the Missing Map of an OAD Status Response */
+#define SMSGS_OAD_MISSING_MAP_LEN 16
+/*! OAD Status Response message length (over-the-air length) */
+#define SMSGS_OAD_STATUS_RESPONSE_MSG_LEN (5 + SMSGS_OAD_MISSING_MAP_LEN)
+/*! Time between the responses to a broadcast OAD status request, in ms */
+#define SMSGS_OAD_STATUS_SLOT 20
 
 /*! Length of a sensor data message with no configured data fields */
 #define SMSGS_BASIC_SENSOR_LEN (3 + SMGS_SENSOR_EXTADDR_LEN)
@@ -197,9 +354,32 @@ extern "C"
 /*! Length of the doorLockSensor portion of the sensor data message */
 #define SMSGS_SENSOR_DOORLOCK_LEN 1
 /*! Length of the messageStatistics portion of the sensor data message */
-#define SMSGS_SENSOR_MSG_STATS_LEN 36
+#define SMSGS_SENSOR_MSG_STATS_LEN 48
 /*! Length of the configSettings portion of the sensor data message */
 #define SMSGS_SENSOR_CONFIG_SETTINGS_LEN 8
+/*! Length of the energyStats portion of the sensor data message */
+#define SMSGS_SENSOR_ENERGY_STATS_LEN 26
+/*! Length of the latencyTrace portion of the sensor data message */
+#define SMSGS_SENSOR_LATENCY_TRACE_LEN 8
+/*! Length of a sensor data batch message with no report fields or samples */
+#define SMSGS_BASIC_SENSOR_BATCH_LEN (SMSGS_BASIC_SENSOR_LEN + 1)
+/*! Length of the sample age portion of each batched sample */
+#define SMSGS_BATCH_SAMPLE_AGE_LEN 2
+/*! Resolution of the batched sample age, in milliseconds */
+#define SMSGS_BATCH_SAMPLE_AGE_RES 100
+/*! Data fields sent once per batch message instead of once per sample */
+#define SMSGS_BATCH_REPORT_FIELDS (Smsgs_dataFields_msgStats | \
+                                   Smsgs_dataFields_configSettings | \
+                                   Smsgs_dataFields_energyStats | \
+                                   Smsgs_dataFields_latencyTrace)
+/*! Version of the compact sensor data encoding */
+#define SMSGS_COMPACT_VERSION 1
+/*! Length of the version, sequence and delta base of a compact message */
+#define SMSGS_COMPACT_HDR_LEN 3
+/*! Compact delta base value for absolute message statistics */
+#define SMSGS_COMPACT_NO_BASE 0
+/*! Maximum length of a varint encoded 32 bit value */
+#define SMSGS_VARINT_MAX_LEN 5
 /*! Toggle Led Request message length (over-the-air length) */
 #define SMSGS_TOGGLE_LED_REQUEST_MSG_LEN 1
 /*! Toggle Led Request message length (over-the-air length) */
@@ -242,7 +422,21 @@ extern "C"
     /* Control the Buzzer, sent from the collector to the sensor */
     Smsgs_cmdIds_buzzerCtrlReq = 12,
     /* Control the Buzzer response msg, sent from the sensor to the collector */
-    Smsgs_cmdIds_buzzerCtrlRsp = 13
+    Smsgs_cmdIds_buzzerCtrlRsp = 13,
+    /*! Batched sensor data message, sent from the sensor to the collector */
+    Smsgs_cmdIds_sensorDataBatch = 18,
+    /*! Group command, from the collector to the members of a group */
+    Smsgs_cmdIds_groupCmdReq = 20,
+    /*! Group command response, from a group member to the collector */
+    Smsgs_cmdIds_groupCmdRsp = 21,
+    /*! OAD image notify, from the collector to the devices */
+    Smsgs_cmdIds_oadImgNotify = 22,
+    /*! OAD image block, broadcast by the collector */
+    Smsgs_cmdIds_oadImgBlock = 23,
+    /*! OAD status request, from the collector to the devices */
+    Smsgs_cmdIds_oadStatusReq = 24,
+    /*! OAD status response, from a device to the collector */
+    Smsgs_cmdIds_oadStatusRsp = 25
  } Smsgs_cmdIds_t;
 
 /*!
@@ -277,6 +471,15 @@ typedef enum
     Smsgs_dataFields_doorLockSensor = 0x0400,
     /*! Water Leak Sensor */
     Smsgs_dataFields_waterleakSensor = 0x0800,
+    /*! Energy Statistics */
+    Smsgs_dataFields_energyStats = 0x1000,
+    /*! Latency Trace */
+    Smsgs_dataFields_latencyTrace = 0x2000,
+    /*!
+     Not a data field - the data fields use the compact encoding, only
+     valid in a Smsgs_cmdIds_sensorData message
+     */
+    Smsgs_dataFields_compactEncoding = 0x8000,
 } Smsgs_dataFields_t;
 
 /*!
@@ -296,6 +499,19 @@ typedef enum
     Smsgs_statusValues_partialSuccess = 2,
 } Smsgs_statusValues_t;
 
+/*!
+ Status of a device in an OAD Status Response
+ */
+typedef enum
+{
+    /*! Wants the image and is missing blocks */
+    Smsgs_oadStatus_receiving = 0,
+    /*! Has every block of the image */
+    Smsgs_oadStatus_complete = 1,
+    /*! Doesn't want the image */
+    Smsgs_oadStatus_declined = 2
+} Smsgs_oadStatus_t;
+
 /******************************************************************************
  Structures - Building blocks for the over-the-air sensor messages
  *****************************************************************************/
@@ -313,6 +529,8 @@ typedef struct _Smsgs_configreqmsg_t
     uint32_t reportingInterval;
     /*! Polling Interval */
     uint32_t pollingInterval;
+    /*! Fast Polling Interval, 0 if not used */
+    uint32_t fastPollingInterval;
 } Smsgs_configReqMsg_t;
 
 /*!
@@ -556,8 +774,63 @@ typedef struct _Smsgs_msgstatsfield_t
     uint16_t joinTime;
     /*! Delay between sending a packet and receiving an ack */
     uint16_t interimDelay;
+    /*!
+     Number of broadcast messages received from the collector
+     */
+    uint16_t numBroadcastMsgRcvd;
+    /*!
+    Number of broadcast messages missed from the collector
+    */
+    uint16_t numBroadcastMsglost;
+    /*!
+    Average end to end delay
+    */
+    uint16_t avgE2EDelay;
+    /*!
+    Worst Case end to end delay
+    */
+    uint16_t worstCaseE2EDelay;
 } Smsgs_msgStatsField_t;
 
+/*!
+ Energy Statistics Field - radio and MCU usage of the sensor during the
+ last reporting period, used to estimate the battery life.
+ */
+typedef struct _Smsgs_energystatsfield_t
+{
+    /*! Length of the accounting period in milliseconds */
+    uint32_t periodTime;
+    /*! Estimated radio transmit time in microseconds */
+    uint32_t txTime;
+    /*! Estimated radio receive time in microseconds */
+    uint32_t rxTime;
+    /*! Application MCU active time in microseconds */
+    uint32_t activeTime;
+    /*! Frames transmitted, including retries and polls */
+    uint16_t txFrames;
+    /*! MAC retries of transmitted data frames */
+    uint16_t retries;
+    /*! Busy clear channel assessments, estimated */
+    uint16_t csmaBackoffs;
+    /*! Data requests (polls) sent */
+    uint16_t polls;
+    /*! Network scans started */
+    uint16_t scans;
+} Smsgs_energyStatsField_t;
+
+/*!
+ Latency Trace Field - used to follow a report from the sensor to the cloud
+ */
+typedef struct _Smsgs_latencytracefield_t
+{
+    /*! Incremented for every report */
+    uint16_t traceId;
+    /*! Sensor time the report was built, in milliseconds */
+    uint32_t timestamp;
+    /*! Delivery delay of the previous report in milliseconds, 0 if unknown */
+    uint16_t radioDelay;
+} Smsgs_latencyTraceField_t;
+
 /*!
  Message Statistics Field
  */
@@ -647,6 +920,21 @@ typedef struct _Smsgs_sensormsg_t
      is set in frameControl.
      */
     Smsgs_waterleakSensorField_t waterleakSensor;
+    /*!
+     Energy Statistics field - valid only if Smsgs_dataFields_energyStats
+     is set in frameControl.
+     */
+    Smsgs_energyStatsField_t energyStats;
+    /*!
+     Latency Trace field - valid only if Smsgs_dataFields_latencyTrace
+     is set in frameControl.
+     */
+    Smsgs_latencyTraceField_t latencyTrace;
+    /*!
+     Sample age in milliseconds - only set for samples parsed from a
+     Smsgs_cmdIds_sensorDataBatch message, 0 otherwise.
+     */
+    uint32_t sampleAge;
 } Smsgs_sensorMsg_t;
 
 
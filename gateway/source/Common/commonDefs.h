@@ -68,6 +68,12 @@ extern "C"
 //USER DEFS
 #define MAX_NUM_OF_DEVICES      25
 #define MAX_NUM_OF_OBJECTS      15
+#define MAX_NUM_OF_GROUPS       8
+#define MAX_GROUP_MEMBERS       32
+//groupId of the group of every associated device
+#define GROUP_ID_ALL            0xFF
+//longest URL of an OAD image, with the NUL
+#define MAX_OAD_URL_LEN         128
 
 #define SL_TASK_PRI             6
 #define GTWAY_TASK_PRI          5
@@ -75,6 +81,8 @@ extern "C"
 #define COLLECTOR_TASK_PRI      3
 #define CLOUDSRV_TASK_PRI       3
 #define CLOUDRX_TASK_PRI        6
+#define OAD_SERVER_TASK_PRI     2
+#define LOG_TASK_PRI            1
 #define HIGHEST_PRI             6
 
 //IPSO DEFS
@@ -90,6 +98,7 @@ extern "C"
 #define ACTUATOR_TYPE       "actuation"
 #define FAN_TYPE            "fan"
 #define DOOR_LOCK_TYPE      "doorlock"
+#define BATT_LIFE_TYPE      "batterylife"
 #define TIME_STAMP          "last_reported"
 #define MAX_TYPE_CHAR_LEN   18
 
@@ -106,6 +115,7 @@ extern "C"
 #define GATEWAY_MQ      "gatewayMq"
 #define CLOUDSERVICE_MQ "clousServiceMq"
 #define MT_SRSP_MQ      "mtSrspMq"
+#define OAD_SERVER_MQ   "oadServerMq"
 
 #define MQ_HIGH_PRIOR    1
 #define MQ_LOW_PRIOR     0
@@ -137,7 +147,8 @@ typedef enum
     CollectorEvent_SEND_SNSR_CMD,
     CollectorEvent_PERMIT_JOIN,
     CollectorEvent_RESET_COP,
-    CollectorEvent_INIT_COP
+    CollectorEvent_INIT_COP,
+    CollectorEvent_OAD_IMAGE
 
 }CollectorEvent;
 // MT_EVENTS
@@ -201,6 +212,7 @@ typedef struct
     uint8_t     event;
     void        *msgPtr;
     int32_t     msgPtrLen;
+    uint32_t    timestamp; //Latency_stamp() when sent, see Utils/latency.h
 }msgQueue_t;
 
 typedef struct nwk_t
@@ -219,9 +231,9 @@ typedef struct nwk_t
 typedef struct smartObject_t
 {
     int typeId;
-    char type[MAX_TYPE_CHAR_LEN];
+    const char *type; //constant string, not copied
     int sensorVal;
-    char unit[7];
+    const char *unit; //constant string, not copied
 }smartObject_t;
 
 typedef struct dev_t
@@ -249,7 +261,9 @@ typedef enum
     CmdType_FAN_DATA,
     CmdType_DOORLOCK_DATA,
     CmdType_LED_DATA,
-    CmdType_LEAK_DATA
+    CmdType_LEAK_DATA,
+    CmdType_GROUP_DEFINE,
+    CmdType_OAD_START
 }CmdTypes;
 
 typedef struct
@@ -258,6 +272,10 @@ typedef struct
     uint16_t shortAddr;
     uint8_t  extAddr[8];
     uint32_t data;
+    uint8_t  groupId; //0 if the command is for the device at shortAddr
+    uint8_t  numMembers; //members of a CmdType_GROUP_DEFINE
+    uint16_t members[MAX_GROUP_MEMBERS];
+    char     url[MAX_OAD_URL_LEN]; //image of a CmdType_OAD_START, "" to stop
 }deviceCmd_t;
 
 
@@ -43,6 +43,9 @@
  Release Name:
  Release Date:
  *****************************************************************************/
+/* Console prints of this file, see Utils/uart_term.h */
+#define LOG_MODULE TermLog_module_gateway
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -55,11 +58,14 @@
 #include <Utils/util.h>
 #include <Board.h>
 #include <Utils/uart_term.h>
+#include <Utils/latency.h>
 #include <CloudService/cloud_service.h>
 #include <NPI/npi.h>
 #include <Collector/collector.h>
 #include "gtwayJson.h"
 #include "provisioning.h"
+#include "oadServer.h"
+#include "history.h"
 #include "gateway.h"
 
 
@@ -121,6 +127,8 @@ void gatewayInit()
     cloudServiceInit(CLOUDSERVICE_MQ);
     cloudServiceCliMqReg(GATEWAY_MQ);
     collectorInit(COLLECTOR_MQ);
+    oadServerInit(COLLECTOR_MQ);
+    History_init();
 
 
     npiCliMqReg(COLLECTOR_MQ);
@@ -214,6 +222,7 @@ void *gatewayMainThread(void *pvParameters)
 
     nwk_t *tempNwk;
     dev_t *tempDev;
+    int devIdx;
 
     deviceCmd_t *tempDevCmd;
     permitJoinCmd_t *tempPermitJoinCmd;
@@ -329,11 +338,23 @@ void *gatewayMainThread(void *pvParameters)
             UART_PRINT("\n\r");
             sprintf(tempDev->name, "0x%04x", tempDev->shortAddr);
 
-            tmpBuff =  formatDevJson(&devList[listDevUpdate(tempDev)], currentTimeStr);
+            devIdx = listDevUpdate(tempDev);
+            if(incomingMsg.event == GatewayEvent_SENSOR_DATA_UPDATE)
+            {
+                History_record(&devList[devIdx]);
+            }
+
+            tmpBuff =  formatDevJson(&devList[devIdx], currentTimeStr);
             //SEND DATA TO CLOUD TASK
             queueElementSend.event = CloudServiceEvt_DEV_UPDATE;
             queueElementSend.msgPtr = tmpBuff;
             queueElementSend.msgPtrLen = strlen(tmpBuff) + 1;
+            queueElementSend.timestamp = LATENCY_NO_STAMP;
+            if(incomingMsg.event == GatewayEvent_SENSOR_DATA_UPDATE)
+            {
+                Latency_recordSince(Latency_stage_gateway, incomingMsg.timestamp);
+                queueElementSend.timestamp = Latency_stamp();
+            }
             mq_send(gatewayCloudMq, (char*) &queueElementSend, sizeof(msgQueue_t), 0);
             break;
 
@@ -391,10 +412,22 @@ void *gatewayMainThread(void *pvParameters)
             break;
 
         case GatewayEvent_DEVICE_CMD:
+            /* The image is fetched first, the collector is told when it is
+               stored */
+            if(((deviceCmd_t*)incomingMsg.msgPtr)->cmdType == CmdType_OAD_START)
+            {
+                if(!OadServer_fetch(((deviceCmd_t*)incomingMsg.msgPtr)->url))
+                {
+                    UART_PRINT("[Gateway Task] OAD fetch already queued\n\r");
+                }
+                break;
+            }
+
             tempDevCmd = (deviceCmd_t*) malloc(sizeof(deviceCmd_t));
 
-            tempDevCmd->shortAddr = ((deviceCmd_t*)incomingMsg.msgPtr)->shortAddr;
-            if(tempDevCmd->shortAddr == 0xFFFF)
+            /* Group commands and definitions go to the collector as they are */
+            memcpy(tempDevCmd, incomingMsg.msgPtr, sizeof(deviceCmd_t));
+            if((tempDevCmd->groupId == 0) && (tempDevCmd->shortAddr == 0xFFFF))
             {
                 int devIdx = devSearchExt(((deviceCmd_t*)incomingMsg.msgPtr)->extAddr);
                 if(devIdx != -1)
@@ -402,8 +435,6 @@ void *gatewayMainThread(void *pvParameters)
                     tempDevCmd->shortAddr = devList[devIdx].shortAddr;
                 }
             }
-            tempDevCmd->data = ((deviceCmd_t*)incomingMsg.msgPtr)->data;
-            tempDevCmd->cmdType = ((deviceCmd_t*)incomingMsg.msgPtr)->cmdType;
             queueElementSend.event = CollectorEvent_SEND_SNSR_CMD;
             queueElementSend.msgPtr = tempDevCmd;
             mq_send(gatewayCollectorMq, (char*) &queueElementSend, sizeof(msgQueue_t), 0);
@@ -0,0 +1,1059 @@
+/******************************************************************************
+
+ @file history.c
+
+ @brief Store of the recent sensor readings, for the local web page
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <ti/drivers/net/wifi/simplelink.h>
+#include <Common/commonDefs.h>
+#include <Utils/uart_term.h>
+#include "history.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*! Length of an hour of readings, in seconds */
+#define HISTORY_SEGMENT_TIME    3600
+
+/*! Hours kept, a day and the hours at either end of it */
+#define HISTORY_NUM_SEGMENTS    26
+
+/*! Time between checkpoints of the hour being filled, in seconds */
+#define HISTORY_CHECKPOINT_INTERVAL 600
+
+/*! Blocks of an hour, about 40 readings of 150 objects */
+#define HISTORY_NUM_BLOCKS      256
+
+/*! Length of a block */
+#define HISTORY_BLOCK_LEN       128
+
+/*! Length of the header of a block */
+#define HISTORY_BLOCK_HDR_LEN   28
+
+/*!
+ Objects of all devices an hour holds, 25 devices of up to 7.  Fewer than
+ the MAX_NUM_OF_DEVICES * MAX_NUM_OF_OBJECTS the device list can have, as
+ each needs a block of its own and RAM limits HISTORY_NUM_BLOCKS.  Readings
+ of the objects past these are dropped, and logged once an hour.
+ */
+#define HISTORY_MAX_SERIES      192
+
+/*! Earliest time taken as set, in 2017 */
+#define HISTORY_MIN_TIME        1483228800UL
+
+/*! Marks a file written by this version */
+#define HISTORY_MAGIC           0x48535431UL
+
+/*! Series without a block being filled */
+#define HISTORY_NO_BLOCK        0xFFFF
+
+/*! Name of the file of an hour, by its number modulo HISTORY_NUM_SEGMENTS */
+#define HISTORY_FILE_FORMAT     "/history/seg%02u.bin"
+
+/*! Number of codes of a number, see timeBits and valueBits */
+#define NUM_CODES               5
+
+/*! Longest line of the JSON */
+#define LINE_LEN                64
+
+/*! Blocks read from a file at a time */
+#define READ_BLOCKS             8
+
+/*! Series read from a file at a time, into the same buffer */
+#define READ_SERIES \
+    ((READ_BLOCKS * sizeof(History_block_t)) / sizeof(History_series_t))
+
+/*! An object of a device, with readings in the hour */
+typedef struct
+{
+    /*! Extended address of the device */
+    uint8_t extAddr[8];
+    /*! Short address of the device when it last reported */
+    uint16_t shortAddr;
+    /*! Block being filled, HISTORY_NO_BLOCK if none */
+    uint16_t openBlock;
+    /*! Nth object of the type the device has */
+    uint8_t occurrence;
+    /*! Type of the object */
+    char type[MAX_TYPE_CHAR_LEN];
+} History_series_t;
+
+/*! Header of an hour, at the start of its file */
+typedef struct
+{
+    /*! HISTORY_MAGIC */
+    uint32_t magic;
+    /*! Number of the hour, counting up */
+    uint32_t seq;
+    /*! Time of the first reading */
+    uint32_t start;
+    /*! Time of the last reading */
+    uint32_t end;
+    /*! Series used */
+    uint16_t numSeries;
+    /*! Blocks used */
+    uint16_t numBlocks;
+    /*! The series */
+    History_series_t series[HISTORY_MAX_SERIES];
+} History_segment_t;
+
+/*! Readings of a series, after the first one encoded as codes */
+typedef struct
+{
+    /*! Index of the series in its hour */
+    uint16_t series;
+    /*! Number of readings */
+    uint16_t count;
+    /*! Bits of data used */
+    uint16_t numBits;
+    uint16_t reserved;
+    /*! Time of the first reading */
+    uint32_t firstTime;
+    /*! First reading */
+    int32_t firstValue;
+    /*! Time of the last reading */
+    uint32_t lastTime;
+    /*! Time between the last two readings */
+    int32_t lastDelta;
+    /*! Last reading */
+    int32_t lastValue;
+    /*! Codes of the following readings, most significant bit first */
+    uint8_t data[HISTORY_BLOCK_LEN - HISTORY_BLOCK_HDR_LEN];
+} History_block_t;
+
+/*! Position in the data of a block being decoded */
+typedef struct
+{
+    const uint8_t *pData;
+    uint16_t pos;
+} reader_t;
+
+/*! Position in the JSON being formatted */
+typedef struct
+{
+    char *pBuf;
+    uint32_t bufLen;
+    /*! Offset in the text of pBuf[0] */
+    uint32_t offset;
+    /*! Length of the text so far */
+    uint32_t pos;
+} text_t;
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+/*!
+ Bits of the nth code of the change of the interval between readings.
+ Code n is sent as n one bits and a zero bit, the last code as ones only,
+ then the zigzag encoded number in its bits.
+ */
+static const uint8_t timeBits[NUM_CODES] = {0, 7, 9, 12, 32};
+
+/*! Bits of the nth code of the change of the value, as timeBits */
+static const uint8_t valueBits[NUM_CODES] = {0, 4, 8, 16, 32};
+
+/*! Held while the hour is used or its file written */
+static pthread_mutex_t historyMutex;
+
+/*! Held while a query uses readBlocks, the files are read without
+    historyMutex */
+static pthread_mutex_t queryMutex;
+
+/*! true once the last hour was read back from its file */
+static bool restored = false;
+
+/*! The hour being filled */
+static History_segment_t seg;
+static History_block_t blocks[HISTORY_NUM_BLOCKS];
+
+/*! Time of the last checkpoint */
+static uint32_t checkpointTime = 0;
+
+/*! Number of the newest hour written to its file */
+static uint32_t writtenSeq = 0;
+
+/*! Readings dropped in the hour for want of a series */
+static uint32_t numDropped = 0;
+
+/*! Kept off the stack of the web server task */
+static History_block_t readBlocks[READ_BLOCKS];
+
+/******************************************************************************
+ Local function prototypes
+ *****************************************************************************/
+
+static void restore(void);
+static void startSegment(uint32_t seq, uint32_t now);
+static bool writeSegment(void);
+static bool fileKept(uint32_t seq);
+static History_series_t *getSeries(const dev_t *pDev, uint8_t objIdx);
+static bool addReading(uint16_t seriesIdx, uint32_t now, int32_t value);
+static uint8_t codeLen(const uint8_t *pBits, uint32_t n, uint8_t *pCode);
+static void putBits(History_block_t *pBlock, uint32_t value, uint8_t numBits);
+static uint32_t getBits(reader_t *pReader, uint8_t numBits);
+static uint32_t zigZag(int32_t n);
+static int32_t unZigZag(uint32_t n);
+static uint16_t matchSeries(const History_series_t *pSeries, uint16_t num,
+                            uint16_t first, const uint8_t *pExtAddr,
+                            uint16_t shortAddr, const char *pType,
+                            int8_t *pMatch);
+static void addBlock(const History_block_t *pBlock, const int8_t *pMatch,
+                     History_result_t *pResult);
+static void addPoint(History_result_t *pResult, uint8_t series,
+                     uint32_t readingTime, int32_t value);
+static void print(text_t *pText, const char *pFormat, ...);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Initialize the store.
+
+ Public function defined in history.h
+ */
+void History_init(void)
+{
+    pthread_mutexattr_t mutexAttrs;
+
+    pthread_mutexattr_init(&mutexAttrs);
+    pthread_mutexattr_setprotocol(&mutexAttrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&historyMutex, &mutexAttrs);
+    pthread_mutex_init(&queryMutex, &mutexAttrs);
+}
+
+/*!
+ Add the readings of a device's objects.
+
+ Public function defined in history.h
+ */
+void History_record(const dev_t *pDev)
+{
+    uint32_t now = (uint32_t)time(NULL);
+    uint8_t i;
+
+    if(now < HISTORY_MIN_TIME)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&historyMutex);
+    restore();
+
+    /* Start the next hour when this one is over, or the clock went back */
+    if((seg.numSeries > 0) &&
+       ((now < seg.end) || ((now - seg.start) >= HISTORY_SEGMENT_TIME)))
+    {
+        writeSegment();
+        startSegment(seg.seq + 1, now);
+    }
+    if(seg.numSeries == 0)
+    {
+        seg.start = now;
+    }
+
+    for(i = 0; i < pDev->objectCount; i++)
+    {
+        History_series_t *pSeries = getSeries(pDev, i);
+
+        /* Objects past the ones an hour holds aren't kept */
+        if(pSeries == NULL)
+        {
+            if(numDropped++ == 0)
+            {
+                UART_PRINT("[History] Hour %u is full, %s of 0x%04x and "
+                           "any more objects not kept\n\r",
+                           (unsigned int)seg.seq, pDev->object[i].type,
+                           pDev->shortAddr);
+            }
+            continue;
+        }
+
+        /* An hour with no blocks left ends early */
+        if(!addReading(pSeries - seg.series, now, pDev->object[i].sensorVal))
+        {
+            writeSegment();
+            startSegment(seg.seq + 1, now);
+
+            pSeries = getSeries(pDev, i);
+            addReading(pSeries - seg.series, now, pDev->object[i].sensorVal);
+        }
+    }
+    seg.end = now;
+
+    if((now - checkpointTime) >= HISTORY_CHECKPOINT_INTERVAL)
+    {
+        writeSegment();
+    }
+
+    pthread_mutex_unlock(&historyMutex);
+}
+
+/*!
+ Get the readings of the objects of a type of a device.
+
+ Public function defined in history.h
+ */
+bool History_query(const uint8_t *pExtAddr, uint16_t shortAddr,
+                   const char *pType, uint32_t from, uint32_t to,
+                   uint16_t numPoints, History_result_t *pResult)
+{
+    int8_t match[HISTORY_MAX_SERIES];
+    uint32_t newest;
+    uint32_t end;
+    uint32_t k;
+
+    if((numPoints == 0) || (numPoints > HISTORY_MAX_POINTS) || (to <= from))
+    {
+        return(false);
+    }
+
+    memset(pResult, 0, sizeof(History_result_t));
+    pResult->from = from;
+    pResult->step = ((to - from) + numPoints - 1) / numPoints;
+    pResult->numPoints = numPoints;
+    end = from + (pResult->step * numPoints);
+
+    /* The hour in RAM, under the lock as it is being filled */
+    pthread_mutex_lock(&historyMutex);
+    restore();
+    newest = seg.seq;
+    if((seg.numSeries > 0) && (seg.end >= from) && (seg.start < end) &&
+       (matchSeries(seg.series, seg.numSeries, 0, pExtAddr, shortAddr, pType,
+                    match) > 0))
+    {
+        for(k = 0; k < seg.numBlocks; k++)
+        {
+            addBlock(&blocks[k], match, pResult);
+        }
+    }
+    pthread_mutex_unlock(&historyMutex);
+
+    /* Then the files from the newest, without holding up the readings */
+    pthread_mutex_lock(&queryMutex);
+    for(k = 1; (k < HISTORY_NUM_SEGMENTS) && (k <= newest); k++)
+    {
+        uint32_t seq = newest - k;
+        History_segment_t hdr;
+        char fileName[SL_FS_MAX_FILE_NAME_LENGTH];
+        int32_t fsHandle;
+        uint16_t i;
+
+        memset(match, -1, sizeof(match));
+        snprintf(fileName, sizeof(fileName), HISTORY_FILE_FORMAT,
+                 (unsigned int)(seq % HISTORY_NUM_SEGMENTS));
+        fsHandle = sl_FsOpen((unsigned char *)fileName, SL_FS_READ, NULL);
+        if(fsHandle < 0)
+        {
+            continue;
+        }
+
+        /* The header up to the series, then the series a chunk at a time */
+        if((sl_FsRead(fsHandle, 0, (unsigned char *)&hdr,
+                      offsetof(History_segment_t, series)) ==
+            offsetof(History_segment_t, series)) &&
+           (hdr.magic == HISTORY_MAGIC) && (hdr.seq == seq) &&
+           (hdr.numSeries <= HISTORY_MAX_SERIES) &&
+           (hdr.numBlocks <= HISTORY_NUM_BLOCKS) &&
+           (hdr.end >= from) && (hdr.start < end))
+        {
+            uint16_t numMatched = 0;
+            uint16_t num;
+
+            for(i = 0; i < hdr.numSeries; i += num)
+            {
+                num = hdr.numSeries - i;
+                if(num > READ_SERIES)
+                {
+                    num = READ_SERIES;
+                }
+                if(sl_FsRead(fsHandle,
+                             offsetof(History_segment_t, series) +
+                             (i * sizeof(History_series_t)),
+                             (unsigned char *)readBlocks,
+                             num * sizeof(History_series_t)) !=
+                   (int32_t)(num * sizeof(History_series_t)))
+                {
+                    break;
+                }
+                numMatched += matchSeries((History_series_t *)readBlocks, num,
+                                          i, pExtAddr, shortAddr, pType,
+                                          match);
+            }
+            if(!fileKept(seq))
+            {
+                numMatched = 0;
+            }
+
+            for(i = 0; (numMatched > 0) && (i < hdr.numBlocks); i += num)
+            {
+                uint16_t j;
+
+                num = hdr.numBlocks - i;
+                if(num > READ_BLOCKS)
+                {
+                    num = READ_BLOCKS;
+                }
+                if(sl_FsRead(fsHandle,
+                             sizeof(History_segment_t) +
+                             (i * sizeof(History_block_t)),
+                             (unsigned char *)readBlocks,
+                             num * sizeof(History_block_t)) !=
+                   (int32_t)(num * sizeof(History_block_t)))
+                {
+                    break;
+                }
+                if(!fileKept(seq))
+                {
+                    /* Overwritten by a newer hour while being read */
+                    break;
+                }
+                for(j = 0; j < num; j++)
+                {
+                    if(readBlocks[j].series < hdr.numSeries)
+                    {
+                        addBlock(&readBlocks[j], match, pResult);
+                    }
+                }
+            }
+        }
+
+        sl_FsClose(fsHandle, NULL, 0, 0);
+    }
+    pthread_mutex_unlock(&queryMutex);
+
+    return(pResult->numSeries > 0);
+}
+
+/*!
+ Format part of the JSON of a query result.
+
+ Public function defined in history.h
+ */
+uint32_t History_formatJson(const History_result_t *pResult,
+                            char *pBuf, uint32_t bufLen, uint32_t offset)
+{
+    text_t text;
+    uint8_t s;
+    uint16_t i;
+
+    text.pBuf = pBuf;
+    text.bufLen = bufLen;
+    text.offset = offset;
+    text.pos = 0;
+
+    print(&text, "{\"from\": %u, \"step\": %u, \"series\": [",
+          (unsigned int)pResult->from, (unsigned int)pResult->step);
+    for(s = 0; s < pResult->numSeries; s++)
+    {
+        const char *pSep = "";
+
+        print(&text, (s == 0) ? "[" : ", [");
+        for(i = 0; i < pResult->numPoints; i++)
+        {
+            const History_point_t *pPoint = &pResult->points[s][i];
+
+            if(pPoint->count > 0)
+            {
+                print(&text, "%s[%u, %ld, %ld, %ld]", pSep,
+                      (unsigned int)(pResult->from + (i * pResult->step)),
+                      (long)(pPoint->sum / pPoint->count),
+                      (long)pPoint->min, (long)pPoint->max);
+                pSep = ", ";
+            }
+        }
+        print(&text, "]");
+    }
+    print(&text, "]}");
+
+    return(text.pos);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief   Read back the newest hour, the first time the store is used.
+ */
+static void restore(void)
+{
+    History_segment_t hdr;
+    char fileName[SL_FS_MAX_FILE_NAME_LENGTH];
+    int32_t fsHandle;
+    int32_t newest = -1;
+    uint32_t seq = 0;
+    uint8_t i;
+
+    if(restored)
+    {
+        return;
+    }
+    restored = true;
+    startSegment(0, 0);
+
+    for(i = 0; i < HISTORY_NUM_SEGMENTS; i++)
+    {
+        snprintf(fileName, sizeof(fileName), HISTORY_FILE_FORMAT,
+                 (unsigned int)i);
+        fsHandle = sl_FsOpen((unsigned char *)fileName, SL_FS_READ, NULL);
+        if(fsHandle < 0)
+        {
+            continue;
+        }
+        if((sl_FsRead(fsHandle, 0, (unsigned char *)&hdr,
+                      offsetof(History_segment_t, series)) ==
+            offsetof(History_segment_t, series)) &&
+           (hdr.magic == HISTORY_MAGIC) &&
+           ((hdr.seq % HISTORY_NUM_SEGMENTS) == i) &&
+           ((newest < 0) || (hdr.seq > seq)))
+        {
+            newest = i;
+            seq = hdr.seq;
+        }
+        sl_FsClose(fsHandle, NULL, 0, 0);
+    }
+
+    if(newest < 0)
+    {
+        return;
+    }
+    writtenSeq = seq;
+
+    snprintf(fileName, sizeof(fileName), HISTORY_FILE_FORMAT,
+             (unsigned int)newest);
+    fsHandle = sl_FsOpen((unsigned char *)fileName, SL_FS_READ, NULL);
+    if(fsHandle >= 0)
+    {
+        if((sl_FsRead(fsHandle, 0, (unsigned char *)&seg, sizeof(seg)) !=
+            sizeof(seg)) ||
+           (seg.numSeries > HISTORY_MAX_SERIES) ||
+           (seg.numBlocks > HISTORY_NUM_BLOCKS) ||
+           (sl_FsRead(fsHandle, sizeof(seg), (unsigned char *)blocks,
+                      seg.numBlocks * sizeof(History_block_t)) !=
+            (int32_t)(seg.numBlocks * sizeof(History_block_t))))
+        {
+            /* Don't add to a broken hour, start the next one */
+            startSegment(seq + 1, 0);
+        }
+        sl_FsClose(fsHandle, NULL, 0, 0);
+    }
+
+    UART_PRINT("[History] Hour %u read back, %d objects\n\r",
+               (unsigned int)seg.seq, seg.numSeries);
+}
+
+/*!
+ * @brief   Start an empty hour.
+ *
+ * @param   seq - number of the hour
+ * @param   now - current time
+ */
+static void startSegment(uint32_t seq, uint32_t now)
+{
+    if(numDropped > 1)
+    {
+        UART_PRINT("[History] Hour %u was full, %u readings not kept\n\r",
+                   (unsigned int)seg.seq, (unsigned int)numDropped);
+    }
+    numDropped = 0;
+
+    memset(&seg, 0, offsetof(History_segment_t, series));
+    seg.magic = HISTORY_MAGIC;
+    seg.seq = seq;
+    seg.start = now;
+    seg.end = now;
+}
+
+/*!
+ * @brief   Write the hour to its file, over the hour of a day ago.
+ *
+ * @return  true if written
+ */
+static bool writeSegment(void)
+{
+    char fileName[SL_FS_MAX_FILE_NAME_LENGTH];
+    uint32_t len = seg.numBlocks * sizeof(History_block_t);
+    int32_t fsHandle;
+    bool written = false;
+
+    checkpointTime = seg.end;
+    writtenSeq = seg.seq;
+
+    snprintf(fileName, sizeof(fileName), HISTORY_FILE_FORMAT,
+             (unsigned int)(seg.seq % HISTORY_NUM_SEGMENTS));
+    fsHandle = sl_FsOpen((unsigned char *)fileName,
+                         SL_FS_CREATE | SL_FS_OVERWRITE |
+                         SL_FS_CREATE_MAX_SIZE(sizeof(seg) + sizeof(blocks)),
+                         NULL);
+    if(fsHandle < 0)
+    {
+        UART_PRINT("[History] Can't open %s: %d\n\r", fileName, fsHandle);
+        return(false);
+    }
+
+    if((sl_FsWrite(fsHandle, 0, (unsigned char *)&seg, sizeof(seg)) ==
+        sizeof(seg)) &&
+       ((len == 0) ||
+        (sl_FsWrite(fsHandle, sizeof(seg), (unsigned char *)blocks, len) ==
+         (int32_t)len)))
+    {
+        written = true;
+    }
+    else
+    {
+        UART_PRINT("[History] Can't write %s\n\r", fileName);
+    }
+    sl_FsClose(fsHandle, NULL, 0, 0);
+
+    return(written);
+}
+
+/*!
+ * @brief   Check that the file of an hour still holds it.  writtenSeq is
+ *          set before a file is written, so data read before this returns
+ *          true is that hour's.
+ *
+ * @param   seq - number of the hour
+ *
+ * @return  true if not written over yet
+ */
+static bool fileKept(uint32_t seq)
+{
+    bool kept;
+
+    pthread_mutex_lock(&historyMutex);
+    kept = ((writtenSeq - seq) < HISTORY_NUM_SEGMENTS);
+    pthread_mutex_unlock(&historyMutex);
+
+    return(kept);
+}
+
+/*!
+ * @brief   Find the series of an object of a device in the hour, or add
+ *          it.
+ *
+ * @param   pDev - the device
+ * @param   objIdx - index of the object
+ *
+ * @return  the series, NULL if the hour has no room for another
+ */
+static History_series_t *getSeries(const dev_t *pDev, uint8_t objIdx)
+{
+    const char *pType = pDev->object[objIdx].type;
+    History_series_t *pSeries;
+    uint8_t occurrence = 0;
+    uint16_t i;
+
+    for(i = 0; i < objIdx; i++)
+    {
+        if(strcmp(pDev->object[i].type, pType) == 0)
+        {
+            occurrence++;
+        }
+    }
+
+    for(i = 0; i < seg.numSeries; i++)
+    {
+        pSeries = &seg.series[i];
+        if((memcmp(pSeries->extAddr, pDev->extAddr, 8) == 0) &&
+           (pSeries->occurrence == occurrence) &&
+           (strcmp(pSeries->type, pType) == 0))
+        {
+            pSeries->shortAddr = pDev->shortAddr;
+            return(pSeries);
+        }
+    }
+
+    if(seg.numSeries >= HISTORY_MAX_SERIES)
+    {
+        return(NULL);
+    }
+
+    pSeries = &seg.series[seg.numSeries++];
+    memcpy(pSeries->extAddr, pDev->extAddr, 8);
+    pSeries->shortAddr = pDev->shortAddr;
+    pSeries->openBlock = HISTORY_NO_BLOCK;
+    pSeries->occurrence = occurrence;
+    strncpy(pSeries->type, pType, MAX_TYPE_CHAR_LEN - 1);
+    pSeries->type[MAX_TYPE_CHAR_LEN - 1] = '\0';
+
+    return(pSeries);
+}
+
+/*!
+ * @brief   Add a reading to a series, in a new block when its block is
+ *          full.
+ *
+ * @param   seriesIdx - index of the series
+ * @param   now - time of the reading
+ * @param   value - the reading
+ *
+ * @return  true if added, false if the hour has no block left
+ */
+static bool addReading(uint16_t seriesIdx, uint32_t now, int32_t value)
+{
+    History_series_t *pSeries = &seg.series[seriesIdx];
+    History_block_t *pBlock = NULL;
+
+    if(pSeries->openBlock != HISTORY_NO_BLOCK)
+    {
+        uint8_t timeCode;
+        uint8_t valueCode;
+        int32_t delta;
+        uint32_t timeZz;
+        uint32_t valueZz;
+        uint16_t len;
+
+        pBlock = &blocks[pSeries->openBlock];
+        delta = (int32_t)(now - pBlock->lastTime);
+        timeZz = zigZag(delta - pBlock->lastDelta);
+        valueZz = zigZag((int32_t)((uint32_t)value -
+                                   (uint32_t)pBlock->lastValue));
+
+        len = codeLen(timeBits, timeZz, &timeCode) +
+              codeLen(valueBits, valueZz, &valueCode);
+        if((pBlock->numBits + len) <= (sizeof(pBlock->data) * 8))
+        {
+            putBits(pBlock, (timeCode < (NUM_CODES - 1)) ?
+                            (((1UL << timeCode) - 1) << 1) : 0xF,
+                    (timeCode < (NUM_CODES - 1)) ? (timeCode + 1) : 4);
+            putBits(pBlock, timeZz, timeBits[timeCode]);
+            putBits(pBlock, (valueCode < (NUM_CODES - 1)) ?
+                            (((1UL << valueCode) - 1) << 1) : 0xF,
+                    (valueCode < (NUM_CODES - 1)) ? (valueCode + 1) : 4);
+            putBits(pBlock, valueZz, valueBits[valueCode]);
+
+            pBlock->count++;
+            pBlock->lastTime = now;
+            pBlock->lastDelta = delta;
+            pBlock->lastValue = value;
+            return(true);
+        }
+    }
+
+    /* The first reading of a block goes in its header */
+    if(seg.numBlocks >= HISTORY_NUM_BLOCKS)
+    {
+        return(false);
+    }
+    pSeries->openBlock = seg.numBlocks++;
+    pBlock = &blocks[pSeries->openBlock];
+    memset(pBlock, 0, sizeof(History_block_t));
+    pBlock->series = seriesIdx;
+    pBlock->count = 1;
+    pBlock->firstTime = now;
+    pBlock->firstValue = value;
+    pBlock->lastTime = now;
+    pBlock->lastValue = value;
+
+    return(true);
+}
+
+/*!
+ * @brief   Get the code a number is sent with.
+ *
+ * @param   pBits - bits of the numbers of each code
+ * @param   n - zigzag encoded number
+ * @param   pCode - set to the code
+ *
+ * @return  bits the code and number take
+ */
+static uint8_t codeLen(const uint8_t *pBits, uint32_t n, uint8_t *pCode)
+{
+    uint8_t code = 0;
+
+    while((code < (NUM_CODES - 1)) && (n >= (1UL << pBits[code])))
+    {
+        code++;
+    }
+    *pCode = code;
+
+    return(((code < (NUM_CODES - 1)) ? (code + 1) : code) + pBits[code]);
+}
+
+/*!
+ * @brief   Add bits to the data of a block.
+ *
+ * @param   pBlock - the block, with room for the bits
+ * @param   value - the bits, in the least significant ones
+ * @param   numBits - number of bits
+ */
+static void putBits(History_block_t *pBlock, uint32_t value, uint8_t numBits)
+{
+    while(numBits > 0)
+    {
+        numBits--;
+        if(value & (1UL << numBits))
+        {
+            pBlock->data[pBlock->numBits >> 3] |=
+                (uint8_t)(0x80 >> (pBlock->numBits & 7));
+        }
+        pBlock->numBits++;
+    }
+}
+
+/*!
+ * @brief   Read bits from the data of a block.
+ *
+ * @param   pReader - position in the data
+ * @param   numBits - number of bits
+ *
+ * @return  the bits, in the least significant ones
+ */
+static uint32_t getBits(reader_t *pReader, uint8_t numBits)
+{
+    uint32_t value = 0;
+
+    while(numBits > 0)
+    {
+        numBits--;
+        value = (value << 1) |
+                ((pReader->pData[pReader->pos >> 3] >>
+                  (7 - (pReader->pos & 7))) & 1);
+        pReader->pos++;
+    }
+
+    return(value);
+}
+
+/*!
+ * @brief   Zigzag encode a number, so small negative numbers are small too
+ */
+static uint32_t zigZag(int32_t n)
+{
+    return(((uint32_t)n << 1) ^ (uint32_t)(n >> 31));
+}
+
+/*!
+ * @brief   Decode a zigzag encoded number
+ */
+static int32_t unZigZag(uint32_t n)
+{
+    return((int32_t)(n >> 1) ^ -(int32_t)(n & 1));
+}
+
+/*!
+ * @brief   Find the series of a query among some of the series of an hour.
+ *
+ * @param   pSeries - the series
+ * @param   num - number of them
+ * @param   first - index of the first in the hour
+ * @param   pExtAddr - extended address of the device, or NULL
+ * @param   shortAddr - short address of the device, if pExtAddr is NULL
+ * @param   pType - type of the objects
+ * @param   pMatch - set to the occurrence of each series matched, -1 for
+ *                   the others, by index in the hour
+ *
+ * @return  number matched
+ */
+static uint16_t matchSeries(const History_series_t *pSeries, uint16_t num,
+                            uint16_t first, const uint8_t *pExtAddr,
+                            uint16_t shortAddr, const char *pType,
+                            int8_t *pMatch)
+{
+    uint16_t numMatched = 0;
+    uint16_t i;
+
+    for(i = 0; i < num; i++)
+    {
+        pMatch[first + i] = -1;
+        if(((pExtAddr != NULL) ?
+            (memcmp(pSeries[i].extAddr, pExtAddr, 8) == 0) :
+            (pSeries[i].shortAddr == shortAddr)) &&
+           (pSeries[i].occurrence < HISTORY_MAX_OCCURRENCES) &&
+           (strncmp(pSeries[i].type, pType, MAX_TYPE_CHAR_LEN) == 0))
+        {
+            pMatch[first + i] = pSeries[i].occurrence;
+            numMatched++;
+        }
+    }
+
+    return(numMatched);
+}
+
+/*!
+ * @brief   Add the readings of a block to the query result, if it is of a
+ *          series of the query.
+ *
+ * @param   pBlock - the block
+ * @param   pMatch - occurrence of each series of the hour, -1 if not wanted
+ * @param   pResult - the result
+ */
+static void addBlock(const History_block_t *pBlock, const int8_t *pMatch,
+                     History_result_t *pResult)
+{
+    uint32_t end = pResult->from + (pResult->step * pResult->numPoints);
+    reader_t reader = {pBlock->data, 0};
+    uint32_t readingTime = pBlock->firstTime;
+    int32_t value = pBlock->firstValue;
+    int32_t delta = 0;
+    int8_t series = pMatch[pBlock->series];
+    uint16_t i;
+
+    if((series < 0) || (pBlock->lastTime < pResult->from) ||
+       (pBlock->firstTime >= end))
+    {
+        return;
+    }
+
+    addPoint(pResult, series, readingTime, value);
+    for(i = 1; i < pBlock->count; i++)
+    {
+        uint8_t code = 0;
+
+        while((code < (NUM_CODES - 1)) && getBits(&reader, 1))
+        {
+            code++;
+        }
+        delta += unZigZag(getBits(&reader, timeBits[code]));
+        readingTime += delta;
+
+        code = 0;
+        while((code < (NUM_CODES - 1)) && getBits(&reader, 1))
+        {
+            code++;
+        }
+        value = (int32_t)((uint32_t)value +
+                          (uint32_t)unZigZag(getBits(&reader,
+                                                     valueBits[code])));
+
+        addPoint(pResult, series, readingTime, value);
+    }
+}
+
+/*!
+ * @brief   Add a reading to the point of its time step.
+ *
+ * @param   pResult - the result
+ * @param   series - series of the reading
+ * @param   readingTime - time of the reading
+ * @param   value - the reading
+ */
+static void addPoint(History_result_t *pResult, uint8_t series,
+                     uint32_t readingTime, int32_t value)
+{
+    History_point_t *pPoint;
+    uint32_t i;
+
+    if(readingTime < pResult->from)
+    {
+        return;
+    }
+    i = (readingTime - pResult->from) / pResult->step;
+    if(i >= pResult->numPoints)
+    {
+        return;
+    }
+
+    pPoint = &pResult->points[series][i];
+    if((pPoint->count == 0) || (value < pPoint->min))
+    {
+        pPoint->min = value;
+    }
+    if((pPoint->count == 0) || (value > pPoint->max))
+    {
+        pPoint->max = value;
+    }
+    pPoint->sum += value;
+    pPoint->count++;
+
+    if(series >= pResult->numSeries)
+    {
+        pResult->numSeries = series + 1;
+    }
+}
+
+/*!
+ * @brief   Add a line to the text, copying the part that falls in the
+ *          buffer
+ *
+ * @param   pText - the text
+ * @param   pFormat - printf format of the line
+ */
+static void print(text_t *pText, const char *pFormat, ...)
+{
+    char line[LINE_LEN];
+    va_list args;
+    uint32_t start;
+    uint32_t end;
+    int len;
+
+    va_start(args, pFormat);
+    len = vsnprintf(line, sizeof(line), pFormat, args);
+    va_end(args);
+    if(len < 0)
+    {
+        return;
+    }
+    if(len >= (int)sizeof(line))
+    {
+        len = sizeof(line) - 1;
+    }
+
+    start = (pText->pos > pText->offset) ? pText->pos : pText->offset;
+    end = pText->pos + len;
+    if(end > (pText->offset + pText->bufLen))
+    {
+        end = pText->offset + pText->bufLen;
+    }
+    if(start < end)
+    {
+        memcpy(&pText->pBuf[start - pText->offset],
+               &line[start - pText->pos], end - start);
+    }
+
+    pText->pos += len;
+}
@@ -0,0 +1,183 @@
+/******************************************************************************
+
+ @file history.h
+
+ @brief Store of the recent sensor readings, for the local web page
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+#ifndef HISTORY_H
+#define HISTORY_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <Common/commonDefs.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup History Sensor Reading History
+ <BR>
+ Every reading the gateway gets is kept, so the local web page can show the
+ last day of readings without the cloud.  The readings of an hour are held
+ in RAM as blocks of compressed samples, each block the samples of one
+ object of one device: the time as the change from the last interval and
+ the value as the change from the last value, both in the fewest bits that
+ hold them.  A reading every minute or so takes about two bytes.
+ <BR>
+ The hour is checkpointed to a file of the SimpleLink file system every
+ HISTORY_CHECKPOINT_INTERVAL, and written out a last time when the next
+ hour starts.  The files are reused in turn, so they hold the last
+ HISTORY_NUM_SEGMENTS hours.  An hour also ends early when its blocks run
+ out.  After a reset the last hour is read back and added to.
+ <BR>
+ Readings are only kept once the time is set, by NTP.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup History
+ * @{
+ */
+
+/*! Most points a query returns for each series */
+#define HISTORY_MAX_POINTS 144
+
+/*! Most objects of the same type a device has, e.g. two temperatures */
+#define HISTORY_MAX_OCCURRENCES 2
+
+/*! Readings of one time step of a series */
+typedef struct
+{
+    /*! Sum of the readings */
+    int64_t sum;
+    /*! Smallest reading */
+    int32_t min;
+    /*! Largest reading */
+    int32_t max;
+    /*! Number of readings, 0 if there were none */
+    uint16_t count;
+} History_point_t;
+
+/*! Result of a query */
+typedef struct
+{
+    /*! Start of the first point, seconds since 1970 */
+    uint32_t from;
+    /*! Time step of the points, in seconds */
+    uint32_t step;
+    /*! Number of points */
+    uint16_t numPoints;
+    /*! Number of series, one for each object of the type */
+    uint8_t numSeries;
+    /*! The points of each series */
+    History_point_t points[HISTORY_MAX_OCCURRENCES][HISTORY_MAX_POINTS];
+} History_result_t;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Initialize the store.  The files are read when the first
+ *          reading is added or the first query is made, once the
+ *          SimpleLink device is started.
+ */
+extern void History_init(void);
+
+/*!
+ * @brief   Add the readings of a device's objects, at the current time.
+ *
+ * @param   pDev - the device, as it is in the device list
+ */
+extern void History_record(const dev_t *pDev);
+
+/*!
+ * @brief   Get the readings of the objects of a type of a device, in
+ *          equal time steps.
+ *
+ * @param   pExtAddr - extended address of the device, NULL to find it by
+ *                     its short address
+ * @param   shortAddr - short address of the device, if pExtAddr is NULL
+ * @param   pType - type of the objects, e.g. TEMP_TYPE
+ * @param   from - start time, seconds since 1970
+ * @param   to - end time, seconds since 1970
+ * @param   numPoints - number of time steps, 1 to HISTORY_MAX_POINTS
+ * @param   pResult - filled in with the readings
+ *
+ * @return  true if the device had objects of the type
+ */
+extern bool History_query(const uint8_t *pExtAddr, uint16_t shortAddr,
+                          const char *pType, uint32_t from, uint32_t to,
+                          uint16_t numPoints, History_result_t *pResult);
+
+/*!
+ * @brief   Format part of the JSON of a query result, for sending it in
+ *          pieces.  Each series is a list of [time, average, min, max],
+ *          without the time steps that have no readings.
+ *
+ * @param   pResult - the query result
+ * @param   pBuf - where to put the text, may be NULL with bufLen 0
+ * @param   bufLen - size of pBuf
+ * @param   offset - offset in the text of the first byte wanted
+ *
+ * @return  length of the whole text
+ */
+extern uint32_t History_formatJson(const History_result_t *pResult,
+                                   char *pBuf, uint32_t bufLen,
+                                   uint32_t offset);
+
+/*! @} end group History */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HISTORY_H */
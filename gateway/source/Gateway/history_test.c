@@ -0,0 +1,626 @@
+/******************************************************************************
+
+ @file history_test.c
+
+ @brief Host test and benchmark of the sensor reading history
+
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+
+ Runs history.c over files in a host folder, with the time faked.
+
+   history_test [<folder>]
+
+ The folder (default /tmp/history_test) must exist, its seg*.bin files are
+ written over.  The test
+   - records 26 hours of readings of 25 devices and checks a day's query of
+     one object against the readings it was given, bucket by bucket,
+   - records with one thread while another queries, then records from
+     inside the file reads of queries, so hours start and files are written
+     over while a query reads them.  The value of every reading is its time
+     and device, so a point from a file written over while it was read
+     shows up as a value of another device or outside its time step,
+   - records more objects than an hour holds and checks the drop is logged
+     once an hour,
+ and prints the time per History_record() and per day's query.
+
+ Built on a host only, from gateway/source, e.g.
+   gcc -std=c99 -D_POSIX_C_SOURCE=200112L -DHISTORY_HOST
+       -DFEATURE_MAC_SECURITY -Dtime=testTime -I Gateway/host
+       -iquote . -iquote Collector -I . -o history_test
+       Gateway/history_test.c Gateway/history.c -lpthread
+ where Gateway/host stands in for simplelink.h, declaring the sl_Fs
+ functions and SL_FS_ flags history.c uses, ti/drivers/UART.h and Board.h.
+ time is renamed so the test sets it.
+ *****************************************************************************/
+
+/* Host builds only; the project compiles this file for the device too */
+#ifdef HISTORY_HOST
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <ti/drivers/net/wifi/simplelink.h>
+#include <Common/commonDefs.h>
+#include <Utils/uart_term.h>
+#include "history.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Files open at a time */
+#define MAX_FILES       8
+
+/* Devices and objects of the accuracy test */
+#define NUM_DEVICES     25
+#define NUM_OBJECTS     6
+
+/* Devices of the drop test, 7 objects each */
+#define NUM_DROP_DEVICES 30
+
+/* Time of the first reading */
+#define START_TIME      1700000000UL
+
+/* Hours recorded */
+#define NUM_HOURS       26
+
+/* A reading of the concurrency tests is its time times this plus the
+   index of its device */
+#define VALUE_SCALE     64
+
+/* Reads of a query between recordings, the time each records, an hour so
+   the files are written over faster than a query reads them, and the
+   queries made */
+#define INTERLEAVE_READS 13
+#define INTERLEAVE_TIME 3600
+#define INTERLEAVE_QUERIES 50
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+static const char *pFolder = "/tmp/history_test";
+
+/* Open files, by handle */
+static FILE *files[MAX_FILES];
+static pthread_mutex_t filesMutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* The time history.c gets */
+static volatile uint32_t testNow;
+
+/* Set once the recording thread is done */
+static volatile bool recordingDone;
+
+/* Hour the devices were last given a report slot in, and their slots */
+static uint32_t slotHour = 0;
+static uint8_t slot[NUM_DEVICES];
+
+/* true to record from sl_FsRead(), and the number of reads so far */
+static bool interleave = false;
+static uint32_t numReads = 0;
+
+/* Log lines saying an hour is full */
+static int numFullLogs;
+
+static dev_t devs[NUM_DROP_DEVICES];
+static History_result_t result;
+
+/******************************************************************************
+ Local function prototypes
+ *****************************************************************************/
+
+static void recordFor(uint32_t seconds);
+
+/******************************************************************************
+ Public functions, stand-ins for the device's
+ *****************************************************************************/
+
+volatile uint8_t LogLevel[TermLog_module_count] = {TermLog_level_info};
+
+int ReportLog(TermLog_module_t module, TermLog_level_t level,
+              const char *pcFormat, ...)
+{
+    char line[160];
+    va_list args;
+
+    (void)module;
+    (void)level;
+    va_start(args, pcFormat);
+    vsnprintf(line, sizeof(line), pcFormat, args);
+    va_end(args);
+    if(strstr(line, "is full") != NULL)
+    {
+        numFullLogs++;
+    }
+    return (0);
+}
+
+time_t testTime(time_t *pTime)
+{
+    if(pTime != NULL)
+    {
+        *pTime = testNow;
+    }
+    return (testNow);
+}
+
+int32_t sl_FsOpen(const unsigned char *pFileName,
+                  const uint32_t accessModeAndMaxSize, uint32_t *pToken)
+{
+    char path[256];
+    const char *pName = strrchr((const char *)pFileName, '/');
+    FILE *pFile;
+    int32_t handle = -1;
+    int32_t i;
+
+    (void)pToken;
+    snprintf(path, sizeof(path), "%s/%s", pFolder, pName + 1);
+    pFile = fopen(path, (accessModeAndMaxSize & SL_FS_READ) ? "rb" : "wb");
+    if(pFile == NULL)
+    {
+        return (-11);
+    }
+    /* Reads see what was written since, like the file system's */
+    setvbuf(pFile, NULL, _IONBF, 0);
+
+    pthread_mutex_lock(&filesMutex);
+    for(i = 0; i < MAX_FILES; i++)
+    {
+        if(files[i] == NULL)
+        {
+            files[i] = pFile;
+            handle = i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&filesMutex);
+
+    if(handle < 0)
+    {
+        fclose(pFile);
+    }
+    return (handle);
+}
+
+int32_t sl_FsRead(int32_t fileHdl, uint32_t offset, unsigned char *pData,
+                  uint32_t len)
+{
+    /* Record in the middle of the query */
+    if(interleave && ((++numReads % INTERLEAVE_READS) == 0))
+    {
+        interleave = false;
+        recordFor(INTERLEAVE_TIME);
+        interleave = true;
+    }
+
+    fseek(files[fileHdl], offset, SEEK_SET);
+    return ((int32_t)fread(pData, 1, len, files[fileHdl]));
+}
+
+int32_t sl_FsWrite(int32_t fileHdl, uint32_t offset, unsigned char *pData,
+                   uint32_t len)
+{
+    int32_t written;
+
+    fseek(files[fileHdl], offset, SEEK_SET);
+    written = (int32_t)fwrite(pData, 1, len, files[fileHdl]);
+    fflush(files[fileHdl]);
+    return (written);
+}
+
+int16_t sl_FsClose(int32_t fileHdl, const unsigned char *pCertificateFileName,
+                   const unsigned char *pSignature, uint32_t signatureLen)
+{
+    (void)pCertificateFileName;
+    (void)pSignature;
+    (void)signatureLen;
+    fclose(files[fileHdl]);
+    pthread_mutex_lock(&filesMutex);
+    files[fileHdl] = NULL;
+    pthread_mutex_unlock(&filesMutex);
+    return (0);
+}
+
+/******************************************************************************
+ Local functions
+ *****************************************************************************/
+
+/*!
+ * @brief   Remove the files of an earlier run
+ */
+static void clearFiles(void)
+{
+    char path[256];
+    int i;
+
+    for(i = 0; i < 26; i++)
+    {
+        snprintf(path, sizeof(path), "%s/seg%02d.bin", pFolder, i);
+        remove(path);
+    }
+}
+
+/*!
+ * @brief   Set up the devices, with the objects given
+ */
+static void setupDevices(int numDevices, int numObjects)
+{
+    static const char *pTypes[7] = {TEMP_TYPE, "illuminance", "humidity",
+                                    "barometer", TEMP_TYPE, "batterylife",
+                                    "pressure"};
+    int d;
+    int o;
+
+    memset(devs, 0, sizeof(devs));
+    for(d = 0; d < numDevices; d++)
+    {
+        devs[d].shortAddr = (uint16_t)(d + 1);
+        devs[d].extAddr[0] = (uint8_t)d;
+        devs[d].extAddr[7] = 0x12;
+        devs[d].objectCount = (uint8_t)numObjects;
+        for(o = 0; o < numObjects; o++)
+        {
+            devs[d].object[o].type = pTypes[o];
+            devs[d].object[o].sensorVal = 2000 + (rand() % 500);
+        }
+    }
+}
+
+/*!
+ * @brief   Record a day and two hours and check a day's query of one
+ *          object against the readings
+ *
+ * @return  0 if they match
+ */
+static int checkAccuracy(void)
+{
+    static uint32_t refTime[2000];
+    static int32_t refValue[2000];
+    uint32_t nextReport[NUM_DEVICES];
+    uint32_t from;
+    uint32_t to;
+    clock_t start;
+    long numRecords = 0;
+    double recordUs;
+    double queryUs;
+    int numRef = 0;
+    int bad = 0;
+    int got = 0;
+    int d;
+    int o;
+    int i;
+    int k;
+
+    clearFiles();
+    setupDevices(NUM_DEVICES, NUM_OBJECTS);
+    for(d = 0; d < NUM_DEVICES; d++)
+    {
+        nextReport[d] = START_TIME + (rand() % 90);
+    }
+
+    start = clock();
+    for(testNow = START_TIME; testNow < START_TIME + (NUM_HOURS * 3600);
+        testNow++)
+    {
+        for(d = 0; d < NUM_DEVICES; d++)
+        {
+            if(testNow < nextReport[d])
+            {
+                continue;
+            }
+            for(o = 0; o < NUM_OBJECTS; o++)
+            {
+                devs[d].object[o].sensorVal += (rand() % 5) - 2;
+                if(o == 3)
+                {
+                    devs[d].object[o].sensorVal = 100000 + (rand() % 300);
+                }
+            }
+            if((d == 3) &&
+               (testNow >= START_TIME + (NUM_HOURS * 3600) - 86400))
+            {
+                refTime[numRef] = testNow;
+                refValue[numRef] = devs[d].object[0].sensorVal;
+                numRef++;
+            }
+            History_record(&devs[d]);
+            numRecords++;
+            nextReport[d] = testNow + 88 + (rand() % 5);
+        }
+    }
+    recordUs = ((double)(clock() - start) * 1e6) /
+               ((double)CLOCKS_PER_SEC * numRecords);
+
+    to = testNow;
+    from = to - 86400;
+    start = clock();
+    for(k = 0; k < 10; k++)
+    {
+        History_query(NULL, 4, TEMP_TYPE, from, to, HISTORY_MAX_POINTS,
+                      &result);
+    }
+    queryUs = ((double)(clock() - start) * 1e6) / (CLOCKS_PER_SEC * 10.0);
+
+    for(i = 0; i < HISTORY_MAX_POINTS; i++)
+    {
+        const History_point_t *pPoint = &result.points[0][i];
+        uint32_t stepStart = from + (i * result.step);
+        int64_t sum = 0;
+        int32_t min = 0x7FFFFFFF;
+        int32_t max = -0x7FFFFFFF;
+        int count = 0;
+
+        for(k = 0; k < numRef; k++)
+        {
+            if((refTime[k] >= stepStart) &&
+               (refTime[k] < stepStart + result.step))
+            {
+                sum += refValue[k];
+                min = (refValue[k] < min) ? refValue[k] : min;
+                max = (refValue[k] > max) ? refValue[k] : max;
+                count++;
+            }
+        }
+        got += pPoint->count;
+        if((pPoint->count != count) ||
+           ((count > 0) && ((pPoint->sum != sum) || (pPoint->min != min) ||
+                            (pPoint->max != max))))
+        {
+            bad++;
+        }
+    }
+
+    printf("accuracy: %d readings, %d found, %d points wrong, %d series\n",
+           numRef, got, bad, result.numSeries);
+    printf("  %.2f us per record, %.0f us per day's query\n", recordUs,
+           queryUs);
+    return ((bad != 0) || (got != numRef) || (result.numSeries != 2));
+}
+
+/*!
+ * @brief   Record a reading of each device every 30 s, the value of each
+ *          its time and device
+ *
+ * @param   seconds - time to record for
+ */
+static void recordFor(uint32_t seconds)
+{
+    uint32_t end = testNow + seconds;
+    int d;
+    int o;
+
+    while(testNow < end)
+    {
+        uint32_t now = testNow + 1;
+
+        testNow = now;
+
+        /* A new order each hour, so the series of an hour aren't those of
+           the hour before */
+        if((now / 3600) != slotHour)
+        {
+            slotHour = now / 3600;
+            for(d = 0; d < NUM_DEVICES; d++)
+            {
+                slot[d] = (uint8_t)(rand() % 30);
+            }
+        }
+
+        for(d = 0; d < NUM_DEVICES; d++)
+        {
+            if(((now + slot[d]) % 30) == 0)
+            {
+                for(o = 0; o < NUM_OBJECTS; o++)
+                {
+                    devs[d].object[o].sensorVal =
+                        (int)(((now - START_TIME) * VALUE_SCALE) + d);
+                }
+                History_record(&devs[d]);
+            }
+        }
+    }
+}
+
+/*!
+ * @brief   Record a day, a minute at a time with pauses for the queries
+ */
+static void *recordThread(void *pArg)
+{
+    static const struct timespec pause = {0, 200000};
+    int i;
+
+    (void)pArg;
+    for(i = 0; i < (24 * 60); i++)
+    {
+        recordFor(60);
+        nanosleep(&pause, NULL);
+    }
+    recordingDone = true;
+    return (NULL);
+}
+
+/*!
+ * @brief   Query a day of a device's temperatures and check each point
+ *
+ * @param   d - index of the device
+ *
+ * @return  number of points that aren't within their time step or are of
+ *          another device
+ */
+static int queryDay(int d)
+{
+    uint32_t to = testNow;
+    uint32_t from = to - 86400;
+    int bad = 0;
+    int s;
+    int i;
+
+    History_query(NULL, devs[d].shortAddr, TEMP_TYPE, from, to,
+                  HISTORY_MAX_POINTS, &result);
+    for(s = 0; s < result.numSeries; s++)
+    {
+        for(i = 0; i < HISTORY_MAX_POINTS; i++)
+        {
+            const History_point_t *pPoint = &result.points[s][i];
+            int64_t stepStart = (int64_t)from + (i * result.step) -
+                                START_TIME;
+
+            /* Only the readings after the first test are the time */
+            if((pPoint->count > 0) &&
+               (stepStart >= (NUM_HOURS * 3600)) &&
+               (((pPoint->min % VALUE_SCALE) != d) ||
+                ((pPoint->max % VALUE_SCALE) != d) ||
+                ((pPoint->min / VALUE_SCALE) < stepStart) ||
+                ((pPoint->max / VALUE_SCALE) >= (stepStart + result.step))))
+            {
+                bad++;
+            }
+        }
+    }
+    return (bad);
+}
+
+/*!
+ * @brief   Query while another thread records
+ *
+ * @return  0 if every point is right
+ */
+static int checkConcurrency(void)
+{
+    pthread_t thread;
+    int numQueries = 0;
+    int bad = 0;
+
+    pthread_create(&thread, NULL, recordThread, NULL);
+    while(!recordingDone)
+    {
+        bad += queryDay(numQueries % NUM_DEVICES);
+        numQueries++;
+    }
+    pthread_join(thread, NULL);
+
+    printf("concurrency: %d queries, %d points wrong\n", numQueries, bad);
+    return (bad != 0);
+}
+
+/*!
+ * @brief   Query with recordings between the file reads of the query, so
+ *          hours start and their files are written over while it reads
+ *
+ * @return  0 if every point is right
+ */
+static int checkInterleaving(void)
+{
+    int numQueries = 0;
+    int bad = 0;
+
+    interleave = true;
+    while(numQueries < INTERLEAVE_QUERIES)
+    {
+        bad += queryDay(numQueries % NUM_DEVICES);
+        numQueries++;
+    }
+    interleave = false;
+
+    printf("interleaving: %d queries, %d points wrong\n", numQueries, bad);
+    return (bad != 0);
+}
+
+/*!
+ * @brief   Record more objects than an hour holds
+ *
+ * @return  0 if the drop is logged once an hour
+ */
+static int checkDrop(void)
+{
+    uint32_t end = testNow + (3 * 3600) - (testNow % 3600);
+    int d;
+
+    setupDevices(NUM_DROP_DEVICES, 7);
+    numFullLogs = 0;
+    while(testNow < end)
+    {
+        testNow += 60;
+        for(d = 0; d < NUM_DROP_DEVICES; d++)
+        {
+            History_record(&devs[d]);
+        }
+    }
+
+    printf("drop: %d objects a reading, %d full hours logged\n",
+           NUM_DROP_DEVICES * 7, numFullLogs);
+    return ((numFullLogs < 2) || (numFullLogs > 4));
+}
+
+/******************************************************************************
+ Public functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    int failures = 0;
+
+    if(argc > 1)
+    {
+        pFolder = argv[1];
+    }
+
+    srand(1);
+    History_init();
+    failures += checkAccuracy();
+    failures += checkConcurrency();
+    failures += checkInterleaving();
+    failures += checkDrop();
+
+    printf("%s\n", (failures == 0) ? "ok" : "FAILED");
+    return (failures != 0);
+}
+
+#endif /* HISTORY_HOST */
@@ -0,0 +1,2 @@
+#pragma once
+typedef void *UART_Handle;
@@ -0,0 +1,13 @@
+/* The sl_Fs calls and SL_FS_ flags history.c uses, history_test.c has them
+   over host files */
+#pragma once
+#include <stdint.h>
+#define SL_FS_MAX_FILE_NAME_LENGTH 180
+#define SL_FS_CREATE 1
+#define SL_FS_OVERWRITE 2
+#define SL_FS_READ 4
+#define SL_FS_CREATE_MAX_SIZE(x) ((x) << 8)
+int32_t sl_FsOpen(const unsigned char *n, uint32_t m, uint32_t *t);
+int32_t sl_FsRead(int32_t h, uint32_t o, unsigned char *p, uint32_t l);
+int32_t sl_FsWrite(int32_t h, uint32_t o, unsigned char *p, uint32_t l);
+int16_t sl_FsClose(int32_t h, const unsigned char *c, const unsigned char *s, uint32_t l);
@@ -0,0 +1,482 @@
+/******************************************************************************
+
+ @file oadServer.c
+
+ @brief Store of the image the collector pushes to the devices over the air
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+
+#define LOG_MODULE TermLog_module_gateway
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <mqueue.h>
+#include <ti/drivers/net/wifi/simplelink.h>
+#include <ti/net/http/httpcli.h>
+#include <Common/commonDefs.h>
+#include <Utils/uart_term.h>
+#include "oadServer.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*! Stack of the fetch task, the HTTP client needs more than the default */
+#define OADTHREADSIZE           4096
+
+/*! File the image is stored in */
+#define OAD_IMAGE_FILE          "/oad/image.bin"
+
+/*! Bytes read from the server and written to the file at a time */
+#define OAD_FETCH_BUF_LEN       512
+
+/*! Longest host name in a URL */
+#define OAD_HOST_LEN            64
+
+/*! Scheme of a URL, only plain HTTP is fetched */
+#define OAD_URL_SCHEME          "http://"
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+static mqd_t oadServerMq = NULL;
+static mqd_t collectorMq = NULL;
+
+/*! Held while the image is checked or read, and while it is dropped */
+static pthread_mutex_t imageMutex;
+
+/*! true while the file holds a whole image */
+static bool imageValid = false;
+
+/*! Length of the image in the file */
+static uint32_t imageLen = 0;
+
+/*! Number of blocks of the image */
+static uint16_t imageNumBlocks = 0;
+
+/*! Handle of the file opened for reading the blocks, negative if closed */
+static int32_t readHandle = -1;
+
+/*! Kept off the stack of the fetch task */
+static HTTPCli_Struct cli;
+static char fetchBuf[OAD_FETCH_BUF_LEN];
+
+/******************************************************************************
+ Local function prototypes
+ *****************************************************************************/
+
+static void * oadServerThread(void *pvParameters);
+static bool fetchImage(const char *pUrl, OadServer_image_t *pImage);
+static bool storeBody(uint32_t len);
+static void dropImage(void);
+static void sendImage(OadServer_image_t *pImage);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Start the task that fetches the images.
+
+ Public function defined in oadServer.h
+ */
+void oadServerInit(const char *collectorMqName)
+{
+    pthread_t thread = (pthread_t) NULL;
+    pthread_attr_t pAttrs;
+    pthread_mutexattr_t mutexAttrs;
+    struct sched_param priParam;
+    mq_attr attr;
+    unsigned mode = 0;
+    int32_t retc;
+
+    attr.mq_maxmsg = 2;
+    attr.mq_msgsize = sizeof(msgQueue_t);
+    oadServerMq = mq_open(OAD_SERVER_MQ, O_CREAT, mode, &attr);
+    collectorMq = mq_open(collectorMqName, O_WRONLY);
+
+    pthread_mutexattr_init(&mutexAttrs);
+    pthread_mutexattr_setprotocol(&mutexAttrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&imageMutex, &mutexAttrs);
+
+    pthread_attr_init(&pAttrs);
+    priParam.sched_priority = OAD_SERVER_TASK_PRI;
+    retc = pthread_attr_setschedparam(&pAttrs, &priParam);
+    retc |= pthread_attr_setstacksize(&pAttrs, OADTHREADSIZE);
+    retc |= pthread_attr_setdetachstate(&pAttrs, PTHREAD_CREATE_DETACHED);
+    retc |= pthread_create(&thread, &pAttrs, oadServerThread, NULL);
+    if(retc != 0)
+    {
+        UART_PRINT("[OAD Server] could not create fetch thread\n\r");
+    }
+}
+
+/*!
+ Fetch an image and have the collector push it.
+
+ Public function defined in oadServer.h
+ */
+bool OadServer_fetch(const char *pUrl)
+{
+    msgQueue_t queueElementSend;
+    size_t len = strlen(pUrl) + 1;
+    char *pCopy = malloc(len);
+
+    if(pCopy == NULL)
+    {
+        return(false);
+    }
+    memcpy(pCopy, pUrl, len);
+
+    /* The only thing the task is sent */
+    queueElementSend.event = 0;
+    queueElementSend.msgPtr = pCopy;
+    queueElementSend.msgPtrLen = len;
+    if(mq_send(oadServerMq, (char*) &queueElementSend, sizeof(msgQueue_t),
+               0) != 0)
+    {
+        free(pCopy);
+        return(false);
+    }
+
+    return(true);
+}
+
+/*!
+ Read a block of the stored image.
+
+ Public function defined in oadServer.h
+ */
+uint8_t OadServer_readBlock(uint16_t blockNum, uint8_t *pBuf)
+{
+    uint32_t offset = (uint32_t)blockNum * SMSGS_OAD_BLOCK_SIZE;
+    uint8_t len = 0;
+
+    pthread_mutex_lock(&imageMutex);
+    if(imageValid && (blockNum < imageNumBlocks))
+    {
+        len = ((imageLen - offset) < SMSGS_OAD_BLOCK_SIZE) ?
+              (uint8_t)(imageLen - offset) : SMSGS_OAD_BLOCK_SIZE;
+        if(sl_FsRead(readHandle, offset, pBuf, len) != len)
+        {
+            len = 0;
+        }
+    }
+    pthread_mutex_unlock(&imageMutex);
+
+    return(len);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief   Fetch task, one image at a time.
+ *
+ * @param   pvParameters - not used
+ */
+static void * oadServerThread(void *pvParameters)
+{
+    msgQueue_t incomingMsg;
+
+    for(;;)
+    {
+        const char *pUrl;
+
+        incomingMsg.msgPtr = NULL;
+        mq_receive(oadServerMq, (char*)&incomingMsg, sizeof(msgQueue_t), NULL);
+        pUrl = (const char *)incomingMsg.msgPtr;
+
+        /* Stop the collector pushing the old image before it is replaced */
+        dropImage();
+        sendImage(NULL);
+
+        if((pUrl != NULL) && (pUrl[0] != '\0'))
+        {
+            OadServer_image_t *pImage = malloc(sizeof(OadServer_image_t));
+
+            if(pImage != NULL)
+            {
+                if(fetchImage(pUrl, pImage))
+                {
+                    UART_PRINT("[OAD Server] Stored %u bytes from %s\n\r",
+                               (unsigned int)pImage->len, pUrl);
+                    sendImage(pImage);
+                }
+                else
+                {
+                    free(pImage);
+                }
+            }
+        }
+        else
+        {
+            UART_PRINT("[OAD Server] Stopped\n\r");
+        }
+
+        if(incomingMsg.msgPtr)
+        {
+            free(incomingMsg.msgPtr);
+        }
+    }
+}
+
+/*!
+ * @brief   Fetch an image with an HTTP GET and store it in the file.
+ *
+ * @param   pUrl - http:// URL of the image
+ * @param   pImage - filled in with the image stored
+ *
+ * @return  true if the whole image was stored
+ */
+static bool fetchImage(const char *pUrl, OadServer_image_t *pImage)
+{
+    char host[OAD_HOST_LEN];
+    const char *pHost = pUrl + sizeof(OAD_URL_SCHEME) - 1;
+    const char *pPath;
+    size_t hostLen;
+    HTTPCli_Field reqFields[2] =
+    {
+        { HTTPStd_FIELD_NAME_HOST, host },
+        { NULL, NULL }
+    };
+    const char *respFields[2] =
+    {
+        HTTPStd_FIELD_NAME_CONTENT_LENGTH,
+        NULL
+    };
+    struct sockaddr addr;
+    uint32_t len = 0;
+    bool moreFlag;
+    bool stored = false;
+    bool valid = false;
+    int ret;
+
+    if((strlen(pUrl) <= (sizeof(OAD_URL_SCHEME) - 1)) ||
+       (memcmp(pUrl, OAD_URL_SCHEME, sizeof(OAD_URL_SCHEME) - 1) != 0))
+    {
+        UART_PRINT("[OAD Server] Not an http URL: %s\n\r", pUrl);
+        return(false);
+    }
+    hostLen = strcspn(pHost, ":/");
+    if((hostLen == 0) || (hostLen >= sizeof(host)))
+    {
+        UART_PRINT("[OAD Server] Bad host in %s\n\r", pUrl);
+        return(false);
+    }
+    memcpy(host, pHost, hostLen);
+    host[hostLen] = '\0';
+    pPath = strchr(pHost, '/');
+    if(pPath == NULL)
+    {
+        pPath = "/";
+    }
+
+    ret = HTTPCli_initSockAddr(&addr, pUrl, 0);
+    if(ret < 0)
+    {
+        UART_PRINT("[OAD Server] Can't resolve %s (%d)\n\r", host, ret);
+        return(false);
+    }
+
+    HTTPCli_construct(&cli);
+    HTTPCli_setRequestFields(&cli, reqFields);
+    HTTPCli_setResponseFields(&cli, respFields);
+
+    do
+    {
+        ret = HTTPCli_connect(&cli, &addr, 0, NULL);
+        if(ret < 0)
+        {
+            break;
+        }
+
+        ret = HTTPCli_sendRequest(&cli, HTTPStd_GET, pPath, false);
+        if(ret < 0)
+        {
+            break;
+        }
+
+        ret = HTTPCli_getResponseStatus(&cli);
+        if(ret != HTTPStd_OK)
+        {
+            break;
+        }
+
+        /* The body is read raw, so its length must be given */
+        do
+        {
+            ret = HTTPCli_getResponseField(&cli, fetchBuf, sizeof(fetchBuf),
+                                           &moreFlag);
+            if(ret == 0)
+            {
+                len = strtoul(fetchBuf, NULL, 10);
+            }
+        } while((ret >= 0) || (ret == HTTPCli_FIELD_ID_DUMMY));
+        if(ret != HTTPCli_FIELD_ID_END)
+        {
+            break;
+        }
+        if((len < SMSGS_OAD_IMG_HDR_LEN) || (len > OADSERVER_MAX_IMAGE_LEN))
+        {
+            UART_PRINT("[OAD Server] Image of %u bytes refused\n\r",
+                       (unsigned int)len);
+            break;
+        }
+
+        stored = storeBody(len);
+    } while(0);
+
+    HTTPCli_disconnect(&cli);
+    HTTPCli_destruct(&cli);
+
+    if(stored == false)
+    {
+        UART_PRINT("[OAD Server] Fetch of %s failed (%d)\n\r", pUrl, ret);
+        return(false);
+    }
+
+    /* Open it for the collector to read the blocks from */
+    pthread_mutex_lock(&imageMutex);
+    readHandle = sl_FsOpen((unsigned char *)OAD_IMAGE_FILE, SL_FS_READ, NULL);
+    if((readHandle >= 0) &&
+       (sl_FsRead(readHandle, 0, pImage->hdr, SMSGS_OAD_IMG_HDR_LEN) ==
+        SMSGS_OAD_IMG_HDR_LEN))
+    {
+        imageLen = len;
+        imageNumBlocks = (uint16_t)((len + SMSGS_OAD_BLOCK_SIZE - 1) /
+                                    SMSGS_OAD_BLOCK_SIZE);
+        imageValid = true;
+        valid = true;
+    }
+    pthread_mutex_unlock(&imageMutex);
+
+    if(valid == false)
+    {
+        dropImage();
+        return(false);
+    }
+
+    pImage->len = imageLen;
+    pImage->numBlocks = imageNumBlocks;
+    return(true);
+}
+
+/*!
+ * @brief   Write the body of the response to the file.
+ *
+ * @param   len - length of the body
+ *
+ * @return  true if all of it was written
+ */
+static bool storeBody(uint32_t len)
+{
+    uint32_t offset = 0;
+    int32_t fsHandle;
+
+    fsHandle = sl_FsOpen((unsigned char *)OAD_IMAGE_FILE,
+                         SL_FS_CREATE | SL_FS_OVERWRITE |
+                         SL_FS_CREATE_MAX_SIZE(len), NULL);
+    if(fsHandle < 0)
+    {
+        return(false);
+    }
+
+    while(offset < len)
+    {
+        int n = ((len - offset) < sizeof(fetchBuf)) ?
+                (int)(len - offset) : (int)sizeof(fetchBuf);
+
+        n = HTTPCli_readRawResponseBody(&cli, fetchBuf, n);
+        if((n <= 0) ||
+           (sl_FsWrite(fsHandle, offset, (unsigned char *)fetchBuf, n) != n))
+        {
+            break;
+        }
+        offset += n;
+    }
+
+    sl_FsClose(fsHandle, NULL, 0, 0);
+
+    return(offset == len);
+}
+
+/*!
+ * @brief   Stop the blocks being read, and close the file.
+ */
+static void dropImage(void)
+{
+    pthread_mutex_lock(&imageMutex);
+    imageValid = false;
+    if(readHandle >= 0)
+    {
+        sl_FsClose(readHandle, NULL, 0, 0);
+        readHandle = -1;
+    }
+    pthread_mutex_unlock(&imageMutex);
+}
+
+/*!
+ * @brief   Tell the collector of the image to push.
+ *
+ * @param   pImage - the image, the collector frees it; NULL to stop
+ */
+static void sendImage(OadServer_image_t *pImage)
+{
+    msgQueue_t queueElementSend;
+
+    queueElementSend.event = CollectorEvent_OAD_IMAGE;
+    queueElementSend.msgPtr = pImage;
+    queueElementSend.msgPtrLen = (pImage != NULL) ?
+                                 sizeof(OadServer_image_t) : 0;
+    if((mq_send(collectorMq, (char*) &queueElementSend, sizeof(msgQueue_t),
+                MQ_LOW_PRIOR) != 0) && (pImage != NULL))
+    {
+        free(pImage);
+    }
+}
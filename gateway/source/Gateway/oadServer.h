@@ -0,0 +1,136 @@
+/******************************************************************************
+
+ @file oadServer.h
+
+ @brief Store of the image the collector pushes to the devices over the air
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+#ifndef OADSERVER_H
+#define OADSERVER_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <Collector/smsgs.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup OadServer OAD Image Store
+ <BR>
+ The image for over-the-air download is fetched with HTTP by a task of its
+ own, at low priority, into the SimpleLink file system, so it survives a
+ reset of the gateway and isn't held in RAM.  When it is stored, the
+ collector gets a CollectorEvent_OAD_IMAGE with its OadServer_image_t and
+ pushes it to the devices, reading each block from the file as it goes out.
+ <BR>
+ A new fetch first sends the collector a CollectorEvent_OAD_IMAGE with no
+ image, to stop pushing the old one, and blocks can't be read until the new
+ one is stored.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup OadServer
+ * @{
+ */
+
+/*! Largest image, the internal flash of the biggest CC13xx */
+#define OADSERVER_MAX_IMAGE_LEN (352UL * 1024UL)
+
+/*! Image stored, sent with CollectorEvent_OAD_IMAGE */
+typedef struct
+{
+    /*! Length in bytes */
+    uint32_t len;
+    /*! Number of blocks of SMSGS_OAD_BLOCK_SIZE bytes */
+    uint16_t numBlocks;
+    /*! Its first bytes, for the devices to decide whether they want it */
+    uint8_t hdr[SMSGS_OAD_IMG_HDR_LEN];
+} OadServer_image_t;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Start the task that fetches the images.
+ *
+ * @param   collectorMqName - queue of the collector, told of each image
+ */
+extern void oadServerInit(const char *collectorMqName);
+
+/*!
+ * @brief   Fetch an image and have the collector push it, in the
+ *          background.  Stops pushing the image fetched before.
+ *
+ * @param   pUrl - http:// URL of the image, "" to only stop
+ *
+ * @return  true if the fetch was queued
+ */
+extern bool OadServer_fetch(const char *pUrl);
+
+/*!
+ * @brief   Read a block of the stored image.
+ *
+ * @param   blockNum - block number
+ * @param   pBuf - where to put it, SMSGS_OAD_BLOCK_SIZE bytes
+ *
+ * @return  length of the block, 0 if there is no such block or no image
+ */
+extern uint8_t OadServer_readBlock(uint16_t blockNum, uint8_t *pBuf);
+
+/*! @} end group OadServer */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OADSERVER_H */
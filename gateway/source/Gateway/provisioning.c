@@ -47,6 +47,9 @@
 //
 //****************************************************************************
 
+/* Console prints of this file, see Utils/uart_term.h */
+#define LOG_MODULE TermLog_module_provisioning
+
 /* Standard Include */
 #include <stdlib.h>
 #include <string.h>
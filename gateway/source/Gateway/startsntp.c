@@ -30,6 +30,9 @@
  * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+/* Console prints of this file, see Utils/uart_term.h */
+#define LOG_MODULE TermLog_module_provisioning
+
 #include <time.h>
 #include <unistd.h>
 
@@ -43,12 +43,17 @@
  Release Name:
  Release Date:
  *****************************************************************************/
+/* Console prints of this file, see Utils/uart_term.h */
+#define LOG_MODULE TermLog_module_npi
+
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
 #include <mqueue.h>
 #include <Common/commonDefs.h>
 #include <Utils/uart_term.h>
+#include <Utils/latency.h>
+#include <Utils/metrics.h>
 #include "npiParse.h"
 
 #define xNPI_DEBUG
@@ -114,6 +119,7 @@ uint32_t mtProcessInCmd(uint8_t * data, uint32_t len)
             }
             else // something went wrong go back to waiting for an SOF
             {
+                Metrics_increment(Metrics_counter_mtFrameErrors);
                 rxState = MT_WAITING_SOF;
                 readBytes = MT_SOF_LEN;
             }
@@ -132,12 +138,14 @@ uint32_t mtProcessInCmd(uint8_t * data, uint32_t len)
                 calcFCS = mtCalcFCS(currentMtPacket, MT_HDR_LEN + currLen);
                 if(calcFCS == data[len - 1])
                 {
+                    Metrics_increment(Metrics_counter_mtFramesIn);
                     unsigned int prio = (currentMtPacket[1] & MT_CMD_TYPE_MASK) == MT_CMD_SRSP ? MQ_HIGH_PRIOR : MQ_LOW_PRIOR;
                     msgQueue_t clientReportMsg;
                     //TODO: modify below if supporting multiple clients
                     clientReportMsg.event = CollectorEvent_PROCESS_NPI_CMD;
                     clientReportMsg.msgPtr = currentMtPacket;
                     clientReportMsg.msgPtrLen = (int32_t)(MT_HDR_LEN + currLen);
+                    clientReportMsg.timestamp = Latency_stamp();
 #ifdef NPI_DEBUG
                     if(currentMtPacket[3] != 0 && clientReportMsg.msgPtrLen == 4)
                     {
@@ -163,6 +171,7 @@ uint32_t mtProcessInCmd(uint8_t * data, uint32_t len)
                 }
                 else
                 {
+                    Metrics_increment(Metrics_counter_mtFcsErrors);
                     if(currentMtPacket != NULL)
                     {
                         free(currentMtPacket);
@@ -173,6 +182,7 @@ uint32_t mtProcessInCmd(uint8_t * data, uint32_t len)
             }
             else
             {
+                Metrics_increment(Metrics_counter_mtFrameErrors);
                 if(currentMtPacket != NULL)
                 {
                     free(currentMtPacket);
@@ -232,6 +242,7 @@ void Mt_sendCmd(mtMsg_t *cmdDesc)
 #endif
     //send message to NPI task
     mq_send(*mtServerMq, (char*)&serverReportMsg, sizeof(msgQueue_t), MQ_LOW_PRIOR);
+    Metrics_increment(Metrics_counter_mtFramesOut);
 }
 
 
@@ -239,9 +250,10 @@ uint8_t Mt_rcvSrsp(mtMsg_t *cmdDesc)
 {
     mtMsg_t tempCmd;
     uint8_t status = MT_FAIL;
-    //uint8_t expectedCmd0 = cmdDesc->cmd0;
+    uint8_t expectedCmd0 = cmdDesc->cmd0;
     uint8_t expectedCmd1 = cmdDesc->cmd1;
     msgQueue_t incomingMsg;
+    uint32_t start = Latency_stamp();
     tempCmd.attrs = NULL;
 
     for(uint8_t retries = 0; retries < MT_SRSP_RETRY_COUNT; retries++)
@@ -258,6 +270,18 @@ uint8_t Mt_rcvSrsp(mtMsg_t *cmdDesc)
                 free(incomingMsg.msgPtr);
                 incomingMsg.msgPtr = NULL;
             }
+            /* An RPC error names the request: error, Cmd0, Cmd1 */
+            if((tempCmd.cmd0 == (MT_CMD_SRSP | MT_ERR)) && (tempCmd.cmd1 == 0)
+               && (tempCmd.len >= 3)
+               && ((tempCmd.attrs[1] & MT_SUBSYSTEM_MASK) ==
+                   (expectedCmd0 & MT_SUBSYSTEM_MASK))
+               && (tempCmd.attrs[2] == expectedCmd1))
+            {
+                free(tempCmd.attrs);
+                tempCmd.attrs = NULL;
+                status = MT_RPC_ERROR;
+                break;
+            }
             if(tempCmd.cmd1 == expectedCmd1)
             {
                 cmdDesc->len = tempCmd.len;
@@ -283,6 +307,14 @@ uint8_t Mt_rcvSrsp(mtMsg_t *cmdDesc)
         //mq_send(*clientMq, (char*)&incomingMsg, sizeof(msgQueue_t), MQ_LOW_PRIOR);
 
     }
+    if(status == MT_SUCCESS)
+    {
+        Metrics_record(Metrics_histogram_srspWait, Latency_stamp() - start);
+    }
+    else if(status == MT_FAIL)
+    {
+        Metrics_increment(Metrics_counter_srspTimeouts);
+    }
     return status;
 }
 
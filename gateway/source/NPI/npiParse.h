@@ -87,6 +87,9 @@ extern "C"
 #define MT_UART_HDR_LEN           (MT_SOF_LEN + MT_HDR_LEN)
 
 #define MT_FAIL     0xFF
+/* Mt_rcvSrsp() status when the co-processor answers with an RPC error, as
+   it does for a command it doesn't know */
+#define MT_RPC_ERROR 0xFE
 
 // Cmd0 Command Type
 typedef enum
@@ -1034,6 +1034,58 @@ uint8_t MtMac_setReq(MtMac_setReq_t *pData)
     return srspStatus;
 }
 
+uint8_t MtMac_setBatchReq(MtMac_setBatchReq_t *pData, MtMac_setBatchReqSrsp_t *pRspData)
+{
+    uint8_t srspStatus = MT_FAIL;
+    mtMsg_t cmdDesc;
+    uint8_t *srspAttrBuf;
+
+    cmdDesc.len = 1 + pData->DataLen;
+    cmdDesc.cmd0 = MT_CMD_SREQ | MT_MAC;
+    cmdDesc.cmd1 = MAC_SET_BATCH_REQ;
+
+    uint8_t *sreqBuf;
+    cmdDesc.attrs = (uint8_t*)malloc(cmdDesc.len);
+    sreqBuf = cmdDesc.attrs;
+
+    *sreqBuf = pData->Count;
+    sreqBuf++;
+    memcpy(sreqBuf, pData->Data, pData->DataLen);
+
+    pRspData->Count = 0;
+    Mt_sendCmd(&cmdDesc);
+    free(cmdDesc.attrs);
+    srspStatus = Mt_rcvSrsp(&cmdDesc);
+    if(srspStatus == MT_SUCCESS)
+    {
+        srspStatus = MT_FAIL;
+        if(cmdDesc.len > 1 && cmdDesc.attrs != NULL)
+        {
+            srspAttrBuf = cmdDesc.attrs;
+
+            srspStatus = *srspAttrBuf;
+            srspAttrBuf++;
+            pRspData->Count = *srspAttrBuf;
+            srspAttrBuf++;
+            if(pRspData->Count > (cmdDesc.len - 2))
+            {
+                pRspData->Count = cmdDesc.len - 2;
+            }
+            if(pRspData->Count > MAC_SET_BATCH_MAX)
+            {
+                pRspData->Count = MAC_SET_BATCH_MAX;
+            }
+            memcpy(pRspData->Status, srspAttrBuf, pRspData->Count);
+        }
+        if(cmdDesc.attrs != NULL)
+        {
+            free(cmdDesc.attrs);
+        }
+    }
+
+    return srspStatus;
+}
+
 uint8_t MtMac_securityGetReq(MtMac_securityGetReq_t *pData, MtMac_securityGetReqSrsp_t *pRspData)
 {
     uint8_t srspStatus = MT_FAIL;
@@ -372,6 +372,7 @@ void MtMac_RegisterCbs(MtMac_callbacks_t *pCbFuncs);
 #define MAC_START_REQ    0x03
 #define MAC_SYNC_REQ    0x04
 #define MAC_SET_RX_GAIN_REQ    0x0F
+#define MAC_SET_BATCH_REQ    0x10
 #define MAC_WS_ASYNC_REQ    0x44
 #define MAC_FH_ENABLE_REQ    0x40
 #define MAC_FH_START_REQ    0x41
@@ -462,6 +463,25 @@ typedef struct
     uint8_t AttributeValue[16];
 }MtMac_setReq_t;
 
+/* Attribute kinds of a MAC_SET_BATCH_REQ, each attribute is the kind, the
+ * 16-bit attribute ID, the value length and the value */
+#define MAC_SET_BATCH_MAC    0x00
+#define MAC_SET_BATCH_FH    0x01
+/* Most attributes in one MAC_SET_BATCH_REQ */
+#define MAC_SET_BATCH_MAX    32
+
+typedef struct
+{
+    uint8_t Count;
+    uint8_t *Data;
+    uint8_t DataLen;
+}MtMac_setBatchReq_t;
+typedef struct
+{
+    uint8_t Count;
+    uint8_t Status[MAC_SET_BATCH_MAX];
+}MtMac_setBatchReqSrsp_t;
+
 typedef struct
 {
     uint8_t AttributeID;
@@ -662,6 +682,7 @@ uint8_t MtMac_associateRsp(MtMac_associateRsp_t *pData);
 uint8_t MtMac_disassociateReq(MtMac_disassociateReq_t *pData);
 uint8_t MtMac_getReq(MtMac_getReq_t *pData, MtMac_getReqSrsp_t *pRspData);
 uint8_t MtMac_setReq(MtMac_setReq_t *pData);
+uint8_t MtMac_setBatchReq(MtMac_setBatchReq_t *pData, MtMac_setBatchReqSrsp_t *pRspData);
 uint8_t MtMac_securityGetReq(MtMac_securityGetReq_t *pData, MtMac_securityGetReqSrsp_t *pRspData);
 uint8_t MtMac_securitySetReq(MtMac_securitySetReq_t *pData);
 uint8_t MtMac_updatePanidReq(MtMac_updatePanidReq_t *pData);
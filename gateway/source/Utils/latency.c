@@ -0,0 +1,219 @@
+/******************************************************************************
+
+ @file latency.c
+
+ @brief Latency histograms of the sensor report path, from the sensor
+        radio to the cloud publish.
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <xdc/std.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/knl/Clock.h>
+#include "latency.h"
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+/*! Names of the stages, as used in the JSON object */
+static const char *stageNames[Latency_stage_count] =
+{
+    "radio",
+    "link",
+    "collector",
+    "gateway",
+    "cloud"
+};
+
+/*! Histogram counts of each stage */
+static uint32_t histograms[Latency_stage_count][LATENCY_NUM_BUCKETS];
+
+/*! Clock ticks when the time stamp was last brought up to date */
+static uint32_t stampTicks;
+/*! Milliseconds counted up to stampTicks */
+static uint32_t stampMs;
+/*! Microseconds counted up to stampTicks, not a whole millisecond yet */
+static uint32_t stampUs;
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Get a time stamp to measure a stage from.
+
+ Public function defined in latency.h
+ */
+uint32_t Latency_stamp(void)
+{
+    UInt key;
+    uint32_t now;
+    uint64_t us;
+
+    /*
+     Count the milliseconds from the ticks gone by since the last stamp,
+     rather than scaling the tick count itself: the count wrapping would
+     then step the stamps, and the delays across it would be wrong.
+     Clock_tickPeriod is in microseconds.
+     */
+    key = Hwi_disable();
+    now = (uint32_t)Clock_getTicks();
+    us = ((uint64_t)(now - stampTicks) * Clock_tickPeriod) + stampUs;
+    stampTicks = now;
+    stampMs += (uint32_t)(us / 1000);
+    stampUs = (uint32_t)(us % 1000);
+    now = stampMs;
+    Hwi_restore(key);
+
+    return ((now == LATENCY_NO_STAMP) ? (now + 1) : now);
+}
+
+/*!
+ Record the delay of a stage.
+
+ Public function defined in latency.h
+ */
+void Latency_record(Latency_stage_t stage, uint32_t delay)
+{
+    UInt key;
+    uint8_t bucket = 0;
+
+    if(stage >= Latency_stage_count)
+    {
+        return;
+    }
+
+    while((delay != 0) && (bucket < (LATENCY_NUM_BUCKETS - 1)))
+    {
+        delay >>= 1;
+        bucket++;
+    }
+
+    /* Recorded from the collector, NPI and cloud tasks */
+    key = Hwi_disable();
+    histograms[stage][bucket]++;
+    Hwi_restore(key);
+}
+
+/*!
+ Record the delay of a stage from a time stamp until now.
+
+ Public function defined in latency.h
+ */
+void Latency_recordSince(Latency_stage_t stage, uint32_t start)
+{
+    if(start != LATENCY_NO_STAMP)
+    {
+        Latency_record(stage, Latency_stamp() - start);
+    }
+}
+
+/*!
+ Get the name of a stage.
+
+ Public function defined in latency.h
+ */
+const char *Latency_stageName(Latency_stage_t stage)
+{
+    return ((stage < Latency_stage_count) ? stageNames[stage] : "");
+}
+
+/*!
+ Copy the histogram of a stage.
+
+ Public function defined in latency.h
+ */
+void Latency_getHistogram(Latency_stage_t stage, uint32_t *pBuckets)
+{
+    UInt key;
+
+    if(stage < Latency_stage_count)
+    {
+        key = Hwi_disable();
+        memcpy(pBuckets, histograms[stage], sizeof(histograms[stage]));
+        Hwi_restore(key);
+    }
+}
+
+/*!
+ Format the histograms as a JSON object.
+
+ Public function defined in latency.h
+ */
+int Latency_formatJson(char *pBuf, int bufLen)
+{
+    uint32_t buckets[LATENCY_NUM_BUCKETS];
+    int len = 0;
+    int stage;
+    int bucket;
+
+    len += snprintf(pBuf + len, bufLen - len, "{");
+    for(stage = 0; (stage < Latency_stage_count) && (len < bufLen); stage++)
+    {
+        len += snprintf(pBuf + len, bufLen - len, "%s\"%s\": [",
+                        (stage == 0) ? "" : ", ", stageNames[stage]);
+        Latency_getHistogram((Latency_stage_t)stage, buckets);
+        for(bucket = 0; (bucket < LATENCY_NUM_BUCKETS) && (len < bufLen);
+            bucket++)
+        {
+            len += snprintf(pBuf + len, bufLen - len, "%s%u",
+                            (bucket == 0) ? "" : ",",
+                            (unsigned int)buckets[bucket]);
+        }
+        if(len < bufLen)
+        {
+            len += snprintf(pBuf + len, bufLen - len, "]");
+        }
+    }
+    if(len < bufLen)
+    {
+        len += snprintf(pBuf + len, bufLen - len, "}");
+    }
+
+    return ((len < bufLen) ? len : 0);
+}
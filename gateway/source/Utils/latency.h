@@ -0,0 +1,167 @@
+/******************************************************************************
+
+ @file latency.h
+
+ @brief Latency histograms of the sensor report path, from the sensor
+        radio to the cloud publish.
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+#ifndef LATENCY_H
+#define LATENCY_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup Latency Latency Histograms
+ <BR>
+ A sensor report passes through several stages before it is published to the
+ cloud.  The time spent in each stage is recorded in a log2 histogram:
+ bucket 0 counts delays under 1 ms and bucket n counts delays of
+ 2^(n-1) to 2^n - 1 ms, the last bucket also counts everything above.
+ <BR>
+ Each stage is recorded by one task only, so no locking is needed.  Readers
+ may see a histogram that is being updated.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup Latency
+ * @{
+ */
+
+/*! Number of buckets in each histogram */
+#define LATENCY_NUM_BUCKETS 16
+
+/*! Time stamp value meaning "not stamped" */
+#define LATENCY_NO_STAMP 0
+
+/*! Stages of the sensor report path */
+typedef enum
+{
+    /*! Sensor data request to data confirm, measured by the sensor */
+    Latency_stage_radio,
+    /*! MAC data indication received over the NPI link to processSensorData */
+    Latency_stage_link,
+    /*! processSensorData to appsrv_deviceSensorDataUpdate */
+    Latency_stage_collector,
+    /*! appsrv_deviceSensorDataUpdate to the gateway task */
+    Latency_stage_gateway,
+    /*! Gateway task to the completed MQTT publish */
+    Latency_stage_cloud,
+    /*! Number of stages */
+    Latency_stage_count
+} Latency_stage_t;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Get a time stamp to measure a stage from.
+ *
+ * @return  current time in milliseconds, never LATENCY_NO_STAMP
+ */
+extern uint32_t Latency_stamp(void);
+
+/*!
+ * @brief   Record the delay of a stage.
+ *
+ * @param   stage - stage the delay was spent in
+ * @param   delay - delay in milliseconds
+ */
+extern void Latency_record(Latency_stage_t stage, uint32_t delay);
+
+/*!
+ * @brief   Record the delay of a stage from a time stamp until now.
+ *          Nothing is recorded for LATENCY_NO_STAMP.
+ *
+ * @param   stage - stage the delay was spent in
+ * @param   start - time stamp from Latency_stamp() at the start of the stage
+ */
+extern void Latency_recordSince(Latency_stage_t stage, uint32_t start);
+
+/*!
+ * @brief   Get the name of a stage, as used in the JSON object.
+ *
+ * @param   stage - the stage
+ *
+ * @return  the name
+ */
+extern const char *Latency_stageName(Latency_stage_t stage);
+
+/*!
+ * @brief   Copy the histogram of a stage.
+ *
+ * @param   stage - the stage
+ * @param   pBuckets - where to put the LATENCY_NUM_BUCKETS counts
+ */
+extern void Latency_getHistogram(Latency_stage_t stage, uint32_t *pBuckets);
+
+/*!
+ * @brief   Format the histograms as a JSON object, one array of
+ *          LATENCY_NUM_BUCKETS counts per stage.
+ *
+ * @param   pBuf - where to put the string
+ * @param   bufLen - size of pBuf
+ *
+ * @return  length of the string, 0 if it didn't fit
+ */
+extern int Latency_formatJson(char *pBuf, int bufLen);
+
+/*! @} end group Latency */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_H */
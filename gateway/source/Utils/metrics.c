@@ -0,0 +1,629 @@
+/******************************************************************************
+
+ @file metrics.c
+
+ @brief Gateway metrics registry: counters, gauges and histograms served
+        as text by the local web server.
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <mqueue.h>
+#include <xdc/std.h>
+#include <xdc/runtime/Memory.h>
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <Common/commonDefs.h>
+#include <Collector/collector.h>
+#include "latency.h"
+#include "metrics.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*! Longest line of the text */
+#define LINE_LEN 100
+
+/*! Number of message queues watched */
+#define NUM_QUEUES 6
+
+/*! Metrics of a device */
+typedef struct
+{
+    /*! Entry in use */
+    bool inUse;
+    /*! RSSI of the last frame, dBm */
+    int8_t rssi;
+    /*! Link quality of the last frame */
+    uint8_t lqi;
+    /*! Short address */
+    uint16_t shortAddr;
+    /*! Messages the device tried to send, as it last reported */
+    uint16_t attempted;
+    /*! Messages the device sent, as it last reported */
+    uint16_t sent;
+    /*! Frames received */
+    uint32_t rxFrames;
+    /*! Time of the last frame, ms */
+    uint32_t lastRx;
+} device_t;
+
+/*! A log2 histogram */
+typedef struct
+{
+    uint32_t buckets[LATENCY_NUM_BUCKETS];
+    /*! Sum of the values recorded */
+    uint32_t sum;
+} histogram_t;
+
+/*! Copy of the metrics being formatted */
+typedef struct
+{
+    uint32_t counters[Metrics_counter_count];
+    histogram_t histograms[Metrics_histogram_count];
+    uint32_t latency[Latency_stage_count][LATENCY_NUM_BUCKETS];
+    /*! Messages waiting in each queue, -1 if the queue isn't there */
+    long queueDepths[NUM_QUEUES];
+    Memory_Stats heap;
+    Collector_statistics_t collector;
+    device_t devices[MAX_NUM_OF_DEVICES];
+} snapshot_t;
+
+/*! Position in the text being formatted */
+typedef struct
+{
+    char *pBuf;
+    uint32_t bufLen;
+    /*! Offset in the text of pBuf[0] */
+    uint32_t offset;
+    /*! Length of the text so far */
+    uint32_t pos;
+} text_t;
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+static const char *counterNames[Metrics_counter_count] =
+{
+    "gw_mt_frames_in_total",
+    "gw_mt_frames_out_total",
+    "gw_mt_fcs_errors_total",
+    "gw_mt_frame_errors_total",
+    "gw_mt_srsp_timeouts_total",
+    "gw_group_cmds_total",
+    "gw_group_acks_total",
+    "gw_group_retries_total",
+    "gw_group_misses_total",
+    "gw_indirect_superseded_total",
+    "gw_indirect_drops_total",
+    "gw_indirect_overflows_total",
+    "gw_oad_blocks_total",
+    "gw_oad_nacks_total",
+    "gw_oad_complete_total",
+    "gw_load_backoffs_total",
+    "gw_load_recoveries_total"
+};
+
+static const char *histogramNames[Metrics_histogram_count] =
+{
+    "gw_mt_srsp_wait_ms",
+    "gw_group_cmd_done_ms",
+    "gw_indirect_wait_ms"
+};
+
+static const char *queueNames[NUM_QUEUES] =
+{
+    NPI_MQ,
+    COLLECTOR_MQ,
+    GATEWAY_MQ,
+    CLOUDSERVICE_MQ,
+    MT_SRSP_MQ,
+    OAD_SERVER_MQ
+};
+
+/*! Collector statistics, gw_collector_<name>_total */
+static const struct
+{
+    const char *pName;
+    uint16_t offset;
+} collectorFields[] =
+{
+    {"tracking_request_attempts",
+     offsetof(Collector_statistics_t, trackingRequestAttempts)},
+    {"tracking_request_sent",
+     offsetof(Collector_statistics_t, trackingReqRequestSent)},
+    {"tracking_response_received",
+     offsetof(Collector_statistics_t, trackingResponseReceived)},
+    {"config_request_attempts",
+     offsetof(Collector_statistics_t, configRequestAttempts)},
+    {"config_request_sent",
+     offsetof(Collector_statistics_t, configReqRequestSent)},
+    {"config_response_received",
+     offsetof(Collector_statistics_t, configResponseReceived)},
+    {"sensor_messages_received",
+     offsetof(Collector_statistics_t, sensorMessagesReceived)},
+    {"channel_access_failures",
+     offsetof(Collector_statistics_t, channelAccessFailures)},
+    {"ack_failures",
+     offsetof(Collector_statistics_t, ackFailures)},
+    {"other_tx_failures",
+     offsetof(Collector_statistics_t, otherTxFailures)},
+    {"rx_decrypt_failures",
+     offsetof(Collector_statistics_t, rxDecryptFailures)},
+    {"tx_encrypt_failures",
+     offsetof(Collector_statistics_t, txEncryptFailures)},
+    {"tx_transaction_expired",
+     offsetof(Collector_statistics_t, txTransactionExpired)},
+    {"tx_transaction_overflow",
+     offsetof(Collector_statistics_t, txTransactionOverflow)}
+};
+
+/*! Per device metrics, in the order deviceValue() knows them */
+static const struct
+{
+    const char *pName;
+    const char *pType;
+} deviceFields[] =
+{
+    {"gw_device_rssi_dbm", "gauge"},
+    {"gw_device_lqi", "gauge"},
+    {"gw_device_rx_frames_total", "counter"},
+    {"gw_device_msgs_attempted_total", "counter"},
+    {"gw_device_msgs_sent_total", "counter"}
+};
+
+static uint32_t counters[Metrics_counter_count];
+static histogram_t histograms[Metrics_histogram_count];
+static device_t devices[MAX_NUM_OF_DEVICES];
+
+/*! Only used by the web server task */
+static snapshot_t snap;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+
+static device_t *findDevice(uint16_t shortAddr);
+static int32_t deviceValue(const device_t *pDev, uint8_t field);
+static void print(text_t *pText, const char *pFormat, ...);
+static void printHistogram(text_t *pText, const char *pName,
+                           const char *pLabel, const uint32_t *pBuckets,
+                           const uint32_t *pSum);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Add one to a counter.
+
+ Public function defined in metrics.h
+ */
+void Metrics_increment(Metrics_counter_t counter)
+{
+    UInt key;
+
+    if(counter < Metrics_counter_count)
+    {
+        key = Hwi_disable();
+        counters[counter]++;
+        Hwi_restore(key);
+    }
+}
+
+/*!
+ Record a value in a histogram.
+
+ Public function defined in metrics.h
+ */
+void Metrics_record(Metrics_histogram_t histogram, uint32_t value)
+{
+    uint32_t shifted = value;
+    uint8_t bucket = 0;
+    UInt key;
+
+    if(histogram >= Metrics_histogram_count)
+    {
+        return;
+    }
+
+    while((shifted != 0) && (bucket < (LATENCY_NUM_BUCKETS - 1)))
+    {
+        shifted >>= 1;
+        bucket++;
+    }
+
+    key = Hwi_disable();
+    histograms[histogram].buckets[bucket]++;
+    histograms[histogram].sum += value;
+    Hwi_restore(key);
+}
+
+/*!
+ Record a frame received from a device.
+
+ Public function defined in metrics.h
+ */
+void Metrics_deviceRx(uint16_t shortAddr, int8_t rssi, uint8_t lqi)
+{
+    device_t *pDev;
+    UInt key;
+
+    key = Hwi_disable();
+    pDev = findDevice(shortAddr);
+    pDev->rssi = rssi;
+    pDev->lqi = lqi;
+    pDev->rxFrames++;
+    pDev->lastRx = (uint32_t)Clock_getTicks();
+    Hwi_restore(key);
+}
+
+/*!
+ Record the message statistics a device reported.
+
+ Public function defined in metrics.h
+ */
+void Metrics_deviceStats(uint16_t shortAddr, uint16_t attempted,
+                         uint16_t sent)
+{
+    device_t *pDev;
+    UInt key;
+
+    key = Hwi_disable();
+    pDev = findDevice(shortAddr);
+    pDev->attempted = attempted;
+    pDev->sent = sent;
+    Hwi_restore(key);
+}
+
+/*!
+ Take a copy of all metrics to format.
+
+ Public function defined in metrics.h
+ */
+void Metrics_snapshot(void)
+{
+    struct mq_attr attr;
+    uint8_t i;
+    UInt key;
+
+    key = Hwi_disable();
+    memcpy(snap.counters, counters, sizeof(counters));
+    memcpy(snap.histograms, histograms, sizeof(histograms));
+    memcpy(snap.devices, devices, sizeof(devices));
+    Hwi_restore(key);
+
+    for(i = 0; i < Latency_stage_count; i++)
+    {
+        Latency_getHistogram((Latency_stage_t)i, snap.latency[i]);
+    }
+
+    for(i = 0; i < NUM_QUEUES; i++)
+    {
+        mqd_t mq = mq_open(queueNames[i], O_RDONLY | O_NONBLOCK);
+
+        snap.queueDepths[i] = -1;
+        if(mq != (mqd_t)-1)
+        {
+            if(mq_getattr(mq, &attr) == 0)
+            {
+                snap.queueDepths[i] = attr.mq_curmsgs;
+            }
+            mq_close(mq);
+        }
+    }
+
+    Memory_getStats(NULL, &snap.heap);
+
+    snap.collector = Collector_statistics;
+}
+
+/*!
+ Format part of the text of the last snapshot.
+
+ Public function defined in metrics.h
+ */
+uint32_t Metrics_formatText(char *pBuf, uint32_t bufLen, uint32_t offset)
+{
+    text_t text;
+    char label[24];
+    uint8_t i;
+    uint8_t f;
+
+    text.pBuf = pBuf;
+    text.bufLen = bufLen;
+    text.offset = offset;
+    text.pos = 0;
+
+    for(i = 0; i < Metrics_counter_count; i++)
+    {
+        print(&text, "# TYPE %s counter\n%s %u\n", counterNames[i],
+              counterNames[i], (unsigned int)snap.counters[i]);
+    }
+
+    print(&text, "# TYPE gw_mq_depth gauge\n");
+    for(i = 0; i < NUM_QUEUES; i++)
+    {
+        if(snap.queueDepths[i] >= 0)
+        {
+            print(&text, "gw_mq_depth{queue=\"%s\"} %ld\n", queueNames[i],
+                  snap.queueDepths[i]);
+        }
+    }
+
+    print(&text, "# TYPE gw_heap_size_bytes gauge\ngw_heap_size_bytes %u\n",
+          (unsigned int)snap.heap.totalSize);
+    print(&text, "# TYPE gw_heap_free_bytes gauge\ngw_heap_free_bytes %u\n",
+          (unsigned int)snap.heap.totalFreeSize);
+    print(&text, "# TYPE gw_heap_largest_free_bytes gauge\n"
+          "gw_heap_largest_free_bytes %u\n",
+          (unsigned int)snap.heap.largestFreeSize);
+
+    for(i = 0; i < (sizeof(collectorFields) / sizeof(collectorFields[0]));
+        i++)
+    {
+        uint32_t value;
+
+        memcpy(&value, (uint8_t *)&snap.collector + collectorFields[i].offset,
+               sizeof(value));
+        print(&text, "# TYPE gw_collector_%s_total counter\n",
+              collectorFields[i].pName);
+        print(&text, "gw_collector_%s_total %u\n", collectorFields[i].pName,
+              (unsigned int)value);
+    }
+
+    for(i = 0; i < Metrics_histogram_count; i++)
+    {
+        print(&text, "# TYPE %s histogram\n", histogramNames[i]);
+        printHistogram(&text, histogramNames[i], NULL,
+                       snap.histograms[i].buckets, &snap.histograms[i].sum);
+    }
+
+    print(&text, "# TYPE gw_latency_ms histogram\n");
+    for(i = 0; i < Latency_stage_count; i++)
+    {
+        snprintf(label, sizeof(label), "stage=\"%s\"",
+                 Latency_stageName((Latency_stage_t)i));
+        printHistogram(&text, "gw_latency_ms", label, snap.latency[i], NULL);
+    }
+
+    /* All the samples of a metric go together */
+    for(f = 0; f < (sizeof(deviceFields) / sizeof(deviceFields[0])); f++)
+    {
+        print(&text, "# TYPE %s %s\n", deviceFields[f].pName,
+              deviceFields[f].pType);
+        for(i = 0; i < MAX_NUM_OF_DEVICES; i++)
+        {
+            if(snap.devices[i].inUse)
+            {
+                print(&text, "%s{addr=\"0x%04x\"} %ld\n",
+                      deviceFields[f].pName, snap.devices[i].shortAddr,
+                      (long)deviceValue(&snap.devices[i], f));
+            }
+        }
+    }
+
+    return (text.pos);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Find the entry of a device, or make one.  A new device takes
+ *              the entry of the device heard from longest ago if the table
+ *              is full.  Called with interrupts off.
+ *
+ * @param       shortAddr - short address of the device
+ *
+ * @return      the entry
+ */
+static device_t *findDevice(uint16_t shortAddr)
+{
+    uint32_t now = (uint32_t)Clock_getTicks();
+    device_t *pOldest = &devices[0];
+    uint8_t i;
+
+    for(i = 0; i < MAX_NUM_OF_DEVICES; i++)
+    {
+        if(!devices[i].inUse)
+        {
+            pOldest = &devices[i];
+            break;
+        }
+        if(devices[i].shortAddr == shortAddr)
+        {
+            return (&devices[i]);
+        }
+        if((now - devices[i].lastRx) > (now - pOldest->lastRx))
+        {
+            pOldest = &devices[i];
+        }
+    }
+
+    memset(pOldest, 0, sizeof(device_t));
+    pOldest->inUse = true;
+    pOldest->shortAddr = shortAddr;
+    pOldest->lastRx = now;
+
+    return (pOldest);
+}
+
+/*!
+ * @brief       Get a per device metric
+ *
+ * @param       pDev - the device
+ * @param       field - index in deviceFields
+ *
+ * @return      the value
+ */
+static int32_t deviceValue(const device_t *pDev, uint8_t field)
+{
+    switch(field)
+    {
+        case 0:
+            return (pDev->rssi);
+        case 1:
+            return (pDev->lqi);
+        case 2:
+            return ((int32_t)pDev->rxFrames);
+        case 3:
+            return (pDev->attempted);
+        default:
+            return (pDev->sent);
+    }
+}
+
+/*!
+ * @brief       Add a line to the text, copying the part that falls in
+ *              the buffer
+ *
+ * @param       pText - the text
+ * @param       pFormat - printf format of the line
+ */
+static void print(text_t *pText, const char *pFormat, ...)
+{
+    char line[LINE_LEN];
+    va_list args;
+    uint32_t start;
+    uint32_t end;
+    int len;
+
+    va_start(args, pFormat);
+    len = vsnprintf(line, sizeof(line), pFormat, args);
+    va_end(args);
+    if(len < 0)
+    {
+        return;
+    }
+    if(len >= (int)sizeof(line))
+    {
+        len = sizeof(line) - 1;
+    }
+
+    start = (pText->pos > pText->offset) ? pText->pos : pText->offset;
+    end = pText->pos + len;
+    if(end > (pText->offset + pText->bufLen))
+    {
+        end = pText->offset + pText->bufLen;
+    }
+    if(start < end)
+    {
+        memcpy(&pText->pBuf[start - pText->offset],
+               &line[start - pText->pos], end - start);
+    }
+
+    pText->pos += len;
+}
+
+/*!
+ * @brief       Add a histogram to the text, with cumulative buckets up to
+ *              the last one used
+ *
+ * @param       pText - the text
+ * @param       pName - name of the histogram
+ * @param       pLabel - label to add, or NULL
+ * @param       pBuckets - LATENCY_NUM_BUCKETS counts
+ * @param       pSum - sum of the values, or NULL if not known
+ */
+static void printHistogram(text_t *pText, const char *pName,
+                           const char *pLabel, const uint32_t *pBuckets,
+                           const uint32_t *pSum)
+{
+    const char *pSep = (pLabel == NULL) ? "" : ",";
+    uint32_t count = 0;
+    int8_t last = LATENCY_NUM_BUCKETS - 2;
+    int8_t bucket;
+
+    if(pLabel == NULL)
+    {
+        pLabel = "";
+    }
+
+    /* Empty buckets at the top say nothing */
+    while((last >= 0) && (pBuckets[last] == 0))
+    {
+        last--;
+    }
+
+    for(bucket = 0; bucket <= last; bucket++)
+    {
+        /* Bucket n holds values up to 2^n - 1 */
+        count += pBuckets[bucket];
+        print(pText, "%s_bucket{%s%sle=\"%u\"} %u\n", pName, pLabel, pSep,
+              (unsigned int)((1UL << bucket) - 1), (unsigned int)count);
+    }
+    for(; bucket < LATENCY_NUM_BUCKETS; bucket++)
+    {
+        count += pBuckets[bucket];
+    }
+    print(pText, "%s_bucket{%s%sle=\"+Inf\"} %u\n", pName, pLabel, pSep,
+          (unsigned int)count);
+
+    if(pLabel[0] != 0)
+    {
+        if(pSum != NULL)
+        {
+            print(pText, "%s_sum{%s} %u\n", pName, pLabel,
+                  (unsigned int)*pSum);
+        }
+        print(pText, "%s_count{%s} %u\n", pName, pLabel, (unsigned int)count);
+    }
+    else
+    {
+        if(pSum != NULL)
+        {
+            print(pText, "%s_sum %u\n", pName, (unsigned int)*pSum);
+        }
+        print(pText, "%s_count %u\n", pName, (unsigned int)count);
+    }
+}
@@ -0,0 +1,205 @@
+/******************************************************************************
+
+ @file metrics.h
+
+ @brief Gateway metrics registry: counters, gauges and histograms served
+        as text by the local web server.
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+#ifndef METRICS_H
+#define METRICS_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup Metrics Metrics Registry
+ <BR>
+ Counters, gauges and histograms of the gateway, formatted in the Prometheus
+ text format for the /metrics page of the local web server.
+ <BR>
+ Counters and histograms are updated by the code that sees the events.
+ Queue depths and heap usage are gauges read when the page is requested.
+ The collector statistics and the latency histograms of latency.h are
+ included as they are.  Per device, the RSSI and LQI of the last frame,
+ the frames received and the message counts the sensor reports in its
+ statistics are kept; the loss rate is 1 - sent / attempted.
+ <BR>
+ Histograms use the log2 buckets of latency.h.
+ <BR>
+ Updates are done with interrupts off, so any task may update any metric.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup Metrics
+ * @{
+ */
+
+/*! Counters */
+typedef enum
+{
+    /*! MT frames received from the co-processor with a good FCS */
+    Metrics_counter_mtFramesIn,
+    /*! MT frames sent to the co-processor */
+    Metrics_counter_mtFramesOut,
+    /*! MT frames dropped for a bad FCS */
+    Metrics_counter_mtFcsErrors,
+    /*! MT frames dropped for a bad length */
+    Metrics_counter_mtFrameErrors,
+    /*! MT commands that got no synchronous response */
+    Metrics_counter_srspTimeouts,
+    /*! Group commands sent */
+    Metrics_counter_groupCmds,
+    /*! Group command acknowledgements received */
+    Metrics_counter_groupAcks,
+    /*! Group command members sent the command again on their own */
+    Metrics_counter_groupRetries,
+    /*! Group command members that never acknowledged */
+    Metrics_counter_groupMisses,
+    /*! Frames held for a sleepy device replaced by a newer one */
+    Metrics_counter_indirectSuperseded,
+    /*! Frames for a sleepy device dropped with the host queue full */
+    Metrics_counter_indirectDrops,
+    /*! Frames for a sleepy device refused by the co-processor */
+    Metrics_counter_indirectOverflows,
+    /*! OAD image blocks broadcast */
+    Metrics_counter_oadBlocks,
+    /*! OAD status responses with blocks missing */
+    Metrics_counter_oadNacks,
+    /*! Devices that got a whole OAD image */
+    Metrics_counter_oadComplete,
+    /*! Reporting interval raised for channel load */
+    Metrics_counter_loadBackoffs,
+    /*! Reporting interval brought back down */
+    Metrics_counter_loadRecoveries,
+    /*! Number of counters */
+    Metrics_counter_count
+} Metrics_counter_t;
+
+/*! Histograms, in milliseconds */
+typedef enum
+{
+    /*! Wait for the synchronous response of an MT command */
+    Metrics_histogram_srspWait,
+    /*! Group command sent until the last member acknowledged or gave up */
+    Metrics_histogram_groupCmdDone,
+    /*! Frame for a sleepy device held on the host until given to the CoP */
+    Metrics_histogram_indirectWait,
+    /*! Number of histograms */
+    Metrics_histogram_count
+} Metrics_histogram_t;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Add one to a counter.
+ *
+ * @param   counter - the counter
+ */
+extern void Metrics_increment(Metrics_counter_t counter);
+
+/*!
+ * @brief   Record a value in a histogram.
+ *
+ * @param   histogram - the histogram
+ * @param   value - the value, in milliseconds
+ */
+extern void Metrics_record(Metrics_histogram_t histogram, uint32_t value);
+
+/*!
+ * @brief   Record a frame received from a device.
+ *
+ * @param   shortAddr - short address of the device
+ * @param   rssi - RSSI of the frame in dBm
+ * @param   lqi - link quality of the frame
+ */
+extern void Metrics_deviceRx(uint16_t shortAddr, int8_t rssi, uint8_t lqi);
+
+/*!
+ * @brief   Record the message statistics a device reported.
+ *
+ * @param   shortAddr - short address of the device
+ * @param   attempted - messages the device tried to send
+ * @param   sent - messages the device sent successfully
+ */
+extern void Metrics_deviceStats(uint16_t shortAddr, uint16_t attempted,
+                                uint16_t sent);
+
+/*!
+ * @brief   Take a copy of all metrics to format.  The copy stays the same
+ *          over the calls to Metrics_formatText() for one page.
+ */
+extern void Metrics_snapshot(void);
+
+/*!
+ * @brief   Format part of the text of the last snapshot, for sending it
+ *          in pieces.
+ *
+ * @param   pBuf - where to put the text, may be NULL with bufLen 0
+ * @param   bufLen - size of pBuf
+ * @param   offset - offset in the text of the first byte wanted
+ *
+ * @return  length of the whole text
+ */
+extern uint32_t Metrics_formatText(char *pBuf, uint32_t bufLen,
+                                   uint32_t offset);
+
+/*! @} end group Metrics */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* METRICS_H */
@@ -0,0 +1,637 @@
+/******************************************************************************
+
+ @file term_log.c
+
+ @brief Binary records of the deferred console log, shared by the gateway
+        and the host decoder.
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "term_log.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*! Longest conversion, flags, width and precision included, that can be
+    formatted */
+#define SPEC_MAX_LEN 24
+
+/*! A conversion of a format string */
+typedef struct
+{
+    /*! Flags, width and precision, as written in the format */
+    const char *pFlags;
+    /*! Length of pFlags */
+    uint8_t flagsLen;
+    /*! Number of '*' in the width and precision */
+    uint8_t stars;
+    /*! Precision, -1 if none or given by a '*' */
+    int16_t precision;
+    /*! true if the precision is given by a '*', the last one */
+    bool precisionStar;
+    /*! Length modifier: 0, 'H' for hh, 'h', 'l', 'q' for ll and j,
+        'z' for z and t, 'L' */
+    char length;
+    /*! Conversion character */
+    char conv;
+} spec_t;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+
+static const char *parseSpec(const char *pFormat, spec_t *pSpec);
+static bool putValue(uint8_t *pArgs, uint16_t maxLen, uint16_t *pLen,
+                     const void *pValue, uint16_t size);
+static bool getValue(const TermLog_header_t *pHdr, uint16_t *pPos,
+                     void *pValue, uint16_t size);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Store the arguments of a print.
+
+ Public function defined in term_log.h
+ */
+uint16_t TermLog_capture(uint8_t *pArgs, uint16_t maxLen,
+                         const char *pFormat, va_list args)
+{
+    uint16_t len = 0;
+    spec_t spec;
+    uint8_t star;
+    int32_t precision;
+
+    while(*pFormat != 0)
+    {
+        if(*pFormat++ != '%')
+        {
+            continue;
+        }
+        pFormat = parseSpec(pFormat, &spec);
+        precision = spec.precision;
+
+        for(star = 0; star < spec.stars; star++)
+        {
+            int32_t word = (int32_t)va_arg(args, int);
+
+            if(!putValue(pArgs, maxLen, &len, &word, sizeof(word)))
+            {
+                return(len);
+            }
+            if(spec.precisionStar && (star == (spec.stars - 1)))
+            {
+                /* A negative precision is taken as none */
+                precision = (word < 0) ? -1 : word;
+            }
+        }
+
+        switch(spec.conv)
+        {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'c':
+                if(spec.length == 'q')
+                {
+                    uint64_t dword = (uint64_t)va_arg(args, long long);
+
+                    if(!putValue(pArgs, maxLen, &len, &dword, sizeof(dword)))
+                    {
+                        return(len);
+                    }
+                }
+                else
+                {
+                    uint32_t word;
+
+                    if(spec.length == 'l')
+                    {
+                        word = (uint32_t)va_arg(args, long);
+                    }
+                    else if(spec.length == 'z')
+                    {
+                        word = (uint32_t)va_arg(args, size_t);
+                    }
+                    else
+                    {
+                        word = (uint32_t)va_arg(args, int);
+                    }
+                    if(!putValue(pArgs, maxLen, &len, &word, sizeof(word)))
+                    {
+                        return(len);
+                    }
+                }
+                break;
+
+            case 'p':
+            {
+                uint32_t word = (uint32_t)(uintptr_t)va_arg(args, void *);
+
+                if(!putValue(pArgs, maxLen, &len, &word, sizeof(word)))
+                {
+                    return(len);
+                }
+                break;
+            }
+
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+            {
+                double dbl;
+
+                if(spec.length == 'L')
+                {
+                    dbl = (double)va_arg(args, long double);
+                }
+                else
+                {
+                    dbl = va_arg(args, double);
+                }
+                if(!putValue(pArgs, maxLen, &len, &dbl, sizeof(dbl)))
+                {
+                    return(len);
+                }
+                break;
+            }
+
+            case 's':
+            {
+                const char *pStr = va_arg(args, const char *);
+                const char *pEnd;
+                uint16_t size;
+
+                if(pStr == NULL)
+                {
+                    pStr = "(null)";
+                }
+                if(precision >= 0)
+                {
+                    /* Only as much as is printed, the string needn't be
+                       terminated */
+                    pEnd = memchr(pStr, 0, (size_t)precision);
+                    size = (uint16_t)((pEnd != NULL) ? (pEnd - pStr)
+                                                     : precision) + 1;
+                }
+                else
+                {
+                    size = (uint16_t)strlen(pStr) + 1;
+                }
+
+                if((pArgs != NULL) && ((len + size) > maxLen))
+                {
+                    /* Keep what fits, nothing after it does */
+                    if(len < maxLen)
+                    {
+                        size = maxLen - len;
+                        memcpy(&pArgs[len], pStr, size - 1);
+                        pArgs[maxLen - 1] = 0;
+                        len = maxLen;
+                    }
+                    return(len);
+                }
+                if(pArgs != NULL)
+                {
+                    memcpy(&pArgs[len], pStr, size - 1);
+                    pArgs[len + size - 1] = 0;
+                }
+                len += size;
+                break;
+            }
+
+            case 'n':
+                (void)va_arg(args, void *);
+                break;
+
+            case '%':
+                break;
+
+            default:
+                /* Unknown conversion, the arguments after it can't be
+                   found */
+                return(len);
+        }
+    }
+
+    return(len);
+}
+
+/*!
+ Format a record as text.
+
+ Public function defined in term_log.h
+ */
+int TermLog_format(const TermLog_header_t *pHdr, const char *pFormat,
+                   char *pBuf, int bufLen)
+{
+    uint16_t pos = 0;
+    int len = 0;
+    spec_t spec;
+    char sub[SPEC_MAX_LEN + 8];
+    int subLen;
+    int ret;
+    uint8_t i;
+
+    if(bufLen <= 0)
+    {
+        return(0);
+    }
+
+    while((*pFormat != 0) && (len < (bufLen - 1)))
+    {
+        if(*pFormat != '%')
+        {
+            pBuf[len++] = *pFormat++;
+            continue;
+        }
+        pFormat = parseSpec(pFormat + 1, &spec);
+
+        if(spec.conv == '%')
+        {
+            pBuf[len++] = '%';
+            continue;
+        }
+        if(spec.conv == 'n')
+        {
+            continue;
+        }
+        if(spec.flagsLen > SPEC_MAX_LEN)
+        {
+            break;
+        }
+
+        /* Rebuild the conversion with the '*' values written in */
+        sub[0] = '%';
+        subLen = 1;
+        for(i = 0; i < spec.flagsLen; i++)
+        {
+            int32_t word;
+
+            if(spec.pFlags[i] != '*')
+            {
+                sub[subLen++] = spec.pFlags[i];
+                continue;
+            }
+            if(!getValue(pHdr, &pos, &word, sizeof(word)))
+            {
+                spec.conv = 0;
+                break;
+            }
+            if((word < 0) && (subLen > 1) && (sub[subLen - 1] == '.'))
+            {
+                /* A negative precision is taken as none */
+                subLen--;
+                continue;
+            }
+            subLen += snprintf(&sub[subLen], sizeof(sub) - subLen, "%ld",
+                               (long)word);
+        }
+        if(subLen > SPEC_MAX_LEN)
+        {
+            break;
+        }
+
+        ret = -1;
+        switch(spec.conv)
+        {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+            {
+                bool sign = (spec.conv == 'd') || (spec.conv == 'i');
+                unsigned long long uval;
+                long long sval;
+
+                if(spec.length == 'q')
+                {
+                    uint64_t dword;
+
+                    if(!getValue(pHdr, &pos, &dword, sizeof(dword)))
+                    {
+                        break;
+                    }
+                    uval = dword;
+                    sval = (long long)dword;
+                }
+                else
+                {
+                    uint32_t word;
+
+                    if(!getValue(pHdr, &pos, &word, sizeof(word)))
+                    {
+                        break;
+                    }
+                    if(spec.length == 'H')
+                    {
+                        word = sign ? (uint32_t)(int8_t)word : (uint8_t)word;
+                    }
+                    else if(spec.length == 'h')
+                    {
+                        word = sign ? (uint32_t)(int16_t)word : (uint16_t)word;
+                    }
+                    uval = word;
+                    sval = (int32_t)word;
+                }
+
+                sub[subLen++] = 'l';
+                sub[subLen++] = 'l';
+                sub[subLen++] = spec.conv;
+                sub[subLen] = 0;
+                if(sign)
+                {
+                    ret = snprintf(&pBuf[len], bufLen - len, sub, sval);
+                }
+                else
+                {
+                    ret = snprintf(&pBuf[len], bufLen - len, sub, uval);
+                }
+                break;
+            }
+
+            case 'c':
+            {
+                int32_t word;
+
+                if(getValue(pHdr, &pos, &word, sizeof(word)))
+                {
+                    sub[subLen++] = 'c';
+                    sub[subLen] = 0;
+                    ret = snprintf(&pBuf[len], bufLen - len, sub, (int)word);
+                }
+                break;
+            }
+
+            case 'p':
+            {
+                uint32_t word;
+
+                if(getValue(pHdr, &pos, &word, sizeof(word)))
+                {
+                    sub[subLen++] = '#';
+                    sub[subLen++] = 'l';
+                    sub[subLen++] = 'x';
+                    sub[subLen] = 0;
+                    ret = snprintf(&pBuf[len], bufLen - len, sub,
+                                   (unsigned long)word);
+                }
+                break;
+            }
+
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+            {
+                double dbl;
+
+                if(getValue(pHdr, &pos, &dbl, sizeof(dbl)))
+                {
+                    sub[subLen++] = spec.conv;
+                    sub[subLen] = 0;
+                    ret = snprintf(&pBuf[len], bufLen - len, sub, dbl);
+                }
+                break;
+            }
+
+            case 's':
+            {
+                const char *pStr = (const char *)(pHdr + 1) + pos;
+
+                if((pos < pHdr->argLen)
+                   && (memchr(pStr, 0, pHdr->argLen - pos) != NULL))
+                {
+                    pos += strlen(pStr) + 1;
+                    sub[subLen++] = 's';
+                    sub[subLen] = 0;
+                    ret = snprintf(&pBuf[len], bufLen - len, sub, pStr);
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if(ret < 0)
+        {
+            /* Out of arguments, the record was cut short */
+            break;
+        }
+        len += ret;
+    }
+
+    if(len >= bufLen)
+    {
+        len = bufLen - 1;
+    }
+    pBuf[len] = 0;
+
+    return(len);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Parse a conversion of a format string
+ *
+ * @param       pFormat - the character after the '%'
+ * @param       pSpec - filled in with the conversion
+ *
+ * @return      the character after the conversion
+ */
+static const char *parseSpec(const char *pFormat, spec_t *pSpec)
+{
+    pSpec->pFlags = pFormat;
+    pSpec->stars = 0;
+    pSpec->precision = -1;
+    pSpec->precisionStar = false;
+    while((*pFormat != 0) && (strchr("-+ #0123456789.*", *pFormat) != NULL))
+    {
+        if(*pFormat == '*')
+        {
+            pSpec->stars++;
+            if(pSpec->precision == 0)
+            {
+                pSpec->precision = -1;
+                pSpec->precisionStar = true;
+            }
+        }
+        else if(*pFormat == '.')
+        {
+            pSpec->precision = 0;
+        }
+        else if((pSpec->precision >= 0) && (*pFormat >= '0')
+                && (*pFormat <= '9') && (pSpec->precision < 10000))
+        {
+            pSpec->precision = (pSpec->precision * 10) + (*pFormat - '0');
+        }
+        pFormat++;
+    }
+    pSpec->flagsLen = (uint8_t)(pFormat - pSpec->pFlags);
+
+    pSpec->length = 0;
+    switch(*pFormat)
+    {
+        case 'h':
+            pFormat++;
+            pSpec->length = 'h';
+            if(*pFormat == 'h')
+            {
+                pFormat++;
+                pSpec->length = 'H';
+            }
+            break;
+
+        case 'l':
+            pFormat++;
+            pSpec->length = 'l';
+            if(*pFormat == 'l')
+            {
+                pFormat++;
+                pSpec->length = 'q';
+            }
+            break;
+
+        case 'j':
+            pFormat++;
+            pSpec->length = 'q';
+            break;
+
+        case 'z':
+        case 't':
+            pFormat++;
+            pSpec->length = 'z';
+            break;
+
+        case 'L':
+            pFormat++;
+            pSpec->length = 'L';
+            break;
+
+        default:
+            break;
+    }
+
+    pSpec->conv = *pFormat;
+    if(*pFormat != 0)
+    {
+        pFormat++;
+    }
+
+    return(pFormat);
+}
+
+/*!
+ * @brief       Store an argument value, or only count it
+ *
+ * @param       pArgs - argument area, NULL to only count
+ * @param       maxLen - size of pArgs
+ * @param       pLen - bytes used so far, updated
+ * @param       pValue - the value
+ * @param       size - size of the value
+ *
+ * @return      false if it didn't fit
+ */
+static bool putValue(uint8_t *pArgs, uint16_t maxLen, uint16_t *pLen,
+                     const void *pValue, uint16_t size)
+{
+    if(pArgs != NULL)
+    {
+        if((*pLen + size) > maxLen)
+        {
+            return(false);
+        }
+        memcpy(&pArgs[*pLen], pValue, size);
+    }
+    *pLen += size;
+
+    return(true);
+}
+
+/*!
+ * @brief       Read the next argument value of a record
+ *
+ * @param       pHdr - the record
+ * @param       pPos - offset of the value in the arguments, updated
+ * @param       pValue - where to put the value
+ * @param       size - size of the value
+ *
+ * @return      false if the record has no more arguments
+ */
+static bool getValue(const TermLog_header_t *pHdr, uint16_t *pPos,
+                     void *pValue, uint16_t size)
+{
+    if((*pPos + size) > pHdr->argLen)
+    {
+        return(false);
+    }
+    memcpy(pValue, (const uint8_t *)(pHdr + 1) + *pPos, size);
+    *pPos += size;
+
+    return(true);
+}
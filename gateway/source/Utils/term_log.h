@@ -0,0 +1,187 @@
+/******************************************************************************
+
+ @file term_log.h
+
+ @brief Binary records of the deferred console log, shared by the gateway
+        and the host decoder.
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+#ifndef TERM_LOG_H
+#define TERM_LOG_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdint.h>
+#include <stdarg.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup TermLog Deferred Console Log Records
+ <BR>
+ A console print is stored as a record holding the address of its format
+ string and the raw values of its arguments, and is only formatted later,
+ by the console drain thread on the gateway or by term_log_decode on a host.
+ <BR>
+ The record starts with a TermLog_header_t.  The arguments follow in the
+ order of the conversions in the format: 4 bytes for each '*' and for
+ integers, pointers and characters, 8 bytes for long long integers and
+ doubles, and %s strings are copied with their terminating NUL, up to the
+ precision if there is one.  Values are stored unaligned, in the byte order
+ of the gateway (little endian).
+ <BR>
+ The code in this module is plain C so the host decoder can share it.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup TermLog
+ * @{
+ */
+
+/*! First byte of every record, for finding records in a dump */
+#define TERM_LOG_MAGIC 0xA5
+
+/*! Record flag: the record is complete */
+#define TERM_LOG_FLAG_READY 0x01
+/*! Record flag: the arguments didn't fit, the text stops early */
+#define TERM_LOG_FLAG_TRUNCATED 0x02
+
+/*! Verbosity levels, a message is kept if its level is at or below the
+    level set for its module */
+typedef enum
+{
+    /*! Errors, also written out immediately */
+    TermLog_level_error,
+    /*! UART_PRINT */
+    TermLog_level_info,
+    /*! DBG_PRINT */
+    TermLog_level_debug
+} TermLog_level_t;
+
+/*! Modules with their own verbosity level */
+typedef enum
+{
+    /*! Anything without a module of its own */
+    TermLog_module_general,
+    /*! Gateway task */
+    TermLog_module_gateway,
+    /*! Wi-Fi provisioning and SNTP */
+    TermLog_module_provisioning,
+    /*! Cloud service */
+    TermLog_module_cloud,
+    /*! Local web server */
+    TermLog_module_webServer,
+    /*! NPI link to the co-processor */
+    TermLog_module_npi,
+    /*! Number of modules */
+    TermLog_module_count
+} TermLog_module_t;
+
+/*! Record header, 16 bytes */
+typedef struct
+{
+    /*! TERM_LOG_MAGIC */
+    uint8_t magic;
+    /*! TERM_LOG_FLAG_xxx */
+    uint8_t flags;
+    /*! Sequence number, consecutive unless records were dropped */
+    uint16_t seq;
+    /*! Time of the print, ms clock ticks */
+    uint32_t time;
+    /*! Address of the format string in the gateway image */
+    uint32_t format;
+    /*! Number of argument bytes following the header */
+    uint16_t argLen;
+    /*! TermLog_module_t */
+    uint8_t module;
+    /*! TermLog_level_t */
+    uint8_t level;
+} TermLog_header_t;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Store the arguments of a print.  Called with a NULL pArgs, only
+ *          counts the bytes they need.  Strings that don't fit are cut
+ *          short and the arguments after them dropped.
+ *
+ * @param   pArgs - where to store the arguments, or NULL
+ * @param   maxLen - size of pArgs
+ * @param   pFormat - printf format string
+ * @param   args - arguments of the format
+ *
+ * @return  number of bytes stored, or needed when pArgs is NULL
+ */
+extern uint16_t TermLog_capture(uint8_t *pArgs, uint16_t maxLen,
+                                const char *pFormat, va_list args);
+
+/*!
+ * @brief   Format a record as text, like snprintf would have formatted
+ *          the original print.
+ *
+ * @param   pHdr - record header, the arguments follow it
+ * @param   pFormat - the format string of the record
+ * @param   pBuf - where to put the text
+ * @param   bufLen - size of pBuf
+ *
+ * @return  length of the text, cut to fit pBuf
+ */
+extern int TermLog_format(const TermLog_header_t *pHdr, const char *pFormat,
+                          char *pBuf, int bufLen);
+
+/*! @} end group TermLog */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TERM_LOG_H */
@@ -0,0 +1,354 @@
+/******************************************************************************
+
+ @file term_log_decode.c
+
+ @brief Host tool that turns binary dumps of the deferred console log back
+        into text
+
+ Group: WCS LPC
+ Target Device: CC13xx CC32xx
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2017, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ Release Name: simplelink_cc13x0_sdk_1_00_00_13"
+ Release Date: 2016-11-21 18:05:40
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+
+ Reads binary records of the gateway console log and prints them as text.
+
+   term_log_decode [-r] [-t] <image> <address> [<dump>]
+
+ <image> is the gateway application binary that produced the records, and
+ <address> the address it runs at, e.g. 0x20004000 for a CC3220S image in
+ RAM; the format strings are read from it.  <dump> is a capture of the
+ console UART after SetLogBinary(true), or stdin.  With -r it is instead a
+ memory dump of logRing, taken with the debugger after a hang; the records
+ still in it are printed oldest first.  -t puts the time, module and level
+ in front of each print.
+
+ Built on a host only, e.g.
+   gcc -DTERM_LOG_HOST -o term_log_decode term_log_decode.c term_log.c
+ *****************************************************************************/
+
+/* Host builds only; the project compiles this file for the device too */
+#ifdef TERM_LOG_HOST
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "term_log.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*! Slot size of the gateway's log ring, records in a -r dump start on
+    slot boundaries */
+#define SLOT_SIZE 64
+
+/*! Largest record accepted, anything above is taken as a false match */
+#define MAX_RECORD 4096
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+static const char *moduleNames[TermLog_module_count] =
+{
+    "general",
+    "gateway",
+    "provisioning",
+    "cloud",
+    "webServer",
+    "npi"
+};
+
+static const char levelNames[] = "EID";
+
+static uint8_t *pImage;
+static long imageLen;
+static uint32_t imageAddr;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+
+static uint8_t *readFile(const char *pPath, long *pLen);
+static const char *findFormat(const TermLog_header_t *pHdr);
+static int compareRecords(const void *pA, const void *pB);
+static void printRecord(const uint8_t *pRec, bool prefix);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char **argv)
+{
+    bool ramDump = false;
+    bool prefix = false;
+    uint8_t *pDump;
+    long dumpLen;
+    const uint8_t **ppRecords;
+    long numRecords = 0;
+    long pos = 0;
+    long i;
+    int arg = 1;
+
+    while((arg < argc) && (argv[arg][0] == '-'))
+    {
+        if(strcmp(argv[arg], "-r") == 0)
+        {
+            ramDump = true;
+        }
+        else if(strcmp(argv[arg], "-t") == 0)
+        {
+            prefix = true;
+        }
+        else
+        {
+            break;
+        }
+        arg++;
+    }
+    if((argc - arg) < 2)
+    {
+        fprintf(stderr,
+                "usage: %s [-r] [-t] <image> <address> [<dump>]\n", argv[0]);
+        return(EXIT_FAILURE);
+    }
+
+    pImage = readFile(argv[arg], &imageLen);
+    imageAddr = (uint32_t)strtoul(argv[arg + 1], NULL, 0);
+    pDump = readFile(((argc - arg) > 2) ? argv[arg + 2] : NULL, &dumpLen);
+
+    ppRecords = malloc(sizeof(*ppRecords)
+                       * ((dumpLen / sizeof(TermLog_header_t)) + 1));
+    if(ppRecords == NULL)
+    {
+        return(EXIT_FAILURE);
+    }
+
+    /* Find the records; UART captures may have console text between them */
+    while((pos + (long)sizeof(TermLog_header_t)) <= dumpLen)
+    {
+        TermLog_header_t hdr;
+        long size;
+
+        memcpy(&hdr, &pDump[pos], sizeof(hdr));
+        size = sizeof(hdr) + hdr.argLen;
+
+        if((hdr.magic != TERM_LOG_MAGIC)
+           || ((hdr.flags & TERM_LOG_FLAG_READY) == 0)
+           || (hdr.module >= TermLog_module_count)
+           || (hdr.level > TermLog_level_debug)
+           || (size > MAX_RECORD) || ((pos + size) > dumpLen)
+           || (findFormat(&hdr) == NULL))
+        {
+            pos += ramDump ? SLOT_SIZE : 1;
+            continue;
+        }
+
+        ppRecords[numRecords++] = &pDump[pos];
+        pos += ramDump ? (((size + SLOT_SIZE - 1) / SLOT_SIZE) * SLOT_SIZE)
+                       : size;
+    }
+
+    if(ramDump)
+    {
+        qsort(ppRecords, numRecords, sizeof(*ppRecords), compareRecords);
+    }
+
+    for(i = 0; i < numRecords; i++)
+    {
+        if(!ramDump && (i > 0))
+        {
+            TermLog_header_t prev;
+            TermLog_header_t hdr;
+
+            memcpy(&prev, ppRecords[i - 1], sizeof(prev));
+            memcpy(&hdr, ppRecords[i], sizeof(hdr));
+            if(hdr.seq != (uint16_t)(prev.seq + 1))
+            {
+                printf("[%u prints lost]\n",
+                       (unsigned int)(uint16_t)(hdr.seq - prev.seq - 1));
+            }
+        }
+        printRecord(ppRecords[i], prefix);
+    }
+
+    return(EXIT_SUCCESS);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Read a whole file, exits on errors
+ *
+ * @param       pPath - file name, NULL for stdin
+ * @param       pLen - set to the length
+ *
+ * @return      the contents
+ */
+static uint8_t *readFile(const char *pPath, long *pLen)
+{
+    FILE *pFile = (pPath == NULL) ? stdin : fopen(pPath, "rb");
+    uint8_t *pBuf = NULL;
+    long size = 0;
+    size_t n;
+
+    if(pFile == NULL)
+    {
+        perror(pPath);
+        exit(EXIT_FAILURE);
+    }
+
+    *pLen = 0;
+    do
+    {
+        if(*pLen == size)
+        {
+            size = (size == 0) ? 65536 : (size * 2);
+            pBuf = realloc(pBuf, size);
+            if(pBuf == NULL)
+            {
+                exit(EXIT_FAILURE);
+            }
+        }
+        n = fread(&pBuf[*pLen], 1, size - *pLen, pFile);
+        *pLen += n;
+    } while(n != 0);
+
+    if(pFile != stdin)
+    {
+        fclose(pFile);
+    }
+
+    return(pBuf);
+}
+
+/*!
+ * @brief       Find the format string of a record in the image
+ *
+ * @param       pHdr - record header
+ *
+ * @return      the format, NULL if the address isn't a string in the image
+ */
+static const char *findFormat(const TermLog_header_t *pHdr)
+{
+    long off = (long)pHdr->format - (long)imageAddr;
+
+    if((pHdr->format < imageAddr) || (off >= imageLen)
+       || (memchr(&pImage[off], 0, imageLen - off) == NULL))
+    {
+        return(NULL);
+    }
+
+    return((const char *)&pImage[off]);
+}
+
+/*!
+ * @brief       qsort comparison, oldest record first
+ *
+ * @param       pA - first record
+ * @param       pB - second record
+ *
+ * @return      <0, 0 or >0 as for qsort
+ */
+static int compareRecords(const void *pA, const void *pB)
+{
+    TermLog_header_t a;
+    TermLog_header_t b;
+
+    memcpy(&a, *(const uint8_t * const *)pA, sizeof(a));
+    memcpy(&b, *(const uint8_t * const *)pB, sizeof(b));
+
+    /* Differences, so both counters may have wrapped */
+    if(a.time != b.time)
+    {
+        return(((int32_t)(a.time - b.time) < 0) ? -1 : 1);
+    }
+
+    return((int16_t)(a.seq - b.seq));
+}
+
+/*!
+ * @brief       Print a record
+ *
+ * @param       pRec - the record, possibly unaligned
+ * @param       prefix - true to print the time, module and level first
+ */
+static void printRecord(const uint8_t *pRec, bool prefix)
+{
+    static uint32_t record[MAX_RECORD / sizeof(uint32_t)];
+    static char text[MAX_RECORD * 2];
+    TermLog_header_t *pHdr = (TermLog_header_t *)record;
+    int len;
+    int i;
+
+    memcpy(pHdr, pRec, sizeof(*pHdr));
+    memcpy(record, pRec, sizeof(*pHdr) + pHdr->argLen);
+
+    if(prefix)
+    {
+        printf("%6u.%03u %-12s %c ", (unsigned int)(pHdr->time / 1000),
+               (unsigned int)(pHdr->time % 1000), moduleNames[pHdr->module],
+               levelNames[pHdr->level]);
+    }
+
+    len = TermLog_format(pHdr, findFormat(pHdr), text, sizeof(text));
+    for(i = 0; i < len; i++)
+    {
+        /* The gateway ends lines with "\n\r" */
+        if(text[i] != '\r')
+        {
+            putchar(text[i]);
+        }
+    }
+    if((pHdr->flags & TERM_LOG_FLAG_TRUNCATED) != 0)
+    {
+        printf("[...]\n");
+    }
+}
+
+#endif /* TERM_LOG_HOST */
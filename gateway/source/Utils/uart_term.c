@@ -46,23 +46,87 @@
 
 // Standard includes
 #include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#include <ti/sysbios/hal/Hwi.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <Common/commonDefs.h>
 
 #include "uart_term.h"
 // TODO: split this file into console and dbgprint
-extern int vsnprintf (char * s, size_t n, const char * format, va_list arg );
 
 //*****************************************************************************
 //                          LOCAL DEFINES
 //*****************************************************************************
 #define IS_SPACE(x)       (x == 32 ? 1 : 0)
 
+// Prints are kept in a ring of slots, a record takes one or more consecutive
+// slots. The ring is followed by LOG_MAX_SLOTS - 1 spare slots so a record
+// never wraps.
+#if !defined(LOG_SLOT_SIZE)
+#define LOG_SLOT_SIZE     64
+#endif
+#if !defined(LOG_RING_SLOTS)
+#define LOG_RING_SLOTS    64
+#endif
+// Most slots one print can take, longer strings are cut short
+#if !defined(LOG_MAX_SLOTS)
+#define LOG_MAX_SLOTS     16
+#endif
+#define LOG_MAX_ARGS      ((LOG_MAX_SLOTS * LOG_SLOT_SIZE) - \
+                           sizeof(TermLog_header_t))
+
+// Longest line written for one print
+#define LOG_LINE_SIZE     (LOG_MAX_SLOTS * LOG_SLOT_SIZE)
+
+typedef union
+{
+    TermLog_header_t    hdr;
+    uint8_t             bytes[LOG_SLOT_SIZE];
+} LogSlot_t;
+
 //*****************************************************************************
 //                 GLOBAL VARIABLES
 //*****************************************************************************
+// Everything is printed until told otherwise
+volatile uint8_t LogLevel[TermLog_module_count] =
+{
+    TermLog_level_debug,    // general
+    TermLog_level_debug,    // gateway
+    TermLog_level_debug,    // provisioning
+    TermLog_level_debug,    // cloud
+    TermLog_level_debug,    // webServer
+    TermLog_level_debug     // npi
+};
+
 static UART_Handle      uartHandle;
 
+// The ring; a debugger dump of it can be read with term_log_decode -r
+LogSlot_t               logRing[LOG_RING_SLOTS + LOG_MAX_SLOTS - 1];
+// Slots reserved and slots written out, free running
+static volatile uint32_t logHead;
+static volatile uint32_t logTail;
+static uint16_t         logSeq;
+// Prints lost to a full ring since the last notice
+static volatile uint32_t logDropped;
+static bool             logBinary;
+
+static sem_t            logSem;
+static pthread_mutex_t  logMutex;
+static char             logLine[LOG_LINE_SIZE];
+
+//*****************************************************************************
+//                 LOCAL FUNCTION PROTOTYPES
+//*****************************************************************************
+static int logPrint(TermLog_module_t module, TermLog_level_t level,
+                    const char *pcFormat, va_list list);
+static void *logThread(void *arg0);
+static void termWrite(const void *pBuf, size_t len);
+
 //*****************************************************************************
 //
 //! Initialization
@@ -79,6 +143,13 @@ UART_Handle InitTerm(void)
 {
 
     UART_Params   		uartParams;
+    pthread_mutexattr_t mutexAttrs;
+
+    /* A high priority thread can flush while the log thread is writing */
+    pthread_mutexattr_init(&mutexAttrs);
+    pthread_mutexattr_setprotocol(&mutexAttrs, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&logMutex, &mutexAttrs);
+    sem_init(&logSem, 0, 0);
 
     Board_initUART();
     UART_Params_init(&uartParams);
@@ -93,6 +164,29 @@ UART_Handle InitTerm(void)
     /* remove uart receive from LPDS dependency */
     UART_control(uartHandle, UART_CMD_RXDISABLE, NULL);
 
+    /* Start the thread writing out the prints, anything printed before now
+       is still in the ring */
+    {
+        pthread_t           thread = (pthread_t) NULL;
+        pthread_attr_t      attrs;
+        struct sched_param  priParam;
+        int32_t             retc;
+
+        pthread_attr_init(&attrs);
+        priParam.sched_priority = LOG_TASK_PRI;
+        retc = pthread_attr_setschedparam(&attrs, &priParam);
+        retc |= pthread_attr_setstacksize(&attrs, TASKSTACKSIZE);
+        retc |= pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
+        retc |= pthread_create(&thread, &attrs, logThread, NULL);
+        if(retc != 0)
+        {
+            static const char err[] = "[Term] could not create log thread\n\r";
+
+            termWrite(err, sizeof(err) - 1);
+            while(1);
+        }
+    }
+
     return(uartHandle);
 }
 
@@ -106,51 +200,166 @@ UART_Handle InitTerm(void)
 //! \param[in]  [variable number of] arguments according to the format in the
 //!             first parameters
 //!
-//! \return count of characters printed
+//! \return 0, or -1 if the log ring was full and the print dropped
+//!
+//! \note The text is written later by the log thread, see ReportLog().
 //
 //*****************************************************************************
 int Report(const char *pcFormat, ...)
 {
-    int     iRet = 0;
-    char        *pcBuff;
-    char        *pcTemp;
-    int         iSize = 256;
+    int         iRet = 0;
     va_list     list;
 
+    if(LogLevel[TermLog_module_general] >= TermLog_level_info)
+    {
+        va_start(list, pcFormat);
+        iRet = logPrint(TermLog_module_general, TermLog_level_info, pcFormat,
+                        list);
+        va_end(list);
+    }
+
+    return iRet;
+}
+
+//*****************************************************************************
+//
+//! Queues a print of a module
+//!
+//! The format string address and the argument values are put in the log
+//! ring, the log thread formats and writes them. The format string must
+//! stay in place, i.e. be a literal. Errors are written out before
+//! returning.
+//!
+//! \param[in]  module  - module printing, TermLog_module_t
+//! \param[in]  level   - level of the print, TermLog_level_t
+//! \param[in]  format  - printf format string
+//! \param[in]  [variable number of] arguments according to the format
+//!
+//! \return 0, or -1 if the log ring was full and the print dropped
+//
+//*****************************************************************************
+int ReportLog(TermLog_module_t module, TermLog_level_t level,
+              const char *pcFormat, ...)
+{
+    int         iRet;
+    va_list     list;
 
-    pcBuff = (char*)malloc(iSize);
-    if(pcBuff == NULL)
+    va_start(list, pcFormat);
+    iRet = logPrint(module, level, pcFormat, list);
+    va_end(list);
+
+    return iRet;
+}
+
+//*****************************************************************************
+//
+//! Sets the verbosity of a module
+//!
+//! \param[in]  module  - the module, TermLog_module_t
+//! \param[in]  level   - most verbose level printed, TermLog_level_t
+//!
+//! \return none
+//
+//*****************************************************************************
+void SetLogLevel(TermLog_module_t module, TermLog_level_t level)
+{
+    if(module < TermLog_module_count)
     {
-        return -1;
+        LogLevel[module] = level;
     }
-    while(1)
+}
+
+//*****************************************************************************
+//
+//! Selects binary logging
+//!
+//! In binary mode the log thread writes the records as they are, for
+//! term_log_decode on a host to format. This takes much less UART time.
+//!
+//! \param[in]  binary  - true for binary records, false for text
+//!
+//! \return none
+//
+//*****************************************************************************
+void SetLogBinary(bool binary)
+{
+    FlushLog();
+    logBinary = binary;
+}
+
+//*****************************************************************************
+//
+//! Writes out the queued prints
+//!
+//! Called by the log thread, and before anything is written to or read from
+//! the console directly so the output stays in order. A print still being
+//! queued by a preempted thread stops the flush, the log thread writes it
+//! and what follows once it is queued.
+//!
+//! \param  none
+//!
+//! \return none
+//
+//*****************************************************************************
+void FlushLog(void)
+{
+    uint32_t    dropped;
+    UInt        key;
+
+    if(uartHandle == NULL)
     {
-        va_start(list,pcFormat);
-        iRet = vsnprintf(pcBuff, iSize, pcFormat, list);
-        va_end(list);
-        if((iRet > -1) && (iRet < iSize))
+        return;
+    }
+
+    pthread_mutex_lock(&logMutex);
+    while(logTail != logHead)
+    {
+        volatile TermLog_header_t *pHdr = &logRing[logTail % LOG_RING_SLOTS].hdr;
+        uint32_t    slots;
+        uint32_t    i;
+
+        if((pHdr->flags & TERM_LOG_FLAG_READY) == 0)
         {
             break;
         }
+        slots = (sizeof(TermLog_header_t) + pHdr->argLen + LOG_SLOT_SIZE - 1)
+                / LOG_SLOT_SIZE;
+
+        if(logBinary)
+        {
+            termWrite((const void *)pHdr,
+                      sizeof(TermLog_header_t) + pHdr->argLen);
+        }
         else
         {
-            iSize *= 2;
-            if((pcTemp = realloc(pcBuff, iSize)) == NULL)
-            {
-                Message("Could not reallocate memory\n\r");
-                iRet = -1;
-                break;
-            }
-            else
-            {
-                pcBuff = pcTemp;
-            }
+            int len = TermLog_format((const TermLog_header_t *)pHdr,
+                                     (const char *)(uintptr_t)pHdr->format,
+                                     logLine, sizeof(logLine));
+            termWrite(logLine, len);
+        }
+
+        /* Any of its slots can start a record next time round, and must
+           not look ready before that one is */
+        for(i = 0; i < slots; i++)
+        {
+            logRing[(logTail % LOG_RING_SLOTS) + i].hdr.flags = 0;
         }
+        logTail += slots;
     }
-    Message(pcBuff);
-    free(pcBuff);
 
-    return iRet;
+    key = Hwi_disable();
+    dropped = logDropped;
+    logDropped = 0;
+    Hwi_restore(key);
+    if((dropped != 0) && !logBinary)
+    {
+        /* Binary records show the loss as a gap in the sequence numbers */
+        int len = snprintf(logLine, sizeof(logLine),
+                           "[Term] %u prints dropped\n\r",
+                           (unsigned int)dropped);
+        termWrite(logLine, len);
+    }
+    pthread_mutex_unlock(&logMutex);
 }
 
 //*****************************************************************************
@@ -211,6 +420,7 @@ int GetCmd(char *pcBuffer, unsigned int uiBufLen)
     int     iLen = 0;
 
 
+    FlushLog();
     UART_readPolling(uartHandle, &cChar, 1);
 
     iLen = 0;
@@ -293,11 +503,8 @@ int GetCmd(char *pcBuffer, unsigned int uiBufLen)
 //*****************************************************************************
 void Message(const char *str)
 {
-#ifdef UART_NONPOLLING
-    UART_write(uartHandle, str, strlen(str));
-#else
-    UART_writePolling(uartHandle, str, strlen(str));
-#endif
+    FlushLog();
+    termWrite(str, strlen(str));
 }
 
 //*****************************************************************************
@@ -331,6 +538,7 @@ char getch(void)
   char  ch;
 
 
+  FlushLog();
   UART_readPolling(uartHandle, &ch, 1);
   return ch;
 }
@@ -346,5 +554,131 @@ char getch(void)
 //*****************************************************************************
 void putch(char ch)
 {
+  FlushLog();
   UART_writePolling(uartHandle, &ch, 1);
 }
+
+//*****************************************************************************
+//                 LOCAL FUNCTIONS
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! Puts a print in the log ring
+//!
+//! Only the slots are reserved with interrupts off; the record is filled in
+//! after, and marked ready last.
+//!
+//! \param[in]  module  - module printing
+//! \param[in]  level   - level of the print
+//! \param[in]  format  - printf format string
+//! \param[in]  list    - arguments of the format
+//!
+//! \return 0, or -1 if the ring was full
+//
+//*****************************************************************************
+static int logPrint(TermLog_module_t module, TermLog_level_t level,
+                    const char *pcFormat, va_list list)
+{
+    TermLog_header_t    *pHdr;
+    va_list     copy;
+    uint16_t    argLen;
+    uint8_t     flags = TERM_LOG_FLAG_READY;
+    uint32_t    slots;
+    uint32_t    first = 0;
+    uint16_t    seq = 0;
+    bool        full;
+    UInt        key;
+
+    va_copy(copy, list);
+    argLen = TermLog_capture(NULL, 0, pcFormat, copy);
+    va_end(copy);
+    if(argLen > LOG_MAX_ARGS)
+    {
+        argLen = LOG_MAX_ARGS;
+        flags |= TERM_LOG_FLAG_TRUNCATED;
+    }
+    slots = (sizeof(TermLog_header_t) + argLen + LOG_SLOT_SIZE - 1)
+            / LOG_SLOT_SIZE;
+
+    key = Hwi_disable();
+    full = ((logHead - logTail) + slots) > LOG_RING_SLOTS;
+    if(full)
+    {
+        logDropped++;
+    }
+    else
+    {
+        first = logHead;
+        logHead += slots;
+        seq = logSeq++;
+    }
+    Hwi_restore(key);
+
+    if(full)
+    {
+        return -1;
+    }
+
+    pHdr = &logRing[first % LOG_RING_SLOTS].hdr;
+    pHdr->magic = TERM_LOG_MAGIC;
+    pHdr->seq = seq;
+    pHdr->time = (uint32_t)Clock_getTicks();
+    pHdr->format = (uint32_t)(uintptr_t)pcFormat;
+    pHdr->argLen = argLen;
+    pHdr->module = module;
+    pHdr->level = level;
+    (void)TermLog_capture((uint8_t *)(pHdr + 1), argLen, pcFormat, list);
+
+    /* After the call, so the record is complete when the flag is seen */
+    ((volatile TermLog_header_t *)pHdr)->flags = flags;
+    sem_post(&logSem);
+
+    if(level == TermLog_level_error)
+    {
+        /* May be followed by a hang, get it out now */
+        FlushLog();
+    }
+
+    return 0;
+}
+
+//*****************************************************************************
+//
+//! Log thread, writes out the prints at low priority
+//!
+//! \param[in]  arg0    - unused
+//!
+//! \return none
+//
+//*****************************************************************************
+static void *logThread(void *arg0)
+{
+    while(1)
+    {
+        sem_wait(&logSem);
+        FlushLog();
+    }
+}
+
+//*****************************************************************************
+//
+//! Writes bytes to the UART
+//!
+//! \param[in]  pBuf    - the bytes
+//! \param[in]  len     - number of bytes
+//!
+//! \return none
+//!
+//! \note If UART_NONPOLLING defined in than this should be called in
+//!       task/thread context only.
+//
+//*****************************************************************************
+static void termWrite(const void *pBuf, size_t len)
+{
+#ifdef UART_NONPOLLING
+    UART_write(uartHandle, pBuf, len);
+#else
+    UART_writePolling(uartHandle, pBuf, len);
+#endif
+}
@@ -46,15 +46,37 @@
 #ifndef __UART_IF_H__
 #define __UART_IF_H__
 
+// Standard includes
+#include <stdbool.h>
+
 // TI-Driver includes
 #include <ti/drivers/UART.h>
 #include "Board.h"
+#include "term_log.h"
 
 //Defines
 
-#define UART_PRINT Report
-#define DBG_PRINT  Report
-#define ERR_PRINT(x) Report("Error [%d] at line [%d] in function [%s]  \n\r",x,__LINE__,__FUNCTION__)
+// A source file sets its module before its includes, e.g.
+//   #define LOG_MODULE TermLog_module_gateway
+#ifndef LOG_MODULE
+#define LOG_MODULE TermLog_module_general
+#endif
+
+// Prints are queued and written to the UART by a low priority thread. The
+// level check comes first, so a filtered print doesn't evaluate its
+// arguments.
+#define LOG_ENABLED(level) ((level) <= LogLevel[LOG_MODULE])
+
+#define UART_PRINT(...) (LOG_ENABLED(TermLog_level_info) ?                  \
+                         ReportLog(LOG_MODULE, TermLog_level_info,          \
+                                   __VA_ARGS__) : 0)
+#define DBG_PRINT(...)  (LOG_ENABLED(TermLog_level_debug) ?                 \
+                         ReportLog(LOG_MODULE, TermLog_level_debug,         \
+                                   __VA_ARGS__) : 0)
+#define ERR_PRINT(x) ReportLog(LOG_MODULE, TermLog_level_error, "Error [%d] at line [%d] in function [%s]  \n\r",x,__LINE__,__FUNCTION__)
+
+// Verbosity of each module, TermLog_level_t
+extern volatile uint8_t LogLevel[TermLog_module_count];
 
 /* API */
 
@@ -62,6 +84,15 @@ UART_Handle InitTerm(void);
 
 int Report(const char *pcFormat, ...);
 
+int ReportLog(TermLog_module_t module, TermLog_level_t level,
+              const char *pcFormat, ...);
+
+void SetLogLevel(TermLog_module_t module, TermLog_level_t level);
+
+void SetLogBinary(bool binary);
+
+void FlushLog(void);
+
 int TrimSpace(char * pcInput);
 
 int GetCmd(char *pcBuffer, unsigned int uiBufLen);
@@ -99,6 +99,28 @@
 /*! FH Poll/Sensor msg start time randomization window */
 #define CONFIG_FH_START_POLL_DATA_RAND_WINDOW 10000
 
+/*!
+ Number of sensor readings buffered and sent together in one
+ Smsgs_cmdIds_sensorDataBatch message. The sensors are then read
+ CONFIG_SENSOR_BATCH_SIZE times per reporting interval. A value of 1 sends
+ a Smsgs_cmdIds_sensorData message for every reading. A batch too long for
+ one frame is split over several messages.
+ */
+#define CONFIG_SENSOR_BATCH_SIZE 1
+
+#if (CONFIG_SENSOR_BATCH_SIZE < 1) || (CONFIG_SENSOR_BATCH_SIZE > 255)
+#error "CONFIG_SENSOR_BATCH_SIZE must be between 1 and 255"
+#endif
+
+/*!
+ Fast poll interval in milliseconds for sleepy devices. After receiving data
+ from the parent the device polls this often, then doubles the interval on
+ every poll without data until it is back at the polling interval.
+ 0 disables the fast polling, it can also be set by the collector in the
+ configuration request message.
+ */
+#define CONFIG_FAST_POLLING_INTERVAL 0
+
 #if (((CONFIG_PHY_ID >= APIMAC_MRFSK_STD_PHY_ID_BEGIN) && (CONFIG_PHY_ID <= APIMAC_MRFSK_GENERIC_PHY_ID_BEGIN)) || \
     ((CONFIG_PHY_ID >= APIMAC_GENERIC_US_915_PHY_132) && (CONFIG_PHY_ID <= APIMAC_GENERIC_ETSI_863_PHY_133)))
 /*! PAN Advertisement Solicit trickle timer duration in milliseconds */
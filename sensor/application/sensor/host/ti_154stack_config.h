@@ -0,0 +1,2 @@
+/* smsgs.h includes the SysConfig output, nothing oad_push.c uses comes from
+   it */
@@ -126,6 +126,8 @@ typedef struct
     Jdllc_device_states_t prevDevState;
     uint8_t dataFailures;
     uint32_t pollInterval;
+    uint32_t fastPollInterval;
+    uint32_t curPollInterval;
 } devInformation_t;
 
 /******************************************************************************
@@ -166,6 +168,8 @@ STATIC devInformation_t devInfoBlock =
                   Jdllc_deviceStates_scanActive,
                   Jdllc_deviceStates_scanActive,
                    0,
+                  CONFIG_POLLING_INTERVAL,
+                  CONFIG_FAST_POLLING_INTERVAL,
                   CONFIG_POLLING_INTERVAL
                 };
 /* default channel mask */
@@ -291,6 +295,8 @@ static void processFHEvent(uint8_t *pFhFrameVar,
 static void populateInfo(ApiMac_deviceDescriptor_t *pDevInfo,
                          Llc_netInfo_t *pParentNetInfo);
 static void handleMaxDataFail(void);
+static void speedUpPollRate(void);
+static void slowDownPollRate(void);
 
 /******************************************************************************
  Public Functions
@@ -501,7 +507,7 @@ void Jdllc_process(void)
                 || (devInfoBlock.currentJdllcState == Jdllc_states_rejoined))
             {
                 /* set poll timer */
-                Ssf_setPollClock(devInfoBlock.pollInterval);
+                Ssf_setPollClock(devInfoBlock.curPollInterval);
             }
 
             /* send poll request */
@@ -882,6 +888,25 @@ void Jdllc_rejoin(ApiMac_deviceDescriptor_t *pDevInfo,
 void Jdllc_setPollRate(uint32_t pollInterval)
 {
     devInfoBlock.pollInterval = pollInterval;
+    if((devInfoBlock.fastPollInterval == 0)
+       || (devInfoBlock.curPollInterval > pollInterval))
+    {
+        devInfoBlock.curPollInterval = pollInterval;
+    }
+}
+
+/*!
+ Set the fast poll interval.
+
+ Public function defined in jdllc.h
+ */
+void Jdllc_setFastPollRate(uint32_t fastPollInterval)
+{
+    devInfoBlock.fastPollInterval = fastPollInterval;
+    if(fastPollInterval == 0)
+    {
+        devInfoBlock.curPollInterval = devInfoBlock.pollInterval;
+    }
 }
 
 /*!
@@ -916,6 +941,23 @@ void Jdllc_sendDisassociationRequest(void)
     ApiMac_mlmeDisassociateReq(&disassocReq);
 }
 
+/*!
+ Collector restored its network.
+
+ Public function defined in jdllc.h
+ */
+void Jdllc_collectorRestored(void)
+{
+    /* In FH mode the collector's PC frame brings orphans back */
+    if((!CONFIG_FH_ENABLE) &&
+       (devInfoBlock.currentJdllcState == Jdllc_states_orphan))
+    {
+        /* Orphan scan now, the collector will answer it */
+        Ssf_stopScanBackoffClock();
+        switchState(Jdllc_deviceStates_scanOrphan);
+    }
+}
+
 #ifdef FEATURE_MAC_SECURITY
 /*!
  Initialize the MAC Security
@@ -1595,6 +1637,7 @@ static void disassoCnfCb(ApiMac_mlmeDisassociateCnf_t *pData)
         devInfoBlock.prevDevState = Jdllc_deviceStates_scanActive;
         devInfoBlock.dataFailures = 0;
         devInfoBlock.pollInterval = CONFIG_POLLING_INTERVAL;
+        devInfoBlock.curPollInterval = CONFIG_POLLING_INTERVAL;
 
         /* change state back to initWaiting and print on UART */
         updateState(Jdllc_states_initWaiting);
@@ -2070,6 +2113,8 @@ static void sendPollReq()
 #ifdef POWER_MEAS
     Sensor_pwrMeasStats.pollRequestsSent++;
 #endif
+    Sensor_energyStats.polls++;
+    Sensor_energyTx(SENSOR_ENERGY_POLL_FRAME_LEN, 1);
     ApiMac_mlmePollReq(&pollReq);
 }
 
@@ -2117,7 +2162,7 @@ static void processCoordRealign(void)
         if((!CONFIG_RX_ON_IDLE))
         {
             /* start polling if parent matches*/
-            Ssf_setPollClock(devInfoBlock.pollInterval);
+            Ssf_setPollClock(devInfoBlock.curPollInterval);
         }
 
         ApiMac_mlmeSetReqBool(ApiMac_attribute_RxOnWhenIdle, CONFIG_RX_ON_IDLE);
@@ -2183,6 +2228,16 @@ static void pollCnfCb(ApiMac_mlmePollCnf_t *pData)
             }
         }
         devInfoBlock.dataFailures = 0;
+
+        if((pData->status == ApiMac_status_success) || pData->framePending)
+        {
+            /* More data is likely to follow, poll for it sooner */
+            speedUpPollRate();
+        }
+        else
+        {
+            slowDownPollRate();
+        }
     }
     else if(pData->status == ApiMac_status_noAck)
     {
@@ -2234,6 +2289,45 @@ static void pollCnfCb(ApiMac_mlmePollCnf_t *pData)
     }
 }
 
+/*!
+ * @brief       Switch to the fast poll interval, the parent had data for
+ *              this device.
+ */
+static void speedUpPollRate(void)
+{
+    if((devInfoBlock.fastPollInterval == 0)
+       || (devInfoBlock.curPollInterval <= devInfoBlock.fastPollInterval))
+    {
+        return;
+    }
+
+    devInfoBlock.curPollInterval = devInfoBlock.fastPollInterval;
+
+    if(!CONFIG_FH_ENABLE && !CONFIG_RX_ON_IDLE
+       && ((devInfoBlock.currentJdllcState == Jdllc_states_joined)
+           || (devInfoBlock.currentJdllcState == Jdllc_states_rejoined)))
+    {
+        /* Don't wait for the slow poll already scheduled */
+        Ssf_setPollClock(devInfoBlock.curPollInterval);
+    }
+}
+
+/*!
+ * @brief       Double the poll interval, up to the configured poll
+ *              interval, the parent had no data for this device.
+ */
+static void slowDownPollRate(void)
+{
+    if(devInfoBlock.curPollInterval < devInfoBlock.pollInterval)
+    {
+        devInfoBlock.curPollInterval <<= 1;
+        if(devInfoBlock.curPollInterval > devInfoBlock.pollInterval)
+        {
+            devInfoBlock.curPollInterval = devInfoBlock.pollInterval;
+        }
+    }
+}
+
 /*!
  * @brief       Process Disassociate Indication callback
  *
@@ -2265,6 +2359,7 @@ static void disassocIndCb(ApiMac_mlmeDisassociateInd_t *pData)
     devInfoBlock.prevDevState = Jdllc_deviceStates_scanActive;
     devInfoBlock.dataFailures = 0;
     devInfoBlock.pollInterval = CONFIG_POLLING_INTERVAL;
+    devInfoBlock.curPollInterval = CONFIG_POLLING_INTERVAL;
 
     /* change state back to initWaiting and print on UART */
     updateState(Jdllc_states_initWaiting);
@@ -2290,6 +2385,8 @@ static void disassocIndCb(ApiMac_mlmeDisassociateInd_t *pData)
 static void sendScanReq(ApiMac_scantype_t type)
 {
     ApiMac_mlmeScanReq_t scanReq;
+    uint8_t numChannels = 0;
+    uint8_t i;
     /* set common parameters for all scans */
     memset(&scanReq, 0, sizeof(ApiMac_mlmeScanReq_t));
     /* set scan channels from channel mask*/
@@ -2312,6 +2409,17 @@ static void sendScanReq(ApiMac_scantype_t type)
     scanReq.phyID = CONFIG_PHY_ID;
     /* using no security for scan request command */
     memset(&scanReq.sec, 0, sizeof(ApiMac_sec_t));
+
+    /* account for the receiver time of the scan */
+    for(i = 0; i < (APIMAC_154G_CHANNEL_BITMAP_SIZ * 8); i++)
+    {
+        if(defaultChannelMask[i / 8] & (1 << (i % 8)))
+        {
+            numChannels++;
+        }
+    }
+    Sensor_energyScan(numChannels, scanReq.scanDuration);
+
     /* send scan Req */
     ApiMac_mlmeScanReq(&scanReq);
 }
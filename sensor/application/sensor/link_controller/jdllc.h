@@ -350,11 +350,30 @@ extern void Jdllc_rejoin(ApiMac_deviceDescriptor_t *pDevInfo,
  */
 extern void Jdllc_setPollRate(uint32_t pollInterval);
 
+/*!
+ * @brief       API for app to set the fast poll interval.
+ *              <BR>
+ *              After the parent has data for the device, the device polls
+ *              at the fast poll interval and then doubles the interval on
+ *              each poll without data, up to the poll interval.
+ *
+ * @param       fastPollInterval - fast poll interval in milliseconds,
+ *                                 0 to always poll at the poll interval
+ */
+extern void Jdllc_setFastPollRate(uint32_t fastPollInterval);
+
 /*!
  * @brief       API for app to set disassociation request.
  */
 extern void Jdllc_sendDisassociationRequest(void);
 
+/*!
+ * @brief       API for app to report that the collector has restarted and
+ *              restored its network. An orphaned device scans for it right
+ *              away instead of waiting out the scan backoff.
+ */
+extern void Jdllc_collectorRestored(void);
+
 /*!
  * @brief       Initialize the MAC Security
  *
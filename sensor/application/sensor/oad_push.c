@@ -0,0 +1,188 @@
+/******************************************************************************
+
+ @file oad_push.c
+
+ @brief Receive side of the OAD images pushed by the collector
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2019, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <string.h>
+
+#include "oad_push.h"
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static bool isStored(const OadPush_image_t *pImg, uint16_t block);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Start receiving an image
+
+ Public function defined in oad_push.h
+ */
+void OadPush_start(OadPush_image_t *pImg, uint8_t seq, uint16_t numBlocks,
+                   const uint8_t *pHdr, uint16_t numStored)
+{
+    uint16_t block;
+
+    if(numStored > numBlocks)
+    {
+        numStored = numBlocks;
+    }
+
+    memset(pImg->stored, 0, sizeof(pImg->stored));
+    for(block = 0; block < numStored; block++)
+    {
+        pImg->stored[block / 8] |= (uint8_t)(1 << (block % 8));
+    }
+
+    pImg->seq = seq;
+    pImg->numBlocks = numBlocks;
+    pImg->numStored = numStored;
+    pImg->firstMissing = numStored;
+    memcpy(pImg->hdr, pHdr, SMSGS_OAD_IMG_HDR_LEN);
+    pImg->status = (numStored == numBlocks) ?
+                    (uint8_t)Smsgs_oadStatus_complete :
+                    (uint8_t)Smsgs_oadStatus_receiving;
+}
+
+/*!
+ Decline an image
+
+ Public function defined in oad_push.h
+ */
+void OadPush_decline(OadPush_image_t *pImg, uint8_t seq)
+{
+    pImg->seq = seq;
+    pImg->numBlocks = 0;
+    pImg->numStored = 0;
+    pImg->firstMissing = 0;
+    pImg->status = (uint8_t)Smsgs_oadStatus_declined;
+}
+
+/*!
+ Check whether a block is still missing
+
+ Public function defined in oad_push.h
+ */
+bool OadPush_isMissing(const OadPush_image_t *pImg, uint8_t seq,
+                       uint16_t block)
+{
+    return((pImg->status == Smsgs_oadStatus_receiving) &&
+           (seq == pImg->seq) && (block < pImg->numBlocks) &&
+           !isStored(pImg, block));
+}
+
+/*!
+ Record that a block was stored
+
+ Public function defined in oad_push.h
+ */
+void OadPush_blockStored(OadPush_image_t *pImg, uint16_t block)
+{
+    pImg->stored[block / 8] |= (uint8_t)(1 << (block % 8));
+    pImg->numStored++;
+
+    while((pImg->firstMissing < pImg->numBlocks) &&
+          isStored(pImg, pImg->firstMissing))
+    {
+        pImg->firstMissing++;
+    }
+
+    if(pImg->numStored == pImg->numBlocks)
+    {
+        pImg->status = (uint8_t)Smsgs_oadStatus_complete;
+    }
+}
+
+/*!
+ Build the OAD Status Response
+
+ Public function defined in oad_push.h
+ */
+void OadPush_buildStatusRsp(const OadPush_image_t *pImg, uint8_t *pBuf)
+{
+    uint8_t *pMap = pBuf + (SMSGS_OAD_STATUS_RESPONSE_MSG_LEN -
+                            SMSGS_OAD_MISSING_MAP_LEN);
+    uint16_t block = pImg->firstMissing;
+    int n;
+
+    pBuf[0] = (uint8_t)Smsgs_cmdIds_oadStatusRsp;
+    pBuf[1] = pImg->seq;
+    pBuf[2] = pImg->status;
+    pBuf[3] = (uint8_t)(block & 0xFF);
+    pBuf[4] = (uint8_t)(block >> 8);
+
+    /* Blocks past the end of the image are left clear */
+    memset(pMap, 0, SMSGS_OAD_MISSING_MAP_LEN);
+    for(n = 0; (n < (SMSGS_OAD_MISSING_MAP_LEN * 8)) &&
+               (block < pImg->numBlocks); n++, block++)
+    {
+        if(!isStored(pImg, block))
+        {
+            pMap[n / 8] |= (uint8_t)(1 << (n % 8));
+        }
+    }
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Check the map of the blocks stored
+ *
+ * @param       pImg - image being received
+ * @param       block - Block Number, below the Number of Blocks
+ *
+ * @return      true if the block is stored
+ */
+static bool isStored(const OadPush_image_t *pImg, uint16_t block)
+{
+    return((pImg->stored[block / 8] & (1 << (block % 8))) != 0);
+}
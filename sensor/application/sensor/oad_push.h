@@ -0,0 +1,175 @@
+/******************************************************************************
+
+ @file oad_push.h
+
+ @brief Receive side of the OAD images pushed by the collector
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2019, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef OAD_PUSH_H
+#define OAD_PUSH_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "smsgs.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup OadPush Pushed OAD Image Bookkeeping
+ <BR>
+ Keeps track of the blocks of an image pushed with the OAD Image Notify,
+ Image Block and Status Request messages (see smsgs.h), and builds the OAD
+ Status Response.  Storing the blocks and deciding whether the image is
+ wanted are left to the caller.
+ <BR>
+ The code in this module is plain C so a host test can share it.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup OadPush
+ * @{
+ */
+
+#if !defined(OADPUSH_MAX_BLOCKS)
+/*! Most blocks of an image, a full 352 KB flash */
+#define OADPUSH_MAX_BLOCKS ((352UL * 1024UL) / SMSGS_OAD_BLOCK_SIZE)
+#endif
+
+/*! Bytes of the map of the blocks stored */
+#define OADPUSH_MAP_LEN ((OADPUSH_MAX_BLOCKS + 7) / 8)
+
+/*! Status before any OAD Image Notify was heard */
+#define OADPUSH_STATUS_NONE 0xFF
+
+/*! The image being received */
+typedef struct
+{
+    /*! Image Sequence of the image, if status isn't OADPUSH_STATUS_NONE */
+    uint8_t seq;
+    /*! Smsgs_oadStatus_t, or OADPUSH_STATUS_NONE */
+    uint8_t status;
+    /*! Number of blocks of the image */
+    uint16_t numBlocks;
+    /*! Number of blocks stored */
+    uint16_t numStored;
+    /*! First block not stored yet */
+    uint16_t firstMissing;
+    /*! Image Header from the OAD Image Notify */
+    uint8_t hdr[SMSGS_OAD_IMG_HDR_LEN];
+    /*! Bit n (bit n % 8 of byte n / 8) is set once block n is stored */
+    uint8_t stored[OADPUSH_MAP_LEN];
+} OadPush_image_t;
+
+/*! @} end group OadPush */
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief       Start receiving an image.
+ *
+ * @param       pImg - image to start
+ * @param       seq - its Image Sequence
+ * @param       numBlocks - its Number of Blocks, OADPUSH_MAX_BLOCKS at most
+ * @param       pHdr - its Image Header
+ * @param       numStored - blocks from the start of the image already stored,
+ *                          by an earlier attempt cut short by a reset
+ */
+extern void OadPush_start(OadPush_image_t *pImg, uint8_t seq,
+                          uint16_t numBlocks, const uint8_t *pHdr,
+                          uint16_t numStored);
+
+/*!
+ * @brief       Decline an image, the Status Responses say so.
+ *
+ * @param       pImg - image to decline
+ * @param       seq - its Image Sequence
+ */
+extern void OadPush_decline(OadPush_image_t *pImg, uint8_t seq);
+
+/*!
+ * @brief       Check whether a block is one still missing from the image.
+ *
+ * @param       pImg - image being received
+ * @param       seq - Image Sequence of the block
+ * @param       block - Block Number
+ *
+ * @return      true if the block should be stored
+ */
+extern bool OadPush_isMissing(const OadPush_image_t *pImg, uint8_t seq,
+                              uint16_t block);
+
+/*!
+ * @brief       Record that a block was stored.  The status becomes
+ *              Smsgs_oadStatus_complete with the last one.
+ *
+ * @param       pImg - image being received
+ * @param       block - Block Number, one OadPush_isMissing() accepted
+ */
+extern void OadPush_blockStored(OadPush_image_t *pImg, uint16_t block);
+
+/*!
+ * @brief       Build the OAD Status Response for the image.
+ *
+ * @param       pImg - image being received
+ * @param       pBuf - SMSGS_OAD_STATUS_RESPONSE_MSG_LEN bytes to fill
+ */
+extern void OadPush_buildStatusRsp(const OadPush_image_t *pImg,
+                                   uint8_t *pBuf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OAD_PUSH_H */
@@ -0,0 +1,389 @@
+/******************************************************************************
+
+ @file oad_push_test.c
+
+ @brief Host test of pushing an OAD image to many devices
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2019, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+
+ Pushes a random image to a number of devices over a lossy channel, with
+ the rounds the collector runs (see processOadEvt() in the gateway's
+ collector.c), and checks that every device ends up with the image.
+
+   oad_push_test [<devices> [<loss %> [<blocks>]]]
+
+ The devices are the OadPush module of the sensor.  Each one loses every
+ block, Status Request and Status Response with the given probability, and
+ one of them is reset in the middle of the push and resumes from the block
+ it last saved.  The time is that of the collector's clocks: a block every
+ SMSGS_OAD_BLOCK_INTERVAL and a status window of one SMSGS_OAD_STATUS_SLOT
+ per device plus half a second.
+
+ Built on a host only, from this folder, e.g.
+   gcc -DOAD_PUSH_HOST -I host -o oad_push_test oad_push_test.c oad_push.c
+ where host/ stands in for the generated ti_154stack_config.h.
+ *****************************************************************************/
+
+/* Host builds only; the project compiles this file for the device too */
+#ifdef OAD_PUSH_HOST
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "oad_push.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Most devices pushed to */
+#define MAX_DEVICES 200
+
+/* Repair rounds, as OAD_MAX_ROUNDS of the collector */
+#define MAX_ROUNDS 8
+
+/* Status window margin, as OAD_STATUS_MARGIN of the collector (in ms) */
+#define STATUS_MARGIN 500
+
+/* A device and the flash it stores the image in */
+typedef struct
+{
+    OadPush_image_t img;
+    uint8_t flash[OADPUSH_MAX_BLOCKS * SMSGS_OAD_BLOCK_SIZE];
+    /* First Missing of its last Status Response, what it saves in NV */
+    uint16_t saved;
+} device_t;
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+static device_t devices[MAX_DEVICES];
+static uint8_t image[OADPUSH_MAX_BLOCKS * SMSGS_OAD_BLOCK_SIZE];
+/* Blocks of the next round, like oad.toSend of the collector */
+static uint8_t toSend[OADPUSH_MAP_LEN];
+static int lossPercent;
+
+/******************************************************************************
+ Local functions
+ *****************************************************************************/
+
+/*!
+ * @brief   Whether a frame is lost
+ */
+static bool lost(void)
+{
+    return ((rand() % 100) < lossPercent);
+}
+
+/*!
+ * @brief   A device receives an OAD Image Block, checked like
+ *          processOadImgBlock() of the sensor
+ */
+static void rxBlock(device_t *pDev, const uint8_t *pFrame, uint16_t len)
+{
+    uint16_t block = (uint16_t)(pFrame[2] | (pFrame[3] << 8));
+    uint16_t dataLen = len - SMSGS_OAD_IMG_BLOCK_HDR_LEN;
+
+    if(!OadPush_isMissing(&pDev->img, pFrame[1], block) ||
+       ((dataLen != SMSGS_OAD_BLOCK_SIZE) &&
+        (block != (pDev->img.numBlocks - 1))))
+    {
+        return;
+    }
+    memcpy(&pDev->flash[block * SMSGS_OAD_BLOCK_SIZE],
+           &pFrame[SMSGS_OAD_IMG_BLOCK_HDR_LEN], dataLen);
+    OadPush_blockStored(&pDev->img, block);
+}
+
+/*!
+ * @brief   The collector takes an OAD Status Response, like
+ *          processOadStatusResponse() of the gateway
+ *
+ * @return  the status in it
+ */
+static uint8_t rxStatusRsp(const uint8_t *pRsp, uint8_t seq,
+                           uint16_t numBlocks)
+{
+    const uint8_t *pMap = pRsp + (SMSGS_OAD_STATUS_RESPONSE_MSG_LEN -
+                                  SMSGS_OAD_MISSING_MAP_LEN);
+    uint16_t block = (uint16_t)(pRsp[3] | (pRsp[4] << 8));
+    int n;
+
+    if((pRsp[0] != Smsgs_cmdIds_oadStatusRsp) || (pRsp[1] != seq) ||
+       (pRsp[2] != Smsgs_oadStatus_receiving))
+    {
+        return (pRsp[2]);
+    }
+
+    for(n = 0; block < numBlocks; n++, block++)
+    {
+        if((n >= (SMSGS_OAD_MISSING_MAP_LEN * 8)) ||
+           (pMap[n / 8] & (1 << (n % 8))))
+        {
+            toSend[block / 8] |= (uint8_t)(1 << (block % 8));
+        }
+    }
+    return (pRsp[2]);
+}
+
+/*!
+ * @brief   Checks of the bookkeeping on its own
+ *
+ * @return  number of failures
+ */
+static int checkBookkeeping(void)
+{
+    static OadPush_image_t img;
+    uint8_t hdr[SMSGS_OAD_IMG_HDR_LEN] = {0};
+    uint8_t rsp[SMSGS_OAD_STATUS_RESPONSE_MSG_LEN];
+    int failures = 0;
+
+    /* 300 blocks, 0-9 stored before a reset, then 12 and 140 */
+    OadPush_start(&img, 7, 300, hdr, 10);
+    OadPush_blockStored(&img, 12);
+    OadPush_blockStored(&img, 140);
+    OadPush_buildStatusRsp(&img, rsp);
+    failures += (rsp[2] != Smsgs_oadStatus_receiving);
+    failures += ((rsp[3] | (rsp[4] << 8)) != 10);
+    /* Bit 2 (block 12) clear, the rest of the map set, block 140 is past
+       the map */
+    failures += (rsp[5] != 0xFB);
+    failures += (rsp[5 + SMSGS_OAD_MISSING_MAP_LEN - 1] != 0xFF);
+
+    failures += OadPush_isMissing(&img, 8, 11);
+    failures += OadPush_isMissing(&img, 7, 12);
+    failures += OadPush_isMissing(&img, 7, 300);
+    failures += !OadPush_isMissing(&img, 7, 11);
+
+    /* The end of the image leaves the rest of the map clear */
+    OadPush_start(&img, 9, 20, hdr, 16);
+    OadPush_buildStatusRsp(&img, rsp);
+    failures += ((rsp[5] != 0x0F) || (rsp[6] != 0));
+    OadPush_blockStored(&img, 16);
+    OadPush_blockStored(&img, 17);
+    OadPush_blockStored(&img, 19);
+    OadPush_blockStored(&img, 18);
+    failures += (img.status != Smsgs_oadStatus_complete);
+    failures += (img.firstMissing != 20);
+
+    OadPush_decline(&img, 10);
+    OadPush_buildStatusRsp(&img, rsp);
+    failures += ((rsp[1] != 10) || (rsp[2] != Smsgs_oadStatus_declined));
+    failures += OadPush_isMissing(&img, 10, 0);
+
+    printf("bookkeeping: %d failures\n", failures);
+    return (failures);
+}
+
+/******************************************************************************
+ Public functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint8_t frame[SMSGS_OAD_IMG_BLOCK_HDR_LEN + SMSGS_OAD_BLOCK_SIZE];
+    uint8_t rsp[SMSGS_OAD_STATUS_RESPONSE_MSG_LEN];
+    uint8_t status[MAX_DEVICES];
+    uint8_t hdr[SMSGS_OAD_IMG_HDR_LEN];
+    const uint8_t seq = 42;
+    int numDevices = 50;
+    int numBlocks = 2880;
+    int numComplete = 0;
+    int failures;
+    long numFrames = 0;
+    long timeMs = 0;
+    int round;
+    int block;
+    int d;
+
+    if(argc > 1)
+    {
+        numDevices = atoi(argv[1]);
+    }
+    if(argc > 2)
+    {
+        lossPercent = atoi(argv[2]);
+    }
+    else
+    {
+        lossPercent = 5;
+    }
+    if(argc > 3)
+    {
+        numBlocks = atoi(argv[3]);
+    }
+    if((numDevices < 1) || (numDevices > MAX_DEVICES) ||
+       (numBlocks < 1) || (numBlocks > (int)OADPUSH_MAX_BLOCKS))
+    {
+        printf("at most %d devices and %lu blocks\n", MAX_DEVICES,
+               (unsigned long)OADPUSH_MAX_BLOCKS);
+        return (1);
+    }
+
+    failures = checkBookkeeping();
+
+    srand(1);
+    for(block = 0; block < (numBlocks * SMSGS_OAD_BLOCK_SIZE); block++)
+    {
+        image[block] = (uint8_t)rand();
+    }
+    memcpy(hdr, image, sizeof(hdr));
+
+    /* Every device hears the notify, queued if it is sleepy */
+    for(d = 0; d < numDevices; d++)
+    {
+        OadPush_start(&devices[d].img, seq, numBlocks, hdr, 0);
+        status[d] = Smsgs_oadStatus_receiving;
+    }
+    for(block = 0; block < numBlocks; block++)
+    {
+        toSend[block / 8] |= (uint8_t)(1 << (block % 8));
+    }
+
+    for(round = 0; round <= MAX_ROUNDS; round++)
+    {
+        int sent = 0;
+
+        for(block = 0; block < numBlocks; block++)
+        {
+            uint16_t len = SMSGS_OAD_BLOCK_SIZE;
+
+            if(!(toSend[block / 8] & (1 << (block % 8))))
+            {
+                continue;
+            }
+            toSend[block / 8] &= (uint8_t)~(1 << (block % 8));
+            if(block == (numBlocks - 1))
+            {
+                /* A short last block */
+                len = SMSGS_OAD_BLOCK_SIZE / 2;
+            }
+            frame[0] = Smsgs_cmdIds_oadImgBlock;
+            frame[1] = seq;
+            frame[2] = (uint8_t)(block & 0xFF);
+            frame[3] = (uint8_t)(block >> 8);
+            memcpy(&frame[SMSGS_OAD_IMG_BLOCK_HDR_LEN],
+                   &image[block * SMSGS_OAD_BLOCK_SIZE], len);
+            for(d = 0; d < numDevices; d++)
+            {
+                if(!lost())
+                {
+                    rxBlock(&devices[d], frame,
+                            SMSGS_OAD_IMG_BLOCK_HDR_LEN + len);
+                }
+            }
+            sent++;
+
+            /* Device 0 resets halfway through the first round */
+            if((round == 0) && (block == (numBlocks / 2)))
+            {
+                OadPush_start(&devices[0].img, seq, numBlocks, hdr,
+                              devices[0].saved);
+            }
+        }
+        numFrames += sent + 1;
+        timeMs += (long)sent * SMSGS_OAD_BLOCK_INTERVAL;
+
+        /* Status Request to the devices still receiving */
+        for(d = 0; d < numDevices; d++)
+        {
+            if((status[d] != Smsgs_oadStatus_receiving) || lost())
+            {
+                continue;
+            }
+            OadPush_buildStatusRsp(&devices[d].img, rsp);
+            if(devices[d].img.status == Smsgs_oadStatus_receiving)
+            {
+                devices[d].saved = devices[d].img.firstMissing;
+            }
+            numFrames++;
+            if(!lost())
+            {
+                status[d] = rxStatusRsp(rsp, seq, numBlocks);
+            }
+        }
+        timeMs += (numDevices * SMSGS_OAD_STATUS_SLOT) + STATUS_MARGIN;
+
+        for(block = 0; block < numBlocks; block++)
+        {
+            if(toSend[block / 8] & (1 << (block % 8)))
+            {
+                break;
+            }
+        }
+        if(block == numBlocks)
+        {
+            break;
+        }
+    }
+
+    for(d = 0; d < numDevices; d++)
+    {
+        if(devices[d].img.status == Smsgs_oadStatus_complete)
+        {
+            numComplete++;
+            if(memcmp(devices[d].flash, image,
+                      ((numBlocks - 1) * SMSGS_OAD_BLOCK_SIZE) +
+                      (SMSGS_OAD_BLOCK_SIZE / 2)) != 0)
+            {
+                printf("device %d stored a corrupt image\n", d);
+                failures++;
+            }
+        }
+    }
+
+    printf("push: %d devices, %d%% loss, %d blocks: %d rounds, %ld frames, "
+           "%.1f min, %d complete\n", numDevices, lossPercent, numBlocks,
+           (round > MAX_ROUNDS) ? MAX_ROUNDS + 1 : round + 1, numFrames,
+           timeMs / 60000.0, numComplete);
+
+    return ((failures == 0) ? 0 : 1);
+}
+
+#endif /* OAD_PUSH_HOST */
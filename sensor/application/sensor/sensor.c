@@ -48,6 +48,7 @@
  Includes
  *****************************************************************************/
 #include <string.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "mac_util.h"
 #include "api_mac.h"
@@ -55,6 +56,7 @@
 #include "ssf.h"
 #include "smsgs.h"
 #include "sensor.h"
+#include "oad_push.h"
 #include <advanced_config.h>
 #include "ti_154stack_config.h"
 
@@ -122,9 +124,50 @@
 #define MIN_POLLING_INTERVAL 1000
 #define MAX_POLLING_INTERVAL 10000
 
+/* Fast Polling Interval Min (in milliseconds) */
+#define MIN_FAST_POLLING_INTERVAL 100
+
 /* Blink Time for Identify LED Request (in milliseconds) */
 #define IDENTIFY_LED_TIME 1000
 
+/* Minimum interval between batched sensor readings (in milliseconds) */
+#define MIN_SAMPLE_INTERVAL 100
+
+/* Time from reporting a pushed OAD image complete to installing it (in
+   milliseconds), for the OAD Status Response to go out */
+#define OAD_INSTALL_DELAY 2000
+
+/* PHY bit and symbol rates used for the airtime estimates */
+#if ((CONFIG_PHY_ID >= APIMAC_GENERIC_US_LRM_915_PHY_129) && \
+     (CONFIG_PHY_ID <= APIMAC_GENERIC_ETSI_LRM_863_PHY_131))
+#define ENERGY_BIT_RATE 5000
+#define ENERGY_SYMBOL_RATE 20000
+#elif ((CONFIG_PHY_ID >= APIMAC_GENERIC_US_915_PHY_132) && \
+       (CONFIG_PHY_ID <= APIMAC_GENERIC_ETSI_863_PHY_133))
+#define ENERGY_BIT_RATE 200000
+#define ENERGY_SYMBOL_RATE 200000
+#elif ((CONFIG_PHY_ID >= APIMAC_MRFSK_STD_PHY_ID_BEGIN) && \
+       (CONFIG_PHY_ID <= APIMAC_MRFSK_GENERIC_PHY_ID_END))
+#define ENERGY_BIT_RATE 50000
+#define ENERGY_SYMBOL_RATE 50000
+#else
+#define ENERGY_BIT_RATE 250000
+#define ENERGY_SYMBOL_RATE 62500
+#endif
+/* Over the air length of an ack frame (in bytes) */
+#define ENERGY_ACK_FRAME_LEN 15
+/* Time the receiver stays on waiting for an ack (in microseconds) */
+#define ENERGY_ACK_WAIT_US 1000
+/* aBaseSuperframeDuration, the scan time unit (in symbols) */
+#define ENERGY_SCAN_BASE_SYMBOLS 960
+
+#ifdef SENSOR_COMPACT_ENCODING
+/* Compact reports between reports with absolute message statistics */
+#define COMPACT_KEYFRAME_INTERVAL 10
+/* Number of 16 bit values in the message statistics field */
+#define COMPACT_NUM_STATS (sizeof(Smsgs_msgStatsField_t) / sizeof(uint16_t))
+#endif /* SENSOR_COMPACT_ENCODING */
+
 /* Inter packet interval in certification test mode */
 #if CERTIFICATION_TEST_MODE
 #if ((CONFIG_PHY_ID >= APIMAC_MRFSK_STD_PHY_ID_BEGIN) && (CONFIG_PHY_ID <= APIMAC_MRFSK_GENERIC_PHY_ID_BEGIN))
@@ -140,6 +183,51 @@
 #endif
 #endif
 
+#if !defined(OAD_IMG_A) && (CONFIG_SENSOR_BATCH_SIZE > 1)
+/*
+ Longest batched sensor data message.  The frame (127 bytes at 2.4 GHz,
+ kept to 255 bytes sub-GHz) also carries the MAC header with security
+ (APIMAC_MHR_LEN), a 32 bit MIC and the FCS.  Batches that don't fit are
+ split over several messages.
+ */
+#ifdef FREQ_2_4G
+#define SENSOR_BATCH_MAX_LEN (127 - APIMAC_MHR_LEN - APIMAC_MIC_32_LEN - 2)
+#else
+#define SENSOR_BATCH_MAX_LEN (255 - APIMAC_MHR_LEN - APIMAC_MIC_32_LEN - 2)
+#endif
+#ifdef LPSTK
+/* Hall effect (4) and accelerometer (8) fields of a sample */
+#define SENSOR_BATCH_LPSTK_LEN 12
+#else
+#define SENSOR_BATCH_LPSTK_LEN 0
+#endif /* LPSTK */
+/* Longest sample, with every sample field */
+#define SENSOR_BATCH_MAX_SAMPLE_LEN (SMSGS_BATCH_SAMPLE_AGE_LEN + \
+                                     SMSGS_SENSOR_TEMP_LEN + \
+                                     SMSGS_SENSOR_LIGHT_LEN + \
+                                     SMSGS_SENSOR_HUMIDITY_LEN + \
+                                     SENSOR_BATCH_LPSTK_LEN)
+
+#if (SMSGS_BASIC_SENSOR_BATCH_LEN + SENSOR_BATCH_MAX_SAMPLE_LEN) > \
+    SENSOR_BATCH_MAX_LEN
+#error "A batched sensor data message must have room for one sample"
+#endif
+
+/* Sensor reading buffered for the batched sensor data message */
+typedef struct
+{
+    /* Tick count when the sensors were read */
+    uint32_t timestamp;
+    Smsgs_tempSensorField_t tempSensor;
+    Smsgs_lightSensorField_t lightSensor;
+    Smsgs_humiditySensorField_t humiditySensor;
+#ifdef LPSTK
+    Smsgs_hallEffectSensorField_t hallEffectSensor;
+    Smsgs_accelSensorField_t accelerometerSensor;
+#endif /* LPSTK */
+} Sensor_sample_t;
+#endif
+
 /******************************************************************************
  Global variables
  *****************************************************************************/
@@ -160,6 +248,11 @@ extern bool parentFound;
 Smsgs_powerMeastatsField_t Sensor_pwrMeasStats =
     { 0 };
 #endif
+
+/*! Energy and airtime accounting for the current reporting period */
+Smsgs_energyStatsField_t Sensor_energyStats =
+    { 0 };
+
 /******************************************************************************
  Local variables
  *****************************************************************************/
@@ -178,9 +271,37 @@ static uint_fast32_t joinTimeTicks = 0;
 /* End to end delay statistics timestamp */
 static uint32_t startSensorMsgTimeStamp = 0;
 
+/* Start of the current energy accounting period (in ticks) */
+static uint32_t energyPeriodStart = 0;
+
+/* Payload length of the last data request handed to the MAC */
+static uint16_t energyTxLen = 0;
+
+/* Trace ID of the last sensor report */
+static uint16_t traceId = 0;
+
+/* Delivery delay of the last confirmed sensor report (in milliseconds) */
+static uint16_t traceRadioDelay = 0;
+
 /*! Device's Outgoing MSDU Handle values */
 STATIC uint8_t deviceTxMsduHandle = 0;
 
+/*! Sequence number of the last group command carried out, 0x100 if none */
+STATIC uint16_t groupCmdSeq = 0x100;
+/*! Group Command Response, sent again if the command is */
+STATIC uint8_t groupCmdRsp[SMSGS_GROUP_CMD_RESPONSE_MSG_LEN];
+/*! Where the Group Command Response goes when its slot comes */
+STATIC ApiMac_sAddr_t groupCmdRspAddr;
+
+/*! Pushed OAD image, nothing heard of one yet */
+STATIC OadPush_image_t oadImage = {0, OADPUSH_STATUS_NONE};
+/*! OAD Status Response, sent when its slot comes */
+STATIC uint8_t oadStatusRsp[SMSGS_OAD_STATUS_RESPONSE_MSG_LEN];
+/*! Where the OAD Status Response goes */
+STATIC ApiMac_sAddr_t oadStatusRspAddr;
+/*! The OAD image was reported complete, install it when the clock fires */
+STATIC bool oadInstall = false;
+
 STATIC Smsgs_configReqMsg_t configSettings;
 
 #if !defined(OAD_IMG_A)
@@ -221,6 +342,28 @@ STATIC Smsgs_accelSensorField_t accelerometerSensor =
     { 0 };
 #endif /* LPSTK */
 
+#if CONFIG_SENSOR_BATCH_SIZE > 1
+/*! Ring of sensor readings waiting to be sent, oldest at sampleHead */
+STATIC Sensor_sample_t sampleRing[CONFIG_SENSOR_BATCH_SIZE];
+STATIC uint8_t sampleHead = 0;
+STATIC uint8_t sampleCount = 0;
+#endif
+
+#ifdef SENSOR_COMPACT_ENCODING
+/*! Report sequence number of the last compact sensor data message */
+STATIC uint8_t compactSeq = SMSGS_COMPACT_NO_BASE;
+/*! Report sequence number of the last confirmed compact message */
+STATIC uint8_t compactBaseSeq = SMSGS_COMPACT_NO_BASE;
+/*! Report sequence number of the compact message waiting for its confirm */
+STATIC uint8_t compactPendingSeq = SMSGS_COMPACT_NO_BASE;
+/*! Compact messages sent since the last absolute message statistics */
+STATIC uint8_t compactDeltaCount = 0;
+/*! Message statistics sent in compactBaseSeq */
+STATIC uint16_t compactBaseStats[COMPACT_NUM_STATS];
+/*! Message statistics sent in compactPendingSeq */
+STATIC uint16_t compactPendingStats[COMPACT_NUM_STATS];
+#endif /* SENSOR_COMPACT_ENCODING */
+
 #endif //OAD_IMG_A
 
 STATIC Llc_netInfo_t parentInfo = {0};
@@ -249,10 +392,31 @@ static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd);
 static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType);
 
 #if !defined(OAD_IMG_A)
+static uint32_t getReadingInterval(void);
+static void buildSensorMessage(Smsgs_sensorMsg_t *pMsg);
 static void processSensorMsgEvt(void);
 static bool sendSensorMessage(ApiMac_sAddr_t *pDstAddr,
                               Smsgs_sensorMsg_t *pMsg);
+static uint8_t *bufferMsgStats(uint8_t *pBuf, Smsgs_msgStatsField_t *pStats);
+static uint8_t *bufferEnergyStats(uint8_t *pBuf,
+                                  Smsgs_energyStatsField_t *pStats);
+static uint8_t *bufferLatencyTrace(uint8_t *pBuf,
+                                   Smsgs_latencyTraceField_t *pTrace);
+#ifdef SENSOR_COMPACT_ENCODING
+static bool sendCompactSensorMessage(ApiMac_sAddr_t *pDstAddr,
+                                     Smsgs_sensorMsg_t *pMsg);
+static uint8_t *bufferCompactMsgStats(uint8_t *pBuf,
+                                      Smsgs_msgStatsField_t *pStats);
+static uint8_t *bufferVarint(uint8_t *pBuf, uint32_t value);
+static uint8_t *bufferZigZag(uint8_t *pBuf, int32_t value);
+#endif
 static void readSensors(void);
+#if CONFIG_SENSOR_BATCH_SIZE > 1
+static void storeSensorSample(void);
+static void processSensorBatchMsgEvt(void);
+static uint8_t sendSensorBatchMessage(ApiMac_sAddr_t *pDstAddr,
+                                      Smsgs_sensorMsg_t *pMsg);
+#endif
 #endif //OAD_IMG_A
 
 #if SENSOR_TEST_RAMP_DATA_SIZE
@@ -265,8 +429,16 @@ static void lpstkAccelerometerTiltCb(void);
 
 static void processConfigRequest(ApiMac_mcpsDataInd_t *pDataInd);
 static void processBroadcastCtrlMsg(ApiMac_mcpsDataInd_t *pDataInd);
+static void processGroupCmdRequest(ApiMac_mcpsDataInd_t *pDataInd);
+static void processOadImgNotify(ApiMac_mcpsDataInd_t *pDataInd);
+static void processOadImgBlock(ApiMac_mcpsDataInd_t *pDataInd);
+static void processOadStatusReq(ApiMac_mcpsDataInd_t *pDataInd);
+static void finishOadImage(void);
+static void sendOadStatusRsp(void);
 static bool sendConfigRsp(ApiMac_sAddr_t *pDstAddr, Smsgs_configRspMsg_t *pMsg);
 static uint16_t validateFrameControl(uint16_t frameControl);
+static uint32_t getCurrentTicks(void);
+static uint32_t energyAirtime(uint16_t frameLen);
 
 #if defined(DEVICE_TYPE_MSG)
 static void Sensor_sendDeviceTypeResponse(void);
@@ -473,6 +645,7 @@ void Sensor_init(void)
         configSettings.reportingInterval = 100;
     }
     configSettings.pollingInterval = CONFIG_POLLING_INTERVAL;
+    configSettings.fastPollingInterval = CONFIG_FAST_POLLING_INTERVAL;
 
     /* Initialize the MAC */
 #ifdef OSAL_PORT2TIRTOS
@@ -586,6 +759,8 @@ void Sensor_init(void)
  */
 void Sensor_process(void)
 {
+    uint32_t activeStart = getCurrentTicks();
+
     /* Start the collector device in the network */
     if(Sensor_events & SENSOR_START_EVT)
     {
@@ -683,8 +858,8 @@ void Sensor_process(void)
         /* In certification test mode, back to back data shall be sent */
         if(!CERTIFICATION_TEST_MODE)
         {
-            /* Setup for the next message */
-            Ssf_setReadingClock(configSettings.reportingInterval);
+            /* Setup for the next reading */
+            Ssf_setReadingClock(getReadingInterval());
         }
 
 #ifdef FEATURE_SECURE_COMMISSIONING
@@ -704,8 +879,18 @@ void Sensor_process(void)
         /* Read sensors */
         readSensors();
 
+#if CONFIG_SENSOR_BATCH_SIZE > 1
+        /* Buffer the reading, and send the batch once it is full */
+        storeSensorSample();
+        if((sampleCount >= CONFIG_SENSOR_BATCH_SIZE)
+           || (configSettings.reportingInterval == 0))
+        {
+            processSensorBatchMsgEvt();
+        }
+#else
         /* Process Sensor Reading Message Event */
         processSensorMsgEvt();
+#endif
 #endif //SENSOR_TEST_RAMP_DATA_SIZE
 #ifdef FEATURE_SECURE_COMMISSIONING
         }
@@ -724,6 +909,30 @@ void Sensor_process(void)
     }
 #endif //OAD_IMG_A
 
+    /* Is it time to answer a broadcast group command? */
+    if(Sensor_events & SENSOR_GROUP_ACK_EVT)
+    {
+        Sensor_sendMsg(Smsgs_cmdIds_groupCmdRsp, &groupCmdRspAddr, true,
+                       SMSGS_GROUP_CMD_RESPONSE_MSG_LEN, groupCmdRsp);
+
+        /* Clear the event */
+        Util_clearEvent(&Sensor_events, SENSOR_GROUP_ACK_EVT);
+    }
+
+    /* Is it time to answer an OAD status request, or to install the image? */
+    if(Sensor_events & SENSOR_OAD_PUSH_EVT)
+    {
+        if(oadInstall)
+        {
+            /* Doesn't return */
+            Ssf_oadPushInstall();
+        }
+        sendOadStatusRsp();
+
+        /* Clear the event */
+        Util_clearEvent(&Sensor_events, SENSOR_OAD_PUSH_EVT);
+    }
+
 #ifdef DISPLAY_PER_STATS
     /* Is it time to update the PER display? */
     if(Sensor_events & SENSOR_UPDATE_STATS_EVT)
@@ -829,6 +1038,13 @@ void Sensor_process(void)
     if(Sensor_events == 0)
 #endif
     {
+        /* Use the idle time to make room in NV */
+        Ssf_compactNV();
+
+        /* Account for the MCU time spent processing, before blocking */
+        Sensor_energyStats.activeTime += (getCurrentTicks() - activeStart)
+                                         * CLOCK_TICK_PERIOD;
+
         /* Wait for response message or events */
         ApiMac_processIncoming();
     }
@@ -910,7 +1126,8 @@ bool Sensor_sendMsg(Smsgs_cmdIds_t type, ApiMac_sAddr_t *pDstAddr,
 #endif /* FEATURE_SECURE_COMMISSIONING */
 #endif /* FEATURE_MAC_SECURITY */
 
-    if(type == Smsgs_cmdIds_sensorData || type == Smsgs_cmdIds_rampdata)
+    if(type == Smsgs_cmdIds_sensorData || type == Smsgs_cmdIds_rampdata
+       || type == Smsgs_cmdIds_sensorDataBatch)
     {
         Sensor_msgStats.msgsAttempted++;
     }
@@ -926,6 +1143,7 @@ bool Sensor_sendMsg(Smsgs_cmdIds_t type, ApiMac_sAddr_t *pDstAddr,
     /* Send the message */
     if(ApiMac_mcpsDataReq(&dataReq) == ApiMac_status_success)
     {
+        energyTxLen = len;
         ret = true;
     }
     else
@@ -960,6 +1178,39 @@ void Sensor_sendIdentifyLedRequest(void)
             cmdBytes);
 }
 
+/*!
+ Account for a transmitted frame in the energy statistics
+
+ Public function defined in sensor.h
+ */
+void Sensor_energyTx(uint16_t frameLen, uint8_t attempts)
+{
+    uint32_t txTime = energyAirtime(frameLen);
+    uint32_t rxTime = ENERGY_ACK_WAIT_US + energyAirtime(ENERGY_ACK_FRAME_LEN);
+
+    Sensor_energyStats.txFrames++;
+    Sensor_energyStats.txTime += txTime * attempts;
+    Sensor_energyStats.rxTime += rxTime * attempts;
+}
+
+/*!
+ Account for an active scan in the energy statistics
+
+ Public function defined in sensor.h
+ */
+void Sensor_energyScan(uint8_t numChannels, uint8_t scanDuration)
+{
+    /* Each channel is listened to for aBaseSuperframeDuration * (2^n + 1) */
+    uint64_t symbols = (uint64_t)numChannels * ENERGY_SCAN_BASE_SYMBOLS
+                       * ((1UL << scanDuration) + 1);
+    uint64_t rxTime = Sensor_energyStats.rxTime
+                      + (symbols * 1000000) / ENERGY_SYMBOL_RATE;
+
+    Sensor_energyStats.scans++;
+    Sensor_energyStats.rxTime = (rxTime > 0xFFFFFFFF) ?
+                                 0xFFFFFFFF : (uint32_t)rxTime;
+}
+
 #ifdef FEATURE_SECURE_COMMISSIONING
 /*!
  * @brief Sets the Security Authentication Mode
@@ -994,6 +1245,8 @@ static void initializeClocks(void)
 {
     /* Initialize the reading clock */
     Ssf_initializeReadingClock();
+    Ssf_initializeGroupAckClock();
+    Ssf_initializeOadPushClock();
 #ifdef USE_DMM
     Ssf_initializeProvisioningClock();
 #endif /* USE_DMM */
@@ -1011,6 +1264,8 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
     if(pDataCnf->status == ApiMac_status_channelAccessFailure)
     {
         Sensor_msgStats.channelAccessFailures++;
+        /* The MAC doesn't report backoffs, a failure used all of them */
+        Sensor_energyStats.csmaBackoffs += CONFIG_MAC_MAX_CSMA_BACKOFFS + 1;
     }
     else if(pDataCnf->status == ApiMac_status_noAck)
     {
@@ -1034,6 +1289,14 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
         Ssf_updateFrameCounter(NULL, pDataCnf->frameCntr);
     }
 
+    /* Anything but a channel access failure went over the air */
+    if(pDataCnf->status != ApiMac_status_channelAccessFailure)
+    {
+        Sensor_energyTx(energyTxLen + SENSOR_ENERGY_FRAME_OVERHEAD,
+                        pDataCnf->retries + 1);
+        Sensor_energyStats.retries += pDataCnf->retries;
+    }
+
 #ifdef FEATURE_SECURE_COMMISSIONING
     /* Strictly ensure that the message did not come from the app */
     if(!(pDataCnf->msduHandle & APP_MARKER_MSDU_HANDLE))
@@ -1073,8 +1336,28 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
         if((pDataCnf->msduHandle & APP_MASK_MSDU_HANDLE)
            == APP_SENSOR_MSDU_HANDLE)
         {
+#ifdef SENSOR_COMPACT_ENCODING
+            if((pDataCnf->status == ApiMac_status_success)
+               && (compactPendingSeq != SMSGS_COMPACT_NO_BASE))
+            {
+                /* The collector has these statistics, use them as the base */
+                compactBaseSeq = compactPendingSeq;
+                memcpy(compactBaseStats, compactPendingStats,
+                       sizeof(compactBaseStats));
+            }
+            compactPendingSeq = SMSGS_COMPACT_NO_BASE;
+#endif /* SENSOR_COMPACT_ENCODING */
             if(pDataCnf->status == ApiMac_status_success)
             {
+                uint32_t radioDelay = getCurrentTicks()
+                                      - startSensorMsgTimeStamp;
+
+                radioDelay /= TICKPERIOD_MS_US;
+
+                /* Reported in the latency trace of the next report */
+                traceRadioDelay = (radioDelay > 0xFFFF) ?
+                                   0xFFFF : (uint16_t)radioDelay;
+
                 Sensor_msgStats.msgsSent++;
 #ifdef DISPLAY_PER_STATS
                 Util_setEvent(&Sensor_events, SENSOR_UPDATE_STATS_EVT);
@@ -1155,6 +1438,9 @@ static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd)
     {
         Smsgs_cmdIds_t cmdId = (Smsgs_cmdIds_t)*(pDataInd->msdu.p);
 
+        Sensor_energyStats.rxTime += energyAirtime(pDataInd->msdu.len +
+                                            SENSOR_ENERGY_FRAME_OVERHEAD);
+
 #ifdef FEATURE_MAC_SECURITY
         {
             if(Jdllc_securityCheck(&(pDataInd->sec)) == false)
@@ -1215,6 +1501,31 @@ static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd)
                 }
                 break;
 
+            case Smsgs_cmdIds_groupCmdReq:
+                /* only act if sensor is in the network */
+                if ((Jdllc_getProvState() == Jdllc_states_joined) ||
+                        (Jdllc_getProvState() == Jdllc_states_rejoined))
+                {
+                    processGroupCmdRequest(pDataInd);
+                }
+                break;
+
+            case Smsgs_cmdIds_oadImgNotify:
+                if ((Jdllc_getProvState() == Jdllc_states_joined) ||
+                        (Jdllc_getProvState() == Jdllc_states_rejoined))
+                {
+                    processOadImgNotify(pDataInd);
+                }
+                break;
+
+            case Smsgs_cmdIds_oadImgBlock:
+                processOadImgBlock(pDataInd);
+                break;
+
+            case Smsgs_cmdIds_oadStatusReq:
+                processOadStatusReq(pDataInd);
+                break;
+
             case Smgs_cmdIds_broadcastCtrlMsg:
                 if(parentFound)
                 {
@@ -1222,6 +1533,10 @@ static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd)
                     processBroadcastCtrlMsg(pDataInd);
                 }
                 break;
+
+            case Smsgs_cmdIds_collectorRestored:
+                Jdllc_collectorRestored();
+                break;
 #ifdef POWER_MEAS
             case Smsgs_cmdIds_rampdata:
                 Sensor_pwrMeasStats.rampDataRcvd++;
@@ -1338,7 +1653,8 @@ static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType)
     msduHandle |= APP_MARKER_MSDU_HANDLE;
 
     /* Add the message type bit */
-    if(msgType == Smsgs_cmdIds_sensorData || msgType == Smsgs_cmdIds_rampdata)
+    if(msgType == Smsgs_cmdIds_sensorData || msgType == Smsgs_cmdIds_rampdata
+       || msgType == Smsgs_cmdIds_sensorDataBatch)
     {
         msduHandle |= APP_SENSOR_MSDU_HANDLE;
     }
@@ -1389,14 +1705,36 @@ static void processSensorRampMsgEvt(void)
 
 #if !defined(OAD_IMG_A)
 /*!
- @brief   Build and send sensor data message
+ * @brief   Get the interval until the next sensor reading
+ *
+ * @return  interval in milliseconds, 0 if reporting is off
  */
-static void processSensorMsgEvt(void)
+static uint32_t getReadingInterval(void)
+{
+#if CONFIG_SENSOR_BATCH_SIZE > 1
+    uint32_t interval = configSettings.reportingInterval /
+                        CONFIG_SENSOR_BATCH_SIZE;
+
+    if((interval > 0) && (interval < MIN_SAMPLE_INTERVAL))
+    {
+        interval = MIN_SAMPLE_INTERVAL;
+    }
+    return (interval);
+#else
+    return (configSettings.reportingInterval);
+#endif
+}
+
+/*!
+ * @brief   Fill in a sensor data message from the latest readings
+ *
+ * @param   pMsg - pointer to the message to fill in
+ */
+static void buildSensorMessage(Smsgs_sensorMsg_t *pMsg)
 {
-    Smsgs_sensorMsg_t sensor;
     uint32_t stat;
 
-    memset(&sensor, 0, sizeof(Smsgs_sensorMsg_t));
+    memset(pMsg, 0, sizeof(Smsgs_sensorMsg_t));
 
     ApiMac_mlmeGetReqUint32(ApiMac_attribute_diagRxSecureFail, &stat);
     Sensor_msgStats.rxDecryptFailures = (uint16_t)stat;
@@ -1405,49 +1743,79 @@ static void processSensorMsgEvt(void)
     Sensor_msgStats.txEncryptFailures = (uint16_t)stat;
 
     ApiMac_mlmeGetReqArray(ApiMac_attribute_extendedAddress,
-    		               sensor.extAddress);
+    		               pMsg->extAddress);
 
     /* fill in the message */
-    sensor.frameControl = configSettings.frameControl;
-    if(sensor.frameControl & Smsgs_dataFields_tempSensor)
+    pMsg->frameControl = configSettings.frameControl;
+    if(pMsg->frameControl & Smsgs_dataFields_tempSensor)
     {
-        memcpy(&sensor.tempSensor, &tempSensor,
+        memcpy(&pMsg->tempSensor, &tempSensor,
                sizeof(Smsgs_tempSensorField_t));
     }
-    if(sensor.frameControl & Smsgs_dataFields_lightSensor)
+    if(pMsg->frameControl & Smsgs_dataFields_lightSensor)
     {
-        memcpy(&sensor.lightSensor, &lightSensor,
+        memcpy(&pMsg->lightSensor, &lightSensor,
                sizeof(Smsgs_lightSensorField_t));
     }
-    if(sensor.frameControl & Smsgs_dataFields_humiditySensor)
+    if(pMsg->frameControl & Smsgs_dataFields_humiditySensor)
     {
-        memcpy(&sensor.humiditySensor, &humiditySensor,
+        memcpy(&pMsg->humiditySensor, &humiditySensor,
                sizeof(Smsgs_humiditySensorField_t));
     }
-    if(sensor.frameControl & Smsgs_dataFields_msgStats)
+    if(pMsg->frameControl & Smsgs_dataFields_msgStats)
     {
-        memcpy(&sensor.msgStats, &Sensor_msgStats,
+        memcpy(&pMsg->msgStats, &Sensor_msgStats,
                sizeof(Smsgs_msgStatsField_t));
     }
-    if(sensor.frameControl & Smsgs_dataFields_configSettings)
+    if(pMsg->frameControl & Smsgs_dataFields_configSettings)
     {
-        sensor.configSettings.pollingInterval = configSettings.pollingInterval;
-        sensor.configSettings.reportingInterval = configSettings
+        pMsg->configSettings.pollingInterval = configSettings.pollingInterval;
+        pMsg->configSettings.reportingInterval = configSettings
                         .reportingInterval;
     }
 
 #ifdef LPSTK
-    if(sensor.frameControl & Smsgs_dataFields_hallEffectSensor)
+    if(pMsg->frameControl & Smsgs_dataFields_hallEffectSensor)
     {
-        memcpy(&sensor.hallEffectSensor, &hallEffectSensor,
+        memcpy(&pMsg->hallEffectSensor, &hallEffectSensor,
                                sizeof(Smsgs_hallEffectSensorField_t));
     }
-    if(sensor.frameControl & Smsgs_dataFields_accelSensor)
+    if(pMsg->frameControl & Smsgs_dataFields_accelSensor)
     {
-        memcpy(&sensor.accelerometerSensor, &accelerometerSensor,
+        memcpy(&pMsg->accelerometerSensor, &accelerometerSensor,
                        sizeof(Smsgs_accelSensorField_t));
     }
 #endif /* LPSTK */
+    if(pMsg->frameControl & Smsgs_dataFields_energyStats)
+    {
+        uint32_t now = getCurrentTicks();
+
+        memcpy(&pMsg->energyStats, &Sensor_energyStats,
+               sizeof(Smsgs_energyStatsField_t));
+        pMsg->energyStats.periodTime = (now - energyPeriodStart)
+                                       / TICKPERIOD_MS_US;
+
+        /* Start a new accounting period */
+        memset(&Sensor_energyStats, 0, sizeof(Smsgs_energyStatsField_t));
+        energyPeriodStart = now;
+    }
+    if(pMsg->frameControl & Smsgs_dataFields_latencyTrace)
+    {
+        pMsg->latencyTrace.traceId = ++traceId;
+        pMsg->latencyTrace.timestamp = getCurrentTicks() / TICKPERIOD_MS_US;
+        pMsg->latencyTrace.radioDelay = traceRadioDelay;
+        traceRadioDelay = 0;
+    }
+}
+
+/*!
+ @brief   Build and send sensor data message
+ */
+static void processSensorMsgEvt(void)
+{
+    Smsgs_sensorMsg_t sensor;
+
+    buildSensorMessage(&sensor);
 
     /* inform the user interface */
     Ssf_sensorReadingUpdate(&sensor);
@@ -1457,7 +1825,11 @@ static void processSensorMsgEvt(void)
     RemoteDisplay_updateSensorData();
 #endif /* USE_DMM */
     /* send the data to the collector */
+#ifdef SENSOR_COMPACT_ENCODING
+    sendCompactSensorMessage(&collectorAddr, &sensor);
+#else
     sendSensorMessage(&collectorAddr, &sensor);
+#endif
 }
 
 /*!
@@ -1531,6 +1903,14 @@ static bool sendSensorMessage(ApiMac_sAddr_t *pDstAddr, Smsgs_sensorMsg_t *pMsg)
         len += sizeof(Smsgs_accelSensorField_t);
     }
 #endif /* LPSTK */
+    if(pMsg->frameControl & Smsgs_dataFields_energyStats)
+    {
+        len += SMSGS_SENSOR_ENERGY_STATS_LEN;
+    }
+    if(pMsg->frameControl & Smsgs_dataFields_latencyTrace)
+    {
+        len += SMSGS_SENSOR_LATENCY_TRACE_LEN;
+    }
     pMsgBuf = (uint8_t *)Ssf_malloc(len);
     if(pMsgBuf)
     {
@@ -1560,36 +1940,7 @@ static bool sendSensorMessage(ApiMac_sAddr_t *pDstAddr, Smsgs_sensorMsg_t *pMsg)
         }
         if(pMsg->frameControl & Smsgs_dataFields_msgStats)
         {
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.joinAttempts);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.joinFails);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.msgsAttempted);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.msgsSent);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.trackingRequests);
-            pBuf = Util_bufferUint16(pBuf,
-                                     pMsg->msgStats.trackingResponseAttempts);
-            pBuf = Util_bufferUint16(pBuf,
-                                     pMsg->msgStats.trackingResponseSent);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.configRequests);
-            pBuf = Util_bufferUint16(pBuf,
-                                     pMsg->msgStats.configResponseAttempts);
-            pBuf = Util_bufferUint16(pBuf,
-                                     pMsg->msgStats.configResponseSent);
-            pBuf = Util_bufferUint16(pBuf,
-                                     pMsg->msgStats.channelAccessFailures);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.macAckFailures);
-            pBuf = Util_bufferUint16(pBuf,
-                                     pMsg->msgStats.otherDataRequestFailures);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.syncLossIndications);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.rxDecryptFailures);
-            pBuf = Util_bufferUint16(pBuf,  pMsg->msgStats.txEncryptFailures);
-            pBuf = Util_bufferUint16(pBuf, Ssf_resetCount);
-            pBuf = Util_bufferUint16(pBuf,  Ssf_resetReseason);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.joinTime);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.interimDelay);
-            pBuf = Util_bufferUint16(pBuf, pMsg->msgStats.numBroadcastMsgRcvd);
-            pBuf = Util_bufferUint16(pBuf,  pMsg->msgStats.numBroadcastMsglost);
-            pBuf = Util_bufferUint16(pBuf,  pMsg->msgStats.avgE2EDelay);
-            pBuf = Util_bufferUint16(pBuf,  pMsg->msgStats.worstCaseE2EDelay);
+            pBuf = bufferMsgStats(pBuf, &pMsg->msgStats);
         }
         if(pMsg->frameControl & Smsgs_dataFields_configSettings)
         {
@@ -1618,6 +1969,14 @@ static bool sendSensorMessage(ApiMac_sAddr_t *pDstAddr, Smsgs_sensorMsg_t *pMsg)
             *pBuf++ = pMsg->accelerometerSensor.yTiltDet;
         }
 #endif /* LPSTK */
+        if(pMsg->frameControl & Smsgs_dataFields_energyStats)
+        {
+            pBuf = bufferEnergyStats(pBuf, &pMsg->energyStats);
+        }
+        if(pMsg->frameControl & Smsgs_dataFields_latencyTrace)
+        {
+            pBuf = bufferLatencyTrace(pBuf, &pMsg->latencyTrace);
+        }
         ret = Sensor_sendMsg(Smsgs_cmdIds_sensorData, pDstAddr, true, len, pMsgBuf);
 
         Ssf_free(pMsgBuf);
@@ -1626,76 +1985,682 @@ static bool sendSensorMessage(ApiMac_sAddr_t *pDstAddr, Smsgs_sensorMsg_t *pMsg)
     return (ret);
 }
 
-#endif // !defined(OAD_IMG_A)
+/*!
+ * @brief   Buffer the message statistics field
+ *
+ * @param   pBuf - where to put the field
+ * @param   pStats - pointer to the message statistics
+ *
+ * @return  pointer to the next byte after the field
+ */
+static uint8_t *bufferMsgStats(uint8_t *pBuf, Smsgs_msgStatsField_t *pStats)
+{
+    pBuf = Util_bufferUint16(pBuf, pStats->joinAttempts);
+    pBuf = Util_bufferUint16(pBuf, pStats->joinFails);
+    pBuf = Util_bufferUint16(pBuf, pStats->msgsAttempted);
+    pBuf = Util_bufferUint16(pBuf, pStats->msgsSent);
+    pBuf = Util_bufferUint16(pBuf, pStats->trackingRequests);
+    pBuf = Util_bufferUint16(pBuf, pStats->trackingResponseAttempts);
+    pBuf = Util_bufferUint16(pBuf, pStats->trackingResponseSent);
+    pBuf = Util_bufferUint16(pBuf, pStats->configRequests);
+    pBuf = Util_bufferUint16(pBuf, pStats->configResponseAttempts);
+    pBuf = Util_bufferUint16(pBuf, pStats->configResponseSent);
+    pBuf = Util_bufferUint16(pBuf, pStats->channelAccessFailures);
+    pBuf = Util_bufferUint16(pBuf, pStats->macAckFailures);
+    pBuf = Util_bufferUint16(pBuf, pStats->otherDataRequestFailures);
+    pBuf = Util_bufferUint16(pBuf, pStats->syncLossIndications);
+    pBuf = Util_bufferUint16(pBuf, pStats->rxDecryptFailures);
+    pBuf = Util_bufferUint16(pBuf, pStats->txEncryptFailures);
+    pBuf = Util_bufferUint16(pBuf, Ssf_resetCount);
+    pBuf = Util_bufferUint16(pBuf, Ssf_resetReseason);
+    pBuf = Util_bufferUint16(pBuf, pStats->joinTime);
+    pBuf = Util_bufferUint16(pBuf, pStats->interimDelay);
+    pBuf = Util_bufferUint16(pBuf, pStats->numBroadcastMsgRcvd);
+    pBuf = Util_bufferUint16(pBuf, pStats->numBroadcastMsglost);
+    pBuf = Util_bufferUint16(pBuf, pStats->avgE2EDelay);
+    pBuf = Util_bufferUint16(pBuf, pStats->worstCaseE2EDelay);
+
+    return (pBuf);
+}
 
+/*!
+ * @brief   Buffer the energy statistics field
+ *
+ * @param   pBuf - where to put the field
+ * @param   pStats - pointer to the energy statistics
+ *
+ * @return  pointer to the next byte after the field
+ */
+static uint8_t *bufferEnergyStats(uint8_t *pBuf,
+                                  Smsgs_energyStatsField_t *pStats)
+{
+    pBuf = Util_bufferUint32(pBuf, pStats->periodTime);
+    pBuf = Util_bufferUint32(pBuf, pStats->txTime);
+    pBuf = Util_bufferUint32(pBuf, pStats->rxTime);
+    pBuf = Util_bufferUint32(pBuf, pStats->activeTime);
+    pBuf = Util_bufferUint16(pBuf, pStats->txFrames);
+    pBuf = Util_bufferUint16(pBuf, pStats->retries);
+    pBuf = Util_bufferUint16(pBuf, pStats->csmaBackoffs);
+    pBuf = Util_bufferUint16(pBuf, pStats->polls);
+    pBuf = Util_bufferUint16(pBuf, pStats->scans);
+
+    return (pBuf);
+}
 
 /*!
- * @brief      Process the Config Request message.
+ * @brief   Buffer the latency trace field
  *
- * @param      pDataInd - pointer to the data indication information
+ * @param   pBuf - where to put the field
+ * @param   pTrace - pointer to the latency trace
+ *
+ * @return  pointer to the next byte after the field
  */
-static void processConfigRequest(ApiMac_mcpsDataInd_t *pDataInd)
+static uint8_t *bufferLatencyTrace(uint8_t *pBuf,
+                                   Smsgs_latencyTraceField_t *pTrace)
 {
-    Smsgs_statusValues_t stat = Smsgs_statusValues_invalid;
-    Smsgs_configRspMsg_t configRsp;
+    pBuf = Util_bufferUint16(pBuf, pTrace->traceId);
+    pBuf = Util_bufferUint32(pBuf, pTrace->timestamp);
+    pBuf = Util_bufferUint16(pBuf, pTrace->radioDelay);
 
-    memset(&configRsp, 0, sizeof(Smsgs_configRspMsg_t));
+    return (pBuf);
+}
 
-    /* Make sure the message is the correct size */
-    if(pDataInd->msdu.len == SMSGS_CONFIG_REQUEST_MSG_LENGTH)
+#ifdef SENSOR_COMPACT_ENCODING
+/*!
+ * @brief   Build and send sensor data message with the compact encoding
+ *
+ * @param   pDstAddr - Where to send the message
+ * @param   pMsg - pointer to the sensor data
+ *
+ * @return  true if message was sent, false if not
+ */
+static bool sendCompactSensorMessage(ApiMac_sAddr_t *pDstAddr,
+                                     Smsgs_sensorMsg_t *pMsg)
+{
+    bool ret = false;
+    uint8_t *pMsgBuf;
+    uint16_t frameControl;
+    uint16_t len = SMSGS_BASIC_SENSOR_LEN + SMSGS_COMPACT_HDR_LEN;
+
+    frameControl = pMsg->frameControl | Smsgs_dataFields_compactEncoding;
+
+    /* Figure out the worst case length */
+    if(frameControl & Smsgs_dataFields_tempSensor)
     {
-        uint8_t *pBuf = pDataInd->msdu.p;
-        uint16_t frameControl;
-        uint32_t reportingInterval;
-        uint32_t pollingInterval;
+        len += 2 * SMSGS_VARINT_MAX_LEN;
+    }
+    if(frameControl & Smsgs_dataFields_lightSensor)
+    {
+        len += SMSGS_VARINT_MAX_LEN;
+    }
+    if(frameControl & Smsgs_dataFields_humiditySensor)
+    {
+        len += 2 * SMSGS_VARINT_MAX_LEN;
+    }
+    if(frameControl & Smsgs_dataFields_msgStats)
+    {
+        len += 1 + (COMPACT_NUM_STATS * SMSGS_VARINT_MAX_LEN);
+    }
+    if(frameControl & Smsgs_dataFields_configSettings)
+    {
+        len += 2 * SMSGS_VARINT_MAX_LEN;
+    }
+#ifdef LPSTK
+    if(frameControl & Smsgs_dataFields_hallEffectSensor)
+    {
+        len += SMSGS_VARINT_MAX_LEN;
+    }
+    if(frameControl & Smsgs_dataFields_accelSensor)
+    {
+        len += (3 * SMSGS_VARINT_MAX_LEN) + 2;
+    }
+#endif /* LPSTK */
+    if(frameControl & Smsgs_dataFields_energyStats)
+    {
+        len += 9 * SMSGS_VARINT_MAX_LEN;
+    }
+    if(frameControl & Smsgs_dataFields_latencyTrace)
+    {
+        len += 3 * SMSGS_VARINT_MAX_LEN;
+    }
+    pMsgBuf = (uint8_t *)Ssf_malloc(len);
+    if(pMsgBuf)
+    {
+        uint8_t *pBuf = pMsgBuf;
 
-        /* Parse the message */
-        configSettings.cmdId = (Smsgs_cmdIds_t)*pBuf++;
-        frameControl = Util_parseUint16(pBuf);
-        pBuf += 2;
-        reportingInterval = Util_parseUint32(pBuf);
-        pBuf += 4;
-        pollingInterval = Util_parseUint32(pBuf);
+        *pBuf++ = (uint8_t)Smsgs_cmdIds_sensorData;
 
-        stat = Smsgs_statusValues_success;
-        collectorAddr.addrMode = pDataInd->srcAddr.addrMode;
-        if(collectorAddr.addrMode == ApiMac_addrType_short)
+        memcpy(pBuf, pMsg->extAddress, SMGS_SENSOR_EXTADDR_LEN);
+        pBuf += SMGS_SENSOR_EXTADDR_LEN;
+
+        pBuf = Util_bufferUint16(pBuf, frameControl);
+
+        /* Skip the sequence number reserved for absolute statistics */
+        compactSeq++;
+        if(compactSeq == SMSGS_COMPACT_NO_BASE)
         {
-            collectorAddr.addr.shortAddr = pDataInd->srcAddr.addr.shortAddr;
+            compactSeq++;
+        }
+
+        /* Send absolute statistics every so often to recover a lost base */
+        if(compactDeltaCount >= COMPACT_KEYFRAME_INTERVAL)
+        {
+            compactBaseSeq = SMSGS_COMPACT_NO_BASE;
+        }
+        if(compactBaseSeq == SMSGS_COMPACT_NO_BASE)
+        {
+            memset(compactBaseStats, 0, sizeof(compactBaseStats));
+            compactDeltaCount = 0;
         }
         else
         {
-            memcpy(collectorAddr.addr.extAddr, pDataInd->srcAddr.addr.extAddr,
-                   (APIMAC_SADDR_EXT_LEN));
+            compactDeltaCount++;
         }
 
-        configSettings.frameControl = validateFrameControl(frameControl);
-        if(configSettings.frameControl != frameControl)
+        *pBuf++ = SMSGS_COMPACT_VERSION;
+        *pBuf++ = compactSeq;
+        *pBuf++ = compactBaseSeq;
+
+        /* Buffer data in order of frameControl mask, starting with LSB */
+        if(frameControl & Smsgs_dataFields_tempSensor)
         {
-            stat = Smsgs_statusValues_partialSuccess;
+            pBuf = bufferZigZag(pBuf, pMsg->tempSensor.ambienceTemp);
+            pBuf = bufferZigZag(pBuf, pMsg->tempSensor.objectTemp);
         }
-        configRsp.frameControl = configSettings.frameControl;
-
-        if((reportingInterval < MIN_REPORTING_INTERVAL)
-           || (reportingInterval > MAX_REPORTING_INTERVAL))
+        if(frameControl & Smsgs_dataFields_lightSensor)
         {
-            stat = Smsgs_statusValues_partialSuccess;
+            pBuf = bufferVarint(pBuf, pMsg->lightSensor.rawData);
         }
-        else
+        if(frameControl & Smsgs_dataFields_humiditySensor)
         {
-#ifndef POWER_MEAS
-            configSettings.reportingInterval = reportingInterval;
-#endif
-            {
-                uint32_t randomNum;
-                randomNum = ((ApiMac_randomByte() << 16) +
-                             (ApiMac_randomByte() << 8) + ApiMac_randomByte());
-                randomNum = (randomNum % reportingInterval) +
-                        SENSOR_MIN_POLL_TIME;
-                Ssf_setReadingClock(randomNum);
-#ifdef LPSTK
-                Lpstk_setSensorReadTimer((Lpstk_SensorMask)(LPSTK_HUMIDITY|
-                                                             LPSTK_TEMPERATURE|
+            pBuf = bufferVarint(pBuf, pMsg->humiditySensor.temp);
+            pBuf = bufferVarint(pBuf, pMsg->humiditySensor.humidity);
+        }
+        if(frameControl & Smsgs_dataFields_msgStats)
+        {
+            pBuf = bufferCompactMsgStats(pBuf, &pMsg->msgStats);
+        }
+        if(frameControl & Smsgs_dataFields_configSettings)
+        {
+            pBuf = bufferVarint(pBuf, pMsg->configSettings.reportingInterval);
+            pBuf = bufferVarint(pBuf, pMsg->configSettings.pollingInterval);
+        }
+#ifdef LPSTK
+        if(frameControl & Smsgs_dataFields_hallEffectSensor)
+        {
+            pBuf = bufferVarint(pBuf, (uint32_t)pMsg->hallEffectSensor.flux);
+        }
+        if(frameControl & Smsgs_dataFields_accelSensor)
+        {
+            pBuf = bufferZigZag(pBuf, pMsg->accelerometerSensor.xAxis);
+            pBuf = bufferZigZag(pBuf, pMsg->accelerometerSensor.yAxis);
+            pBuf = bufferZigZag(pBuf, pMsg->accelerometerSensor.zAxis);
+            *pBuf++ = pMsg->accelerometerSensor.xTiltDet;
+            *pBuf++ = pMsg->accelerometerSensor.yTiltDet;
+        }
+#endif /* LPSTK */
+        if(frameControl & Smsgs_dataFields_energyStats)
+        {
+            pBuf = bufferVarint(pBuf, pMsg->energyStats.periodTime);
+            pBuf = bufferVarint(pBuf, pMsg->energyStats.txTime);
+            pBuf = bufferVarint(pBuf, pMsg->energyStats.rxTime);
+            pBuf = bufferVarint(pBuf, pMsg->energyStats.activeTime);
+            pBuf = bufferVarint(pBuf, pMsg->energyStats.txFrames);
+            pBuf = bufferVarint(pBuf, pMsg->energyStats.retries);
+            pBuf = bufferVarint(pBuf, pMsg->energyStats.csmaBackoffs);
+            pBuf = bufferVarint(pBuf, pMsg->energyStats.polls);
+            pBuf = bufferVarint(pBuf, pMsg->energyStats.scans);
+        }
+        if(frameControl & Smsgs_dataFields_latencyTrace)
+        {
+            pBuf = bufferVarint(pBuf, pMsg->latencyTrace.traceId);
+            pBuf = bufferVarint(pBuf, pMsg->latencyTrace.timestamp);
+            pBuf = bufferVarint(pBuf, pMsg->latencyTrace.radioDelay);
+        }
+        len = (uint16_t)(pBuf - pMsgBuf);
+
+        ret = Sensor_sendMsg(Smsgs_cmdIds_sensorData, pDstAddr, true, len,
+                             pMsgBuf);
+        if(ret && (frameControl & Smsgs_dataFields_msgStats))
+        {
+            /* Becomes the delta base once the collector has it */
+            compactPendingSeq = compactSeq;
+        }
+
+        Ssf_free(pMsgBuf);
+    }
+
+    return (ret);
+}
+
+/*!
+ * @brief   Buffer the message statistics field with the compact encoding,
+ *          relative to the statistics of compactBaseSeq
+ *
+ * @param   pBuf - where to put the field
+ * @param   pStats - pointer to the message statistics
+ *
+ * @return  pointer to the next byte after the field
+ */
+static uint8_t *bufferCompactMsgStats(uint8_t *pBuf,
+                                      Smsgs_msgStatsField_t *pStats)
+{
+    uint8_t i;
+
+    /* Same order as bufferMsgStats() */
+    memcpy(compactPendingStats, pStats, sizeof(Smsgs_msgStatsField_t));
+    compactPendingStats[offsetof(Smsgs_msgStatsField_t, resetCount)
+                        / sizeof(uint16_t)] = Ssf_resetCount;
+    compactPendingStats[offsetof(Smsgs_msgStatsField_t, lastResetReason)
+                        / sizeof(uint16_t)] = Ssf_resetReseason;
+
+    *pBuf++ = COMPACT_NUM_STATS;
+    for(i = 0; i < COMPACT_NUM_STATS; i++)
+    {
+        pBuf = bufferZigZag(pBuf, (int16_t)(compactPendingStats[i]
+                                            - compactBaseStats[i]));
+    }
+
+    return (pBuf);
+}
+
+/*!
+ * @brief   Buffer a value as a varint, 7 bits per byte starting with the
+ *          least significant bits.  Bit 7 is set in all but the last byte.
+ *
+ * @param   pBuf - where to put the value
+ * @param   value - value to buffer
+ *
+ * @return  pointer to the next byte after the value
+ */
+static uint8_t *bufferVarint(uint8_t *pBuf, uint32_t value)
+{
+    while(value >= 0x80)
+    {
+        *pBuf++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *pBuf++ = (uint8_t)value;
+
+    return (pBuf);
+}
+
+/*!
+ * @brief   Buffer a signed value as a zig-zag encoded varint, so that
+ *          values close to zero take a single byte.
+ *
+ * @param   pBuf - where to put the value
+ * @param   value - value to buffer
+ *
+ * @return  pointer to the next byte after the value
+ */
+static uint8_t *bufferZigZag(uint8_t *pBuf, int32_t value)
+{
+    return (bufferVarint(pBuf, ((uint32_t)value << 1)
+                               ^ (uint32_t)(value >> 31)));
+}
+#endif /* SENSOR_COMPACT_ENCODING */
+
+#if CONFIG_SENSOR_BATCH_SIZE > 1
+/*!
+ * @brief   Store the latest sensor readings in the sample ring.  When the
+ *          ring is full the oldest reading is overwritten.
+ */
+static void storeSensorSample(void)
+{
+    Sensor_sample_t *pSample;
+
+    if(sampleCount < CONFIG_SENSOR_BATCH_SIZE)
+    {
+        pSample = &sampleRing[(sampleHead + sampleCount)
+                              % CONFIG_SENSOR_BATCH_SIZE];
+        sampleCount++;
+    }
+    else
+    {
+        /* Previous batch was not sent, drop the oldest reading */
+        pSample = &sampleRing[sampleHead];
+        sampleHead = (sampleHead + 1) % CONFIG_SENSOR_BATCH_SIZE;
+    }
+
+#ifdef OSAL_PORT2TIRTOS
+    pSample->timestamp = Clock_getTicks();
+#else
+    pSample->timestamp = ICall_getTicks();
+#endif
+    memcpy(&pSample->tempSensor, &tempSensor,
+           sizeof(Smsgs_tempSensorField_t));
+    memcpy(&pSample->lightSensor, &lightSensor,
+           sizeof(Smsgs_lightSensorField_t));
+    memcpy(&pSample->humiditySensor, &humiditySensor,
+           sizeof(Smsgs_humiditySensorField_t));
+#ifdef LPSTK
+    memcpy(&pSample->hallEffectSensor, &hallEffectSensor,
+           sizeof(Smsgs_hallEffectSensorField_t));
+    memcpy(&pSample->accelerometerSensor, &accelerometerSensor,
+           sizeof(Smsgs_accelSensorField_t));
+#endif /* LPSTK */
+}
+
+/*!
+ @brief   Build and send the batched sensor data message
+ */
+static void processSensorBatchMsgEvt(void)
+{
+    Smsgs_sensorMsg_t sensor;
+
+    /* The latest readings are used for the user interface and report */
+    buildSensorMessage(&sensor);
+
+    /* inform the user interface */
+    Ssf_sensorReadingUpdate(&sensor);
+
+#if defined(BLE_START) && (USE_DMM)
+    /* Sync BLE application with new data */
+    RemoteDisplay_updateSensorData();
+#endif /* USE_DMM */
+    /* send the buffered readings to the collector, in as many messages
+       as they need */
+    while(sampleCount > 0)
+    {
+        uint8_t numSent = sendSensorBatchMessage(&collectorAddr, &sensor);
+
+        if(numSent == 0)
+        {
+            break;
+        }
+        sampleHead = (sampleHead + numSent) % CONFIG_SENSOR_BATCH_SIZE;
+        sampleCount -= numSent;
+    }
+}
+
+/*!
+ * @brief   Build and send a batched sensor data message with the oldest
+ *          buffered samples, as many as fit in SENSOR_BATCH_MAX_LEN.  The
+ *          report fields go with the message that takes the last sample,
+ *          less the ones that don't fit with it.
+ *
+ * @param   pDstAddr - Where to send the message
+ * @param   pMsg - pointer to the sensor data, used for the frame control
+ *                 and the report fields
+ *
+ * @return  number of samples sent, 0 if the message wasn't sent
+ */
+static uint8_t sendSensorBatchMessage(ApiMac_sAddr_t *pDstAddr,
+                                      Smsgs_sensorMsg_t *pMsg)
+{
+    uint8_t ret = 0;
+    uint8_t *pMsgBuf;
+    uint16_t len = SMSGS_BASIC_SENSOR_BATCH_LEN;
+    uint16_t sampleLen = SMSGS_BATCH_SAMPLE_AGE_LEN;
+    uint16_t reportLen = 0;
+    uint16_t frameControl = pMsg->frameControl;
+    uint8_t numSamples = sampleCount;
+    /* Report fields to leave out of a message too long for them, in order */
+    static const uint16_t optionalFields[] =
+    {
+        Smsgs_dataFields_latencyTrace,
+        Smsgs_dataFields_energyStats,
+        Smsgs_dataFields_msgStats,
+        Smsgs_dataFields_configSettings
+    };
+    static const uint8_t optionalLens[] =
+    {
+        SMSGS_SENSOR_LATENCY_TRACE_LEN,
+        SMSGS_SENSOR_ENERGY_STATS_LEN,
+        sizeof(Smsgs_msgStatsField_t),
+        SMSGS_SENSOR_CONFIG_SETTINGS_LEN
+    };
+    uint8_t i;
+
+    /* Figure out the length of one sample */
+    if(frameControl & Smsgs_dataFields_tempSensor)
+    {
+        sampleLen += SMSGS_SENSOR_TEMP_LEN;
+    }
+    if(frameControl & Smsgs_dataFields_lightSensor)
+    {
+        sampleLen += SMSGS_SENSOR_LIGHT_LEN;
+    }
+    if(frameControl & Smsgs_dataFields_humiditySensor)
+    {
+        sampleLen += SMSGS_SENSOR_HUMIDITY_LEN;
+    }
+#ifdef LPSTK
+    if(frameControl & Smsgs_dataFields_hallEffectSensor)
+    {
+        sampleLen += sizeof(Smsgs_hallEffectSensorField_t);
+    }
+    if(frameControl & Smsgs_dataFields_accelSensor)
+    {
+        sampleLen += sizeof(Smsgs_accelSensorField_t);
+    }
+#endif /* LPSTK */
+
+    /* The report fields are sent once */
+    if(frameControl & Smsgs_dataFields_msgStats)
+    {
+        reportLen += sizeof(Smsgs_msgStatsField_t);
+    }
+    if(frameControl & Smsgs_dataFields_configSettings)
+    {
+        reportLen += SMSGS_SENSOR_CONFIG_SETTINGS_LEN;
+    }
+    if(frameControl & Smsgs_dataFields_energyStats)
+    {
+        reportLen += SMSGS_SENSOR_ENERGY_STATS_LEN;
+    }
+    if(frameControl & Smsgs_dataFields_latencyTrace)
+    {
+        reportLen += SMSGS_SENSOR_LATENCY_TRACE_LEN;
+    }
+
+    if(((len + reportLen + (sampleLen * numSamples)) > SENSOR_BATCH_MAX_LEN)
+       && (numSamples > 1))
+    {
+        /* Too long, send the samples that fit and leave the report fields
+           for the message with the rest, at least the last sample */
+        frameControl &= ~SMSGS_BATCH_REPORT_FIELDS;
+        reportLen = 0;
+        numSamples--;
+        if((len + (sampleLen * numSamples)) > SENSOR_BATCH_MAX_LEN)
+        {
+            numSamples = (SENSOR_BATCH_MAX_LEN - len) / sampleLen;
+        }
+    }
+
+    /* The last sample alone may still be too long with every report field
+       (the frame is short at 2.4 GHz), the sample always fits without them */
+    for(i = 0; (i < (sizeof(optionalFields) / sizeof(optionalFields[0]))) &&
+        ((len + reportLen + (sampleLen * numSamples)) > SENSOR_BATCH_MAX_LEN);
+        i++)
+    {
+        if(frameControl & optionalFields[i])
+        {
+            frameControl &= ~optionalFields[i];
+            reportLen -= optionalLens[i];
+        }
+    }
+    len += reportLen + (sampleLen * numSamples);
+
+    pMsgBuf = (uint8_t *)Ssf_malloc(len);
+    if(pMsgBuf)
+    {
+        uint8_t *pBuf = pMsgBuf;
+        uint32_t now;
+
+#ifdef OSAL_PORT2TIRTOS
+        now = Clock_getTicks();
+#else
+        now = ICall_getTicks();
+#endif
+
+        *pBuf++ = (uint8_t)Smsgs_cmdIds_sensorDataBatch;
+
+        memcpy(pBuf, pMsg->extAddress, SMGS_SENSOR_EXTADDR_LEN);
+        pBuf += SMGS_SENSOR_EXTADDR_LEN;
+
+        pBuf = Util_bufferUint16(pBuf, frameControl);
+        *pBuf++ = numSamples;
+
+        if(frameControl & Smsgs_dataFields_msgStats)
+        {
+            pBuf = bufferMsgStats(pBuf, &pMsg->msgStats);
+        }
+        if(frameControl & Smsgs_dataFields_configSettings)
+        {
+            pBuf = Util_bufferUint32(pBuf,
+                                     pMsg->configSettings.reportingInterval);
+            pBuf = Util_bufferUint32(pBuf,
+                                     pMsg->configSettings.pollingInterval);
+        }
+        if(frameControl & Smsgs_dataFields_energyStats)
+        {
+            pBuf = bufferEnergyStats(pBuf, &pMsg->energyStats);
+        }
+        if(frameControl & Smsgs_dataFields_latencyTrace)
+        {
+            pBuf = bufferLatencyTrace(pBuf, &pMsg->latencyTrace);
+        }
+
+        /* Oldest sample first */
+        for(i = 0; i < numSamples; i++)
+        {
+            Sensor_sample_t *pSample =
+                &sampleRing[(sampleHead + i) % CONFIG_SENSOR_BATCH_SIZE];
+            uint32_t age = ((now - pSample->timestamp) / TICKPERIOD_MS_US)
+                           / SMSGS_BATCH_SAMPLE_AGE_RES;
+
+            pBuf = Util_bufferUint16(pBuf,
+                                     (age > 0xFFFF) ? 0xFFFF : (uint16_t)age);
+
+            if(frameControl & Smsgs_dataFields_tempSensor)
+            {
+                pBuf = Util_bufferUint16(pBuf,
+                                         pSample->tempSensor.ambienceTemp);
+                pBuf = Util_bufferUint16(pBuf,
+                                         pSample->tempSensor.objectTemp);
+            }
+            if(frameControl & Smsgs_dataFields_lightSensor)
+            {
+                pBuf = Util_bufferUint16(pBuf, pSample->lightSensor.rawData);
+            }
+            if(frameControl & Smsgs_dataFields_humiditySensor)
+            {
+                pBuf = Util_bufferUint16(pBuf, pSample->humiditySensor.temp);
+                pBuf = Util_bufferUint16(pBuf,
+                                         pSample->humiditySensor.humidity);
+            }
+#ifdef LPSTK
+            if(frameControl & Smsgs_dataFields_hallEffectSensor)
+            {
+                pBuf = Util_bufferUint32(pBuf,
+                                (uint32_t)pSample->hallEffectSensor.flux);
+            }
+            if(frameControl & Smsgs_dataFields_accelSensor)
+            {
+                pBuf = Util_bufferUint16(pBuf,
+                                pSample->accelerometerSensor.xAxis);
+                pBuf = Util_bufferUint16(pBuf,
+                                pSample->accelerometerSensor.yAxis);
+                pBuf = Util_bufferUint16(pBuf,
+                                pSample->accelerometerSensor.zAxis);
+                *pBuf++ = pSample->accelerometerSensor.xTiltDet;
+                *pBuf++ = pSample->accelerometerSensor.yTiltDet;
+            }
+#endif /* LPSTK */
+        }
+
+        if(Sensor_sendMsg(Smsgs_cmdIds_sensorDataBatch, pDstAddr, true,
+                          len, pMsgBuf) == true)
+        {
+            ret = numSamples;
+        }
+
+        Ssf_free(pMsgBuf);
+    }
+
+    return (ret);
+}
+#endif /* CONFIG_SENSOR_BATCH_SIZE > 1 */
+
+#endif // !defined(OAD_IMG_A)
+
+
+/*!
+ * @brief      Process the Config Request message.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processConfigRequest(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    Smsgs_statusValues_t stat = Smsgs_statusValues_invalid;
+    Smsgs_configRspMsg_t configRsp;
+
+    memset(&configRsp, 0, sizeof(Smsgs_configRspMsg_t));
+
+    /* Make sure the message is the correct size */
+    if((pDataInd->msdu.len == SMSGS_CONFIG_REQUEST_MSG_LENGTH)
+       || (pDataInd->msdu.len == SMSGS_CONFIG_REQUEST_FAST_POLL_MSG_LENGTH))
+    {
+        uint8_t *pBuf = pDataInd->msdu.p;
+        uint16_t frameControl;
+        uint32_t reportingInterval;
+        uint32_t pollingInterval;
+        uint32_t fastPollingInterval = configSettings.fastPollingInterval;
+
+        /* Parse the message */
+        configSettings.cmdId = (Smsgs_cmdIds_t)*pBuf++;
+        frameControl = Util_parseUint16(pBuf);
+        pBuf += 2;
+        reportingInterval = Util_parseUint32(pBuf);
+        pBuf += 4;
+        pollingInterval = Util_parseUint32(pBuf);
+        pBuf += 4;
+        if(pDataInd->msdu.len == SMSGS_CONFIG_REQUEST_FAST_POLL_MSG_LENGTH)
+        {
+            fastPollingInterval = Util_parseUint32(pBuf);
+        }
+
+        stat = Smsgs_statusValues_success;
+        collectorAddr.addrMode = pDataInd->srcAddr.addrMode;
+        if(collectorAddr.addrMode == ApiMac_addrType_short)
+        {
+            collectorAddr.addr.shortAddr = pDataInd->srcAddr.addr.shortAddr;
+        }
+        else
+        {
+            memcpy(collectorAddr.addr.extAddr, pDataInd->srcAddr.addr.extAddr,
+                   (APIMAC_SADDR_EXT_LEN));
+        }
+
+        configSettings.frameControl = validateFrameControl(frameControl);
+        if(configSettings.frameControl != frameControl)
+        {
+            stat = Smsgs_statusValues_partialSuccess;
+        }
+        configRsp.frameControl = configSettings.frameControl;
+
+        if((reportingInterval < MIN_REPORTING_INTERVAL)
+           || (reportingInterval > MAX_REPORTING_INTERVAL))
+        {
+            stat = Smsgs_statusValues_partialSuccess;
+        }
+        else
+        {
+#ifndef POWER_MEAS
+            configSettings.reportingInterval = reportingInterval;
+#endif
+            {
+                uint32_t randomNum;
+                randomNum = ((ApiMac_randomByte() << 16) +
+                             (ApiMac_randomByte() << 8) + ApiMac_randomByte());
+                randomNum = (randomNum % reportingInterval) +
+                        SENSOR_MIN_POLL_TIME;
+                Ssf_setReadingClock(randomNum);
+#ifdef LPSTK
+                Lpstk_setSensorReadTimer((Lpstk_SensorMask)(LPSTK_HUMIDITY|
+                                                             LPSTK_TEMPERATURE|
                                                              LPSTK_LIGHT|
                                                              LPSTK_HALL_EFFECT|
                                                              LPSTK_ACCELEROMETER),
@@ -1717,6 +2682,18 @@ static void processConfigRequest(ApiMac_mcpsDataInd_t *pDataInd)
             Jdllc_setPollRate(configSettings.pollingInterval);
         }
         configRsp.pollingInterval = configSettings.pollingInterval;
+
+        if((fastPollingInterval != 0)
+           && ((fastPollingInterval < MIN_FAST_POLLING_INTERVAL)
+               || (fastPollingInterval > configSettings.pollingInterval)))
+        {
+            stat = Smsgs_statusValues_partialSuccess;
+        }
+        else
+        {
+            configSettings.fastPollingInterval = fastPollingInterval;
+            Jdllc_setFastPollRate(configSettings.fastPollingInterval);
+        }
     }
 
     /* Send the response message */
@@ -1784,6 +2761,291 @@ static void processBroadcastCtrlMsg(ApiMac_mcpsDataInd_t *pDataInd)
     }
 }
 
+/*!
+ * @brief      Process the Group Command Request: carry out the command if
+ *             this device is a member, once per sequence number, and answer
+ *             it, in this member's slot if the request was broadcast.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processGroupCmdRequest(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    uint8_t *pBuf = pDataInd->msdu.p;
+    uint8_t *pMask = pBuf + SMSGS_GROUP_CMD_REQUEST_HDR_LEN;
+    uint8_t maskLen;
+    uint16_t baseAddr;
+    uint16_t shortAddr;
+    uint16_t offset;
+    uint16_t rank = 0;
+    uint16_t bit;
+
+    /* Make sure there is a command after the Member Mask */
+    if(pDataInd->msdu.len <= SMSGS_GROUP_CMD_REQUEST_HDR_LEN)
+    {
+        return;
+    }
+    baseAddr = Util_buildUint16(pBuf[2], pBuf[3]);
+    maskLen = pBuf[4];
+    if((maskLen > SMSGS_GROUP_CMD_MAX_MASK_LEN) ||
+       (pDataInd->msdu.len <= (SMSGS_GROUP_CMD_REQUEST_HDR_LEN + maskLen)))
+    {
+        return;
+    }
+
+    /* Is this device a member, and which one? */
+    ApiMac_mlmeGetReqUint16(ApiMac_attribute_shortAddress, &shortAddr);
+    if(shortAddr < baseAddr)
+    {
+        return;
+    }
+    offset = shortAddr - baseAddr;
+    if(maskLen == 0)
+    {
+        rank = offset % (SMSGS_GROUP_CMD_MAX_MASK_LEN * 8);
+    }
+    else
+    {
+        if((offset >= (maskLen * 8)) ||
+           ((pMask[offset / 8] & (1 << (offset % 8))) == 0))
+        {
+            return;
+        }
+        for(bit = 0; bit < offset; bit++)
+        {
+            if(pMask[bit / 8] & (1 << (bit % 8)))
+            {
+                rank++;
+            }
+        }
+    }
+
+    /* The collector sends the command again to the members it didn't hear
+       from, so carry it out only the first time */
+    if(pBuf[1] != groupCmdSeq)
+    {
+        uint8_t *pCmd = pMask + maskLen;
+
+        groupCmdSeq = pBuf[1];
+        groupCmdRsp[0] = (uint8_t)Smsgs_cmdIds_groupCmdRsp;
+        groupCmdRsp[1] = pBuf[1];
+        switch(*pCmd)
+        {
+            case Smsgs_cmdIds_toggleLedReq:
+                Ssf_toggleLED();
+                groupCmdRsp[2] = (uint8_t)Smsgs_statusValues_success;
+                break;
+
+            default:
+                groupCmdRsp[2] = (uint8_t)Smsgs_statusValues_invalid;
+                break;
+        }
+    }
+
+    memcpy(&groupCmdRspAddr, &pDataInd->srcAddr, sizeof(ApiMac_sAddr_t));
+    if((pDataInd->dstAddr.addrMode == ApiMac_addrType_none) ||
+       ((pDataInd->dstAddr.addrMode == ApiMac_addrType_short) &&
+        (pDataInd->dstAddr.addr.shortAddr == 0xFFFF)))
+    {
+        /* Broadcast, wait for this member's slot */
+        Ssf_setGroupAckClock((uint32_t)(rank + 1) * SMSGS_GROUP_CMD_ACK_SLOT);
+    }
+    else
+    {
+        Sensor_sendMsg(Smsgs_cmdIds_groupCmdRsp, &groupCmdRspAddr, true,
+                       SMSGS_GROUP_CMD_RESPONSE_MSG_LEN, groupCmdRsp);
+    }
+}
+
+/*!
+ * @brief      Process the OAD Image Notify message: start receiving the
+ *             image if this device wants it, and keep the receiver on for
+ *             its blocks.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processOadImgNotify(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    uint8_t *pBuf = pDataInd->msdu.p;
+    uint8_t *pHdr = pBuf + SMSGS_OAD_IMG_NOTIFY_HDR_LEN;
+    uint16_t numBlocks;
+    uint16_t numStored = 0;
+
+    if(pDataInd->msdu.len !=
+       (SMSGS_OAD_IMG_NOTIFY_HDR_LEN + SMSGS_OAD_IMG_HDR_LEN))
+    {
+        return;
+    }
+
+    /* Each round starts with the same notify */
+    if((oadImage.status != OADPUSH_STATUS_NONE) &&
+       (pBuf[1] == oadImage.seq))
+    {
+        if(oadImage.status == Smsgs_oadStatus_receiving)
+        {
+            /* In case rejoining turned it off */
+            ApiMac_mlmeSetReqBool(ApiMac_attribute_RxOnWhenIdle, true);
+        }
+        return;
+    }
+
+    /* A new image replaces one not finished */
+    if(oadImage.status == Smsgs_oadStatus_receiving)
+    {
+        Ssf_oadPushClose();
+    }
+    oadInstall = false;
+
+    numBlocks = Util_buildUint16(pBuf[3], pBuf[4]);
+    if((numBlocks == 0) || (numBlocks > OADPUSH_MAX_BLOCKS) ||
+       (Ssf_oadPushOpen(pBuf[1], pHdr, &numStored) == false))
+    {
+        OadPush_decline(&oadImage, pBuf[1]);
+        ApiMac_mlmeSetReqBool(ApiMac_attribute_RxOnWhenIdle,
+                              CONFIG_RX_ON_IDLE);
+        return;
+    }
+
+    OadPush_start(&oadImage, pBuf[1], numBlocks, pHdr, numStored);
+    if(oadImage.status == Smsgs_oadStatus_complete)
+    {
+        /* Every block was stored before a reset */
+        finishOadImage();
+        return;
+    }
+
+    Ssf_oadPushSave(oadImage.seq, oadImage.firstMissing, oadImage.hdr,
+                    &pDataInd->srcAddr);
+
+    /* The blocks are broadcast */
+    ApiMac_mlmeSetReqBool(ApiMac_attribute_RxOnWhenIdle, true);
+}
+
+/*!
+ * @brief      Process the OAD Image Block message: store the block if it is
+ *             one of the image still missing.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processOadImgBlock(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    uint8_t *pBuf = pDataInd->msdu.p;
+    uint16_t block;
+    uint8_t len;
+
+    if((pDataInd->msdu.len <= SMSGS_OAD_IMG_BLOCK_HDR_LEN) ||
+       (pDataInd->msdu.len >
+        (SMSGS_OAD_IMG_BLOCK_HDR_LEN + SMSGS_OAD_BLOCK_SIZE)))
+    {
+        return;
+    }
+
+    block = Util_buildUint16(pBuf[2], pBuf[3]);
+    len = (uint8_t)(pDataInd->msdu.len - SMSGS_OAD_IMG_BLOCK_HDR_LEN);
+    if((OadPush_isMissing(&oadImage, pBuf[1], block) == false) ||
+       ((len != SMSGS_OAD_BLOCK_SIZE) &&
+        (block != (oadImage.numBlocks - 1))))
+    {
+        /* Only the last block may be short */
+        return;
+    }
+
+    if(Ssf_oadPushWrite(block, &pBuf[SMSGS_OAD_IMG_BLOCK_HDR_LEN], len))
+    {
+        OadPush_blockStored(&oadImage, block);
+        if(oadImage.status == Smsgs_oadStatus_complete)
+        {
+            finishOadImage();
+        }
+    }
+}
+
+/*!
+ * @brief      Process the OAD Status Request message: report the blocks
+ *             still missing, in this device's slot if the request was
+ *             broadcast.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void processOadStatusReq(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    uint8_t *pBuf = pDataInd->msdu.p;
+    uint16_t baseAddr;
+    uint16_t shortAddr;
+
+    /* Only a device that heard the notify answers, and only once for a
+       complete image */
+    if((pDataInd->msdu.len != SMSGS_OAD_STATUS_REQUEST_MSG_LEN) ||
+       (oadImage.status == OADPUSH_STATUS_NONE) ||
+       (pBuf[1] != oadImage.seq) || oadInstall)
+    {
+        return;
+    }
+
+    OadPush_buildStatusRsp(&oadImage, oadStatusRsp);
+    memcpy(&oadStatusRspAddr, &pDataInd->srcAddr, sizeof(ApiMac_sAddr_t));
+
+    if(oadImage.status == Smsgs_oadStatus_receiving)
+    {
+        /* Once a round, so a reset doesn't lose the blocks stored */
+        Ssf_oadPushSave(oadImage.seq, oadImage.firstMissing, oadImage.hdr,
+                        &pDataInd->srcAddr);
+    }
+
+    if((pDataInd->dstAddr.addrMode == ApiMac_addrType_none) ||
+       ((pDataInd->dstAddr.addrMode == ApiMac_addrType_short) &&
+        (pDataInd->dstAddr.addr.shortAddr == 0xFFFF)))
+    {
+        baseAddr = Util_buildUint16(pBuf[3], pBuf[4]);
+        ApiMac_mlmeGetReqUint16(ApiMac_attribute_shortAddress, &shortAddr);
+        if(shortAddr < baseAddr)
+        {
+            /* The collector already has this device's status */
+            return;
+        }
+        if(shortAddr > baseAddr)
+        {
+            /* Broadcast, wait for this device's slot */
+            Ssf_setOadPushClock((uint32_t)(shortAddr - baseAddr) *
+                                SMSGS_OAD_STATUS_SLOT);
+            return;
+        }
+    }
+
+    sendOadStatusRsp();
+}
+
+/*!
+ * @brief      Close the stored image once every block is in, and go back to
+ *             the configured receiver setting.  An image that fails its
+ *             check is declined.
+ */
+static void finishOadImage(void)
+{
+    if(Ssf_oadPushFinish() == false)
+    {
+        OadPush_decline(&oadImage, oadImage.seq);
+    }
+
+    ApiMac_mlmeSetReqBool(ApiMac_attribute_RxOnWhenIdle, CONFIG_RX_ON_IDLE);
+}
+
+/*!
+ * @brief      Send the OAD Status Response built for the last request.
+ *             Once the image is reported complete, install it after
+ *             OAD_INSTALL_DELAY.
+ */
+static void sendOadStatusRsp(void)
+{
+    Sensor_sendMsg(Smsgs_cmdIds_oadStatusRsp, &oadStatusRspAddr, true,
+                   SMSGS_OAD_STATUS_RESPONSE_MSG_LEN, oadStatusRsp);
+
+    if(oadStatusRsp[2] == Smsgs_oadStatus_complete)
+    {
+        oadInstall = true;
+        Ssf_setOadPushClock(OAD_INSTALL_DELAY);
+    }
+}
+
 /*!
  * @brief   Build and send Config Response message
  *
@@ -1854,10 +3116,44 @@ static uint16_t validateFrameControl(uint16_t frameControl)
     {
         newFrameControl |= Smsgs_dataFields_configSettings;
     }
+    if(frameControl & Smsgs_dataFields_energyStats)
+    {
+        newFrameControl |= Smsgs_dataFields_energyStats;
+    }
+    if(frameControl & Smsgs_dataFields_latencyTrace)
+    {
+        newFrameControl |= Smsgs_dataFields_latencyTrace;
+    }
 
     return (newFrameControl);
 }
 
+/*!
+ * @brief   Get the current tick count
+ *
+ * @return  current tick count
+ */
+static uint32_t getCurrentTicks(void)
+{
+#ifdef OSAL_PORT2TIRTOS
+    return (Clock_getTicks());
+#else
+    return (ICall_getTicks());
+#endif
+}
+
+/*!
+ * @brief   Estimate the time a frame spends on the air
+ *
+ * @param   frameLen - over the air length of the frame, in bytes
+ *
+ * @return  airtime in microseconds
+ */
+static uint32_t energyAirtime(uint16_t frameLen)
+{
+    return (((uint32_t)frameLen * 8000) / (ENERGY_BIT_RATE / 1000));
+}
+
 #if defined(DEVICE_TYPE_MSG)
 static void Sensor_sendDeviceTypeResponse(void)
 {
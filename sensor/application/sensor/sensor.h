@@ -73,6 +73,10 @@ extern "C"
 #define SENSOR_START_EVT 0x0001
 /*! Event ID - Reading Timeout Event */
 #define SENSOR_READING_TIMEOUT_EVT 0x0002
+/*! Event ID - Group Command Response slot Event */
+#define SENSOR_GROUP_ACK_EVT 0x0200
+/*! Event ID - OAD Status Response slot or pushed image install Event */
+#define SENSOR_OAD_PUSH_EVT 0x0400
 
 #ifdef FEATURE_NATIVE_OAD
 /*! Event ID - OAD Timeout Event */
@@ -109,6 +113,11 @@ extern "C"
 /*! tick number for one ms  */
 #define TICKPERIOD_MS_US      (1000/(CLOCK_TICK_PERIOD))
 
+/*! Over the air overhead (PHY, MAC header, security and FCS) of a data frame */
+#define SENSOR_ENERGY_FRAME_OVERHEAD 31
+/*! Over the air length of a data request (poll) frame */
+#define SENSOR_ENERGY_POLL_FRAME_LEN 26
+
 /*! Sensor Status Values */
 typedef enum
 {
@@ -135,6 +144,9 @@ extern uint16_t Sensor_events;
 /*! Sensor statistics */
 extern Smsgs_msgStatsField_t Sensor_msgStats;
 
+/*! Energy and airtime accounting for the current reporting period */
+extern Smsgs_energyStatsField_t Sensor_energyStats;
+
 #ifdef POWER_MEAS
 /*! Power Measurement Statistics */
  extern Smsgs_powerMeastatsField_t Sensor_pwrMeasStats;
@@ -187,6 +199,22 @@ extern bool Sensor_sendMsg(Smsgs_cmdIds_t type, ApiMac_sAddr_t *pDstAddr,
  */
 extern void Sensor_sendIdentifyLedRequest(void);
 
+/*!
+ * @brief   Account for a transmitted frame in the energy statistics
+ *
+ * @param   frameLen - over the air length of the frame, in bytes
+ * @param   attempts - number of times the frame was transmitted
+ */
+extern void Sensor_energyTx(uint16_t frameLen, uint8_t attempts);
+
+/*!
+ * @brief   Account for an active scan in the energy statistics
+ *
+ * @param   numChannels - number of channels scanned
+ * @param   scanDuration - scan duration exponent of the scan request
+ */
+extern void Sensor_energyScan(uint8_t numChannels, uint8_t scanDuration);
+
 
 #ifdef FEATURE_SECURE_COMMISSIONING
 /*!
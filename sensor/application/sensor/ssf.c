@@ -89,10 +89,17 @@
 
 #ifdef FEATURE_NATIVE_OAD
 #include "oad_client.h"
+#include "oad_storage.h"
+#include "oad_image_header.h"
+#include "sys_ctrl.h"
 #endif //FEATURE_NATIVE_OAD
 
 #ifdef OSAL_PORT2TIRTOS
 #include "osal_port.h"
+#ifdef OSAL_PORT_CS_STATS
+#include <xdc/runtime/Timestamp.h>
+#include <xdc/runtime/Types.h>
+#endif
 #else
 #include "icall.h"
 #endif
@@ -104,6 +111,14 @@
 /* Initial timeout value for the reading clock */
 #define READING_INIT_TIMEOUT_VALUE 100
 
+#if !defined(SSF_CLOCK_TOLERANCE)
+/*
+ Milliseconds a clock expiration may be delayed by so it is handled in the
+ same wakeup as another one (at most a quarter of the clock's timeout)
+ */
+#define SSF_CLOCK_TOLERANCE 250
+#endif
+
 /* SSF Events */
 #define KEY_EVENT               0x0001
 #define NODE_EVENT_UBLE         0x0002
@@ -125,6 +140,13 @@
 #define SSF_NV_RESET_COUNT_ID 0x0006
 /* NV Item ID - OAD information */
 #define SSF_NV_OAD_ID 0x0007
+
+#ifdef FEATURE_NATIVE_OAD
+/* OAD storage puts block n at n times its block size */
+#if defined(OAD_BLOCK_SIZE) && (OAD_BLOCK_SIZE != SMSGS_OAD_BLOCK_SIZE)
+#error "Pushed OAD images need OAD_BLOCK_SIZE equal to SMSGS_OAD_BLOCK_SIZE"
+#endif
+#endif /* FEATURE_NATIVE_OAD */
 /* NV Item ID - Device Key information */
 #define SSF_NV_DEVICE_KEY_ID  0x0008
 /* NV Item ID - the number of black list entries */
@@ -216,28 +238,23 @@ static ICall_Semaphore sensorSem;
 #endif
 
 /* Clock/timer resources */
-static Clock_Struct readingClkStruct;
-static Clock_Handle readingClkHandle;
+static Timer_WheelEntry readingClk;
+static Timer_WheelEntry groupAckClk;
+static Timer_WheelEntry oadPushClk;
 
 /* Clock/timer resources for JDLLC */
 /* trickle timer */
-STATIC Clock_Struct tricklePASClkStruct;
-STATIC Clock_Handle tricklePASClkHandle;
-STATIC Clock_Struct tricklePCSClkStruct;
-STATIC Clock_Handle tricklePCSClkHandle;
+STATIC Timer_WheelEntry tricklePASClk;
+STATIC Timer_WheelEntry tricklePCSClk;
 /* poll timer */
-STATIC Clock_Struct pollClkStruct;
-STATIC Clock_Handle pollClkHandle;
+STATIC Timer_WheelEntry pollClk;
 /* scan backoff timer */
-STATIC Clock_Struct scanBackoffClkStruct;
-STATIC Clock_Handle scanBackoffClkHandle;
+STATIC Timer_WheelEntry scanBackoffClk;
 /* FH assoc delay */
-STATIC Clock_Struct fhAssocClkStruct;
-STATIC Clock_Handle fhAssocClkHandle;
+STATIC Timer_WheelEntry fhAssocClk;
 
 #ifdef USE_DMM
-STATIC Clock_Struct provisioningClkStruct;
-STATIC Clock_Handle provisioningClkHandle;
+STATIC Timer_WheelEntry provisioningClk;
 #endif /* USE_DMM */
 
 /* Key press parameters */
@@ -274,12 +291,20 @@ static uint32_t prevTicks;
 CUI_clientHandle_t ssfCuiHndl;
 uint32_t sensorStatusLine;
 uint32_t perStatusLine;
+#ifdef OSAL_PORT_CS_STATS
+uint32_t csStatsStatusLine;
+#endif
 
 /******************************************************************************
  Local function prototypes
  *****************************************************************************/
 
 static void processReadingTimeoutCallback(UArg a0);
+#if defined(OSAL_PORT_CS_STATS) && !defined(POWER_MEAS)
+static void displayCSStats(void);
+#endif
+static void processGroupAckTimeoutCallback(UArg a0);
+static void processOadPushTimeoutCallback(UArg a0);
 static void processKeyChangeCallback(uint32_t _btn, Button_EventMask _events);
 static void processPCSTrickleTimeoutCallback(UArg a0);
 static void processPASTrickleTimeoutCallback(UArg a0);
@@ -436,6 +461,9 @@ void Ssf_init(void *sem)
 #ifdef DISPLAY_PER_STATS
     clientParams.maxStatusLines++;
 #endif
+#ifdef OSAL_PORT_CS_STATS
+    clientParams.maxStatusLines++;
+#endif
 #ifdef FEATURE_SECURE_COMMISSIONING
     clientParams.maxStatusLines++;
 #endif
@@ -497,6 +525,9 @@ void Ssf_init(void *sem)
 #ifdef DISPLAY_PER_STATS
     CUI_statusLineResourceRequest(ssfCuiHndl, "Sensor PER", &perStatusLine);
 #endif
+#ifdef OSAL_PORT_CS_STATS
+    CUI_statusLineResourceRequest(ssfCuiHndl, "OSAL CS", &csStatsStatusLine);
+#endif
 #endif /* POWER_MEAS */
 
     if((pNV != NULL) && (pNV->readItem != NULL))
@@ -1047,6 +1078,129 @@ void Ssf_clearOadInfo()
 }
 #endif /* FEATURE_NATIVE_OAD */
 
+/*!
+ Decide whether to take a pushed OAD image
+
+ Public function defined in ssf.h
+ */
+bool Ssf_oadPushOpen(uint8_t seq, uint8_t *pImgHdr, uint16_t *pNumStored)
+{
+#ifdef FEATURE_NATIVE_OAD
+    uint8_t savedHdr[OADProtocol_IMAGE_ID_LEN];
+    uint8_t savedSeq;
+    uint16_t savedBlock;
+    ApiMac_sAddr_t savedSrvAddr;
+    uint32_t crc32 = Util_buildUint32(pImgHdr[OAD_IMG_ID_LEN],
+                                      pImgHdr[OAD_IMG_ID_LEN + 1],
+                                      pImgHdr[OAD_IMG_ID_LEN + 2],
+                                      pImgHdr[OAD_IMG_ID_LEN + 3]);
+
+    /* Only an image built for this application, and not the one running */
+    if((memcmp(pImgHdr, _imgHdr.fixedHdr.imgID, OAD_IMG_ID_LEN) != 0) ||
+       (crc32 == _imgHdr.fixedHdr.crc32))
+    {
+        return (false);
+    }
+
+    /* Carry on where a reset stopped the same image */
+    *pNumStored = 0;
+    if(Ssf_getOadInfo(&savedBlock, savedHdr, &savedSeq, &savedSrvAddr) &&
+       (savedSeq == seq) &&
+       (memcmp(savedHdr, pImgHdr, OADProtocol_IMAGE_ID_LEN) == 0))
+    {
+        *pNumStored = savedBlock;
+    }
+
+    OADStorage_init();
+    return (true);
+#else
+    (void)seq;
+    (void)pImgHdr;
+    *pNumStored = 0;
+    return (false);
+#endif /* FEATURE_NATIVE_OAD */
+}
+
+/*!
+ Save the progress of a pushed OAD image
+
+ Public function defined in ssf.h
+ */
+void Ssf_oadPushSave(uint8_t seq, uint16_t firstMissing, uint8_t *pImgHdr,
+                     ApiMac_sAddr_t *pSrvAddr)
+{
+#ifdef FEATURE_NATIVE_OAD
+    Ssf_oadInfoUpdate(&firstMissing, pImgHdr, &seq, pSrvAddr);
+#else
+    (void)seq;
+    (void)firstMissing;
+    (void)pImgHdr;
+    (void)pSrvAddr;
+#endif /* FEATURE_NATIVE_OAD */
+}
+
+/*!
+ Store a block of a pushed OAD image
+
+ Public function defined in ssf.h
+ */
+bool Ssf_oadPushWrite(uint16_t block, uint8_t *pData, uint8_t len)
+{
+#ifdef FEATURE_NATIVE_OAD
+    return (OADStorage_imgBlockWrite(block, pData, len) ==
+            OADStorage_Status_Success);
+#else
+    (void)block;
+    (void)pData;
+    (void)len;
+    return (false);
+#endif /* FEATURE_NATIVE_OAD */
+}
+
+/*!
+ Check and close a pushed OAD image
+
+ Public function defined in ssf.h
+ */
+bool Ssf_oadPushFinish(void)
+{
+#ifdef FEATURE_NATIVE_OAD
+    /* Checks the CRC of the image and marks it for the boot image manager */
+    bool status = (OADStorage_imgFinalise() == OADStorage_Status_Success);
+
+    OADStorage_close();
+    return (status);
+#else
+    return (false);
+#endif /* FEATURE_NATIVE_OAD */
+}
+
+/*!
+ Close a pushed OAD image without finishing it
+
+ Public function defined in ssf.h
+ */
+void Ssf_oadPushClose(void)
+{
+#ifdef FEATURE_NATIVE_OAD
+    OADStorage_close();
+#endif /* FEATURE_NATIVE_OAD */
+}
+
+/*!
+ Install the finished OAD image
+
+ Public function defined in ssf.h
+ */
+void Ssf_oadPushInstall(void)
+{
+#ifdef FEATURE_NATIVE_OAD
+    /* Nothing left to resume */
+    Ssf_clearOadInfo();
+    SysCtrlSystemReset();
+#endif /* FEATURE_NATIVE_OAD */
+}
+
 /*!
  The application calls this function to indicate a Configuration
  Request message.
@@ -1117,6 +1271,9 @@ void Ssf_trackingUpdate(ApiMac_sAddr_t *pSrcAddr)
  */
 void Ssf_sensorReadingUpdate(Smsgs_sensorMsg_t *pMsg)
 {
+#if defined(OSAL_PORT_CS_STATS) && !defined(POWER_MEAS)
+    displayCSStats();
+#endif
 }
 
 /*!
@@ -1127,12 +1284,8 @@ void Ssf_sensorReadingUpdate(Smsgs_sensorMsg_t *pMsg)
 void Ssf_initializeReadingClock(void)
 {
     /* Initialize the timers needed for this application */
-    readingClkHandle = Timer_construct(&readingClkStruct,
-                                        processReadingTimeoutCallback,
-                                        READING_INIT_TIMEOUT_VALUE,
-                                        0,
-                                        false,
-                                        0);
+    Timer_wheelConstruct(&readingClk, processReadingTimeoutCallback,
+                         READING_INIT_TIMEOUT_VALUE, SSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1143,9 +1296,9 @@ void Ssf_initializeReadingClock(void)
 void Ssf_setReadingClock(uint32_t readingTime)
 {
     /* Stop the Reading timer */
-    if(Timer_isActive(&readingClkStruct) == true)
+    if(Timer_wheelIsActive(&readingClk) == true)
     {
-        Timer_stop(&readingClkStruct);
+        Timer_wheelStop(&readingClk);
     }
 #ifdef POWER_MEAS
     if(POWER_TEST_PROFILE != DATA_ACK)
@@ -1157,8 +1310,70 @@ void Ssf_setReadingClock(uint32_t readingTime)
     /* Setup timer */
     if ( readingTime )
     {
-        Timer_setTimeout(readingClkHandle, readingTime);
-        Timer_start(&readingClkStruct);
+        Timer_wheelSetTimeout(&readingClk, readingTime);
+        Timer_wheelStart(&readingClk);
+    }
+}
+
+/*!
+ Initialize the group command response clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_initializeGroupAckClock(void)
+{
+    /* No tolerance, the response has to stay in its slot */
+    Timer_wheelConstruct(&groupAckClk, processGroupAckTimeoutCallback,
+                         SMSGS_GROUP_CMD_ACK_SLOT, 0, 0);
+}
+
+/*!
+ Set the group command response clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_setGroupAckClock(uint32_t ackTime)
+{
+    if(Timer_wheelIsActive(&groupAckClk) == true)
+    {
+        Timer_wheelStop(&groupAckClk);
+    }
+
+    if(ackTime)
+    {
+        Timer_wheelSetTimeout(&groupAckClk, ackTime);
+        Timer_wheelStart(&groupAckClk);
+    }
+}
+
+/*!
+ Initialize the OAD status response and install clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_initializeOadPushClock(void)
+{
+    /* No tolerance, the response has to stay in its slot */
+    Timer_wheelConstruct(&oadPushClk, processOadPushTimeoutCallback,
+                         SMSGS_OAD_STATUS_SLOT, 0, 0);
+}
+
+/*!
+ Set the OAD status response and install clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_setOadPushClock(uint32_t oadTime)
+{
+    if(Timer_wheelIsActive(&oadPushClk) == true)
+    {
+        Timer_wheelStop(&oadPushClk);
+    }
+
+    if(oadTime)
+    {
+        Timer_wheelSetTimeout(&oadPushClk, oadTime);
+        Timer_wheelStart(&oadPushClk);
     }
 }
 
@@ -1201,19 +1416,11 @@ void Ssf_free(void *ptr)
 void Ssf_initializeTrickleClock(void)
 {
     /* Initialize trickle timer */
-    tricklePASClkHandle = Timer_construct(&tricklePASClkStruct,
-                                         processPASTrickleTimeoutCallback,
-                                         TRICKLE_TIMEOUT_VALUE,
-                                         0,
-                                         false,
-                                         0);
+    Timer_wheelConstruct(&tricklePASClk, processPASTrickleTimeoutCallback,
+                         TRICKLE_TIMEOUT_VALUE, SSF_CLOCK_TOLERANCE, 0);
 
-    tricklePCSClkHandle = Timer_construct(&tricklePCSClkStruct,
-                                         processPCSTrickleTimeoutCallback,
-                                         TRICKLE_TIMEOUT_VALUE,
-                                         0,
-                                         false,
-                                         0);
+    Timer_wheelConstruct(&tricklePCSClk, processPCSTrickleTimeoutCallback,
+                         TRICKLE_TIMEOUT_VALUE, SSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1227,9 +1434,9 @@ void Ssf_setTrickleClock(uint16_t trickleTime, uint8_t frameType)
     if(frameType == ApiMac_wisunAsyncFrame_advertisementSolicit)
     {
         /* Stop the PA trickle timer */
-        if(Timer_isActive(&tricklePASClkStruct) == true)
+        if(Timer_wheelIsActive(&tricklePASClk) == true)
         {
-            Timer_stop(&tricklePASClkStruct);
+            Timer_wheelStop(&tricklePASClk);
         }
 
         if(trickleTime > 0)
@@ -1239,16 +1446,16 @@ void Ssf_setTrickleClock(uint16_t trickleTime, uint8_t frameType)
             trickleTime = (trickleTime >> 1) +
                           (randomNum % (trickleTime >> 1));
             /* Setup timer */
-            Timer_setTimeout(tricklePASClkHandle, trickleTime);
-            Timer_start(&tricklePASClkStruct);
+            Timer_wheelSetTimeout(&tricklePASClk, trickleTime);
+            Timer_wheelStart(&tricklePASClk);
         }
     }
     else if(frameType == ApiMac_wisunAsyncFrame_configSolicit)
     {
         /* Stop the PC trickle timer */
-        if(Timer_isActive(&tricklePCSClkStruct) == true)
+        if(Timer_wheelIsActive(&tricklePCSClk) == true)
         {
-            Timer_stop(&tricklePCSClkStruct);
+            Timer_wheelStop(&tricklePCSClk);
         }
 
         if(trickleTime > 0)
@@ -1259,8 +1466,8 @@ void Ssf_setTrickleClock(uint16_t trickleTime, uint8_t frameType)
             randomNum = ((ApiMac_randomByte() << 8) + ApiMac_randomByte());
             trickleTime = (trickleTime >> 1) +
                           (randomNum % (trickleTime >> 1));
-            Timer_setTimeout(tricklePCSClkHandle, trickleTime);
-            Timer_start(&tricklePCSClkStruct);
+            Timer_wheelSetTimeout(&tricklePCSClk, trickleTime);
+            Timer_wheelStart(&tricklePCSClk);
         }
     }
 }
@@ -1273,12 +1480,8 @@ void Ssf_setTrickleClock(uint16_t trickleTime, uint8_t frameType)
 void Ssf_initializePollClock(void)
 {
     /* Initialize the timers needed for this application */
-    pollClkHandle = Timer_construct(&pollClkStruct,
-                                     processPollTimeoutCallback,
-                                     POLL_TIMEOUT_VALUE,
-                                     0,
-                                     false,
-                                     0);
+    Timer_wheelConstruct(&pollClk, processPollTimeoutCallback,
+                         POLL_TIMEOUT_VALUE, SSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1289,9 +1492,9 @@ void Ssf_initializePollClock(void)
 void Ssf_setPollClock(uint32_t pollTime)
 {
     /* Stop the Reading timer */
-    if(Timer_isActive(&pollClkStruct) == true)
+    if(Timer_wheelIsActive(&pollClk) == true)
     {
-        Timer_stop(&pollClkStruct);
+        Timer_wheelStop(&pollClk);
     }
 #ifdef POWER_MEAS
     if ((POWER_TEST_PROFILE == DATA_ACK) || (POWER_TEST_PROFILE == SLEEP))
@@ -1304,19 +1507,19 @@ void Ssf_setPollClock(uint32_t pollTime)
     if(pollTime > 0)
     {
         if(SM_Last_State == SM_CM_InProgress) {
-            Timer_setTimeout(pollClkHandle, SM_POLLING_INTERVAL);
+            Timer_wheelSetTimeout(&pollClk, SM_POLLING_INTERVAL);
         }
         else {
-            Timer_setTimeout(pollClkHandle, pollTime);
+            Timer_wheelSetTimeout(&pollClk, pollTime);
         }
-        Timer_start(&pollClkStruct);
+        Timer_wheelStart(&pollClk);
     }
 #else
     /* Setup timer */
     if(pollTime > 0)
     {
-        Timer_setTimeout(pollClkHandle, pollTime);
-        Timer_start(&pollClkStruct);
+        Timer_wheelSetTimeout(&pollClk, pollTime);
+        Timer_wheelStart(&pollClk);
     }
 #endif /*FEATURE_SECURE_COMMISSIONING*/
 }
@@ -1328,7 +1531,7 @@ void Ssf_setPollClock(uint32_t pollTime)
  */
 uint32_t Ssf_getPollClock(void)
 {
-    return Timer_getTimeout(pollClkHandle);
+    return Timer_wheelGetTimeout(&pollClk);
 }
 
 /*!
@@ -1339,12 +1542,8 @@ uint32_t Ssf_getPollClock(void)
 void Ssf_initializeScanBackoffClock(void)
 {
     /* Initialize the timers needed for this application */
-    scanBackoffClkHandle = Timer_construct(&scanBackoffClkStruct,
-                                           processScanBackoffTimeoutCallback,
-                                           SCAN_BACKOFF_TIMEOUT_VALUE,
-                                           0,
-                                           false,
-                                           0);
+    Timer_wheelConstruct(&scanBackoffClk, processScanBackoffTimeoutCallback,
+                         SCAN_BACKOFF_TIMEOUT_VALUE, SSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1355,16 +1554,16 @@ void Ssf_initializeScanBackoffClock(void)
 void Ssf_setScanBackoffClock(uint32_t scanBackoffTime)
 {
     /* Stop the Reading timer */
-    if(Timer_isActive(&scanBackoffClkStruct) == true)
+    if(Timer_wheelIsActive(&scanBackoffClk) == true)
     {
-        Timer_stop(&scanBackoffClkStruct);
+        Timer_wheelStop(&scanBackoffClk);
     }
 
     /* Setup timer */
     if(scanBackoffTime > 0)
     {
-        Timer_setTimeout(scanBackoffClkHandle, scanBackoffTime);
-        Timer_start(&scanBackoffClkStruct);
+        Timer_wheelSetTimeout(&scanBackoffClk, scanBackoffTime);
+        Timer_wheelStart(&scanBackoffClk);
     }
 }
 
@@ -1376,9 +1575,9 @@ void Ssf_setScanBackoffClock(uint32_t scanBackoffTime)
 void Ssf_stopScanBackoffClock(void)
 {
     /* Stop the Reading timer */
-    if(Timer_isActive(&scanBackoffClkStruct) == true)
+    if(Timer_wheelIsActive(&scanBackoffClk) == true)
     {
-        Timer_stop(&scanBackoffClkStruct);
+        Timer_wheelStop(&scanBackoffClk);
     }
 }
 
@@ -1390,12 +1589,8 @@ void Ssf_stopScanBackoffClock(void)
 void Ssf_initializeFHAssocClock(void)
 {
     /* Initialize the timers needed for this application */
-    fhAssocClkHandle = Timer_construct(&fhAssocClkStruct,
-                                       processFHAssocTimeoutCallback,
-                                       FH_ASSOC_TIMER,
-                                        0,
-                                        false,
-                                        0);
+    Timer_wheelConstruct(&fhAssocClk, processFHAssocTimeoutCallback,
+                         FH_ASSOC_TIMER, SSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1406,9 +1601,9 @@ void Ssf_initializeFHAssocClock(void)
 void Ssf_setFHAssocClock(uint32_t fhAssocTime)
 {
     /* Stop the Reading timer */
-    if(Timer_isActive(&fhAssocClkStruct) == true)
+    if(Timer_wheelIsActive(&fhAssocClk) == true)
     {
-        Timer_stop(&fhAssocClkStruct);
+        Timer_wheelStop(&fhAssocClk);
     }
 
     /* Setup timer */
@@ -1420,8 +1615,8 @@ void Ssf_setFHAssocClock(uint32_t fhAssocTime)
             fhAssocTime = fhAssocTime + (((ApiMac_randomByte() << 8) +
                           ApiMac_randomByte()) % ADD_ASSOCIATION_RANDOM_WINDOW);
         }
-        Timer_setTimeout(fhAssocClkHandle, fhAssocTime);
-        Timer_start(&fhAssocClkStruct);
+        Timer_wheelSetTimeout(&fhAssocClk, fhAssocTime);
+        Timer_wheelStart(&fhAssocClk);
     }
 }
 
@@ -1435,12 +1630,8 @@ void Ssf_setFHAssocClock(uint32_t fhAssocTime)
 void Ssf_initializeProvisioningClock(void)
 {
     /* Initialize the timers needed for this application */
-    provisioningClkHandle = Timer_construct(&provisioningClkStruct,
-                                       processProvisioningCallback,
-                                       FH_ASSOC_TIMER,
-                                        0,
-                                        false,
-                                        0);
+    Timer_wheelConstruct(&provisioningClk, processProvisioningCallback,
+                         FH_ASSOC_TIMER, SSF_CLOCK_TOLERANCE, 0);
 }
 
 /*!
@@ -1451,24 +1642,24 @@ void Ssf_initializeProvisioningClock(void)
 void Ssf_setProvisioningClock(bool provision)
 {
     /* Stop the Provisioning timer */
-    if(Timer_isActive(&provisioningClkStruct) == true)
+    if(Timer_wheelIsActive(&provisioningClk) == true)
     {
-        Timer_stop(&provisioningClkStruct);
+        Timer_wheelStop(&provisioningClk);
     }
 
     /* Setup timer for provisioning association timeout */
     if (provision)
     {
-        Timer_setTimeout(provisioningClkHandle, PROVISIONING_ASSOC_TIMER);
+        Timer_wheelSetTimeout(&provisioningClk, PROVISIONING_ASSOC_TIMER);
     }
     /* Setup timer for disassociation delay */
     else
     {
-        Timer_setTimeout(provisioningClkHandle, PROVISIONING_DISASSOC_TIMER);
+        Timer_wheelSetTimeout(&provisioningClk, PROVISIONING_DISASSOC_TIMER);
     }
 
-    Timer_setFunc(provisioningClkHandle, processProvisioningCallback, provision);
-    Timer_start(&provisioningClkStruct);
+    Timer_wheelSetFunc(&provisioningClk, processProvisioningCallback, provision);
+    Timer_wheelStart(&provisioningClk);
 }
 
 
@@ -1782,6 +1973,19 @@ void Ssf_clearAllNVItems(void)
 #endif
 }
 
+/*!
+ Compact NV ahead of time while idle
+
+ Public function defined in ssf.h
+ */
+void Ssf_compactNV(void)
+{
+#ifndef ONE_PAGE_NV
+    /* Compacts at most one page, and only when free space is low */
+    (void)NVOCMP_compactStep();
+#endif
+}
+
 /*!
  Add an entry into the black list
 
@@ -1996,6 +2200,36 @@ static void processReadingTimeoutCallback(UArg a0)
     Semaphore_post(sensorSem);
 }
 
+/*!
+ * @brief   Group command response slot handler function.
+ *
+ * @param   a0 - ignored
+ */
+static void processGroupAckTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Sensor_events, SENSOR_GROUP_ACK_EVT);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
+
+/*!
+ * @brief   OAD status response slot and install handler function.
+ *
+ * @param   a0 - ignored
+ */
+static void processOadPushTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Sensor_events, SENSOR_OAD_PUSH_EVT);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
+
 /*!
  * @brief       Key event handler function
  *
@@ -2203,6 +2437,32 @@ void Ssf_displayPerStats(Smsgs_msgStatsField_t* pstats)
 }
 #endif /* DISPLAY_PER_STATS */
 
+#if defined(OSAL_PORT_CS_STATS) && !defined(POWER_MEAS)
+/*!
+ * @brief       Print the time interrupts were held off by OSAL port critical
+ *              sections, the longest and the mean, in microseconds.
+ */
+static void displayCSStats(void)
+{
+    OsalPort_CSStats stats;
+    Types_FreqHz freq;
+    uint32_t mean = 0;
+
+    OsalPort_getCSStats(&stats);
+    Timestamp_getFreq(&freq);
+    if(stats.count > 0)
+    {
+        mean = (uint32_t)((stats.totalTicks * 1000000) /
+                          ((uint64_t)stats.count * freq.lo));
+    }
+    CUI_statusLinePrintf(ssfCuiHndl, csStatsStatusLine,
+                         "Max=%uus, Mean=%uus, Count=%u",
+                         (unsigned)(((uint64_t)stats.maxTicks * 1000000) /
+                                    freq.lo),
+                         (unsigned)mean, (unsigned)stats.count);
+}
+#endif /* OSAL_PORT_CS_STATS && !POWER_MEAS */
+
 #ifdef FEATURE_UBLE
 /*********************************************************************
 * @fn      bleAdv_eventProxyCB
@@ -200,6 +200,62 @@ extern bool Ssf_getOadInfo(uint16_t *pOadBlock, uint8_t *pOadImgHdr, uint8_t *pO
 extern void Ssf_clearOadInfo();
 #endif //FEATURE_NATIVE_OAD
 
+/*!
+ * @brief       Decide whether to take a pushed OAD image, and get its
+ *              storage ready.  Without native OAD support every image is
+ *              declined.
+ *
+ * @param       seq - Image Sequence of the image
+ * @param       pImgHdr - its Image Header (SMSGS_OAD_IMG_HDR_LEN bytes)
+ * @param       pNumStored - set to the blocks from the start of the image
+ *                           stored before a reset, if it is the same image
+ *
+ * @return      true if the image is wanted
+ */
+extern bool Ssf_oadPushOpen(uint8_t seq, uint8_t *pImgHdr,
+                            uint16_t *pNumStored);
+
+/*!
+ * @brief       Save the progress of a pushed OAD image in NV, see
+ *              Ssf_oadInfoUpdate().
+ *
+ * @param       seq - Image Sequence of the image
+ * @param       firstMissing - first block not stored yet
+ * @param       pImgHdr - its Image Header
+ * @param       pSrvAddr - address of the collector pushing it
+ */
+extern void Ssf_oadPushSave(uint8_t seq, uint16_t firstMissing,
+                            uint8_t *pImgHdr, ApiMac_sAddr_t *pSrvAddr);
+
+/*!
+ * @brief       Store a block of a pushed OAD image.
+ *
+ * @param       block - Block Number
+ * @param       pData - the block
+ * @param       len - its length, SMSGS_OAD_BLOCK_SIZE but for the last one
+ *
+ * @return      true if stored
+ */
+extern bool Ssf_oadPushWrite(uint16_t block, uint8_t *pData, uint8_t len);
+
+/*!
+ * @brief       Check and close a pushed OAD image with every block stored.
+ *
+ * @return      true if the image can be installed
+ */
+extern bool Ssf_oadPushFinish(void);
+
+/*!
+ * @brief       Close a pushed OAD image without finishing it.
+ */
+extern void Ssf_oadPushClose(void);
+
+/*!
+ * @brief       Install the finished OAD image: reset into the boot image
+ *              manager.
+ */
+extern void Ssf_oadPushInstall(void);
+
 /*!
  * @brief       The application calls this function to indicate that the
  *              device's state has changed.
@@ -220,6 +276,31 @@ extern void Ssf_initializeReadingClock(void);
  */
 extern void Ssf_setReadingClock(uint32_t readingTime);
 
+/*!
+ * @brief       Initialize the group command response clock.
+ */
+extern void Ssf_initializeGroupAckClock(void);
+
+/*!
+ * @brief       set the group command response clock.
+ *
+ * @param       ackTime - time until the response slot (in msec)
+ */
+extern void Ssf_setGroupAckClock(uint32_t ackTime);
+
+/*!
+ * @brief       Initialize the OAD status response and install clock.
+ */
+extern void Ssf_initializeOadPushClock(void);
+
+/*!
+ * @brief       set the OAD status response and install clock.
+ *
+ * @param       oadTime - time until the response slot or the install
+ *                        (in msec)
+ */
+extern void Ssf_setOadPushClock(uint32_t oadTime);
+
 /*!
  * @brief       The application calls this function to indicate that this
  *              device has been removed from the network.
@@ -422,6 +503,12 @@ extern void Ssf_clearNetworkInfo(void);
  */
 extern void Ssf_clearAllNVItems(void);
 
+/*!
+ * @brief       Compact NV ahead of time so that NV writes don't have to.
+ *              Call when the application is idle.
+ */
+extern void Ssf_compactNV(void);
+
 /*!
  * @brief       The application calls this function to get the
  *              temperature from the onboard sensor
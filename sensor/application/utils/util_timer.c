@@ -54,6 +54,7 @@
 #include <stdbool.h>
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Queue.h>
+#include <ti/sysbios/knl/Swi.h>
 
 #include "util_timer.h"
 
@@ -71,6 +72,36 @@ typedef struct _queueRec_
     uint8_t *pData;      /* pointer to app data */
 } queueRec_t;
 
+/*! Largest share of a wheel entry timeout that may go to its tolerance */
+#define TIMER_WHEEL_TOLERANCE_SHIFT     2
+
+/*! true if tick a is before tick b, allowing for wrap */
+#define TIMER_TICK_BEFORE(a, b)     ((int32_t)((a) - (b)) < 0)
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+/* Clock shared by all wheel entries */
+static Clock_Struct wheelClkStruct;
+static Clock_Handle wheelClkHandle = NULL;
+
+/* Started entries, in order of deadline */
+static Timer_WheelEntry *pWheelHead = NULL;
+
+/* Set while expired entries are being called back */
+static bool wheelExpiring = false;
+
+static Timer_WheelStats wheelStats;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static void wheelTimeoutCallback(UArg a0);
+static void wheelRemove(Timer_WheelEntry *pEntry);
+static void wheelInsert(Timer_WheelEntry *pEntry);
+static void wheelArm(void);
+
 /******************************************************************************
  Public Functions
  *****************************************************************************/
@@ -188,3 +219,321 @@ void Timer_setFunc(Clock_Handle handle, Clock_FuncPtr fxn, UArg arg)
 {
     Clock_setFunc(handle, fxn, arg);
 }
+
+/*!
+ Initialize a timer wheel entry.
+
+ Public function defined in util_timer.h
+ */
+void Timer_wheelConstruct(Timer_WheelEntry *pEntry, Clock_FuncPtr fxn,
+                          uint32_t timeout, uint32_t tolerance, UArg arg)
+{
+    if(wheelClkHandle == NULL)
+    {
+        wheelClkHandle = Timer_construct(&wheelClkStruct, wheelTimeoutCallback,
+                                         0, 0, false, 0);
+    }
+
+    memset(pEntry, 0, sizeof(Timer_WheelEntry));
+    pEntry->fxn = fxn;
+    pEntry->arg = arg;
+    pEntry->timeout = timeout;
+    pEntry->tolerance = tolerance;
+}
+
+/*!
+ Start a timer wheel entry.
+
+ Public function defined in util_timer.h
+ */
+void Timer_wheelStart(Timer_WheelEntry *pEntry)
+{
+    uint32_t timeout = pEntry->timeout;
+    uint32_t slack;
+    UInt key;
+
+    /* Past it the ticks can't be told apart from ones gone by */
+    if(timeout > TIMER_WHEEL_MAX_TIMEOUT)
+    {
+        timeout = TIMER_WHEEL_MAX_TIMEOUT;
+    }
+
+    slack = timeout >> TIMER_WHEEL_TOLERANCE_SHIFT;
+    if(pEntry->tolerance < slack)
+    {
+        slack = pEntry->tolerance;
+    }
+    if(slack > (TIMER_WHEEL_MAX_TIMEOUT - timeout))
+    {
+        slack = TIMER_WHEEL_MAX_TIMEOUT - timeout;
+    }
+
+    key = Swi_disable();
+
+    wheelRemove(pEntry);
+
+    pEntry->expiry = Clock_getTicks() + (timeout * TIMER_MS_ADJUSTMENT);
+    pEntry->deadline = pEntry->expiry + (slack * TIMER_MS_ADJUSTMENT);
+    pEntry->active = true;
+
+    wheelInsert(pEntry);
+    wheelArm();
+
+    Swi_restore(key);
+}
+
+/*!
+ Determine if a timer wheel entry is currently active.
+
+ Public function defined in util_timer.h
+ */
+bool Timer_wheelIsActive(Timer_WheelEntry *pEntry)
+{
+    return(pEntry->active);
+}
+
+/*!
+ Stop a timer wheel entry.
+
+ Public function defined in util_timer.h
+ */
+void Timer_wheelStop(Timer_WheelEntry *pEntry)
+{
+    UInt key = Swi_disable();
+
+    if(pEntry->active == true)
+    {
+        wheelRemove(pEntry);
+        pEntry->active = false;
+
+        /* Don't wake up for an entry that is gone */
+        wheelArm();
+    }
+
+    Swi_restore(key);
+}
+
+/*!
+ Set a timer wheel entry timeout.
+
+ Public function defined in util_timer.h
+ */
+void Timer_wheelSetTimeout(Timer_WheelEntry *pEntry, uint32_t timeout)
+{
+    pEntry->timeout = timeout;
+}
+
+/*!
+ Get a timer wheel entry timeout.
+
+ Public function defined in util_timer.h
+ */
+uint32_t Timer_wheelGetTimeout(Timer_WheelEntry *pEntry)
+{
+    uint32_t timeout = pEntry->timeout;
+    UInt key = Swi_disable();
+
+    if(pEntry->active == true)
+    {
+        uint32_t now = Clock_getTicks();
+
+        timeout = 0;
+        if(TIMER_TICK_BEFORE(now, pEntry->expiry))
+        {
+            timeout = (pEntry->expiry - now) / TIMER_MS_ADJUSTMENT;
+        }
+    }
+
+    Swi_restore(key);
+
+    return(timeout);
+}
+
+/*!
+ Set a timer wheel entry callback function and argument.
+
+ Public function defined in util_timer.h
+ */
+void Timer_wheelSetFunc(Timer_WheelEntry *pEntry, Clock_FuncPtr fxn, UArg arg)
+{
+    UInt key = Swi_disable();
+
+    pEntry->fxn = fxn;
+    pEntry->arg = arg;
+
+    Swi_restore(key);
+}
+
+/*!
+ Get the timer wheel counts.
+
+ Public function defined in util_timer.h
+ */
+void Timer_wheelGetStats(Timer_WheelStats *pStats, bool reset)
+{
+    UInt key = Swi_disable();
+
+    if(pStats != NULL)
+    {
+        *pStats = wheelStats;
+    }
+    if(reset == true)
+    {
+        memset(&wheelStats, 0, sizeof(wheelStats));
+    }
+
+    Swi_restore(key);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Wheel clock timeout handler function. Calls back every entry
+ *              that is due, so entries whose tolerance windows overlap
+ *              share this wakeup, then rearms for the next deadline.
+ *
+ * @param       a0 - ignored
+ */
+static void wheelTimeoutCallback(UArg a0)
+{
+    Timer_WheelEntry *pEntry;
+    Timer_WheelEntry *pPrev;
+    Clock_FuncPtr fxn;
+    UArg arg;
+    UInt key;
+
+    (void)a0; /* Parameter is not used */
+
+    key = Swi_disable();
+
+    wheelStats.wakeups++;
+    wheelExpiring = true;
+
+    do
+    {
+        uint32_t now = Clock_getTicks();
+
+        /* Any entry past its expiry may go now, not only those at deadline */
+        pPrev = NULL;
+        pEntry = pWheelHead;
+        while((pEntry != NULL) && TIMER_TICK_BEFORE(now, pEntry->expiry))
+        {
+            pPrev = pEntry;
+            pEntry = pEntry->pNext;
+        }
+
+        if(pEntry != NULL)
+        {
+            if(pPrev == NULL)
+            {
+                pWheelHead = pEntry->pNext;
+            }
+            else
+            {
+                pPrev->pNext = pEntry->pNext;
+            }
+            pEntry->pNext = NULL;
+            pEntry->active = false;
+            fxn = pEntry->fxn;
+            arg = pEntry->arg;
+
+            wheelStats.expirations++;
+
+            /* The callback may restart or stop entries */
+            Swi_restore(key);
+            fxn(arg);
+            key = Swi_disable();
+        }
+    } while(pEntry != NULL);
+
+    wheelExpiring = false;
+    wheelArm();
+
+    Swi_restore(key);
+}
+
+/*!
+ * @brief       Unlink an entry from the wheel, called with Swis disabled
+ *
+ * @param       pEntry - entry, ignored if not in the wheel
+ */
+static void wheelRemove(Timer_WheelEntry *pEntry)
+{
+    Timer_WheelEntry **ppLink = &pWheelHead;
+
+    while(*ppLink != NULL)
+    {
+        if(*ppLink == pEntry)
+        {
+            *ppLink = pEntry->pNext;
+            pEntry->pNext = NULL;
+            break;
+        }
+        ppLink = &(*ppLink)->pNext;
+    }
+}
+
+/*!
+ * @brief       Link an entry into the wheel by deadline, called with Swis
+ *              disabled
+ *
+ * @param       pEntry - entry
+ */
+static void wheelInsert(Timer_WheelEntry *pEntry)
+{
+    Timer_WheelEntry **ppLink = &pWheelHead;
+
+    while((*ppLink != NULL) &&
+          !TIMER_TICK_BEFORE(pEntry->deadline, (*ppLink)->deadline))
+    {
+        ppLink = &(*ppLink)->pNext;
+    }
+
+    pEntry->pNext = *ppLink;
+    *ppLink = pEntry;
+}
+
+/*!
+ * @brief       Set the wheel clock, called with Swis disabled. The wakeup
+ *              goes no later than the first deadline, and as late before it
+ *              as another entry's expiry, so every entry that can share the
+ *              wakeup does while a lone entry is not delayed.
+ */
+static void wheelArm(void)
+{
+    Timer_WheelEntry *pEntry;
+    uint32_t wakeup;
+    int32_t ticks;
+
+    if(wheelExpiring == true)
+    {
+        /* Armed once the expired entries are done */
+        return;
+    }
+
+    Clock_stop(wheelClkHandle);
+
+    if(pWheelHead != NULL)
+    {
+        wakeup = pWheelHead->expiry;
+        for(pEntry = pWheelHead->pNext; pEntry != NULL; pEntry = pEntry->pNext)
+        {
+            if(TIMER_TICK_BEFORE(wakeup, pEntry->expiry) &&
+               !TIMER_TICK_BEFORE(pWheelHead->deadline, pEntry->expiry))
+            {
+                wakeup = pEntry->expiry;
+            }
+        }
+
+        ticks = (int32_t)(wakeup - Clock_getTicks());
+        if(ticks < 1)
+        {
+            ticks = 1;
+        }
+
+        Clock_setTimeout(wheelClkHandle, (uint32_t)ticks);
+        Clock_start(wheelClkHandle);
+    }
+}
@@ -74,6 +74,54 @@ extern "C"
  * @{
  */
 
+/*!
+ Longest timer wheel timeout, with its tolerance, in milliseconds. Wheel
+ entries are kept in 10 us clock ticks and compared allowing for wrap,
+ which only holds within half the 32-bit tick range: about 5.96 hours.
+ */
+#define TIMER_WHEEL_MAX_TIMEOUT     21474836
+
+/******************************************************************************
+ Structures
+ *****************************************************************************/
+
+/*!
+ Timer wheel entry.
+
+ Wheel timers all share one TIRTOS clock. Each has a tolerance: its expiry
+ may be delayed by up to that long (capped at a quarter of the timeout) so
+ that timers due close together are handled in a single wakeup.
+ The fields are private to util_timer.c.
+ */
+typedef struct _Timer_WheelEntry
+{
+    /*! Next entry, in order of deadline */
+    struct _Timer_WheelEntry *pNext;
+    /*! Callback function upon expiration */
+    Clock_FuncPtr fxn;
+    /*! Argument passed to the callback function */
+    UArg arg;
+    /*! Timeout in milliseconds */
+    uint32_t timeout;
+    /*! Allowed delay in milliseconds */
+    uint32_t tolerance;
+    /*! Earliest tick the entry may expire at */
+    uint32_t expiry;
+    /*! Latest tick the entry may expire at */
+    uint32_t deadline;
+    /*! true while started */
+    bool active;
+} Timer_WheelEntry;
+
+/*! Timer wheel counts since reset */
+typedef struct _Timer_WheelStats
+{
+    /*! Number of times the wheel clock expired */
+    uint32_t wakeups;
+    /*! Number of entry expirations handled */
+    uint32_t expirations;
+} Timer_WheelStats;
+
 /******************************************************************************
  Function Prototypes
  *****************************************************************************/
@@ -147,6 +195,83 @@ extern uint32_t Timer_getTimeout(Clock_Handle handle);
  */
 extern void Timer_setFunc(Clock_Handle handle, Clock_FuncPtr fxn, UArg arg);
 
+/*!
+ * @brief   Initialize a timer wheel entry. The wheel clock is created
+ *          with the first entry.
+ *
+ * @param   pEntry    - pointer to the entry
+ * @param   fxn       - callback function upon expiration
+ * @param   timeout   - timeout in milliseconds, TIMER_WHEEL_MAX_TIMEOUT at
+ *                      most
+ * @param   tolerance - milliseconds the expiration may be delayed by to
+ *                      share a wakeup with another entry
+ * @param   arg       - argument passed to callback function
+ */
+extern void Timer_wheelConstruct(Timer_WheelEntry *pEntry, Clock_FuncPtr fxn,
+                                 uint32_t timeout, uint32_t tolerance,
+                                 UArg arg);
+
+/*!
+ * @brief   Start (or restart) a timer wheel entry with its timeout.
+ *          A timeout over TIMER_WHEEL_MAX_TIMEOUT is cut to it, and the
+ *          tolerance to what is left of it.
+ *
+ * @param   pEntry - pointer to the entry
+ */
+extern void Timer_wheelStart(Timer_WheelEntry *pEntry);
+
+/*!
+ * @brief   Determine if a timer wheel entry is currently active.
+ *
+ * @param   pEntry - pointer to the entry
+ *
+ * @return  TRUE or FALSE
+ */
+extern bool Timer_wheelIsActive(Timer_WheelEntry *pEntry);
+
+/*!
+ * @brief   Stop a timer wheel entry.
+ *
+ * @param   pEntry - pointer to the entry
+ */
+extern void Timer_wheelStop(Timer_WheelEntry *pEntry);
+
+/*!
+ * @brief   Set a timer wheel entry timeout, used from the next start.
+ *
+ * @param   pEntry  - pointer to the entry
+ * @param   timeout - Timeout value in milliseconds, TIMER_WHEEL_MAX_TIMEOUT
+ *                    at most
+ */
+extern void Timer_wheelSetTimeout(Timer_WheelEntry *pEntry, uint32_t timeout);
+
+/*!
+ * @brief   Get a timer wheel entry timeout.
+ *
+ * @param   pEntry - pointer to the entry
+ *
+ * @return  Time left in milliseconds if active, otherwise the timeout
+ */
+extern uint32_t Timer_wheelGetTimeout(Timer_WheelEntry *pEntry);
+
+/*!
+ * @brief   Set a timer wheel entry callback function and argument.
+ *
+ * @param   pEntry - pointer to the entry
+ * @param   fxn    - callback function
+ * @param   arg    - callback function argument
+ */
+extern void Timer_wheelSetFunc(Timer_WheelEntry *pEntry, Clock_FuncPtr fxn,
+                               UArg arg);
+
+/*!
+ * @brief   Get the timer wheel counts.
+ *
+ * @param   pStats - filled in with the counts
+ * @param   reset  - true to clear the counts afterwards
+ */
+extern void Timer_wheelGetStats(Timer_WheelStats *pStats, bool reset);
+
 /*! @} end group TimerClock */
 
 #ifdef __cplusplus
@@ -0,0 +1,2 @@
+#pragma once
+#define BIOS_WAIT_FOREVER 0xFFFFFFFF
@@ -0,0 +1,2 @@
+#pragma once
+#define HEAPMGR_CONFIG 0x80
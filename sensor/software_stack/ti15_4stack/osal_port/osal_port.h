@@ -101,6 +101,11 @@ extern "C"
 #define OsalPort_PWR_CONSERVE 0
 #define OsalPort_PWR_HOLD     1
 
+/* Message ring slots for the application task's queue, 0 for none */
+#ifndef OsalPort_APP_MSG_RING_SIZE
+#define OsalPort_APP_MSG_RING_SIZE  16
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -129,6 +134,20 @@ typedef struct
 
 typedef void * OsalPort_MsgQ;
 
+#ifdef OSAL_PORT_CS_STATS
+/** Time interrupts were held off by OSAL port critical sections, in
+ *  Timestamp ticks (see Timestamp_getFreq()). Nested sections count once.
+ *  Read with OsalPort_getCSStats(), e.g. from the application or a
+ *  debugger; the average is totalTicks / count. The total is 64 bits so
+ *  that it doesn't wrap over a long run. */
+typedef struct
+{
+  uint32_t count;
+  uint64_t totalTicks;
+  uint32_t maxTicks;
+} OsalPort_CSStats;
+#endif
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -230,6 +249,27 @@ extern uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg );
  */
 extern uint8_t *OsalPort_msgReceive( uint8_t taskId );
 
+/*********************************************************************
+ * @fn      OsalPort_msgRingEnable
+ *
+ * @brief
+ *
+ *    This function puts a ring of message slots in front of a task's
+ *    message queue. Sending to the task then costs a few instructions
+ *    with interrupts off instead of a list append, and the task takes
+ *    messages from the ring without any lock. The list still takes
+ *    messages when the ring is full. The task's messages can't be
+ *    searched with OsalPort_msgFind()/OsalPort_msgFindDequeue() while
+ *    they are in the ring, so enable it only for tasks that don't.
+ *
+ * @param   uint8_t taskId - receiving task ID, before it has messages
+ * @param   uint16_t size - number of slots, a power of two up to 32768
+ *
+ * @return  OsalPort_SUCCESS, OsalPort_INVALID_TASK,
+ *          OsalPort_INVALIDPARAMETER, OsalPort_MSG_BUFFER_NOT_AVAIL
+ */
+extern uint8_t OsalPort_msgRingEnable( uint8_t taskId, uint16_t size );
+
 /**************************************************************************************************
  * @fn          OsalPort_msgFind
  *
@@ -574,6 +614,28 @@ extern uint32_t OsalPort_enterCS(void);
  */
 void OsalPort_leaveCS(uint32_t key);
 
+#ifdef OSAL_PORT_CS_STATS
+/*********************************************************************
+ * @fn      OsalPort_getCSStats
+ *
+ * @brief
+ *
+ *   Gets the time interrupts were held off by OSAL port critical sections
+ *
+ * @param   pStats - filled in with the statistics
+ */
+extern void OsalPort_getCSStats(OsalPort_CSStats *pStats);
+
+/*********************************************************************
+ * @fn      OsalPort_resetCSStats
+ *
+ * @brief
+ *
+ *   Clears the critical section statistics
+ */
+extern void OsalPort_resetCSStats(void);
+#endif
+
 /*********************************************************************
  * @fn      OsalPort_buildUint16
  *
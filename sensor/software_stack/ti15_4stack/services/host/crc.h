@@ -0,0 +1,7 @@
+/* The pycrc generated header crc.c and nvocmp.c use */
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint_fast8_t crc_t;
+
+crc_t crc_update(crc_t crc, const void *data, size_t data_len);
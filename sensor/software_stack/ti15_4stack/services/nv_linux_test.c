@@ -0,0 +1,716 @@
+/******************************************************************************
+
+ @file  nv_linux_test.c
+
+ @brief Host fuzz, power-loss test and benchmark of the NV driver on the
+        flash model
+
+ Group: WCS, LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+
+ Copyright (c) 2017-2019, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+
+
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+
+ Runs the NV driver (nvocmp.c) on the host flash model (nv_linux.c).
+
+   nv_linux_test fuzz [<seed> [<steps> [<items>]]]
+   nv_linux_test powerloss [<seed> [<cuts>]]
+   nv_linux_test bench [<writes>]
+
+ fuzz creates, writes, deletes and reads random items and compacts in the
+ background, checking every read against a model of what was written, then
+ initializes the driver again on the same flash and checks every item.  More
+ items than fit the pages make a write fail with "Out of NV".
+
+ powerloss runs a random write, delete and compact load on a file backed
+ flash in a child process, and cuts the power in the middle of one flash
+ operation: half the cuts in a write, half in a compaction.  Another child
+ then initializes the driver on what was left, and checks that every item
+ holds what was last written to it, except the one being changed, which
+ may hold its old or its new value.
+
+ bench writes a collector like load: 50 device records of 24 bytes, each
+ rewritten 10% of the time, and 50 frame counters rewritten the rest of the
+ time.  It prints the time per write and per read, the write amplification
+ (bytes programmed over bytes written) and the erases of each page.
+
+ Built on a host only, from this folder, e.g.
+   gcc -DNV_LINUX -DNV_LINUX_TEST -DNVOCMP_POSIX_MUTEX [-DNVOCMP_RAM_INDEX]
+       [-DNVOCMP_NVPAGES=4] -I host -o nv_linux_test
+       nv_linux_test.c nv_linux.c nvocmp.c crc.c -lpthread
+ host/ stands in for the pycrc generated crc.h of the SDK.
+ *****************************************************************************/
+
+/* Host builds only; the project compiles this file for the device too */
+#if defined(NV_LINUX) && defined(NV_LINUX_TEST)
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "nvintf.h"
+#include "nvocmp.h"
+#include "nv_linux.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Most items in the fuzz test */
+#define FUZZ_MAX_ITEMS  400
+/* Items by default, fills about half of two pages */
+#define FUZZ_DEF_ITEMS  100
+/* Longest item in the fuzz test */
+#define FUZZ_MAX_LEN    40
+
+/* System ID of the test items */
+#define TEST_SYSID      5
+
+/* Steps and items of the power-loss load */
+#define LOSS_STEPS      2000
+#define LOSS_ITEMS      40
+/* Exit code of a power-loss child that found a problem */
+#define LOSS_FAIL_EXIT  2
+/* Seconds a power-loss child may take, recovery mustn't hang */
+#define LOSS_TIMEOUT    10
+
+/* Records and frame counters of the benchmark */
+#define BENCH_DEVICES   50
+/* Length of a benchmark device record */
+#define BENCH_REC_LEN   24
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+/* What each fuzz item should hold, length 0 if it doesn't exist */
+static uint8_t model[FUZZ_MAX_ITEMS][FUZZ_MAX_LEN];
+static uint16_t modelLen[FUZZ_MAX_ITEMS];
+
+/* Flash operations and erases done before each power-loss step, and after
+   the last */
+static uint32_t lossOps[LOSS_STEPS + 1];
+static uint32_t lossErases[LOSS_STEPS + 1];
+
+/******************************************************************************
+ Local functions
+ *****************************************************************************/
+
+/*!
+ * @brief   ID of fuzz item n
+ */
+static NVINTF_itemID_t fuzzId(int n)
+{
+    NVINTF_itemID_t id;
+
+    id.systemID = TEST_SYSID;
+    id.itemID = (uint16_t)(n % 7);
+    id.subID = (uint16_t)n;
+    return (id);
+}
+
+/*!
+ * @brief   Check every fuzz item against the model
+ *
+ * @return  0 if they all match
+ */
+static int fuzzCheckAll(NVINTF_nvFuncts_t *pNv, int numItems)
+{
+    uint8_t buf[FUZZ_MAX_LEN];
+    uint8_t status;
+    int n;
+
+    for(n = 0; n < numItems; n++)
+    {
+        status = pNv->readItem(fuzzId(n), 0,
+                               modelLen[n] ? modelLen[n] : 1, buf);
+        if(modelLen[n] &&
+           ((status != NVINTF_SUCCESS) ||
+            (memcmp(buf, model[n], modelLen[n]) != 0)))
+        {
+            printf("item %d doesn't match (%d)\n", n, status);
+            return (1);
+        }
+        if(!modelLen[n] && (status == NVINTF_SUCCESS))
+        {
+            printf("item %d was deleted but is found\n", n);
+            return (1);
+        }
+    }
+    return (0);
+}
+
+/*!
+ * @brief   Random item operations checked against the model
+ *
+ * @return  0 if the driver kept every item
+ */
+static int fuzz(unsigned int seed, int steps, int numItems)
+{
+    NVINTF_nvFuncts_t nv;
+    uint8_t buf[FUZZ_MAX_LEN];
+    uint8_t status;
+    uint16_t len;
+    int step;
+    int op;
+    int n;
+    int k;
+
+    srand(seed);
+    NVOCMP_loadApiPtrsExt(&nv);
+    if(nv.initNV(NULL) != NVINTF_SUCCESS)
+    {
+        printf("init failed\n");
+        return (1);
+    }
+
+    for(step = 0; step < steps; step++)
+    {
+        n = rand() % numItems;
+        op = rand() % 10;
+        if(op < 6)
+        {
+            /* An item keeps the length it was created with */
+            len = modelLen[n] ? modelLen[n] :
+                                (uint16_t)(1 + (rand() % FUZZ_MAX_LEN));
+            for(k = 0; k < len; k++)
+            {
+                buf[k] = (uint8_t)rand();
+            }
+            status = modelLen[n] ? nv.writeItem(fuzzId(n), len, buf) :
+                                   nv.createItem(fuzzId(n), len, buf);
+            if(status != NVINTF_SUCCESS)
+            {
+                printf("step %d: write of item %d failed (%d)\n", step, n,
+                       status);
+                return (1);
+            }
+            memcpy(model[n], buf, len);
+            modelLen[n] = len;
+        }
+        else if(op < 7)
+        {
+            status = nv.deleteItem(fuzzId(n));
+            if(modelLen[n] && (status != NVINTF_SUCCESS))
+            {
+                printf("step %d: delete of item %d failed (%d)\n", step, n,
+                       status);
+                return (1);
+            }
+            modelLen[n] = 0;
+        }
+        else if(op < 9)
+        {
+            status = nv.readItem(fuzzId(n), 0,
+                                 modelLen[n] ? modelLen[n] : 1, buf);
+            if((modelLen[n] && ((status != NVINTF_SUCCESS) ||
+                                (memcmp(buf, model[n], modelLen[n]) != 0))) ||
+               (!modelLen[n] && (status == NVINTF_SUCCESS)))
+            {
+                printf("step %d: item %d doesn't match (%d)\n", step, n,
+                       status);
+                return (1);
+            }
+        }
+        else
+        {
+            (void)NVOCMP_compactStep();
+        }
+    }
+
+    /* Everything has to be found again from the flash alone */
+    if(nv.initNV(NULL) != NVINTF_SUCCESS)
+    {
+        printf("init again failed\n");
+        return (1);
+    }
+    if(fuzzCheckAll(&nv, numItems) != 0)
+    {
+        return (1);
+    }
+
+    printf("fuzz: seed %u, %d steps, %d items ok\n", seed, steps, numItems);
+    return (0);
+}
+
+/*!
+ * @brief   Next step of the power-loss load, the same for every run with
+ *          the same seed
+ *
+ * @param   pN - filled in with the item
+ * @param   pBuf - filled in with the value to write
+ *
+ * @return  0 to write the item, 1 to delete it, 2 to compact
+ */
+static int lossStep(int *pN, uint8_t *pBuf)
+{
+    int op = rand() % 10;
+    int k;
+
+    *pN = rand() % LOSS_ITEMS;
+    for(k = 0; k < FUZZ_MAX_LEN; k++)
+    {
+        pBuf[k] = (uint8_t)rand();
+    }
+    return ((op < 8) ? 0 : ((op < 9) ? 1 : 2));
+}
+
+/*!
+ * @brief   Length of power-loss item n, it keeps the same length
+ */
+static uint16_t lossLen(int n)
+{
+    return ((uint16_t)(4 + (n % (FUZZ_MAX_LEN - 3))));
+}
+
+/*!
+ * @brief   Run the power-loss load in a child process on the flash file,
+ *          noting the flash operations before each step
+ *
+ * @param   pPath - the flash file
+ * @param   seed - seed of the load
+ * @param   cut - flash operation to cut the power in, counted from 0 at
+ *                the start of init, 0 for none
+ *
+ * @return  the step the power was cut in, LOSS_STEPS if not, -1 on failure
+ */
+static int lossRun(const char *pPath, unsigned int seed, uint32_t cut)
+{
+    int pipeFd[2];
+    uint32_t rec[2];
+    int steps = 0;
+    int status;
+    pid_t pid;
+
+    if(pipe(pipeFd) != 0)
+    {
+        return (-1);
+    }
+    pid = fork();
+    if(pid == 0)
+    {
+        NVINTF_nvFuncts_t nv;
+        NV_LINUX_stats_t stats;
+        uint8_t buf[FUZZ_MAX_LEN];
+        int step;
+        int n;
+
+        close(pipeFd[0]);
+        alarm(LOSS_TIMEOUT);
+        NV_LINUX_setFile(pPath);
+        NVOCMP_loadApiPtrsExt(&nv);
+        if(nv.initNV(NULL) != NVINTF_SUCCESS)
+        {
+            _exit(LOSS_FAIL_EXIT);
+        }
+        /* Operations count from the start of init, the cut from here */
+        NV_LINUX_getStats(&stats);
+        if(cut != 0)
+        {
+            NV_LINUX_setPowerLoss(cut - (stats.programs + stats.erases));
+        }
+        srand(seed);
+        for(step = 0; step <= LOSS_STEPS; step++)
+        {
+            NV_LINUX_getStats(&stats);
+            rec[0] = stats.programs + stats.erases;
+            rec[1] = stats.erases;
+            if(write(pipeFd[1], rec, sizeof(rec)) != sizeof(rec))
+            {
+                _exit(LOSS_FAIL_EXIT);
+            }
+            if(step == LOSS_STEPS)
+            {
+                break;
+            }
+            switch(lossStep(&n, buf))
+            {
+                case 0:
+                    if(nv.writeItem(fuzzId(n), lossLen(n), buf) !=
+                       NVINTF_SUCCESS)
+                    {
+                        _exit(LOSS_FAIL_EXIT);
+                    }
+                    break;
+                case 1:
+                    (void)nv.deleteItem(fuzzId(n));
+                    break;
+                default:
+                    (void)NVOCMP_compactStep();
+                    break;
+            }
+        }
+        _exit(0);
+    }
+
+    close(pipeFd[1]);
+    while((steps <= LOSS_STEPS) &&
+          (read(pipeFd[0], rec, sizeof(rec)) == sizeof(rec)))
+    {
+        lossOps[steps] = rec[0];
+        lossErases[steps] = rec[1];
+        steps++;
+    }
+    close(pipeFd[0]);
+    if((pid < 0) || (waitpid(pid, &status, 0) != pid) ||
+       !WIFEXITED(status))
+    {
+        return (-1);
+    }
+    if(WEXITSTATUS(status) == NV_LINUX_POWERLOSS_EXIT)
+    {
+        return (steps - 1);
+    }
+    return ((WEXITSTATUS(status) == 0) ? LOSS_STEPS : -1);
+}
+
+/*!
+ * @brief   Initialize the driver in a child process on what a power-loss
+ *          run left, and check the items against the load up to the step
+ *          the power was cut in
+ *
+ * @return  0 if every item holds what it should
+ */
+static int lossCheck(const char *pPath, unsigned int seed, int lostStep)
+{
+    uint8_t lost[FUZZ_MAX_LEN];
+    uint8_t buf[FUZZ_MAX_LEN];
+    int lostOp = 0;
+    int lostN = -1;
+    int status;
+    int step;
+    int n;
+    pid_t pid;
+
+    /* What the items should hold, and the change the power was cut in */
+    memset(modelLen, 0, sizeof(modelLen));
+    srand(seed);
+    for(step = 0; step <= lostStep; step++)
+    {
+        int op = lossStep(&n, buf);
+
+        if(step == lostStep)
+        {
+            lostOp = op;
+            lostN = (op < 2) ? n : -1;
+            memcpy(lost, buf, sizeof(lost));
+        }
+        else if(op == 0)
+        {
+            memcpy(model[n], buf, lossLen(n));
+            modelLen[n] = lossLen(n);
+        }
+        else if(op == 1)
+        {
+            modelLen[n] = 0;
+        }
+    }
+
+    pid = fork();
+    if(pid == 0)
+    {
+        NVINTF_nvFuncts_t nv;
+        uint8_t rc;
+
+        alarm(LOSS_TIMEOUT);
+        NV_LINUX_setFile(pPath);
+        NVOCMP_loadApiPtrsExt(&nv);
+        if(nv.initNV(NULL) != NVINTF_SUCCESS)
+        {
+            printf("step %d: init after power loss failed\n", lostStep);
+            fflush(stdout);
+            _exit(1);
+        }
+        if(lostN >= 0)
+        {
+            /* Either the old or the new value, or gone if deleted */
+            n = lostN;
+            rc = nv.readItem(fuzzId(n), 0, lossLen(n), buf);
+            if((rc == NVINTF_SUCCESS) && (lostOp == 0) &&
+               (memcmp(buf, lost, lossLen(n)) == 0))
+            {
+                modelLen[n] = lossLen(n);
+                memcpy(model[n], lost, lossLen(n));
+            }
+            else if((rc != NVINTF_SUCCESS) && (lostOp == 1))
+            {
+                modelLen[n] = 0;
+            }
+        }
+        if(fuzzCheckAll(&nv, LOSS_ITEMS) != 0)
+        {
+            printf("step %d: items wrong after power loss\n", lostStep);
+            fflush(stdout);
+            _exit(1);
+        }
+        _exit(0);
+    }
+
+    if((pid < 0) || (waitpid(pid, &status, 0) != pid) ||
+       !WIFEXITED(status))
+    {
+        printf("step %d: init after power loss didn't finish\n", lostStep);
+        return (1);
+    }
+    return (WEXITSTATUS(status));
+}
+
+/*!
+ * @brief   Cut the power in writes and compactions, checking what the
+ *          driver finds after each
+ *
+ * @return  0 if every item was recovered
+ */
+static int powerLoss(unsigned int seed, int cuts)
+{
+    char path[] = "/tmp/nv_linux_testXXXXXX";
+    int compactSteps[LOSS_STEPS];
+    int writeSteps[LOSS_STEPS];
+    int numCompact = 0;
+    int numWrite = 0;
+    int result = 1;
+    unsigned int pick = seed;
+    int step;
+    int cut;
+    int fd;
+
+    fd = mkstemp(path);
+    if(fd < 0)
+    {
+        perror(path);
+        return (1);
+    }
+    close(fd);
+
+    /* Find the flash operations of each step without a cut.  Step 0 is
+       left out, as its first operation is the one NV_LINUX_setPowerLoss()
+       can't be armed for. */
+    unlink(path);
+    if(lossRun(path, seed, 0) != LOSS_STEPS)
+    {
+        printf("load failed without power loss\n");
+        goto done;
+    }
+    for(step = 1; step < LOSS_STEPS; step++)
+    {
+        if(lossOps[step + 1] == lossOps[step])
+        {
+            continue;
+        }
+        if(lossErases[step + 1] != lossErases[step])
+        {
+            compactSteps[numCompact++] = step;
+        }
+        else
+        {
+            writeSteps[numWrite++] = step;
+        }
+    }
+    if((numCompact == 0) || (numWrite == 0))
+    {
+        printf("load didn't compact\n");
+        goto done;
+    }
+
+    for(cut = 0; cut < cuts; cut++)
+    {
+        uint32_t op;
+        int lostStep;
+
+        step = (cut & 1) ? compactSteps[rand_r(&pick) % numCompact] :
+                           writeSteps[rand_r(&pick) % numWrite];
+        op = lossOps[step] +
+             ((uint32_t)rand_r(&pick) % (lossOps[step + 1] - lossOps[step]));
+
+        unlink(path);
+        lostStep = lossRun(path, seed, op);
+        if(lostStep != step)
+        {
+            printf("cut %d at operation %lu: stopped in step %d, not %d\n",
+                   cut, (unsigned long)op, lostStep, step);
+            goto done;
+        }
+        if(lossCheck(path, seed, lostStep) != 0)
+        {
+            goto done;
+        }
+    }
+
+    printf("powerloss: seed %u, %d cuts in writes, %d in compactions ok\n",
+           seed, (cuts + 1) / 2, cuts / 2);
+    result = 0;
+
+done:
+    unlink(path);
+    return (result);
+}
+
+/*!
+ * @brief   Collector like load, timed and counted
+ *
+ * @return  0 if every write succeeded
+ */
+static int bench(int writes)
+{
+    NVINTF_nvFuncts_t nv;
+    NVINTF_itemID_t id;
+    NV_LINUX_stats_t stats;
+    uint8_t rec[BENCH_REC_LEN];
+    uint32_t frameCounter;
+    unsigned long userBytes = 0;
+    clock_t start;
+    double writeNs;
+    double readNs;
+    int n;
+    int i;
+
+    NVOCMP_loadApiPtrs(&nv);
+    if(nv.initNV(NULL) != NVINTF_SUCCESS)
+    {
+        printf("init failed\n");
+        return (1);
+    }
+
+    id.systemID = TEST_SYSID;
+    for(n = 0; n < BENCH_DEVICES; n++)
+    {
+        id.itemID = 4;
+        id.subID = (uint16_t)n;
+        memset(rec, n, sizeof(rec));
+        nv.writeItem(id, sizeof(rec), rec);
+    }
+
+    srand(1);
+    NV_LINUX_resetStats();
+    start = clock();
+    for(i = 0; i < writes; i++)
+    {
+        uint8_t status;
+
+        n = rand() % BENCH_DEVICES;
+        id.subID = (uint16_t)n;
+        if((rand() % 10) == 0)
+        {
+            id.itemID = 4;
+            memset(rec, i, sizeof(rec));
+            status = nv.writeItem(id, sizeof(rec), rec);
+            userBytes += sizeof(rec);
+        }
+        else
+        {
+            id.itemID = 5;
+            frameCounter = (uint32_t)i;
+            status = nv.writeItem(id, sizeof(frameCounter), &frameCounter);
+            userBytes += sizeof(frameCounter);
+        }
+        if(status != NVINTF_SUCCESS)
+        {
+            printf("write %d failed (%d)\n", i, status);
+            return (1);
+        }
+    }
+    writeNs = ((double)(clock() - start) * 1e9) /
+              ((double)CLOCKS_PER_SEC * writes);
+    NV_LINUX_getStats(&stats);
+
+    start = clock();
+    for(i = 0; i < writes; i++)
+    {
+        id.itemID = 4;
+        id.subID = (uint16_t)(i % BENCH_DEVICES);
+        nv.readItem(id, 0, sizeof(rec), rec);
+    }
+    readNs = ((double)(clock() - start) * 1e9) /
+             ((double)CLOCKS_PER_SEC * writes);
+
+    printf("bench: %d pages, %d writes: %.0f ns per write, %.0f ns per "
+           "read\n", NVOCMP_NVPAGES, writes, writeNs, readNs);
+    printf("  %lu bytes written, %lu programmed, write amplification "
+           "%.2f\n", userBytes, (unsigned long)stats.programBytes,
+           (double)stats.programBytes / userBytes);
+    printf("  %lu erases:", (unsigned long)stats.erases);
+    for(n = 0; n < NVOCMP_NVPAGES; n++)
+    {
+        printf(" %lu", (unsigned long)stats.pageErases[n]);
+    }
+    printf("\n");
+    return (0);
+}
+
+/******************************************************************************
+ Public functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    if((argc > 1) && (strcmp(argv[1], "fuzz") == 0))
+    {
+        int numItems = (argc > 4) ? atoi(argv[4]) : FUZZ_DEF_ITEMS;
+
+        if((numItems < 1) || (numItems > FUZZ_MAX_ITEMS))
+        {
+            numItems = FUZZ_MAX_ITEMS;
+        }
+        return (fuzz((argc > 2) ? (unsigned int)atoi(argv[2]) : 1,
+                     (argc > 3) ? atoi(argv[3]) : 20000, numItems));
+    }
+    if((argc > 1) && (strcmp(argv[1], "powerloss") == 0))
+    {
+        return (powerLoss((argc > 2) ? (unsigned int)atoi(argv[2]) : 1,
+                          (argc > 3) ? atoi(argv[3]) : 200));
+    }
+    if((argc > 1) && (strcmp(argv[1], "bench") == 0))
+    {
+        return (bench((argc > 2) ? atoi(argv[2]) : 20000));
+    }
+
+    printf("nv_linux_test fuzz [<seed> [<steps> [<items>]]]\n"
+           "nv_linux_test powerloss [<seed> [<cuts>]]\n"
+           "nv_linux_test bench [<writes>]\n");
+    return (1);
+}
+
+#endif /* NV_LINUX && NV_LINUX_TEST */
@@ -87,6 +87,13 @@ nvFps.initNV(NULL);
 nvFps.compactNV(NULL);
 status = nvFps.readItem(id, 0, len, buf);
 
+Compaction normally happens 'just in time', inside the write that runs out of
+space, and that write waits for the page copy and erase. To keep that out of
+the foreground, the application can call NVOCMP_compactStep() when it is idle.
+Each call compacts at most one page, and only once free space is below
+NVOCMP_COMPACT_WATERMARK, so the writes find room already made. A call holds
+the driver lock for the whole page, about 20 ms with two 8 KB pages.
+
 Note: Each item operation results in a traversal of the page starting at
 the most recently written item. This makes 'finding' items by 'trying' item IDs
 in order extremely inefficient. The doNext() API call allows the user to find,
@@ -106,6 +113,14 @@ NVOCMP_CRCONREAD (on:1 off:0) - item crc is checked on read. Disabling this may
 increase driver speed but safety is reduced.
 NVOCMP_NVS_INDEX - The index of the NVS_Config structure which describes the
 flash sector that NVOCMP should use. Default is 0.
+NVOCMP_RAM_INDEX - Keeps a sorted RAM index of where the newest copy of each
+item is, so item reads and writes don't have to search the pages for it. The
+index is built at init and after each compaction. Leave it out of RAM
+constrained images.
+NVOCMP_RAM_INDEX_SIZE - Number of items the RAM index can hold, 8 bytes each.
+Items beyond that are still found by searching the pages. Default is 64.
+NVOCMP_COMPACT_WATERMARK - Free bytes below which NVOCMP_compactStep() compacts
+one page. Default is a quarter page.
 
 Dependencies:
 Requires NVS for NV access.
@@ -199,6 +214,11 @@ static const NVINTF_itemID_t diagId = NVOCMP_NVID_DIAG;
 enum {NVOCMP_FINDANY = 0, NVOCMP_FINDSYSID, NVOCMP_FINDITMID,
     NVOCMP_FINDSTRICT};
 
+#if defined(NVOCMP_RAM_INDEX) && !defined(NVOCMP_RAM_INDEX_SIZE)
+// Number of items the RAM index can locate
+#define NVOCMP_RAM_INDEX_SIZE   64
+#endif
+
 //*****************************************************************************
 // Macros
 //*****************************************************************************
@@ -268,6 +288,11 @@ static void NVOCMP_assert(bool cond, char *message, bool fatal)
 #define FLASH_PAGE_SIZE  (1 << PAGE_SIZE_LSHIFT)
 #endif // FLASH_PAGE_SIZE
 
+#if !defined (NVOCMP_COMPACT_WATERMARK)
+// Free bytes below which NVOCMP_compactStep() compacts a page
+#define NVOCMP_COMPACT_WATERMARK  (FLASH_PAGE_SIZE / 4)
+#endif // NVOCMP_COMPACT_WATERMARK
+
 #if !defined (NVOCMP_VERSION)
 // Version of NV page format (do not use 0xFF)
 #define NVOCMP_VERSION  0x03
@@ -430,6 +455,16 @@ typedef struct
 // Compressed item header byte array
 typedef uint8_t cmpIH_t[NVOCMP_ITEMHDRLEN];
 
+#ifdef NVOCMP_RAM_INDEX
+// RAM index entry, locates the newest copy of an item
+typedef struct
+{
+    uint32_t cmpid; // Compressed ID
+    uint16_t hofs;  // Header offset
+    uint8_t  hpage; // Header page
+} NVOCMP_indexEntry_t;
+#endif
+
 // Item write parameters
 typedef struct
 {
@@ -536,6 +571,14 @@ static bool (*NVOCMP_voltCheckFptr)(void);
 static uint16_t NVOCMP_badCRCCount = 0;
 #endif // NVOCMP_STATS
 
+#ifdef NVOCMP_RAM_INDEX
+// Item locations, sorted by cmpid
+static NVOCMP_indexEntry_t NVOCMP_index[NVOCMP_RAM_INDEX_SIZE];
+static uint16_t NVOCMP_indexCount = 0;
+// TRUE when every active item is in the index, so a miss means not found
+static bool NVOCMP_indexComplete = FALSE;
+#endif // NVOCMP_RAM_INDEX
+
 NVOCMP_initAction_t gAction;
 uint8_t NVOCMP_size;
 
@@ -591,11 +634,20 @@ static void       NVOCMP_setCompactHdr(uint8_t dstPg, uint8_t pg, int16_t offset
 static void       NVOCMP_getCompactHdr(uint8_t dstPg, uint16_t location,
                                        NVOCMP_compactHdr_t *pHdr);
 static uint16_t   NVOCMP_findOffset(uint8_t pg, uint16_t ofs);
+static uint16_t   NVOCMP_findLastItem(uint8_t pg, uint16_t ofs);
 static uint8_t    NVOCMP_doNVCRC(uint8_t pg, uint16_t ofs, uint16_t len, uint8_t crc);
 static uint8_t    NVOCMP_doRAMCRC(uint8_t *input, uint16_t len, uint8_t crc);
 static uint8_t    NVOCMP_verifyCRC(uint16_t iOfs, uint16_t len, uint8_t crc, uint8_t pg);
 static uint8_t    NVOCMP_readByte(uint8_t pg, uint16_t ofs);
 static void       NVOCMP_writeByte(uint8_t pg, uint16_t ofs, uint8_t bwv);
+static uint16_t   NVOCMP_freeSpace(NVOCMP_nvHandle_t *pNvHandle);
+
+#ifdef NVOCMP_RAM_INDEX
+static void       NVOCMP_buildIndex(NVOCMP_nvHandle_t *pNvHandle);
+static uint16_t   NVOCMP_searchIndex(uint32_t cmpid);
+static void       NVOCMP_updateIndex(uint32_t cmpid, uint8_t pg, uint16_t hOfs);
+static void       NVOCMP_removeIndex(uint8_t pg, uint16_t hOfs);
+#endif
 
 #if (NVOCMP_NVPAGES != NVOCMP_NVONEP)
 static uint8_t    NVOCMP_cleanPage(NVOCMP_nvHandle_t *pNvHandle);
@@ -712,6 +764,77 @@ extern void NVOCMP_setCheckVoltage(void *funcPtr)
 #endif
 }
 
+/**
+ * @fn      NVOCMP_compactStep
+ *
+ * @brief   Global function to compact NV ahead of time, meant to be called
+ *          when the application is idle. If free space is below
+ *          NVOCMP_COMPACT_WATERMARK, one page is compacted, so the time
+ *          taken is bounded by one page copy and erase: about 20 ms with
+ *          2 pages of 8 KB, 10 ms with 4, at 8 ms per erase and 8 us per
+ *          word programmed. A step is a page rather than some number of
+ *          items because the copy can't be left half done while the
+ *          driver is unlocked, and the erase can't be split anyway.
+ *
+ * @return  NVINTF_SUCCESS if a page was compacted, NVINTF_BADPARAM if no
+ *          compaction was needed, or specific failure code
+ */
+uint8_t NVOCMP_compactStep(void)
+{
+    uint8_t err;
+    uint8_t pg;
+    bool reclaim = FALSE;
+
+    // Nothing to lock until the driver is initialized
+    if(NVOCMP_failF == NVINTF_NOTREADY)
+    {
+        return(NVINTF_NOTREADY);
+    }
+
+    // Prevent RTOS thread contention
+    NVOCMP_LOCK();
+    err = NVOCMP_failF;
+    if(err == NVINTF_SUCCESS)
+    {
+        // Only worth it if some page has inactive items to drop
+        for(pg = 0; pg < NVOCMP_NVSIZE; pg++)
+        {
+#if (NVOCMP_NVPAGES != NVOCMP_NVONEP)
+            if(pg == NVOCMP_nvHandle.tailPage)
+            {
+                continue;
+            }
+#endif
+            if(!NVOCMP_nvHandle.pageInfo[pg].allActive)
+            {
+                reclaim = TRUE;
+            }
+        }
+
+        if(reclaim &&
+           (NVOCMP_freeSpace(&NVOCMP_nvHandle) < NVOCMP_COMPACT_WATERMARK))
+        {
+            // Compact until there is room for a small item, one page
+            (void)NVOCMP_compactPage(&NVOCMP_nvHandle, NVOCMP_SMALLITEM);
+            // 'failW' indicates compaction status
+            err = NVOCMP_failW;
+        }
+        else
+        {
+            err = NVINTF_BADPARAM;
+        }
+    }
+
+#ifdef NV_LINUX
+    if(err == NVINTF_SUCCESS)
+    {
+        NV_LINUX_save();
+    }
+#endif
+
+    NVOCMP_UNLOCK(err);
+}
+
 /******************************************************************************
  * @fn      NVOCMP_initNvApi
  *
@@ -1505,7 +1628,13 @@ static uint8_t NVOCMP_scanPage(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg,
   }
   else
   {
+    // Items are only written to the active page, and compaction may have
+    // started from it, skip what a write cut short left on them
     pPageInfo->offset = NVOCMP_findOffset(pg, FLASH_PAGE_SIZE);
+    if((pHdr->state == NVOCMP_PGACT) || (pHdr->state == NVOCMP_PGXSRC))
+    {
+      pPageInfo->offset = NVOCMP_findLastItem(pg, pPageInfo->offset);
+    }
   }
   pPageInfo->sPage = startHdr.page;
   pPageInfo->sOffset = startHdr.pageOffset;
@@ -1753,12 +1882,30 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
 
       if(pg < NVOCMP_NVSIZE)
       {
-        uint8_t tmpPg;
         pNvHandle->compactInfo.xDstPage = pg;
         pNvHandle->compactInfo.xSrcSPage = pNvHandle->pageInfo[pg].sPage;
         pNvHandle->compactInfo.xSrcEPage = pNvHandle->pageInfo[pg].ePage;
         cleanPages = NVOCMP_cleanPage(pNvHandle);
         pNvHandle->tailPage = NVOCMP_ADDPAGE(pg, cleanPages);
+      }
+      else
+      {
+        // Compaction finished but the power went before the new tail page
+        // was marked: it is the last erased page before the head
+        for(pg = 0; pg < NVOCMP_NVSIZE; pg++)
+        {
+          if((pNvHandle->pageInfo[pg].state == NVOCMP_PGNACT) &&
+             (pNvHandle->pageInfo[NVOCMP_INCPAGE(pg)].state != NVOCMP_PGNACT))
+          {
+            break;
+          }
+        }
+        pNvHandle->tailPage = pg;
+      }
+
+      if(pNvHandle->tailPage < NVOCMP_NVSIZE)
+      {
+        uint8_t tmpPg;
         pNvHandle->headPage = NVOCMP_INCPAGE(pNvHandle->tailPage);
 
         tmpPg = NVOCMP_findPage(NVOCMP_PGACT);
@@ -1789,8 +1936,18 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
       }
       else
       {
-        //shoud not hit here
-        while(1);
+        // No compaction to finish and no erased page
+        NVOCMP_ASSERT(FALSE, "Something wrong serious");
+        for(pg = 0; pg < NVOCMP_NVSIZE; pg++)
+        {
+          NVOCMP_failW = NVOCMP_erase(pNvHandle, pg);
+        }
+        pNvHandle->headPage = 0;
+        pNvHandle->tailPage = NVOCMP_NVSIZE - 1;
+        pNvHandle->actPage = 0;
+        pNvHandle->actOffset = pNvHandle->pageInfo[pNvHandle->actPage].offset;
+        NVOCMP_changePageState(pNvHandle, pNvHandle->headPage, NVOCMP_PGRDY);
+        NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
       }
       break;
 #if !defined(NVOCMP_MIGRATE_DISABLED)
@@ -1862,6 +2019,28 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
       break;
   }
 #endif
+
+  // Part of an item left past the last whole one on the active page by a
+  // write cut short can't be written over, compact to get rid of it
+  pg = pNvHandle->actPage;
+  if((pg != NVOCMP_NULLPAGE) &&
+     (NVOCMP_findOffset(pg, FLASH_PAGE_SIZE) > pNvHandle->pageInfo[pg].offset))
+  {
+    uint8_t tmp;
+
+    NVOCMP_ALERT(FALSE, "Partial item found, compacting.")
+    // The page counts as all active until an item is made inactive, and
+    // compaction skips such pages
+    tmp = NVOCMP_readByte(pg, NVOCMP_PGHDRVER);
+    tmp &= ~NVOCMP_ALLACTIVE;
+    NVOCMP_writeByte(pg, NVOCMP_PGHDRVER, tmp);
+    pNvHandle->pageInfo[pg].allActive = NVOCMP_SOMEINACTIVE;
+    NVOCMP_compactPage(pNvHandle, 0);
+  }
+
+#ifdef NVOCMP_RAM_INDEX
+  NVOCMP_buildIndex(pNvHandle);
+#endif
 }
 
 /******************************************************************************
@@ -2291,6 +2470,12 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
         {
             NVOCMP_setItemInactive(pNvHandle, dstPg, hOfs);
         }
+#ifdef NVOCMP_RAM_INDEX
+        else
+        {
+            NVOCMP_updateIndex(pHdr->cmpid, dstPg, hOfs);
+        }
+#endif
     }
     else
     {
@@ -2442,6 +2627,9 @@ static void NVOCMP_setItemInactive(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg,
 #endif
     // Mark the item as inactive
     NVOCMP_writeByte(pg, iOfs + NVOCMP_HDRVLDOFS, tmp);
+#ifdef NVOCMP_RAM_INDEX
+    NVOCMP_removeIndex(pg, iOfs);
+#endif
 
     if(pNvHandle->pageInfo[pg].allActive)
     {
@@ -2598,6 +2786,75 @@ static uint16_t NVOCMP_findOffset(uint8_t pg, uint16_t ofs)
     return(ofs + j);
 }
 
+/******************************************************************************
+ * @fn      NVOCMP_findLastItem
+ *
+ * @brief   Find the end of the last whole item on a page. A write cut short
+ *          by a power loss leaves the start of an item without its header,
+ *          which is written last, so look down for a header whose item
+ *          passes its CRC.
+ *
+ * @param   pg  - Valid NV page to search
+ * @param   ofs - Offset past the last programmed byte, from findOffset()
+ *
+ * @return  Offset past the last whole item, NVOCMP_PGDATAOFS if none
+ */
+static uint16_t NVOCMP_findLastItem(uint8_t pg, uint16_t ofs)
+{
+    NVOCMP_itemHdr_t iHdr;
+    uint16_t hOfs;
+
+    for(; ofs >= (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN); ofs--)
+    {
+        hOfs = ofs - NVOCMP_ITEMHDRLEN;
+        if(NVOCMP_readByte(pg, ofs - 1) != NVOCMP_SIGNATURE)
+        {
+            continue;
+        }
+
+        NVOCMP_readHeader(pg, hOfs, &iHdr);
+        if((hOfs >= (NVOCMP_PGDATAOFS + iHdr.len)) &&
+           (NVOCMP_verifyCRC(hOfs - iHdr.len, iHdr.len, iHdr.crc8, pg) ==
+            NVINTF_SUCCESS))
+        {
+            return(ofs);
+        }
+    }
+
+    return(NVOCMP_PGDATAOFS);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_freeSpace
+ *
+ * @brief   Find the space left for new items on pages that aren't full
+ *
+ * @param   pNvHandle - pointer to NV handle
+ *
+ * @return  Number of free bytes
+ */
+static uint16_t NVOCMP_freeSpace(NVOCMP_nvHandle_t *pNvHandle)
+{
+    uint8_t pg;
+    uint32_t free = 0;
+
+    for(pg = 0; pg < NVOCMP_NVSIZE; pg++)
+    {
+#if (NVOCMP_NVPAGES != NVOCMP_NVONEP)
+        if(pg == pNvHandle->tailPage)
+        {
+            continue;
+        }
+#endif
+        if(pNvHandle->pageInfo[pg].state != NVOCMP_PGFULL)
+        {
+            free += FLASH_PAGE_SIZE - pNvHandle->pageInfo[pg].offset;
+        }
+    }
+
+    return((free > 0xFFFF) ? 0xFFFF : (uint16_t)free);
+}
+
 /******************************************************************************
  * @fn      NVOCMP_findItem
  *
@@ -2622,6 +2879,36 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
     uint16_t nvSearched = 0;
     uint32_t cid = NVOCMP_CMPRID(pHdr->sysid,pHdr->itemid,pHdr->subid);
 
+#ifdef NVOCMP_RAM_INDEX
+    // Strict searches start at the newest item, the index can answer them
+    if(flag == NVOCMP_FINDSTRICT)
+    {
+        uint16_t i = NVOCMP_searchIndex(cid);
+
+        if((i < NVOCMP_indexCount) && (NVOCMP_index[i].cmpid == cid))
+        {
+            NVOCMP_itemHdr_t iHdr;
+
+            NVOCMP_readHeader(NVOCMP_index[i].hpage, NVOCMP_index[i].hofs, &iHdr);
+            if((iHdr.cmpid == cid) && (iHdr.stats & NVOCMP_ACTIVEIDBIT) &&
+               !(iHdr.stats & NVOCMP_VALIDIDBIT))
+            {
+                memcpy(pHdr, &iHdr, sizeof(NVOCMP_itemHdr_t));
+                return(NVINTF_SUCCESS);
+            }
+
+            // Index doesn't match flash, rebuild it and search the pages
+            NVOCMP_ALERT(FALSE, "RAM index out of date, rebuilding.")
+            NVOCMP_buildIndex(pNvHandle);
+        }
+        else if(NVOCMP_indexComplete)
+        {
+            pHdr->hofs = 0;
+            return(NVINTF_NOTFOUND);
+        }
+    }
+#endif
+
     for(p = pg; nvSearched < NVOCMP_NVSIZE; p = NVOCMP_DECPAGE(p), ofs = pNvHandle->pageInfo[p].offset)
     {
       nvSearched++;
@@ -2906,6 +3193,9 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
 
     if(status == NVOCMP_COMPACT_FAILURE)
     {
+#ifdef NVOCMP_RAM_INDEX
+      NVOCMP_buildIndex(pNvHandle);
+#endif
       return(0);
     }
 
@@ -2980,6 +3270,10 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
   pNvHandle->actPage = pg;
   pNvHandle->actOffset = pNvHandle->pageInfo[pNvHandle->actPage].offset;
   NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
+#ifdef NVOCMP_RAM_INDEX
+  // Items have moved
+  NVOCMP_buildIndex(pNvHandle);
+#endif
   return(FLASH_PAGE_SIZE - pNvHandle->compactInfo.xDstOffset);
 }
 #else
@@ -3059,6 +3353,9 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
 
   if(status == NVOCMP_COMPACT_FAILURE)
   {
+#ifdef NVOCMP_RAM_INDEX
+    NVOCMP_buildIndex(pNvHandle);
+#endif
     return(0);
   }
 
@@ -3085,6 +3382,10 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
 
   pNvHandle->actPage = 0;
   pNvHandle->actOffset = pNvHandle->pageInfo[pNvHandle->actPage].offset;
+#ifdef NVOCMP_RAM_INDEX
+  // Items have moved
+  NVOCMP_buildIndex(pNvHandle);
+#endif
   return(FLASH_PAGE_SIZE - pNvHandle->compactInfo.xDstOffset);
 }
 #endif
@@ -3804,4 +4105,163 @@ static uint8_t NVOCMP_verifyCRC(uint16_t iOfs, uint16_t len, uint8_t crc, uint8_
     return(newCRC == crc ? NVINTF_SUCCESS : NVINTF_CORRUPT);
 }
 
+#ifdef NVOCMP_RAM_INDEX
+/******************************************************************************
+ * @fn      NVOCMP_buildIndex
+ *
+ * @brief   Rebuild the RAM index by walking all items from the newest back,
+ *          the same way findItem() does, so the first copy of an item seen
+ *          is the one findItem() would return.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ *
+ * @return  none
+ */
+static void NVOCMP_buildIndex(NVOCMP_nvHandle_t *pNvHandle)
+{
+    uint8_t p;
+    uint16_t i;
+    uint16_t ofs;
+    uint16_t nvSearched = 0;
+    NVOCMP_itemHdr_t iHdr;
+
+    NVOCMP_indexCount = 0;
+    NVOCMP_indexComplete = TRUE;
+
+    for(p = pNvHandle->actPage, ofs = pNvHandle->actOffset; nvSearched < NVOCMP_NVSIZE;
+        p = NVOCMP_DECPAGE(p), ofs = pNvHandle->pageInfo[p].offset)
+    {
+      nvSearched++;
+#if (NVOCMP_NVPAGES != NVOCMP_NVONEP)
+      if(p == pNvHandle->tailPage)
+      {
+        continue;
+      }
+#endif
+      while(ofs >= (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN))
+      {
+          // Align to start of item header
+          ofs -= NVOCMP_ITEMHDRLEN;
+
+          // Read and decompress item header
+          NVOCMP_readHeader(p, ofs, &iHdr);
+
+          if(!(iHdr.stats & NVOCMP_FOLLOWBIT) || (iHdr.len >= ofs))
+          {
+              // Corrupted, leave it to findItem() to search and recover
+              NVOCMP_ALERT(FALSE, "RAM index stopped at corrupted item.")
+              NVOCMP_indexComplete = FALSE;
+              return;
+          }
+
+          if((iHdr.stats & NVOCMP_ACTIVEIDBIT) &&
+            !(iHdr.stats & NVOCMP_VALIDIDBIT))
+          {
+              i = NVOCMP_searchIndex(iHdr.cmpid);
+              if((i >= NVOCMP_indexCount) || (NVOCMP_index[i].cmpid != iHdr.cmpid))
+              {
+                  NVOCMP_updateIndex(iHdr.cmpid, p, ofs);
+              }
+          }
+
+          // Jump to next item
+          ofs -= iHdr.len;
+      }
+    }
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_searchIndex
+ *
+ * @brief   Binary search of the RAM index
+ *
+ * @param   cmpid - compressed ID to look for
+ *
+ * @return  Position of cmpid in the index, or where it would be inserted
+ */
+static uint16_t NVOCMP_searchIndex(uint32_t cmpid)
+{
+    uint16_t lo = 0;
+    uint16_t hi = NVOCMP_indexCount;
+
+    while(lo < hi)
+    {
+        uint16_t mid = (lo + hi) >> 1;
+
+        if(NVOCMP_index[mid].cmpid < cmpid)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return(lo);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_updateIndex
+ *
+ * @brief   Set the location of an item in the RAM index, adding the item if
+ *          needed. If the index is full the item is left to be searched for.
+ *
+ * @param   cmpid - compressed ID of the item
+ * @param   pg - page of the item header
+ * @param   hOfs - offset of the item header
+ *
+ * @return  none
+ */
+static void NVOCMP_updateIndex(uint32_t cmpid, uint8_t pg, uint16_t hOfs)
+{
+    uint16_t i = NVOCMP_searchIndex(cmpid);
+
+    if((i >= NVOCMP_indexCount) || (NVOCMP_index[i].cmpid != cmpid))
+    {
+        if(NVOCMP_indexCount >= NVOCMP_RAM_INDEX_SIZE)
+        {
+            NVOCMP_indexComplete = FALSE;
+            return;
+        }
+
+        // Make room for the new entry
+        memmove(&NVOCMP_index[i + 1], &NVOCMP_index[i],
+                (NVOCMP_indexCount - i) * sizeof(NVOCMP_indexEntry_t));
+        NVOCMP_indexCount++;
+        NVOCMP_index[i].cmpid = cmpid;
+    }
+
+    NVOCMP_index[i].hpage = pg;
+    NVOCMP_index[i].hofs = hOfs;
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_removeIndex
+ *
+ * @brief   Remove the RAM index entry pointing at an item being made inactive,
+ *          if there is one
+ *
+ * @param   pg - page of the item header
+ * @param   hOfs - offset of the item header
+ *
+ * @return  none
+ */
+static void NVOCMP_removeIndex(uint8_t pg, uint16_t hOfs)
+{
+    uint16_t i;
+
+    for(i = 0; i < NVOCMP_indexCount; i++)
+    {
+        if((NVOCMP_index[i].hpage == pg) && (NVOCMP_index[i].hofs == hOfs))
+        {
+            NVOCMP_indexCount--;
+            memmove(&NVOCMP_index[i], &NVOCMP_index[i + 1],
+                    (NVOCMP_indexCount - i) * sizeof(NVOCMP_indexEntry_t));
+            break;
+        }
+    }
+}
+#endif // NVOCMP_RAM_INDEX
+
 //*****************************************************************************
@@ -109,6 +109,23 @@ extern void NVOCMP_loadApiPtrsMin(NVINTF_nvFuncts_t *pfn);
  */
 extern void NVOCMP_setCheckVoltage(void *funcPtr);
 
+/**
+ * @fn      NVOCMP_compactStep
+ *
+ * @brief   Global function to compact NV ahead of time, meant to be called
+ *          when the application is idle. If free space is below
+ *          NVOCMP_COMPACT_WATERMARK, one page is compacted, so the time
+ *          taken is bounded by one page copy and erase: about 20 ms with
+ *          2 pages of 8 KB, 10 ms with 4, at 8 ms per erase and 8 us per
+ *          word programmed. A step is a page rather than some number of
+ *          items because the copy can't be left half done while the
+ *          driver is unlocked, and the erase can't be split anyway.
+ *
+ * @return  NVINTF_SUCCESS if a page was compacted, NVINTF_BADPARAM if no
+ *          compaction was needed, or specific failure code
+ */
+extern uint8_t NVOCMP_compactStep(void);
+
 // Exception function can be defined to handle NV corruption issues
 // If none provided, NV module attempts to proceed ignoring problem
 #if !defined (NVOCMP_EXCEPTION)
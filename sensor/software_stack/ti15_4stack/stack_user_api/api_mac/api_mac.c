@@ -259,6 +259,12 @@ void *ApiMac_init(uint8_t macTaskIdParam, bool enableFH)
 
     appTaskId = OsalPort_registerTask(Task_self(), appSemHandle, &appEvents);
 
+#if (OsalPort_APP_MSG_RING_SIZE > 0)
+    /* MAC callbacks reach this task through a ring; without one (no
+       memory) they still arrive through the message list */
+    (void)OsalPort_msgRingEnable(appTaskId, OsalPort_APP_MSG_RING_SIZE);
+#endif
+
     /* Allocate message buffer space */
     macStackInitParams_t *pMsg = (macStackInitParams_t *)OsalPort_msgAllocate(
                     sizeof(macStackInitParams_t));